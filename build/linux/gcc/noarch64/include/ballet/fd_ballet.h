@@ -0,0 +1,12 @@
+#ifndef HEADER_fd_src_ballet_fd_ballet_h
+#define HEADER_fd_src_ballet_fd_ballet_h
+
+//#include "fd_ballet_base.h"   /* Includes ../util/fd_util.h */
+//#include "sha256/fd_sha256.h" /* Includes fd_ballet_base.h */
+//#include "sha512/fd_sha512.h" /* Includes fd_ballet_base.h */
+#include "ed25519/fd_ed25519.h" /* Includes sha512/fd_sha512.h */
+#include "poh/fd_poh.h"         /* Includes sha256/fd_sha256.h */
+#include "shred/fd_shred.h"
+#include "bmtree/fd_bmtree.h"   /* Includes sha256/fd_sha256.h */
+
+#endif /* HEADER_fd_src_ballet_fd_ballet_h */
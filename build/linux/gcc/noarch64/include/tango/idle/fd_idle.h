@@ -0,0 +1,218 @@
+#ifndef HEADER_fd_src_tango_idle_fd_idle_h
+#define HEADER_fd_src_tango_idle_fd_idle_h
+
+/* fd_idle provides an escalating idle policy for tile run loops.  When
+   a tile finds itself caught up with its inputs, it conventionally spins
+   on FD_SPIN_PAUSE() until new work shows up.  This gives the lowest
+   possible wake-up latency but burns an entire core at full power even
+   when there is no traffic.  Keeping idle cores busy burns into the
+   package power and thermal budget and thus reduces the turbo headroom
+   available to the tiles that are actually busy.
+
+   A fd_idle_t lets a run loop back off gracefully as an idle episode
+   gets longer:
+
+     SPIN  - FD_SPIN_PAUSE() (same as the conventional behavior).  Used
+             for the first spin_max ticks of an idle episode.
+
+     WAIT  - UMONITOR/UMWAIT on the cache line where new work will show
+             up (e.g. the mcache line for the next expected sequence
+             number).  The core drops into a light C0.x sleep state and
+             is woken up by the hardware when that line is written (or
+             the wait deadline expires).  Used for idle episodes longer
+             than spin_max but shorter than wait_max ticks.  Falls back
+             to FD_SPIN_PAUSE() if the host does not support WAITPKG.
+
+     SLEEP - Put the thread to sleep for sleep_ns via the operating
+             system.  Used for idle episodes longer than wait_max ticks.
+             This is meant for off-peak operation only and should be
+             used with sleep_ns much smaller than the tile's housekeeping
+             interval.  (A futex based tier is not used as tango
+             producers never do wake-up syscalls on behalf of consumers.)
+
+   Since the right thresholds depend on traffic patterns and the host,
+   each idle episode that ends with the run loop finding new work is
+   recorded in a per tier histogram of the duration of the final idle
+   primitive of that episode.  This is a tight upper bound of the wake-up
+   latency of that tier (the work became available at some point during
+   that last primitive) and thus can be used to pick thresholds.
+
+   Like fd_fctl, a fd_idle_t is typically local to the tile but it can
+   be placed in a shared memory region to allow remote monitors to
+   inspect its statistics. */
+
+#include "../fd_tango_base.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+/* FD_IDLE_TIER_* enumerate the idle tiers.  FD_IDLE_TIER_CNT is the
+   number of tiers. */
+
+#define FD_IDLE_TIER_SPIN  (0)
+#define FD_IDLE_TIER_WAIT  (1)
+#define FD_IDLE_TIER_SLEEP (2)
+#define FD_IDLE_TIER_CNT   (3)
+
+/* FD_IDLE_HIST_BIN_CNT is the number of bins in a wake-up latency
+   histogram.  Bin 0 counts latencies in [0,2) ticks and bin b>0 counts
+   latencies in [2^b,2^(b+1)) ticks. */
+
+#define FD_IDLE_HIST_BIN_CNT (64UL)
+
+/* FD_IDLE_{ALIGN,FOOTPRINT} specify the alignment and footprint needed
+   for a fd_idle_t.  ALIGN is at least double cache line to mitigate
+   various kinds of false sharing when used in a shared region. */
+
+#define FD_IDLE_ALIGN     (128UL)
+#define FD_IDLE_FOOTPRINT (sizeof(fd_idle_t))
+
+/* FD_IDLE_{SPIN,WAIT,SLEEP}_NS_DEFAULT give the default thresholds.  By
+   default, the sleep tier is disabled. */
+
+#define FD_IDLE_SPIN_NS_DEFAULT  (10000L)   /* 10 us */
+#define FD_IDLE_WAIT_NS_DEFAULT  (LONG_MAX) /* never sleep */
+#define FD_IDLE_SLEEP_NS_DEFAULT (100000L)  /* 100 us */
+
+/* fd_idle_t is an opaque handle of an idle object.  Details are exposed
+   here to facilitate inlining the busy path in run loops. */
+
+#define FD_IDLE_MAGIC (0xf17eda2c3791d1e0UL) /* firedancer idle ver 0 */
+
+struct __attribute__((aligned(FD_IDLE_ALIGN))) fd_idle_private {
+  ulong magic;       /* == FD_IDLE_MAGIC */
+  long  spin_max;    /* Ticks into an idle episode before escalating SPIN->WAIT, in [0,LONG_MAX] */
+  long  wait_max;    /* Ticks into an idle episode before escalating WAIT->SLEEP, in [spin_max,LONG_MAX] */
+  long  wait_dt;     /* Maximum ticks for a single UMWAIT, positive */
+  long  sleep_ns;    /* Nanoseconds for a single SLEEP, positive */
+  int   has_waitpkg; /* 1 if UMONITOR/UMWAIT are usable on this host, 0 otherwise */
+  int   tier;        /* Tier of the most recent idle primitive in the current idle episode, -1 if not idle */
+  long  idle_then;   /* Tickcount when the current idle episode started (valid if tier>=0) */
+  long  wait_then;   /* Tickcount when the most recent idle primitive started (valid if tier>=0) */
+
+  ulong episode_cnt[ FD_IDLE_TIER_CNT ];                         /* Number of idle episodes that ended in each tier */
+  ulong wake_hist  [ FD_IDLE_TIER_CNT ][ FD_IDLE_HIST_BIN_CNT ]; /* Wake-up latency histogram for each tier */
+};
+
+typedef struct fd_idle_private fd_idle_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_idle_{align,footprint} return the required alignment and footprint
+   of a memory region suitable for use as a fd_idle_t. */
+
+FD_FN_CONST static inline ulong fd_idle_align    ( void ) { return FD_IDLE_ALIGN;     }
+FD_FN_CONST static inline ulong fd_idle_footprint( void ) { return FD_IDLE_FOOTPRINT; }
+
+/* fd_idle_new formats an unused memory region for use as an idle
+   object.  spin_ns is how long in ns an idle episode should spin before
+   escalating to the wait tier.  wait_ns is how long in ns into an idle
+   episode to escalate to the sleep tier (LONG_MAX disables the sleep
+   tier).  sleep_ns is how long in ns each sleep should be.  Negative
+   values for any of these indicate to use the corresponding default.
+   The ns thresholds are converted to ticks using
+   fd_tempo_tick_per_ns(), which can take ~0.5 s the first time it is
+   called in a thread group.  Returns shmem on success and NULL on
+   failure (logs details).  Reasons for failure include an obviously bad
+   memory region, wait_ns<spin_ns and zero sleep_ns.
+
+   fd_idle_join joins the caller to an idle object.  fd_idle_leave
+   leaves a current local join.  fd_idle_delete unformats a memory
+   region used as an idle object.  These follow the usual conventions. */
+
+void *
+fd_idle_new( void * shmem,
+             long   spin_ns,
+             long   wait_ns,
+             long   sleep_ns );
+
+fd_idle_t *
+fd_idle_join( void * shidle );
+
+void *
+fd_idle_leave( fd_idle_t * idle );
+
+void *
+fd_idle_delete( void * shidle );
+
+/* fd_idle_has_waitpkg returns 1 if the host supports UMONITOR/UMWAIT
+   and 0 otherwise. */
+
+int
+fd_idle_has_waitpkg( void );
+
+/* Accessors.  These assume idle is a current local join.
+   fd_idle_{spin_max,wait_max} are in ticks and fd_idle_sleep_ns is in
+   ns.  fd_idle_episode_cnt returns the number of idle episodes that
+   ended in the given tier.  fd_idle_wake_hist returns the location of
+   the given tier's wake-up latency histogram (indexed
+   [0,FD_IDLE_HIST_BIN_CNT)).  tier is assumed to be in
+   [0,FD_IDLE_TIER_CNT). */
+
+FD_FN_PURE static inline long fd_idle_spin_max   ( fd_idle_t const * idle ) { return idle->spin_max;    }
+FD_FN_PURE static inline long fd_idle_wait_max   ( fd_idle_t const * idle ) { return idle->wait_max;    }
+FD_FN_PURE static inline long fd_idle_sleep_ns   ( fd_idle_t const * idle ) { return idle->sleep_ns;    }
+FD_FN_PURE static inline int  fd_idle_waitpkg    ( fd_idle_t const * idle ) { return idle->has_waitpkg; }
+FD_FN_PURE static inline int  fd_idle_in_episode ( fd_idle_t const * idle ) { return idle->tier>=0;     }
+
+FD_FN_PURE static inline ulong
+fd_idle_episode_cnt( fd_idle_t const * idle,
+                     int               tier ) {
+  return idle->episode_cnt[ tier ];
+}
+
+FD_FN_CONST static inline ulong const *
+fd_idle_wake_hist( fd_idle_t const * idle,
+                   int               tier ) {
+  return idle->wake_hist[ tier ];
+}
+
+/* fd_idle_wait is called by a run loop that has just found itself
+   caught up at time now (in ticks).  watch points to the location in
+   the caller's address space where new work will show up (e.g.
+   &mline->seq for the next expected frag) and seen is the value the
+   caller observed there when it found itself caught up.  This picks the
+   tier based on how long the caller has been idle, does the tier's idle
+   primitive and returns the tickcount observed when the primitive
+   completed (which the caller can use as its new now).  The wait and
+   sleep tiers reread watch immediately before blocking and return
+   without blocking if it no longer holds seen.  Starts a new idle
+   episode if the caller was not already in one. */
+
+long
+fd_idle_wait( fd_idle_t *   idle,
+              ulong const * watch,
+              ulong         seen,
+              long          now );
+
+/* fd_idle_busy is called by a run loop when it has found new work.  If
+   the caller was in an idle episode, the episode is ended and the
+   wake-up latency of the episode's final idle primitive is recorded.
+   This is cheap (a predictable branch) when the caller was not idle
+   and thus is fine to call for every frag processed. */
+
+static inline void
+fd_idle_busy( fd_idle_t * idle,
+              long        now ) {
+  int tier = idle->tier;
+  if( FD_LIKELY( tier<0 ) ) return;
+  ulong lat = (ulong)fd_long_max( now - idle->wait_then, 0L );
+  idle->episode_cnt[ tier ]++;
+  idle->wake_hist  [ tier ][ fd_ulong_find_msb( lat|1UL ) ]++;
+  idle->tier = -1;
+}
+
+/* fd_idle_wake_quantile returns an upper bound in ticks of the q
+   quantile of the given tier's wake-up latency histogram (i.e. the
+   upper edge of the bin containing that quantile).  q is in [0,1].
+   Returns 0 if no episodes have ended in that tier. */
+
+long
+fd_idle_wake_quantile( fd_idle_t const * idle,
+                       int               tier,
+                       float             q );
+
+FD_PROTOTYPES_END
+
+#endif
+
+#endif /* HEADER_fd_src_tango_idle_fd_idle_h */
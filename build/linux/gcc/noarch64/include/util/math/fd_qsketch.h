@@ -0,0 +1,140 @@
+#ifndef HEADER_fd_src_util_math_fd_qsketch_h
+#define HEADER_fd_src_util_math_fd_qsketch_h
+
+/* fd_qsketch provides a constant memory, mergeable streaming quantile
+   sketch (DDSketch style) for non-negative samples with a wide dynamic
+   range (e.g. per frag processing times).  Unlike fd_stat_median_T,
+   this doesn't need the sample array and inserting a sample is a fast
+   O(1).
+
+   A sketch is configured with a relative accuracy alpha and a sample
+   range [min,max].  Samples are counted in logarithmically spaced
+   buckets: bucket k covers (gamma^(k-1),gamma^k] where
+   gamma=(1+alpha)/(1-alpha).  The error guarantee is:
+
+     If the sample of rank r (see fd_qsketch_quantile) is in [min,max],
+     the value returned for rank r is within a relative error alpha of
+     that sample.
+
+   Samples in [0,min) are counted in a single underflow bucket (and
+   reported as 0, i.e. an absolute error less than min).  Samples
+   larger than max are counted in the top bucket (and reported as ~max).
+   Negative samples are treated as 0.  The number of buckets (and thus
+   the footprint) is ~ln(max/min)/(2 alpha).  E.g. alpha 0.01 over
+   [1,1e12] is ~1400 buckets (~11 KiB).
+
+   Sketches with identical configuration can be merged exactly (bucket
+   counts add), so per tile sketches can be combined by a monitor.
+
+   A sketch is designed to live in a shared memory region (e.g. a wksp)
+   with one writer and an arbitrary number of concurrent readers.  The
+   writer never blocks and does no atomic operations.  Bucket counts
+   are updated individually, so a concurrent reader's view might not
+   correspond exactly to the sketch at a single point in time (more
+   than adequate for monitoring). */
+
+#include "../log/fd_log.h"
+
+#if FD_HAS_DOUBLE
+
+/* FD_QSKETCH_ALIGN gives the alignment of a sketch.  Double cache line
+   to mitigate false sharing.  FD_QSKETCH_BUCKET_MAX gives the maximum
+   number of buckets supported by a sketch. */
+
+#define FD_QSKETCH_ALIGN      (128UL)
+#define FD_QSKETCH_BUCKET_MAX (1UL<<20)
+
+struct fd_qsketch_private;
+typedef struct fd_qsketch_private fd_qsketch_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_qsketch_{align,footprint} return the required alignment and
+   footprint of a memory region suitable for use as a sketch with the
+   given configuration.  alpha should be in (0,0.5] and min, max should
+   satisfy 0<min<max<inf.  fd_qsketch_footprint returns 0 if the
+   configuration is invalid (including requiring more than
+   FD_QSKETCH_BUCKET_MAX buckets). */
+
+FD_FN_CONST ulong fd_qsketch_align( void );
+
+FD_FN_CONST ulong
+fd_qsketch_footprint( double alpha,
+                      double min,
+                      double max );
+
+/* fd_qsketch_new formats an unused memory region for use as a sketch
+   with the given configuration.  The sketch will initially be empty.
+   Returns shmem on success and NULL on failure (logs details).
+
+   fd_qsketch_join joins the caller to a sketch.  fd_qsketch_leave
+   leaves a current local join.  fd_qsketch_delete unformats a memory
+   region used as a sketch.  These follow the usual conventions. */
+
+void *
+fd_qsketch_new( void * shmem,
+                double alpha,
+                double min,
+                double max );
+
+fd_qsketch_t *
+fd_qsketch_join( void * shsketch );
+
+void *
+fd_qsketch_leave( fd_qsketch_t * sketch );
+
+void *
+fd_qsketch_delete( void * shsketch );
+
+/* Accessors.  fd_qsketch_{alpha,min,max,bucket_cnt} return the
+   sketch's configuration.  fd_qsketch_cnt returns the number of
+   samples inserted (might be slightly inconsistent with the bucket
+   counts under concurrent inserts). */
+
+FD_FN_PURE double fd_qsketch_alpha     ( fd_qsketch_t const * sketch );
+FD_FN_PURE double fd_qsketch_min       ( fd_qsketch_t const * sketch );
+FD_FN_PURE double fd_qsketch_max       ( fd_qsketch_t const * sketch );
+FD_FN_PURE ulong  fd_qsketch_bucket_cnt( fd_qsketch_t const * sketch );
+
+ulong fd_qsketch_cnt( fd_qsketch_t const * sketch );
+
+/* fd_qsketch_insert inserts the sample x (assumed not NaN) into the
+   sketch.  Only the sketch's writer should call this.  O(1) (a log and
+   an increment).
+
+   fd_qsketch_reset removes all samples from the sketch.  Only the
+   sketch's writer should call this.  Returns sketch.
+
+   fd_qsketch_merge adds the samples of src to dst.  Only dst's writer
+   should call this (src can be concurrently written).  Returns dst on
+   success and NULL if the sketches have different configurations (logs
+   details). */
+
+void
+fd_qsketch_insert( fd_qsketch_t * sketch,
+                   double         x );
+
+fd_qsketch_t *
+fd_qsketch_reset( fd_qsketch_t * sketch );
+
+fd_qsketch_t *
+fd_qsketch_merge( fd_qsketch_t *       dst,
+                  fd_qsketch_t const * src );
+
+/* fd_qsketch_quantile returns an estimate of the q quantile of the
+   samples in the sketch.  Specifically, with cnt samples, this
+   estimates the sample of rank floor(q*(cnt-1)) (0-indexed in sorted
+   order).  For odd cnt, q of 0.5 is thus the median (as computed by
+   fd_stat_median_T).  See above for error bounds.  q is clamped to
+   [0,1].  Returns 0 if the sketch is empty.  O(bucket_cnt).  Safe to
+   call concurrently with the writer. */
+
+double
+fd_qsketch_quantile( fd_qsketch_t const * sketch,
+                     double               q );
+
+FD_PROTOTYPES_END
+
+#endif /* FD_HAS_DOUBLE */
+
+#endif /* HEADER_fd_src_util_math_fd_qsketch_h */
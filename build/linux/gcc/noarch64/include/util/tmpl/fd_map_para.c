@@ -0,0 +1,533 @@
+/* Declare high performance concurrent key-val maps suitable for placing
+   in a wksp and sharing between tiles in different processes.  Unlike
+   the other maps, any number of threads can concurrently insert,
+   remove, modify and query.  Typical usage:
+
+     struct myele {
+       ulong key;  // Technically "MAP_KEY_T  MAP_KEY;"  (default is ulong key)
+       uint  next; // Technically "MAP_NEXT;"            (default is uint  next), managed by the map
+       ... key and next can be located arbitrarily in struct
+       ... the rest of the struct is POD state/values associated with key
+     };
+
+     typedef struct myele myele_t;
+
+     #define MAP_NAME mymap
+     #define MAP_T    myele_t
+     #include "util/tmpl/fd_map_para.c"
+
+  will declare the following static inline APIs as a header only style
+  library in the compilation unit:
+
+    // align/footprint - Return the alignment/footprint required for a
+    // memory region to be used as mymap with bucket_cnt hash chains
+    // that can hold up to ele_max keys.  footprint returns 0 if
+    // bucket_cnt is not a power of 2 or ele_max is not in
+    // [1,UINT_MAX).  A bucket_cnt around ele_max/2 to ele_max is
+    // typical.
+    //
+    // new - Format a memory region pointed to by shmem into a mymap.
+    // seed is an arbitrary value used to seed the key hash function.
+    // Returns shmem on success and NULL on failure (logs details).
+    //
+    // join - Join a mymap.  Returns a handle of the caller's join on
+    // success and NULL on failure (logs details).  leave / delete are
+    // the usual.
+
+    ulong     mymap_align    ( void                                                        );
+    ulong     mymap_footprint( ulong bucket_cnt, ulong ele_max                             );
+    void *    mymap_new      ( void * shmem, ulong bucket_cnt, ulong ele_max, ulong seed );
+    mymap_t * mymap_join     ( void * shmap                                                );
+    void *    mymap_leave    ( mymap_t * join                                              );
+    void *    mymap_delete   ( void * shmap                                                );
+
+    // Accessors.  key_cnt returns the number of keys in the map at some
+    // point in time between when the call was made and when it
+    // returned.
+
+    ulong mymap_bucket_cnt( mymap_t const * join );
+    ulong mymap_ele_max   ( mymap_t const * join );
+    ulong mymap_seed      ( mymap_t const * join );
+    ulong mymap_key_cnt   ( mymap_t const * join );
+
+    // insert - Copies ele into the map.  Returns FD_MAP_PARA_SUCCESS on
+    // success, FD_MAP_PARA_ERR_KEY if ele's key is already in the map
+    // and FD_MAP_PARA_ERR_FULL if the map already holds ele_max keys
+    // (checked first).  The value of ele's next field is ignored.
+    //
+    // remove - Removes key from the map.  If ele is non-NULL, the
+    // removed element is copied into ele.  Returns FD_MAP_PARA_SUCCESS
+    // on success and FD_MAP_PARA_ERR_KEY if key is not in the map.
+    //
+    // query - Copies the element with key into ele.  Returns
+    // FD_MAP_PARA_SUCCESS on success and FD_MAP_PARA_ERR_KEY if key is
+    // not in the map (ele is clobbered).  This never writes to the map
+    // (i.e. readers do not contend with each other or with writers on
+    // other chains).
+    //
+    // modify_prepare / modify_publish - modify_prepare locks key's hash
+    // chain and returns a pointer in the caller's address space to the
+    // element with key, which the caller can update in place (other
+    // than its key and next fields) and then unlock with
+    // modify_publish( join, lock ).  Returns NULL (with the chain
+    // unlocked) if key is not in the map.  Concurrent queries for keys
+    // on the same chain will spin until the modification is published,
+    // so keep modifications short.
+
+    int       mymap_insert        ( mymap_t * join, myele_t const * ele            );
+    int       mymap_remove        ( mymap_t * join, ulong key, myele_t * ele       );
+    int       mymap_query         ( mymap_t const * join, ulong key, myele_t * ele );
+    myele_t * mymap_modify_prepare( mymap_t * join, ulong key, ulong * lock        );
+    void      mymap_modify_publish( mymap_t * join, ulong lock                     );
+
+  The implementation is a chained hash table.  Each hash chain has a
+  version number that writers make odd (with a CAS) to lock the chain
+  and make even again (bumped) to unlock it.  Queries are lock free:
+  they read the version, walk the chain, copy out the element and then
+  reread the version, retrying if the version changed or was odd.
+  Elements are addressed by their index in the map's element array
+  (not by pointer) and unused elements are kept on a lock free stack
+  (with an ABA tag) such that a map in a wksp can be used concurrently
+  by processes that map the wksp at different addresses.  Since a
+  query can observe an element that is being removed and reused, the
+  walk is bounded and the element is only trusted after the version
+  check.  As such, MAP_KEY_EQUAL and MAP_KEY_HASH should be robust
+  against arbitrary bit patterns in a key (trivially true for the
+  default ulong keys).
+
+  You can do this as often as you like in a compilation unit to get
+  different types of maps.  Since it is all static inline, it is fine
+  to do this in a header too. */
+
+#include "../log/fd_log.h"
+
+#if !FD_HAS_ATOMIC
+#error "fd_map_para requires FD_HAS_ATOMIC"
+#endif
+
+#ifndef MAP_NAME
+#error "Define MAP_NAME"
+#endif
+
+/* A MAP_T should be something reasonable to shallow copy with the
+   fields described above. */
+
+#ifndef MAP_T
+#error "Define MAP_T struct"
+#endif
+
+/* MAP_KEY_T should be something reasonable to pass to a static inline
+   by value, compare for equality and copy.  E.g. a uint, ulong, __m128i,
+   etc. */
+
+#ifndef MAP_KEY_T
+#define MAP_KEY_T ulong
+#endif
+
+/* MAP_KEY is the MAP_T key field name.  Defaults to key. */
+
+#ifndef MAP_KEY
+#define MAP_KEY key
+#endif
+
+/* MAP_NEXT is the MAP_T next field name.  This should be a uint.
+   Defaults to next. */
+
+#ifndef MAP_NEXT
+#define MAP_NEXT next
+#endif
+
+/* MAP_KEY_EQUAL returns 0/1 if k0 is the different/same */
+
+#ifndef MAP_KEY_EQUAL
+#define MAP_KEY_EQUAL(k0,k1) (k0)==(k1)
+#endif
+
+/* MAP_KEY_HASH takes a key and a seed and maps it into a ulong uniform
+   pseudo randomly. */
+
+#ifndef MAP_KEY_HASH
+#define MAP_KEY_HASH(key,seed) fd_ulong_hash( (key) ^ (seed) )
+#endif
+
+/* MAP_MAGIC is the magic number for identifying the map's region. */
+
+#ifndef MAP_MAGIC
+#define MAP_MAGIC (0xf17eda2c376a9a00UL) /* firedancer map para ver 0 */
+#endif
+
+/* Implementation *****************************************************/
+
+#ifndef FD_MAP_PARA_SUCCESS
+#define FD_MAP_PARA_SUCCESS  ( 0) /* Operation was successful */
+#define FD_MAP_PARA_ERR_KEY  (-1) /* Key was not in the map (remove, query) or already in the map (insert) */
+#define FD_MAP_PARA_ERR_FULL (-2) /* Map already holds ele_max keys */
+#endif
+
+#define MAP_(n)       FD_EXPAND_THEN_CONCAT3(MAP_NAME,_,n)
+#define MAP_IDX_NULL  UINT_MAX
+
+struct MAP_(private_bucket) {
+  ulong ver;  /* Odd if the chain is locked */
+  uint  head; /* Index of the first element on the chain, MAP_IDX_NULL if empty */
+};
+
+typedef struct MAP_(private_bucket) MAP_(private_bucket_t);
+
+struct __attribute__((aligned(128UL))) MAP_(private) {
+  ulong magic;      /* == MAP_MAGIC */
+  ulong bucket_cnt; /* Power of 2 */
+  ulong ele_max;    /* In [1,UINT_MAX) */
+  ulong seed;
+  ulong ele_off;    /* Byte offset from the header to the element array */
+
+  ulong free_top __attribute__((aligned(128UL))); /* Unused element stack top, (tag<<32) | idx (idx MAP_IDX_NULL if empty) */
+  ulong key_cnt  __attribute__((aligned(128UL))); /* Number of keys currently in the map */
+
+  /* bucket_cnt MAP_(private_bucket_t) follow here */
+  /* ele_max    MAP_T                  follow here (at ele_off) */
+};
+
+typedef struct MAP_(private) MAP_(t);
+
+FD_PROTOTYPES_BEGIN
+
+/* Private APIs *******************************************************/
+
+FD_FN_CONST static inline ulong
+MAP_(private_ele_off)( ulong bucket_cnt ) {
+  return fd_ulong_align_up( sizeof(MAP_(t)) + bucket_cnt*sizeof(MAP_(private_bucket_t)), alignof(MAP_T) );
+}
+
+FD_FN_CONST static inline MAP_(private_bucket_t) *
+MAP_(private_bucket)( MAP_(t) * map ) {
+  return (MAP_(private_bucket_t) *)(map+1);
+}
+
+FD_FN_CONST static inline MAP_(private_bucket_t) const *
+MAP_(private_bucket_const)( MAP_(t) const * map ) {
+  return (MAP_(private_bucket_t) const *)(map+1);
+}
+
+FD_FN_PURE static inline MAP_T *
+MAP_(private_ele)( MAP_(t) * map ) {
+  return (MAP_T *)((ulong)map + map->ele_off);
+}
+
+FD_FN_PURE static inline MAP_T const *
+MAP_(private_ele_const)( MAP_(t) const * map ) {
+  return (MAP_T const *)((ulong)map + map->ele_off);
+}
+
+FD_FN_PURE static inline ulong
+MAP_(private_bucket_idx)( MAP_(t) const * map,
+                          MAP_KEY_T       key ) {
+  return ((ulong)(MAP_KEY_HASH( (key), (map->seed) ))) & (map->bucket_cnt-1UL);
+}
+
+/* private_lock spins until it locks chain bucket and returns the odd
+   version the chain was locked at.  private_unlock unlocks a chain
+   locked at version ver (bumping the chain's version). */
+
+static inline ulong
+MAP_(private_lock)( MAP_(private_bucket_t) * bucket ) {
+  for(;;) {
+    ulong ver = FD_VOLATILE_CONST( bucket->ver );
+    if( FD_LIKELY( !(ver & 1UL) ) && FD_LIKELY( FD_ATOMIC_CAS( &bucket->ver, ver, ver+1UL )==ver ) ) return ver+1UL;
+    FD_SPIN_PAUSE();
+  }
+}
+
+static inline void
+MAP_(private_unlock)( MAP_(private_bucket_t) * bucket,
+                      ulong                    ver ) {
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( bucket->ver ) = ver+1UL;
+  FD_COMPILER_MFENCE();
+}
+
+/* private_{acquire,release} pop / push an element from / to the
+   unused element stack.  acquire returns MAP_IDX_NULL if the stack is
+   empty. */
+
+static inline uint
+MAP_(private_acquire)( MAP_(t) * map ) {
+  MAP_T * ele = MAP_(private_ele)( map );
+  for(;;) {
+    ulong top = FD_VOLATILE_CONST( map->free_top );
+    uint  idx = (uint)top;
+    if( FD_UNLIKELY( idx==MAP_IDX_NULL ) ) return MAP_IDX_NULL;
+    uint  nxt = FD_VOLATILE_CONST( ele[ idx ].MAP_NEXT ); /* Might be stale, in which case the CAS below will fail */
+    ulong tag = (top>>32) + 1UL;
+    if( FD_LIKELY( FD_ATOMIC_CAS( &map->free_top, top, (tag<<32) | (ulong)nxt )==top ) ) return idx;
+    FD_SPIN_PAUSE();
+  }
+}
+
+static inline void
+MAP_(private_release)( MAP_(t) * map,
+                       uint      idx ) {
+  MAP_T * ele = MAP_(private_ele)( map );
+  for(;;) {
+    ulong top = FD_VOLATILE_CONST( map->free_top );
+    FD_VOLATILE( ele[ idx ].MAP_NEXT ) = (uint)top;
+    ulong tag = (top>>32) + 1UL;
+    if( FD_LIKELY( FD_ATOMIC_CAS( &map->free_top, top, (tag<<32) | (ulong)idx )==top ) ) return;
+    FD_SPIN_PAUSE();
+  }
+}
+
+/* Public APIS ********************************************************/
+
+FD_FN_CONST static inline ulong MAP_(align)( void ) { return fd_ulong_max( alignof(MAP_(t)), alignof(MAP_T) ); }
+
+FD_FN_CONST static inline ulong
+MAP_(footprint)( ulong bucket_cnt,
+                 ulong ele_max ) {
+  if( FD_UNLIKELY( !fd_ulong_is_pow2( bucket_cnt ) | (bucket_cnt>(1UL<<40)) ) ) return 0UL;
+  if( FD_UNLIKELY( !((1UL<=ele_max) & (ele_max<(ulong)MAP_IDX_NULL)) ) ) return 0UL;
+  return fd_ulong_align_up( MAP_(private_ele_off)( bucket_cnt ) + ele_max*sizeof(MAP_T), MAP_(align)() );
+}
+
+FD_FN_UNUSED static void * /* Work around -Winline */
+MAP_(new)( void * shmem,
+           ulong  bucket_cnt,
+           ulong  ele_max,
+           ulong  seed ) {
+  MAP_(t) * map = (MAP_(t) *)shmem;
+
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, MAP_(align)() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !MAP_(footprint)( bucket_cnt, ele_max ) ) ) {
+    FD_LOG_WARNING(( "bad bucket_cnt or ele_max" ));
+    return NULL;
+  }
+
+  memset( map, 0, sizeof(MAP_(t)) );
+
+  map->bucket_cnt = bucket_cnt;
+  map->ele_max    = ele_max;
+  map->seed       = seed;
+  map->ele_off    = MAP_(private_ele_off)( bucket_cnt );
+  map->key_cnt    = 0UL;
+
+  MAP_(private_bucket_t) * bucket = MAP_(private_bucket)( map );
+  for( ulong idx=0UL; idx<bucket_cnt; idx++ ) {
+    bucket[ idx ].ver  = 0UL;
+    bucket[ idx ].head = MAP_IDX_NULL;
+  }
+
+  /* Put all the elements on the unused stack (in order such that the
+     low indexed elements are used first) */
+
+  MAP_T * ele = MAP_(private_ele)( map );
+  for( ulong idx=0UL; idx<ele_max; idx++ ) ele[ idx ].MAP_NEXT = (idx+1UL<ele_max) ? (uint)(idx+1UL) : MAP_IDX_NULL;
+  map->free_top = 0UL; /* tag 0, idx 0 */
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( map->magic ) = (MAP_MAGIC);
+  FD_COMPILER_MFENCE();
+
+  return shmem;
+}
+
+FD_FN_UNUSED static MAP_(t) * /* Work around -Winline */
+MAP_(join)( void * shmap ) {
+  MAP_(t) * map = (MAP_(t) *)shmap;
+
+  if( FD_UNLIKELY( !shmap ) ) {
+    FD_LOG_WARNING(( "NULL shmap" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmap, MAP_(align)() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmap" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( map->magic!=(MAP_MAGIC) ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  return map;
+}
+
+static inline void * MAP_(leave)( MAP_(t) * join ) { return (void *)join; }
+
+FD_FN_UNUSED static void * /* Work around -Winline */
+MAP_(delete)( void * shmap ) {
+  MAP_(t) * map = (MAP_(t) *)shmap;
+
+  if( FD_UNLIKELY( !shmap ) ) {
+    FD_LOG_WARNING(( "NULL shmap" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmap, MAP_(align)() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmap" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( map->magic!=(MAP_MAGIC) ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( map->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return shmap;
+}
+
+FD_FN_PURE static inline ulong MAP_(bucket_cnt)( MAP_(t) const * join ) { return join->bucket_cnt; }
+FD_FN_PURE static inline ulong MAP_(ele_max)   ( MAP_(t) const * join ) { return join->ele_max;    }
+FD_FN_PURE static inline ulong MAP_(seed)      ( MAP_(t) const * join ) { return join->seed;       }
+static inline ulong            MAP_(key_cnt)   ( MAP_(t) const * join ) { return FD_VOLATILE_CONST( join->key_cnt ); }
+
+FD_FN_UNUSED static int /* Work around -Winline */
+MAP_(insert)( MAP_(t) *     join,
+              MAP_T const * ele ) {
+  MAP_T * pool = MAP_(private_ele)( join );
+
+  /* Acquire and fill in an element before locking the chain to keep
+     the lock hold time short */
+
+  uint idx = MAP_(private_acquire)( join );
+  if( FD_UNLIKELY( idx==MAP_IDX_NULL ) ) return FD_MAP_PARA_ERR_FULL;
+  pool[ idx ] = *ele;
+
+  MAP_(private_bucket_t) * bucket = MAP_(private_bucket)( join ) + MAP_(private_bucket_idx)( join, ele->MAP_KEY );
+  ulong ver = MAP_(private_lock)( bucket );
+
+  for( uint i=bucket->head; i!=MAP_IDX_NULL; i=pool[ i ].MAP_NEXT ) {
+    if( FD_UNLIKELY( MAP_KEY_EQUAL( (pool[ i ].MAP_KEY), (ele->MAP_KEY) ) ) ) {
+      MAP_(private_unlock)( bucket, ver );
+      MAP_(private_release)( join, idx );
+      return FD_MAP_PARA_ERR_KEY;
+    }
+  }
+
+  pool[ idx ].MAP_NEXT = bucket->head;
+  FD_COMPILER_MFENCE();
+  bucket->head = idx;
+  MAP_(private_unlock)( bucket, ver );
+
+  FD_ATOMIC_FETCH_AND_ADD( &join->key_cnt, 1UL );
+  return FD_MAP_PARA_SUCCESS;
+}
+
+FD_FN_UNUSED static int /* Work around -Winline */
+MAP_(remove)( MAP_(t) * join,
+              MAP_KEY_T key,
+              MAP_T *   ele ) {
+  MAP_T * pool = MAP_(private_ele)( join );
+
+  MAP_(private_bucket_t) * bucket = MAP_(private_bucket)( join ) + MAP_(private_bucket_idx)( join, key );
+  ulong ver = MAP_(private_lock)( bucket );
+
+  uint * prev = &bucket->head;
+  for( uint i=*prev; i!=MAP_IDX_NULL; i=*prev ) {
+    if( MAP_KEY_EQUAL( (pool[ i ].MAP_KEY), (key) ) ) {
+      *prev = pool[ i ].MAP_NEXT;
+      if( ele ) *ele = pool[ i ];
+      MAP_(private_unlock)( bucket, ver );
+      MAP_(private_release)( join, i );
+      FD_ATOMIC_FETCH_AND_ADD( &join->key_cnt, -1UL );
+      return FD_MAP_PARA_SUCCESS;
+    }
+    prev = &pool[ i ].MAP_NEXT;
+  }
+
+  MAP_(private_unlock)( bucket, ver );
+  return FD_MAP_PARA_ERR_KEY;
+}
+
+FD_FN_UNUSED static int /* Work around -Winline */
+MAP_(query)( MAP_(t) const * join,
+             MAP_KEY_T       key,
+             MAP_T *         ele ) {
+  MAP_T const * pool    = MAP_(private_ele_const)( join );
+  ulong         ele_max = join->ele_max;
+
+  MAP_(private_bucket_t) const * bucket = MAP_(private_bucket_const)( join ) + MAP_(private_bucket_idx)( join, key );
+  for(;;) {
+    FD_COMPILER_MFENCE();
+    ulong ver = FD_VOLATILE_CONST( bucket->ver );
+    FD_COMPILER_MFENCE();
+    if( FD_UNLIKELY( ver & 1UL ) ) { FD_SPIN_PAUSE(); continue; }
+
+    /* Walk the chain speculatively.  A chain has at most ele_max
+       elements so a longer walk (or an out of range index) means we
+       raced with a writer. */
+
+    int  err = FD_MAP_PARA_ERR_KEY;
+    uint i   = FD_VOLATILE_CONST( bucket->head );
+    for( ulong rem=ele_max; rem && (ulong)i<ele_max; rem-- ) {
+      MAP_T const * e = pool + i;
+      if( MAP_KEY_EQUAL( (e->MAP_KEY), (key) ) ) {
+        *ele = *e;
+        err  = FD_MAP_PARA_SUCCESS;
+        break;
+      }
+      i = FD_VOLATILE_CONST( e->MAP_NEXT );
+    }
+
+    FD_COMPILER_MFENCE();
+    if( FD_LIKELY( FD_VOLATILE_CONST( bucket->ver )==ver ) ) return err;
+    FD_SPIN_PAUSE();
+  }
+}
+
+FD_FN_UNUSED static MAP_T * /* Work around -Winline */
+MAP_(modify_prepare)( MAP_(t) * join,
+                      MAP_KEY_T key,
+                      ulong *   lock ) {
+  MAP_T * pool = MAP_(private_ele)( join );
+
+  ulong bucket_idx = MAP_(private_bucket_idx)( join, key );
+  MAP_(private_bucket_t) * bucket = MAP_(private_bucket)( join ) + bucket_idx;
+  ulong ver = MAP_(private_lock)( bucket );
+
+  for( uint i=bucket->head; i!=MAP_IDX_NULL; i=pool[ i ].MAP_NEXT ) {
+    if( MAP_KEY_EQUAL( (pool[ i ].MAP_KEY), (key) ) ) {
+      *lock = bucket_idx;
+      return pool + i;
+    }
+  }
+
+  MAP_(private_unlock)( bucket, ver );
+  return NULL;
+}
+
+static inline void
+MAP_(modify_publish)( MAP_(t) * join,
+                      ulong     lock ) {
+  MAP_(private_bucket_t) * bucket = MAP_(private_bucket)( join ) + lock;
+  MAP_(private_unlock)( bucket, bucket->ver );
+}
+
+FD_PROTOTYPES_END
+
+#undef MAP_IDX_NULL
+#undef MAP_
+
+/* End implementation *************************************************/
+
+#undef MAP_MAGIC
+#undef MAP_KEY_HASH
+#undef MAP_KEY_EQUAL
+#undef MAP_NEXT
+#undef MAP_KEY
+#undef MAP_KEY_T
+#undef MAP_T
+#undef MAP_NAME
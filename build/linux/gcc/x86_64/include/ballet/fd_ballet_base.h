@@ -0,0 +1,14 @@
+#ifndef HEADER_fd_src_ballet_fd_ballet_base_h
+#define HEADER_fd_src_ballet_fd_ballet_base_h
+
+#include "../util/fd_util.h"
+
+//FD_PROTOTYPES_BEGIN
+
+/* This is currently just a stub in anticipation of future common
+   interoperability functionality */
+
+//FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_ballet_fd_ballet_base_h */
+
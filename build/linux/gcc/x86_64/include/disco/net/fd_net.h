@@ -0,0 +1,414 @@
+#ifndef HEADER_fd_src_disco_net_fd_net_h
+#define HEADER_fd_src_disco_net_fd_net_h
+
+/* fd_net provides services to ingest UDP/IP4 traffic received from
+   AF_XDP sockets into tango frag streams.  On a multi-queue NIC, one
+   XSK is bound per NIC RX queue and the queues are spread over one or
+   more net tiles (see fd_net_queue_assign), such that ingress scales
+   with the number of queues. */
+
+#include "../fd_disco_base.h"
+#include "../../util/net/fd_eth.h"
+#include "../../util/net/fd_udp.h" /* includes fd_ip4.h */
+
+/* FD_NET_PARSE_{SUCCESS,ERR_*} give the return codes of
+   fd_net_parse_udp and fd_net_check_udp_batch.  ERR_* are negative
+   integers. */
+
+#define FD_NET_PARSE_SUCCESS   ( 0) /* Packet is a well formed unfragmented UDP/IP4 datagram */
+#define FD_NET_PARSE_ERR_ETH   (-1) /* Truncated ethernet header / vlan tag or not an IP4 ethertype */
+#define FD_NET_PARSE_ERR_IP4   (-2) /* Truncated or malformed ip4 header, bad header checksum or fragmented */
+#define FD_NET_PARSE_ERR_PROTO (-3) /* IP4 packet does not encapsulate a UDP datagram */
+#define FD_NET_PARSE_ERR_UDP   (-4) /* Truncated or malformed udp header */
+#define FD_NET_PARSE_ERR_CSUM  (-5) /* Bad udp checksum (fd_net_check_udp_batch only) */
+
+/* fd_net_udp_info_t describes the location of a UDP payload in a raw
+   ethernet frame and the flow it belongs to.  Addresses are in the
+   usual fd_ip4 representation (technically net order), ports are in
+   host order. */
+
+struct fd_net_udp_info {
+  ulong  payload_off; /* Byte offset of the first payload byte from the first byte of the frame */
+  ulong  payload_sz;  /* Payload size in bytes, payload_off+payload_sz<=pkt_sz */
+  uint   saddr;       /* IP4 source address */
+  uint   daddr;       /* IP4 destination address */
+  ushort sport;       /* UDP source port, host order */
+  ushort dport;       /* UDP destination port, host order */
+};
+
+typedef struct fd_net_udp_info fd_net_udp_info_t;
+
+/* Beyond the standard FD_CNC_SIGNAL_HALT, FD_NET_CNC_SIGNAL_ACK can be
+   raised by a cnc thread with an open command session while the net
+   tile is in the RUN state.  The net tile will transition from ACK->RUN
+   the next time it processes cnc signals to indicate it is running
+   normally.  If a signal other than ACK, HALT, or RUN is raised, it
+   will be logged as unexpected and transitioned by back to RUN. */
+
+#define FD_NET_CNC_SIGNAL_ACK (4UL)
+
+/* A fd_net_tile will use the fseq and cnc application regions to
+   accumulate flow control diagnostics in the standard ways.  It
+   additionally will accumulate to the cnc application region the
+   following tile specific counters:
+
+     CHUNK_IDX   is the chunk idx where net tile should start publishing payloads on boot (ignored if not valid on boot)
+     RX_PUB_CNT  is the number of UDP datagrams published by the net tile
+     RX_PUB_SZ   is the number of UDP payload bytes published by the net tile
+     RX_FILT_CNT is the number of received frames filtered by the net tile (not UDP/IP4, malformed or too large)
+     RX_FILT_SZ  is the number of received frame bytes filtered by the net tile
+
+   and, for each XSK xsk_idx the tile receives from, the following
+   counters at FD_NET_CNC_DIAG_Q( xsk_idx, * ):
+
+     Q_IFQUEUE    is the NIC RX queue the XSK is bound to (set on boot)
+     Q_RX_CNT     is the number of frames taken off the XSK's RX ring
+     Q_DROP_CNT   is the number of frames the kernel dropped for the XSK (ring full / invalid descriptor / other) since it was bound
+     Q_FILL_EMPTY is the number of times the kernel found the XSK's fill ring empty since it was bound
+
+   DROP_CNT and FILL_EMPTY mirror the kernel's counters and are updated
+   for one XSK per housekeeping event (they require a syscall).  As
+   such, the cnc app region must be at least
+   FD_NET_CNC_APP_SZ( xsk_cnt ) bytes in size.
+
+   Except for IN_BACKP, none of the diagnostics are cleared at
+   tile startup (as such that they can be accumulated over multiple
+   runs).  Clearing is up to monitoring scripts. */
+
+#define FD_NET_CNC_DIAG_CHUNK_IDX   (2UL) /* On 1st cache line of app region, updated by producer, frequently */
+#define FD_NET_CNC_DIAG_RX_PUB_CNT  (3UL) /* ", frequently */
+#define FD_NET_CNC_DIAG_RX_PUB_SZ   (4UL) /* ", frequently */
+#define FD_NET_CNC_DIAG_RX_FILT_CNT (5UL) /* ", frequently */
+#define FD_NET_CNC_DIAG_RX_FILT_SZ  (6UL) /* ", frequently */
+
+#define FD_NET_CNC_DIAG_Q_IFQUEUE    (0UL) /* Per XSK, updated by producer, on boot */
+#define FD_NET_CNC_DIAG_Q_RX_CNT     (1UL) /* ", frequently */
+#define FD_NET_CNC_DIAG_Q_DROP_CNT   (2UL) /* ", infrequently */
+#define FD_NET_CNC_DIAG_Q_FILL_EMPTY (3UL) /* ", infrequently */
+
+#define FD_NET_CNC_DIAG_Q( xsk_idx, diag ) (8UL + 4UL*(xsk_idx) + (diag))
+
+#define FD_NET_CNC_APP_SZ( xsk_cnt ) (8UL*FD_NET_CNC_DIAG_Q( (xsk_cnt), 0UL ))
+
+/* FD_NET_TILE_OUT_MAX are the maximum number of outputs a net tile can
+   have.  These limits are more or less arbitrary from a functional
+   correctness POV.  They mostly exist to set some practical upper
+   bounds for things like scratch footprint. */
+
+#define FD_NET_TILE_OUT_MAX FD_FRAG_META_ORIG_MAX
+#define FD_NET_TILE_XSK_MAX (64UL)
+
+/* FD_NET_TILE_SCRATCH_{ALIGN,FOOTPRINT} specify the alignment and
+   footprint needed for a net tile scratch region that can support
+   out_cnt outputs and xsk_cnt XSKs.  ALIGN is an integer power of 2 of
+   at least double cache line to mitigate various kinds of false
+   sharing.  FOOTPRINT will be an integer multiple of ALIGN.  out_cnt
+   and xsk_cnt are assumed to be valid (i.e. at most
+   FD_NET_TILE_OUT_MAX and in [1,FD_NET_TILE_XSK_MAX]).  These are
+   provided to facilitate compile time declarations. */
+
+#define FD_NET_TILE_SCRATCH_ALIGN (128UL)
+#define FD_NET_TILE_SCRATCH_FOOTPRINT( out_cnt, xsk_cnt )               \
+  FD_LAYOUT_FINI( FD_LAYOUT_APPEND( FD_LAYOUT_APPEND( FD_LAYOUT_INIT,   \
+    FD_FCTL_ALIGN,  FD_FCTL_FOOTPRINT( (out_cnt) )                   ), \
+    alignof(ulong), (xsk_cnt)*sizeof(ulong)                          ), \
+    FD_NET_TILE_SCRATCH_ALIGN )
+
+/* FD_NET_ZC_TILE_SCRATCH_ALIGN specifies the alignment needed for a
+   zero copy net tile scratch region (see fd_net_zc_tile).  The
+   footprint depends on run time parameters and is given by
+   fd_net_zc_tile_scratch_footprint. */
+
+#define FD_NET_ZC_TILE_SCRATCH_ALIGN (128UL)
+
+/* FD_NET_ZC_UMEM_ALIGN is the alignment of the XSK UMEM a zero copy
+   net tile carves out of its dcache's data region.  This matches
+   FD_XSK_UMEM_ALIGN (the dcache data region itself is only
+   FD_DCACHE_ALIGN aligned, so up to FD_NET_ZC_UMEM_ALIGN bytes at the
+   start of the data region are unused). */
+
+#define FD_NET_ZC_UMEM_ALIGN (4096UL)
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_net_queue_assign assigns queue_cnt NIC RX queues to tile_cnt net
+   tiles.  tile_numa[ tile_idx ] is the NUMA node of the cpu tile
+   tile_idx runs on (ULONG_MAX if it floats) and nic_numa is the NUMA
+   node the NIC is attached to (ULONG_MAX if unknown, see
+   fd_xdp_iface_numa_idx).  On return, queue_tile[ queue_idx ] is the
+   tile that should serve RX queue queue_idx.
+
+   Tiles on the NIC's NUMA node get first pick: the tiles are ordered
+   NIC local first (in tile order, then the remaining tiles in tile
+   order) and queues are dealt round robin in that order.  Thus, every
+   tile serves at least one queue if queue_cnt>=tile_cnt, the queue
+   counts of any two tiles differ by at most one and any extra queues
+   go to NIC local tiles.  (If fewer queues than tiles, the NIC local
+   tiles are the ones that get work.)  Returns the number of tiles that
+   were assigned at least one queue (i.e. min(queue_cnt,tile_cnt)) or
+   0 if queue_cnt or tile_cnt is zero or tile_cnt is larger than
+   FD_TILE_MAX (queue_tile is not touched then). */
+
+ulong
+fd_net_queue_assign( ulong         queue_cnt,
+                     ulong         tile_cnt,
+                     ulong const * tile_numa,
+                     ulong         nic_numa,
+                     ulong *       queue_tile );
+
+/* fd_net_zc_dcache_data_sz returns the dcache data_sz needed such that
+   fd_net_zc_umem can carve out a UMEM of at least frame_cnt frames of
+   frame_sz bytes each.  frame_sz and frame_cnt are assumed positive and
+   such that the result does not overflow. */
+
+FD_FN_CONST static inline ulong
+fd_net_zc_dcache_data_sz( ulong frame_sz,
+                          ulong frame_cnt ) {
+  return frame_cnt*frame_sz + FD_NET_ZC_UMEM_ALIGN;
+}
+
+/* fd_net_zc_umem returns the location in the caller's address space
+   of the UMEM a zero copy net tile uses in the data region of the
+   dcache (a current local join).  The UMEM is the largest
+   FD_NET_ZC_UMEM_ALIGN aligned region inside the data region that
+   holds a whole number of frame_sz byte frames.  If opt_frame_cnt is
+   non-NULL, *opt_frame_cnt will hold the number of frames on return.
+   Returns NULL (and *opt_frame_cnt will be zero) if frame_sz is zero
+   or the data region is too small for a single frame. */
+
+static inline uchar *
+fd_net_zc_umem( uchar * dcache,
+                ulong   frame_sz,
+                ulong * opt_frame_cnt ) {
+  ulong data_sz   = fd_dcache_data_sz( dcache );
+  ulong umem      = fd_ulong_align_up( (ulong)dcache, FD_NET_ZC_UMEM_ALIGN );
+  ulong pad       = umem - (ulong)dcache;
+  ulong frame_cnt = (frame_sz && data_sz>pad) ? (data_sz-pad)/frame_sz : 0UL;
+  if( opt_frame_cnt ) *opt_frame_cnt = frame_cnt;
+  return frame_cnt ? (uchar *)umem : NULL;
+}
+
+/* fd_net_parse_udp parses the raw ethernet frame in the pkt_sz byte
+   memory region pointed to by pkt.  A single 802.1Q vlan tag is
+   skipped.  The ip4 header must have a valid version, length and
+   header checksum and must not be a fragment.  The udp length must be
+   consistent with the ip4 length.  The udp checksum is not verified
+   (this is typically already done by the NIC and is optional for
+   UDP/IP4 anyway).  Trailing bytes beyond the ip4 total length (e.g.
+   ethernet minimum frame padding) are ignored.
+
+   On success, returns FD_NET_PARSE_SUCCESS and populates *info.  On
+   failure, returns a FD_NET_PARSE_ERR_* code and *info is unspecified.
+   This does not log and has no alignment requirements on pkt. */
+
+static inline int
+fd_net_parse_udp( void const *        pkt,
+                  ulong               pkt_sz,
+                  fd_net_udp_info_t * info ) {
+  uchar const * p = (uchar const *)pkt;
+  ulong         o = sizeof(fd_eth_hdr_t);
+
+  if( FD_UNLIKELY( pkt_sz<o ) ) return FD_NET_PARSE_ERR_ETH;
+  ushort net_type = ((fd_eth_hdr_t const *)p)->net_type;
+  if( FD_UNLIKELY( net_type==fd_ushort_bswap( FD_ETH_HDR_TYPE_VLAN ) ) ) {
+    if( FD_UNLIKELY( pkt_sz<o+sizeof(fd_vlan_tag_t) ) ) return FD_NET_PARSE_ERR_ETH;
+    net_type = ((fd_vlan_tag_t const *)(p+o))->net_type;
+    o += sizeof(fd_vlan_tag_t);
+  }
+  if( FD_UNLIKELY( net_type!=fd_ushort_bswap( FD_ETH_HDR_TYPE_IP ) ) ) return FD_NET_PARSE_ERR_ETH;
+
+  /* The ip4 header and udp header are copied out to sidestep alignment
+     issues (frames are usually only 2 byte aligned at the ip4 header). */
+
+  if( FD_UNLIKELY( pkt_sz<o+20UL ) ) return FD_NET_PARSE_ERR_IP4;
+  fd_ip4_hdr_t ip4[3]; /* 60 bytes, large enough for the largest possible header */
+  ip4->u[0] = fd_uint_load_4( p+o );
+  ulong ihl = 4UL*(ulong)ip4->ihl;
+  ulong tot = (ulong)fd_ushort_bswap( ip4->net_tot_len );
+  if( FD_UNLIKELY( (ip4->version!=4U) | (ihl<20UL) | (tot<ihl) | (pkt_sz<o+tot) ) ) return FD_NET_PARSE_ERR_IP4;
+  fd_memcpy( ip4, p+o, ihl );
+  if( FD_UNLIKELY( fd_ip4_hdr_check( ip4 ) ) ) return FD_NET_PARSE_ERR_IP4;
+  if( FD_UNLIKELY( !fd_ip4_hdr_net_frag_off_is_unfragmented( ip4->net_frag_off ) ) ) return FD_NET_PARSE_ERR_IP4;
+  if( FD_UNLIKELY( ip4->protocol!=FD_IP4_HDR_PROTOCOL_UDP ) ) return FD_NET_PARSE_ERR_PROTO;
+
+  ulong end = o + tot;
+  o += ihl;
+
+  if( FD_UNLIKELY( end<o+sizeof(fd_udp_hdr_t) ) ) return FD_NET_PARSE_ERR_UDP;
+  fd_udp_hdr_t udp[1];
+  fd_memcpy( udp, p+o, sizeof(fd_udp_hdr_t) );
+  ulong len = (ulong)fd_ushort_bswap( udp->net_len );
+  if( FD_UNLIKELY( (len<sizeof(fd_udp_hdr_t)) | (len>end-o) ) ) return FD_NET_PARSE_ERR_UDP;
+
+  info->payload_off = o + sizeof(fd_udp_hdr_t);
+  info->payload_sz  = len - sizeof(fd_udp_hdr_t);
+  info->saddr       = ip4->saddr;
+  info->daddr       = ip4->daddr;
+  info->sport       = fd_ushort_bswap( udp->net_sport );
+  info->dport       = fd_ushort_bswap( udp->net_dport );
+  return FD_NET_PARSE_SUCCESS;
+}
+
+/* fd_net_check_udp_batch validates the burst of batch_cnt raw
+   ethernet frames described by batch (e.g. as handed to an rx aio
+   callback).  Each frame is parsed as per fd_net_parse_udp (which
+   includes validating the ip4 header checksum) and, if the datagram
+   has a udp checksum (check!=0), the checksum of the pseudo header,
+   udp header and payload is verified in software with
+   fd_ip4_csum_append (AVX2 accelerated on FD_HAS_AVX targets).  This is
+   for use when the NIC does not do (or cannot be trusted with) udp
+   checksum offload.
+
+   On return, err[ batch_idx ] holds FD_NET_PARSE_SUCCESS if frame
+   batch_idx is a valid UDP/IP4 datagram and a FD_NET_PARSE_ERR_* code
+   otherwise.  If opt_info is non-NULL, opt_info[ batch_idx ] is
+   populated for every valid frame (and is unspecified for the others).
+   Returns the number of valid frames.  This does not log and has no
+   alignment requirements on the frames. */
+
+ulong
+fd_net_check_udp_batch( fd_aio_pkt_info_t const * batch,
+                        ulong                     batch_cnt,
+                        fd_net_udp_info_t *       opt_info,
+                        int *                     err );
+
+/* fd_net_udp_sig returns the frag sig the net tile uses for a UDP
+   datagram described by info.  This packs the flow as
+   [ saddr (32) | sport (16) | dport (16) ] such that downstream
+   consumers can filter / steer on flow without touching the payload. */
+
+FD_FN_PURE static inline ulong
+fd_net_udp_sig( fd_net_udp_info_t const * info ) {
+  return (((ulong)info->saddr)<<32) | (((ulong)info->sport)<<16) | ((ulong)info->dport);
+}
+
+FD_PROTOTYPES_END
+
+#if FD_HAS_HOSTED && FD_HAS_X86 && defined(__linux__) && FD_HAS_LIBBPF
+
+#include "../../tango/xdp/fd_xsk_aio.h"
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_net_tile ingests UDP/IP4 traffic received on the xsk_cnt AF_XDP
+   sockets behind xsk_aio[ xsk_idx ] for xsk_idx in [0,xsk_cnt) (e.g.
+   one per NIC RX queue assigned to this tile) as a single tango
+   fragment stream from origin orig into the given mcache and dcache.
+   The XSKs are serviced round robin.  Each datagram is validated (see
+   fd_net_parse_udp) and its payload is copied into a dcache chunk.
+   Frames that do not parse or that have a payload larger than mtu are
+   filtered.  The published frag has sig fd_net_udp_sig, sz the payload
+   size and tsorig the time the frame was taken off the XSK RX ring.
+   The tile can send to out_cnt reliable consumers and an arbitrary
+   number of unreliable consumers.
+
+   rx_burst is the maximum number of frames an xsk_aio completes per
+   service call (i.e. the pkt_cnt the xsk_aio were created with).  The tile
+   only services the XSK RX ring when it has at least rx_burst flow
+   control credits.  Thus, when reliable consumers fall behind, frames
+   back up into the XSK RX ring and get dropped by the kernel
+   (backpressuring the network) instead of overrunning consumers.
+
+   When this is called, the cnc should be in the BOOT state.  Returns 0
+   on a successful run of the net tile.  That is, the tile booted
+   successfully (transitioning the cnc from BOOT->RUN), ran (handling
+   any application specific cnc signals while running), and (after
+   receiving a HALT signal) halted successfully (transitioning the cnc
+   from HALT->BOOT before return).  Returns a non-zero error code if the
+   tile fails to boot up (logs details ... the cnc will not be
+   transitioned from its original state and thus is likely bootable
+   again if its original state was BOOT).
+
+   The mcache, dcache, cr_max, lazy and scratch requirements are the
+   same as fd_replay_tile with mtu playing the role of pkt_max.  The
+   tile installs its own rx aio on the xsk_aio while running (and
+   replaces it with one that drops on halt).  The lifetime of the cnc,
+   xsk_aio[*], mcache, dcache, out_fseq[*], rng and scratch used by this
+   tile should be a superset of this tile's lifetime.  While this tile
+   is running, no other tile should use cnc for its command and
+   control, service any of the xsk_aio, publish into mcache or dcache,
+   use the rng for anything (and the rng should be seeded distinctly
+   from all other rngs in the system), or use scratch for anything. */
+
+FD_FN_CONST ulong
+fd_net_tile_scratch_align( void );
+
+FD_FN_CONST ulong
+fd_net_tile_scratch_footprint( ulong out_cnt,
+                               ulong xsk_cnt );
+
+int
+fd_net_tile( fd_cnc_t *       cnc,       /* Local join to the net tile's command-and-control */
+             ulong            xsk_cnt,   /* Number of XSKs to receive from, in [1,FD_NET_TILE_XSK_MAX] */
+             fd_xsk_aio_t **  xsk_aio,   /* xsk_aio[xsk_idx] is the local join to the XSK aio of XSK xsk_idx */
+             ulong            rx_burst,  /* Max frames an xsk_aio completes per service, positive */
+             ulong            mtu,       /* Max UDP payload size to publish, positive */
+             ulong            orig,      /* Origin for this fragment stream, in [0,FD_FRAG_META_ORIG_MAX) */
+             fd_frag_meta_t * mcache,    /* Local join to the net tile's frag stream output mcache */
+             uchar *          dcache,    /* Local join to the net tile's frag stream output dcache */
+             ulong            out_cnt,   /* Number of reliable consumers, reliable consumers are indexed [0,out_cnt) */
+             ulong **         out_fseq,  /* out_fseq[out_idx] is the local join to reliable consumer out_idx's fseq */
+             ulong            cr_max,    /* Maximum number of flow control credits, 0 means use a reasonable default */
+             long             lazy,      /* Lazyiness, <=0 means use a reasonable default */
+             fd_rng_t *       rng,       /* Local join to the rng this net tile should use */
+             void *           scratch ); /* Tile scratch memory */
+
+/* fd_net_zc_tile is a zero copy variant of fd_net_tile.  xsk should be
+   a fresh local join to an fd_xsk_t created with fd_xsk_new_shumem
+   whose UMEM is the fd_net_zc_umem region of dcache (such that
+   received frames already sit at dcache chunk offsets in the wksp).
+   Instead of copying payloads, the published frags point directly at
+   the payload in the frame the kernel received it into.  A payload
+   that does not start on a FD_CHUNK_ALIGN boundary is moved down to
+   the nearest one in its own frame before publishing (with the usual
+   eth/ip4/udp headers, a UMEM headroom of 22 bytes makes this a no-op
+   for the common case).  Filtered frames are returned to the fill ring
+   immediately.
+
+   A frame holding a published payload is only returned to the fill
+   ring after all out_cnt reliable consumers have advertised (via their
+   fseq) that they are done with it.  Thus, when reliable consumers fall
+   behind, the fill ring runs dry and the kernel drops frames (and
+   there is no payload copy to bound that by).  Unreliable consumers
+   get no such protection: payloads can be overwritten as soon as the
+   next housekeeping event after publication (consumers should
+   treat payloads as they would any other speculatively read dcache
+   region).  If out_cnt is zero, frames are recycled every housekeeping
+   event.
+
+   frame_cnt (i.e. the UMEM size over the frame size) must be at most
+   the xsk fill ring depth.  All frames are given to the fill ring on
+   boot.  FD_NET_CNC_DIAG_CHUNK_IDX is not used.  The per XSK diagnostics
+   are those of a fd_net_tile with a single XSK.  Otherwise, the
+   arguments, return value and lifetime requirements are as
+   fd_net_tile, with the xsk being serviced directly by this tile.  The
+   xsk should be left (and rejoined fresh) between runs of the tile. */
+
+FD_FN_CONST ulong
+fd_net_zc_tile_scratch_align( void );
+
+FD_FN_CONST ulong
+fd_net_zc_tile_scratch_footprint( ulong out_cnt,
+                                  ulong frame_cnt,
+                                  ulong rx_burst );
+
+int
+fd_net_zc_tile( fd_cnc_t *       cnc,       /* Local join to the net tile's command-and-control */
+                fd_xsk_t *       xsk,       /* Local join to the XSK the net tile should receive from, UMEM in dcache */
+                ulong            rx_burst,  /* Max frames to take off the XSK RX ring at a time, positive */
+                ulong            mtu,       /* Max UDP payload size to publish, positive */
+                ulong            orig,      /* Origin for this fragment stream, in [0,FD_FRAG_META_ORIG_MAX) */
+                fd_frag_meta_t * mcache,    /* Local join to the net tile's frag stream output mcache */
+                uchar *          dcache,    /* Local join to the net tile's frag stream output dcache, holds the UMEM */
+                ulong            out_cnt,   /* Number of reliable consumers, reliable consumers are indexed [0,out_cnt) */
+                ulong **         out_fseq,  /* out_fseq[out_idx] is the local join to reliable consumer out_idx's fseq */
+                ulong            cr_max,    /* Maximum number of flow control credits, 0 means use a reasonable default */
+                long             lazy,      /* Lazyiness, <=0 means use a reasonable default */
+                fd_rng_t *       rng,       /* Local join to the rng this net tile should use */
+                void *           scratch ); /* Tile scratch memory */
+
+FD_PROTOTYPES_END
+
+#endif
+
+#endif /* HEADER_fd_src_disco_net_fd_net_h */
@@ -0,0 +1,18 @@
+#ifndef HEADER_fd_src_tango_fd_tango_h
+#define HEADER_fd_src_tango_fd_tango_h
+
+//#include "fd_tango_base.h"  /* Includes ../util/fd_util.h */
+#include "tempo/fd_tempo.h"   /* Includes fd_tango_base.h */
+#include "cnc/fd_cnc.h"       /* Includes fd_tango_base.h */
+#include "fseq/fd_fseq.h"     /* Includes fd_tango_base.h */
+#include "fctl/fd_fctl.h"     /* Includes fd_tango_base.h */
+#include "mcache/fd_mcache.h" /* Includes fd_tango_base.h */
+#include "dcache/fd_dcache.h" /* Includes fd_tango_base.h */
+#include "tcache/fd_tcache.h" /* Includes fd_tango_base.h */
+#include "aio/fd_aio.h"       /* Includes fd_tango_base.h */
+#include "idle/fd_idle.h"     /* Includes fd_tango_base.h */
+#include "lhist/fd_lhist.h"   /* Includes fd_tango_base.h */
+#include "tlog/fd_tlog.h"     /* Includes fd_tango_base.h */
+
+#endif /* HEADER_fd_src_tango_fd_tango_h */
+
@@ -0,0 +1,125 @@
+#ifndef HEADER_fd_src_tango_xdp_fd_xdp_redirect_prog_h
+#define HEADER_fd_src_tango_xdp_fd_xdp_redirect_prog_h
+
+/* Cross-platform definitions about fd_xdp_redirect_prog.c */
+
+#if defined(__bpf__)
+#include "../ebpf/fd_ebpf_base.h"
+#else
+#include "../../util/fd_util_base.h"
+#endif
+
+/* FD_XDP_XSKS_MAP_CNT: Max supported number of XSKs (queues).
+   The actual limit may be lower in practice depending on hardware. */
+#define FD_XDP_XSKS_MAP_CNT 256U
+
+/* FD_XDP_UDP_MAP_CNT: Max supported number of UDP port mappings. */
+#define FD_XDP_UDP_MAP_CNT  64U
+
+/* Filter stage *******************************************************/
+
+/* Traffic matching a UDP listener optionally goes through a filter
+   stage before being redirected to an XSK.  In order, it drops:
+
+   - datagrams with a UDP payload larger than udp_sz_max
+   - datagrams from a source address in a denied prefix
+   - datagrams from a source address (not in an allowed prefix) that
+     exceeds its token bucket
+
+   The filter stage is configured with the fd_xdp_filter_* API of
+   fd_xdp_redirect_user.h.  All stages are disabled by default. */
+
+/* FD_XDP_SRC_RATE_MAP_CNT: Max number of source addresses tracked for
+   rate limiting.  Least recently seen sources get evicted. */
+#define FD_XDP_SRC_RATE_MAP_CNT   65536U
+
+/* FD_XDP_SRC_PREFIX_MAP_CNT: Max number of allow/deny prefixes. */
+#define FD_XDP_SRC_PREFIX_MAP_CNT 1024U
+
+/* FD_XDP_FILTER_TXN_MTU: Max UDP payload size of a transaction.  A
+   reasonable udp_sz_max for transaction ingress. */
+#define FD_XDP_FILTER_TXN_MTU     1232U
+
+/* FD_XDP_FILTER_ACTION_*: Values of firedancer_src_prefixes */
+#define FD_XDP_FILTER_ACTION_ALLOW 1U /* Not rate limited */
+#define FD_XDP_FILTER_ACTION_DENY  2U /* Dropped */
+
+/* FD_XDP_FILTER_STAT_*: Indices into firedancer_filter_stats */
+#define FD_XDP_FILTER_STAT_PASS      0U /* Redirected to an XSK */
+#define FD_XDP_FILTER_STAT_DROP_SZ   1U /* Dropped by the size check */
+#define FD_XDP_FILTER_STAT_DROP_DENY 2U /* Dropped by a deny prefix */
+#define FD_XDP_FILTER_STAT_DROP_RATE 3U /* Dropped by rate limiting */
+#define FD_XDP_FILTER_STAT_CNT       4U
+
+/* fd_xdp_filter_cfg_t is the value of the single entry of the
+   firedancer_filter_cfg map.  Token buckets are kept in nanoseconds of
+   credit:  a source accrues 1 ns of credit per ns (up to burst_ns) and
+   each datagram costs pkt_cost_ns (i.e. the sustained rate is
+   1e9/pkt_cost_ns datagrams per second and the burst is
+   burst_ns/pkt_cost_ns datagrams).  This avoids divisions in the
+   program.  A zero udp_sz_max or pkt_cost_ns disables the size check or
+   rate limiting respectively. */
+
+struct fd_xdp_filter_cfg {
+  uint  udp_sz_max;
+  uint  _pad;
+  ulong pkt_cost_ns;
+  ulong burst_ns;
+};
+
+typedef struct fd_xdp_filter_cfg fd_xdp_filter_cfg_t;
+
+/* fd_xdp_src_prefix_key_t is the key of the firedancer_src_prefixes
+   LPM trie.  ip4_addr is in network byte order. */
+
+struct fd_xdp_src_prefix_key {
+  uint prefix_len; /* in [0,32] */
+  uint ip4_addr;
+};
+
+typedef struct fd_xdp_src_prefix_key fd_xdp_src_prefix_key_t;
+
+/* fd_xdp_src_bucket_t is the value of the firedancer_src_rates map,
+   keyed by source address (network byte order). */
+
+struct fd_xdp_src_bucket {
+  ulong ts_ns;     /* bpf_ktime_get_ns of the last update */
+  ulong credit_ns; /* credit as of ts_ns */
+};
+
+typedef struct fd_xdp_src_bucket fd_xdp_src_bucket_t;
+
+/* fd_xdp_src_bucket_take refills bucket up to time now (credit is
+   capped at burst_ns) and tries to take cost_ns of credit from it.
+   Returns 1 if the datagram fits in the bucket (and debits it) and 0
+   if it should be dropped.
+
+   The bucket is shared by all CPUs receiving traffic from the source
+   and is updated without atomics.  A CPU can thus observe a ts_ns
+   stored by another CPU that is newer than its own now.  Elapsed time
+   is clamped at zero in this case (a naive now-ts_ns would wrap and
+   refill the bucket, defeating the limit) and ts_ns is only ever moved
+   forward.  Concurrent updates can still lose a debit so the limit is
+   approximate under contention, but the bucket never gains credit
+   faster than wallclock time. */
+
+static inline int
+fd_xdp_src_bucket_take( fd_xdp_src_bucket_t * bucket,
+                        ulong                 now,
+                        ulong                 cost_ns,
+                        ulong                 burst_ns ) {
+  ulong ts_ns   = bucket->ts_ns;
+  ulong elapsed = now>ts_ns ? now-ts_ns : 0UL;
+  if( elapsed>burst_ns ) elapsed = burst_ns; /* no overflow below */
+  ulong credit  = bucket->credit_ns + elapsed;
+  if( credit>burst_ns ) credit = burst_ns;
+  if( now>bucket->ts_ns ) bucket->ts_ns = now;
+  if( credit<cost_ns ) {
+    bucket->credit_ns = credit;
+    return 0;
+  }
+  bucket->credit_ns = credit - cost_ns;
+  return 1;
+}
+
+#endif /* HEADER_fd_src_tango_xdp_fd_xdp_redirect_prog_h */
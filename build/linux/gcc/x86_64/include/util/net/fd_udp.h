@@ -0,0 +1,72 @@
+#ifndef HEADER_fd_src_util_net_fd_udp_h
+#define HEADER_fd_src_util_net_fd_udp_h
+
+#include "fd_ip4.h" /* UDP is tightly tied to IP regardless of standard intent due to pseudo header layer violating BS */
+
+/* FIXME: UDP CRASH COURSE HERE */
+
+union fd_udp_hdr {
+  struct {
+    ushort net_sport; /* src port, net order */
+    ushort net_dport; /* dst port, net order */
+    ushort net_len;   /* datagram length, from first byte of this header to last byte of the udp payload */
+    ushort check;     /* UDP checksum ("invariant" order), from first byte of pseudo header prepended before this header to last
+                         byte of udp payload with zero padding to even length inclusive.  In IP4, 0 indicates no checksum. */
+  };
+  uint u[2];
+};
+
+typedef union fd_udp_hdr fd_udp_hdr_t;
+
+/* FIXME: CONSIDER A PRETTY PRINTER FOR A FD_UDP_HDR? */
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_ip4_udp_check is used for udp check field computation and
+   validation.  If the dgram has no checksum (check==0), this returns
+   the value to use for check.  If the dgram has a checksum (check!=0),
+   this returns 0 if the message has a valid checksum or non-zero if
+   not.  ip4_saddr and ip4_daddr are the ip4 source and destination
+   addresses to use for the udp pseudo header.  udp is a non-NULL
+   pointer to the first byte of a memory region containing the udp
+   header and dgram is a non-NULL pointer to the first byte of a memory
+   region containing a datagram of size:
+
+     dgram_sz = fd_ushort_bswap(udp->net_len) - sizeof(fd_udp_hdr_t)
+
+   bytes.  No bytes past the end of dgram are read and dgram has no
+   alignment requirements.  The datagram is summed with
+   fd_ip4_csum_append (AVX2 accelerated on FD_HAS_AVX targets).
+
+   UDP checksums are not particularly robust and can inhibit
+   cut-through usage.  So in general it is best to avoid them, usually
+   by exploiting their optionality in IP4 (note that the Ethernet CRC
+   is reasonably strong and still provides protection) or by relying on
+   NIC checksum offload.  This is here for applications that need to
+   compute / validate UDP checksums in software (e.g. when the hardware
+   sending/receiving the packet doesn't do checksum offload and UDP
+   checksums are required). */
+
+FD_FN_PURE static inline ushort
+fd_ip4_udp_check( uint                 ip4_saddr,
+                  uint                 ip4_daddr,
+                  fd_udp_hdr_t const * udp,
+                  void const *         dgram ) {
+  ushort net_len = udp->net_len; /* In net order */
+  ulong  rem     = (ulong)fd_ushort_bswap( net_len ) - sizeof(fd_udp_hdr_t);
+
+  /* Sum the pseudo header and UDP header words */
+  uint const * u = udp->u;
+  ulong ul = ((((ulong)FD_IP4_HDR_PROTOCOL_UDP)<<8) | (((ulong)net_len)<<16))
+           + ((ulong)ip4_saddr)
+           + ((ulong)ip4_daddr)
+           + ((ulong)u[0])
+           + ((ulong)u[1]);
+
+  /* Sum the dgram words, reduce and complement */
+  return fd_ip4_csum_fold( fd_ip4_csum_append( ul, dgram, rem ) );
+}
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_util_net_fd_udp_h */
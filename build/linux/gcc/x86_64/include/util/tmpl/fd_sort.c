@@ -0,0 +1,1102 @@
+/* Declares a family of functions useful for single threaded sorting of
+   POD types in high performance contexts.  Example usage:
+
+     #define SORT_NAME        sort_double_descend
+     #define SORT_KEY_T       double
+     #define SORT_BEFORE(a,b) (a)>(b)
+     #include "util/tmpl/fd_sort.c"
+
+   will create the following API for use in the local compile unit:
+
+     // Sort key[i] for i in [0,cnt) stable in place in a best / average
+     // worst case of O(N) / O(N^2) / O(N^2) operations.
+
+     double *
+     sort_double_descend_insert( double * key,
+                                 ulong    cnt );
+
+     // Return 1 if cnt is a sensible value for the stable sorting APIs
+     // (i.e. cnt*sizeof(double)+alignof(double)-1 will not overflow).  
+
+     int sort_double_descend_stable_cnt_valid( ulong cnt );
+
+     // Return the alignment and footprint required for a scratch region
+     // adequate for sorting up to cnt elements.  The results will be
+     // standard allocator and standard declaration friendly.  (E.g. a
+     // declaration "double scratch[ cnt ];" will be fine as a scratch
+     // region.)
+
+     ulong sort_double_descend_stable_scratch_align    ( void      );
+     ulong sort_double_descend_stable_scratch_footprint( ulong cnt );
+
+     // Sort key[i] for i in [0,cnt) stable in best / average / worst
+     // case of O(N lg N) / O(N lg N) / O(N lg N) operations.  Scratch
+     // is a scratch workspace of suitable alignment and footprint.
+     // Returns where the sorted values ended up.  Will be at either key
+     // or (double *)scratch.
+
+     double *
+     sort_double_descend_stable_fast( double * key,
+                                      ulong    cnt,
+                                      void   * scratch );
+
+     // Same as above but does additional copying if necessary such that
+     // the final result ends up in key.  Returns key.
+
+     double *
+     sort_double_descend_stable( double * key,
+                                 ulong    cnt,
+                                 void *   scratch );
+
+     // Sort key[i] for i in [0,cnt) inplace in best / average / worst
+     // case of O(N lg N) / O(N lg N) / O(N^2) operations.  Returns key.
+
+     double *
+     sort_double_inplace( double * key,
+                          ulong    cnt );
+
+     // Partially sort key[i] such that key[rnk] holds rnk and return
+     // key[rnk] in best / average / worst of O(N) / O(N) / O(N^2)
+     // operations.  Returns key.  Assumes key is non-NULL, cnt is valid
+     // and positive and rnk is in [0,cnt)
+
+     double *
+     sort_double_select( double * key,
+                         ulong    cnt,
+                         ulong    rnk );
+
+   If SORT_RADIX_KEY is defined (see below), the following API is also
+   created:
+
+     // Sort key[i] for i in [0,cnt) stable in best / average / worst
+     // case of O(N) / O(N) / O(N) operations (an LSD radix sort with
+     // 8-bit digits that skips digits where all keys are the same).
+     // Scratch is a scratch workspace suitable for the stable sorts
+     // above.  Returns where the sorted values ended up.  Will be at
+     // either key or (double *)scratch.
+
+     double *
+     sort_double_descend_radix_fast( double * key,
+                                     ulong    cnt,
+                                     void *   scratch );
+
+     // Same as above but does additional copying if necessary such that
+     // the final result ends up in key.  Returns key.
+
+     double *
+     sort_double_descend_radix( double * key,
+                                ulong    cnt,
+                                void *   scratch );
+
+   If SORT_PARALLEL is non-zero (see below), the following API is also
+   created:
+
+     // Same as sort_double_descend_stable but uses the caller and the
+     // tiles [tile0,tile1) as workers of the fd_tpool tpool.  Blocks
+     // are sorted in parallel with the above and then merged in
+     // parallel (each merge is split into segments that are placed by
+     // binary search such that all workers can help with the final
+     // merges).  Returns key.
+
+     double *
+     sort_double_descend_stable_para( fd_tpool_t * tpool,
+                                      ulong        tile0,
+                                      ulong        tile1,
+                                      double *     key,
+                                      ulong        cnt,
+                                      void *       scratch );
+
+   It is fine to include this template multiple times in a compilation
+   unit.  Just provide the specification before each inclusion.  Various
+   additional options to tune the methods are described below. */
+
+#include "../bits/fd_bits.h"
+
+/* SORT_NAME gives the name of the function to declare (and the base
+   name of auxiliary and/or variant functions). */
+
+#ifndef SORT_NAME
+#error "SORT_NAME must be defined"
+#endif
+
+/* SORT_KEY_T gives the POD datatype to sort. */
+
+#ifndef SORT_KEY_T
+#error "SORT_KEY_T must be defined"
+#endif
+
+/* SORT_IDX_T gives the data type used to index the arrays */
+
+#ifndef SORT_IDX_T
+#define SORT_IDX_T ulong
+#endif
+
+/* SORT_BEFORE(a,b) evaluates to 1 if a<b is strictly true. */
+
+#ifndef SORT_BEFORE
+#define SORT_BEFORE(a,b) (a)<(b)
+#endif
+
+/* SORT_MERGE_THRESH / SORT_QUICK_THRESH give largest merge/quick
+   partition size where insertion sort will be used.  Should be at least
+   2 (and probably larger than one might expect to get optimal
+   performance). */
+
+#ifndef SORT_MERGE_THRESH
+#define SORT_MERGE_THRESH 32
+#endif
+
+#ifndef SORT_QUICK_THRESH
+#define SORT_QUICK_THRESH 32
+#endif
+
+/* SORT_QUICK_ORDER_STYLE selects the method used for ordering two keys.
+   Roughly, say 1 for floating point keys (see quick method for
+   details). */
+
+#ifndef SORT_QUICK_ORDER_STYLE
+#define SORT_QUICK_ORDER_STYLE 0
+#endif
+
+/* SORT_QUICK_SWAP_MINIMIZE indicates that quick sort should eat the
+   non-deterministic branch cost to avoid no-op swaps.  This is useful
+   if the key_t has a large memory footprint such that the no-op is
+   actually a larger cost than a branch mispredict. */
+
+#ifndef SORT_QUICK_SWAP_MINIMIZE
+#define SORT_QUICK_SWAP_MINIMIZE 0
+#endif
+
+/* SORT_RADIX_KEY(k), if defined, maps a key to a ulong such that
+   SORT_BEFORE(a,b) is equivalent to SORT_RADIX_KEY(a)<SORT_RADIX_KEY(b).
+   This enables the radix sort APIs.  fd_sort_radix_key_{long,ulong,
+   double,...} below give the mappings for the usual primitive types
+   (e.g. for an descending sort of doubles, use
+   ~fd_sort_radix_key_double(k)).  Keys narrower than 64-bits should
+   map to small values to benefit from the skipping of digits where all
+   keys are the same. */
+
+/* SORT_NETWORK indicates that quick sort and select should sort small
+   partitions with AVX2 bitonic sorting networks instead of insertion
+   sort.  Only supported for keys that are 64-bit primitives sorted in
+   ascending order:
+     0 - use insertion sort (default)
+     1 - SORT_KEY_T is a long   and SORT_BEFORE(a,b) is (a)<(b)
+     2 - SORT_KEY_T is a ulong  and SORT_BEFORE(a,b) is (a)<(b)
+     3 - SORT_KEY_T is a double and SORT_BEFORE(a,b) is (a)<(b) (no NaN)
+   Ignored on targets without FD_HAS_AVX.  The networks handle
+   partitions of up to 32 keys (SORT_QUICK_THRESH should be at most 32
+   to use them for all small partitions). */
+
+#ifndef SORT_NETWORK
+#define SORT_NETWORK 0
+#endif
+
+/* SORT_PARALLEL indicates the parallel APIs should be created (requires
+   fd_tpool).  SORT_PARALLEL_THRESH gives the largest cnt that the
+   parallel APIs sort on the caller alone. */
+
+#ifndef SORT_PARALLEL
+#define SORT_PARALLEL 0
+#endif
+
+#ifndef SORT_PARALLEL_THRESH
+#define SORT_PARALLEL_THRESH 16384UL
+#endif
+
+#if SORT_PARALLEL
+#include "../tpool/fd_tpool.h"
+#endif
+
+/* 0 - local use only
+   1 - library header declaration
+   2 - library implementation */
+
+#ifndef SORT_IMPL_STYLE
+#define SORT_IMPL_STYLE 0
+#endif
+
+/* SORT_IDX_IF(c,t,f) returns sort_idx t if c is non-zero and sort_idx f o.w. */
+
+#ifndef SORT_IDX_IF
+#define SORT_IDX_IF(c,t,f) ((SORT_IDX_T)fd_ulong_if( (c), (ulong)(t), (ulong)(f) ))
+#endif
+
+/**********************************************************************/
+
+#ifndef HEADER_fd_src_util_tmpl_fd_sort_private
+#define HEADER_fd_src_util_tmpl_fd_sort_private
+
+/* fd_sort_radix_key_* map primitive types to ulongs that preserve the
+   ascending order of the type (for floating point, -0 is before +0 and
+   NaN are not supported). */
+
+FD_FN_CONST static inline ulong fd_sort_radix_key_uchar ( uchar  k ) { return (ulong)k; }
+FD_FN_CONST static inline ulong fd_sort_radix_key_ushort( ushort k ) { return (ulong)k; }
+FD_FN_CONST static inline ulong fd_sort_radix_key_uint  ( uint   k ) { return (ulong)k; }
+FD_FN_CONST static inline ulong fd_sort_radix_key_ulong ( ulong  k ) { return k;        }
+FD_FN_CONST static inline ulong fd_sort_radix_key_schar ( schar  k ) { return (ulong)(uchar )(k ^ (schar)SCHAR_MIN); }
+FD_FN_CONST static inline ulong fd_sort_radix_key_short ( short  k ) { return (ulong)(ushort)(k ^ (short)SHRT_MIN ); }
+FD_FN_CONST static inline ulong fd_sort_radix_key_int   ( int    k ) { return (ulong)((uint)k ^ (1U <<31)); }
+FD_FN_CONST static inline ulong fd_sort_radix_key_long  ( long   k ) { return (ulong)k ^ (1UL<<63); }
+
+FD_FN_CONST static inline ulong
+fd_sort_radix_key_float( float k ) {
+  union { float f; uint u; } t; t.f = k;
+  return (ulong)(t.u ^ ((uint)(((int)t.u)>>31) | (1U<<31)));
+}
+
+#if FD_HAS_DOUBLE
+FD_FN_CONST static inline ulong
+fd_sort_radix_key_double( double k ) {
+  union { double f; ulong u; } t; t.f = k;
+  return t.u ^ ((ulong)(((long)t.u)>>63) | (1UL<<63));
+}
+#endif
+
+#if FD_HAS_AVX
+
+#include <x86intrin.h>
+
+/* FD_SORT_PRIVATE_CE does a compare exchange of the 4 signed 64-bit
+   lanes of a and b (a gets the lane-wise min and b the max). */
+
+#define FD_SORT_PRIVATE_CE(a,b) do {                          \
+    __m256i _gt = _mm256_cmpgt_epi64( (a), (b) );              \
+    __m256i _lo = _mm256_blendv_epi8( (a), (b), _gt );         \
+    (b)         = _mm256_blendv_epi8( (b), (a), _gt );         \
+    (a)         = _lo;                                         \
+  } while(0)
+
+/* fd_sort_private_net_clean sorts the bitonic sequence held in the 4
+   lanes of v. */
+
+static inline __m256i
+fd_sort_private_net_clean( __m256i v ) {
+  __m256i t; __m256i gt; __m256i lo; __m256i hi;
+  t  = _mm256_permute4x64_epi64( v, 0x4E ); /* Distance 2 */
+  gt = _mm256_cmpgt_epi64( v, t );
+  lo = _mm256_blendv_epi8( v, t, gt );
+  hi = _mm256_blendv_epi8( t, v, gt );
+  v  = _mm256_blend_epi32( lo, hi, 0xF0 );
+  t  = _mm256_permute4x64_epi64( v, 0xB1 ); /* Distance 1 */
+  gt = _mm256_cmpgt_epi64( v, t );
+  lo = _mm256_blendv_epi8( v, t, gt );
+  hi = _mm256_blendv_epi8( t, v, gt );
+  return _mm256_blend_epi32( lo, hi, 0xCC );
+}
+
+/* fd_sort_private_net sorts the 4*reg_cnt signed 64-bit values in the
+   32-byte aligned buf in ascending order with a bitonic sorting
+   network.  reg_cnt should be a compile time constant 4 or 8.  Groups
+   of 4 registers are sorted column-wise and transposed such that each
+   register holds a sorted run of 4, then runs are repeatedly bitonic
+   merged. */
+
+static inline void
+fd_sort_private_net( long * buf,
+                     ulong  reg_cnt ) {
+  __m256i r[8];
+  for( ulong i=0UL; i<reg_cnt; i++ ) r[i] = _mm256_load_si256( (__m256i const *)(buf + 4UL*i) );
+
+  for( ulong g=0UL; g<reg_cnt; g+=4UL ) {
+    FD_SORT_PRIVATE_CE( r[g    ], r[g+1UL] ); FD_SORT_PRIVATE_CE( r[g+2UL], r[g+3UL] );
+    FD_SORT_PRIVATE_CE( r[g    ], r[g+2UL] ); FD_SORT_PRIVATE_CE( r[g+1UL], r[g+3UL] );
+    FD_SORT_PRIVATE_CE( r[g+1UL], r[g+2UL] );
+    __m256i t0 = _mm256_unpacklo_epi64( r[g    ], r[g+1UL] );
+    __m256i t1 = _mm256_unpackhi_epi64( r[g    ], r[g+1UL] );
+    __m256i t2 = _mm256_unpacklo_epi64( r[g+2UL], r[g+3UL] );
+    __m256i t3 = _mm256_unpackhi_epi64( r[g+2UL], r[g+3UL] );
+    r[g    ] = _mm256_permute2x128_si256( t0, t2, 0x20 );
+    r[g+1UL] = _mm256_permute2x128_si256( t1, t3, 0x20 );
+    r[g+2UL] = _mm256_permute2x128_si256( t0, t2, 0x31 );
+    r[g+3UL] = _mm256_permute2x128_si256( t1, t3, 0x31 );
+  }
+
+  for( ulong w=1UL; w<reg_cnt; w<<=1 ) { /* Merge runs of w registers */
+    for( ulong b=0UL; b<reg_cnt; b+=2UL*w ) {
+      __m256i t[4];
+      for( ulong i=0UL; i<w; i++ ) t[i] = _mm256_permute4x64_epi64( r[b+2UL*w-1UL-i], 0x1B ); /* Reverse the right run */
+      for( ulong i=0UL; i<w; i++ ) { FD_SORT_PRIVATE_CE( r[b+i], t[i] ); r[b+w+i] = t[i]; }
+      for( ulong d=w>>1; d; d>>=1 )
+        for( ulong i=b; i<b+2UL*w; i++ ) if( !(i & d) ) FD_SORT_PRIVATE_CE( r[i], r[i+d] );
+      for( ulong i=b; i<b+2UL*w; i++ ) r[i] = fd_sort_private_net_clean( r[i] );
+    }
+  }
+
+  for( ulong i=0UL; i<reg_cnt; i++ ) _mm256_store_si256( (__m256i *)(buf + 4UL*i), r[i] );
+}
+
+#endif /* FD_HAS_AVX */
+
+#endif /* HEADER_fd_src_util_tmpl_fd_sort_private */
+
+#define SORT_(x)FD_EXPAND_THEN_CONCAT3(SORT_NAME,_,x)
+
+#if SORT_IMPL_STYLE==1 /* need prototypes */
+
+SORT_KEY_T *
+SORT_(private_merge)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt,
+                      SORT_KEY_T * tmp );
+
+SORT_KEY_T *
+SORT_(private_quick)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt );
+
+SORT_KEY_T *
+SORT_(private_select)( SORT_KEY_T * key,
+                       SORT_IDX_T   cnt,
+                       SORT_IDX_T   rnk );
+
+#ifdef SORT_RADIX_KEY
+SORT_KEY_T *
+SORT_(private_radix)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt,
+                      SORT_KEY_T * tmp );
+#endif
+
+#if SORT_PARALLEL
+SORT_KEY_T *
+SORT_(stable_para)( fd_tpool_t * tpool,
+                    ulong        tile0,
+                    ulong        tile1,
+                    SORT_KEY_T * key,
+                    SORT_IDX_T   cnt,
+                    void *       scratch );
+#endif
+
+#else /* need implementations */
+
+#if SORT_IMPL_STYLE==0 /* local only */
+#define SORT_IMPL_STATIC static
+#else
+#define SORT_IMPL_STATIC
+#endif
+
+static SORT_KEY_T *
+SORT_(insert)( SORT_KEY_T * key,
+               SORT_IDX_T   cnt ) {
+  for( SORT_IDX_T i=((SORT_IDX_T)1); i<cnt; i++ ) {
+    SORT_KEY_T key_i = key[i];
+    SORT_IDX_T j = i;
+    while( j ) {
+      SORT_IDX_T k = j - ((SORT_IDX_T)1);
+      SORT_KEY_T key_j = key[k]; if( !(SORT_BEFORE( key_i, key_j )) ) break;
+      key[j] = key_j;
+      j = k;
+    }
+    key[j] = key_i;
+  }
+  return key;
+}
+
+/* SORT_(private_small) sorts the small partitions of quick sort and
+   select. */
+
+#if SORT_NETWORK && FD_HAS_AVX
+
+FD_STATIC_ASSERT( sizeof(SORT_KEY_T)==8UL, fd_sort_network_requires_64_bit_keys );
+
+static inline SORT_KEY_T *
+SORT_(private_small)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt ) {
+  ulong n = (ulong)cnt;
+  if( FD_UNLIKELY( n>32UL ) ) return SORT_(insert)( key, cnt );
+  if( FD_UNLIKELY( n<2UL  ) ) return key;
+
+  /* Map the keys to signed 64-bit values with the same order, pad with
+     the largest value, sort and map back */
+
+  long buf[ 32 ] __attribute__((aligned(32)));
+  ulong m = fd_ulong_if( n<=16UL, 16UL, 32UL );
+  for( ulong i=0UL; i<n; i++ ) {
+#   if SORT_NETWORK==1
+    buf[i] = (long)key[i];
+#   elif SORT_NETWORK==2
+    buf[i] = (long)(((ulong)key[i]) ^ (1UL<<63));
+#   else
+    union { SORT_KEY_T f; long u; } t; t.f = key[i];
+    buf[i] = t.u ^ (long)(((ulong)(t.u>>63))>>1);
+#   endif
+  }
+  for( ulong i=n; i<m; i++ ) buf[i] = LONG_MAX;
+  fd_sort_private_net( buf, m>>2 );
+  for( ulong i=0UL; i<n; i++ ) {
+#   if SORT_NETWORK==1
+    key[i] = (SORT_KEY_T)buf[i];
+#   elif SORT_NETWORK==2
+    key[i] = (SORT_KEY_T)(((ulong)buf[i]) ^ (1UL<<63));
+#   else
+    union { SORT_KEY_T f; long u; } t; t.u = buf[i] ^ (long)(((ulong)(buf[i]>>63))>>1);
+    key[i] = t.f;
+#   endif
+  }
+  return key;
+}
+
+#else
+
+static inline SORT_KEY_T *
+SORT_(private_small)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt ) {
+  return SORT_(insert)( key, cnt );
+}
+
+#endif
+
+/* FIXME: USE IMPLICIT RECURSION ALA QUICK BELOW? */
+
+SORT_IMPL_STATIC SORT_KEY_T *
+SORT_(private_merge)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt,
+                      SORT_KEY_T * tmp ) {
+
+  /* If below threshhold, use insertion sort */
+
+  if( cnt<=((SORT_IDX_T)(SORT_MERGE_THRESH)) ) return SORT_(insert)( key, cnt );
+  
+  /* Otherwise, break input in half and sort the halves */
+
+  SORT_KEY_T * key_left  = key;
+  SORT_KEY_T * tmp_left  = tmp;
+  SORT_IDX_T   cnt_left  = cnt >> 1;
+  SORT_KEY_T * out_left  = SORT_(private_merge)( key_left,  cnt_left,  tmp_left  );
+
+  SORT_KEY_T * key_right = key + cnt_left;
+  SORT_KEY_T * tmp_right = tmp + cnt_left;
+  SORT_IDX_T   cnt_right = cnt - cnt_left;
+  SORT_KEY_T * out_right = SORT_(private_merge)( key_right, cnt_right, tmp_right );
+
+  /* Merge out_left / out_right */
+
+  if( out_left==key ) key = tmp; /* If out_left overlaps with key, merge into tmp.  Otherwise, merge into key */
+
+  /* Note that out_left does not overlap with the location for merge
+     output at this point.  out_right might overlap (with the right
+     half) with the location for merge output but this will still work
+     in that case.  */
+
+  SORT_IDX_T i = ((SORT_IDX_T)0);
+  SORT_IDX_T j = ((SORT_IDX_T)0);
+  SORT_IDX_T k = ((SORT_IDX_T)0);
+# if 1 /* Minimal C language operations */
+  for(;;) { /* Note that cnt_left>0 and cnt_right>0 as cnt > SORT_MERGE_THRESH >= 1 at this point */
+    if( SORT_BEFORE( out_right[k], out_left[j] ) ) {
+      key[i++] = out_right[k++];
+      if( k>=cnt_right ) {
+        do key[i++] = out_left [j++]; while( j<cnt_left  ); /* append left  stragglers (at least one) */
+        break;
+      }
+    } else {
+      key[i++] = out_left [j++];
+      if( j>=cnt_left  ) {
+        do key[i++] = out_right[k++]; while( k<cnt_right ); /* append right stragglers (at least one) */
+        break;
+      }
+    }
+  }
+# else /* Branch free variant (Pyth investigations suggested the above is better) */
+  for(;;) { /* Note that cnt_left>0 and cnt_right>0 as cnt > SORT_MERGE_THRESH >= 1 at this point */
+    SORT_KEY_T out_j = out_left [j];
+    SORT_KEY_T out_k = out_right[k];
+    int from_right = (SORT_BEFORE( out_k, out_j ));
+    key[i++] = from_right ? out_k : out_j; FD_COMPILER_FORGET( from_right );
+    j += (SORT_IDX_T)(from_right^1);       FD_COMPILER_FORGET( from_right );
+    k += (SORT_IDX_T) from_right;
+    int c = (j<cnt_left) & (k<cnt_right); FD_COMPILER_FORGET( c ); /* prevent compiler from branch nesting the compares */
+    if( !c ) break;
+  }
+  for( ; j<cnt_left;  j++ ) key[i++] = out_left [j];
+  for( ; k<cnt_right; k++ ) key[i++] = out_right[k];
+# endif
+
+  return key;
+}
+
+/* This uses a dual pivot quick sort for better theoretical and
+   practical mojo. */
+
+SORT_IMPL_STATIC SORT_KEY_T *
+SORT_(private_quick)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt ) {
+  SORT_IDX_T stack[ 4UL*8UL*sizeof(SORT_IDX_T) ]; /* See note below on sizing */
+  ulong      stack_cnt = 0UL;
+
+  stack[ stack_cnt++ ] = (SORT_IDX_T)0;
+  stack[ stack_cnt++ ] = cnt;
+  for(;;) {
+
+    /* Pop the next partition to process */
+
+    if( !stack_cnt ) return key; /* All done */
+    SORT_IDX_T h = stack[ --stack_cnt ];
+    SORT_IDX_T l = stack[ --stack_cnt ];
+
+    /* [l,h) is the partition we are sorting.  If this partition is
+       small enough, sort it via insertion sort. */
+
+    SORT_IDX_T n = h-l;
+    if( FD_LIKELY( n <= ((SORT_IDX_T)(SORT_QUICK_THRESH)) ) ) {
+      SORT_(private_small)( key+l, n );
+      continue;
+    }
+
+    /* This partition is too large to insertion sort.  Pick two pivots,
+       sort the partition into a left, center and right partition and
+       then recursively sort those partitions.  We initially use a
+       simple choice of pivots that is ideal for nearly sorted data (in
+       either direction) with a little extra sampling to improve the
+       partitioning for randomly ordered data.  There is a possibility
+       that this deterministic choice of pivots will not suceeed in
+       making two or more non-empty partitions; we detect and correct
+       that below. */
+
+    /* Initial pivot selection */
+
+    SORT_KEY_T p1;
+    SORT_KEY_T p2;
+    do {
+      SORT_IDX_T n3 = n / (SORT_IDX_T)3; /* magic multiply under the hood typically */
+      SORT_IDX_T h1 = h - (SORT_IDX_T)1;
+      SORT_KEY_T p0 = key[ l       ];
+      /**/       p1 = key[ l  + n3 ];
+      /**/       p2 = key[ h1 - n3 ];
+      SORT_KEY_T p3 = key[ h1      ];
+#     if SORT_QUICK_ORDER_STYLE==0
+      /* Generates better code for integral types (branchless via stack) */
+      SORT_KEY_T _k[2]; ulong _c;
+#     define ORDER(k0,k1) _k[0] = k0; _k[1] = k1; _c = (ulong)(SORT_BEFORE(k1,k0)); k0 = _k[_c]; k1 = _k[_c^1UL];
+#     else
+      /* Generates much better code for floating point types (branchless
+         via min / max floating point instructions) */
+      SORT_KEY_T _k0; SORT_KEY_T _k1; int _c;
+#     define ORDER(k0,k1) _c = (SORT_BEFORE(k1,k0)); _k0 = _c ? k1 : k0; _k1 = _c ? k0 : k1; k0 = _k0; k1 = _k1;
+#     endif
+
+      ORDER(p0,p2); ORDER(p1,p3);
+      ORDER(p0,p1); ORDER(p2,p3);
+      ORDER(p1,p2);
+#     undef ORDER
+    } while(0);
+
+  retry: /* Three way partitioning (silly language restriction) */;
+    SORT_IDX_T i = l;
+    SORT_IDX_T j = l;
+    SORT_IDX_T k = h-(SORT_IDX_T)1;
+    do { /* Note [j,k] is non-empty (look ma ... no branches!) */
+
+      /* At this point, p1 <= p2 and:
+         - keys [l,i) are before p1 (left partition)
+         - keys [i,j) are in [p1,p2] (center partition)
+         - keys [j,k] are not yet partitioned (region is non-empty)
+         - keys (k,h) are after p2 (right partition)
+         Decide where key j should be moved. */
+
+      SORT_KEY_T kj = key[j];
+
+      int to_left  = (SORT_BEFORE( kj, p1 ));
+      int to_right = (SORT_BEFORE( p2, kj ));
+      SORT_IDX_T m = SORT_IDX_IF( to_right, k, SORT_IDX_IF( to_left, i, j ) );
+
+#     if SORT_QUICK_SWAP_MINIMIZE
+      if( FD_LIKELY( j!=h ) ) { key[j] = key[m]; key[m] = kj; } /* ~2/3 prob */
+#     else
+      /**/                      key[j] = key[m]; key[m] = kj;
+#     endif
+
+      i += (SORT_IDX_T) to_left;
+      j += (SORT_IDX_T)(to_right^1); /* to_left_or_to_center <=> !to_right */
+      k -= (SORT_IDX_T) to_right;
+    } while( j<=k );
+
+    /* Schedule recursion */
+
+    if( FD_UNLIKELY( (j-i)==n ) ) {
+
+      /* All the keys ended up in the center partition.  If p1<p2, we
+         had an unlucky choice of pivots such that p1==min(key[i]) and
+         p2==max(key[i]) for i in [l,h).  Since we picked the keys
+         deterministically above, we would have the same bad luck the
+         next time we processed this partition.  But, because there are
+         at least two distinct elements in the partition, there is a
+         choice of pivots that will make a non-trivial partition, so we
+         need to redo this partition with different pivots.
+
+         Randomly picking a new pivot pair in [l,h) has probability
+         between ~50% and ~100%.  The worst case is half the keys in
+         the partition equal to p1 and the other half equal to p2; the
+         best case exactly one key is equal to p1 / p2 and all other
+         keys are in (p1,p2] / [p1,p2).
+
+         The optimal handling of the worst case though is just to set
+         p1=p2 (p2=p1).  This will pull the keys equal to p1 (p2) into
+         the left (right) partition and the remaining keys into the
+         center partition; the right (left) partition will be empty.
+         Thus, this is guaranteed to yield a non-trivial partition of
+         the center partition but may not yield as load balanced set of
+         partitions as random for the next iteration.  We go with the
+         deterministic option for simplicity below. */
+
+      if( FD_UNLIKELY( (SORT_BEFORE( p1, p2 )) ) ) { p1 = p2; goto retry; }
+
+      /* p1==p2 here ... all keys in this partition are the same
+         We don't need to recurse further in this partition. */
+
+    } else {
+
+      /* Between [1,n-1] keys ended up in the center partition such that
+         at least 1 key ended up in another partition.  We push all
+         three partitions onto the partition stack for recursion.  The
+         order of the pushes is important to bound the maximum stack
+         usage.  Below, we push the center partition followed by the
+         larger of the left and right partitions then followed by the
+         smaller of the left and right partitions (such that we process
+         the smallest next iteration).  For this, the same O(log_2 cnt)
+         max recusion depth applies as quicksort even this does a three
+         way partitioning.  That is, let fl/fc/fr be the fraction of
+         keys in the left, center, right partitions.  At this point, fl
+         is in [0,1), fc is in (0,1) and fr is in [0,1) and fl+fc+fr=1.
+         The smaller of the left or right partition is what process next
+         and, as the smaller of the left or right, it fraction of the
+         keys is at most 0.5(1-fc)<=0.5.  We do push up to two
+         partitions onto the stack (four SORT_IDX_T) each level of
+         recursion though instead of one like normal quick sort though. */
+
+      int left_larger = (i-l) > (h-j); /* True if the left partition should go on the stack */
+      SORT_IDX_T l_larger  = SORT_IDX_IF( left_larger, l, j );
+      SORT_IDX_T h_larger  = SORT_IDX_IF( left_larger, i, h );
+      SORT_IDX_T l_smaller = SORT_IDX_IF( left_larger, j, l );
+      SORT_IDX_T h_smaller = SORT_IDX_IF( left_larger, h, i );
+
+      /* Immediately process empty partitions */
+      ulong push_smaller = (ulong)(l_smaller<h_smaller); FD_COMPILER_FORGET( push_smaller );
+
+      /* Immediately process partitions where all keys are the same */
+      ulong push_center  = (ulong)(SORT_BEFORE( p1, p2 )); FD_COMPILER_FORGET( push_center );
+
+      /* Guaranteed non-empty (larger of left or right have at least 1 key) */
+      ulong push_larger  = 1UL;
+
+      stack[ stack_cnt ] = l_larger;  stack_cnt += push_larger;
+      stack[ stack_cnt ] = h_larger;  stack_cnt += push_larger;
+      stack[ stack_cnt ] = i;         stack_cnt += push_center;
+      stack[ stack_cnt ] = j;         stack_cnt += push_center;
+      stack[ stack_cnt ] = l_smaller; stack_cnt += push_smaller;
+      stack[ stack_cnt ] = h_smaller; stack_cnt += push_smaller;
+    }
+  }
+  /* never get here */
+}
+
+SORT_IMPL_STATIC SORT_KEY_T *
+SORT_(private_select)( SORT_KEY_T * key,
+                       SORT_IDX_T   cnt,
+                       SORT_IDX_T   rnk ) {
+  SORT_IDX_T l = (SORT_IDX_T)0;
+  SORT_IDX_T h = cnt;
+  for(;;) {
+
+    /* The partition [l,h) contains rnk.  If this partition is small
+       enough, sort it via insertion sort. */
+
+    SORT_IDX_T n = h-l;
+    if( FD_LIKELY( n <= ((SORT_IDX_T)(SORT_QUICK_THRESH)) ) ) { SORT_(private_small)( key+l, n ); return key; }
+
+    /* This partition is too large to insertion sort.  Pick two pivots,
+       sort the partition into a left, center and right partition and
+       then recursive on the partition holding rnk.  We initially use a
+       simple choice of pivots that is ideal for nearly sorted data (in
+       either direction) with a little extra sampling to improve the
+       partitioning for randomly ordered data.  There is a possibility
+       that this deterministic choice of pivots will not succeed in
+       making two or more non-empty partitions; we detect and correct
+       that below. */
+
+    /* Initial pivot selection */
+
+    SORT_KEY_T p1;
+    SORT_KEY_T p2;
+    do {
+      SORT_IDX_T n3 = n / (SORT_IDX_T)3; /* magic multiply under the hood typically */
+      SORT_IDX_T h1 = h - (SORT_IDX_T)1;
+      SORT_KEY_T p0 = key[ l       ];
+      /**/       p1 = key[ l  + n3 ];
+      /**/       p2 = key[ h1 - n3 ];
+      SORT_KEY_T p3 = key[ h1      ];
+#     if SORT_QUICK_ORDER_STYLE==0
+      /* Generates better code for integral types (branchless via stack) */
+      SORT_KEY_T _k[2]; ulong _c;
+#     define ORDER(k0,k1) _k[0] = k0; _k[1] = k1; _c = (ulong)(SORT_BEFORE(k1,k0)); k0 = _k[_c]; k1 = _k[_c^1UL];
+#     else
+      /* Generates much better code for floating point types (branchless
+         via min / max floating point instructions) */
+      SORT_KEY_T _k0; SORT_KEY_T _k1; int _c;
+#     define ORDER(k0,k1) _c = (SORT_BEFORE(k1,k0)); _k0 = _c ? k1 : k0; _k1 = _c ? k0 : k1; k0 = _k0; k1 = _k1;
+#     endif
+
+      ORDER(p0,p2); ORDER(p1,p3);
+      ORDER(p0,p1); ORDER(p2,p3);
+      ORDER(p1,p2);
+#     undef ORDER
+    } while(0);
+
+  retry: /* Three way partitioning (silly language restriction) */;
+    SORT_IDX_T i = l;
+    SORT_IDX_T j = l;
+    SORT_IDX_T k = h-(SORT_IDX_T)1;
+    do { /* Note [j,k] is non-empty (look ma ... no branches!) */
+
+      /* At this point, p1 <= p2 and:
+         - keys [l,i) are before p1 (left partition)
+         - keys [i,j) are in [p1,p2] (center partition)
+         - keys [j,k] are not yet partitioned (region is non-empty)
+         - keys (k,h) are after p2 (right partition)
+         Decide where key j should be moved. */
+
+      SORT_KEY_T kj = key[j];
+
+      int to_left  = (SORT_BEFORE( kj, p1 ));
+      int to_right = (SORT_BEFORE( p2, kj ));
+      SORT_IDX_T m = SORT_IDX_IF( to_right, k, SORT_IDX_IF( to_left, i, j ) );
+
+#     if SORT_QUICK_SWAP_MINIMIZE
+      if( FD_LIKELY( j!=h ) ) { key[j] = key[m]; key[m] = kj; } /* ~2/3 prob */
+#     else
+      /**/                   key[j] = key[m]; key[m] = kj;
+#     endif
+
+      i += (SORT_IDX_T) to_left;
+      j += (SORT_IDX_T)(to_right^1); /* to_left_or_to_center <=> !to_right */
+      k -= (SORT_IDX_T) to_right;
+    } while( j<=k );
+
+    if( FD_UNLIKELY( (j-i)==n ) ) {
+
+      /* All the keys ended up in the center partition.  If p1<p2, we
+         had an unlucky choice of pivots such that p1==min(key[i]) and
+         p2==max(key[i]) for i in [l,h).  Since we picked the keys
+         deterministically above, we would have the same bad luck the
+         next time we processed this partition.  But, because there are
+         at least two distinct elements in the partition, there is a
+         choice of pivots that will make a non-trivial partition, so we
+         need to redo this partition with different pivots.
+
+         Randomly picking a new pivot pair in [l,h) has probability
+         between ~50% and ~100%.  The worst case is half the keys in
+         the partition equal to p1 and the other half equal to p2; the
+         best case exactly one key is equal to p1 / p2 and all other
+         keys are in (p1,p2] / [p1,p2).
+
+         The optimal handling of the worst case though is just to set
+         p1=p2 (p2=p1).  This will pull the keys equal to p1 (p2) into
+         the left (right) partition and the remaining keys into the
+         center partition; the right (left) partition will be empty.
+         Thus, this is guaranteed to yield a non-trivial partition of
+         the center partition but may not yield as load balanced set of
+         partitions as random for the next iteration.  We go with the
+         deterministic option for simplicity below. */
+
+      if( FD_UNLIKELY( (SORT_BEFORE( p1, p2 )) ) ) { p1 = p2; goto retry; }
+
+      /* p1==p2 here ... all keys in this partition are the same.  We
+         don't need to recurse further in this partition as all keys
+         would do here. */
+
+      return key;
+    }
+
+    /* At this point:
+       - [l,i) is the left partition,
+       - [i,j) is the center partition
+       - [j,h) is the right partition
+       Between [1,n-1] keys ended up in the center partition such that
+       at least 1 key ended up in another partition.  Recurse on the
+       partition that contains rnk.  As this is typically used in median
+       finding, we assume that the center partition is the most likely
+       in the below selection (this can also be done branchlessly). */
+
+    SORT_IDX_T l_next = i; SORT_IDX_T h_next = j;
+    if( FD_UNLIKELY( rnk< i   ) ) l_next = l, h_next = i;
+    if( FD_UNLIKELY( j  <=rnk ) ) l_next = j, h_next = h;
+    l = l_next; h = h_next;
+  }
+  /* never get here */
+}
+
+#ifdef SORT_RADIX_KEY
+
+/* This is an LSD radix sort with 8-bit digits.  All the digit
+   histograms are computed in a single pass up front.  Passes for
+   digits where all keys have the same value are skipped (such that
+   sorting narrow or clustered keys is cheap). */
+
+SORT_IMPL_STATIC SORT_KEY_T *
+SORT_(private_radix)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt,
+                      SORT_KEY_T * tmp ) {
+  ulong n = (ulong)cnt;
+  if( FD_UNLIKELY( n<2UL ) ) return key;
+
+  ulong hist[ 8 ][ 256 ];
+  memset( hist, 0, sizeof(hist) );
+  for( ulong i=0UL; i<n; i++ ) {
+    ulong r = (ulong)(SORT_RADIX_KEY( key[i] ));
+    for( ulong d=0UL; d<8UL; d++ ) hist[ d ][ (r >> (8UL*d)) & 255UL ]++;
+  }
+
+  ulong        r0  = (ulong)(SORT_RADIX_KEY( key[0] ));
+  SORT_KEY_T * src = key;
+  SORT_KEY_T * dst = tmp;
+  for( ulong d=0UL; d<8UL; d++ ) {
+    ulong   shift = 8UL*d;
+    ulong * h     = hist[ d ];
+    if( h[ (r0 >> shift) & 255UL ]==n ) continue; /* All keys have the same digit */
+
+    ulong sum = 0UL;
+    for( ulong b=0UL; b<256UL; b++ ) { ulong c = h[b]; h[b] = sum; sum += c; }
+
+    for( ulong i=0UL; i<n; i++ ) {
+      SORT_KEY_T k = src[i];
+      dst[ h[ (((ulong)(SORT_RADIX_KEY( k ))) >> shift) & 255UL ]++ ] = k;
+    }
+
+    SORT_KEY_T * t = src; src = dst; dst = t;
+  }
+  return src;
+}
+
+#endif
+
+#if SORT_PARALLEL
+
+/* A SORT_(private_para_t) describes a pass of SORT_(stable_para).  The
+   pass reads runs of width keys from src and writes runs of 2*width
+   keys to dst.  Each pair of runs is merged as seg_per_pair segments
+   of seg_sz output keys. */
+
+struct SORT_(private_para) {
+  SORT_KEY_T * src;
+  SORT_KEY_T * dst;
+  ulong        cnt;
+  ulong        width;
+  ulong        seg_sz;
+  ulong        seg_per_pair;
+};
+
+typedef struct SORT_(private_para) SORT_(private_para_t);
+
+/* SORT_(private_para_leaf) sorts the blocks [b0,b1) of width keys in
+   place (using the same region of dst as scratch). */
+
+static void
+SORT_(private_para_leaf)( void * _ctx,
+                          ulong  b0,
+                          ulong  b1 ) {
+  SORT_(private_para_t) const * ctx = (SORT_(private_para_t) const *)_ctx;
+  for( ulong b=b0; b<b1; b++ ) {
+    ulong        i0  = b*ctx->width;
+    if( FD_UNLIKELY( i0>=ctx->cnt ) ) return; /* Trailing blocks can be empty when cnt is not a multiple of width */
+    ulong        n   = fd_ulong_min( ctx->width, ctx->cnt - i0 );
+    SORT_KEY_T * key = ctx->src + i0;
+    SORT_KEY_T * tmp = ctx->dst + i0;
+    if( SORT_(private_merge)( key, (SORT_IDX_T)n, tmp )==tmp ) memcpy( key, tmp, n*sizeof(SORT_KEY_T) );
+  }
+}
+
+/* SORT_(private_para_merge) does the merge segments [s0,s1) of a
+   pass.  The number of keys from the left run among the first k
+   outputs of a merge is found by binary search (ties go to the left run
+   for stability), so each segment can be merged independently. */
+
+static inline ulong
+SORT_(private_para_split)( SORT_KEY_T const * a,
+                           ulong              na,
+                           SORT_KEY_T const * b,
+                           ulong              nb,
+                           ulong              k ) {
+  ulong lo = k - fd_ulong_min( k, nb );
+  ulong hi = fd_ulong_min( k, na );
+  while( lo<hi ) {
+    ulong mid = (lo+hi+1UL)>>1;
+    if( SORT_BEFORE( b[ k-mid ], a[ mid-1UL ] ) ) hi = mid-1UL;
+    else                                         lo = mid;
+  }
+  return lo;
+}
+
+static void
+SORT_(private_para_merge)( void * _ctx,
+                           ulong  s0,
+                           ulong  s1 ) {
+  SORT_(private_para_t) const * ctx = (SORT_(private_para_t) const *)_ctx;
+  ulong cnt   = ctx->cnt;
+  ulong width = ctx->width;
+  for( ulong s=s0; s<s1; s++ ) {
+    ulong base = (s / ctx->seg_per_pair)*2UL*width;
+    ulong na   = fd_ulong_min( width, cnt - base );
+    ulong nb   = fd_ulong_min( width, cnt - base - na );
+    ulong o0   = (s % ctx->seg_per_pair)*ctx->seg_sz;
+    if( FD_UNLIKELY( o0>=na+nb ) ) continue;
+    ulong o1   = fd_ulong_min( o0 + ctx->seg_sz, na+nb );
+
+    SORT_KEY_T const * a  = ctx->src + base;
+    SORT_KEY_T const * b  = a + na;
+    ulong              a0 = SORT_(private_para_split)( a, na, b, nb, o0 ); ulong b0 = o0 - a0;
+    ulong              a1 = SORT_(private_para_split)( a, na, b, nb, o1 ); ulong b1 = o1 - a1;
+    SORT_KEY_T *       out = ctx->dst + base + o0;
+
+    while( (a0<a1) & (b0<b1) ) {
+      if( SORT_BEFORE( b[b0], a[a0] ) ) *out++ = b[b0++];
+      else                              *out++ = a[a0++];
+    }
+    while( a0<a1 ) *out++ = a[a0++];
+    while( b0<b1 ) *out++ = b[b0++];
+  }
+}
+
+/* SORT_(private_para_copy) copies src[i0,i1) to dst. */
+
+static void
+SORT_(private_para_copy)( void * _ctx,
+                          ulong  i0,
+                          ulong  i1 ) {
+  SORT_(private_para_t) const * ctx = (SORT_(private_para_t) const *)_ctx;
+  memcpy( ctx->dst + i0, ctx->src + i0, (i1-i0)*sizeof(SORT_KEY_T) );
+}
+
+SORT_IMPL_STATIC SORT_KEY_T *
+SORT_(stable_para)( fd_tpool_t * tpool,
+                    ulong        tile0,
+                    ulong        tile1,
+                    SORT_KEY_T * key,
+                    SORT_IDX_T   cnt,
+                    void *       scratch ) {
+  SORT_KEY_T * tmp        = (SORT_KEY_T *)scratch;
+  ulong        n          = (ulong)cnt;
+  ulong        worker_cnt = 1UL + tile1 - tile0;
+
+  if( FD_UNLIKELY( (n<=SORT_PARALLEL_THRESH) | (worker_cnt<=1UL) ) ) {
+    if( SORT_(private_merge)( key, cnt, tmp )==tmp ) memcpy( key, tmp, n*sizeof(SORT_KEY_T) );
+    return key;
+  }
+
+  /* Sort a power of two number of blocks (at least one per worker) in
+   parallel */
+
+  ulong block_cnt = fd_ulong_min( fd_ulong_pow2_up( worker_cnt ), 1UL << fd_ulong_find_msb( n / fd_ulong_max( (SORT_PARALLEL_THRESH)/2UL, 1UL ) ) );
+
+  SORT_(private_para_t) ctx[1];
+  ctx->src   = key;
+  ctx->dst   = tmp;
+  ctx->cnt   = n;
+  ctx->width = (n + block_cnt - 1UL) / block_cnt;
+  fd_tpool_for( tpool, tile0, tile1, 0UL, block_cnt, 1UL, SORT_(private_para_leaf), ctx );
+
+  /* Merge pairs of runs in parallel until there is one run */
+
+  ctx->seg_sz = fd_ulong_max( (n + 4UL*worker_cnt - 1UL) / (4UL*worker_cnt), 4096UL );
+  while( ctx->width<n ) {
+    ulong pair_cnt = (n + 2UL*ctx->width - 1UL) / (2UL*ctx->width);
+    ctx->seg_per_pair = (2UL*ctx->width + ctx->seg_sz - 1UL) / ctx->seg_sz;
+    fd_tpool_for( tpool, tile0, tile1, 0UL, pair_cnt*ctx->seg_per_pair, 1UL, SORT_(private_para_merge), ctx );
+    SORT_KEY_T * t = ctx->src; ctx->src = ctx->dst; ctx->dst = t;
+    ctx->width *= 2UL;
+  }
+
+  if( ctx->src!=key ) {
+    ctx->dst = key;
+    fd_tpool_for( tpool, tile0, tile1, 0UL, n, ctx->seg_sz, SORT_(private_para_copy), ctx );
+  }
+  return key;
+}
+
+#endif
+
+#undef SORT_IMPL_STATIC
+
+#endif
+
+#if SORT_IMPL_STYLE==0 || SORT_IMPL_STYLE==1 /* need interface */
+
+FD_FN_CONST static inline int SORT_(stable_cnt_valid)( SORT_IDX_T cnt ) {
+  /* Written funny for supporting different signed idx types without
+     generating compiler warnings */
+  SORT_IDX_T max = (SORT_IDX_T)fd_ulong_min( (-alignof(SORT_KEY_T))/sizeof(SORT_KEY_T), /* ==floor( (2^64-align-1)/sz ) */
+                                             (ulong)(SORT_IDX_T)((~0UL)>>1) );          /* ==SORT_IDX_MAX as ulong */
+  return (!cnt) | ((((SORT_IDX_T)0)<cnt) & (cnt<max)) | (cnt==max);
+}
+
+FD_FN_CONST static inline ulong SORT_(stable_scratch_align)    ( void )           { return alignof(SORT_KEY_T); } 
+FD_FN_CONST static inline ulong SORT_(stable_scratch_footprint)( SORT_IDX_T cnt ) { return sizeof (SORT_KEY_T)*(ulong)cnt; }
+
+static inline SORT_KEY_T *
+SORT_(stable_fast)( SORT_KEY_T * key,
+                    SORT_IDX_T   cnt,
+                    void *       scratch ) {
+  SORT_KEY_T * tmp = (SORT_KEY_T *)scratch;
+  return SORT_(private_merge)( key, cnt, tmp );
+}
+
+FD_FN_UNUSED static SORT_KEY_T * /* Work around -Winline */
+SORT_(stable)( SORT_KEY_T * key,
+               SORT_IDX_T   cnt,
+               void *       scratch ) {
+  SORT_KEY_T * tmp = (SORT_KEY_T *)scratch;
+  if( SORT_(private_merge)( key, cnt, tmp )==tmp ) for( SORT_IDX_T i=((SORT_IDX_T)0); i<cnt; i++ ) key[i] = tmp[i];
+  return key;
+}
+
+#ifdef SORT_RADIX_KEY
+
+static inline SORT_KEY_T *
+SORT_(radix_fast)( SORT_KEY_T * key,
+                   SORT_IDX_T   cnt,
+                   void *       scratch ) {
+  SORT_KEY_T * tmp = (SORT_KEY_T *)scratch;
+  return SORT_(private_radix)( key, cnt, tmp );
+}
+
+FD_FN_UNUSED static SORT_KEY_T * /* Work around -Winline */
+SORT_(radix)( SORT_KEY_T * key,
+              SORT_IDX_T   cnt,
+              void *       scratch ) {
+  SORT_KEY_T * tmp = (SORT_KEY_T *)scratch;
+  if( SORT_(private_radix)( key, cnt, tmp )==tmp ) for( SORT_IDX_T i=((SORT_IDX_T)0); i<cnt; i++ ) key[i] = tmp[i];
+  return key;
+}
+
+#endif
+
+static inline SORT_KEY_T *
+SORT_(inplace)( SORT_KEY_T * key,
+                SORT_IDX_T   cnt ) {
+  return SORT_(private_quick)( key, cnt );
+}
+
+static inline SORT_KEY_T *
+SORT_(select)( SORT_KEY_T * key,
+               SORT_IDX_T   cnt,
+               SORT_IDX_T   rnk ) {
+  return SORT_(private_select)( key, cnt, rnk );
+}
+
+#endif
+
+#undef SORT_
+
+#undef SORT_IDX_IF
+#undef SORT_IMPL_STYLE
+#undef SORT_NETWORK
+#undef SORT_RADIX_KEY
+#undef SORT_PARALLEL
+#undef SORT_PARALLEL_THRESH
+#undef SORT_QUICK_SWAP_MINIMIZE
+#undef SORT_QUICK_ORDER_STYLE
+#undef SORT_QUICK_THRESH
+#undef SORT_MERGE_THRESH
+#undef SORT_BEFORE
+#undef SORT_IDX_T
+#undef SORT_KEY_T
+#undef SORT_NAME
+
@@ -0,0 +1,2 @@
+CFLAGS+=-DFD_HAS_IO_URING=1
+FD_HAS_IO_URING:=1
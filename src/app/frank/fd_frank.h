@@ -56,6 +56,26 @@ int
 fd_frank_pack_task( int     argc,
                     char ** argv );
 
+/* fd_frank_lhist_pod_join joins the lhist whose gaddr is stored at
+   path in pod.  Latency histograms are optional (pods configured before
+   they existed do not have them), so this returns NULL if pod has no
+   such path.  Terminates the thread group if path is present but does
+   not refer to a valid lhist.  A non-NULL return should be paired with
+   fd_wksp_pod_unmap( fd_lhist_leave( lhist ) ). */
+
+#if FD_HAS_FRANK
+
+static inline fd_lhist_t *
+fd_frank_lhist_pod_join( uchar const * pod,
+                         char const *  path ) {
+  if( !fd_pod_query_cstr( pod, path, NULL ) ) return NULL;
+  fd_lhist_t * lhist = fd_lhist_join( fd_wksp_pod_map( pod, path ) );
+  if( FD_UNLIKELY( !lhist ) ) FD_LOG_ERR(( "fd_lhist_join failed" ));
+  return lhist;
+}
+
+#endif
+
 FD_PROTOTYPES_END
 
 #endif /* HEADER_fd_src_app_frank_fd_frank_h */
@@ -40,6 +40,12 @@ fd_frank_dedup_task( int     argc,
   ulong ** in_fseq = (ulong **)fd_alloca( alignof(ulong *), sizeof(ulong *)*in_cnt );
   if( FD_UNLIKELY( !in_fseq ) ) FD_LOG_ERR(( "fd_alloca failed" ));
 
+  fd_lhist_t ** in_lat_pub = (fd_lhist_t **)fd_alloca( alignof(fd_lhist_t *), sizeof(fd_lhist_t *)*in_cnt );
+  if( FD_UNLIKELY( !in_lat_pub ) ) FD_LOG_ERR(( "fd_alloca failed" ));
+
+  fd_lhist_t ** in_lat_orig = (fd_lhist_t **)fd_alloca( alignof(fd_lhist_t *), sizeof(fd_lhist_t *)*in_cnt );
+  if( FD_UNLIKELY( !in_lat_orig ) ) FD_LOG_ERR(( "fd_alloca failed" ));
+
   ulong in_idx = 0UL;
   for( fd_pod_iter_t iter = fd_pod_iter_init( verify_pods ); !fd_pod_iter_done( iter ); iter = fd_pod_iter_next( iter ) ) {
     fd_pod_info_t info = fd_pod_iter_info( iter );
@@ -55,6 +61,12 @@ fd_frank_dedup_task( int     argc,
     in_fseq[ in_idx ] = fd_fseq_join( fd_wksp_pod_map( verify_pod, "fseq" ) );
     if( FD_UNLIKELY( !in_fseq[ in_idx ] ) ) FD_LOG_ERR(( "fd_fseq_join failed" ));
 
+    FD_LOG_INFO(( "joining %s.verify.%s.lat_pub", cfg_path, verify_name ));
+    in_lat_pub[ in_idx ] = fd_frank_lhist_pod_join( verify_pod, "lat_pub" ); /* NULL if not configured */
+
+    FD_LOG_INFO(( "joining %s.verify.%s.lat_orig", cfg_path, verify_name ));
+    in_lat_orig[ in_idx ] = fd_frank_lhist_pod_join( verify_pod, "lat_orig" ); /* NULL if not configured */
+
     in_idx++;
   }
 
@@ -82,6 +94,19 @@ fd_frank_dedup_task( int     argc,
   fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, seed, 0UL ) );
   if( FD_UNLIKELY( !rng ) ) FD_LOG_ERR(( "fd_rng_join failed" ));
 
+  int idle_en = fd_pod_query_int( cfg_pod, "dedup.idle.enable", 0 ); /* 0 <> never idle */
+  fd_idle_t _idle[ 1 ];
+  fd_idle_t * idle = NULL;
+  if( idle_en ) {
+    long idle_spin  = fd_pod_query_long( cfg_pod, "dedup.idle.spin_ns",  -1L ); /* <0 <> use default */
+    long idle_wait  = fd_pod_query_long( cfg_pod, "dedup.idle.wait_ns",  -1L ); /* <0 <> use default */
+    long idle_sleep = fd_pod_query_long( cfg_pod, "dedup.idle.sleep_ns", -1L ); /* <0 <> use default */
+    FD_LOG_INFO(( "creating idle (%s.dedup.idle.spin_ns %li %s.dedup.idle.wait_ns %li %s.dedup.idle.sleep_ns %li)",
+                  cfg_path, idle_spin, cfg_path, idle_wait, cfg_path, idle_sleep ));
+    idle = fd_idle_join( fd_idle_new( _idle, idle_spin, idle_wait, idle_sleep ) );
+    if( FD_UNLIKELY( !idle ) ) FD_LOG_ERR(( "fd_idle_join failed" ));
+  }
+
   FD_LOG_INFO(( "creating scratch" ));
   ulong footprint = fd_dedup_tile_scratch_footprint( in_cnt, 1UL );
   if( FD_UNLIKELY( !footprint ) ) FD_LOG_ERR(( "fd_dedup_tile_scratch_footprint failed" ));
@@ -91,17 +116,25 @@ fd_frank_dedup_task( int     argc,
   /* Start deduping */
 
   FD_LOG_INFO(( "dedup run" ));
-  int err = fd_dedup_tile( cnc, in_cnt, in_mcache, in_fseq, tcache, mcache, 1UL, &out_fseq, cr_max, lazy, rng, scratch );
+  int err = fd_dedup_tile( cnc, in_cnt, in_mcache, in_fseq, in_lat_pub, in_lat_orig, tcache, mcache, 1UL, &out_fseq, cr_max, lazy, idle, rng, scratch );
   if( FD_UNLIKELY( err ) ) FD_LOG_ERR(( "fd_dedup_tile failed (%i)", err ));
 
   /* Clean up */
 
   FD_LOG_INFO(( "dedup fini" ));
+  if( idle ) {
+    for( int tier=0; tier<FD_IDLE_TIER_CNT; tier++ )
+      FD_LOG_INFO(( "dedup idle tier %i: %lu episodes, wake p50 <= %li ticks, p99 <= %li ticks", tier,
+                    fd_idle_episode_cnt( idle, tier ), fd_idle_wake_quantile( idle, tier, 0.50f ), fd_idle_wake_quantile( idle, tier, 0.99f ) ));
+    fd_idle_delete   ( fd_idle_leave  ( idle     ) );
+  }
   fd_rng_delete    ( fd_rng_leave   ( rng      ) );
   fd_wksp_pod_unmap( fd_fseq_leave  ( out_fseq ) );
   fd_wksp_pod_unmap( fd_mcache_leave( mcache   ) );
   fd_wksp_pod_unmap( fd_tcache_leave( tcache   ) );
   for( ulong in_idx=in_cnt; in_idx; in_idx-- ) {
+    if( in_lat_orig[ in_idx-1UL ] ) fd_wksp_pod_unmap( fd_lhist_leave( in_lat_orig[ in_idx-1UL ] ) );
+    if( in_lat_pub [ in_idx-1UL ] ) fd_wksp_pod_unmap( fd_lhist_leave( in_lat_pub [ in_idx-1UL ] ) );
     fd_wksp_pod_unmap( fd_fseq_leave  ( in_fseq  [ in_idx-1UL ] ) );
     fd_wksp_pod_unmap( fd_mcache_leave( in_mcache[ in_idx-1UL ] ) );
   }
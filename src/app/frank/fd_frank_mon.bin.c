@@ -222,13 +222,26 @@ printf_pct( ulong  num_now,
   /**/                 printf( ">999.999" );
 }
 
+/* printf_lat prints to stdout the q quantile of the latency histogram
+   lat (in ticks) as an age in ns (see printf_age).  Will be exactly 10
+   char wide.  Prints a dash if lat has no samples. */
+
+static void
+printf_lat( ulong const * lat,
+            ulong         cnt,
+            double        q,
+            double        ns_per_tic ) {
+  if( FD_UNLIKELY( !cnt ) ) { printf( "         -" ); return; }
+  printf_age( (long)(0.5+ns_per_tic*(double)fd_lhist_quantile( lat, q )) );
+}
+
 /**********************************************************************/
 
 /* snap reads all the IPC diagnostics in a frank instance and stores
    them into the easy to process structure snap */
 
 struct snap {
-  ulong pmap; /* Bit {0,1,2} set <> {cnc,mcache,fseq} values are valid */
+  ulong pmap; /* Bit {0,1,2,3} set <> {cnc,mcache,fseq,lat} values are valid */
 
   long  cnc_heartbeat;
   ulong cnc_signal;
@@ -251,16 +264,21 @@ struct snap {
   ulong fseq_diag_ovrnp_cnt;
   ulong fseq_diag_ovrnr_cnt;
   ulong fseq_diag_slow_cnt;
+
+  ulong * lat_pub;  /* Snapshot of the link's tspub  latency lhist bins, indexed [0,FD_LHIST_BIN_CNT) */
+  ulong * lat_orig; /* Snapshot of the link's tsorig latency lhist bins, indexed [0,FD_LHIST_BIN_CNT) */
 };
 
 typedef struct snap snap_t;
 
 static void
-snap( ulong             tile_cnt,     /* Number of tiles to snapshot */
-      snap_t *          snap_cur,     /* Snaphot for each tile, indexed [0,tile_cnt) */
-      fd_cnc_t **       tile_cnc,     /* Local cnc    joins for each tile, NULL if n/a, indexed [0,tile_cnt) */
-      fd_frag_meta_t ** tile_mcache,  /* Local mcache joins for each tile, NULL if n/a, indexed [0,tile_cnt) */
-      ulong **          tile_fseq ) { /* Local fseq   joins for each tile, NULL if n/a, indexed [0,tile_cnt) */
+snap( ulong             tile_cnt,       /* Number of tiles to snapshot */
+      snap_t *          snap_cur,       /* Snaphot for each tile, indexed [0,tile_cnt) */
+      fd_cnc_t **       tile_cnc,       /* Local cnc    joins for each tile, NULL if n/a, indexed [0,tile_cnt) */
+      fd_frag_meta_t ** tile_mcache,    /* Local mcache joins for each tile, NULL if n/a, indexed [0,tile_cnt) */
+      ulong **          tile_fseq,      /* Local fseq   joins for each tile, NULL if n/a, indexed [0,tile_cnt) */
+      fd_lhist_t **     tile_lat_pub,   /* Local tspub  lhist joins for each tile, NULL if n/a, indexed [0,tile_cnt) */
+      fd_lhist_t **     tile_lat_orig ) { /* Local tsorig lhist joins for each tile, NULL if n/a, indexed [0,tile_cnt) */
 
   for( ulong tile_idx=0UL; tile_idx<tile_cnt; tile_idx++ ) {
     snap_t * snap = &snap_cur[ tile_idx ];
@@ -310,6 +328,14 @@ snap( ulong             tile_cnt,     /* Number of tiles to snapshot */
       pmap |= 4UL;
     }
 
+    fd_lhist_t const * lat_pub  = tile_lat_pub [ tile_idx ];
+    fd_lhist_t const * lat_orig = tile_lat_orig[ tile_idx ];
+    if( FD_LIKELY( lat_pub && lat_orig ) ) {
+      fd_lhist_snap( lat_pub,  snap->lat_pub  );
+      fd_lhist_snap( lat_orig, snap->lat_orig );
+      pmap |= 8UL;
+    }
+
     snap->pmap = pmap;
   }
 }
@@ -353,7 +379,10 @@ main( int     argc,
   fd_cnc_t **       tile_cnc    = fd_alloca( alignof(fd_cnc_t *      ), sizeof(fd_cnc_t *      )*tile_cnt );
   fd_frag_meta_t ** tile_mcache = fd_alloca( alignof(fd_frag_meta_t *), sizeof(fd_frag_meta_t *)*tile_cnt );
   ulong **          tile_fseq   = fd_alloca( alignof(ulong *         ), sizeof(ulong *         )*tile_cnt );
-  if( FD_UNLIKELY( (!tile_name) | (!tile_cnc) | (!tile_mcache) | (!tile_fseq) ) ) FD_LOG_ERR(( "fd_alloca failed" )); /* paranoia */
+  fd_lhist_t **     tile_lat_pub  = fd_alloca( alignof(fd_lhist_t *  ), sizeof(fd_lhist_t *  )*tile_cnt );
+  fd_lhist_t **     tile_lat_orig = fd_alloca( alignof(fd_lhist_t *  ), sizeof(fd_lhist_t *  )*tile_cnt );
+  if( FD_UNLIKELY( (!tile_name) | (!tile_cnc) | (!tile_mcache) | (!tile_fseq) | (!tile_lat_pub) | (!tile_lat_orig) ) )
+    FD_LOG_ERR(( "fd_alloca failed" )); /* paranoia */
   
   do {
     ulong tile_idx = 0UL;
@@ -363,8 +392,10 @@ main( int     argc,
     tile_cnc[ tile_idx ] = fd_cnc_join( fd_wksp_pod_map( cfg_pod, "main.cnc" ) );
     if( FD_UNLIKELY( !tile_cnc[ tile_idx ] ) ) FD_LOG_ERR(( "fd_cnc_join failed" ));
     if( FD_UNLIKELY( fd_cnc_app_sz( tile_cnc[ tile_idx ] )<64UL ) ) FD_LOG_ERR(( "cnc app sz should be at least 64 bytes" ));
-    tile_mcache[ tile_idx ] = NULL; /* main has no mcache */
-    tile_fseq  [ tile_idx ] = NULL; /* main has no fseq */
+    tile_mcache  [ tile_idx ] = NULL; /* main has no mcache */
+    tile_fseq    [ tile_idx ] = NULL; /* main has no fseq */
+    tile_lat_pub [ tile_idx ] = NULL; /* main has no lat */
+    tile_lat_orig[ tile_idx ] = NULL; /* main has no lat */
     tile_idx++;
 
     tile_name[ tile_idx ] = "pack";
@@ -372,8 +403,10 @@ main( int     argc,
     tile_cnc[ tile_idx ] = fd_cnc_join( fd_wksp_pod_map( cfg_pod, "pack.cnc" ) );
     if( FD_UNLIKELY( !tile_cnc[ tile_idx ] ) ) FD_LOG_ERR(( "fd_cnc_join failed" ));
     if( FD_UNLIKELY( fd_cnc_app_sz( tile_cnc[ tile_idx ] )<64UL ) ) FD_LOG_ERR(( "cnc app sz should be at least 64 bytes" ));
-    tile_mcache[ tile_idx ] = NULL; /* pack has no mcache */
-    tile_fseq  [ tile_idx ] = NULL; /* pack has no fseq */
+    tile_mcache  [ tile_idx ] = NULL; /* pack has no mcache */
+    tile_fseq    [ tile_idx ] = NULL; /* pack has no fseq */
+    tile_lat_pub [ tile_idx ] = NULL; /* pack has no lat */
+    tile_lat_orig[ tile_idx ] = NULL; /* pack has no lat */
     tile_idx++;
 
     tile_name[ tile_idx ] = "dedup";
@@ -387,6 +420,10 @@ main( int     argc,
     FD_LOG_INFO(( "joining %s.dedup.fseq", cfg_path ));
     tile_fseq[ tile_idx ] = fd_fseq_join( fd_wksp_pod_map( cfg_pod, "dedup.fseq" ) );
     if( FD_UNLIKELY( !tile_fseq[ tile_idx ] ) ) FD_LOG_ERR(( "fd_fseq_join failed" ));
+    FD_LOG_INFO(( "joining %s.dedup.lat_pub", cfg_path ));
+    tile_lat_pub[ tile_idx ] = fd_frank_lhist_pod_join( cfg_pod, "dedup.lat_pub" ); /* NULL if not configured */
+    FD_LOG_INFO(( "joining %s.dedup.lat_orig", cfg_path ));
+    tile_lat_orig[ tile_idx ] = fd_frank_lhist_pod_join( cfg_pod, "dedup.lat_orig" ); /* NULL if not configured */
     tile_idx++;
 
     for( fd_pod_iter_t iter = fd_pod_iter_init( verify_pods ); !fd_pod_iter_done( iter ); iter = fd_pod_iter_next( iter ) ) {
@@ -406,6 +443,10 @@ main( int     argc,
       FD_LOG_INFO(( "joining %s.verify.%s.fseq", cfg_path, verify_name ));
       tile_fseq[ tile_idx ] = fd_fseq_join( fd_wksp_pod_map( verify_pod, "fseq" ) );
       if( FD_UNLIKELY( !tile_fseq[ tile_idx ] ) ) FD_LOG_ERR(( "fd_fseq_join failed" ));
+      FD_LOG_INFO(( "joining %s.verify.%s.lat_pub", cfg_path, verify_name ));
+      tile_lat_pub[ tile_idx ] = fd_frank_lhist_pod_join( verify_pod, "lat_pub" ); /* NULL if not configured */
+      FD_LOG_INFO(( "joining %s.verify.%s.lat_orig", cfg_path, verify_name ));
+      tile_lat_orig[ tile_idx ] = fd_frank_lhist_pod_join( verify_pod, "lat_orig" ); /* NULL if not configured */
       tile_idx++;
     }
   } while(0);
@@ -419,9 +460,20 @@ main( int     argc,
   if( FD_UNLIKELY( !snap_prv ) ) FD_LOG_ERR(( "fd_alloca failed" )); /* Paranoia */
   snap_t * snap_cur = snap_prv + tile_cnt;
 
+  /* Each snap has room for the latency histograms of its link (plus
+     one scratch histogram for computing interval quantiles) */
+
+  ulong * lat_mem = (ulong *)fd_alloca( alignof(ulong), sizeof(ulong)*(4UL*tile_cnt+1UL)*FD_LHIST_BIN_CNT );
+  if( FD_UNLIKELY( !lat_mem ) ) FD_LOG_ERR(( "fd_alloca failed" )); /* Paranoia */
+  for( ulong snap_idx=0UL; snap_idx<2UL*tile_cnt; snap_idx++ ) {
+    snap_prv[ snap_idx ].lat_pub  = lat_mem; lat_mem += FD_LHIST_BIN_CNT;
+    snap_prv[ snap_idx ].lat_orig = lat_mem; lat_mem += FD_LHIST_BIN_CNT;
+  }
+  ulong * lat_delta = lat_mem;
+
   /* Get the inital reference diagnostic snapshot */
 
-  snap( tile_cnt, snap_prv, tile_cnc, tile_mcache, tile_fseq );
+  snap( tile_cnt, snap_prv, tile_cnc, tile_mcache, tile_fseq, tile_lat_pub, tile_lat_orig );
   long then; long tic; fd_tempo_observe_pair( &then, &tic );
 
   /* Monitor for duration ns.  Note that for duration==0, this
@@ -439,7 +491,7 @@ main( int     argc,
 
     fd_log_wait_until( then + dt_min + (long)fd_rng_ulong_roll( rng, 1UL+(ulong)(dt_max-dt_min) ) );
 
-    snap( tile_cnt, snap_cur, tile_cnc, tile_mcache, tile_fseq );
+    snap( tile_cnt, snap_cur, tile_cnc, tile_mcache, tile_fseq, tile_lat_pub, tile_lat_orig );
     long now; long toc; fd_tempo_observe_pair( &now, &toc );
     
     /* Pretty print a comparison between this diagnostic snapshot and
@@ -513,6 +565,28 @@ main( int     argc,
       printf( "\n" );
     }
     printf( "\n" );
+    printf( "         link |  tspub p50 |  tspub p99 | tspub p999 | tsorig p50 | tsorig p99 | tsorig p999\n" );
+    printf( "--------------+------------+------------+------------+------------+------------+------------\n" );
+    for( ulong tile_idx=2UL; tile_idx<tile_cnt; tile_idx++ ) {
+      snap_t * prv = &snap_prv[ tile_idx ];
+      snap_t * cur = &snap_cur[ tile_idx ];
+      if( tile_idx==2UL ) printf( " %5s->%-5s", tile_name[ 2        ], tile_name[ 1 ] );
+      else                printf( " %5s->%-5s", tile_name[ tile_idx ], tile_name[ 2 ] );
+      if( FD_LIKELY( (cur->pmap & prv->pmap) & 8UL ) ) { /* Show quantiles of the latencies observed since the last snapshot */
+        ulong cnt = fd_lhist_snap_sub( lat_delta, cur->lat_pub, prv->lat_pub );
+        printf( " | " ); printf_lat( lat_delta, cnt, 0.5,   ns_per_tic );
+        printf( " | " ); printf_lat( lat_delta, cnt, 0.99,  ns_per_tic );
+        printf( " | " ); printf_lat( lat_delta, cnt, 0.999, ns_per_tic );
+        cnt = fd_lhist_snap_sub( lat_delta, cur->lat_orig, prv->lat_orig );
+        printf( " | " ); printf_lat( lat_delta, cnt, 0.5,   ns_per_tic );
+        printf( " | " ); printf_lat( lat_delta, cnt, 0.99,  ns_per_tic );
+        printf( " | " ); printf_lat( lat_delta, cnt, 0.999, ns_per_tic );
+      } else {
+        printf( " |          - |          - |          - |          - |          - |          -" );
+      }
+      printf( "\n" );
+    }
+    printf( "\n" );
 
     /* Stop once we've been monitoring for duration ns */
 
@@ -530,6 +604,8 @@ main( int     argc,
   FD_LOG_NOTICE(( "cleaning up" ));
   fd_rng_delete( fd_rng_leave( rng ) );
   for( ulong tile_idx=tile_cnt; tile_idx; tile_idx-- ) {
+    if( FD_LIKELY( tile_lat_orig[ tile_idx-1UL ] ) ) fd_wksp_pod_unmap( fd_lhist_leave( tile_lat_orig[ tile_idx-1UL ] ) );
+    if( FD_LIKELY( tile_lat_pub [ tile_idx-1UL ] ) ) fd_wksp_pod_unmap( fd_lhist_leave( tile_lat_pub [ tile_idx-1UL ] ) );
     if( FD_LIKELY( tile_fseq  [ tile_idx-1UL ] ) ) fd_wksp_pod_unmap( fd_fseq_leave  ( tile_fseq  [ tile_idx-1UL ] ) );
     if( FD_LIKELY( tile_mcache[ tile_idx-1UL ] ) ) fd_wksp_pod_unmap( fd_mcache_leave( tile_mcache[ tile_idx-1UL ] ) );
     if( FD_LIKELY( tile_cnc   [ tile_idx-1UL ] ) ) fd_wksp_pod_unmap( fd_cnc_leave   ( tile_cnc   [ tile_idx-1UL ] ) );
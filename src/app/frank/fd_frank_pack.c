@@ -45,6 +45,12 @@ fd_frank_pack_task( int     argc,
   fd_wksp_t * wksp = fd_wksp_containing( mcache );
   if( FD_UNLIKELY( !wksp ) ) FD_LOG_ERR(( "fd_wksp_containing failed" ));
 
+  FD_LOG_INFO(( "joining %s.dedup.lat_pub", cfg_path ));
+  fd_lhist_t * lat_pub = fd_frank_lhist_pod_join( cfg_pod, "dedup.lat_pub" ); /* NULL if not configured */
+
+  FD_LOG_INFO(( "joining %s.dedup.lat_orig", cfg_path ));
+  fd_lhist_t * lat_orig = fd_frank_lhist_pod_join( cfg_pod, "dedup.lat_orig" ); /* NULL if not configured */
+
   FD_LOG_INFO(( "joining %s.dedup.fseq", cfg_path ));
   ulong * fseq = fd_fseq_join( fd_wksp_pod_map( cfg_pod, "dedup.fseq" ) );
   if( FD_UNLIKELY( !fseq ) ) FD_LOG_ERR(( "fd_fseq_join failed" ));
@@ -78,6 +84,19 @@ fd_frank_pack_task( int     argc,
   fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, seed, 0UL ) );
   if( FD_UNLIKELY( !rng ) ) FD_LOG_ERR(( "fd_rng_join failed" ));
 
+  int idle_en = fd_pod_query_int( cfg_pod, "pack.idle.enable", 0 ); /* 0 <> never idle */
+  fd_idle_t _idle[ 1 ];
+  fd_idle_t * idle = NULL;
+  if( idle_en ) {
+    long idle_spin  = fd_pod_query_long( cfg_pod, "pack.idle.spin_ns",  -1L ); /* <0 <> use default */
+    long idle_wait  = fd_pod_query_long( cfg_pod, "pack.idle.wait_ns",  -1L ); /* <0 <> use default */
+    long idle_sleep = fd_pod_query_long( cfg_pod, "pack.idle.sleep_ns", -1L ); /* <0 <> use default */
+    FD_LOG_INFO(( "creating idle (%s.pack.idle.spin_ns %li %s.pack.idle.wait_ns %li %s.pack.idle.sleep_ns %li)",
+                  cfg_path, idle_spin, cfg_path, idle_wait, cfg_path, idle_sleep ));
+    idle = fd_idle_join( fd_idle_new( _idle, idle_spin, idle_wait, idle_sleep ) );
+    if( FD_UNLIKELY( !idle ) ) FD_LOG_ERR(( "fd_idle_join failed" ));
+  }
+
   /* Start packing */
 
   FD_LOG_INFO(( "pack run" ));
@@ -123,8 +142,11 @@ fd_frank_pack_task( int     argc,
     long  diff      = fd_seq_diff( seq_found, seq );
     if( FD_UNLIKELY( diff ) ) { /* caught up or overrun, optimize for expected sequence number ready */
       if( FD_LIKELY( diff<0L ) ) { /* caught up */
-        FD_SPIN_PAUSE();
-        now = fd_tickcount();
+        if( idle ) now = fd_idle_wait( idle, &mline->seq, seq_found, now );
+        else {
+          FD_SPIN_PAUSE();
+          now = fd_tickcount();
+        }
         continue;
       }
       /* overrun by dedup tile ... recover */
@@ -134,12 +156,15 @@ fd_frank_pack_task( int     argc,
     }
 
     now = fd_tickcount();
+    if( idle ) fd_idle_busy( idle, now );
 
     /* At this point, we have started receiving frag seq with details in
        mline at time now.  Speculatively processs it here. */
 
     /* Placeholder for speculative pack operations */
-    ulong sz = (ulong)mline->sz;
+    ulong sz     = (ulong)mline->sz;
+    ulong tsorig = (ulong)mline->tsorig;
+    ulong tspub  = (ulong)mline->tspub;
 
     /* Check that we weren't overrun while processing */
     seq_found = fd_frag_meta_seq_query( mline );
@@ -149,6 +174,10 @@ fd_frank_pack_task( int     argc,
       continue;
     }
 
+    /* Record the latencies of this frag */
+    if( lat_pub  ) fd_lhist_sample( lat_pub,  (ulong)fd_long_max( now - fd_frag_meta_ts_decomp( tspub,  now ), 0L ) );
+    if( lat_orig ) fd_lhist_sample( lat_orig, (ulong)fd_long_max( now - fd_frag_meta_ts_decomp( tsorig, now ), 0L ) );
+
     /* Placeholder for non-speculative pack operations */
     accum_pub_cnt++;
     accum_pub_sz += sz;
@@ -162,8 +191,16 @@ fd_frank_pack_task( int     argc,
   
   fd_cnc_signal( cnc, FD_CNC_SIGNAL_BOOT );
   FD_LOG_INFO(( "pack fini" ));
+  if( idle ) {
+    for( int tier=0; tier<FD_IDLE_TIER_CNT; tier++ )
+      FD_LOG_INFO(( "pack idle tier %i: %lu episodes, wake p50 <= %li ticks, p99 <= %li ticks", tier,
+                    fd_idle_episode_cnt( idle, tier ), fd_idle_wake_quantile( idle, tier, 0.50f ), fd_idle_wake_quantile( idle, tier, 0.99f ) ));
+    fd_idle_delete   ( fd_idle_leave  ( idle   ) );
+  }
   fd_rng_delete    ( fd_rng_leave   ( rng    ) );
   fd_wksp_pod_unmap( fd_fseq_leave  ( fseq   ) );
+  if( lat_orig ) fd_wksp_pod_unmap( fd_lhist_leave( lat_orig ) );
+  if( lat_pub  ) fd_wksp_pod_unmap( fd_lhist_leave( lat_pub  ) );
   fd_wksp_pod_unmap( fd_mcache_leave( mcache ) );
   fd_wksp_pod_unmap( fd_cnc_leave   ( cnc    ) );
   fd_wksp_pod_detach( pod );
@@ -0,0 +1,334 @@
+/* fd_frank_plan is a NUMA aware placement planner for the IPC objects
+   of a frank instance.  It is run by fd_frank_init with the same
+   --tile-cpus the instance will be run with (tile 0 is main, tile 1 is
+   pack, tile 2 is dedup and tiles 3+ are the verify tiles in the order
+   main will boot them).  Given the tile to cpu map and the cpu to NUMA
+   node map of the host, it creates one wksp per NUMA node used by the
+   instance and allocates each tile's and each link's IPC objects in the
+   wksp of the appropriate node.  The gaddrs of the objects are inserted
+   into the instance's configuration pod at the same paths that
+   fd_frank_run and fd_frank_mon expect.
+
+   The instance's link topology is the frank pipeline:
+
+     verify.vN (tx verify tile vN) -> (rx dedup tile)
+     dedup     (tx dedup tile)     -> (rx pack tile)
+
+   and the sizing of its objects are read from the pod at [cfg].plan
+   (see README.md).  Objects written frequently by a single tile (its
+   cnc, the dedup tcache, a link's fseq and latency histograms) are
+   always placed on that tile's node.  A link's mcache and dcache are
+   placed on the node of the link's consumer (policy "consumer", the
+   default, the consumer polls the mcache continuously and the producer
+   only writes each line once) or producer (policy "producer").  Links
+   whose producer and consumer are on different nodes are reported.
+
+   The names of the wksps created are printed to stdout (one per line)
+   such that the caller can clean them up later. */
+
+#include "fd_frank.h"
+
+#if FD_HAS_FRANK
+
+#include <stdio.h>
+
+#define FD_FRANK_PLAN_POLICY_CONSUMER (0)
+#define FD_FRANK_PLAN_POLICY_PRODUCER (1)
+
+#define FD_FRANK_PLAN_TAG      (1UL)
+#define FD_FRANK_PLAN_PATH_MAX (256UL) /* Max pod path length (including terminating '\0') */
+
+struct fd_frank_plan {
+  uchar *      pod;      /* Root pod of the instance (writable) */
+  char const * cfg;      /* Path of the instance's configuration in pod */
+  char const * wksp;     /* Prefix of the per NUMA node wksp names */
+  ulong        page_sz;  /* Per NUMA node wksp page size */
+  ulong        page_cnt; /* Per NUMA node wksp page count */
+  ulong        mode;     /* Per NUMA node wksp permissions */
+
+  fd_wksp_t *  numa_wksp[ FD_SHMEM_NUMA_MAX ]; /* Indexed by numa_idx, NULL if not yet used */
+};
+
+typedef struct fd_frank_plan fd_frank_plan_t;
+
+/* fd_frank_plan_tile_numa returns the NUMA node of tile_idx.  Tiles
+   that float (or are not configured) are placed on NUMA node 0. */
+
+static ulong
+fd_frank_plan_tile_numa( ulong        tile_idx,
+                         char const * tile_name ) {
+  ulong cpu_idx = fd_tile_cpu_id( tile_idx );
+  if( FD_UNLIKELY( cpu_idx>=fd_shmem_cpu_cnt() ) ) {
+    FD_LOG_WARNING(( "tile %s (%lu) floats; placing its objects on numa node 0", tile_name, tile_idx ));
+    return 0UL;
+  }
+  return fd_shmem_numa_idx( cpu_idx );
+}
+
+/* fd_frank_plan_numa_wksp returns the wksp for numa_idx, creating it
+   if this is the first object placed on numa_idx. */
+
+static fd_wksp_t *
+fd_frank_plan_numa_wksp( fd_frank_plan_t * plan,
+                         ulong             numa_idx ) {
+  fd_wksp_t * wksp = plan->numa_wksp[ numa_idx ];
+  if( FD_LIKELY( wksp ) ) return wksp;
+
+  char name[ FD_SHMEM_NAME_MAX ];
+  if( FD_UNLIKELY( !fd_cstr_printf( name, FD_SHMEM_NAME_MAX, NULL, "%s.numa%lu", plan->wksp, numa_idx ) ) )
+    FD_LOG_ERR(( "wksp name too long for numa node %lu", numa_idx ));
+
+  /* Clean up any stale wksp from a previous instance */
+
+  fd_shmem_info_t info[1];
+  if( FD_UNLIKELY( !fd_shmem_info( name, 0UL, info ) ) ) {
+    FD_LOG_WARNING(( "deleting stale wksp %s", name ));
+    void * shmem = fd_shmem_join( name, FD_SHMEM_JOIN_MODE_READ_WRITE, NULL, NULL, NULL );
+    if( FD_UNLIKELY( !shmem                   ) ) FD_LOG_ERR(( "fd_shmem_join( %s ) failed", name ));
+    if( FD_UNLIKELY( !fd_wksp_delete( shmem ) ) ) FD_LOG_ERR(( "fd_wksp_delete( %s ) failed", name ));
+    if( FD_UNLIKELY( fd_shmem_unlink( name, info->page_sz ) ) ) FD_LOG_ERR(( "fd_shmem_unlink( %s ) failed", name ));
+    fd_shmem_leave( shmem, NULL, NULL );
+  }
+
+  ulong cpu_idx = fd_shmem_cpu_idx( numa_idx );
+  if( FD_UNLIKELY( fd_shmem_create( name, plan->page_sz, plan->page_cnt, cpu_idx, plan->mode ) ) )
+    FD_LOG_ERR(( "fd_shmem_create( %s, %lu, %lu, %lu, 0%03lo ) failed", name, plan->page_sz, plan->page_cnt, cpu_idx, plan->mode ));
+
+  void * shmem = fd_shmem_join( name, FD_SHMEM_JOIN_MODE_READ_WRITE, NULL, NULL, NULL );
+  if( FD_UNLIKELY( !shmem ) ) FD_LOG_ERR(( "fd_shmem_join( %s ) failed", name ));
+  if( FD_UNLIKELY( !fd_wksp_new( shmem, name, plan->page_sz*plan->page_cnt, 0UL ) ) ) FD_LOG_ERR(( "fd_wksp_new( %s ) failed", name ));
+  fd_shmem_leave( shmem, NULL, NULL );
+
+  wksp = fd_wksp_attach( name );
+  if( FD_UNLIKELY( !wksp ) ) FD_LOG_ERR(( "fd_wksp_attach( %s ) failed", name ));
+
+  char path[ FD_FRANK_PLAN_PATH_MAX ];
+  fd_cstr_printf( path, FD_FRANK_PLAN_PATH_MAX, NULL, "%s.plan.wksp.numa%lu", plan->cfg, numa_idx );
+  if( FD_UNLIKELY( !fd_pod_insert_cstr( plan->pod, path, name ) ) ) FD_LOG_ERR(( "fd_pod_insert_cstr( %s ) failed", path ));
+
+  printf( "%s\n", name );
+  FD_LOG_NOTICE(( "created wksp %s on numa node %lu", name, numa_idx ));
+
+  plan->numa_wksp[ numa_idx ] = wksp;
+  return wksp;
+}
+
+/* fd_frank_plan_alloc allocates an object with the given alignment and
+   footprint on numa_idx and records its gaddr in the pod at
+   [cfg].[key].  Returns the location of the object in the caller's
+   local address space. */
+
+static void *
+fd_frank_plan_alloc( fd_frank_plan_t * plan,
+                     ulong             numa_idx,
+                     char const *      key,
+                     ulong             align,
+                     ulong             footprint ) {
+  if( FD_UNLIKELY( !footprint ) ) FD_LOG_ERR(( "bad configuration for %s.%s", plan->cfg, key ));
+
+  fd_wksp_t * wksp  = fd_frank_plan_numa_wksp( plan, numa_idx );
+  ulong       gaddr = fd_wksp_alloc( wksp, align, footprint, FD_FRANK_PLAN_TAG );
+  if( FD_UNLIKELY( !gaddr ) ) FD_LOG_ERR(( "fd_wksp_alloc( %s, %lu, %lu ) failed for %s.%s; increase --page-cnt",
+                                           fd_wksp_name( wksp ), align, footprint, plan->cfg, key ));
+
+  char buf [ FD_WKSP_CSTR_MAX       ];
+  char path[ FD_FRANK_PLAN_PATH_MAX ];
+  fd_cstr_printf( path, FD_FRANK_PLAN_PATH_MAX, NULL, "%s.%s", plan->cfg, key );
+  if( FD_UNLIKELY( !fd_pod_insert_cstr( plan->pod, path, fd_wksp_cstr( wksp, gaddr, buf ) ) ) )
+    FD_LOG_ERR(( "fd_pod_insert_cstr( %s ) failed; increase the pod size", path ));
+
+  FD_LOG_INFO(( "%s: numa %lu (%s)", path, numa_idx, buf ));
+  return fd_wksp_laddr( wksp, gaddr );
+}
+
+static void
+fd_frank_plan_cnc( fd_frank_plan_t * plan,
+                   ulong             numa_idx,
+                   char const *      key,
+                   ulong             type,
+                   ulong             app_sz ) {
+  void * mem = fd_frank_plan_alloc( plan, numa_idx, key, fd_cnc_align(), fd_cnc_footprint( app_sz ) );
+  if( FD_UNLIKELY( !fd_cnc_new( mem, app_sz, type, fd_tickcount() ) ) ) FD_LOG_ERR(( "fd_cnc_new failed for %s", key ));
+}
+
+/* fd_frank_plan_link places the objects of the link name (produced by
+   tile tx and consumed by tile rx).  A zero mtu indicates the link has
+   no dcache.  Returns 1 if the link crosses NUMA nodes and 0 if not. */
+
+static int
+fd_frank_plan_link( fd_frank_plan_t * plan,
+                    int               policy,
+                    char const *      name,
+                    char const *      tx_name,
+                    ulong             tx_numa,
+                    char const *      rx_name,
+                    ulong             rx_numa,
+                    ulong             depth,
+                    ulong             mtu ) {
+  ulong numa = (policy==FD_FRANK_PLAN_POLICY_PRODUCER) ? tx_numa : rx_numa;
+
+  char key[ FD_FRANK_PLAN_PATH_MAX ];
+
+  fd_cstr_printf( key, FD_FRANK_PLAN_PATH_MAX, NULL, "%s.mcache", name );
+  void * mem = fd_frank_plan_alloc( plan, numa, key, fd_mcache_align(), fd_mcache_footprint( depth, 0UL ) );
+  if( FD_UNLIKELY( !fd_mcache_new( mem, depth, 0UL, 0UL ) ) ) FD_LOG_ERR(( "fd_mcache_new failed for %s", key ));
+
+  if( mtu ) {
+    ulong data_sz = fd_dcache_req_data_sz( mtu, depth, 1UL, 1 );
+    if( FD_UNLIKELY( !data_sz ) ) FD_LOG_ERR(( "bad mtu (%lu) / depth (%lu) for %s", mtu, depth, name ));
+    fd_cstr_printf( key, FD_FRANK_PLAN_PATH_MAX, NULL, "%s.dcache", name );
+    mem = fd_frank_plan_alloc( plan, numa, key, fd_dcache_align(), fd_dcache_footprint( data_sz, 0UL ) );
+    if( FD_UNLIKELY( !fd_dcache_new( mem, data_sz, 0UL ) ) ) FD_LOG_ERR(( "fd_dcache_new failed for %s", key ));
+  }
+
+  /* The fseq and latency histograms are written by the consumer */
+
+  fd_cstr_printf( key, FD_FRANK_PLAN_PATH_MAX, NULL, "%s.fseq", name );
+  mem = fd_frank_plan_alloc( plan, rx_numa, key, fd_fseq_align(), fd_fseq_footprint() );
+  if( FD_UNLIKELY( !fd_fseq_new( mem, 0UL ) ) ) FD_LOG_ERR(( "fd_fseq_new failed for %s", key ));
+
+  fd_cstr_printf( key, FD_FRANK_PLAN_PATH_MAX, NULL, "%s.lat_pub", name );
+  mem = fd_frank_plan_alloc( plan, rx_numa, key, fd_lhist_align(), fd_lhist_footprint() );
+  if( FD_UNLIKELY( !fd_lhist_new( mem ) ) ) FD_LOG_ERR(( "fd_lhist_new failed for %s", key ));
+
+  fd_cstr_printf( key, FD_FRANK_PLAN_PATH_MAX, NULL, "%s.lat_orig", name );
+  mem = fd_frank_plan_alloc( plan, rx_numa, key, fd_lhist_align(), fd_lhist_footprint() );
+  if( FD_UNLIKELY( !fd_lhist_new( mem ) ) ) FD_LOG_ERR(( "fd_lhist_new failed for %s", key ));
+
+  /* Record and report the placement */
+
+  char path[ FD_FRANK_PLAN_PATH_MAX ];
+  fd_cstr_printf( path, FD_FRANK_PLAN_PATH_MAX, NULL, "%s.plan.link.%s.tx_numa", plan->cfg, name );
+  if( FD_UNLIKELY( !fd_pod_insert_ulong( plan->pod, path, tx_numa ) ) ) FD_LOG_ERR(( "fd_pod_insert_ulong( %s ) failed", path ));
+  fd_cstr_printf( path, FD_FRANK_PLAN_PATH_MAX, NULL, "%s.plan.link.%s.rx_numa", plan->cfg, name );
+  if( FD_UNLIKELY( !fd_pod_insert_ulong( plan->pod, path, rx_numa ) ) ) FD_LOG_ERR(( "fd_pod_insert_ulong( %s ) failed", path ));
+
+  int cross = (tx_numa!=rx_numa);
+  if( FD_UNLIKELY( cross ) )
+    FD_LOG_WARNING(( "link %s crosses numa nodes (tx %s on %lu, rx %s on %lu); %s polls remote memory",
+                     name, tx_name, tx_numa, rx_name, rx_numa,
+                     (policy==FD_FRANK_PLAN_POLICY_PRODUCER) ? "consumer" : "producer publishes to and flow controls against" ));
+  return cross;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * pod_gaddr = fd_env_strip_cmdline_cstr ( &argc, &argv, "--pod",      NULL, NULL       );
+  char const * cfg_path  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--cfg",      NULL, NULL       );
+  char const * wksp_pfx  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--wksp",     NULL, NULL       );
+  char const * _page_sz  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",  NULL, "gigantic" );
+  ulong        page_cnt  = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt", NULL, 1UL        );
+  char const * _mode     = fd_env_strip_cmdline_cstr ( &argc, &argv, "--mode",     NULL, "0600"     );
+
+  if( FD_UNLIKELY( !pod_gaddr ) ) FD_LOG_ERR(( "--pod not specified" ));
+  if( FD_UNLIKELY( !cfg_path  ) ) FD_LOG_ERR(( "--cfg not specified" ));
+  if( FD_UNLIKELY( !wksp_pfx  ) ) FD_LOG_ERR(( "--wksp not specified" ));
+
+  ulong page_sz = fd_cstr_to_shmem_page_sz( _page_sz );
+  if( FD_UNLIKELY( !page_sz  ) ) FD_LOG_ERR(( "unsupported --page-sz" ));
+  if( FD_UNLIKELY( !page_cnt ) ) FD_LOG_ERR(( "--page-cnt should be positive" ));
+
+  fd_frank_plan_t plan[1];
+  memset( plan, 0, sizeof(fd_frank_plan_t) );
+  plan->cfg      = cfg_path;
+  plan->wksp     = wksp_pfx;
+  plan->page_sz  = page_sz;
+  plan->page_cnt = page_cnt;
+  plan->mode     = fd_cstr_to_ulong_octal( _mode );
+
+  void * shpod = fd_wksp_map( pod_gaddr );
+  if( FD_UNLIKELY( !shpod ) ) FD_LOG_ERR(( "unable to map --pod %s", pod_gaddr ));
+  plan->pod = fd_pod_join( shpod );
+  if( FD_UNLIKELY( !plan->pod ) ) FD_LOG_ERR(( "fd_pod_join failed" ));
+
+  /* Load the plan parameters.  Note that we query everything we need
+     up front as pod inserts below invalidate pointers into the pod. */
+
+  uchar const * cfg_pod = fd_pod_query_subpod( plan->pod, cfg_path );
+  if( FD_UNLIKELY( !cfg_pod  ) ) FD_LOG_ERR(( "path not found" ));
+  uchar const * plan_pod = fd_pod_query_subpod( cfg_pod, "plan" );
+  if( FD_UNLIKELY( !plan_pod ) ) FD_LOG_ERR(( "%s.plan not found", cfg_path ));
+
+  char const * _policy            = fd_pod_query_cstr ( plan_pod, "policy",             "consumer" );
+  ulong        verify_cnt         = fd_pod_query_ulong( plan_pod, "verify_cnt",         0UL        );
+  ulong        verify_depth       = fd_pod_query_ulong( plan_pod, "verify_depth",       0UL        );
+  ulong        verify_mtu         = fd_pod_query_ulong( plan_pod, "verify_mtu",         0UL        );
+  ulong        dedup_depth        = fd_pod_query_ulong( plan_pod, "dedup_depth",        0UL        );
+  ulong        dedup_tcache_depth = fd_pod_query_ulong( plan_pod, "dedup_tcache_depth", 0UL        );
+  ulong        dedup_tcache_map   = fd_pod_query_ulong( plan_pod, "dedup_tcache_map",   0UL        );
+  ulong        cnc_app_sz         = fd_pod_query_ulong( plan_pod, "cnc_app_sz",         4032UL     );
+
+  int policy;
+  if(      !strcmp( _policy, "consumer" ) ) policy = FD_FRANK_PLAN_POLICY_CONSUMER;
+  else if( !strcmp( _policy, "producer" ) ) policy = FD_FRANK_PLAN_POLICY_PRODUCER;
+  else FD_LOG_ERR(( "unsupported %s.plan.policy %s (should be consumer or producer)", cfg_path, _policy ));
+
+  if( FD_UNLIKELY( !verify_mtu ) ) FD_LOG_ERR(( "%s.plan.verify_mtu not configured", cfg_path ));
+
+  ulong tile_cnt = 3UL + verify_cnt;
+  if( FD_UNLIKELY( fd_tile_cnt()<tile_cnt ) ) FD_LOG_ERR(( "at least %lu --tile-cpus required for this config", tile_cnt ));
+
+  FD_LOG_NOTICE(( "planning %s (%lu verify, policy %s) over %lu numa nodes", cfg_path, verify_cnt, _policy, fd_shmem_numa_cnt() ));
+
+  /* Place the tile objects */
+
+  ulong pack_numa  = fd_frank_plan_tile_numa( 1UL, "pack"  );
+  ulong dedup_numa = fd_frank_plan_tile_numa( 2UL, "dedup" );
+
+  fd_frank_plan_cnc( plan, pack_numa,  "pack.cnc",  0UL, cnc_app_sz );
+  fd_frank_plan_cnc( plan, dedup_numa, "dedup.cnc", 1UL, cnc_app_sz );
+
+  void * mem = fd_frank_plan_alloc( plan, dedup_numa, "dedup.tcache", fd_tcache_align(),
+                                    fd_tcache_footprint( dedup_tcache_depth, dedup_tcache_map ) );
+  if( FD_UNLIKELY( !fd_tcache_new( mem, dedup_tcache_depth, dedup_tcache_map ) ) ) FD_LOG_ERR(( "fd_tcache_new failed" ));
+
+  /* Place the links */
+
+  ulong cross_cnt = 0UL;
+
+  cross_cnt += (ulong)fd_frank_plan_link( plan, policy, "dedup", "dedup", dedup_numa, "pack", pack_numa, dedup_depth, 0UL );
+
+  for( ulong verify_idx=0UL; verify_idx<verify_cnt; verify_idx++ ) {
+    char verify_name[ 32 ]; fd_cstr_printf( verify_name, 32UL, NULL, "v%lu", verify_idx );
+    char key        [ 64 ];
+
+    ulong verify_numa = fd_frank_plan_tile_numa( 3UL+verify_idx, verify_name );
+
+    fd_cstr_printf( key, 64UL, NULL, "verify.%s.cnc", verify_name );
+    fd_frank_plan_cnc( plan, verify_numa, key, 2UL, cnc_app_sz );
+
+    fd_cstr_printf( key, 64UL, NULL, "verify.%s", verify_name );
+    cross_cnt += (ulong)fd_frank_plan_link( plan, policy, key, verify_name, verify_numa, "dedup", dedup_numa,
+                                            verify_depth, verify_mtu );
+  }
+
+  char path[ FD_FRANK_PLAN_PATH_MAX ];
+  fd_cstr_printf( path, FD_FRANK_PLAN_PATH_MAX, NULL, "%s.plan.cross_cnt", cfg_path );
+  if( FD_UNLIKELY( !fd_pod_insert_ulong( plan->pod, path, cross_cnt ) ) ) FD_LOG_ERR(( "fd_pod_insert_ulong( %s ) failed", path ));
+
+  if( FD_UNLIKELY( cross_cnt ) ) FD_LOG_WARNING(( "%lu of %lu links cross numa nodes", cross_cnt, verify_cnt+1UL ));
+  else                           FD_LOG_NOTICE (( "no links cross numa nodes" ));
+
+  for( ulong numa_idx=0UL; numa_idx<FD_SHMEM_NUMA_MAX; numa_idx++ )
+    if( plan->numa_wksp[ numa_idx ] ) fd_wksp_detach( plan->numa_wksp[ numa_idx ] );
+  fd_wksp_unmap( fd_pod_leave( plan->pod ) );
+
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_ERR(( "unsupported for this build target" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
@@ -0,0 +1,5 @@
+$(call add-hdrs,fd_capture.h)
+$(call add-objs,fd_capture,fd_disco)
+$(call make-unit-test,test_capture,test_capture,fd_disco fd_tango fd_util)
+$(call run-unit-test,test_capture,--tile-cpus f3)
+$(call make-bin,fd_capture_tile,fd_capture_tile,fd_disco fd_tango fd_util)
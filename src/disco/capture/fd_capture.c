@@ -0,0 +1,532 @@
+#include "fd_capture.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+#include "../../util/net/fd_pcap.h"
+#include <stdio.h>
+#include <errno.h>
+
+/* fd_capture_ring_private specifies the layout of a shared memory
+   region containing a capture ring.  The ring is a single producer
+   single consumer byte ring.  The producer and the consumer cursors
+   count bytes written / read since the ring was created and are on
+   their own cache line pairs to avoid false sharing. */
+
+#define FD_CAPTURE_RING_MAGIC (0xf17eda2c37ca9700UL) /* firedancer capture ver 0 */
+
+struct __attribute__((aligned(FD_CAPTURE_RING_ALIGN))) fd_capture_ring_private {
+  ulong magic;   /* == FD_CAPTURE_RING_MAGIC */
+  ulong data_sz; /* Bytes of frag storage, multiple of 64 of at least FD_CAPTURE_RING_DATA_MIN */
+
+  /* Written by the capture tile */
+
+  ulong prod __attribute__((aligned(FD_CAPTURE_RING_ALIGN))); /* Bytes published to the ring */
+  ulong closed;                                               /* Non-zero if no more bytes will be published */
+
+  /* Written by the capture writer */
+
+  ulong cons __attribute__((aligned(FD_CAPTURE_RING_ALIGN))); /* Bytes consumed from the ring, in [prod-data_sz,prod] */
+
+  /* data_sz bytes of frag storage here */
+};
+
+FD_STATIC_ASSERT( sizeof(fd_capture_ring_t)==FD_CAPTURE_RING_FOOTPRINT( 0UL ), layout );
+
+/* fd_capture_rec_t is the header of a frag in the ring.  It is followed
+   by the frag payload, padded to a multiple of 64 bytes.  A header with
+   sz FD_CAPTURE_REC_WRAP indicates the next frag starts at the
+   beginning of the ring. */
+
+#define FD_CAPTURE_REC_WRAP (ULONG_MAX)
+
+struct __attribute__((aligned(64))) fd_capture_rec {
+  ulong seq;
+  ulong sig;
+  ulong ctl;
+  ulong tsorig;
+  ulong tspub;
+  long  ts;     /* Wallclock when captured */
+  ulong sz;     /* Payload size */
+  ulong _pad;
+};
+
+typedef struct fd_capture_rec fd_capture_rec_t;
+
+FD_STATIC_ASSERT( sizeof(fd_capture_rec_t)==64UL, layout );
+
+/* FD_CAPTURE_PUB_LAZY is the number of bytes the capture tile can
+   accumulate in the ring before making them visible to the writer.
+   This amortizes the cache line traffic on the producer cursor over
+   many frags. */
+
+#define FD_CAPTURE_PUB_LAZY (65536UL)
+
+static inline uchar *
+fd_capture_ring_data( fd_capture_ring_t * ring ) {
+  return (uchar *)(ring+1);
+}
+
+ulong
+fd_capture_ring_align( void ) {
+  return FD_CAPTURE_RING_ALIGN;
+}
+
+ulong
+fd_capture_ring_footprint( ulong data_sz ) {
+  if( FD_UNLIKELY( (data_sz<FD_CAPTURE_RING_DATA_MIN) | (!fd_ulong_is_aligned( data_sz, 64UL )) |
+                   (data_sz>(ULONG_MAX>>1)) ) ) return 0UL;
+  return FD_CAPTURE_RING_FOOTPRINT( data_sz );
+}
+
+void *
+fd_capture_ring_new( void * shmem,
+                     ulong  data_sz ) {
+
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, fd_capture_ring_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_capture_ring_footprint( data_sz ) ) ) {
+    FD_LOG_WARNING(( "bad data_sz" ));
+    return NULL;
+  }
+
+  fd_capture_ring_t * ring = (fd_capture_ring_t *)shmem;
+
+  memset( ring, 0, sizeof(fd_capture_ring_t) );
+
+  ring->data_sz = data_sz;
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( ring->magic ) = FD_CAPTURE_RING_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return shmem;
+}
+
+fd_capture_ring_t *
+fd_capture_ring_join( void * shring ) {
+
+  if( FD_UNLIKELY( !shring ) ) {
+    FD_LOG_WARNING(( "NULL shring" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shring, fd_capture_ring_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shring" ));
+    return NULL;
+  }
+
+  fd_capture_ring_t * ring = (fd_capture_ring_t *)shring;
+
+  if( FD_UNLIKELY( ring->magic!=FD_CAPTURE_RING_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  return ring;
+}
+
+void *
+fd_capture_ring_leave( fd_capture_ring_t * ring ) {
+
+  if( FD_UNLIKELY( !ring ) ) {
+    FD_LOG_WARNING(( "NULL ring" ));
+    return NULL;
+  }
+
+  return (void *)ring;
+}
+
+void *
+fd_capture_ring_delete( void * shring ) {
+
+  if( FD_UNLIKELY( !shring ) ) {
+    FD_LOG_WARNING(( "NULL shring" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shring, fd_capture_ring_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shring" ));
+    return NULL;
+  }
+
+  fd_capture_ring_t * ring = (fd_capture_ring_t *)shring;
+
+  if( FD_UNLIKELY( ring->magic!=FD_CAPTURE_RING_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( ring->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return (void *)ring;
+}
+
+void
+fd_capture_ring_close( fd_capture_ring_t * ring ) {
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( ring->closed ) = 1UL;
+  FD_COMPILER_MFENCE();
+}
+
+int
+fd_capture_tile( fd_cnc_t *             cnc,
+                 fd_frag_meta_t const * mcache,
+                 uchar const *          dcache,
+                 fd_capture_ring_t *    ring,
+                 long                   lazy,
+                 fd_rng_t *             rng ) {
+
+  /* cnc state */
+  ulong * cnc_diag;           /* ==fd_cnc_app_laddr( cnc ), local address of the capture tile cnc diagnostic region */
+  ulong   cnc_diag_cap_cnt;   /* Accumulates number of frags captured between housekeeping events */
+  ulong   cnc_diag_cap_sz;    /* Accumulates frag payload bytes captured between housekeeping events */
+  ulong   cnc_diag_ovrnp_cnt; /* Accumulates number of overruns while polling between housekeeping events */
+  ulong   cnc_diag_ovrnr_cnt; /* Accumulates number of overruns while copying between housekeeping events */
+  ulong   cnc_diag_drop_cnt;  /* Accumulates number of frags dropped between housekeeping events */
+  ulong   cnc_diag_drop_sz;   /* Accumulates frag payload bytes dropped between housekeeping events */
+
+  /* in frag stream state */
+  ulong        depth; /* ==fd_mcache_depth( mcache ), depth of the mcache / positive integer power of 2 */
+  ulong        seq;   /* sequence number of the next frag to capture */
+  void const * base;  /* ==fd_wksp_containing( dcache ), chunk reference address in the tile's local address space */
+
+  /* capture ring state */
+  uchar * data;     /* ==fd_capture_ring_data( ring ), ring frag storage */
+  ulong   data_sz;  /* ==ring->data_sz */
+  ulong   prod;     /* bytes written to the ring */
+  ulong   prod_pub; /* bytes made visible to the writer, in [prod-FD_CAPTURE_PUB_LAZY,prod] */
+  ulong   cons;     /* most recent observation of the writer's cursor */
+
+  /* timestamp state */
+  long    wall0;        /* wallclock observed at the last housekeeping event */
+  long    tick0;        /* tickcount observed with wall0 */
+  double  ns_per_tick;  /* ==1/fd_tempo_tick_per_ns */
+
+  /* housekeeping state */
+  ulong async_min; /* minimum number of ticks between processing a housekeeping event, positive integer power of 2 */
+
+  do {
+
+    FD_LOG_INFO(( "Booting capture" ));
+
+    /* cnc state init */
+
+    if( FD_UNLIKELY( !cnc ) ) { FD_LOG_WARNING(( "NULL cnc" )); return 1; }
+    if( FD_UNLIKELY( fd_cnc_app_sz( cnc )<64UL ) ) { FD_LOG_WARNING(( "cnc app sz must be at least 64" )); return 1; }
+    if( FD_UNLIKELY( fd_cnc_signal_query( cnc )!=FD_CNC_SIGNAL_BOOT ) ) { FD_LOG_WARNING(( "already booted" )); return 1; }
+
+    cnc_diag = (ulong *)fd_cnc_app_laddr( cnc );
+
+    cnc_diag_cap_cnt   = 0UL;
+    cnc_diag_cap_sz    = 0UL;
+    cnc_diag_ovrnp_cnt = 0UL;
+    cnc_diag_ovrnr_cnt = 0UL;
+    cnc_diag_drop_cnt  = 0UL;
+    cnc_diag_drop_sz   = 0UL;
+
+    /* in frag stream init */
+
+    if( FD_UNLIKELY( !mcache ) ) { FD_LOG_WARNING(( "NULL mcache" )); return 1; }
+    depth = fd_mcache_depth( mcache );
+    seq   = fd_mcache_seq_query( fd_mcache_seq_laddr_const( mcache ) );
+
+    if( FD_UNLIKELY( !dcache ) ) { FD_LOG_WARNING(( "NULL dcache" )); return 1; }
+    base = fd_wksp_containing( dcache );
+    if( FD_UNLIKELY( !base ) ) { FD_LOG_WARNING(( "fd_wksp_containing failed" )); return 1; }
+
+    /* capture ring init */
+
+    if( FD_UNLIKELY( !ring ) ) { FD_LOG_WARNING(( "NULL ring" )); return 1; }
+    if( FD_UNLIKELY( FD_VOLATILE_CONST( ring->closed ) ) ) { FD_LOG_WARNING(( "ring closed" )); return 1; }
+    data     = fd_capture_ring_data( ring );
+    data_sz  = ring->data_sz;
+    prod     = FD_VOLATILE_CONST( ring->prod );
+    prod_pub = prod;
+    cons     = FD_VOLATILE_CONST( ring->cons );
+
+    /* timestamp init */
+
+    ns_per_tick = 1. / fd_tempo_tick_per_ns( NULL );
+    fd_tempo_observe_pair( &wall0, &tick0 );
+
+    /* housekeeping init */
+
+    if( lazy<=0L ) lazy = fd_tempo_lazy_default( depth );
+    FD_LOG_INFO(( "Configuring housekeeping (lazy %li ns)", lazy ));
+
+    async_min = fd_tempo_async_min( lazy, 1UL /*event_cnt*/, (float)fd_tempo_tick_per_ns( NULL ) );
+    if( FD_UNLIKELY( !async_min ) ) { FD_LOG_WARNING(( "bad lazy" )); return 1; }
+
+  } while(0);
+
+  FD_LOG_INFO(( "Running capture (seq %lu)", seq ));
+  FD_COMPILER_MFENCE();
+  cnc_diag[ FD_CNC_DIAG_IN_BACKP  ] = 0UL;
+  cnc_diag[ FD_CNC_DIAG_BACKP_CNT ] = 0UL;
+  FD_COMPILER_MFENCE();
+  fd_cnc_signal( cnc, FD_CNC_SIGNAL_RUN );
+  long then = fd_tickcount();
+  long now  = then;
+  for(;;) {
+
+    /* Do housekeeping at a low rate in the background */
+    if( FD_UNLIKELY( (now-then)>=0L ) ) {
+
+      /* Make captured frags visible to the writer */
+      FD_COMPILER_MFENCE();
+      FD_VOLATILE( ring->prod ) = prod;
+      FD_COMPILER_MFENCE();
+      prod_pub = prod;
+
+      /* Send diagnostic info */
+      fd_cnc_heartbeat( cnc, now );
+      FD_COMPILER_MFENCE();
+      cnc_diag[ FD_CAPTURE_CNC_DIAG_CAP_CNT   ] += cnc_diag_cap_cnt;
+      cnc_diag[ FD_CAPTURE_CNC_DIAG_CAP_SZ    ] += cnc_diag_cap_sz;
+      cnc_diag[ FD_CAPTURE_CNC_DIAG_OVRNP_CNT ] += cnc_diag_ovrnp_cnt;
+      cnc_diag[ FD_CAPTURE_CNC_DIAG_OVRNR_CNT ] += cnc_diag_ovrnr_cnt;
+      cnc_diag[ FD_CAPTURE_CNC_DIAG_DROP_CNT  ] += cnc_diag_drop_cnt;
+      cnc_diag[ FD_CAPTURE_CNC_DIAG_DROP_SZ   ] += cnc_diag_drop_sz;
+      FD_COMPILER_MFENCE();
+      cnc_diag_cap_cnt   = 0UL;
+      cnc_diag_cap_sz    = 0UL;
+      cnc_diag_ovrnp_cnt = 0UL;
+      cnc_diag_ovrnr_cnt = 0UL;
+      cnc_diag_drop_cnt  = 0UL;
+      cnc_diag_drop_sz   = 0UL;
+
+      /* Receive command-and-control signals */
+      ulong s = fd_cnc_signal_query( cnc );
+      if( FD_UNLIKELY( s!=FD_CNC_SIGNAL_RUN ) ) {
+        if( FD_LIKELY( s==FD_CNC_SIGNAL_HALT ) ) break;
+        if( FD_UNLIKELY( s!=FD_CAPTURE_CNC_SIGNAL_ACK ) ) {
+          char buf[ FD_CNC_SIGNAL_CSTR_BUF_MAX ];
+          FD_LOG_WARNING(( "Unexpected signal %s (%lu) received; trying to resume", fd_cnc_signal_cstr( s, buf ), s ));
+        }
+        fd_cnc_signal( cnc, FD_CNC_SIGNAL_RUN );
+      }
+
+      /* Resync the tickcount to wallclock model (the tickcount can
+         drift relative to the wallclock over long captures) */
+      fd_tempo_observe_pair( &wall0, &tick0 );
+
+      /* Reload housekeeping timer */
+      then = now + (long)fd_tempo_async_reload( rng, async_min );
+    }
+
+    /* Poll for the next frag */
+
+    fd_frag_meta_t const * mline;
+    ulong                  seq_found;
+    long                   diff;
+    ulong                  poll_max = 1UL;
+
+    ulong sig;
+    ulong chunk;
+    ulong sz;
+    ulong ctl;
+    ulong tsorig;
+    ulong tspub;
+    FD_MCACHE_WAIT_REG( sig, chunk, sz, ctl, tsorig, tspub, mline, seq_found, diff, poll_max, mcache, depth, seq );
+
+    if( FD_UNLIKELY( diff ) ) {
+      if( FD_LIKELY( diff<0L ) ) { /* Caught up, make what we have visible to the writer while idle */
+        if( FD_UNLIKELY( prod!=prod_pub ) ) {
+          FD_COMPILER_MFENCE();
+          FD_VOLATILE( ring->prod ) = prod;
+          FD_COMPILER_MFENCE();
+          prod_pub = prod;
+        }
+        FD_SPIN_PAUSE();
+        now = fd_tickcount();
+        continue;
+      }
+      /* Overrun while polling (we can't trust the metadata we just
+         loaded so we skip ahead to recover) */
+      cnc_diag_ovrnp_cnt++;
+      seq = seq_found;
+      now = fd_tickcount();
+      continue;
+    }
+
+    /* Reserve space in the ring for the frag (and a wrap marker if the
+       frag doesn't fit contiguously before the end of the ring).  If
+       the writer hasn't freed up enough space, refresh our view of its
+       progress before giving up on the frag. */
+
+    ulong rec_sz = sizeof(fd_capture_rec_t) + fd_ulong_align_up( sz, 64UL );
+    ulong off    = prod % data_sz;
+    ulong pad_sz = fd_ulong_if( off+rec_sz>data_sz, data_sz-off, 0UL );
+    ulong req_sz = pad_sz + rec_sz;
+
+    if( FD_UNLIKELY( data_sz-(prod-cons)<req_sz ) ) {
+      cons = FD_VOLATILE_CONST( ring->cons );
+      if( FD_UNLIKELY( data_sz-(prod-cons)<req_sz ) ) {
+        cnc_diag_drop_cnt++;
+        cnc_diag_drop_sz += sz;
+        seq = fd_seq_inc( seq, 1UL );
+        now = fd_tickcount();
+        continue;
+      }
+    }
+
+    /* Copy the frag into the ring */
+
+    now = fd_tickcount();
+
+    if( FD_UNLIKELY( pad_sz ) ) {
+      ((fd_capture_rec_t *)(data+off))->sz = FD_CAPTURE_REC_WRAP;
+      off = 0UL;
+    }
+
+    fd_capture_rec_t * rec = (fd_capture_rec_t *)(data+off);
+    rec->seq    = seq;
+    rec->sig    = sig;
+    rec->ctl    = ctl;
+    rec->tsorig = tsorig;
+    rec->tspub  = tspub;
+    rec->ts     = wall0 + (long)( (double)(now-tick0)*ns_per_tick );
+    rec->sz     = sz;
+    fd_memcpy( rec+1, fd_chunk_to_laddr_const( base, chunk ), sz );
+
+    /* Check that we weren't overrun while copying.  If so, the copy
+       might be corrupt, so we don't commit it and skip ahead. */
+
+    seq_found = fd_frag_meta_seq_query( mline );
+    if( FD_UNLIKELY( fd_seq_ne( seq_found, seq ) ) ) {
+      cnc_diag_ovrnr_cnt++;
+      seq = seq_found;
+      continue;
+    }
+
+    /* Commit the frag and wind up for the next iteration */
+
+    prod += req_sz;
+    if( FD_UNLIKELY( (prod-prod_pub)>=FD_CAPTURE_PUB_LAZY ) ) {
+      FD_COMPILER_MFENCE();
+      FD_VOLATILE( ring->prod ) = prod;
+      FD_COMPILER_MFENCE();
+      prod_pub = prod;
+    }
+
+    seq = fd_seq_inc( seq, 1UL );
+    cnc_diag_cap_cnt++;
+    cnc_diag_cap_sz += sz;
+  }
+
+  do {
+
+    FD_LOG_INFO(( "Halting capture" ));
+
+    FD_COMPILER_MFENCE();
+    FD_VOLATILE( ring->prod ) = prod;
+    FD_COMPILER_MFENCE();
+
+    FD_LOG_INFO(( "Halted capture" ));
+    fd_cnc_signal( cnc, FD_CNC_SIGNAL_BOOT );
+
+  } while(0);
+
+  return 0;
+}
+
+/* FD_CAPTURE_WRITER_BUF_SZ is the size of the stdio buffer used by the
+   writer (large to keep the number of write syscalls low) */
+
+#define FD_CAPTURE_WRITER_BUF_SZ (1UL<<22)
+
+int
+fd_capture_writer( fd_capture_ring_t * ring,
+                   char const *        pcap_path ) {
+
+  if( FD_UNLIKELY( !ring      ) ) { FD_LOG_WARNING(( "NULL ring"      )); return 1; }
+  if( FD_UNLIKELY( !pcap_path ) ) { FD_LOG_WARNING(( "NULL pcap_path" )); return 1; }
+
+  uchar const * data    = fd_capture_ring_data( ring );
+  ulong         data_sz = ring->data_sz;
+  ulong         cons    = FD_VOLATILE_CONST( ring->cons );
+
+  int err = 0;
+
+  FD_LOG_INFO(( "Creating pcap %s", pcap_path ));
+  FILE * file = fopen( pcap_path, "w" );
+  if( FD_UNLIKELY( !file ) ) {
+    FD_LOG_WARNING(( "fopen( \"%s\" ) failed (%i-%s); discarding captured frags", pcap_path, errno, strerror( errno ) ));
+    err = 1;
+  } else {
+    if( FD_UNLIKELY( setvbuf( file, NULL, _IOFBF, FD_CAPTURE_WRITER_BUF_SZ ) ) )
+      FD_LOG_WARNING(( "setvbuf failed; attempting to continue" ));
+    if( FD_UNLIKELY( !fd_pcapng_fwrite_hdr( file ) ) ) err = 1;
+  }
+
+  ulong write_cnt = 0UL;
+  ulong write_sz  = 0UL;
+
+  for(;;) {
+
+    /* Note: closed is observed before prod such that all frags
+       published before the ring was closed get drained */
+
+    FD_COMPILER_MFENCE();
+    ulong closed = FD_VOLATILE_CONST( ring->closed );
+    ulong prod   = FD_VOLATILE_CONST( ring->prod   );
+    FD_COMPILER_MFENCE();
+
+    if( FD_UNLIKELY( cons==prod ) ) {
+      if( closed ) break;
+      FD_YIELD();
+      continue;
+    }
+
+    while( cons!=prod ) {
+      fd_capture_rec_t const * rec = (fd_capture_rec_t const *)(data + (cons % data_sz));
+      ulong sz = rec->sz;
+
+      if( FD_UNLIKELY( sz==FD_CAPTURE_REC_WRAP ) ) {
+        cons += data_sz - (cons % data_sz);
+        continue;
+      }
+
+      if( FD_LIKELY( !err ) ) {
+        char comment[ 128 ];
+        fd_cstr_printf( comment, 128UL, NULL, "seq %lu sig %lu ctl %lu tsorig %lu tspub %lu",
+                        rec->seq, rec->sig, rec->ctl, rec->tsorig, rec->tspub );
+        if( FD_UNLIKELY( !fd_pcapng_fwrite_pkt( rec->ts, rec+1, sz, comment, file ) ) ) {
+          FD_LOG_WARNING(( "write to \"%s\" failed; discarding remaining captured frags", pcap_path ));
+          err = 1;
+        } else {
+          write_cnt++;
+          write_sz += sz;
+        }
+      }
+
+      cons += sizeof(fd_capture_rec_t) + fd_ulong_align_up( sz, 64UL );
+    }
+
+    /* Release the space back to the capture tile */
+
+    FD_COMPILER_MFENCE();
+    FD_VOLATILE( ring->cons ) = cons;
+    FD_COMPILER_MFENCE();
+  }
+
+  if( file && FD_UNLIKELY( fclose( file ) ) ) {
+    FD_LOG_WARNING(( "fclose( \"%s\" ) failed (%i-%s)", pcap_path, errno, strerror( errno ) ));
+    err = 1;
+  }
+
+  FD_LOG_INFO(( "Wrote %lu frags (%lu payload bytes) to %s", write_cnt, write_sz, pcap_path ));
+  return err;
+}
+
+#endif
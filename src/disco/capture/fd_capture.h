@@ -0,0 +1,184 @@
+#ifndef HEADER_fd_src_disco_capture_fd_capture_h
+#define HEADER_fd_src_disco_capture_fd_capture_h
+
+/* fd_capture provides services to non-invasively capture a tango frag
+   stream to a pcapng file (e.g. to record production traffic for later
+   replay with fd_replay).
+
+   A capture is done by two threads connected by a capture ring.  The
+   capture tile joins the frag stream as an unreliable consumer (such
+   that it never backpressures the producer) and copies each frag's
+   metadata and payload into the ring.  The capture writer, running on a
+   different core, drains the ring to the pcapng file.  As such, the
+   capture tile is only as expensive as a memcpy per frag and slow
+   storage only shows up as dropped frags (never as backpressure).  When
+   the capture tile falls behind the producer, frags are lost to
+   overruns.  When the ring is full (i.e. the writer can't keep up),
+   frags are dropped.  Both are reported through the capture tile's cnc
+   diagnostics.
+
+   Each frag is written as an Ethernet packet whose bytes are the frag
+   payload (the typical use case being frag streams of packets) and
+   whose timestamp is the wallclock when the frag was captured (frags
+   smaller than an Ethernet header are written but will be rejected by
+   the fd_pcap readers).  The
+   remaining frag metadata is preserved in a packet comment of the form:
+
+     seq %lu sig %lu ctl %lu tsorig %lu tspub %lu */
+
+#include "../fd_disco_base.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+/* Beyond the standard FD_CNC_SIGNAL_HALT, FD_CAPTURE_CNC_SIGNAL_ACK can
+   be raised by a cnc thread with an open command session while the
+   capture is in the RUN state.  The capture will transition from
+   ACK->RUN the next time it processes cnc signals to indicate it is
+   running normally.  If a signal other than ACK, HALT, or RUN is
+   raised, it will be logged as unexpected and transitioned by back to
+   RUN. */
+
+#define FD_CAPTURE_CNC_SIGNAL_ACK (4UL)
+
+/* A fd_capture_tile will accumulate to the cnc application region the
+   following tile specific counters:
+
+     CAP_CNT   is the number of frags copied into the capture ring
+     CAP_SZ    is the number of frag payload bytes copied into the capture ring
+     OVRNP_CNT is the number of overruns detected while polling the frag stream (capture tile fell behind the producer)
+     OVRNR_CNT is the number of overruns detected while copying a frag (capture tile fell behind the producer)
+     DROP_CNT  is the number of frags dropped because the capture ring was full (writer fell behind)
+     DROP_SZ   is the number of frag payload bytes dropped because the capture ring was full
+
+   As such, the cnc app region must be at least 64B in size.  IN_BACKP
+   and BACKP_CNT are zero (the capture never backpressures).  None of
+   the diagnostics are cleared at tile startup (as such that they can be
+   accumulated over multiple runs).  Clearing is up to monitoring
+   scripts. */
+
+#define FD_CAPTURE_CNC_DIAG_CAP_CNT   (2UL) /* On 1st cache line of app region, updated by producer, frequently */
+#define FD_CAPTURE_CNC_DIAG_CAP_SZ    (3UL) /* ", frequently */
+#define FD_CAPTURE_CNC_DIAG_OVRNP_CNT (4UL) /* ", rarely (hopefully) */
+#define FD_CAPTURE_CNC_DIAG_OVRNR_CNT (5UL) /* ", rarely (hopefully) */
+#define FD_CAPTURE_CNC_DIAG_DROP_CNT  (6UL) /* ", rarely (hopefully) */
+#define FD_CAPTURE_CNC_DIAG_DROP_SZ   (7UL) /* ", rarely (hopefully) */
+
+/* FD_CAPTURE_RING_{ALIGN,FOOTPRINT} specify the alignment and footprint
+   needed for a capture ring with data_sz bytes of frag storage.  ALIGN
+   is an integer power of 2 of at least double cache line to mitigate
+   various kinds of false sharing.  FOOTPRINT will be an integer
+   multiple of ALIGN.  data_sz is assumed to be valid (see
+   fd_capture_ring_footprint).  These are provided to facilitate compile
+   time declarations. */
+
+#define FD_CAPTURE_RING_ALIGN (128UL)
+#define FD_CAPTURE_RING_FOOTPRINT( data_sz ) (384UL + (data_sz))
+
+/* FD_CAPTURE_RING_DATA_MIN is the minimum data_sz of a capture ring.
+   Each frag takes 64 bytes of metadata plus its payload rounded up to a
+   multiple of 64 in the ring.  This is twice the largest frag. */
+
+#define FD_CAPTURE_RING_DATA_MIN (2UL*(64UL+65536UL))
+
+struct fd_capture_ring_private;
+typedef struct fd_capture_ring_private fd_capture_ring_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_capture_ring_{align,footprint} return the required alignment and
+   footprint of a memory region suitable for use as a capture ring with
+   data_sz bytes of frag storage.  data_sz should be a multiple of 64 of
+   at least FD_CAPTURE_RING_DATA_MIN.  fd_capture_ring_footprint
+   silently returns 0 if data_sz is not valid so callers can diagnose
+   configuration issues.
+
+   fd_capture_ring_new formats an unused memory region for use as a
+   capture ring.  Returns shmem on success and NULL on failure (logs
+   details).  fd_capture_ring_join joins the caller to the capture ring.
+   fd_capture_ring_leave leaves a current local join.
+   fd_capture_ring_delete unformats a memory region used as a capture
+   ring.  These have the usual new/join/leave/delete semantics.  A
+   capture ring should be used by at most one capture tile and one
+   capture writer at a time (and those can be in different processes). */
+
+FD_FN_CONST ulong
+fd_capture_ring_align( void );
+
+FD_FN_CONST ulong
+fd_capture_ring_footprint( ulong data_sz );
+
+void *
+fd_capture_ring_new( void * shmem,
+                     ulong  data_sz );
+
+fd_capture_ring_t *
+fd_capture_ring_join( void * shring );
+
+void *
+fd_capture_ring_leave( fd_capture_ring_t * ring );
+
+void *
+fd_capture_ring_delete( void * shring );
+
+/* fd_capture_ring_close indicates no more frags will be written to the
+   ring.  A writer draining the ring will return once it has written out
+   all frags in the ring.  This should be called after the capture tile
+   using the ring has halted (or failed to boot). */
+
+void
+fd_capture_ring_close( fd_capture_ring_t * ring );
+
+/* fd_capture_tile captures the frag stream described by mcache and
+   dcache into the capture ring.  The tile joins the stream as an
+   unreliable consumer starting from the most recently published frag
+   when the tile boots.  Payloads are resolved relative to the workspace
+   containing dcache (the usual convention for producers publishing
+   into a compact dcache).
+
+   When this is called, the cnc should be in the BOOT state.  Returns 0
+   on a successful run of the capture tile.  That is, the tile booted
+   successfully (transitioning the cnc from BOOT->RUN), ran (handling
+   any application specific cnc signals while running), and (after
+   receiving a HALT signal) halted successfully (transitioning the cnc
+   from HALT->BOOT before return).  Returns a non-zero error code if the
+   tile fails to boot up (logs details ... the cnc will not be
+   transitioned from its original state and thus is likely bootable
+   again if its original state was BOOT).  All frags captured are
+   visible to the writer when this returns.
+
+   lazy is the ballpark interval in ns for how often to do housekeeping
+   (e.g. processing cnc signals and updating diagnostics).  <=0
+   indicates to pick a reasonable default.
+
+   The lifetime of the cnc, mcache, dcache, ring and rng used by this
+   tile should be a superset of this tile's lifetime.  While this tile
+   is running, no other tile should use cnc for its command and control,
+   write to ring or use the rng for anything (and the rng should be
+   seeded distinctly from all other rngs in the system). */
+
+int
+fd_capture_tile( fd_cnc_t *             cnc,     /* Local join to the capture's command-and-control */
+                 fd_frag_meta_t const * mcache,  /* Local join to the mcache of the frag stream to capture */
+                 uchar const *          dcache,  /* Local join to the dcache of the frag stream to capture */
+                 fd_capture_ring_t *    ring,    /* Local join to the capture ring to copy frags into */
+                 long                   lazy,    /* Laziness, <=0 means use a reasonable default */
+                 fd_rng_t *             rng );   /* Local join to the rng this capture should use */
+
+/* fd_capture_writer writes the frags copied into ring by a capture tile
+   to a new pcapng file at pcap_path (truncating any existing file).
+   Blocks the caller until the ring has been closed (see
+   fd_capture_ring_close) and drained.  Returns 0 on success and non-zero
+   on failure (logs details).  If the file can't be created or a write
+   fails, frags are still drained from the ring (such that the capture
+   tile can continue running) but are discarded.  Should be run on a
+   different core than the capture tile. */
+
+int
+fd_capture_writer( fd_capture_ring_t * ring,
+                   char const *        pcap_path );
+
+FD_PROTOTYPES_END
+
+#endif
+
+#endif /* HEADER_fd_src_disco_capture_fd_capture_h */
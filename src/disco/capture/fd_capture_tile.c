@@ -0,0 +1,104 @@
+#include "../fd_disco.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+static int
+writer_main( int     argc,
+             char ** argv ) {
+  (void)argc;
+  return fd_capture_writer( (fd_capture_ring_t *)argv[0], (char const *)argv[1] );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  FD_LOG_NOTICE(( "Init" ));
+
+  char const * _cnc    = fd_env_strip_cmdline_cstr ( &argc, &argv, "--cnc",     NULL, NULL     );
+  char const * _mcache = fd_env_strip_cmdline_cstr ( &argc, &argv, "--mcache",  NULL, NULL     );
+  char const * _dcache = fd_env_strip_cmdline_cstr ( &argc, &argv, "--dcache",  NULL, NULL     );
+  char const * _pcap   = fd_env_strip_cmdline_cstr ( &argc, &argv, "--pcap",    NULL, NULL     );
+  ulong        ring_sz = fd_env_strip_cmdline_ulong( &argc, &argv, "--ring-sz", NULL, 1UL<<30  );
+  long         lazy    = fd_env_strip_cmdline_long ( &argc, &argv, "--lazy",    NULL, 0L       ); /* <=0 <> use default */
+  uint         seed    = fd_env_strip_cmdline_uint ( &argc, &argv, "--seed",    NULL, (uint)(ulong)fd_tickcount() );
+
+  if( FD_UNLIKELY( fd_tile_cnt()<2UL ) ) FD_LOG_ERR(( "this binary needs --tile-cpus to specify at least 2 tiles (capture and writer)" ));
+
+  if( FD_UNLIKELY( !_cnc ) ) FD_LOG_ERR(( "--cnc not specified" ));
+  FD_LOG_NOTICE(( "Joining --cnc %s", _cnc ));
+  fd_cnc_t * cnc = fd_cnc_join( fd_wksp_map( _cnc ) );
+  if( FD_UNLIKELY( !cnc ) ) FD_LOG_ERR(( "fd_cnc_join failed" ));
+
+  if( FD_UNLIKELY( !_mcache ) ) FD_LOG_ERR(( "--mcache not specified" ));
+  FD_LOG_NOTICE(( "Joining --mcache %s", _mcache ));
+  fd_frag_meta_t * mcache = fd_mcache_join( fd_wksp_map( _mcache ) );
+  if( FD_UNLIKELY( !mcache ) ) FD_LOG_ERR(( "fd_mcache_join failed" ));
+
+  if( FD_UNLIKELY( !_dcache ) ) FD_LOG_ERR(( "--dcache not specified" ));
+  FD_LOG_NOTICE(( "Joining --dcache %s", _dcache ));
+  uchar * dcache = fd_dcache_join( fd_wksp_map( _dcache ) );
+  if( FD_UNLIKELY( !dcache ) ) FD_LOG_ERR(( "fd_dcache_join failed" ));
+
+  if( FD_UNLIKELY( !_pcap ) ) FD_LOG_ERR(( "--pcap not specified" ));
+  FD_LOG_NOTICE(( "Using --pcap %s, --lazy %li", _pcap, lazy ));
+
+  FD_LOG_NOTICE(( "Creating rng --seed %u", seed ));
+  fd_rng_t _rng[1];
+  fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, seed, 0UL ) );
+
+  FD_LOG_NOTICE(( "Creating capture ring --ring-sz %lu", ring_sz ));
+  ulong footprint = fd_capture_ring_footprint( ring_sz );
+  if( FD_UNLIKELY( !footprint ) ) FD_LOG_ERR(( "bad --ring-sz" ));
+  ulong  page_sz  = FD_SHMEM_HUGE_PAGE_SZ;
+  ulong  page_cnt = fd_ulong_align_up( footprint, page_sz ) / page_sz;
+  ulong  cpu_idx  = fd_tile_cpu_id( fd_tile_idx() );
+  void * shring   = fd_shmem_acquire( page_sz, page_cnt, cpu_idx );
+  if( FD_UNLIKELY( !shring ) ) FD_LOG_ERR(( "fd_shmem_acquire failed (need at least %lu free huge pages on numa node %lu)",
+                                            page_cnt, fd_shmem_numa_idx( cpu_idx ) ));
+  fd_capture_ring_t * ring = fd_capture_ring_join( fd_capture_ring_new( shring, ring_sz ) );
+  if( FD_UNLIKELY( !ring ) ) FD_LOG_ERR(( "fd_capture_ring_join failed" ));
+
+  FD_LOG_NOTICE(( "Run" ));
+
+  char * writer_argv[2];
+  writer_argv[0] = (char *)ring;
+  writer_argv[1] = (char *)_pcap;
+  fd_tile_exec_t * writer = fd_tile_exec_new( 1UL, writer_main, 0, writer_argv );
+  if( FD_UNLIKELY( !writer ) ) FD_LOG_ERR(( "fd_tile_exec_new failed" ));
+
+  int err = fd_capture_tile( cnc, mcache, dcache, ring, lazy, rng );
+  if( FD_UNLIKELY( err ) ) FD_LOG_WARNING(( "fd_capture_tile failed (%i)", err ));
+
+  fd_capture_ring_close( ring );
+  int writer_err;
+  fd_tile_exec_delete( writer, &writer_err );
+  if( FD_UNLIKELY( err        ) ) FD_LOG_ERR(( "fd_capture_tile failed (%i)", err ));
+  if( FD_UNLIKELY( writer_err ) ) FD_LOG_ERR(( "fd_capture_writer failed (%i)", writer_err ));
+
+  FD_LOG_NOTICE(( "Fini" ));
+
+  fd_capture_ring_delete( fd_capture_ring_leave( ring ) );
+  fd_shmem_release( shring, page_sz, page_cnt );
+  fd_rng_delete( fd_rng_leave( rng ) );
+  fd_wksp_unmap( fd_dcache_leave( dcache ) );
+  fd_wksp_unmap( fd_mcache_leave( mcache ) );
+  fd_wksp_unmap( fd_cnc_leave   ( cnc    ) );
+
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "implement support for this build target" ));
+  fd_halt();
+  return 1;
+}
+
+#endif
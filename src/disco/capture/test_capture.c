@@ -0,0 +1,261 @@
+#include "../fd_disco.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+#include "../../util/net/fd_pcap.h"
+#include <unistd.h>
+
+FD_STATIC_ASSERT( FD_CAPTURE_CNC_SIGNAL_ACK==4UL, unit_test );
+
+FD_STATIC_ASSERT( FD_CAPTURE_CNC_DIAG_CAP_CNT  ==2UL, unit_test );
+FD_STATIC_ASSERT( FD_CAPTURE_CNC_DIAG_CAP_SZ   ==3UL, unit_test );
+FD_STATIC_ASSERT( FD_CAPTURE_CNC_DIAG_OVRNP_CNT==4UL, unit_test );
+FD_STATIC_ASSERT( FD_CAPTURE_CNC_DIAG_OVRNR_CNT==5UL, unit_test );
+FD_STATIC_ASSERT( FD_CAPTURE_CNC_DIAG_DROP_CNT ==6UL, unit_test );
+FD_STATIC_ASSERT( FD_CAPTURE_CNC_DIAG_DROP_SZ  ==7UL, unit_test );
+
+FD_STATIC_ASSERT( FD_CAPTURE_RING_ALIGN==128UL, unit_test );
+
+#define MTU_MAX (9216UL)
+
+struct test_cfg {
+  fd_cnc_t *          cnc;
+  fd_frag_meta_t *    mcache;
+  uchar *             dcache;
+  fd_capture_ring_t * ring;
+  long                lazy;
+  uint                seed;
+  char const *        pcap;
+};
+
+typedef struct test_cfg test_cfg_t;
+
+static int
+capture_tile_main( int     argc,
+                   char ** argv ) {
+  (void)argc;
+  test_cfg_t * cfg = (test_cfg_t *)argv;
+
+  fd_rng_t _rng[1];
+  fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, cfg->seed, 0UL ) );
+
+  FD_TEST( !fd_capture_tile( cfg->cnc, cfg->mcache, cfg->dcache, cfg->ring, cfg->lazy, rng ) );
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+  return 0;
+}
+
+static int
+writer_tile_main( int     argc,
+                  char ** argv ) {
+  (void)argc;
+  test_cfg_t * cfg = (test_cfg_t *)argv;
+  return fd_capture_writer( cfg->ring, cfg->pcap );
+}
+
+/* Frag payloads start with the frag seq and are followed by a pattern
+   derived from it such that captured frags can be validated.  Payloads
+   are at least an Ethernet header in size so the capture is readable
+   with fd_pcap_mmap. */
+
+static void
+frag_fill( uchar * p,
+           ulong   seq,
+           ulong   sz ) {
+  FD_STORE( ulong, p, seq );
+  for( ulong i=8UL; i<sz; i++ ) p[i] = (uchar)(seq+i);
+}
+
+static int
+frag_check( uchar const * p,
+            ulong         sz ) {
+  if( sz<8UL ) return 0;
+  ulong seq = FD_LOAD( ulong, p );
+  for( ulong i=8UL; i<sz; i++ ) if( p[i]!=(uchar)(seq+i) ) return 0;
+  return 1;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  FD_TEST( fd_capture_ring_align()==FD_CAPTURE_RING_ALIGN );
+  FD_TEST( !fd_capture_ring_footprint( 0UL                            ) );
+  FD_TEST( !fd_capture_ring_footprint( FD_CAPTURE_RING_DATA_MIN-64UL  ) );
+  FD_TEST( !fd_capture_ring_footprint( FD_CAPTURE_RING_DATA_MIN+1UL   ) );
+  FD_TEST( fd_capture_ring_footprint( FD_CAPTURE_RING_DATA_MIN )==FD_CAPTURE_RING_FOOTPRINT( FD_CAPTURE_RING_DATA_MIN ) );
+
+  ulong cpu_idx = fd_tile_cpu_id( fd_tile_idx() );
+  if( cpu_idx>fd_shmem_cpu_cnt() ) cpu_idx = 0UL;
+
+  char const * _page_sz = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",  NULL, "normal"                     );
+  ulong        page_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt", NULL, 8192UL                       );
+  ulong        numa_idx = fd_env_strip_cmdline_ulong( &argc, &argv, "--numa-idx", NULL, fd_shmem_numa_idx( cpu_idx ) );
+  char const * pcap     = fd_env_strip_cmdline_cstr ( &argc, &argv, "--pcap",     NULL, "/tmp/test_capture.pcapng"   );
+  ulong        mtu      = fd_env_strip_cmdline_ulong( &argc, &argv, "--mtu",      NULL, 1542UL                       );
+  ulong        depth    = fd_env_strip_cmdline_ulong( &argc, &argv, "--depth",    NULL, 4096UL                       );
+  ulong        ring_sz  = fd_env_strip_cmdline_ulong( &argc, &argv, "--ring-sz",  NULL, 1UL<<20                      );
+  ulong        frag_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--frag-cnt", NULL, 1000000UL                    );
+  long         lazy     = fd_env_strip_cmdline_long ( &argc, &argv, "--lazy",     NULL, 0L /* use default */         );
+
+  ulong page_sz = fd_cstr_to_shmem_page_sz( _page_sz );
+  if( FD_UNLIKELY( !page_sz ) ) FD_LOG_ERR(( "unsupported --page-sz" ));
+  if( FD_UNLIKELY( (mtu<14UL) | (mtu>MTU_MAX) ) ) FD_LOG_ERR(( "bad --mtu" ));
+
+  if( FD_UNLIKELY( fd_tile_cnt()<3UL ) ) {
+    FD_LOG_WARNING(( "skip: this unit test requires at least 3 tiles" ));
+    fd_halt();
+    return 0;
+  }
+
+  long  hb0  = fd_tickcount();
+  ulong seq0 = fd_rng_ulong( rng );
+
+  FD_LOG_NOTICE(( "Creating workspace (--page-cnt %lu, --page-sz %s, --numa-idx %lu)", page_cnt, _page_sz, numa_idx ));
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( page_sz, page_cnt, fd_shmem_cpu_idx( numa_idx ), "wksp", 0UL );
+  FD_TEST( wksp );
+
+  test_cfg_t cfg[1];
+
+  cfg->cnc = fd_cnc_join( fd_cnc_new( fd_wksp_alloc_laddr( wksp, fd_cnc_align(), fd_cnc_footprint( 64UL ), 1UL ),
+                                      64UL, 0UL, hb0 ) );
+  FD_TEST( cfg->cnc );
+
+  FD_LOG_NOTICE(( "Creating mcache (--depth %lu, app_sz 0, seq0 %lu)", depth, seq0 ));
+  cfg->mcache = fd_mcache_join( fd_mcache_new( fd_wksp_alloc_laddr( wksp, fd_mcache_align(), fd_mcache_footprint( depth, 0UL ), 1UL ),
+                                               depth, 0UL, seq0 ) );
+  FD_TEST( cfg->mcache );
+
+  FD_LOG_NOTICE(( "Creating dcache (--mtu %lu, burst 1, compact 1, app_sz 0)", mtu ));
+  ulong data_sz = fd_dcache_req_data_sz( mtu, depth, 1UL, 1 ); FD_TEST( data_sz );
+  cfg->dcache = fd_dcache_join( fd_dcache_new( fd_wksp_alloc_laddr( wksp, fd_dcache_align(), fd_dcache_footprint( data_sz, 0UL ), 1UL ),
+                                               data_sz, 0UL ) );
+  FD_TEST( cfg->dcache );
+
+  FD_LOG_NOTICE(( "Creating capture ring (--ring-sz %lu)", ring_sz ));
+  ulong ring_footprint = fd_capture_ring_footprint( ring_sz );
+  if( FD_UNLIKELY( !ring_footprint ) ) FD_LOG_ERR(( "bad --ring-sz" ));
+  void * shring = fd_wksp_alloc_laddr( wksp, fd_capture_ring_align(), ring_footprint, 1UL ); FD_TEST( shring );
+  FD_TEST( !fd_capture_ring_new( NULL,                 ring_sz ) ); /* NULL shmem */
+  FD_TEST( !fd_capture_ring_new( (char *)shring+64UL,  ring_sz ) ); /* misaligned */
+  FD_TEST( !fd_capture_ring_new( shring,               0UL     ) ); /* bad data_sz */
+  FD_TEST( fd_capture_ring_new( shring, ring_sz )==shring );
+  FD_TEST( !fd_capture_ring_join( NULL ) );
+  cfg->ring = fd_capture_ring_join( shring ); FD_TEST( cfg->ring );
+
+  cfg->lazy = lazy;
+  cfg->seed = 1U;
+  cfg->pcap = pcap;
+
+  FD_LOG_NOTICE(( "Booting (--pcap %s)", pcap ));
+
+  fd_tile_exec_t * writer_exec  = fd_tile_exec_new( 2UL, writer_tile_main,  0, (char **)fd_type_pun( cfg ) ); FD_TEST( writer_exec  );
+  fd_tile_exec_t * capture_exec = fd_tile_exec_new( 1UL, capture_tile_main, 0, (char **)fd_type_pun( cfg ) ); FD_TEST( capture_exec );
+
+  FD_TEST( fd_cnc_wait( cfg->cnc, FD_CNC_SIGNAL_BOOT, (long)5e9, NULL )==FD_CNC_SIGNAL_RUN );
+
+  FD_LOG_NOTICE(( "Publishing (--frag-cnt %lu)", frag_cnt ));
+
+  ulong   chunk0 = fd_dcache_compact_chunk0( wksp, cfg->dcache );
+  ulong   wmark  = fd_dcache_compact_wmark ( wksp, cfg->dcache, mtu );
+  ulong   chunk  = chunk0;
+  ulong   seq    = seq0;
+  ulong   pub_sz = 0UL;
+  for( ulong frag_idx=0UL; frag_idx<frag_cnt; frag_idx++ ) {
+    ulong   sz = 14UL + fd_rng_ulong_roll( rng, mtu-13UL );
+    uchar * p  = (uchar *)fd_chunk_to_laddr( wksp, chunk );
+    frag_fill( p, seq, sz );
+    ulong tspub = (ulong)fd_frag_meta_ts_comp( fd_tickcount() );
+    fd_mcache_publish( cfg->mcache, depth, seq, seq /* sig */, chunk, sz, fd_frag_meta_ctl( 0UL, 1, 1, 0 ), tspub, tspub );
+    chunk   = fd_dcache_compact_next( chunk, sz, chunk0, wmark );
+    seq     = fd_seq_inc( seq, 1UL );
+    pub_sz += sz;
+    if( FD_UNLIKELY( !(frag_idx & 1023UL) ) ) FD_YIELD(); /* Give the capture a chance on oversubscribed hosts */
+  }
+
+  FD_LOG_NOTICE(( "Halting" ));
+
+  FD_TEST( !fd_cnc_open( cfg->cnc ) );
+  fd_cnc_signal( cfg->cnc, FD_CNC_SIGNAL_HALT );
+  FD_TEST( fd_cnc_wait( cfg->cnc, FD_CNC_SIGNAL_HALT, (long)5e9, NULL )==FD_CNC_SIGNAL_BOOT );
+  fd_cnc_close( cfg->cnc );
+
+  int ret;
+  FD_TEST( !fd_tile_exec_delete( capture_exec, &ret ) ); FD_TEST( !ret );
+  fd_capture_ring_close( cfg->ring );
+  FD_TEST( !fd_tile_exec_delete( writer_exec,  &ret ) ); FD_TEST( !ret );
+
+  ulong const * cnc_diag  = (ulong const *)fd_cnc_app_laddr( cfg->cnc );
+  ulong         cap_cnt   = cnc_diag[ FD_CAPTURE_CNC_DIAG_CAP_CNT   ];
+  ulong         cap_sz    = cnc_diag[ FD_CAPTURE_CNC_DIAG_CAP_SZ    ];
+  ulong         ovrnp_cnt = cnc_diag[ FD_CAPTURE_CNC_DIAG_OVRNP_CNT ];
+  ulong         ovrnr_cnt = cnc_diag[ FD_CAPTURE_CNC_DIAG_OVRNR_CNT ];
+  ulong         drop_cnt  = cnc_diag[ FD_CAPTURE_CNC_DIAG_DROP_CNT  ];
+  ulong         drop_sz   = cnc_diag[ FD_CAPTURE_CNC_DIAG_DROP_SZ   ];
+  FD_LOG_NOTICE(( "pub_cnt %lu pub_sz %lu cap_cnt %lu cap_sz %lu ovrnp_cnt %lu ovrnr_cnt %lu drop_cnt %lu drop_sz %lu",
+                  frag_cnt, pub_sz, cap_cnt, cap_sz, ovrnp_cnt, ovrnr_cnt, drop_cnt, drop_sz ));
+  FD_TEST( cap_cnt+drop_cnt<=frag_cnt );
+  FD_TEST( cap_sz +drop_sz <=pub_sz   );
+
+  FD_LOG_NOTICE(( "Validating %s", pcap ));
+
+  fd_pcap_mmap_t reader[1];
+  FD_TEST( fd_pcap_mmap_open( reader, pcap )==reader );
+  FD_TEST( fd_pcap_mmap_fmt( reader )==FD_PCAP_MMAP_FMT_PCAPNG );
+
+  static uchar pkt[ MTU_MAX ];
+  ulong rd_cnt = 0UL;
+  ulong rd_sz  = 0UL;
+  ulong rd_seq = seq0;
+  for(;;) {
+    long  ts;
+    ulong sz = fd_pcap_mmap_next( reader, pkt, MTU_MAX, &ts );
+    if( !sz ) break;
+    FD_TEST( frag_check( pkt, sz ) );
+    ulong pkt_seq = FD_LOAD( ulong, pkt );
+    FD_TEST( !rd_cnt || fd_seq_gt( pkt_seq, rd_seq ) ); /* captured in order */
+    FD_TEST( fd_seq_lt( pkt_seq, seq ) );
+    FD_TEST( ts>0L );
+    rd_seq = pkt_seq;
+    rd_cnt++;
+    rd_sz += sz;
+  }
+  FD_TEST( fd_pcap_mmap_close( reader )==reader );
+  FD_TEST( rd_cnt==cap_cnt );
+  FD_TEST( rd_sz ==cap_sz  );
+
+  unlink( pcap );
+
+  FD_LOG_NOTICE(( "Cleaning up" ));
+
+  FD_TEST( fd_capture_ring_delete( fd_capture_ring_leave( cfg->ring ) )==shring );
+  FD_TEST( !fd_capture_ring_join( shring ) ); /* bad magic */
+  fd_wksp_free_laddr( shring );
+  fd_wksp_free_laddr( fd_dcache_delete( fd_dcache_leave( cfg->dcache ) ) );
+  fd_wksp_free_laddr( fd_mcache_delete( fd_mcache_leave( cfg->mcache ) ) );
+  fd_wksp_free_laddr( fd_cnc_delete   ( fd_cnc_leave   ( cfg->cnc    ) ) );
+
+  fd_wksp_delete_anonymous( wksp );
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
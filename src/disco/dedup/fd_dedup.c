@@ -3,7 +3,9 @@
 #if FD_HAS_HOSTED && FD_HAS_X86
 
 /* A fd_dedup_tile_in has all the state needed for deduping frags from
-   an in.  It fits on exactly one cache line. */
+   an in.  It fits on exactly two cache lines (the latency histogram
+   joins are only used when recording the latencies of a successfully
+   read frag). */
 
 struct __attribute__((aligned(64))) fd_dedup_tile_in {
   fd_frag_meta_t const * mcache;   /* local join to this in's mcache */
@@ -14,10 +16,14 @@ struct __attribute__((aligned(64))) fd_dedup_tile_in {
   ulong *                fseq;     /* local join to the fseq used to return flow control credits the in */
   uint                   accum[6]; /* local diagnostic accumualtors.  These are drained during in housekeeping. */
                                    /* Assumes FD_FSEQ_DIAG_{PUB_CNT,PUB_SZ,FILT_CNT,FILT_SZ,OVRNP_CNT,OVRNR_CONT} are 0:5 */
+  fd_lhist_t *           lat_pub;  /* local join to this in's tspub  latency lhist, NULL if not recorded */
+  fd_lhist_t *           lat_orig; /* local join to this in's tsorig latency lhist, NULL if not recorded */
 };
 
 typedef struct fd_dedup_tile_in fd_dedup_tile_in_t;
 
+FD_STATIC_ASSERT( sizeof(fd_dedup_tile_in_t)==128UL, layout ); /* See FD_DEDUP_TILE_SCRATCH_FOOTPRINT */
+
 /* fd_dedup_tile_in_update returns flow control credits to the in
    assuming that there are at most exposed_cnt frags currently exposed
    to reliable outs and drains the run-time diagnostics accumulated
@@ -65,6 +71,26 @@ fd_dedup_tile_in_update( fd_dedup_tile_in_t * in,
   accum[3] = 0U;              accum[4] = 0U;              accum[5] = 0U;
 }
 
+/* fd_dedup_tile_in_caught_up returns 1 if all in_cnt ins are caught up
+   (i.e. the mcache line where each in's next frag will show up does not
+   yet hold that frag) and 0 otherwise (at least one in has a frag ready
+   or was overrun).  This is used to recheck every in immediately before
+   idling such that a frag that arrived on an in polled earlier in the
+   sweep does not wait out an idle primitive watching a different in. */
+
+static inline int
+fd_dedup_tile_in_caught_up( fd_dedup_tile_in_t const * in,
+                            ulong                      in_cnt ) {
+  for( ulong in_idx=0UL; in_idx<in_cnt; in_idx++ ) {
+    fd_dedup_tile_in_t const * this_in = &in[ in_idx ];
+    FD_COMPILER_MFENCE();
+    ulong seq_found = this_in->mline->seq;
+    FD_COMPILER_MFENCE();
+    if( FD_UNLIKELY( fd_seq_le( this_in->seq, seq_found ) ) ) return 0; /* Ready or overrun */
+  }
+  return 1;
+}
+
 #define SCRATCH_ALLOC( a, s ) (__extension__({                    \
     ulong _scratch_alloc = fd_ulong_align_up( scratch_top, (a) ); \
     scratch_top = _scratch_alloc + (s);                           \
@@ -97,12 +123,15 @@ fd_dedup_tile( fd_cnc_t *              cnc,
                ulong                   in_cnt,
                fd_frag_meta_t const ** in_mcache,
                ulong **                in_fseq,
+               fd_lhist_t **           in_lat_pub,
+               fd_lhist_t **           in_lat_orig,
                fd_tcache_t *           tcache,
                fd_frag_meta_t *        mcache,
                ulong                   out_cnt,
                ulong **                _out_fseq,
                ulong                   cr_max,
                long                    lazy,
+               fd_idle_t *             idle,
                fd_rng_t *              rng,
                void *                  scratch ) {
 
@@ -143,6 +172,9 @@ fd_dedup_tile( fd_cnc_t *              cnc,
   ushort * event_map; /* current mapping of event_seq to event idx, event_map[ event_seq ] is next event to process */
   ulong    async_min; /* minimum number of ticks between processing a housekeeping event, positive integer power of 2 */
 
+  /* idle state */
+  ulong    idle_poll_cnt; /* number of consecutive in polls that found nothing new */
+
   do {
 
     FD_LOG_INFO(( "Booting dedup (in-cnt %lu, out-cnt %lu)", in_cnt, out_cnt ));
@@ -194,6 +226,8 @@ fd_dedup_tile( fd_cnc_t *              cnc,
 
       this_in->mcache = in_mcache[ in_idx ];
       this_in->fseq   = in_fseq  [ in_idx ];
+      this_in->lat_pub  = in_lat_pub  ? in_lat_pub [ in_idx ] : NULL;
+      this_in->lat_orig = in_lat_orig ? in_lat_orig[ in_idx ] : NULL;
       ulong const * this_in_sync = fd_mcache_seq_laddr_const( this_in->mcache );
 
       this_in->depth = fd_mcache_depth( this_in->mcache ); min_in_depth = fd_ulong_min( min_in_depth, this_in->depth );
@@ -324,6 +358,8 @@ fd_dedup_tile( fd_cnc_t *              cnc,
     async_min = fd_tempo_async_min( lazy, event_cnt, (float)fd_tempo_tick_per_ns( NULL ) );
     if( FD_UNLIKELY( !async_min ) ) { FD_LOG_WARNING(( "bad lazy" )); return 1; }
 
+    idle_poll_cnt = 0UL;
+
   } while(0);
 
   FD_LOG_INFO(( "Running dedup" ));
@@ -497,11 +533,24 @@ fd_dedup_tile( fd_cnc_t *              cnc,
         this_in->seq = seq_found; /* Resume from here (probably reasonably current, could query in mcache sync directly instead) */
         this_in->accum[ FD_FSEQ_DIAG_OVRNP_CNT ]++;
       }
-      /* Don't bother with spin as polling multiple locations */
+      /* Don't bother with spin as polling multiple locations.  But if
+         a full sweep of the ins found nothing new and a recheck of all
+         ins still finds nothing new, let the idle policy back off
+         (waiting on the line where this in's next frag will show up).
+         The idle primitive only watches this in's line, so a frag
+         arriving on another in while idle is noticed once the primitive
+         times out (bounded by the wait tier's UMWAIT deadline or the
+         sleep tier's sleep_ns). */
       now = fd_tickcount();
+      idle_poll_cnt++;
+      if( FD_UNLIKELY( idle && idle_poll_cnt>=in_cnt ) && fd_dedup_tile_in_caught_up( in, in_cnt ) )
+        now = fd_idle_wait( idle, &this_in_mline->seq, seq_found, now );
       continue;
     }
 
+    idle_poll_cnt = 0UL;
+    if( idle ) fd_idle_busy( idle, now );
+
     /* We have a new fragment to dedup.  Try to load it.  This attempt
        should always be successful if in producers are honoring our flow
        control.  Since we can cheaply detect if there are
@@ -517,6 +566,7 @@ fd_dedup_tile( fd_cnc_t *              cnc,
     ulong sz       = (ulong)this_in_mline->sz;
     ulong ctl      = (ulong)this_in_mline->ctl;
     ulong tsorig   = (ulong)this_in_mline->tsorig;
+    ulong in_tspub = (ulong)this_in_mline->tspub;
     FD_COMPILER_MFENCE();
     ulong seq_test =        this_in_mline->seq;
     FD_COMPILER_MFENCE();
@@ -555,6 +605,11 @@ fd_dedup_tile( fd_cnc_t *              cnc,
       seq = fd_seq_inc( seq, 1UL );
     }
 
+    /* Record the latencies of this frag */
+
+    if( this_in->lat_pub  ) fd_lhist_sample( this_in->lat_pub,  (ulong)fd_long_max( now - fd_frag_meta_ts_decomp( in_tspub, now ), 0L ) );
+    if( this_in->lat_orig ) fd_lhist_sample( this_in->lat_orig, (ulong)fd_long_max( now - fd_frag_meta_ts_decomp( tsorig,   now ), 0L ) );
+
     /* Windup for the next in poll and accumulate diagnostics */
 
     this_in_seq    = fd_seq_inc( this_in_seq, 1UL );
@@ -46,7 +46,7 @@
 #define FD_DEDUP_TILE_SCRATCH_FOOTPRINT( in_cnt, out_cnt )              \
   FD_LAYOUT_FINI( FD_LAYOUT_APPEND( FD_LAYOUT_APPEND( FD_LAYOUT_APPEND( \
   FD_LAYOUT_APPEND( FD_LAYOUT_APPEND( FD_LAYOUT_INIT,                   \
-    64UL,             (in_cnt)*64UL                           ),        \
+    64UL,             (in_cnt)*128UL                          ),        \
     alignof(ulong *), (out_cnt)*sizeof(ulong *)               ),        \
     alignof(ulong *), (out_cnt)*sizeof(ulong *)               ),        \
     alignof(ulong),   (out_cnt)*sizeof(ulong)                 ),        \
@@ -176,6 +176,14 @@ FD_PROTOTYPES_BEGIN
    pedantically, this more about how applications handle fragment
    streams and less about how the dedup tile functions).
 
+   in_lat_pub and in_lat_orig optionally specify per in latency
+   histograms.  For every frag successfully read from in in_idx, the
+   dedup records now-tspub into in_lat_pub[in_idx] and now-tsorig into
+   in_lat_orig[in_idx] (in ticks, negative latencies from clock skew
+   are recorded as 0).  Either array can be NULL and individual entries
+   can be NULL to not record the corresponding latencies.  The dedup is
+   the single writer of these lhists while it is running.
+
    cr_max is the maximum number of flow control credits the dedup tile
    is allowed for publishing frags to outs.  It represents the maximum
    number of frags a reliable out can lag behind the deduped stream and
@@ -202,6 +210,18 @@ FD_PROTOTYPES_BEGIN
    fast a consumer can process frags typically.  <=0 indicates to pick a
    conservative default.
 
+   idle is the idle policy to use when all ins are caught up (see
+   fd_idle.h).  The dedup backs off (spin, then wait on the mcache line of
+   the next expected frag of the last in polled, then optionally sleep)
+   only after a full sweep of the ins found nothing new and an immediate
+   recheck of every in confirms they are all still caught up.  As only
+   one in's line is watched while idle, a frag arriving on another in
+   can be delayed by up to one idle primitive (the wait tier's bounded
+   UMWAIT or the sleep tier's sleep_ns).  NULL indicates
+   to poll the ins continuously as fast as possible (lowest latency,
+   highest power).  While the tile is running, no other tile should use
+   idle for anything.
+
    scratch points to tile scratch memory.  fd_dedup_tile_scratch_align
    and fd_dedup_tile_scratch_footprint return the required alignment and
    footprint needed for this region.  This memory region is exclusively
@@ -221,7 +241,7 @@ FD_PROTOTYPES_BEGIN
    and outputs also use their cnc and fseq application regions similarly
    for monitoring simplicity / consistency.
 
-   The lifetime of the cnc, mcaches, fseqs, tcache, rng and scratch used
+   The lifetime of the cnc, mcaches, fseqs, tcache, idle, rng and scratch used
    by this tile should be a superset of this tile's lifetime.  While
    this tile is running, no other tile should use cnc for its command
    and control, modify the tcache, publish into mcache, use the rng for
@@ -246,18 +266,21 @@ fd_dedup_tile_scratch_footprint( ulong in_cnt,
                                  ulong out_cnt );
 
 int
-fd_dedup_tile( fd_cnc_t *              cnc,       /* Local join to the dedup's command-and-control */
-               ulong                   in_cnt,    /* Number of input mcaches to dedup, inputs are indexed [0,in_cnt) */
-               fd_frag_meta_t const ** in_mcache, /* in_mcache[in_idx] is the local join to input in_idx's mcache */
-               ulong **                in_fseq,   /* in_fseq  [in_idx] is the local join to input in_idx's fseq */
-               fd_tcache_t *           tcache,    /* Local join to the dedup's unique signature cache */
-               fd_frag_meta_t *        mcache,    /* Local join to the dedup's frag stream output mcache */
-               ulong                   out_cnt,   /* Number of reliable consumers, reliable consumers are indexed [0,out_cnt) */
-               ulong **                out_fseq,  /* out_fseq[out_idx] is the local join to reliable consumer out_idx's fseq */
-               ulong                   cr_max,    /* Maximum number of flow control credits, 0 means use a reasonable default */
-               long                    lazy,      /* Lazyiness, <=0 means use a reasonable default */
-               fd_rng_t *              rng,       /* Local join to the rng this dedup should use */
-               void *                  scratch ); /* Tile scratch memory */
+fd_dedup_tile( fd_cnc_t *              cnc,         /* Local join to the dedup's command-and-control */
+               ulong                   in_cnt,      /* Number of input mcaches to dedup, inputs are indexed [0,in_cnt) */
+               fd_frag_meta_t const ** in_mcache,   /* in_mcache[in_idx] is the local join to input in_idx's mcache */
+               ulong **                in_fseq,     /* in_fseq  [in_idx] is the local join to input in_idx's fseq */
+               fd_lhist_t **           in_lat_pub,  /* in_lat_pub [in_idx] is the local join to input in_idx's tspub  latency lhist, NULL if n/a */
+               fd_lhist_t **           in_lat_orig, /* in_lat_orig[in_idx] is the local join to input in_idx's tsorig latency lhist, NULL if n/a */
+               fd_tcache_t *           tcache,      /* Local join to the dedup's unique signature cache */
+               fd_frag_meta_t *        mcache,      /* Local join to the dedup's frag stream output mcache */
+               ulong                   out_cnt,     /* Number of reliable consumers, reliable consumers are indexed [0,out_cnt) */
+               ulong **                out_fseq,    /* out_fseq[out_idx] is the local join to reliable consumer out_idx's fseq */
+               ulong                   cr_max,      /* Maximum number of flow control credits, 0 means use a reasonable default */
+               long                    lazy,        /* Lazyiness, <=0 means use a reasonable default */
+               fd_idle_t *             idle,        /* Local join to the idle policy this dedup should use, NULL means never idle */
+               fd_rng_t *              rng,         /* Local join to the rng this dedup should use */
+               void *                  scratch );   /* Tile scratch memory */
 
 FD_PROTOTYPES_END
 
@@ -14,12 +14,18 @@ main( int     argc,
   char const * _cnc        = fd_env_strip_cmdline_cstr ( &argc, &argv, "--cnc",        NULL, NULL );
   char const * _in_mcaches = fd_env_strip_cmdline_cstr ( &argc, &argv, "--in-mcaches", NULL, ""   );
   char const * _in_fseqs   = fd_env_strip_cmdline_cstr ( &argc, &argv, "--in-fseqs",   NULL, ""   );
+  char const * _in_lat_pubs  = fd_env_strip_cmdline_cstr( &argc, &argv, "--in-lat-pubs",  NULL, "" ); /* "" <> don't record */
+  char const * _in_lat_origs = fd_env_strip_cmdline_cstr( &argc, &argv, "--in-lat-origs", NULL, "" ); /* "" <> don't record */
   char const * _tcache     = fd_env_strip_cmdline_cstr ( &argc, &argv, "--tcache",     NULL, NULL );
   char const * _mcache     = fd_env_strip_cmdline_cstr ( &argc, &argv, "--mcache",     NULL, NULL );
   char const * _out_fseqs  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--out-fseqs",  NULL, ""   );
   ulong        cr_max      = fd_env_strip_cmdline_ulong( &argc, &argv, "--cr-max",     NULL, 0UL  ); /*   0 <> use default */
   long         lazy        = fd_env_strip_cmdline_long ( &argc, &argv, "--lazy",       NULL, 0L   ); /* <=0 <> use default */
   uint         seed        = fd_env_strip_cmdline_uint ( &argc, &argv, "--seed",       NULL, (uint)(ulong)fd_tickcount() );
+  int          idle_en     = fd_env_strip_cmdline_int  ( &argc, &argv, "--idle",       NULL, 0    ); /*   0 <> never idle */
+  long         idle_spin   = fd_env_strip_cmdline_long ( &argc, &argv, "--idle-spin",  NULL, -1L  ); /*  <0 <> use default */
+  long         idle_wait   = fd_env_strip_cmdline_long ( &argc, &argv, "--idle-wait",  NULL, -1L  ); /*  <0 <> use default */
+  long         idle_sleep  = fd_env_strip_cmdline_long ( &argc, &argv, "--idle-sleep", NULL, -1L  ); /*  <0 <> use default */
 
   if( FD_UNLIKELY( !_cnc ) ) FD_LOG_ERR(( "--cnc not specified" ));
   FD_LOG_NOTICE(( "Joining --cnc %s", _cnc ));
@@ -48,6 +54,26 @@ main( int     argc,
     if( FD_UNLIKELY( !in_fseq[ in_idx ] ) ) FD_LOG_ERR(( "fd_fseq_join failed" ));
   }
 
+  char * _in_lat_pub [ 256 ];
+  char * _in_lat_orig[ 256 ];
+  ulong in_lat_pub_cnt  = fd_cstr_tokenize( _in_lat_pub,  256UL, (char *)_in_lat_pubs,  ',' ); /* argv is non-const */
+  ulong in_lat_orig_cnt = fd_cstr_tokenize( _in_lat_orig, 256UL, (char *)_in_lat_origs, ',' ); /* argv is non-const */
+  if( FD_UNLIKELY( (!!in_lat_pub_cnt ) & (in_lat_pub_cnt !=in_cnt) ) ) FD_LOG_ERR(( "--in-mcaches and --in-lat-pubs mismatch"  ));
+  if( FD_UNLIKELY( (!!in_lat_orig_cnt) & (in_lat_orig_cnt!=in_cnt) ) ) FD_LOG_ERR(( "--in-mcaches and --in-lat-origs mismatch" ));
+
+  fd_lhist_t * in_lat_pub [ 256 ];
+  fd_lhist_t * in_lat_orig[ 256 ];
+  for( ulong in_idx=0UL; in_idx<in_lat_pub_cnt; in_idx++ ) {
+    FD_LOG_NOTICE(( "Joining --in-lat-pubs[%lu] %s", in_idx, _in_lat_pub[ in_idx ] ));
+    in_lat_pub[ in_idx ] = fd_lhist_join( fd_wksp_map( _in_lat_pub[ in_idx ] ) );
+    if( FD_UNLIKELY( !in_lat_pub[ in_idx ] ) ) FD_LOG_ERR(( "fd_lhist_join failed" ));
+  }
+  for( ulong in_idx=0UL; in_idx<in_lat_orig_cnt; in_idx++ ) {
+    FD_LOG_NOTICE(( "Joining --in-lat-origs[%lu] %s", in_idx, _in_lat_orig[ in_idx ] ));
+    in_lat_orig[ in_idx ] = fd_lhist_join( fd_wksp_map( _in_lat_orig[ in_idx ] ) );
+    if( FD_UNLIKELY( !in_lat_orig[ in_idx ] ) ) FD_LOG_ERR(( "fd_lhist_join failed" ));
+  }
+
   if( FD_UNLIKELY( !_tcache ) ) FD_LOG_ERR(( "--tcache not specified" ));
   FD_LOG_NOTICE(( "Joining --tcache %s", _tcache ));
   fd_tcache_t * tcache = fd_tcache_join( fd_wksp_map( _tcache ) );
@@ -75,6 +101,14 @@ main( int     argc,
   fd_rng_t _rng[1];
   fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, seed, 0UL ) );
 
+  fd_idle_t * idle = NULL;
+  if( idle_en ) {
+    FD_LOG_NOTICE(( "Creating idle --idle-spin %li --idle-wait %li --idle-sleep %li", idle_spin, idle_wait, idle_sleep ));
+    static fd_idle_t _idle[1];
+    idle = fd_idle_join( fd_idle_new( _idle, idle_spin, idle_wait, idle_sleep ) );
+    if( FD_UNLIKELY( !idle ) ) FD_LOG_ERR(( "fd_idle_join failed" ));
+  }
+
   FD_LOG_NOTICE(( "Creating scratch" ));
   ulong footprint = fd_dedup_tile_scratch_footprint( in_cnt, out_cnt );
   if( FD_UNLIKELY( !footprint ) ) FD_LOG_ERR(( "fd_dedup_tile_scratch_footprint failed" ));
@@ -87,16 +121,21 @@ main( int     argc,
 
   FD_LOG_NOTICE(( "Run" ));
 
-  int err = fd_dedup_tile( cnc, in_cnt, in_mcache, in_fseq, tcache, mcache, out_cnt, out_fseq, cr_max, lazy, rng, scratch );
+  int err = fd_dedup_tile( cnc, in_cnt, in_mcache, in_fseq,
+                           in_lat_pub_cnt ? in_lat_pub : NULL, in_lat_orig_cnt ? in_lat_orig : NULL,
+                           tcache, mcache, out_cnt, out_fseq, cr_max, lazy, idle, rng, scratch );
   if( FD_UNLIKELY( err ) ) FD_LOG_ERR(( "fd_dedup_tile failed (%i)", err ));
 
   FD_LOG_NOTICE(( "Fini" ));
 
   fd_shmem_release( scratch, page_sz, page_cnt );
+  if( idle ) fd_idle_delete( fd_idle_leave( idle ) );
   fd_rng_delete( fd_rng_leave( rng ) );
   for( ulong out_idx=out_cnt; out_idx; out_idx-- ) fd_wksp_unmap( fd_fseq_leave( out_fseq[ out_idx-1UL ] ) );
   fd_wksp_unmap( fd_mcache_leave( mcache ) );
   fd_wksp_unmap( fd_tcache_leave( tcache ) );
+  for( ulong in_idx=in_lat_orig_cnt; in_idx; in_idx-- ) fd_wksp_unmap( fd_lhist_leave( in_lat_orig[ in_idx-1UL ] ) );
+  for( ulong in_idx=in_lat_pub_cnt;  in_idx; in_idx-- ) fd_wksp_unmap( fd_lhist_leave( in_lat_pub [ in_idx-1UL ] ) );
   for( ulong in_idx=in_cnt; in_idx; in_idx-- ) fd_wksp_unmap( fd_fseq_leave  ( in_fseq  [ in_idx-1UL ] ) );
   for( ulong in_idx=in_cnt; in_idx; in_idx-- ) fd_wksp_unmap( fd_mcache_leave( in_mcache[ in_idx-1UL ] ) );
   fd_wksp_unmap( fd_cnc_leave( cnc ) );
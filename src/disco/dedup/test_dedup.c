@@ -29,6 +29,7 @@ struct test_cfg {
   uchar *     dedup_scratch_mem;
   ulong       dedup_cr_max;
   long        dedup_lazy;
+  int         dedup_idle;
   uint        dedup_seed;
 
   ulong       rx_cnt;
@@ -279,6 +280,14 @@ dedup_tile_main( int     argc,
   for( ulong tx_idx=0UL; tx_idx<cfg->tx_cnt; tx_idx++ )
     tx_fseq[ tx_idx ] = fd_fseq_join( cfg->tx_fseq_mem + tx_idx*cfg->tx_fseq_footprint );
 
+  static fd_lhist_t _tx_lat[ 2 ][ 128 ]; /* Tile local, only used for diagnostics */
+  fd_lhist_t * tx_lat_pub [ 128 ];
+  fd_lhist_t * tx_lat_orig[ 128 ];
+  for( ulong tx_idx=0UL; tx_idx<cfg->tx_cnt; tx_idx++ ) {
+    tx_lat_pub [ tx_idx ] = fd_lhist_join( fd_lhist_new( &_tx_lat[0][ tx_idx ] ) );
+    tx_lat_orig[ tx_idx ] = fd_lhist_join( fd_lhist_new( &_tx_lat[1][ tx_idx ] ) );
+  }
+
   fd_tcache_t *    dedup_tcache = fd_tcache_join( cfg->dedup_tcache_mem );
   fd_frag_meta_t * dedup_mcache = fd_mcache_join( cfg->dedup_mcache_mem );
 
@@ -289,10 +298,26 @@ dedup_tile_main( int     argc,
   fd_rng_t _rng[1];
   fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, cfg->dedup_seed, 0UL ) );
 
-  int err = fd_dedup_tile( cnc, cfg->tx_cnt, tx_mcache, tx_fseq, dedup_tcache, dedup_mcache, cfg->rx_cnt, rx_fseq,
-                           cfg->dedup_cr_max, cfg->dedup_lazy, rng, cfg->dedup_scratch_mem );
+  fd_idle_t _idle[1];
+  fd_idle_t * idle = cfg->dedup_idle ? fd_idle_join( fd_idle_new( _idle, -1L, -1L, -1L ) ) : NULL;
+
+  int err = fd_dedup_tile( cnc, cfg->tx_cnt, tx_mcache, tx_fseq, tx_lat_pub, tx_lat_orig,
+                           dedup_tcache, dedup_mcache, cfg->rx_cnt, rx_fseq,
+                           cfg->dedup_cr_max, cfg->dedup_lazy, idle, rng, cfg->dedup_scratch_mem );
   if( FD_UNLIKELY( err ) ) FD_LOG_ERR(( "fd_dedup_tile failed (%i)", err ));
 
+  if( idle ) fd_idle_delete( fd_idle_leave( idle ) );
+  for( ulong tx_idx=cfg->tx_cnt; tx_idx; tx_idx-- ) {
+    static ulong snap[ FD_LHIST_BIN_CNT ];
+    fd_lhist_snap( tx_lat_pub[ tx_idx-1UL ], snap );
+    FD_LOG_NOTICE(( "tx %lu: tspub  latency p50 %lu p99 %lu p999 %lu ticks", tx_idx-1UL,
+                    fd_lhist_quantile( snap, 0.5 ), fd_lhist_quantile( snap, 0.99 ), fd_lhist_quantile( snap, 0.999 ) ));
+    fd_lhist_snap( tx_lat_orig[ tx_idx-1UL ], snap );
+    FD_LOG_NOTICE(( "tx %lu: tsorig latency p50 %lu p99 %lu p999 %lu ticks", tx_idx-1UL,
+                    fd_lhist_quantile( snap, 0.5 ), fd_lhist_quantile( snap, 0.99 ), fd_lhist_quantile( snap, 0.999 ) ));
+    fd_lhist_delete( fd_lhist_leave( tx_lat_orig[ tx_idx-1UL ] ) );
+    fd_lhist_delete( fd_lhist_leave( tx_lat_pub [ tx_idx-1UL ] ) );
+  }
   fd_rng_delete( fd_rng_leave( rng ) );
   for( ulong rx_idx=cfg->rx_cnt; rx_idx; rx_idx-- ) fd_fseq_leave  ( rx_fseq  [ rx_idx-1UL ] );
   fd_mcache_leave( dedup_mcache );
@@ -476,6 +501,7 @@ main( int     argc,
   ulong        dedup_depth    = fd_env_strip_cmdline_ulong( &argc, &argv, "--dedup-depth",    NULL, 32768UL                    );
   ulong        dedup_cr_max   = fd_env_strip_cmdline_ulong( &argc, &argv, "--dedup-cr-max",   NULL, 0UL /* use default */      );
   long         dedup_lazy     = fd_env_strip_cmdline_long ( &argc, &argv, "--dedup-lazy",     NULL, 0L /* use default */       );
+  int          dedup_idle     = fd_env_strip_cmdline_int  ( &argc, &argv, "--dedup-idle",     NULL, 0  /* never idle */        );
   ulong        rx_cnt         = fd_env_strip_cmdline_ulong( &argc, &argv, "--rx-cnt",         NULL, 2UL                        );
   int          rx_lazy        = fd_env_strip_cmdline_int  ( &argc, &argv, "--rx-lazy",        NULL, 7                          );
   ulong        test_depth     = fd_env_strip_cmdline_ulong( &argc, &argv, "--test-depth",     NULL, 2046UL                     );
@@ -604,6 +630,7 @@ main( int     argc,
   cfg->dedup_scratch_mem = dedup_scratch_mem;
   cfg->dedup_cr_max      = dedup_cr_max;
   cfg->dedup_lazy        = dedup_lazy;
+  cfg->dedup_idle        = dedup_idle;
   cfg->dedup_seed        = rng_seq++;
 
   cfg->rx_cnt        = rx_cnt;
@@ -663,8 +690,8 @@ main( int     argc,
   for( ulong tile_idx=1UL; tile_idx<tile_cnt; tile_idx++ )
     FD_TEST( fd_cnc_wait( cnc[ tile_idx ], FD_CNC_SIGNAL_BOOT, (long)5e9, NULL )==FD_CNC_SIGNAL_RUN );
 
-  FD_LOG_NOTICE(( "Running (--duration %li ns, --tx-lazy %li ns, --dedup-cr-max %lu, --dedup-lazy %li ns, --rx-lazy %i)",
-                  duration, tx_lazy, dedup_cr_max, dedup_lazy, rx_lazy ));
+  FD_LOG_NOTICE(( "Running (--duration %li ns, --tx-lazy %li ns, --dedup-cr-max %lu, --dedup-lazy %li ns, --dedup-idle %i, --rx-lazy %i)",
+                  duration, tx_lazy, dedup_cr_max, dedup_lazy, dedup_idle, rx_lazy ));
 
   /* FIXME: DO MONITORING WHILE RUNNING */
   fd_log_sleep( duration );
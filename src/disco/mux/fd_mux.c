@@ -3,7 +3,9 @@
 #if FD_HAS_HOSTED && FD_HAS_X86
 
 /* A fd_mux_tile_in has all the state needed for muxing frags from an
-   in.  It fits on exactly one cache line. */
+   in.  It fits on exactly two cache lines (the latency histogram
+   joins are only used when recording the latencies of a successfully
+   read frag). */
 
 struct __attribute__((aligned(64))) fd_mux_tile_in {
   fd_frag_meta_t const * mcache;   /* local join to this in's mcache */
@@ -14,10 +16,14 @@ struct __attribute__((aligned(64))) fd_mux_tile_in {
   ulong *                fseq;     /* local join to the fseq used to return flow control credits the in */
   uint                   accum[6]; /* local diagnostic accumualtors.  These are drained during in housekeeping. */
                                    /* Assumes FD_FSEQ_DIAG_{PUB_CNT,PUB_SZ,FILT_CNT,FILT_SZ,OVRNP_CNT,OVRNR_CONT} are 0:5 */
+  fd_lhist_t *           lat_pub;  /* local join to this in's tspub  latency lhist, NULL if not recorded */
+  fd_lhist_t *           lat_orig; /* local join to this in's tsorig latency lhist, NULL if not recorded */
 };
 
 typedef struct fd_mux_tile_in fd_mux_tile_in_t;
 
+FD_STATIC_ASSERT( sizeof(fd_mux_tile_in_t)==128UL, layout ); /* See FD_MUX_TILE_SCRATCH_FOOTPRINT */
+
 /* fd_mux_tile_in_update returns flow control credits to the in assuming
    that there are at most exposed_cnt frags currently exposed to
    reliable outs and drains the run-time diagnostics accumulated since
@@ -65,6 +71,26 @@ fd_mux_tile_in_update( fd_mux_tile_in_t * in,
   accum[3] = 0U;              accum[4] = 0U;              accum[5] = 0U;
 }
 
+/* fd_mux_tile_in_caught_up returns 1 if all in_cnt ins are caught up
+   (i.e. the mcache line where each in's next frag will show up does not
+   yet hold that frag) and 0 otherwise (at least one in has a frag ready
+   or was overrun).  This is used to recheck every in immediately before
+   idling such that a frag that arrived on an in polled earlier in the
+   sweep does not wait out an idle primitive watching a different in. */
+
+static inline int
+fd_mux_tile_in_caught_up( fd_mux_tile_in_t const * in,
+                          ulong                    in_cnt ) {
+  for( ulong in_idx=0UL; in_idx<in_cnt; in_idx++ ) {
+    fd_mux_tile_in_t const * this_in = &in[ in_idx ];
+    FD_COMPILER_MFENCE();
+    ulong seq_found = this_in->mline->seq;
+    FD_COMPILER_MFENCE();
+    if( FD_UNLIKELY( fd_seq_le( this_in->seq, seq_found ) ) ) return 0; /* Ready or overrun */
+  }
+  return 1;
+}
+
 #define SCRATCH_ALLOC( a, s ) (__extension__({                    \
     ulong _scratch_alloc = fd_ulong_align_up( scratch_top, (a) ); \
     scratch_top = _scratch_alloc + (s);                           \
@@ -97,11 +123,17 @@ fd_mux_tile( fd_cnc_t *              cnc,
              ulong                   in_cnt,
              fd_frag_meta_t const ** in_mcache,
              ulong **                in_fseq,
+             fd_lhist_t **           in_lat_pub,
+             fd_lhist_t **           in_lat_orig,
              fd_frag_meta_t *        mcache,
              ulong                   out_cnt,
              ulong **                _out_fseq,
+             ulong                   out_grp_cnt,
+             ulong **                out_grp_fseq,
              ulong                   cr_max,
              long                    lazy,
+             fd_idle_t *             idle,
+             fd_tlog_t *             tlog,
              fd_rng_t *              rng,
              void *                  scratch ) {
 
@@ -133,9 +165,19 @@ fd_mux_tile( fd_cnc_t *              cnc,
   ushort *   event_map; /* current mapping of event_seq to event idx, event_map[ event_seq ] is next event to process */
   ulong      async_min; /* minimum number of ticks between processing a housekeeping event, positive integer power of 2 */
 
+  /* idle state */
+  ulong      idle_poll_cnt; /* number of consecutive in polls that found nothing new */
+
+  /* tlog state */
+  ulong      tlog_fmt_run;   /* tlog format ids for the events this mux traces (see fd_mux.h), unused if tlog is NULL */
+  ulong      tlog_fmt_halt;
+  ulong      tlog_fmt_backp;
+  ulong      tlog_fmt_ovrnp;
+  ulong      tlog_fmt_ovrnr;
+
   do {
 
-    FD_LOG_INFO(( "Booting mux (in-cnt %lu, out-cnt %lu)", in_cnt, out_cnt ));
+    FD_LOG_INFO(( "Booting mux (in-cnt %lu, out-cnt %lu, out-grp-cnt %lu)", in_cnt, out_cnt, out_grp_cnt ));
     if( FD_UNLIKELY( in_cnt >FD_MUX_TILE_IN_MAX  ) ) { FD_LOG_WARNING(( "in_cnt too large"  )); return 1; }
     if( FD_UNLIKELY( out_cnt>FD_MUX_TILE_OUT_MAX ) ) { FD_LOG_WARNING(( "out_cnt too large" )); return 1; }
 
@@ -184,6 +226,8 @@ fd_mux_tile( fd_cnc_t *              cnc,
 
       this_in->mcache = in_mcache[ in_idx ];
       this_in->fseq   = in_fseq  [ in_idx ];
+      this_in->lat_pub  = in_lat_pub  ? in_lat_pub [ in_idx ] : NULL;
+      this_in->lat_orig = in_lat_orig ? in_lat_orig[ in_idx ] : NULL;
       ulong const * this_in_sync = fd_mcache_seq_laddr_const( this_in->mcache );
 
       this_in->depth  = fd_mcache_depth( this_in->mcache ); min_in_depth = fd_ulong_min( min_in_depth, this_in->depth );
@@ -319,6 +363,35 @@ fd_mux_tile( fd_cnc_t *              cnc,
       out_seq [ out_idx ] = fd_fseq_query( out_fseq[ out_idx ] );
     }
 
+    /* If the outs are grouped, initialize each group's aggregate to
+       the current position of its slowest out (the outs will keep it
+       current from here) and then treat the groups as the outs for the
+       rest of the run.  Since out_grp_cnt<=out_cnt, the out_* scratch
+       arrays have room for the groups. */
+
+    if( out_grp_cnt ) {
+      if( FD_UNLIKELY( out_grp_cnt>out_cnt ) ) {
+        FD_LOG_WARNING(( "out_grp_cnt %lu must be in [0,%lu]", out_grp_cnt, out_cnt ));
+        return 1;
+      }
+      if( FD_UNLIKELY( !out_grp_fseq ) ) { FD_LOG_WARNING(( "NULL out_grp_fseq" )); return 1; }
+      for( ulong grp_idx=0UL; grp_idx<out_grp_cnt; grp_idx++ )
+        if( FD_UNLIKELY( !out_grp_fseq[ grp_idx ] ) ) { FD_LOG_WARNING(( "NULL out_grp_fseq[%lu]", grp_idx )); return 1; }
+
+      for( ulong grp_idx=0UL; grp_idx<out_grp_cnt; grp_idx++ ) {
+        ulong out0 = fd_fctl_rx_grp_rx0( grp_idx,     out_cnt, out_grp_cnt );
+        ulong out1 = fd_fctl_rx_grp_rx0( grp_idx+1UL, out_cnt, out_grp_cnt );
+        fd_fctl_rx_agg_update( out_grp_fseq[ grp_idx ], out_fseq + out0, out1-out0 );
+      }
+
+      for( ulong grp_idx=0UL; grp_idx<out_grp_cnt; grp_idx++ ) {
+        out_fseq[ grp_idx ] = out_grp_fseq[ grp_idx ];
+        out_slow[ grp_idx ] = (ulong *)fd_fseq_app_laddr( out_grp_fseq[ grp_idx ] ) + FD_FSEQ_DIAG_SLOW_CNT;
+        out_seq [ grp_idx ] = fd_fseq_query( out_fseq[ grp_idx ] );
+      }
+      out_cnt = out_grp_cnt;
+    }
+
     /* housekeeping init */
 
     if( lazy<=0L ) lazy = fd_tempo_lazy_default( cr_max );
@@ -338,9 +411,32 @@ fd_mux_tile( fd_cnc_t *              cnc,
     async_min = fd_tempo_async_min( lazy, event_cnt, (float)fd_tempo_tick_per_ns( NULL ) );
     if( FD_UNLIKELY( !async_min ) ) { FD_LOG_WARNING(( "bad lazy" )); return 1; }
 
+    idle_poll_cnt = 0UL;
+
+    /* tlog init */
+
+    tlog_fmt_run   = 0UL;
+    tlog_fmt_halt  = 0UL;
+    tlog_fmt_backp = 0UL;
+    tlog_fmt_ovrnp = 0UL;
+    tlog_fmt_ovrnr = 0UL;
+    if( tlog ) {
+      tlog_fmt_run   = fd_tlog_fmt( tlog, "mux run seq %lu cr_avail %lu" );
+      tlog_fmt_halt  = fd_tlog_fmt( tlog, "mux halt seq %lu" );
+      tlog_fmt_backp = fd_tlog_fmt( tlog, "mux backpressured seq %lu" );
+      tlog_fmt_ovrnp = fd_tlog_fmt( tlog, "mux in overrun while polling seq %lu found %lu" );
+      tlog_fmt_ovrnr = fd_tlog_fmt( tlog, "mux in overrun while reading seq %lu found %lu" );
+      if( FD_UNLIKELY( (tlog_fmt_run  ==ULONG_MAX) | (tlog_fmt_halt ==ULONG_MAX) | (tlog_fmt_backp==ULONG_MAX) |
+                       (tlog_fmt_ovrnp==ULONG_MAX) | (tlog_fmt_ovrnr==ULONG_MAX) ) ) {
+        FD_LOG_WARNING(( "fd_tlog_fmt failed" ));
+        return 1;
+      }
+    }
+
   } while(0);
 
   FD_LOG_INFO(( "Running mux" ));
+  if( tlog ) FD_TLOG( tlog, tlog_fmt_run, seq, cr_avail );
   fd_cnc_signal( cnc, FD_CNC_SIGNAL_RUN );
   long then = fd_tickcount();
   long now  = then;
@@ -464,6 +560,7 @@ fd_mux_tile( fd_cnc_t *              cnc,
        from not backpressured to backpressured. */
 
     if( FD_UNLIKELY( !cr_avail ) ) {
+      if( FD_UNLIKELY( tlog && !cnc_diag_in_backp ) ) FD_TLOG( tlog, tlog_fmt_backp, seq );
       cnc_diag_backp_cnt += (ulong)!cnc_diag_in_backp;
       cnc_diag_in_backp   = 1UL;
       FD_SPIN_PAUSE();
@@ -491,14 +588,28 @@ fd_mux_tile( fd_cnc_t *              cnc,
     long diff = fd_seq_diff( this_in_seq, seq_found );
     if( FD_UNLIKELY( diff ) ) { /* Caught up or overrun, optimize for new frag case */
       if( FD_UNLIKELY( diff<0L ) ) { /* Overrun (impossible if in is honoring our flow control) */
+        if( tlog ) FD_TLOG( tlog, tlog_fmt_ovrnp, this_in_seq, seq_found );
         this_in->seq = seq_found; /* Resume from here (probably reasonably current, could query in mcache sync directly instead) */
         this_in->accum[ FD_FSEQ_DIAG_OVRNP_CNT ]++;
       }
-      /* Don't bother with spin as polling multiple locations */
+      /* Don't bother with spin as polling multiple locations.  But if
+         a full sweep of the ins found nothing new and a recheck of all
+         ins still finds nothing new, let the idle policy back off
+         (waiting on the line where this in's next frag will show up).
+         The idle primitive only watches this in's line, so a frag
+         arriving on another in while idle is noticed once the primitive
+         times out (bounded by the wait tier's UMWAIT deadline or the
+         sleep tier's sleep_ns). */
       now = fd_tickcount();
+      idle_poll_cnt++;
+      if( FD_UNLIKELY( idle && idle_poll_cnt>=in_cnt ) && fd_mux_tile_in_caught_up( in, in_cnt ) )
+        now = fd_idle_wait( idle, &this_in_mline->seq, seq_found, now );
       continue;
     }
 
+    idle_poll_cnt = 0UL;
+    if( idle ) fd_idle_busy( idle, now );
+
     /* We have a new fragment to mux.  Try to load it.  This attempt
        should always be successful if in producers are honoring our flow
        control.  Since we can cheaply detect if there are
@@ -514,11 +625,13 @@ fd_mux_tile( fd_cnc_t *              cnc,
     ulong sz       = (ulong)this_in_mline->sz;
     ulong ctl      = (ulong)this_in_mline->ctl;
     ulong tsorig   = (ulong)this_in_mline->tsorig;
+    ulong in_tspub = (ulong)this_in_mline->tspub;
     FD_COMPILER_MFENCE();
     ulong seq_test =        this_in_mline->seq;
     FD_COMPILER_MFENCE();
 
     if( FD_UNLIKELY( fd_seq_ne( seq_test, seq_found ) ) ) { /* Overrun while reading (impossible if this_in honoring our fctl) */
+      if( tlog ) FD_TLOG( tlog, tlog_fmt_ovrnr, this_in_seq, seq_test );
       this_in->seq = seq_test; /* Resume from here (probably reasonably current, could query in mcache sync instead) */
       this_in->accum[ FD_FSEQ_DIAG_OVRNR_CNT ]++;
       /* Don't bother with spin as polling multiple locations */
@@ -540,6 +653,11 @@ fd_mux_tile( fd_cnc_t *              cnc,
       seq = fd_seq_inc( seq, 1UL );
     }
 
+    /* Record the latencies of this frag */
+
+    if( this_in->lat_pub  ) fd_lhist_sample( this_in->lat_pub,  (ulong)fd_long_max( now - fd_frag_meta_ts_decomp( in_tspub, now ), 0L ) );
+    if( this_in->lat_orig ) fd_lhist_sample( this_in->lat_orig, (ulong)fd_long_max( now - fd_frag_meta_ts_decomp( tsorig,   now ), 0L ) );
+
     /* Windup for the next in poll and accumulate diagnostics */
 
     this_in_seq    = fd_seq_inc( this_in_seq, 1UL );
@@ -561,6 +679,8 @@ fd_mux_tile( fd_cnc_t *              cnc,
       fd_mux_tile_in_update( this_in, 0UL ); /* exposed_cnt 0 assumes all reliable consumers caught up or shutdown */
     }
 
+    if( tlog ) FD_TLOG( tlog, tlog_fmt_halt, seq );
+
     FD_LOG_INFO(( "Halted mux" ));
     fd_cnc_signal( cnc, FD_CNC_SIGNAL_BOOT );
 
@@ -46,7 +46,7 @@
 #define FD_MUX_TILE_SCRATCH_FOOTPRINT( in_cnt, out_cnt )                \
   FD_LAYOUT_FINI( FD_LAYOUT_APPEND( FD_LAYOUT_APPEND( FD_LAYOUT_APPEND( \
   FD_LAYOUT_APPEND( FD_LAYOUT_APPEND( FD_LAYOUT_INIT,                   \
-    64UL,             (in_cnt)*64UL                           ),        \
+    64UL,             (in_cnt)*128UL                          ),        \
     alignof(ulong *), (out_cnt)*sizeof(ulong *)               ),        \
     alignof(ulong *), (out_cnt)*sizeof(ulong *)               ),        \
     alignof(ulong),   (out_cnt)*sizeof(ulong)                 ),        \
@@ -139,6 +139,14 @@ FD_PROTOTYPES_BEGIN
    (more pedantically, this more about how applications handle fragment
    streams and less about how the mux tile functions).
 
+   in_lat_pub and in_lat_orig optionally specify per in latency
+   histograms.  For every frag successfully read from in in_idx, the
+   mux records now-tspub into in_lat_pub[in_idx] and now-tsorig into
+   in_lat_orig[in_idx] (in ticks, negative latencies from clock skew
+   are recorded as 0).  Either array can be NULL and individual entries
+   can be NULL to not record the corresponding latencies.  The mux is
+   the single writer of these lhists while it is running.
+
    cr_max is the maximum number of flow control credits the mux tile is
    allowed for publishing frags to outs.  It represents the maximum
    number of frags a reliable out can lag behind the multiplexed stream
@@ -153,6 +161,22 @@ FD_PROTOTYPES_BEGIN
    to lag the mux by up to mcache.depth frags and in[*].cr_max is the
    same as in_mcache[*].depth.
 
+   out_grp_cnt and out_grp_fseq optionally enable hierarchical flow
+   control for large out_cnt (see fd_fctl.h).  If out_grp_cnt is zero,
+   the mux receives credits from each reliable consumer's fseq (and
+   out_grp_fseq is ignored).  Otherwise, the reliable consumers are
+   partitioned into out_grp_cnt groups (in [1,out_cnt], out_idx is in
+   group fd_fctl_rx_grp_idx( out_idx, out_cnt, out_grp_cnt )) and the
+   mux receives credits only from out_grp_fseq[ grp_idx ], the fseq
+   aggregating the positions of the consumers in group grp_idx.  The
+   mux's flow control cost then only depends on out_grp_cnt.  The mux
+   initializes the aggregates from out_fseq at boot.  While running, it
+   is up to the consumers to keep the aggregates current (typically, the
+   first consumer of each group calls fd_fctl_rx_agg_update on its
+   group's aggregate right after returning its own credits).  The mux
+   accumulates slow consumer diagnostics into the application regions
+   of the group fseqs.
+
    lazy is the ballpark interval in ns for how often to receive credits
    from an out (and, equivalently, how often to return credits to an
    in).  Too small a lazy will drown the system in cache coherence
@@ -163,6 +187,25 @@ FD_PROTOTYPES_BEGIN
    fast a consumer can process frags typically.  <=0 indicates to pick a
    conservative default.
 
+   idle is the idle policy to use when all ins are caught up (see
+   fd_idle.h).  The mux backs off (spin, then wait on the mcache line of
+   the next expected frag of the last in polled, then optionally sleep)
+   only after a full sweep of the ins found nothing new and an immediate
+   recheck of every in confirms they are all still caught up.  As only
+   one in's line is watched while idle, a frag arriving on another in
+   can be delayed by up to one idle primitive (the wait tier's bounded
+   UMWAIT or the sleep tier's sleep_ns).  NULL indicates
+   to poll the ins continuously as fast as possible (lowest latency,
+   highest power).  While the tile is running, no other tile should use
+   idle for anything.
+
+   tlog is an optional tlog (see fd_tlog.h) the mux traces rare events
+   to: run (seq and initial credits), halt, transitions into
+   backpressure and in overruns (expected and found in seqs).  The mux
+   registers its formats at boot (so a tlog can be reused across
+   restarts).  NULL indicates no tracing.  While the tile is running, no
+   other tile should write to tlog.
+
    scratch points to tile scratch memory.  fd_mux_tile_scratch_align and
    fd_mux_tile_scratch_footprint return the required alignment and
    footprint needed for this region.  This memory region is exclusively
@@ -182,7 +225,7 @@ FD_PROTOTYPES_BEGIN
    also use their cnc and fseq application regions similarly for
    monitoring simplicity / consistency.
    
-   The lifetime of the cnc, mcaches, fseqs, rng and scratch used by this
+   The lifetime of the cnc, mcaches, fseqs, idle, tlog, rng and scratch used by this
    tile should be a superset of this tile's lifetime.  While this tile
    is running, no other tile should use cnc for its command and control,
    publish into mcache, use the rng for anything (and the rng should be
@@ -191,12 +234,13 @@ FD_PROTOTYPES_BEGIN
    in_mcache metadata.  This tile uses the in_fseqs passed to it in the
    usual consumer ways (e.g. publishing recent locations in the
    producers sequence space and updating consumer oriented diagnostics)
-   and the out_fseqs passed to it in the usual producer ways (i.e.
-   discovering the location of reliable consumers in sequence space and
-   updating producer oriented diagnostics).  The in_mcache, in_fseq and
-   out_fseq arrays will not be used the after the tile has successfully
-   booted (transitioned the cnc from BOOT to RUN) or returned (e.g.
-   failed to boot), whichever comes first. */
+   and the out_fseqs (or out_grp_fseqs) passed to it in the usual
+   producer ways (i.e. discovering the location of reliable consumers in
+   sequence space and updating producer oriented diagnostics).  The
+   in_mcache, in_fseq, out_fseq and out_grp_fseq arrays will not be used
+   the after the tile has successfully booted (transitioned the cnc from
+   BOOT to RUN) or returned (e.g. failed to boot), whichever comes
+   first. */
 
 FD_FN_CONST ulong
 fd_mux_tile_scratch_align( void );
@@ -206,17 +250,23 @@ fd_mux_tile_scratch_footprint( ulong in_cnt,
                                ulong out_cnt );
 
 int
-fd_mux_tile( fd_cnc_t *              cnc,       /* Local join to the mux's command-and-control */
-             ulong                   in_cnt,    /* Number of input mcaches to multiplex, inputs are indexed [0,in_cnt) */
-             fd_frag_meta_t const ** in_mcache, /* in_mcache[in_idx] is the local join to input in_idx's mcache */
-             ulong **                in_fseq,   /* in_fseq  [in_idx] is the local join to input in_idx's fseq */
-             fd_frag_meta_t *        mcache,    /* Local join to the mux's frag stream output mcache */
-             ulong                   out_cnt,   /* Number of reliable consumers, reliable consumers are indexed [0,out_cnt) */
-             ulong **                out_fseq,  /* out_fseq[out_idx] is the local join to reliable consumer out_idx's fseq */
-             ulong                   cr_max,    /* Maximum number of flow control credits, 0 means use a reasonable default */
-             long                    lazy,      /* Lazyiness, <=0 means use a reasonable default */
-             fd_rng_t *              rng,       /* Local join to the rng this mux should use */
-             void *                  scratch ); /* Tile scratch memory */
+fd_mux_tile( fd_cnc_t *              cnc,          /* Local join to the mux's command-and-control */
+             ulong                   in_cnt,       /* Number of input mcaches to multiplex, inputs are indexed [0,in_cnt) */
+             fd_frag_meta_t const ** in_mcache,    /* in_mcache[in_idx] is the local join to input in_idx's mcache */
+             ulong **                in_fseq,      /* in_fseq  [in_idx] is the local join to input in_idx's fseq */
+             fd_lhist_t **           in_lat_pub,   /* in_lat_pub [in_idx] is the local join to input in_idx's tspub  latency lhist, NULL if n/a */
+             fd_lhist_t **           in_lat_orig,  /* in_lat_orig[in_idx] is the local join to input in_idx's tsorig latency lhist, NULL if n/a */
+             fd_frag_meta_t *        mcache,       /* Local join to the mux's frag stream output mcache */
+             ulong                   out_cnt,      /* Number of reliable consumers, reliable consumers are indexed [0,out_cnt) */
+             ulong **                out_fseq,     /* out_fseq[out_idx] is the local join to reliable consumer out_idx's fseq */
+             ulong                   out_grp_cnt,  /* Number of reliable consumer groups, 0 means receive credits from each out */
+             ulong **                out_grp_fseq, /* out_grp_fseq[grp_idx] is the local join to group grp_idx's aggregate fseq */
+             ulong                   cr_max,       /* Maximum number of flow control credits, 0 means use a reasonable default */
+             long                    lazy,         /* Lazyiness, <=0 means use a reasonable default */
+             fd_idle_t *             idle,         /* Local join to the idle policy this mux should use, NULL means never idle */
+             fd_tlog_t *             tlog,         /* Local join to the tlog this mux should trace events to, NULL means no tracing */
+             fd_rng_t *              rng,          /* Local join to the rng this mux should use */
+             void *                  scratch );    /* Tile scratch memory */
 
 FD_PROTOTYPES_END
 
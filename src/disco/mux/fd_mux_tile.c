@@ -14,11 +14,19 @@ main( int     argc,
   char const * _cnc        = fd_env_strip_cmdline_cstr ( &argc, &argv, "--cnc",        NULL, NULL );
   char const * _in_mcaches = fd_env_strip_cmdline_cstr ( &argc, &argv, "--in-mcaches", NULL, ""   );
   char const * _in_fseqs   = fd_env_strip_cmdline_cstr ( &argc, &argv, "--in-fseqs",   NULL, ""   );
+  char const * _in_lat_pubs  = fd_env_strip_cmdline_cstr( &argc, &argv, "--in-lat-pubs",  NULL, "" ); /* "" <> don't record */
+  char const * _in_lat_origs = fd_env_strip_cmdline_cstr( &argc, &argv, "--in-lat-origs", NULL, "" ); /* "" <> don't record */
   char const * _mcache     = fd_env_strip_cmdline_cstr ( &argc, &argv, "--mcache",     NULL, NULL );
   char const * _out_fseqs  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--out-fseqs",  NULL, ""   );
+  char const * _out_grp_fseqs = fd_env_strip_cmdline_cstr( &argc, &argv, "--out-grp-fseqs", NULL, "" ); /* "" <> ungrouped */
   ulong        cr_max      = fd_env_strip_cmdline_ulong( &argc, &argv, "--cr-max",     NULL, 0UL  ); /*   0 <> use default */
   long         lazy        = fd_env_strip_cmdline_long ( &argc, &argv, "--lazy",       NULL, 0L   ); /* <=0 <> use default */
   uint         seed        = fd_env_strip_cmdline_uint ( &argc, &argv, "--seed",       NULL, (uint)(ulong)fd_tickcount() );
+  int          idle_en     = fd_env_strip_cmdline_int  ( &argc, &argv, "--idle",       NULL, 0    ); /*   0 <> never idle */
+  long         idle_spin   = fd_env_strip_cmdline_long ( &argc, &argv, "--idle-spin",  NULL, -1L  ); /*  <0 <> use default */
+  long         idle_wait   = fd_env_strip_cmdline_long ( &argc, &argv, "--idle-wait",  NULL, -1L  ); /*  <0 <> use default */
+  long         idle_sleep  = fd_env_strip_cmdline_long ( &argc, &argv, "--idle-sleep", NULL, -1L  ); /*  <0 <> use default */
+  char const * _tlog       = fd_env_strip_cmdline_cstr ( &argc, &argv, "--tlog",       NULL, NULL ); /* NULL <> no tracing */
 
   if( FD_UNLIKELY( !_cnc ) ) FD_LOG_ERR(( "--cnc not specified" ));
   FD_LOG_NOTICE(( "Joining --cnc %s", _cnc ));
@@ -47,6 +55,26 @@ main( int     argc,
     if( FD_UNLIKELY( !in_fseq[ in_idx ] ) ) FD_LOG_ERR(( "fd_fseq_join failed" ));
   }
 
+  char * _in_lat_pub [ 256 ];
+  char * _in_lat_orig[ 256 ];
+  ulong in_lat_pub_cnt  = fd_cstr_tokenize( _in_lat_pub,  256UL, (char *)_in_lat_pubs,  ',' ); /* argv is non-const */
+  ulong in_lat_orig_cnt = fd_cstr_tokenize( _in_lat_orig, 256UL, (char *)_in_lat_origs, ',' ); /* argv is non-const */
+  if( FD_UNLIKELY( (!!in_lat_pub_cnt ) & (in_lat_pub_cnt !=in_cnt) ) ) FD_LOG_ERR(( "--in-mcaches and --in-lat-pubs mismatch"  ));
+  if( FD_UNLIKELY( (!!in_lat_orig_cnt) & (in_lat_orig_cnt!=in_cnt) ) ) FD_LOG_ERR(( "--in-mcaches and --in-lat-origs mismatch" ));
+
+  fd_lhist_t * in_lat_pub [ 256 ];
+  fd_lhist_t * in_lat_orig[ 256 ];
+  for( ulong in_idx=0UL; in_idx<in_lat_pub_cnt; in_idx++ ) {
+    FD_LOG_NOTICE(( "Joining --in-lat-pubs[%lu] %s", in_idx, _in_lat_pub[ in_idx ] ));
+    in_lat_pub[ in_idx ] = fd_lhist_join( fd_wksp_map( _in_lat_pub[ in_idx ] ) );
+    if( FD_UNLIKELY( !in_lat_pub[ in_idx ] ) ) FD_LOG_ERR(( "fd_lhist_join failed" ));
+  }
+  for( ulong in_idx=0UL; in_idx<in_lat_orig_cnt; in_idx++ ) {
+    FD_LOG_NOTICE(( "Joining --in-lat-origs[%lu] %s", in_idx, _in_lat_orig[ in_idx ] ));
+    in_lat_orig[ in_idx ] = fd_lhist_join( fd_wksp_map( _in_lat_orig[ in_idx ] ) );
+    if( FD_UNLIKELY( !in_lat_orig[ in_idx ] ) ) FD_LOG_ERR(( "fd_lhist_join failed" ));
+  }
+
   if( FD_UNLIKELY( !_mcache ) ) FD_LOG_ERR(( "--mcache not specified" ));
   FD_LOG_NOTICE(( "Joining --mcache %s", _mcache ));
   fd_frag_meta_t * mcache = fd_mcache_join( fd_wksp_map( _mcache ) );
@@ -63,12 +91,38 @@ main( int     argc,
     if( FD_UNLIKELY( !out_fseq[ out_idx ] ) ) FD_LOG_ERR(( "fd_fseq_join failed" ));
   }
 
+  char * _out_grp_fseq[ 256 ];
+  ulong out_grp_cnt = fd_cstr_tokenize( _out_grp_fseq, 256UL, (char *)_out_grp_fseqs, ',' ); /* argv is non-const */
+  if( FD_UNLIKELY( out_grp_cnt>out_cnt ) ) FD_LOG_ERR(( "more --out-grp-fseqs than --out-fseqs specified" ));
+
+  ulong * out_grp_fseq[ 256 ];
+  for( ulong grp_idx=0UL; grp_idx<out_grp_cnt; grp_idx++ ) {
+    FD_LOG_NOTICE(( "Joining --out-grp-fseqs[%lu] %s", grp_idx, _out_grp_fseq[ grp_idx ] ));
+    out_grp_fseq[ grp_idx ] = fd_fseq_join( fd_wksp_map( _out_grp_fseq[ grp_idx ] ) );
+    if( FD_UNLIKELY( !out_grp_fseq[ grp_idx ] ) ) FD_LOG_ERR(( "fd_fseq_join failed" ));
+  }
+
   FD_LOG_NOTICE(( "Using --cr-max %lu, --lazy %li", cr_max, lazy ));
 
   FD_LOG_NOTICE(( "Creating rng --seed %u", seed ));
   fd_rng_t _rng[1];
   fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, seed, 0UL ) );
 
+  fd_idle_t * idle = NULL;
+  if( idle_en ) {
+    FD_LOG_NOTICE(( "Creating idle --idle-spin %li --idle-wait %li --idle-sleep %li", idle_spin, idle_wait, idle_sleep ));
+    static fd_idle_t _idle[1];
+    idle = fd_idle_join( fd_idle_new( _idle, idle_spin, idle_wait, idle_sleep ) );
+    if( FD_UNLIKELY( !idle ) ) FD_LOG_ERR(( "fd_idle_join failed" ));
+  }
+
+  fd_tlog_t * tlog = NULL;
+  if( _tlog ) {
+    FD_LOG_NOTICE(( "Joining --tlog %s", _tlog ));
+    tlog = fd_tlog_join( fd_wksp_map( _tlog ) );
+    if( FD_UNLIKELY( !tlog ) ) FD_LOG_ERR(( "fd_tlog_join failed" ));
+  }
+
   FD_LOG_NOTICE(( "Creating scratch" ));
   ulong footprint = fd_mux_tile_scratch_footprint( in_cnt, out_cnt );
   if( FD_UNLIKELY( !footprint ) ) FD_LOG_ERR(( "fd_mux_tile_scratch_footprint failed" ));
@@ -81,15 +135,22 @@ main( int     argc,
 
   FD_LOG_NOTICE(( "Run" ));
 
-  int err = fd_mux_tile( cnc, in_cnt, in_mcache, in_fseq, mcache, out_cnt, out_fseq, cr_max, lazy, rng, scratch );
+  int err = fd_mux_tile( cnc, in_cnt, in_mcache, in_fseq,
+                         in_lat_pub_cnt ? in_lat_pub : NULL, in_lat_orig_cnt ? in_lat_orig : NULL,
+                         mcache, out_cnt, out_fseq, out_grp_cnt, out_grp_fseq, cr_max, lazy, idle, tlog, rng, scratch );
   if( FD_UNLIKELY( err ) ) FD_LOG_ERR(( "fd_mux_tile failed (%i)", err ));
 
   FD_LOG_NOTICE(( "Fini" ));
 
   fd_shmem_release( scratch, page_sz, page_cnt );
+  if( tlog ) fd_wksp_unmap( fd_tlog_leave( tlog ) );
+  if( idle ) fd_idle_delete( fd_idle_leave( idle ) );
   fd_rng_delete( fd_rng_leave( rng ) );
+  for( ulong grp_idx=out_grp_cnt; grp_idx; grp_idx-- ) fd_wksp_unmap( fd_fseq_leave( out_grp_fseq[ grp_idx-1UL ] ) );
   for( ulong out_idx=out_cnt; out_idx; out_idx-- ) fd_wksp_unmap( fd_fseq_leave( out_fseq[ out_idx-1UL ] ) );
   fd_wksp_unmap( fd_mcache_leave( mcache ) );
+  for( ulong in_idx=in_lat_orig_cnt; in_idx; in_idx-- ) fd_wksp_unmap( fd_lhist_leave( in_lat_orig[ in_idx-1UL ] ) );
+  for( ulong in_idx=in_lat_pub_cnt;  in_idx; in_idx-- ) fd_wksp_unmap( fd_lhist_leave( in_lat_pub [ in_idx-1UL ] ) );
   for( ulong in_idx=in_cnt; in_idx; in_idx-- ) fd_wksp_unmap( fd_fseq_leave  ( in_fseq  [ in_idx-1UL ] ) );
   for( ulong in_idx=in_cnt; in_idx; in_idx-- ) fd_wksp_unmap( fd_mcache_leave( in_mcache[ in_idx-1UL ] ) );
   fd_wksp_unmap( fd_cnc_leave( cnc ) );
@@ -26,8 +26,10 @@ struct test_cfg {
   uchar *     mux_cnc_mem;
   uchar *     mux_mcache_mem;
   uchar *     mux_scratch_mem;
+  uchar *     mux_tlog_mem;
   ulong       mux_cr_max;
   long        mux_lazy;
+  int         mux_idle;
   uint        mux_seed;
 
   ulong       rx_cnt;
@@ -35,6 +37,8 @@ struct test_cfg {
   uchar *     rx_cnc_mem;      ulong rx_cnc_footprint;
   uchar *     rx_rng_mem;      ulong rx_rng_footprint;
   uchar *     rx_fseq_mem;     ulong rx_fseq_footprint;
+  ulong       rx_grp_cnt;
+  uchar *     rx_grp_fseq_mem;
 
   ulong       pkt_framing;
   ulong       pkt_payload_max;
@@ -266,20 +270,51 @@ mux_tile_main( int     argc,
   for( ulong tx_idx=0UL; tx_idx<cfg->tx_cnt; tx_idx++ )
     tx_fseq[ tx_idx ] = fd_fseq_join( cfg->tx_fseq_mem + tx_idx*cfg->tx_fseq_footprint );
 
+  static fd_lhist_t _tx_lat[ 2 ][ 128 ]; /* Tile local, only used for diagnostics */
+  fd_lhist_t * tx_lat_pub [ 128 ];
+  fd_lhist_t * tx_lat_orig[ 128 ];
+  for( ulong tx_idx=0UL; tx_idx<cfg->tx_cnt; tx_idx++ ) {
+    tx_lat_pub [ tx_idx ] = fd_lhist_join( fd_lhist_new( &_tx_lat[0][ tx_idx ] ) );
+    tx_lat_orig[ tx_idx ] = fd_lhist_join( fd_lhist_new( &_tx_lat[1][ tx_idx ] ) );
+  }
+
   fd_frag_meta_t * mux_mcache = fd_mcache_join( cfg->mux_mcache_mem );
 
   ulong * rx_fseq[ 128 ];
   for( ulong rx_idx=0UL; rx_idx<cfg->rx_cnt; rx_idx++ )
     rx_fseq[ rx_idx ] = fd_fseq_join( cfg->rx_fseq_mem + rx_idx*cfg->rx_fseq_footprint );
 
+  ulong * rx_grp_fseq[ 128 ];
+  for( ulong grp_idx=0UL; grp_idx<cfg->rx_grp_cnt; grp_idx++ )
+    rx_grp_fseq[ grp_idx ] = fd_fseq_join( cfg->rx_grp_fseq_mem + grp_idx*cfg->rx_fseq_footprint );
+
   fd_rng_t _rng[1];
   fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, cfg->mux_seed, 0UL ) );
 
-  int err = fd_mux_tile( cnc, cfg->tx_cnt, tx_mcache, tx_fseq, mux_mcache, cfg->rx_cnt, rx_fseq,
-                         cfg->mux_cr_max, cfg->mux_lazy, rng, cfg->mux_scratch_mem );
+  fd_idle_t _idle[1];
+  fd_idle_t * idle = cfg->mux_idle ? fd_idle_join( fd_idle_new( _idle, -1L, -1L, -1L ) ) : NULL;
+
+  fd_tlog_t * tlog = fd_tlog_join( cfg->mux_tlog_mem );
+
+  int err = fd_mux_tile( cnc, cfg->tx_cnt, tx_mcache, tx_fseq, tx_lat_pub, tx_lat_orig, mux_mcache, cfg->rx_cnt, rx_fseq,
+                         cfg->rx_grp_cnt, rx_grp_fseq, cfg->mux_cr_max, cfg->mux_lazy, idle, tlog, rng, cfg->mux_scratch_mem );
   if( FD_UNLIKELY( err ) ) FD_LOG_ERR(( "fd_mux_tile failed (%i)", err ));
 
+  fd_tlog_leave( tlog );
+  if( idle ) fd_idle_delete( fd_idle_leave( idle ) );
+  for( ulong tx_idx=cfg->tx_cnt; tx_idx; tx_idx-- ) {
+    static ulong snap[ FD_LHIST_BIN_CNT ];
+    fd_lhist_snap( tx_lat_pub[ tx_idx-1UL ], snap );
+    FD_LOG_NOTICE(( "tx %lu: tspub  latency p50 %lu p99 %lu p999 %lu ticks", tx_idx-1UL,
+                    fd_lhist_quantile( snap, 0.5 ), fd_lhist_quantile( snap, 0.99 ), fd_lhist_quantile( snap, 0.999 ) ));
+    fd_lhist_snap( tx_lat_orig[ tx_idx-1UL ], snap );
+    FD_LOG_NOTICE(( "tx %lu: tsorig latency p50 %lu p99 %lu p999 %lu ticks", tx_idx-1UL,
+                    fd_lhist_quantile( snap, 0.5 ), fd_lhist_quantile( snap, 0.99 ), fd_lhist_quantile( snap, 0.999 ) ));
+    fd_lhist_delete( fd_lhist_leave( tx_lat_orig[ tx_idx-1UL ] ) );
+    fd_lhist_delete( fd_lhist_leave( tx_lat_pub [ tx_idx-1UL ] ) );
+  }
   fd_rng_delete( fd_rng_leave( rng ) );
+  for( ulong grp_idx=cfg->rx_grp_cnt; grp_idx; grp_idx-- ) fd_fseq_leave( rx_grp_fseq[ grp_idx-1UL ] );
   for( ulong rx_idx=cfg->rx_cnt; rx_idx; rx_idx-- ) fd_fseq_leave  ( rx_fseq  [ rx_idx-1UL ] );
   fd_mcache_leave( mux_mcache );
   for( ulong tx_idx=cfg->tx_cnt; tx_idx; tx_idx-- ) fd_fseq_leave  ( tx_fseq  [ tx_idx-1UL ] );
@@ -310,9 +345,25 @@ rx_tile_main( int     argc,
   ulong const *          sync   = fd_mcache_seq_laddr_const( mcache );
   ulong                  seq    = fd_mcache_seq_query( sync );
 
-  /* Hook up to mux flow control */
+  /* Hook up to mux flow control.  If the rxs are grouped, the first rx
+     of each group also keeps the group's aggregate current. */
   ulong * fseq = fd_fseq_join( cfg->rx_fseq_mem + rx_idx*cfg->rx_fseq_footprint );
 
+  ulong *       grp_fseq = NULL;
+  ulong const * grp_rx_fseq[ 128 ];
+  ulong         grp_rx_cnt = 0UL;
+  if( cfg->rx_grp_cnt ) {
+    ulong grp_idx = fd_fctl_rx_grp_idx( rx_idx, cfg->rx_cnt, cfg->rx_grp_cnt );
+    ulong rx0     = fd_fctl_rx_grp_rx0( grp_idx,     cfg->rx_cnt, cfg->rx_grp_cnt );
+    ulong rx1     = fd_fctl_rx_grp_rx0( grp_idx+1UL, cfg->rx_cnt, cfg->rx_grp_cnt );
+    if( rx_idx==rx0 ) {
+      grp_fseq   = fd_fseq_join( cfg->rx_grp_fseq_mem + grp_idx*cfg->rx_fseq_footprint );
+      grp_rx_cnt = rx1 - rx0;
+      for( ulong grp_rx_idx=0UL; grp_rx_idx<grp_rx_cnt; grp_rx_idx++ )
+        grp_rx_fseq[ grp_rx_idx ] = fd_fseq_join( cfg->rx_fseq_mem + (rx0+grp_rx_idx)*cfg->rx_fseq_footprint );
+    }
+  }
+
   /* Hook up to the random number generator */
   fd_rng_t * rng = fd_rng_join( cfg->rx_rng_mem + rx_idx*cfg->rx_rng_footprint );
 
@@ -343,6 +394,7 @@ rx_tile_main( int     argc,
 
       /* Send flow control credits */
       fd_fctl_rx_cr_return( fseq, seq );
+      if( grp_fseq ) fd_fctl_rx_agg_update( grp_fseq, grp_rx_fseq, grp_rx_cnt );
 
       /* Send diagnostic info */
       long now = fd_log_wallclock();
@@ -439,7 +491,10 @@ main( int     argc,
   ulong        mux_depth  = fd_env_strip_cmdline_ulong( &argc, &argv, "--mux-depth",  NULL, 32768UL                      );
   ulong        mux_cr_max = fd_env_strip_cmdline_ulong( &argc, &argv, "--mux-cr-max", NULL, 0UL /* use default */        );
   long         mux_lazy   = fd_env_strip_cmdline_long ( &argc, &argv, "--mux-lazy",   NULL, 0L /* use default */         );
+  int          mux_idle   = fd_env_strip_cmdline_int  ( &argc, &argv, "--mux-idle",   NULL, 0  /* never idle */          );
+  ulong    mux_tlog_depth = fd_env_strip_cmdline_ulong( &argc, &argv, "--mux-tlog-depth", NULL, 1024UL                   );
   ulong        rx_cnt     = fd_env_strip_cmdline_ulong( &argc, &argv, "--rx-cnt",     NULL, 2UL                          );
+  ulong        rx_grp_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--rx-grp-cnt", NULL, 0UL /* ungrouped */          );
   int          rx_lazy    = fd_env_strip_cmdline_int  ( &argc, &argv, "--rx-lazy",    NULL, 7                            );
   long         duration   = fd_env_strip_cmdline_long ( &argc, &argv, "--duration",   NULL, (long)10e9                   );
 
@@ -454,6 +509,7 @@ main( int     argc,
   if( FD_UNLIKELY( !rx_cnt                    ) ) FD_LOG_ERR(( "rx_cnt should be positive" ));
   if( FD_UNLIKELY( tx_cnt>FD_MUX_TILE_IN_MAX  ) ) FD_LOG_ERR(( "--tx-cnt too large for this unit test" ));
   if( FD_UNLIKELY( rx_cnt>FD_MUX_TILE_OUT_MAX ) ) FD_LOG_ERR(( "--rx-cnt too large for this unit test" ));
+  if( FD_UNLIKELY( rx_grp_cnt>rx_cnt          ) ) FD_LOG_ERR(( "--rx-grp-cnt should be at most --rx-cnt" ));
 
   ulong tile_cnt = 1UL+tx_cnt+1UL+rx_cnt; /* 1 main(cnc,this) + tx_cnt tx_mains + 1 mux_main + rx_cnt rx_mains */
   if( FD_UNLIKELY( fd_tile_cnt()<tile_cnt ) ) FD_LOG_ERR(( "this unit test requires at least %lu tiles", tile_cnt ));
@@ -489,7 +545,7 @@ main( int     argc,
 
   FD_LOG_NOTICE(( "Creating fseqs" ));
   ulong   fseq_footprint = fd_fseq_footprint();
-  uchar * fseq_mem       = (uchar *)fd_wksp_alloc_laddr( wksp, fd_fseq_align(), fseq_footprint*(tx_cnt+rx_cnt), 1UL );
+  uchar * fseq_mem       = (uchar *)fd_wksp_alloc_laddr( wksp, fd_fseq_align(), fseq_footprint*(tx_cnt+rx_cnt+rx_grp_cnt), 1UL );
   FD_TEST( fseq_mem );
 
   FD_LOG_NOTICE(( "Creating rngs" ));
@@ -525,6 +581,10 @@ main( int     argc,
   uchar * mux_scratch_mem       = (uchar *)fd_wksp_alloc_laddr( wksp, fd_mux_tile_scratch_align(), mux_scratch_footprint, 1UL );
   FD_TEST( mux_scratch_mem );
 
+  FD_LOG_NOTICE(( "Creating mux tlog (--mux-tlog-depth %lu)", mux_tlog_depth ));
+  uchar * mux_tlog_mem = (uchar *)fd_wksp_alloc_laddr( wksp, fd_tlog_align(), fd_tlog_footprint( mux_tlog_depth ), 1UL );
+  FD_TEST( mux_tlog_mem );
+
   long now = fd_tickcount();
 
   test_cfg_t cfg[1];
@@ -543,8 +603,10 @@ main( int     argc,
   cfg->mux_cnc_mem     = cnc_mem + tx_cnt*cnc_footprint;
   cfg->mux_mcache_mem  = mux_mcache_mem;
   cfg->mux_scratch_mem = mux_scratch_mem;
+  cfg->mux_tlog_mem    = mux_tlog_mem;
   cfg->mux_cr_max      = mux_cr_max;
   cfg->mux_lazy        = mux_lazy;
+  cfg->mux_idle        = mux_idle;
   cfg->mux_seed        = rng_seq++;
 
   cfg->rx_cnt      = rx_cnt;
@@ -552,6 +614,8 @@ main( int     argc,
   cfg->rx_cnc_mem  = cnc_mem  + (tx_cnt+1UL)*cnc_footprint;  cfg->rx_cnc_footprint  = cnc_footprint;
   cfg->rx_rng_mem  = rng_mem  +  tx_cnt     *rng_footprint;  cfg->rx_rng_footprint  = rng_footprint;
   cfg->rx_fseq_mem = fseq_mem +  tx_cnt     *fseq_footprint; cfg->rx_fseq_footprint = fseq_footprint;
+  cfg->rx_grp_cnt      = rx_grp_cnt;
+  cfg->rx_grp_fseq_mem = fseq_mem + (tx_cnt+rx_cnt)*fseq_footprint;
   
   cfg->pkt_framing     = pkt_framing;
   cfg->pkt_payload_max = pkt_payload_max;
@@ -571,12 +635,15 @@ main( int     argc,
   ulong mux_seq0 = fd_rng_ulong( rng );
   FD_TEST( fd_cnc_new   ( cfg->mux_cnc_mem,    64UL, 1UL, now           ) );
   FD_TEST( fd_mcache_new( cfg->mux_mcache_mem, mux_depth, 0UL, mux_seq0 ) );
+  FD_TEST( fd_tlog_new  ( cfg->mux_tlog_mem,   mux_tlog_depth, 0UL      ) );
 
   for( ulong rx_idx=0UL; rx_idx<rx_cnt; rx_idx++ ) {
     FD_TEST( fd_cnc_new ( cfg->rx_cnc_mem  + rx_idx*cfg->rx_cnc_footprint,  64UL, 2UL, now ) );
     FD_TEST( fd_rng_new ( cfg->rx_rng_mem  + rx_idx*cfg->rx_rng_footprint,  rng_seq++, 0UL ) );
     FD_TEST( fd_fseq_new( cfg->rx_fseq_mem + rx_idx*cfg->rx_fseq_footprint, mux_seq0       ) );
   }
+  for( ulong grp_idx=0UL; grp_idx<rx_grp_cnt; grp_idx++ )
+    FD_TEST( fd_fseq_new( cfg->rx_grp_fseq_mem + grp_idx*cfg->rx_fseq_footprint, mux_seq0 ) );
 
   FD_LOG_NOTICE(( "Booting" ));
 
@@ -599,8 +666,8 @@ main( int     argc,
   for( ulong tile_idx=1UL; tile_idx<tile_cnt; tile_idx++ )
     FD_TEST( fd_cnc_wait( cnc[ tile_idx ], FD_CNC_SIGNAL_BOOT, (long)5e9, NULL )==FD_CNC_SIGNAL_RUN );
 
-  FD_LOG_NOTICE(( "Running (--duration %li ns, --tx-lazy %li ns, --mux-cr-max %lu, --mux-lazy %li ns, --rx-lazy %i)",
-                  duration, tx_lazy, mux_cr_max, mux_lazy, rx_lazy ));
+  FD_LOG_NOTICE(( "Running (--duration %li ns, --tx-lazy %li ns, --mux-cr-max %lu, --mux-lazy %li ns, --mux-idle %i, --rx-lazy %i, "
+                  "--rx-grp-cnt %lu)", duration, tx_lazy, mux_cr_max, mux_lazy, mux_idle, rx_lazy, rx_grp_cnt ));
 
   /* FIXME: DO MONITORING WHILE RUNNING */
   fd_log_sleep( duration );
@@ -624,14 +691,38 @@ main( int     argc,
 
   for( ulong tile_idx=1UL; tile_idx<tile_cnt; tile_idx++ ) FD_TEST( fd_cnc_leave( cnc[ tile_idx ] ) );
 
+  /* The mux traced at least its run and halt transitions.  Drain
+     whatever is still in the tlog; the last record is the halt. */
+
+  do {
+    fd_tlog_t * tlog = fd_tlog_join( cfg->mux_tlog_mem ); FD_TEST( tlog );
+    ulong seq_end = fd_tlog_seq( tlog );
+    FD_TEST( (seq_end-fd_tlog_seq0( tlog ))>=2UL );
+    ulong seq = fd_ulong_max( fd_tlog_seq0( tlog ), seq_end - fd_ulong_min( seq_end, mux_tlog_depth ) );
+    char  buf[ 256 ];
+    fd_tlog_rec_t rec[1];
+    for( ; seq<seq_end; seq++ ) {
+      FD_TEST( !fd_tlog_read( tlog, seq, rec ) );
+      FD_TEST( fd_tlog_fmt_cstr( tlog, rec->fmt ) );
+      FD_LOG_INFO(( "mux tlog %lu: %s", seq, fd_tlog_rec_cstr( tlog, rec, buf, sizeof(buf) ) ));
+    }
+    FD_TEST( !strncmp( fd_tlog_fmt_cstr( tlog, rec->fmt ), "mux halt", 8UL ) );
+    FD_TEST( fd_tlog_read( tlog, seq_end, rec )<0 );
+    FD_TEST( fd_tlog_leave( tlog )==cfg->mux_tlog_mem );
+  } while(0);
+
   FD_LOG_NOTICE(( "Cleaning up" ));
 
+  for( ulong grp_idx=0UL; grp_idx<rx_grp_cnt; grp_idx++ )
+    FD_TEST( fd_fseq_delete( cfg->rx_grp_fseq_mem + grp_idx*cfg->rx_fseq_footprint ) );
+
   for( ulong rx_idx=0UL; rx_idx<rx_cnt; rx_idx++ ) {
     FD_TEST( fd_fseq_delete( cfg->rx_fseq_mem + rx_idx*cfg->rx_fseq_footprint ) );
     FD_TEST( fd_rng_delete ( cfg->rx_rng_mem  + rx_idx*cfg->rx_rng_footprint  ) );
     FD_TEST( fd_cnc_delete ( cfg->rx_cnc_mem  + rx_idx*cfg->rx_cnc_footprint  ) );
   }
 
+  FD_TEST( fd_tlog_delete  ( cfg->mux_tlog_mem   ) );
   FD_TEST( fd_mcache_delete( cfg->mux_mcache_mem ) );
   FD_TEST( fd_cnc_delete   ( cfg->mux_cnc_mem    ) );
 
@@ -644,6 +735,7 @@ main( int     argc,
     FD_TEST( fd_cnc_delete   ( cfg->tx_cnc_mem    + tx_idx*cfg->tx_cnc_footprint    ) );
   }
 
+  fd_wksp_free_laddr( mux_tlog_mem    );
   fd_wksp_free_laddr( mux_scratch_mem );
   fd_wksp_free_laddr( mux_mcache_mem  );
   fd_wksp_free_laddr( tx_fctl_mem     );
@@ -0,0 +1,8 @@
+$(call add-hdrs,fd_net.h)
+$(call add-objs,fd_net,fd_disco)
+$(call make-unit-test,test_net,test_net,fd_disco fd_tango fd_util)
+$(call run-unit-test,test_net)
+ifdef FD_HAS_LIBBPF
+$(call make-bin,fd_net_tile,fd_net_tile,fd_disco fd_xdp fd_tango fd_util)
+$(call add-test-scripts,test_net_veth)
+endif
@@ -0,0 +1,866 @@
+#include "fd_net.h"
+
+ulong
+fd_net_queue_assign( ulong         queue_cnt,
+                     ulong         tile_cnt,
+                     ulong const * tile_numa,
+                     ulong         nic_numa,
+                     ulong *       queue_tile ) {
+  if( FD_UNLIKELY( (!queue_cnt) | (!tile_cnt) | (tile_cnt>FD_TILE_MAX) ) ) return 0UL;
+
+  /* Order the tiles NIC local first (stable) */
+
+  ulong order[ FD_TILE_MAX ];
+  ulong order_cnt = 0UL;
+  for( ulong tile_idx=0UL; tile_idx<tile_cnt; tile_idx++ )
+    if( (nic_numa!=ULONG_MAX) & (tile_numa[ tile_idx ]==nic_numa) ) order[ order_cnt++ ] = tile_idx;
+  for( ulong tile_idx=0UL; tile_idx<tile_cnt; tile_idx++ )
+    if( !((nic_numa!=ULONG_MAX) & (tile_numa[ tile_idx ]==nic_numa)) ) order[ order_cnt++ ] = tile_idx;
+
+  /* Deal the queues round robin */
+
+  for( ulong queue_idx=0UL; queue_idx<queue_cnt; queue_idx++ ) queue_tile[ queue_idx ] = order[ queue_idx % tile_cnt ];
+
+  return fd_ulong_min( queue_cnt, tile_cnt );
+}
+
+ulong
+fd_net_check_udp_batch( fd_aio_pkt_info_t const * batch,
+                        ulong                     batch_cnt,
+                        fd_net_udp_info_t *       opt_info,
+                        int *                     err ) {
+  ulong ok_cnt = 0UL;
+  for( ulong batch_idx=0UL; batch_idx<batch_cnt; batch_idx++ ) {
+    uchar const *       pkt  = (uchar const *)batch[ batch_idx ].buf;
+    fd_net_udp_info_t   _info[1];
+    fd_net_udp_info_t * info = opt_info ? opt_info + batch_idx : _info;
+
+    int rc = fd_net_parse_udp( pkt, (ulong)batch[ batch_idx ].buf_sz, info );
+    if( FD_LIKELY( rc==FD_NET_PARSE_SUCCESS ) ) {
+
+      /* The udp header is copied out as frames are usually only 2 byte
+         aligned at the ip4 header.  The payload is summed in place. */
+
+      fd_udp_hdr_t udp[1];
+      fd_memcpy( udp, pkt + info->payload_off - sizeof(fd_udp_hdr_t), sizeof(fd_udp_hdr_t) );
+      if( udp->check && fd_ip4_udp_check( info->saddr, info->daddr, udp, pkt + info->payload_off ) ) rc = FD_NET_PARSE_ERR_CSUM;
+    }
+
+    err[ batch_idx ] = rc;
+    ok_cnt += (ulong)(rc==FD_NET_PARSE_SUCCESS);
+  }
+  return ok_cnt;
+}
+
+#if FD_HAS_HOSTED && FD_HAS_X86 && defined(__linux__) && FD_HAS_LIBBPF
+
+#define SCRATCH_ALLOC( a, s ) (__extension__({                    \
+    ulong _scratch_alloc = fd_ulong_align_up( scratch_top, (a) ); \
+    scratch_top = _scratch_alloc + (s);                           \
+    (void *)_scratch_alloc;                                       \
+  }))
+
+FD_STATIC_ASSERT( FD_FCTL_ALIGN<=FD_NET_TILE_SCRATCH_ALIGN, packing );
+
+ulong
+fd_net_tile_scratch_align( void ) {
+  return FD_NET_TILE_SCRATCH_ALIGN;
+}
+
+ulong
+fd_net_tile_scratch_footprint( ulong out_cnt,
+                               ulong xsk_cnt ) {
+  if( FD_UNLIKELY( out_cnt>FD_NET_TILE_OUT_MAX ) ) return 0UL;
+  if( FD_UNLIKELY( (!xsk_cnt) | (xsk_cnt>FD_NET_TILE_XSK_MAX) ) ) return 0UL;
+  ulong scratch_top = 0UL;
+  SCRATCH_ALLOC( fd_fctl_align(), fd_fctl_footprint( out_cnt ) ); /* fctl */
+  SCRATCH_ALLOC( alignof(ulong),  xsk_cnt*sizeof(ulong)        ); /* q_rx_cnt */
+  return fd_ulong_align_up( scratch_top, fd_net_tile_scratch_align() );
+}
+
+/* fd_net_tile_rx_t holds the out frag stream state the rx aio callback
+   needs.  It lives on the tile's stack and is updated in place by the
+   callback such that the run loop sees the results when
+   fd_xsk_aio_service returns. */
+
+struct fd_net_tile_rx {
+
+  /* out frag stream state */
+  fd_frag_meta_t * mcache;   /* Local join to the output mcache */
+  ulong            depth;    /* ==fd_mcache_depth( mcache ) */
+  ulong            orig;     /* Origin of the output frag stream */
+  ulong            seq;      /* Next sequence number to publish */
+  void *           base;     /* ==fd_wksp_containing( dcache ) */
+  ulong            chunk0;   /* ==fd_dcache_compact_chunk0( base, dcache ) */
+  ulong            wmark;    /* ==fd_dcache_compact_wmark ( base, dcache, mtu ) */
+  ulong            chunk;    /* Chunk where the next payload will be written, in [chunk0,wmark] */
+  ulong            mtu;      /* Max payload size to publish */
+  ulong            cr_avail; /* Flow control credits available, frames past this many are left pending */
+
+  /* per XSK state */
+  ulong *          q_rx_cnt; /* q_rx_cnt[xsk_idx] accumulates frames received on XSK xsk_idx between housekeeping events */
+  ulong            q;        /* Index of the XSK currently being serviced */
+
+  /* diagnostics accumulated between housekeeping events */
+  ulong pub_cnt;
+  ulong pub_sz;
+  ulong filt_cnt;
+  ulong filt_sz;
+};
+
+typedef struct fd_net_tile_rx fd_net_tile_rx_t;
+
+/* fd_net_tile_rx_send is the rx aio callback invoked by
+   fd_xsk_aio_service with a batch of frames just taken off the XSK RX
+   ring.  Accepted frames are returned to the fill ring as soon as this
+   returns, so payloads are copied into the dcache here.  If the tile
+   runs out of flow control credits part way through the batch, this
+   returns FD_AIO_ERR_AGAIN with *opt_batch_idx set to the first frame
+   not accepted such that the xsk_aio can keep the rest pending (rather
+   than the tile silently dropping them). */
+
+static int
+fd_net_tile_rx_send( void *                    ctx,
+                     fd_aio_pkt_info_t const * batch,
+                     ulong                     batch_cnt,
+                     ulong *                   opt_batch_idx ) {
+  fd_net_tile_rx_t * rx = (fd_net_tile_rx_t *)ctx;
+
+  fd_frag_meta_t * mcache = rx->mcache;
+  ulong            depth  = rx->depth;
+  void *           base   = rx->base;
+  ulong            chunk0 = rx->chunk0;
+  ulong            wmark  = rx->wmark;
+  ulong            mtu    = rx->mtu;
+  ulong            seq    = rx->seq;
+  ulong            chunk  = rx->chunk;
+  ulong            ctl    = fd_frag_meta_ctl( rx->orig, 1 /*som*/, 1 /*eom*/, 0 /*err*/ );
+
+  /* All frames in the batch were received no later than now */
+  ulong tsorig = fd_frag_meta_ts_comp( fd_tickcount() );
+
+  ulong pub_cnt   = 0UL;
+  ulong batch_idx = 0UL;
+  for( ; batch_idx<batch_cnt; batch_idx++ ) {
+    if( FD_UNLIKELY( pub_cnt>=rx->cr_avail ) ) break; /* Backpressured, leave the rest of the batch to the xsk_aio */
+
+    uchar const * pkt    = (uchar const *)batch[ batch_idx ].buf;
+    ulong         pkt_sz = (ulong)batch[ batch_idx ].buf_sz;
+
+    fd_net_udp_info_t info[1];
+    if( FD_UNLIKELY( fd_net_parse_udp( pkt, pkt_sz, info )!=FD_NET_PARSE_SUCCESS ) ) {
+      rx->filt_cnt++;
+      rx->filt_sz += pkt_sz;
+      continue;
+    }
+
+    ulong sz = info->payload_sz;
+    if( FD_UNLIKELY( sz>mtu ) ) {
+      rx->filt_cnt++;
+      rx->filt_sz += pkt_sz;
+      continue;
+    }
+
+    fd_memcpy( fd_chunk_to_laddr( base, chunk ), pkt + info->payload_off, sz );
+
+    ulong tspub = fd_frag_meta_ts_comp( fd_tickcount() );
+    fd_mcache_publish( mcache, depth, seq, fd_net_udp_sig( info ), chunk, sz, ctl, tsorig, tspub );
+
+    chunk = fd_dcache_compact_next( chunk, sz, chunk0, wmark );
+    seq   = fd_seq_inc( seq, 1UL );
+    pub_cnt++;
+    rx->pub_sz += sz;
+  }
+
+  rx->seq       = seq;
+  rx->chunk     = chunk;
+  rx->cr_avail -= pub_cnt;
+  rx->pub_cnt  += pub_cnt;
+  rx->q_rx_cnt[ rx->q ] += batch_idx;
+
+  if( FD_UNLIKELY( batch_idx<batch_cnt ) ) {
+    if( opt_batch_idx ) *opt_batch_idx = batch_idx;
+    return FD_AIO_ERR_AGAIN;
+  }
+  return FD_AIO_SUCCESS;
+}
+
+/* fd_net_tile_rx_drop is installed as the rx aio on halt such that
+   servicing the xsk_aio after the tile returns is harmless. */
+
+static int
+fd_net_tile_rx_drop( void *                    ctx,
+                     fd_aio_pkt_info_t const * batch,
+                     ulong                     batch_cnt,
+                     ulong *                   opt_batch_idx ) {
+  (void)ctx; (void)batch; (void)batch_cnt; (void)opt_batch_idx;
+  return FD_AIO_SUCCESS;
+}
+
+/* fd_net_tile_q_stats updates the kernel side diagnostics of XSK
+   xsk_idx in cnc_diag. */
+
+static void
+fd_net_tile_q_stats( ulong *    cnc_diag,
+                     ulong      xsk_idx,
+                     fd_xsk_t * xsk ) {
+  fd_xsk_stats_t stats[1];
+  if( FD_UNLIKELY( fd_xsk_stats( xsk, stats ) ) ) return; /* logs details */
+  cnc_diag[ FD_NET_CNC_DIAG_Q( xsk_idx, FD_NET_CNC_DIAG_Q_DROP_CNT   ) ] = stats->rx_dropped + stats->rx_invalid_descs + stats->rx_ring_full;
+  cnc_diag[ FD_NET_CNC_DIAG_Q( xsk_idx, FD_NET_CNC_DIAG_Q_FILL_EMPTY ) ] = stats->rx_fill_ring_empty_descs;
+}
+
+int
+fd_net_tile( fd_cnc_t *       cnc,
+             ulong            xsk_cnt,
+             fd_xsk_aio_t **  xsk_aio,
+             ulong            rx_burst,
+             ulong            mtu,
+             ulong            orig,
+             fd_frag_meta_t * mcache,
+             uchar *          dcache,
+             ulong            out_cnt,
+             ulong **         out_fseq,
+             ulong            cr_max,
+             long             lazy,
+             fd_rng_t *       rng,
+             void *           scratch ) {
+
+  /* cnc state */
+  ulong * cnc_diag;           /* ==fd_cnc_app_laddr( cnc ), local address of the net tile cnc diagnostic region */
+  ulong   cnc_diag_in_backp;  /* is the run loop currently backpressured by one or more of the outs, in [0,1] */
+  ulong   cnc_diag_backp_cnt; /* Accumulates number of transitions of tile to backpressured between housekeeping events */
+
+  /* in xsk state */
+  fd_aio_t         _aio[1]; /* rx aio installed on all xsk_aio while running */
+  fd_net_tile_rx_t rx[1];   /* rx aio callback context, also holds the out frag stream state and rx diagnostics */
+  ulong            stats_q; /* Index of the XSK whose kernel stats will be queried next housekeeping */
+
+  /* out frag stream state */
+  ulong * sync;   /* ==fd_mcache_seq_laddr( mcache ), local addr where net tile mcache sync info is published */
+
+  /* flow control state */
+  fd_fctl_t * fctl; /* output flow control */
+
+  /* housekeeping state */
+  ulong async_min; /* minimum number of ticks between processing a housekeeping event, positive integer power of 2 */
+
+  do {
+
+    FD_LOG_INFO(( "Booting net (out-cnt %lu)", out_cnt ));
+    if( FD_UNLIKELY( out_cnt>FD_NET_TILE_OUT_MAX ) ) { FD_LOG_WARNING(( "out_cnt too large" )); return 1; }
+
+    if( FD_UNLIKELY( !scratch ) ) {
+      FD_LOG_WARNING(( "NULL scratch" ));
+      return 1;
+    }
+
+    if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)scratch, fd_net_tile_scratch_align() ) ) ) {
+      FD_LOG_WARNING(( "misaligned scratch" ));
+      return 1;
+    }
+
+    ulong scratch_top = (ulong)scratch;
+
+    /* cnc state init */
+
+    if( FD_UNLIKELY( !cnc ) ) { FD_LOG_WARNING(( "NULL cnc" )); return 1; }
+    if( FD_UNLIKELY( !((1UL<=xsk_cnt) & (xsk_cnt<=FD_NET_TILE_XSK_MAX)) ) ) {
+      FD_LOG_WARNING(( "xsk_cnt must be in [1,%lu]", FD_NET_TILE_XSK_MAX ));
+      return 1;
+    }
+    if( FD_UNLIKELY( fd_cnc_app_sz( cnc )<FD_NET_CNC_APP_SZ( xsk_cnt ) ) ) {
+      FD_LOG_WARNING(( "cnc app sz must be at least %lu", FD_NET_CNC_APP_SZ( xsk_cnt ) ));
+      return 1;
+    }
+    if( FD_UNLIKELY( fd_cnc_signal_query( cnc )!=FD_CNC_SIGNAL_BOOT ) ) { FD_LOG_WARNING(( "already booted" )); return 1; }
+
+    cnc_diag = (ulong *)fd_cnc_app_laddr( cnc );
+
+    /* in_backp==1, backp_cnt==0 indicates waiting for initial credits,
+       cleared during first housekeeping if credits available */
+    cnc_diag_in_backp  = 1UL;
+    cnc_diag_backp_cnt = 0UL;
+
+    /* in xsk init */
+
+    if( FD_UNLIKELY( !xsk_aio ) ) { FD_LOG_WARNING(( "NULL xsk_aio" )); return 1; }
+    for( ulong xsk_idx=0UL; xsk_idx<xsk_cnt; xsk_idx++ ) {
+      if( FD_UNLIKELY( !xsk_aio[ xsk_idx ] ) ) { FD_LOG_WARNING(( "NULL xsk_aio[%lu]", xsk_idx )); return 1; }
+      fd_xsk_t * xsk = fd_xsk_aio_xsk( xsk_aio[ xsk_idx ] );
+      if( FD_UNLIKELY( !xsk ) ) { FD_LOG_WARNING(( "xsk_aio[%lu] not joined", xsk_idx )); return 1; }
+      cnc_diag[ FD_NET_CNC_DIAG_Q( xsk_idx, FD_NET_CNC_DIAG_Q_IFQUEUE ) ] = (ulong)fd_xsk_ifqueue( xsk );
+    }
+    if( FD_UNLIKELY( !rx_burst ) ) { FD_LOG_WARNING(( "rx_burst must be positive" )); return 1; }
+    if( FD_UNLIKELY( !mtu ) ) { FD_LOG_WARNING(( "mtu must be positive" )); return 1; }
+
+    /* out frag stream init */
+
+    if( FD_UNLIKELY( !mcache ) ) { FD_LOG_WARNING(( "NULL mcache" )); return 1; }
+    rx->mcache = mcache;
+    rx->depth  = fd_mcache_depth( mcache );
+    rx->orig   = orig;
+    sync       = fd_mcache_seq_laddr( mcache );
+
+    rx->seq = fd_mcache_seq_query( sync ); /* FIXME: ALLOW OPTION FOR MANUAL SPECIFICATION */
+
+    if( FD_UNLIKELY( !dcache ) ) { FD_LOG_WARNING(( "NULL dcache" )); return 1; }
+
+    rx->base = fd_wksp_containing( dcache );
+    if( FD_UNLIKELY( !rx->base ) ) { FD_LOG_WARNING(( "fd_wksp_containing failed" )); return 1; }
+
+    if( FD_UNLIKELY( !fd_dcache_compact_is_safe( rx->base, dcache, mtu, rx->depth ) ) ) {
+      FD_LOG_WARNING(( "--dcache not compatible with wksp base, --mtu and --mcache depth" ));
+      return 1;
+    }
+
+    rx->mtu    = mtu;
+    rx->chunk0 = fd_dcache_compact_chunk0( rx->base, dcache );
+    rx->wmark  = fd_dcache_compact_wmark ( rx->base, dcache, mtu );
+    rx->chunk  = FD_VOLATILE_CONST( cnc_diag[ FD_NET_CNC_DIAG_CHUNK_IDX ] );
+    if( FD_UNLIKELY( !((rx->chunk0<=rx->chunk) & (rx->chunk<=rx->wmark)) ) ) {
+      rx->chunk = rx->chunk0;
+      FD_LOG_INFO(( "out of bounds cnc chunk index; overriding initial chunk to chunk0" ));
+    }
+    FD_LOG_INFO(( "chunk %lu", rx->chunk ));
+
+    rx->pub_cnt  = 0UL;
+    rx->pub_sz   = 0UL;
+    rx->filt_cnt = 0UL;
+    rx->filt_sz  = 0UL;
+
+    /* out flow control init */
+
+    if( FD_UNLIKELY( !!out_cnt && !out_fseq ) ) { FD_LOG_WARNING(( "NULL out_fseq" )); return 1; }
+
+    fctl = fd_fctl_join( fd_fctl_new( SCRATCH_ALLOC( fd_fctl_align(), fd_fctl_footprint( out_cnt ) ), out_cnt ) );
+    if( FD_UNLIKELY( !fctl ) ) { FD_LOG_WARNING(( "join failed" )); return 1; }
+
+    rx->q_rx_cnt = (ulong *)SCRATCH_ALLOC( alignof(ulong), xsk_cnt*sizeof(ulong) );
+    for( ulong xsk_idx=0UL; xsk_idx<xsk_cnt; xsk_idx++ ) rx->q_rx_cnt[ xsk_idx ] = 0UL;
+    rx->q   = 0UL;
+    stats_q = 0UL;
+
+    for( ulong out_idx=0UL; out_idx<out_cnt; out_idx++ ) {
+
+      ulong * fseq = out_fseq[ out_idx ];
+      if( FD_UNLIKELY( !fseq ) ) { FD_LOG_WARNING(( "NULL out_fseq[%lu]", out_idx )); return 1; }
+      ulong * fseq_diag = (ulong *)fd_fseq_app_laddr( fseq );
+
+      /* Assumes lag_max==depth */
+      if( FD_UNLIKELY( !fd_fctl_cfg_rx_add( fctl, rx->depth, fseq, &fseq_diag[ FD_FSEQ_DIAG_SLOW_CNT ] ) ) ) {
+        FD_LOG_WARNING(( "fd_fctl_cfg_rx_add failed" ));
+        return 1;
+      }
+    }
+
+    /* cr_burst is rx_burst because a single xsk_aio service can publish
+       up to rx_burst frags before we can check cr_avail again.  We use
+       defaults for cr_resume and cr_refill (and possible cr_max if the
+       user wanted to use defaults here too). */
+
+    if( FD_UNLIKELY( !fd_fctl_cfg_done( fctl, rx_burst, cr_max, 0UL, 0UL ) ) ) {
+      FD_LOG_WARNING(( "fd_fctl_cfg_done failed" ));
+      return 1;
+    }
+    FD_LOG_INFO(( "cr_burst %lu cr_max %lu cr_resume %lu cr_refill %lu",
+                  fd_fctl_cr_burst( fctl ), fd_fctl_cr_max( fctl ), fd_fctl_cr_resume( fctl ), fd_fctl_cr_refill( fctl ) ));
+
+    cr_max       = fd_fctl_cr_max( fctl );
+    rx->cr_avail = 0UL; /* Will be initialized by run loop */
+
+    /* housekeeping init */
+
+    if( lazy<=0L ) lazy = fd_tempo_lazy_default( cr_max );
+    FD_LOG_INFO(( "Configuring housekeeping (lazy %li ns)", lazy ));
+
+    async_min = fd_tempo_async_min( lazy, 1UL /*event_cnt*/, (float)fd_tempo_tick_per_ns( NULL ) );
+    if( FD_UNLIKELY( !async_min ) ) { FD_LOG_WARNING(( "bad lazy" )); return 1; }
+
+    /* Install the rx aio last as nothing above can fail after this */
+
+    fd_aio_t * aio = fd_aio_join( fd_aio_new( _aio, rx, fd_net_tile_rx_send ) );
+    if( FD_UNLIKELY( !aio ) ) { FD_LOG_WARNING(( "fd_aio_join failed" )); return 1; }
+    for( ulong xsk_idx=0UL; xsk_idx<xsk_cnt; xsk_idx++ ) fd_xsk_aio_set_rx( xsk_aio[ xsk_idx ], aio );
+
+  } while(0);
+
+  FD_LOG_INFO(( "Running net (orig %lu, xsk-cnt %lu)", orig, xsk_cnt ));
+  fd_cnc_signal( cnc, FD_CNC_SIGNAL_RUN );
+  long then = fd_tickcount();
+  long now  = then;
+  for(;;) {
+
+    /* Do housekeeping at a low rate in the background */
+    if( FD_UNLIKELY( (now-then)>=0L ) ) {
+
+      /* Send synchronization info */
+      fd_mcache_seq_update( sync, rx->seq );
+
+      /* Send diagnostic info */
+      fd_cnc_heartbeat( cnc, now );
+      FD_COMPILER_MFENCE();
+      cnc_diag[ FD_CNC_DIAG_IN_BACKP        ]  = cnc_diag_in_backp;
+      cnc_diag[ FD_CNC_DIAG_BACKP_CNT       ] += cnc_diag_backp_cnt;
+      cnc_diag[ FD_NET_CNC_DIAG_CHUNK_IDX   ]  = rx->chunk;
+      cnc_diag[ FD_NET_CNC_DIAG_RX_PUB_CNT  ] += rx->pub_cnt;
+      cnc_diag[ FD_NET_CNC_DIAG_RX_PUB_SZ   ] += rx->pub_sz;
+      cnc_diag[ FD_NET_CNC_DIAG_RX_FILT_CNT ] += rx->filt_cnt;
+      cnc_diag[ FD_NET_CNC_DIAG_RX_FILT_SZ  ] += rx->filt_sz;
+      FD_COMPILER_MFENCE();
+      cnc_diag_backp_cnt = 0UL;
+      rx->pub_cnt        = 0UL;
+      rx->pub_sz         = 0UL;
+      rx->filt_cnt       = 0UL;
+      rx->filt_sz        = 0UL;
+
+      for( ulong xsk_idx=0UL; xsk_idx<xsk_cnt; xsk_idx++ ) {
+        cnc_diag[ FD_NET_CNC_DIAG_Q( xsk_idx, FD_NET_CNC_DIAG_Q_RX_CNT ) ] += rx->q_rx_cnt[ xsk_idx ];
+        rx->q_rx_cnt[ xsk_idx ] = 0UL;
+      }
+
+      /* Kernel side counters need a syscall, so only do one XSK per
+         housekeeping event */
+      fd_net_tile_q_stats( cnc_diag, stats_q, fd_xsk_aio_xsk( xsk_aio[ stats_q ] ) );
+      stats_q = fd_ulong_if( stats_q+1UL<xsk_cnt, stats_q+1UL, 0UL );
+
+      /* Receive command-and-control signals */
+      ulong s = fd_cnc_signal_query( cnc );
+      if( FD_UNLIKELY( s!=FD_CNC_SIGNAL_RUN ) ) {
+        if( FD_LIKELY( s==FD_CNC_SIGNAL_HALT ) ) break;
+        if( FD_UNLIKELY( s!=FD_NET_CNC_SIGNAL_ACK ) ) {
+          char buf[ FD_CNC_SIGNAL_CSTR_BUF_MAX ];
+          FD_LOG_WARNING(( "Unexpected signal %s (%lu) received; trying to resume", fd_cnc_signal_cstr( s, buf ), s ));
+        }
+        fd_cnc_signal( cnc, FD_CNC_SIGNAL_RUN );
+      }
+
+      /* Receive flow control credits */
+      rx->cr_avail = fd_fctl_tx_cr_update( fctl, rx->cr_avail, rx->seq );
+
+      /* Reload housekeeping timer */
+      then = now + (long)fd_tempo_async_reload( rng, async_min );
+    }
+
+    /* Check if we are backpressured.  A single service can publish up
+       to rx_burst frags so we need at least that many credits before
+       taking frames off the RX ring.  While backpressured, frames
+       accumulate in the XSK RX ring (and the kernel drops frames once
+       it is full). */
+
+    if( FD_UNLIKELY( rx->cr_avail<rx_burst ) ) {
+      cnc_diag_backp_cnt += (ulong)!cnc_diag_in_backp;
+      cnc_diag_in_backp   = 1UL;
+      FD_SPIN_PAUSE();
+      now = fd_tickcount();
+      continue;
+    }
+    cnc_diag_in_backp = 0UL;
+
+    /* Receive and publish a batch of frames (if any) from the next
+       XSK */
+
+    fd_xsk_aio_service( xsk_aio[ rx->q ] );
+    rx->q = fd_ulong_if( rx->q+1UL<xsk_cnt, rx->q+1UL, 0UL );
+
+    now = fd_tickcount();
+  }
+
+  do {
+
+    FD_LOG_INFO(( "Halting net" ));
+
+    FD_LOG_INFO(( "Uninstalling rx aio" ));
+    fd_aio_t * aio = fd_aio_join( fd_aio_new( fd_aio_delete( fd_aio_leave( _aio ) ), NULL, fd_net_tile_rx_drop ) );
+    for( ulong xsk_idx=0UL; xsk_idx<xsk_cnt; xsk_idx++ ) fd_xsk_aio_set_rx( xsk_aio[ xsk_idx ], aio );
+    fd_aio_delete( fd_aio_leave( aio ) );
+
+    FD_LOG_INFO(( "Destroying fctl" ));
+    fd_fctl_delete( fd_fctl_leave( fctl ) );
+
+    FD_LOG_INFO(( "Halted net" ));
+    fd_cnc_signal( cnc, FD_CNC_SIGNAL_BOOT );
+
+  } while(0);
+
+  return 0;
+}
+
+/* Zero copy mode *****************************************************/
+
+FD_STATIC_ASSERT( FD_FCTL_ALIGN          <=FD_NET_ZC_TILE_SCRATCH_ALIGN, packing );
+FD_STATIC_ASSERT( FD_XDP_FRAME_META_ALIGN<=FD_NET_ZC_TILE_SCRATCH_ALIGN, packing );
+FD_STATIC_ASSERT( FD_NET_ZC_UMEM_ALIGN   ==FD_XSK_UMEM_ALIGN,            layout  );
+
+ulong
+fd_net_zc_tile_scratch_align( void ) {
+  return FD_NET_ZC_TILE_SCRATCH_ALIGN;
+}
+
+ulong
+fd_net_zc_tile_scratch_footprint( ulong out_cnt,
+                                  ulong frame_cnt,
+                                  ulong rx_burst ) {
+  if( FD_UNLIKELY( out_cnt>FD_NET_TILE_OUT_MAX ) ) return 0UL;
+  if( FD_UNLIKELY( (!frame_cnt) | (frame_cnt>(1UL<<32)) ) ) return 0UL;
+  if( FD_UNLIKELY( (!rx_burst ) | (rx_burst >(1UL<<32)) ) ) return 0UL;
+  ulong scratch_top = 0UL;
+  SCRATCH_ALLOC( fd_fctl_align(),         fd_fctl_footprint( out_cnt )                  ); /* fctl */
+  SCRATCH_ALLOC( alignof(ulong),          fd_ulong_pow2_up( frame_cnt )*sizeof(ulong)   ); /* pend */
+  SCRATCH_ALLOC( FD_XDP_FRAME_META_ALIGN, rx_burst*sizeof(fd_xsk_frame_meta_t)          ); /* meta */
+  SCRATCH_ALLOC( alignof(ulong),          rx_burst*sizeof(ulong)                        ); /* filt */
+  return fd_ulong_align_up( scratch_top, fd_net_zc_tile_scratch_align() );
+}
+
+int
+fd_net_zc_tile( fd_cnc_t *       cnc,
+                fd_xsk_t *       xsk,
+                ulong            rx_burst,
+                ulong            mtu,
+                ulong            orig,
+                fd_frag_meta_t * mcache,
+                uchar *          dcache,
+                ulong            out_cnt,
+                ulong **         out_fseq,
+                ulong            cr_max,
+                long             lazy,
+                fd_rng_t *       rng,
+                void *           scratch ) {
+
+  /* cnc state */
+  ulong * cnc_diag;           /* ==fd_cnc_app_laddr( cnc ), local address of the net tile cnc diagnostic region */
+  ulong   cnc_diag_in_backp;  /* is the run loop currently backpressured by one or more of the outs, in [0,1] */
+  ulong   cnc_diag_backp_cnt; /* Accumulates number of transitions of tile to backpressured between housekeeping events */
+  ulong   cnc_diag_rx_cnt;    /* Accumulates number of frames received between housekeeping events */
+  ulong   cnc_diag_pub_cnt;   /* Accumulates number of datagrams published between housekeeping events */
+  ulong   cnc_diag_pub_sz;    /* Accumulates number of payload bytes published between housekeeping events */
+  ulong   cnc_diag_filt_cnt;  /* Accumulates number of frames filtered between housekeeping events */
+  ulong   cnc_diag_filt_sz;   /* Accumulates number of frame bytes filtered between housekeeping events */
+
+  /* in xsk state */
+  uchar *               umem;       /* ==fd_xsk_umem_laddr( xsk ), inside the dcache data region */
+  ulong                 frame_sz;   /* UMEM frame size, integer power of 2 */
+  ulong                 frame_mask; /* ==frame_sz-1 */
+  fd_xsk_frame_meta_t * meta;       /* RX completion batch, indexed [0,rx_burst) */
+  ulong *               filt;       /* Offsets of filtered frames to return to the fill ring, indexed [0,rx_burst) */
+
+  /* out frag stream state */
+  ulong   depth;   /* ==fd_mcache_depth( mcache ), positive integer power of 2 */
+  ulong * sync;    /* ==fd_mcache_seq_laddr( mcache ), local addr where net tile mcache sync info is published */
+  ulong   seq;     /* next net tile mcache sequence number to publish */
+  void *  base;    /* ==fd_wksp_containing( dcache ), chunks are relative to this */
+
+  /* frame recycling state */
+  ulong * pend;        /* pend[ s & pend_mask ] is the UMEM offset of the frame holding the payload published at seq s */
+  ulong   pend_depth;  /* ==fd_ulong_pow2_up( frame_cnt ) */
+  ulong   pend_mask;   /* ==pend_depth-1 */
+  ulong   recycle_seq; /* frames published at seqs in [recycle_seq,seq) have not been returned to the fill ring yet */
+
+  /* flow control state */
+  fd_fctl_t * fctl;     /* output flow control */
+  ulong       cr_avail; /* number of flow control credits available to publish downstream, in [0,cr_max] */
+
+  /* housekeeping state */
+  ulong async_min; /* minimum number of ticks between processing a housekeeping event, positive integer power of 2 */
+
+  do {
+
+    FD_LOG_INFO(( "Booting net zc (out-cnt %lu)", out_cnt ));
+    if( FD_UNLIKELY( out_cnt>FD_NET_TILE_OUT_MAX ) ) { FD_LOG_WARNING(( "out_cnt too large" )); return 1; }
+
+    if( FD_UNLIKELY( !scratch ) ) {
+      FD_LOG_WARNING(( "NULL scratch" ));
+      return 1;
+    }
+
+    if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)scratch, fd_net_zc_tile_scratch_align() ) ) ) {
+      FD_LOG_WARNING(( "misaligned scratch" ));
+      return 1;
+    }
+
+    ulong scratch_top = (ulong)scratch;
+
+    /* cnc state init */
+
+    if( FD_UNLIKELY( !cnc ) ) { FD_LOG_WARNING(( "NULL cnc" )); return 1; }
+    if( FD_UNLIKELY( fd_cnc_app_sz( cnc )<FD_NET_CNC_APP_SZ( 1UL ) ) ) {
+      FD_LOG_WARNING(( "cnc app sz must be at least %lu", FD_NET_CNC_APP_SZ( 1UL ) ));
+      return 1;
+    }
+    if( FD_UNLIKELY( fd_cnc_signal_query( cnc )!=FD_CNC_SIGNAL_BOOT ) ) { FD_LOG_WARNING(( "already booted" )); return 1; }
+
+    cnc_diag = (ulong *)fd_cnc_app_laddr( cnc );
+
+    /* in_backp==1, backp_cnt==0 indicates waiting for initial credits,
+       cleared during first housekeeping if credits available */
+    cnc_diag_in_backp  = 1UL;
+    cnc_diag_backp_cnt = 0UL;
+    cnc_diag_rx_cnt    = 0UL;
+    cnc_diag_pub_cnt   = 0UL;
+    cnc_diag_pub_sz    = 0UL;
+    cnc_diag_filt_cnt  = 0UL;
+    cnc_diag_filt_sz   = 0UL;
+
+    /* out frag stream init */
+
+    if( FD_UNLIKELY( !mcache ) ) { FD_LOG_WARNING(( "NULL mcache" )); return 1; }
+    depth = fd_mcache_depth    ( mcache );
+    sync  = fd_mcache_seq_laddr( mcache );
+
+    seq = fd_mcache_seq_query( sync ); /* FIXME: ALLOW OPTION FOR MANUAL SPECIFICATION */
+
+    if( FD_UNLIKELY( !dcache ) ) { FD_LOG_WARNING(( "NULL dcache" )); return 1; }
+
+    base = fd_wksp_containing( dcache );
+    if( FD_UNLIKELY( !base ) ) { FD_LOG_WARNING(( "fd_wksp_containing failed" )); return 1; }
+
+    if( FD_UNLIKELY( !mtu ) ) { FD_LOG_WARNING(( "mtu must be positive" )); return 1; }
+
+    /* in xsk init */
+
+    if( FD_UNLIKELY( !xsk      ) ) { FD_LOG_WARNING(( "NULL xsk" )); return 1; }
+    if( FD_UNLIKELY( !rx_burst ) ) { FD_LOG_WARNING(( "rx_burst must be positive" )); return 1; }
+
+    cnc_diag[ FD_NET_CNC_DIAG_Q( 0UL, FD_NET_CNC_DIAG_Q_IFQUEUE ) ] = (ulong)fd_xsk_ifqueue( xsk );
+
+    fd_xsk_params_t const * params = fd_xsk_get_params( xsk );
+    frame_sz   = params->frame_sz;
+    frame_mask = frame_sz - 1UL;
+    umem       = (uchar *)fd_xsk_umem_laddr( xsk );
+
+    ulong frame_cnt = params->umem_sz / frame_sz;
+    if( FD_UNLIKELY( (!frame_cnt) | (frame_cnt>params->fr_depth) ) ) {
+      FD_LOG_WARNING(( "xsk UMEM frame cnt (%lu) must be in [1,fill ring depth (%lu)]", frame_cnt, params->fr_depth ));
+      return 1;
+    }
+
+    ulong data0 = (ulong)dcache;
+    ulong data1 = data0 + fd_dcache_data_sz( dcache );
+    if( FD_UNLIKELY( !((data0<=(ulong)umem) & ((ulong)umem+params->umem_sz<=data1)) ) ) {
+      FD_LOG_WARNING(( "xsk UMEM is not inside the dcache data region" ));
+      return 1;
+    }
+
+    ulong footprint = fd_net_zc_tile_scratch_footprint( out_cnt, frame_cnt, rx_burst );
+    if( FD_UNLIKELY( !footprint ) ) { FD_LOG_WARNING(( "bad frame_cnt or rx_burst" )); return 1; }
+
+    /* out flow control init */
+
+    if( FD_UNLIKELY( !!out_cnt && !out_fseq ) ) { FD_LOG_WARNING(( "NULL out_fseq" )); return 1; }
+
+    fctl = fd_fctl_join( fd_fctl_new( SCRATCH_ALLOC( fd_fctl_align(), fd_fctl_footprint( out_cnt ) ), out_cnt ) );
+    if( FD_UNLIKELY( !fctl ) ) { FD_LOG_WARNING(( "join failed" )); return 1; }
+
+    for( ulong out_idx=0UL; out_idx<out_cnt; out_idx++ ) {
+
+      ulong * fseq = out_fseq[ out_idx ];
+      if( FD_UNLIKELY( !fseq ) ) { FD_LOG_WARNING(( "NULL out_fseq[%lu]", out_idx )); return 1; }
+      ulong * fseq_diag = (ulong *)fd_fseq_app_laddr( fseq );
+
+      /* Assumes lag_max==depth */
+      if( FD_UNLIKELY( !fd_fctl_cfg_rx_add( fctl, depth, fseq, &fseq_diag[ FD_FSEQ_DIAG_SLOW_CNT ] ) ) ) {
+        FD_LOG_WARNING(( "fd_fctl_cfg_rx_add failed" ));
+        return 1;
+      }
+    }
+
+    /* A single RX completion can publish up to rx_burst frags (see
+       fd_net_tile for the rest) */
+
+    if( FD_UNLIKELY( !fd_fctl_cfg_done( fctl, rx_burst, cr_max, 0UL, 0UL ) ) ) {
+      FD_LOG_WARNING(( "fd_fctl_cfg_done failed" ));
+      return 1;
+    }
+    FD_LOG_INFO(( "cr_burst %lu cr_max %lu cr_resume %lu cr_refill %lu",
+                  fd_fctl_cr_burst( fctl ), fd_fctl_cr_max( fctl ), fd_fctl_cr_resume( fctl ), fd_fctl_cr_refill( fctl ) ));
+
+    cr_max   = fd_fctl_cr_max( fctl );
+    cr_avail = 0UL; /* Will be initialized by run loop */
+
+    /* frame recycling init */
+
+    pend_depth  = fd_ulong_pow2_up( frame_cnt );
+    pend_mask   = pend_depth - 1UL;
+    pend        = (ulong *)              SCRATCH_ALLOC( alignof(ulong),          pend_depth*sizeof(ulong)              );
+    meta        = (fd_xsk_frame_meta_t *)SCRATCH_ALLOC( FD_XDP_FRAME_META_ALIGN, rx_burst*sizeof(fd_xsk_frame_meta_t) );
+    filt        = (ulong *)              SCRATCH_ALLOC( alignof(ulong),          rx_burst*sizeof(ulong)                );
+    recycle_seq = seq;
+
+    /* housekeeping init */
+
+    if( lazy<=0L ) lazy = fd_tempo_lazy_default( cr_max );
+    FD_LOG_INFO(( "Configuring housekeeping (lazy %li ns)", lazy ));
+
+    async_min = fd_tempo_async_min( lazy, 1UL /*event_cnt*/, (float)fd_tempo_tick_per_ns( NULL ) );
+    if( FD_UNLIKELY( !async_min ) ) { FD_LOG_WARNING(( "bad lazy" )); return 1; }
+
+    /* Give every frame to the kernel last as nothing above can fail
+       after this (pend is free at this point, so use it to stage the
+       offsets) */
+
+    for( ulong frame_idx=0UL; frame_idx<frame_cnt; frame_idx++ ) pend[ frame_idx ] = frame_idx*frame_sz;
+    if( FD_UNLIKELY( fd_xsk_rx_enqueue( xsk, pend, frame_cnt )!=frame_cnt ) ) {
+      FD_LOG_WARNING(( "fd_xsk_rx_enqueue failed (xsk not freshly joined?)" ));
+      return 1;
+    }
+
+  } while(0);
+
+  FD_LOG_INFO(( "Running net zc (orig %lu)", orig ));
+  fd_cnc_signal( cnc, FD_CNC_SIGNAL_RUN );
+  ulong ctl  = fd_frag_meta_ctl( orig, 1 /*som*/, 1 /*eom*/, 0 /*err*/ );
+  long  then = fd_tickcount();
+  long  now  = then;
+  for(;;) {
+
+    /* Do housekeeping at a low rate in the background */
+    if( FD_UNLIKELY( (now-then)>=0L ) ) {
+
+      /* Send synchronization info */
+      fd_mcache_seq_update( sync, seq );
+
+      /* Send diagnostic info */
+      fd_cnc_heartbeat( cnc, now );
+      FD_COMPILER_MFENCE();
+      cnc_diag[ FD_CNC_DIAG_IN_BACKP        ]  = cnc_diag_in_backp;
+      cnc_diag[ FD_CNC_DIAG_BACKP_CNT       ] += cnc_diag_backp_cnt;
+      cnc_diag[ FD_NET_CNC_DIAG_RX_PUB_CNT  ] += cnc_diag_pub_cnt;
+      cnc_diag[ FD_NET_CNC_DIAG_RX_PUB_SZ   ] += cnc_diag_pub_sz;
+      cnc_diag[ FD_NET_CNC_DIAG_RX_FILT_CNT ] += cnc_diag_filt_cnt;
+      cnc_diag[ FD_NET_CNC_DIAG_RX_FILT_SZ  ] += cnc_diag_filt_sz;
+      cnc_diag[ FD_NET_CNC_DIAG_Q( 0UL, FD_NET_CNC_DIAG_Q_RX_CNT ) ] += cnc_diag_rx_cnt;
+      FD_COMPILER_MFENCE();
+      fd_net_tile_q_stats( cnc_diag, 0UL, xsk );
+      cnc_diag_backp_cnt = 0UL;
+      cnc_diag_rx_cnt    = 0UL;
+      cnc_diag_pub_cnt   = 0UL;
+      cnc_diag_pub_sz    = 0UL;
+      cnc_diag_filt_cnt  = 0UL;
+      cnc_diag_filt_sz   = 0UL;
+
+      /* Receive command-and-control signals */
+      ulong s = fd_cnc_signal_query( cnc );
+      if( FD_UNLIKELY( s!=FD_CNC_SIGNAL_RUN ) ) {
+        if( FD_LIKELY( s==FD_CNC_SIGNAL_HALT ) ) break;
+        if( FD_UNLIKELY( s!=FD_NET_CNC_SIGNAL_ACK ) ) {
+          char buf[ FD_CNC_SIGNAL_CSTR_BUF_MAX ];
+          FD_LOG_WARNING(( "Unexpected signal %s (%lu) received; trying to resume", fd_cnc_signal_cstr( s, buf ), s ));
+        }
+        fd_cnc_signal( cnc, FD_CNC_SIGNAL_RUN );
+      }
+
+      /* Receive flow control credits */
+      cr_avail = fd_fctl_tx_cr_update( fctl, cr_avail, seq );
+
+      /* Return frames all reliable consumers are done with to the fill
+         ring.  A consumer's fseq is the next seq it will process, so
+         the frames published at seqs in [recycle_seq,slowest) are no
+         longer in use.  (Frames are never held across more than
+         pend_depth seqs as there are only frame_cnt frames.) */
+
+      ulong slowest = seq;
+      for( ulong out_idx=0UL; out_idx<out_cnt; out_idx++ ) {
+        ulong out_seq = fd_fseq_query( out_fseq[ out_idx ] );
+        if( fd_seq_lt( out_seq, slowest ) ) slowest = out_seq;
+      }
+
+      long recycle_cnt = fd_seq_diff( slowest, recycle_seq );
+      if( FD_LIKELY( recycle_cnt>0L ) ) {
+        ulong cnt  = (ulong)recycle_cnt;
+        ulong idx  = recycle_seq & pend_mask;
+        ulong cnt0 = fd_ulong_min( cnt, pend_depth-idx ); /* pend is a ring, so at most two contiguous runs */
+        ulong done = fd_xsk_rx_enqueue( xsk, pend+idx, cnt0 );
+        if( FD_LIKELY( done==cnt0 ) ) done += fd_xsk_rx_enqueue( xsk, pend, cnt-cnt0 );
+        recycle_seq = fd_seq_inc( recycle_seq, done ); /* Retry any stragglers next housekeeping (shouldn't happen) */
+      }
+
+      /* Reload housekeeping timer */
+      then = now + (long)fd_tempo_async_reload( rng, async_min );
+    }
+
+    /* Check if we are backpressured (see fd_net_tile) */
+
+    if( FD_UNLIKELY( cr_avail<rx_burst ) ) {
+      cnc_diag_backp_cnt += (ulong)!cnc_diag_in_backp;
+      cnc_diag_in_backp   = 1UL;
+      FD_SPIN_PAUSE();
+      now = fd_tickcount();
+      continue;
+    }
+    cnc_diag_in_backp = 0UL;
+
+    /* Receive a batch of frames (if any) */
+
+    ulong rx_cnt = fd_xsk_rx_complete( xsk, meta, rx_burst );
+    if( FD_LIKELY( !rx_cnt ) ) {
+      now = fd_tickcount();
+      continue;
+    }
+
+    /* All frames in the batch were received no later than now */
+    ulong tsorig = fd_frag_meta_ts_comp( fd_tickcount() );
+    cnc_diag_rx_cnt += rx_cnt;
+
+    /* Publish the payloads in place */
+
+    ulong filt_cnt = 0UL;
+    for( ulong rx_idx=0UL; rx_idx<rx_cnt; rx_idx++ ) {
+      ulong   off       = meta[ rx_idx ].off;
+      ulong   pkt_sz    = (ulong)meta[ rx_idx ].sz;
+      ulong   frame_off = off & ~frame_mask;
+      uchar * pkt       = umem + off;
+
+      fd_net_udp_info_t info[1];
+      if( FD_UNLIKELY( (fd_net_parse_udp( pkt, pkt_sz, info )!=FD_NET_PARSE_SUCCESS) || (info->payload_sz>mtu) ) ) {
+        filt[ filt_cnt++ ] = frame_off;
+        cnc_diag_filt_cnt++;
+        cnc_diag_filt_sz += pkt_sz;
+        continue;
+      }
+
+      /* Chunks are FD_CHUNK_ALIGN aligned and frames are at least
+         XDP_PACKET_HEADROOM aligned, so there is always room to move
+         the payload down to a chunk boundary inside its frame */
+
+      ulong   sz      = info->payload_sz;
+      uchar * payload = pkt + info->payload_off;
+      uchar * dst     = (uchar *)fd_ulong_align_dn( (ulong)payload, FD_CHUNK_ALIGN );
+      if( FD_UNLIKELY( dst!=payload ) ) memmove( dst, payload, sz );
+
+      ulong chunk = fd_laddr_to_chunk( base, dst );
+      ulong tspub = fd_frag_meta_ts_comp( fd_tickcount() );
+      fd_mcache_publish( mcache, depth, seq, fd_net_udp_sig( info ), chunk, sz, ctl, tsorig, tspub );
+
+      pend[ seq & pend_mask ] = frame_off;
+      seq = fd_seq_inc( seq, 1UL );
+      cr_avail--;
+      cnc_diag_pub_cnt++;
+      cnc_diag_pub_sz += sz;
+    }
+
+    /* Filtered frames go straight back to the kernel.  This can't fail
+       as the fill ring is deep enough for every frame. */
+
+    if( FD_UNLIKELY( filt_cnt ) ) fd_xsk_rx_enqueue( xsk, filt, filt_cnt );
+
+    now = fd_tickcount();
+  }
+
+  do {
+
+    FD_LOG_INFO(( "Halting net zc" ));
+
+    FD_LOG_INFO(( "Destroying fctl" ));
+    fd_fctl_delete( fd_fctl_leave( fctl ) );
+
+    FD_LOG_INFO(( "Halted net zc" ));
+    fd_cnc_signal( cnc, FD_CNC_SIGNAL_BOOT );
+
+  } while(0);
+
+  return 0;
+}
+
+#undef SCRATCH_ALLOC
+
+#endif
@@ -0,0 +1,311 @@
+#include "../fd_disco.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86 && defined(__linux__) && FD_HAS_LIBBPF
+
+#include "../../tango/xdp/fd_xdp.h"
+
+FD_STATIC_ASSERT( FD_NET_TILE_SCRATCH_ALIGN   <=FD_SHMEM_HUGE_PAGE_SZ, alignment );
+FD_STATIC_ASSERT( FD_NET_ZC_TILE_SCRATCH_ALIGN<=FD_SHMEM_HUGE_PAGE_SZ, alignment );
+
+/* ZC_HEADROOM is the UMEM headroom used with --zero-copy.  The kernel
+   puts received frames XDP_PACKET_HEADROOM+ZC_HEADROOM bytes into
+   their UMEM frame.  With an untagged eth / option-less ip4 / udp
+   frame, this makes UDP payloads start on a chunk boundary (256+22+42
+   is a multiple of 64) such that they can be published in place. */
+
+#define ZC_HEADROOM (22UL)
+
+/* fd_net_tile runs one net tile per --cnc / --mcache / --dcache (the
+   comma separated lists must have the same length, tile i of the
+   thread group runs net tile i).  The RX queues listed in --ifqueues
+   (default all RX queues of --ifname) are spread over the net tiles,
+   preferring tiles on the NIC's NUMA node (see fd_net_queue_assign).
+   Each tile services an XSK per assigned queue and allocates it on its
+   own NUMA node.  Net tile i publishes with origin --orig + i.  If
+   there is one net tile, all --out-fseqs are its reliable consumers.
+   Otherwise, --out-fseqs is either empty or has one fseq per net tile
+   (e.g. the downstream verify tile fed by that net tile). */
+
+#define NET_TILE_MAX (64UL)
+#define NET_QUEUE_MAX (256UL)
+#define NET_OUT_MAX (256UL)
+
+static char const * app_name;
+static char const * ifname;
+static ulong        frame_sz;
+static ulong        xsk_depth;
+static ulong        rx_burst;
+static ulong        mtu;
+static ulong        orig;
+static ulong        cr_max;
+static long         lazy;
+static uint         seed;
+static int          zc;
+
+static ulong            tile_cnt;
+static fd_cnc_t *       cnc   [ NET_TILE_MAX ];
+static fd_frag_meta_t * mcache[ NET_TILE_MAX ];
+static uchar *          dcache[ NET_TILE_MAX ];
+
+static ulong            queue_cnt;
+static uint             queue     [ NET_QUEUE_MAX ];
+static ulong            queue_tile[ NET_QUEUE_MAX ];
+
+static ulong            out_cnt;
+static ulong *          out_fseq[ NET_OUT_MAX ];
+
+/* net_tile_main runs net tile tile_idx (==argc).  Returns the net
+   tile's return value.  Logs and aborts on setup failure. */
+
+static int
+net_tile_main( int     argc,
+               char ** argv ) {
+  (void)argv;
+  ulong tile_idx = (ulong)argc;
+
+  /* Select the out fseqs for this tile */
+
+  ulong    tile_out_cnt  = tile_cnt==1UL ? out_cnt : fd_ulong_min( out_cnt, 1UL );
+  ulong ** tile_out_fseq = tile_cnt==1UL ? out_fseq : (out_fseq + tile_idx);
+
+  /* Select the queues for this tile */
+
+  uint  tile_queue[ NET_QUEUE_MAX ];
+  ulong xsk_cnt = 0UL;
+  for( ulong queue_idx=0UL; queue_idx<queue_cnt; queue_idx++ )
+    if( queue_tile[ queue_idx ]==tile_idx ) tile_queue[ xsk_cnt++ ] = queue[ queue_idx ];
+
+  if( FD_UNLIKELY( !xsk_cnt ) ) FD_LOG_ERR(( "net tile %lu has no RX queues", tile_idx ));
+  if( FD_UNLIKELY( zc && xsk_cnt>1UL ) ) FD_LOG_ERR(( "--zero-copy supports only one RX queue per net tile" ));
+
+  ulong tile_orig = orig + tile_idx;
+
+  fd_rng_t _rng[1];
+  fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, seed, tile_idx ) );
+
+  ulong page_sz = FD_SHMEM_HUGE_PAGE_SZ;
+  ulong cpu_idx = fd_tile_cpu_id( fd_tile_idx() );
+
+  ulong xsk_footprint = fd_xsk_footprint( frame_sz, xsk_depth, xsk_depth, xsk_depth, xsk_depth );
+  if( FD_UNLIKELY( !xsk_footprint ) ) FD_LOG_ERR(( "fd_xsk_footprint failed" ));
+
+  /* In zero copy mode, the UMEM is the dcache (sized to hold one frame
+     per fill ring entry) and only the fd_xsk_t itself is allocated
+     here. */
+
+  ulong   frame_cnt = xsk_depth;
+  uchar * umem      = NULL;
+  if( zc ) {
+    ulong umem_frame_cnt;
+    umem = fd_net_zc_umem( dcache[ tile_idx ], frame_sz, &umem_frame_cnt );
+    if( FD_UNLIKELY( umem_frame_cnt<frame_cnt ) )
+      FD_LOG_ERR(( "--dcache data too small for --zero-copy (need a data_sz of at least %lu)",
+                   fd_net_zc_dcache_data_sz( frame_sz, frame_cnt ) ));
+    xsk_footprint = fd_xsk_shumem_footprint();
+  }
+
+  ulong          xsk_page_cnt = fd_ulong_align_up( xsk_footprint, page_sz ) / page_sz;
+  fd_xsk_t *     xsk    [ NET_QUEUE_MAX ];
+  fd_xsk_aio_t * xsk_aio[ NET_QUEUE_MAX ];
+  ulong          xsk_aio_page_cnt = 0UL;
+
+  for( ulong xsk_idx=0UL; xsk_idx<xsk_cnt; xsk_idx++ ) {
+    FD_LOG_NOTICE(( "net tile %lu: Creating xsk (--app-name %s --ifname %s --ifqueue %u --frame-sz %lu --xsk-depth %lu --zero-copy %i)",
+                    tile_idx, app_name, ifname, tile_queue[ xsk_idx ], frame_sz, xsk_depth, zc ));
+
+    void * xsk_mem = fd_shmem_acquire( page_sz, xsk_page_cnt, cpu_idx );
+    if( FD_UNLIKELY( !xsk_mem ) ) FD_LOG_ERR(( "fd_shmem_acquire failed (need at least %lu free huge pages on numa node %lu)",
+                                               xsk_page_cnt, fd_shmem_numa_idx( cpu_idx ) ));
+
+    void * shxsk = zc ? fd_xsk_new_shumem( xsk_mem, frame_sz, xsk_depth, xsk_depth, xsk_depth, xsk_depth,
+                                           umem, frame_cnt*frame_sz, ZC_HEADROOM )
+                      : fd_xsk_new       ( xsk_mem, frame_sz, xsk_depth, xsk_depth, xsk_depth, xsk_depth );
+    if( FD_UNLIKELY( !shxsk ) ) FD_LOG_ERR(( "fd_xsk_new failed" ));
+    if( FD_UNLIKELY( !fd_xsk_bind( shxsk, app_name, ifname, tile_queue[ xsk_idx ] ) ) ) FD_LOG_ERR(( "fd_xsk_bind failed" ));
+    xsk[ xsk_idx ] = fd_xsk_join( shxsk ); /* Also activates the xsk */
+    if( FD_UNLIKELY( !xsk[ xsk_idx ] ) ) FD_LOG_ERR(( "fd_xsk_join failed" ));
+
+    xsk_aio[ xsk_idx ] = NULL;
+    if( !zc ) {
+      ulong xsk_aio_footprint = fd_xsk_aio_footprint( xsk_depth, rx_burst );
+      if( FD_UNLIKELY( !xsk_aio_footprint ) ) FD_LOG_ERR(( "fd_xsk_aio_footprint failed" ));
+      xsk_aio_page_cnt = fd_ulong_align_up( xsk_aio_footprint, page_sz ) / page_sz;
+      void * xsk_aio_mem = fd_shmem_acquire( page_sz, xsk_aio_page_cnt, cpu_idx );
+      if( FD_UNLIKELY( !xsk_aio_mem ) ) FD_LOG_ERR(( "fd_shmem_acquire failed (need at least %lu free huge pages on numa node %lu)",
+                                                     xsk_aio_page_cnt, fd_shmem_numa_idx( cpu_idx ) ));
+      xsk_aio[ xsk_idx ] = fd_xsk_aio_join( fd_xsk_aio_new( xsk_aio_mem, xsk_depth, rx_burst ), xsk[ xsk_idx ] );
+      if( FD_UNLIKELY( !xsk_aio[ xsk_idx ] ) ) FD_LOG_ERR(( "fd_xsk_aio_join failed" ));
+    }
+  }
+
+  FD_LOG_NOTICE(( "net tile %lu: Creating scratch (--rx-burst %lu)", tile_idx, rx_burst ));
+  ulong footprint = zc ? fd_net_zc_tile_scratch_footprint( tile_out_cnt, frame_cnt, rx_burst )
+                       : fd_net_tile_scratch_footprint   ( tile_out_cnt, xsk_cnt );
+  if( FD_UNLIKELY( !footprint ) ) FD_LOG_ERR(( "scratch footprint failed" ));
+  ulong  page_cnt = fd_ulong_align_up( footprint, page_sz ) / page_sz;
+  void * scratch  = fd_shmem_acquire( page_sz, page_cnt, cpu_idx );
+  if( FD_UNLIKELY( !scratch ) ) FD_LOG_ERR(( "fd_shmem_acquire failed (need at least %lu free huge pages on numa node %lu)",
+                                             page_cnt, fd_shmem_numa_idx( cpu_idx ) ));
+
+  FD_LOG_NOTICE(( "net tile %lu: Run", tile_idx ));
+
+  int err = zc ? fd_net_zc_tile( cnc[ tile_idx ], xsk[ 0 ],         rx_burst, mtu, tile_orig, mcache[ tile_idx ], dcache[ tile_idx ],
+                                 tile_out_cnt, tile_out_fseq, cr_max, lazy, rng, scratch )
+               : fd_net_tile   ( cnc[ tile_idx ], xsk_cnt, xsk_aio, rx_burst, mtu, tile_orig, mcache[ tile_idx ], dcache[ tile_idx ],
+                                 tile_out_cnt, tile_out_fseq, cr_max, lazy, rng, scratch );
+  if( FD_UNLIKELY( err ) ) FD_LOG_WARNING(( "net tile %lu failed (%i)", tile_idx, err ));
+
+  fd_shmem_release( scratch, page_sz, page_cnt );
+  for( ulong xsk_idx=xsk_cnt; xsk_idx; xsk_idx-- ) {
+    if( FD_UNLIKELY( fd_xsk_deactivate( xsk[ xsk_idx-1UL ] ) ) ) FD_LOG_WARNING(( "fd_xsk_deactivate failed" ));
+    if( xsk_aio[ xsk_idx-1UL ] )
+      fd_shmem_release( fd_xsk_aio_delete( fd_xsk_aio_leave( xsk_aio[ xsk_idx-1UL ] ) ), page_sz, xsk_aio_page_cnt );
+    fd_shmem_release( fd_xsk_delete( fd_xsk_unbind( fd_xsk_leave( xsk[ xsk_idx-1UL ] ) ) ), page_sz, xsk_page_cnt );
+  }
+  fd_rng_delete( fd_rng_leave( rng ) );
+  return err;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  FD_LOG_NOTICE(( "Init" ));
+
+  char const * _cnc       = fd_env_strip_cmdline_cstr ( &argc, &argv, "--cnc",       NULL, NULL   );
+  /**/         app_name   = fd_env_strip_cmdline_cstr ( &argc, &argv, "--app-name",  NULL, NULL   );
+  /**/         ifname     = fd_env_strip_cmdline_cstr ( &argc, &argv, "--ifname",    NULL, NULL   );
+  char const * _ifqueues  = fd_env_strip_cmdline_cstr ( &argc, &argv, "--ifqueues",  NULL, NULL   ); /* NULL <> all */
+  /**/         frame_sz   = fd_env_strip_cmdline_ulong( &argc, &argv, "--frame-sz",  NULL, 2048UL );
+  /**/         xsk_depth  = fd_env_strip_cmdline_ulong( &argc, &argv, "--xsk-depth", NULL, 1024UL );
+  /**/         rx_burst   = fd_env_strip_cmdline_ulong( &argc, &argv, "--rx-burst",  NULL, 64UL   );
+  /**/         mtu        = fd_env_strip_cmdline_ulong( &argc, &argv, "--mtu",       NULL, 1472UL );
+  /**/         orig       = fd_env_strip_cmdline_ulong( &argc, &argv, "--orig",      NULL, 0UL    );
+  char const * _mcache    = fd_env_strip_cmdline_cstr ( &argc, &argv, "--mcache",    NULL, NULL   );
+  char const * _dcache    = fd_env_strip_cmdline_cstr ( &argc, &argv, "--dcache",    NULL, NULL   );
+  char const * _out_fseqs = fd_env_strip_cmdline_cstr ( &argc, &argv, "--out-fseqs", NULL, ""     );
+  /**/         cr_max     = fd_env_strip_cmdline_ulong( &argc, &argv, "--cr-max",    NULL, 0UL    ); /*   0 <> use default */
+  /**/         lazy       = fd_env_strip_cmdline_long ( &argc, &argv, "--lazy",      NULL, 0L     ); /* <=0 <> use default */
+  /**/         seed       = fd_env_strip_cmdline_uint ( &argc, &argv, "--seed",      NULL, (uint)(ulong)fd_tickcount() );
+  /**/         zc         = fd_env_strip_cmdline_int  ( &argc, &argv, "--zero-copy", NULL, 0      );
+
+  if( FD_UNLIKELY( !app_name ) ) FD_LOG_ERR(( "--app-name not specified" ));
+  if( FD_UNLIKELY( !ifname   ) ) FD_LOG_ERR(( "--ifname not specified"   ));
+  if( FD_UNLIKELY( !_cnc     ) ) FD_LOG_ERR(( "--cnc not specified"      ));
+  if( FD_UNLIKELY( !_mcache  ) ) FD_LOG_ERR(( "--mcache not specified"   ));
+  if( FD_UNLIKELY( !_dcache  ) ) FD_LOG_ERR(( "--dcache not specified"   ));
+
+  char * _tile_cnc   [ NET_TILE_MAX+1UL ];
+  char * _tile_mcache[ NET_TILE_MAX+1UL ];
+  char * _tile_dcache[ NET_TILE_MAX+1UL ];
+  tile_cnt = fd_cstr_tokenize( _tile_cnc, NET_TILE_MAX+1UL, (char *)_cnc, ',' ); /* argv is non-const */
+  if( FD_UNLIKELY( (!tile_cnt) | (tile_cnt>NET_TILE_MAX) ) ) FD_LOG_ERR(( "--cnc must list 1 to %lu net tile cncs", NET_TILE_MAX ));
+  if( FD_UNLIKELY( fd_cstr_tokenize( _tile_mcache, NET_TILE_MAX+1UL, (char *)_mcache, ',' )!=tile_cnt ) )
+    FD_LOG_ERR(( "--mcache must list one mcache per --cnc" ));
+  if( FD_UNLIKELY( fd_cstr_tokenize( _tile_dcache, NET_TILE_MAX+1UL, (char *)_dcache, ',' )!=tile_cnt ) )
+    FD_LOG_ERR(( "--dcache must list one dcache per --cnc" ));
+  if( FD_UNLIKELY( tile_cnt>fd_tile_cnt() ) )
+    FD_LOG_ERR(( "%lu net tiles requested but only %lu tiles available (use --tile-cpus)", tile_cnt, fd_tile_cnt() ));
+
+  for( ulong tile_idx=0UL; tile_idx<tile_cnt; tile_idx++ ) {
+    FD_LOG_NOTICE(( "Joining --cnc[%lu] %s", tile_idx, _tile_cnc[ tile_idx ] ));
+    cnc[ tile_idx ] = fd_cnc_join( fd_wksp_map( _tile_cnc[ tile_idx ] ) );
+    if( FD_UNLIKELY( !cnc[ tile_idx ] ) ) FD_LOG_ERR(( "fd_cnc_join failed" ));
+
+    FD_LOG_NOTICE(( "Joining --mcache[%lu] %s", tile_idx, _tile_mcache[ tile_idx ] ));
+    mcache[ tile_idx ] = fd_mcache_join( fd_wksp_map( _tile_mcache[ tile_idx ] ) );
+    if( FD_UNLIKELY( !mcache[ tile_idx ] ) ) FD_LOG_ERR(( "fd_mcache_join failed" ));
+
+    FD_LOG_NOTICE(( "Joining --dcache[%lu] %s", tile_idx, _tile_dcache[ tile_idx ] ));
+    dcache[ tile_idx ] = fd_dcache_join( fd_wksp_map( _tile_dcache[ tile_idx ] ) );
+    if( FD_UNLIKELY( !dcache[ tile_idx ] ) ) FD_LOG_ERR(( "fd_dcache_join failed" ));
+  }
+
+  char * _out_fseq[ NET_OUT_MAX ];
+  out_cnt = fd_cstr_tokenize( _out_fseq, NET_OUT_MAX, (char *)_out_fseqs, ',' ); /* argv is non-const */
+  if( FD_UNLIKELY( out_cnt>NET_OUT_MAX ) ) FD_LOG_ERR(( "too many --out-fseqs specified for current implementation" ));
+  if( FD_UNLIKELY( (tile_cnt>1UL) & (!!out_cnt) & (out_cnt!=tile_cnt) ) )
+    FD_LOG_ERR(( "with multiple net tiles, --out-fseqs must be empty or list one fseq per net tile" ));
+
+  for( ulong out_idx=0UL; out_idx<out_cnt; out_idx++ ) {
+    FD_LOG_NOTICE(( "Joining --out-fseqs[%lu] %s", out_idx, _out_fseq[ out_idx ] ));
+    out_fseq[ out_idx ] = fd_fseq_join( fd_wksp_map( _out_fseq[ out_idx ] ) );
+    if( FD_UNLIKELY( !out_fseq[ out_idx ] ) ) FD_LOG_ERR(( "fd_fseq_join failed" ));
+  }
+
+  /* Determine the RX queues to service */
+
+  if( !_ifqueues ) {
+    queue_cnt = fd_xdp_iface_rxq_cnt( ifname );
+    if( FD_UNLIKELY( !queue_cnt ) ) FD_LOG_ERR(( "unable to determine the RX queues of --ifname %s (use --ifqueues)", ifname ));
+    if( FD_UNLIKELY( queue_cnt>NET_QUEUE_MAX ) ) FD_LOG_ERR(( "too many RX queues for current implementation (use --ifqueues)" ));
+    for( ulong queue_idx=0UL; queue_idx<queue_cnt; queue_idx++ ) queue[ queue_idx ] = (uint)queue_idx;
+  } else {
+    char * _queue[ NET_QUEUE_MAX+1UL ];
+    queue_cnt = fd_cstr_tokenize( _queue, NET_QUEUE_MAX+1UL, (char *)_ifqueues, ',' ); /* argv is non-const */
+    if( FD_UNLIKELY( (!queue_cnt) | (queue_cnt>NET_QUEUE_MAX) ) ) FD_LOG_ERR(( "--ifqueues must list 1 to %lu RX queues", NET_QUEUE_MAX ));
+    for( ulong queue_idx=0UL; queue_idx<queue_cnt; queue_idx++ ) queue[ queue_idx ] = fd_cstr_to_uint( _queue[ queue_idx ] );
+  }
+
+  /* Assign the queues to net tiles by NUMA locality */
+
+  ulong tile_numa[ NET_TILE_MAX ];
+  for( ulong tile_idx=0UL; tile_idx<tile_cnt; tile_idx++ ) tile_numa[ tile_idx ] = fd_shmem_numa_idx( fd_tile_cpu_id( tile_idx ) );
+  ulong nic_numa = fd_xdp_iface_numa_idx( ifname );
+
+  ulong used_cnt = fd_net_queue_assign( queue_cnt, tile_cnt, tile_numa, nic_numa, queue_tile );
+  if( FD_UNLIKELY( used_cnt<tile_cnt ) ) FD_LOG_ERR(( "fewer RX queues (%lu) than net tiles (%lu)", queue_cnt, tile_cnt ));
+
+  if( nic_numa==ULONG_MAX ) FD_LOG_NOTICE(( "--ifname %s numa node unknown", ifname ));
+  else                      FD_LOG_NOTICE(( "--ifname %s on numa node %lu", ifname, nic_numa ));
+  for( ulong queue_idx=0UL; queue_idx<queue_cnt; queue_idx++ )
+    FD_LOG_NOTICE(( "RX queue %u -> net tile %lu (cpu %lu)", queue[ queue_idx ], queue_tile[ queue_idx ],
+                    fd_tile_cpu_id( queue_tile[ queue_idx ] ) ));
+
+  FD_LOG_NOTICE(( "Using --cr-max %lu, --lazy %li, --seed %u", cr_max, lazy, seed ));
+
+  /* Run net tiles 1:tile_cnt-1 on the corresponding tiles and net tile
+     0 on this tile */
+
+  fd_tile_exec_t * exec[ NET_TILE_MAX ];
+  for( ulong tile_idx=1UL; tile_idx<tile_cnt; tile_idx++ ) {
+    exec[ tile_idx ] = fd_tile_exec_new( tile_idx, net_tile_main, (int)tile_idx, NULL );
+    if( FD_UNLIKELY( !exec[ tile_idx ] ) ) FD_LOG_ERR(( "fd_tile_exec_new failed" ));
+  }
+
+  int err = net_tile_main( 0, NULL );
+
+  for( ulong tile_idx=1UL; tile_idx<tile_cnt; tile_idx++ ) {
+    int tile_err;
+    char const * fail = fd_tile_exec_delete( exec[ tile_idx ], &tile_err );
+    if( FD_UNLIKELY( fail ) ) FD_LOG_ERR(( "net tile %lu failed (%s)", tile_idx, fail ));
+    if( !err ) err = tile_err;
+  }
+  if( FD_UNLIKELY( err ) ) FD_LOG_ERR(( "fd_net_tile failed (%i)", err ));
+
+  FD_LOG_NOTICE(( "Fini" ));
+
+  for( ulong out_idx=out_cnt; out_idx; out_idx-- ) fd_wksp_unmap( fd_fseq_leave( out_fseq[ out_idx-1UL ] ) );
+  for( ulong tile_idx=tile_cnt; tile_idx; tile_idx-- ) {
+    fd_wksp_unmap( fd_dcache_leave( dcache[ tile_idx-1UL ] ) );
+    fd_wksp_unmap( fd_mcache_leave( mcache[ tile_idx-1UL ] ) );
+    fd_wksp_unmap( fd_cnc_leave   ( cnc   [ tile_idx-1UL ] ) );
+  }
+
+  fd_halt();
+  return err;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "implement support for this build target" ));
+  fd_halt();
+  return 1;
+}
+
+#endif
@@ -0,0 +1,316 @@
+#include "../fd_disco.h"
+
+/* test_net covers the frame validation done by the net tile, the
+   zero copy UMEM layout helpers and the RX queue to net tile
+   assignment.  The tile itself needs an AF_XDP
+   capable interface (see test_net_veth). */
+
+static uchar frame[ 2048 ];
+
+#define ZC_FRAME_SZ  (2048UL)
+#define ZC_FRAME_CNT (8UL)
+#define ZC_DATA_SZ   (ZC_FRAME_CNT*ZC_FRAME_SZ + FD_NET_ZC_UMEM_ALIGN)
+
+static uchar zc_mem[ FD_DCACHE_FOOTPRINT( ZC_DATA_SZ, 0UL ) + FD_NET_ZC_UMEM_ALIGN ] __attribute__((aligned(FD_NET_ZC_UMEM_ALIGN)));
+
+/* build_frame writes an eth(/vlan)/ip4/udp frame with a payload_sz byte
+   payload (and opt_sz bytes of ip4 options) to frame and returns the
+   frame size. */
+
+static ulong
+build_frame( int   vlan,
+             ulong opt_sz,
+             ulong payload_sz ) {
+  uchar * p = frame;
+
+  fd_eth_hdr_t eth[1];
+  fd_memset( eth, 0, sizeof(fd_eth_hdr_t) );
+  eth->net_type = fd_ushort_bswap( vlan ? FD_ETH_HDR_TYPE_VLAN : FD_ETH_HDR_TYPE_IP );
+  fd_memcpy( p, eth, sizeof(fd_eth_hdr_t) ); p += sizeof(fd_eth_hdr_t);
+
+  if( vlan ) {
+    fd_vlan_tag_t tag[1];
+    tag->net_vid  = fd_ushort_bswap( (ushort)42 );
+    tag->net_type = fd_ushort_bswap( FD_ETH_HDR_TYPE_IP );
+    fd_memcpy( p, tag, sizeof(fd_vlan_tag_t) ); p += sizeof(fd_vlan_tag_t);
+  }
+
+  ulong ihl = 20UL + opt_sz;
+  fd_ip4_hdr_t ip4[3];
+  fd_memset( ip4, 0, sizeof(ip4) );
+  ((uchar *)ip4)[0] = (uchar)(0x40UL | (ihl/4UL)); /* version 4, ihl */
+  ip4->net_tot_len  = fd_ushort_bswap( (ushort)(ihl + sizeof(fd_udp_hdr_t) + payload_sz) );
+  ip4->net_frag_off = fd_ushort_bswap( FD_IP4_HDR_FRAG_OFF_DF );
+  ip4->ttl          = (uchar)64;
+  ip4->protocol     = FD_IP4_HDR_PROTOCOL_UDP;
+  ip4->saddr        = FD_IP4_ADDR( 10, 0, 0, 1 );
+  ip4->daddr        = FD_IP4_ADDR( 10, 0, 0, 2 );
+  ip4->check        = fd_ip4_hdr_check( ip4 );
+  fd_memcpy( p, ip4, ihl ); p += ihl;
+
+  fd_udp_hdr_t udp[1];
+  udp->net_sport = fd_ushort_bswap( (ushort)1234 );
+  udp->net_dport = fd_ushort_bswap( (ushort)9001 );
+  udp->net_len   = fd_ushort_bswap( (ushort)(sizeof(fd_udp_hdr_t) + payload_sz) );
+  udp->check     = (ushort)0;
+  fd_memcpy( p, udp, sizeof(fd_udp_hdr_t) ); p += sizeof(fd_udp_hdr_t);
+
+  for( ulong i=0UL; i<payload_sz; i++ ) p[i] = (uchar)i;
+  p += payload_sz;
+
+  return (ulong)(p - frame);
+}
+
+/* ip4_off returns the offset of the ip4 header in frame */
+
+static inline ulong ip4_off( int vlan ) { return sizeof(fd_eth_hdr_t) + (vlan ? sizeof(fd_vlan_tag_t) : 0UL); }
+
+/* ip4_recheck recomputes the ip4 header checksum of frame in place */
+
+static void
+ip4_recheck( int vlan ) {
+  fd_ip4_hdr_t ip4[3];
+  fd_memcpy( ip4, frame + ip4_off( vlan ), 20UL );
+  ulong ihl = 4UL*(ulong)ip4->ihl;
+  fd_memcpy( ip4, frame + ip4_off( vlan ), ihl );
+  ip4->check = (ushort)0;
+  ip4->check = fd_ip4_hdr_check( ip4 );
+  fd_memcpy( frame + ip4_off( vlan ), ip4, ihl );
+}
+
+/* udp_recheck fills in the udp checksum of frame in place */
+
+static void
+udp_recheck( int   vlan,
+             ulong opt_sz ) {
+  uchar *      ip4 = frame + ip4_off( vlan );
+  uchar *      p   = ip4 + 20UL + opt_sz;
+  fd_udp_hdr_t udp[1];
+  fd_memcpy( udp, p, sizeof(fd_udp_hdr_t) );
+  udp->check = (ushort)0;
+  udp->check = fd_ip4_udp_check( fd_uint_load_4( ip4+12UL ), fd_uint_load_4( ip4+16UL ), udp, p + sizeof(fd_udp_hdr_t) );
+  fd_memcpy( p, udp, sizeof(fd_udp_hdr_t) );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  fd_net_udp_info_t info[1];
+
+  for( int vlan=0; vlan<2; vlan++ ) {
+    for( ulong opt_sz=0UL; opt_sz<=40UL; opt_sz+=20UL ) {
+      for( ulong payload_sz=0UL; payload_sz<=1472UL; payload_sz+=46UL ) {
+        ulong sz  = build_frame( vlan, opt_sz, payload_sz );
+        ulong off = ip4_off( vlan ) + 20UL + opt_sz + sizeof(fd_udp_hdr_t);
+        FD_TEST( sz==off+payload_sz );
+
+        FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_SUCCESS );
+        FD_TEST( info->payload_off==off                       );
+        FD_TEST( info->payload_sz ==payload_sz                );
+        FD_TEST( info->saddr      ==FD_IP4_ADDR( 10, 0, 0, 1 ) );
+        FD_TEST( info->daddr      ==FD_IP4_ADDR( 10, 0, 0, 2 ) );
+        FD_TEST( info->sport      ==(ushort)1234              );
+        FD_TEST( info->dport      ==(ushort)9001              );
+        FD_TEST( fd_net_udp_sig( info )==((((ulong)FD_IP4_ADDR( 10, 0, 0, 1 ))<<32) | (1234UL<<16) | 9001UL) );
+
+        /* Trailing padding is ignored */
+
+        FD_TEST( fd_net_parse_udp( frame, sz+16UL, info )==FD_NET_PARSE_SUCCESS );
+        FD_TEST( info->payload_off==off        );
+        FD_TEST( info->payload_sz ==payload_sz );
+
+        /* Every truncation is rejected */
+
+        for( ulong trunc_sz=0UL; trunc_sz<sz; trunc_sz++ )
+          FD_TEST( fd_net_parse_udp( frame, trunc_sz, info )!=FD_NET_PARSE_SUCCESS );
+      }
+    }
+  }
+
+  ulong sz = build_frame( 0, 0UL, 100UL );
+  uchar * ip4 = frame + ip4_off( 0 );
+  uchar * udp = ip4 + 20UL;
+
+  /* Bad ethertype */
+
+  frame[12] = (uchar)0x86; frame[13] = (uchar)0xdd; /* IP6 */
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_ERR_ETH );
+  sz = build_frame( 0, 0UL, 100UL );
+
+  /* Bad version, ihl, length and checksum */
+
+  ip4[0] = (uchar)0x65; ip4_recheck( 0 );
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_ERR_IP4 );
+  sz = build_frame( 0, 0UL, 100UL );
+
+  ip4[0] = (uchar)0x44;
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_ERR_IP4 );
+  sz = build_frame( 0, 0UL, 100UL );
+
+  ip4[2] = (uchar)0xff; ip4_recheck( 0 );
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_ERR_IP4 );
+  sz = build_frame( 0, 0UL, 100UL );
+
+  ip4[8] = (uchar)(ip4[8]+1); /* ttl, without fixing the checksum */
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_ERR_IP4 );
+  sz = build_frame( 0, 0UL, 100UL );
+
+  /* Fragments */
+
+  ip4[6] = (uchar)0x20; ip4[7] = (uchar)0x00; ip4_recheck( 0 ); /* MF */
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_ERR_IP4 );
+  ip4[6] = (uchar)0x00; ip4[7] = (uchar)0x10; ip4_recheck( 0 ); /* offset */
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_ERR_IP4 );
+  sz = build_frame( 0, 0UL, 100UL );
+
+  /* Not UDP */
+
+  ip4[9] = FD_IP4_HDR_PROTOCOL_TCP; ip4_recheck( 0 );
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_ERR_PROTO );
+  sz = build_frame( 0, 0UL, 100UL );
+
+  /* Bad udp length */
+
+  udp[4] = (uchar)0x00; udp[5] = (uchar)0x07; /* Smaller than the udp header */
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_ERR_UDP );
+  udp[4] = (uchar)0x00; udp[5] = (uchar)109; /* Larger than the ip4 payload */
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_ERR_UDP );
+  udp[4] = (uchar)0x00; udp[5] = (uchar)58; /* Smaller than the ip4 payload is fine */
+  FD_TEST( fd_net_parse_udp( frame, sz, info )==FD_NET_PARSE_SUCCESS );
+  FD_TEST( info->payload_sz==50UL );
+
+  /* Misaligned frames */
+
+  sz = build_frame( 1, 20UL, 333UL );
+  for( ulong align_off=1UL; align_off<8UL; align_off++ ) {
+    static uchar shifted[ 2048+8 ];
+    fd_memcpy( shifted + align_off, frame, sz );
+    FD_TEST( fd_net_parse_udp( shifted + align_off, sz, info )==FD_NET_PARSE_SUCCESS );
+    FD_TEST( info->payload_sz==333UL );
+  }
+
+  /* Batch validation with udp checksums */
+
+  do {
+    static uchar pkt_mem[ 8 ][ 2048+8 ];
+    fd_aio_pkt_info_t batch[ 8 ];
+    fd_net_udp_info_t batch_info[ 8 ];
+    int               batch_err [ 8 ];
+
+    for( ulong batch_idx=0UL; batch_idx<8UL; batch_idx++ ) {
+      int   vlan       = (int)(batch_idx & 1UL);
+      ulong opt_sz     = 20UL*((batch_idx>>1) & 1UL);
+      ulong payload_sz = 1UL + 173UL*batch_idx; /* Odd and even sizes */
+      ulong align_off  = batch_idx;
+      ulong pkt_sz     = build_frame( vlan, opt_sz, payload_sz );
+      udp_recheck( vlan, opt_sz );
+      fd_memcpy( pkt_mem[ batch_idx ] + align_off, frame, pkt_sz );
+      batch[ batch_idx ].buf    = pkt_mem[ batch_idx ] + align_off;
+      batch[ batch_idx ].buf_sz = (ushort)pkt_sz;
+    }
+
+    FD_TEST( fd_net_check_udp_batch( batch, 8UL, batch_info, batch_err )==8UL );
+    for( ulong batch_idx=0UL; batch_idx<8UL; batch_idx++ ) {
+      FD_TEST( batch_err[ batch_idx ]==FD_NET_PARSE_SUCCESS );
+      FD_TEST( batch_info[ batch_idx ].payload_sz==1UL + 173UL*batch_idx );
+    }
+
+    /* Corrupt the payload of 1, the udp checksum of 3 (and remove the
+       udp checksum of 4 which is fine), the ip4 header of 5 and
+       truncate 6 */
+
+    uchar * p;
+    p = (uchar *)batch[1].buf; p[ batch_info[1].payload_off ]++;
+    p = (uchar *)batch[3].buf; p[ batch_info[3].payload_off-1UL ]++;
+    p = (uchar *)batch[4].buf; p[ batch_info[4].payload_off-1UL ] = (uchar)0; p[ batch_info[4].payload_off-2UL ] = (uchar)0;
+    p = (uchar *)batch[5].buf; p[ ip4_off( 1 ) + 8UL ]++;
+    batch[6].buf_sz = (ushort)(batch[6].buf_sz - 1U);
+
+    FD_TEST( fd_net_check_udp_batch( batch, 8UL, NULL, batch_err )==4UL );
+    FD_TEST( batch_err[0]==FD_NET_PARSE_SUCCESS   );
+    FD_TEST( batch_err[1]==FD_NET_PARSE_ERR_CSUM  );
+    FD_TEST( batch_err[2]==FD_NET_PARSE_SUCCESS   );
+    FD_TEST( batch_err[3]==FD_NET_PARSE_ERR_CSUM  );
+    FD_TEST( batch_err[4]==FD_NET_PARSE_SUCCESS   );
+    FD_TEST( batch_err[5]==FD_NET_PARSE_ERR_IP4   );
+    FD_TEST( batch_err[6]==FD_NET_PARSE_ERR_IP4   );
+    FD_TEST( batch_err[7]==FD_NET_PARSE_SUCCESS   );
+
+    FD_TEST( !fd_net_check_udp_batch( batch, 0UL, NULL, batch_err ) );
+  } while(0);
+
+  /* Zero copy UMEM layout at every possible dcache data alignment */
+
+  FD_TEST( fd_net_zc_dcache_data_sz( ZC_FRAME_SZ, ZC_FRAME_CNT )==ZC_DATA_SZ );
+
+  for( ulong shift=0UL; shift<FD_NET_ZC_UMEM_ALIGN; shift+=FD_DCACHE_ALIGN ) {
+    uchar * dcache = fd_dcache_join( fd_dcache_new( zc_mem + shift, ZC_DATA_SZ, 0UL ) );
+    FD_TEST( dcache );
+
+    ulong   frame_cnt;
+    uchar * umem = fd_net_zc_umem( dcache, ZC_FRAME_SZ, &frame_cnt );
+    FD_TEST( umem );
+    FD_TEST( fd_ulong_is_aligned( (ulong)umem, FD_NET_ZC_UMEM_ALIGN ) );
+    FD_TEST( frame_cnt>=ZC_FRAME_CNT );
+    FD_TEST( dcache<=umem );
+    FD_TEST( umem+frame_cnt*ZC_FRAME_SZ<=dcache+ZC_DATA_SZ );
+    FD_TEST( fd_net_zc_umem( dcache, ZC_FRAME_SZ, NULL )==umem );
+
+    FD_TEST( !fd_net_zc_umem( dcache, 0UL,        &frame_cnt ) && !frame_cnt );
+    FD_TEST( !fd_net_zc_umem( dcache, ZC_DATA_SZ+1UL, &frame_cnt ) && !frame_cnt );
+
+    FD_TEST( fd_dcache_delete( fd_dcache_leave( dcache ) )==zc_mem + shift );
+  }
+
+  /* RX queue assignment */
+
+  do {
+    ulong tile_numa [ 8 ] = { 1UL, 0UL, 1UL, 0UL, 0UL, 1UL, 0UL, 0UL };
+    ulong queue_tile[ 64 ];
+
+    FD_TEST( !fd_net_queue_assign( 0UL, 4UL, tile_numa, 0UL, queue_tile ) );
+    FD_TEST( !fd_net_queue_assign( 4UL, 0UL, tile_numa, 0UL, queue_tile ) );
+    FD_TEST( !fd_net_queue_assign( 4UL, FD_TILE_MAX+1UL, tile_numa, 0UL, queue_tile ) );
+
+    /* NIC local tiles get the first (and when queues don't divide
+       evenly, the extra) queues */
+
+    FD_TEST( fd_net_queue_assign( 3UL, 6UL, tile_numa, 1UL, queue_tile )==3UL );
+    FD_TEST( queue_tile[0]==0UL ); FD_TEST( queue_tile[1]==2UL ); FD_TEST( queue_tile[2]==5UL );
+
+    FD_TEST( fd_net_queue_assign( 4UL, 6UL, tile_numa, 1UL, queue_tile )==4UL );
+    FD_TEST( queue_tile[3]==1UL );
+
+    /* Unknown NIC numa (or no tile on the NIC numa) gives plain round
+       robin */
+
+    FD_TEST( fd_net_queue_assign( 5UL, 3UL, tile_numa, ULONG_MAX, queue_tile )==3UL );
+    for( ulong q=0UL; q<5UL; q++ ) FD_TEST( queue_tile[q]==q%3UL );
+    FD_TEST( fd_net_queue_assign( 5UL, 3UL, tile_numa, 7UL, queue_tile )==3UL );
+    for( ulong q=0UL; q<5UL; q++ ) FD_TEST( queue_tile[q]==q%3UL );
+
+    /* Every queue is assigned to a valid tile and the load is balanced */
+
+    for( ulong tile_cnt=1UL; tile_cnt<=8UL; tile_cnt++ ) {
+      for( ulong queue_cnt=1UL; queue_cnt<=64UL; queue_cnt++ ) {
+        for( ulong nic_numa=0UL; nic_numa<3UL; nic_numa++ ) {
+          FD_TEST( fd_net_queue_assign( queue_cnt, tile_cnt, tile_numa, nic_numa, queue_tile )==fd_ulong_min( queue_cnt, tile_cnt ) );
+          ulong load[ 8 ] = {0};
+          for( ulong q=0UL; q<queue_cnt; q++ ) { FD_TEST( queue_tile[q]<tile_cnt ); load[ queue_tile[q] ]++; }
+          ulong load_min = ULONG_MAX; ulong load_max = 0UL;
+          for( ulong t=0UL; t<tile_cnt; t++ ) { load_min = fd_ulong_min( load_min, load[t] ); load_max = fd_ulong_max( load_max, load[t] ); }
+          FD_TEST( load_max-load_min<=1UL );
+          for( ulong t=0UL; t<tile_cnt; t++ ) /* NIC local tiles are never less loaded than remote ones */
+            for( ulong u=0UL; u<tile_cnt; u++ )
+              if( (tile_numa[t]==nic_numa) & (tile_numa[u]!=nic_numa) ) FD_TEST( load[t]>=load[u] );
+        }
+      }
+    }
+  } while(0);
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
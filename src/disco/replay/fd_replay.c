@@ -3,8 +3,6 @@
 #if FD_HAS_HOSTED && FD_HAS_X86
 
 #include "../../util/net/fd_pcap.h"
-#include <stdio.h>
-#include <errno.h>
 
 #define SCRATCH_ALLOC( a, s ) (__extension__({                    \
     ulong _scratch_alloc = fd_ulong_align_up( scratch_top, (a) ); \
@@ -31,6 +29,8 @@ int
 fd_replay_tile( fd_cnc_t *       cnc,
                 char const *     pcap_path,
                 ulong            pkt_max,
+                float            pace,
+                ulong            loop_cnt,
                 ulong            orig,
                 fd_frag_meta_t * mcache,
                 uchar *          dcache,
@@ -52,8 +52,17 @@ fd_replay_tile( fd_cnc_t *       cnc,
   ulong   cnc_diag_pcap_filt_sz;  /* Accumulates pcap payload bytes filtered between housekeeping events */
 
   /* in pcap stream state */
-  FILE *           pcap_file; /* handle of pcap file stream */
-  fd_pcap_iter_t * pcap_iter; /* iterator for the pcap file stream */
+  fd_pcap_mmap_t   pcap[1];  /* reader of the memory mapped pcap */
+  ulong            loop_rem; /* number of passes over the pcap remaining (including the current one), positive */
+  ulong            pass_cnt; /* number of packets read in the current pass */
+  ulong            pend_sz;  /* size of the packet loaded at chunk pending publication, 0 if none */
+  long             pend_ts;  /* timestamp of the pending packet */
+
+  /* pacing state */
+  double           pace_tick_per_ns; /* ticks per ns of capture time, 0 if not pacing */
+  int              pace_sync;        /* should the pace be synchronized to the next packet loaded */
+  long             pace_ts0;         /* capture timestamp the pace is synchronized to */
+  long             pace_tick0;       /* tickcount the pace is synchronized to */
 
   /* out frag stream state */
   ulong   depth;  /* ==fd_mcache_depth( mcache ), depth of the mcache / positive integer power of 2 */
@@ -111,12 +120,22 @@ fd_replay_tile( fd_cnc_t *       cnc,
 
     if( FD_UNLIKELY( !pkt_max ) ) { FD_LOG_WARNING(( "pkt_max must be positive" )); return 1; }
     if( FD_UNLIKELY( !pcap_path ) ) { FD_LOG_WARNING(( "NULL pcap path" )); return 1; }
-    FD_LOG_INFO(( "Opening pcap %s (pkt_max %lu)", pcap_path, pkt_max ));
-    pcap_file = fopen( pcap_path, "r" );
-    if( FD_UNLIKELY( !pcap_file ) ) { FD_LOG_WARNING(( "fopen failed" )); return 1; }
+    FD_LOG_INFO(( "Opening pcap %s (pkt_max %lu, loop_cnt %lu)", pcap_path, pkt_max, loop_cnt ));
+    if( FD_UNLIKELY( !fd_pcap_mmap_open( pcap, pcap_path ) ) ) { FD_LOG_WARNING(( "fd_pcap_mmap_open failed" )); return 1; }
+
+    loop_rem = loop_cnt ? loop_cnt : ULONG_MAX;
+    pass_cnt = 0UL;
+    pend_sz  = 0UL;
+    pend_ts  = 0L;
+
+    /* pacing init */
+
+    FD_LOG_INFO(( "Configuring pacing (pace %f)", (double)pace ));
+    pace_tick_per_ns = pace>0.f ? fd_tempo_tick_per_ns( NULL ) / (double)pace : 0.;
+    pace_sync        = 1;
+    pace_ts0         = 0L;
+    pace_tick0       = 0L;
 
-    pcap_iter = fd_pcap_iter_new( pcap_file );
-    if( FD_UNLIKELY( !pcap_iter ) ) { FD_LOG_WARNING(( "fd_pcap_iter_new failed" )); return 1; }
     FD_COMPILER_MFENCE();
     cnc_diag[ FD_REPLAY_CNC_DIAG_PCAP_DONE ] = 0UL; /* Clear before entering running state */
     FD_COMPILER_MFENCE();
@@ -262,35 +281,71 @@ fd_replay_tile( fd_cnc_t *       cnc,
     }
     cnc_diag_in_backp = 0UL;
 
-    /* Try to load the next packet directly into the dcache at chunk */
+    /* If there isn't a packet pending publication, try to load the next
+       packet directly into the dcache at chunk.  At the end of a pass,
+       rewind for the next one (unless the pass was empty, in which case
+       the pcap has nothing to replay). */
 
-    if( FD_UNLIKELY( cnc_diag_pcap_done ) ) {
-      FD_SPIN_PAUSE();
-      now = fd_tickcount();
-      continue;
-    }
+    if( FD_LIKELY( !pend_sz ) ) {
 
-    long  ts;
-    ulong sz = fd_pcap_iter_next( pcap_iter, fd_chunk_to_laddr( base, chunk ), pkt_max, &ts );
-    if( FD_UNLIKELY( !sz ) ) {
-      cnc_diag_pcap_done = 1UL;
-      now = fd_tickcount();
-      continue;
+      if( FD_UNLIKELY( cnc_diag_pcap_done ) ) {
+        FD_SPIN_PAUSE();
+        now = fd_tickcount();
+        continue;
+      }
+
+      long  ts;
+      ulong sz = fd_pcap_mmap_next( pcap, fd_chunk_to_laddr( base, chunk ), pkt_max, &ts );
+      if( FD_UNLIKELY( !sz ) ) {
+        loop_rem--;
+        if( FD_LIKELY( loop_rem && pass_cnt ) ) {
+          fd_pcap_mmap_rewind( pcap );
+          pass_cnt  = 0UL;
+          pace_sync = 1;
+        } else {
+          cnc_diag_pcap_done = 1UL;
+        }
+        now = fd_tickcount();
+        continue;
+      }
+      pass_cnt++;
+
+      int should_filter = 0; /* FIXME: filter logic goes here */
+
+      if( FD_UNLIKELY( should_filter ) ) {
+        cnc_diag_pcap_filt_cnt++;
+        cnc_diag_pcap_filt_sz += sz;
+        now = fd_tickcount();
+        continue;
+      }
+
+      pend_sz = sz;
+      pend_ts = ts;
+
+      if( FD_UNLIKELY( pace_sync ) ) {
+        pace_sync  = 0;
+        pace_ts0   = ts;
+        pace_tick0 = fd_tickcount();
+      }
     }
 
-    int should_filter = 0; /* FIXME: filter logic goes here */
+    /* If pacing, wait until the pending packet is due (housekeeping
+       continues in the meantime) */
 
-    if( FD_UNLIKELY( should_filter ) ) {
-      cnc_diag_pcap_filt_cnt++;
-      cnc_diag_pcap_filt_sz += sz;
-      now = fd_tickcount();
-      continue;
+    now = fd_tickcount();
+
+    if( FD_UNLIKELY( pace_tick_per_ns>0. ) ) {
+      long due = pace_tick0 + (long)( (double)(pend_ts-pace_ts0)*pace_tick_per_ns );
+      if( FD_UNLIKELY( (now-due)<0L ) ) {
+        FD_SPIN_PAUSE();
+        continue;
+      }
     }
 
-    ulong sig = (ulong)ts; /* FIXME: TEMPORARY HACK */
+    ulong sz  = pend_sz;
+    ulong sig = (ulong)pend_ts; /* FIXME: TEMPORARY HACK */
     ulong ctl = fd_frag_meta_ctl( orig, 1 /*som*/, 1 /*eom*/, 0 /*err*/ );
 
-    now = fd_tickcount();
     ulong tsorig = fd_frag_meta_ts_comp( now );
     ulong tspub  = tsorig;
     fd_mcache_publish( mcache, depth, seq, sig, chunk, sz, ctl, tsorig, tspub );
@@ -299,6 +354,7 @@ fd_replay_tile( fd_cnc_t *       cnc,
 
     chunk = fd_dcache_compact_next( chunk, sz, chunk0, wmark );
     seq   = fd_seq_inc( seq, 1UL );
+    pend_sz = 0UL;
     cr_avail--;
     cnc_diag_pcap_pub_cnt++;
     cnc_diag_pcap_pub_sz += sz;
@@ -312,8 +368,7 @@ fd_replay_tile( fd_cnc_t *       cnc,
     fd_fctl_delete( fd_fctl_leave( fctl ) );
 
     FD_LOG_INFO(( "Closing pcap" ));
-    if( FD_UNLIKELY( fclose( fd_pcap_iter_delete( pcap_iter ) ) ) )
-      FD_LOG_WARNING(( "fclose failed (%i-%s)", errno, strerror( errno ) ));
+    fd_pcap_mmap_close( pcap );
 
     FD_LOG_INFO(( "Halted replay" ));
     fd_cnc_signal( cnc, FD_CNC_SIGNAL_BOOT );
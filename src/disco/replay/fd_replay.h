@@ -23,7 +23,7 @@
    following tile specific counters:
 
      CHUNK_IDX     is the chunk idx where reply tile should start publishing payloads on boot (ignored if not valid on boot)
-     PCAP_DONE     is cleared before the tile starts processing the pcap and is set when the pcap processing is done
+     PCAP_DONE     is cleared before the tile starts processing the pcap and is set when the last pass over the pcap is done
      PCAP_PUB_CNT  is the number of pcap packets published by the replay
      PCAP_PUB_SZ   is the number of pcap packet payload bytes published by the replay
      PCAP_FILT_CNT is the number of pcap packets filtered by the replay
@@ -65,8 +65,11 @@
 
 FD_PROTOTYPES_BEGIN
 
-/* fd_replay_tile replays a packets in a pcap file as a tango fragment
-   stream from origin orig into the given mcache and dcache.  The tile
+/* fd_replay_tile replays a packets in a pcap (or pcapng) file as a
+   tango fragment stream from origin orig into the given mcache and
+   dcache.  The pcap is memory mapped (see fd_pcap_mmap_t) such that
+   each packet is copied exactly once, from the page cache straight into
+   the dcache.  The tile
    can send to out_cnt reliable consumers and an arbitrary number of
    unreliable consumers.  (While reliable consumers are simple to reason
    about, they have especially high demands on their implementation as a
@@ -110,6 +113,21 @@ FD_PROTOTYPES_BEGIN
    frags / how fast a consumer can process frags typically.  <=0
    indicates to pick a conservative default.
 
+   pace controls the rate packets are published at.  If pace is
+   positive, packets are published at pace times the rate they were
+   captured at (e.g. 1 replays at the original timestamps, 2 replays
+   twice as fast, 0.5 replays half as fast).  Otherwise, packets are
+   published as fast as flow control allows.  When pacing, the pace is
+   (re)synchronized to the first packet of each pass over the pcap and
+   packets with a timestamp earlier than their predecessors are
+   published immediately.
+
+   loop_cnt is the number of passes to make over the pcap before the
+   replay is done.  0 indicates to loop over the pcap until halted.  The
+   mapping is reused between passes.  (A loop over a pcap in the page
+   cache is typically the fastest way to generate a high rate frag
+   stream for benchmarking downstream tiles.)
+
    scratch points to tile scratch memory.  fd_replay_tile_scratch_align
    and fd_replay_tile_scratch_footprint return the required alignment
    and footprint needed for this region.  This memory region is
@@ -145,6 +163,8 @@ int
 fd_replay_tile( fd_cnc_t *       cnc,       /* Local join to the replay's command-and-control */
                 char const *     pcap_path, /* Points to first byte of cstr with the path to the pcap to use */
                 ulong            pkt_max,   /* Upper bound of a size of packet in the pcap */
+                float            pace,      /* Pace multiplier relative to the capture, <=0 means as fast as possible */
+                ulong            loop_cnt,  /* Number of passes over the pcap, 0 means loop until halted */
                 ulong            orig,      /* Origin for this pcap fragment stream, in [0,FD_FRAG_META_ORIG_MAX) */
                 fd_frag_meta_t * mcache,    /* Local join to the replay's frag stream output mcache */
                 uchar *          dcache,    /* Local join to the replay's frag stream output dcache */
@@ -14,6 +14,8 @@ main( int     argc,
   char const * _cnc       = fd_env_strip_cmdline_cstr ( &argc, &argv, "--cnc",       NULL, NULL   );
   char const * _pcap      = fd_env_strip_cmdline_cstr ( &argc, &argv, "--pcap",      NULL, NULL   );
   ulong        pkt_max    = fd_env_strip_cmdline_ulong( &argc, &argv, "--pkt-max",   NULL, 1522UL );
+  char const * _pace      = fd_env_strip_cmdline_cstr ( &argc, &argv, "--pace",      NULL, "fast" ); /* fast, orig or a multiplier */
+  ulong        loop_cnt   = fd_env_strip_cmdline_ulong( &argc, &argv, "--loop",      NULL, 1UL    ); /*   0 <> until halted */
   ulong        orig       = fd_env_strip_cmdline_ulong( &argc, &argv, "--orig",      NULL, 0UL    );
   char const * _mcache    = fd_env_strip_cmdline_cstr ( &argc, &argv, "--mcache",    NULL, NULL   );
   char const * _dcache    = fd_env_strip_cmdline_cstr ( &argc, &argv, "--dcache",    NULL, NULL   );
@@ -30,6 +32,15 @@ main( int     argc,
   if( FD_UNLIKELY( !_pcap ) ) FD_LOG_ERR(( "--pcap not specified" ));
   FD_LOG_NOTICE(( "Using --pcap %s", _pcap ));
 
+  float pace;
+  if(      !strcmp( _pace, "fast" ) ) pace = 0.f;
+  else if( !strcmp( _pace, "orig" ) ) pace = 1.f;
+  else {
+    pace = fd_cstr_to_float( _pace );
+    if( FD_UNLIKELY( !(pace>0.f) ) ) FD_LOG_ERR(( "--pace should be fast, orig or a positive multiplier" ));
+  }
+  FD_LOG_NOTICE(( "Using --pace %s, --loop %lu", _pace, loop_cnt ));
+
   if( FD_UNLIKELY( !_mcache ) ) FD_LOG_ERR(( "--mcache not specified" ));
   FD_LOG_NOTICE(( "Joining --mcache %s", _mcache ));
   fd_frag_meta_t * mcache = fd_mcache_join( fd_wksp_map( _mcache ) );
@@ -69,7 +80,7 @@ main( int     argc,
 
   FD_LOG_NOTICE(( "Run" ));
 
-  int err = fd_replay_tile( cnc, _pcap, pkt_max, orig, mcache, dcache, out_cnt, out_fseq, cr_max, lazy, rng, scratch );
+  int err = fd_replay_tile( cnc, _pcap, pkt_max, pace, loop_cnt, orig, mcache, dcache, out_cnt, out_fseq, cr_max, lazy, rng, scratch );
   if( FD_UNLIKELY( err ) ) FD_LOG_ERR(( "fd_replay_tile failed (%i)", err ));
 
   FD_LOG_NOTICE(( "Fini" ));
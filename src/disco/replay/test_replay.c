@@ -21,6 +21,8 @@ struct test_cfg {
   fd_cnc_t *       tx_cnc;
   char const *     tx_pcap;
   ulong            tx_mtu;
+  float            tx_pace;
+  ulong            tx_loop_cnt;
   ulong            tx_orig;
   fd_frag_meta_t * tx_mcache;
   uchar *          tx_dcache;
@@ -49,8 +51,8 @@ tx_tile_main( int     argc,
 
   uchar scratch[ FD_REPLAY_TILE_SCRATCH_FOOTPRINT( 1UL ) ] __attribute__((aligned( FD_REPLAY_TILE_SCRATCH_ALIGN )));
 
-  FD_TEST( !fd_replay_tile( cfg->tx_cnc, cfg->tx_pcap, cfg->tx_mtu, cfg->tx_orig, cfg->tx_mcache, cfg->tx_dcache,
-                            1UL, &cfg->rx_fseq, cfg->tx_cr_max, cfg->tx_lazy, rng, scratch ) );
+  FD_TEST( !fd_replay_tile( cfg->tx_cnc, cfg->tx_pcap, cfg->tx_mtu, cfg->tx_pace, cfg->tx_loop_cnt, cfg->tx_orig,
+                            cfg->tx_mcache, cfg->tx_dcache, 1UL, &cfg->rx_fseq, cfg->tx_cr_max, cfg->tx_lazy, rng, scratch ) );
 
   fd_rng_delete( fd_rng_leave( rng ) );
   return 0;
@@ -189,6 +191,8 @@ main( int     argc,
   ulong        numa_idx  = fd_env_strip_cmdline_ulong( &argc, &argv, "--numa-idx",  NULL, fd_shmem_numa_idx( cpu_idx ) );
   char const * tx_pcap   = fd_env_strip_cmdline_cstr ( &argc, &argv, "--tx-pcap",   NULL, NULL                         );
   ulong        tx_mtu    = fd_env_strip_cmdline_ulong( &argc, &argv, "--tx-mtu",    NULL, 1542UL                       );
+  float        tx_pace   = fd_env_strip_cmdline_float( &argc, &argv, "--tx-pace",   NULL, 0.f /* as fast as possible */ );
+  ulong        tx_loop   = fd_env_strip_cmdline_ulong( &argc, &argv, "--tx-loop",   NULL, 1UL                          );
   ulong        tx_orig   = fd_env_strip_cmdline_ulong( &argc, &argv, "--tx-orig",   NULL, 0UL                          );
   ulong        tx_depth  = fd_env_strip_cmdline_ulong( &argc, &argv, "--tx-depth",  NULL, 32768UL                      );
   ulong        tx_cr_max = fd_env_strip_cmdline_ulong( &argc, &argv, "--tx-cr-max", NULL, 0UL /* use default */        );
@@ -217,8 +221,10 @@ main( int     argc,
   FD_TEST( cfg->tx_cnc );
 
   cfg->tx_pcap = tx_pcap;
-  cfg->tx_mtu  = tx_mtu;
-  cfg->tx_orig = tx_orig;
+  cfg->tx_mtu      = tx_mtu;
+  cfg->tx_pace     = tx_pace;
+  cfg->tx_loop_cnt = tx_loop;
+  cfg->tx_orig     = tx_orig;
 
   FD_LOG_NOTICE(( "Creating tx mcache (--tx-depth %lu, app_sz 0, seq0 %lu)", tx_depth, seq0 ));
   cfg->tx_mcache = fd_mcache_join( fd_mcache_new( fd_wksp_alloc_laddr( cfg->wksp,
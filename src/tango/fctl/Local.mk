@@ -3,3 +3,4 @@ $(call add-objs,fd_fctl,fd_tango)
 $(call make-unit-test,test_fctl,test_fctl,fd_tango fd_util)
 $(call run-unit-test,test_fctl,)
 
+$(call make-unit-test,bench_fctl,bench_fctl,fd_tango fd_util)
@@ -0,0 +1,167 @@
+#include "../fd_tango.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+/* bench_fctl measures the transmitter side cost of a credit query as a
+   function of the number of reliable receivers for flat flow control
+   (one fctl rx per receiver) and hierarchical flow control (receivers
+   partitioned into a fixed number of groups, one fctl rx per group
+   aggregate, see fd_fctl_rx_agg_update).  It also reports the cost of a
+   group aggregate refresh (paid by the group's first receiver in its
+   housekeeping).  If there is more than one tile available, tile 1
+   plays the receivers (continuously advancing all receiver positions
+   and refreshing the group aggregates) such that every transmitter read
+   of a receiver line is a cross core cache line pull like it is in
+   production.  With only one tile, the receiver lines stay hot in the
+   transmitter's cache and this only measures the instruction
+   overhead. */
+
+#define RX_MAX (64UL)
+
+struct __attribute__((aligned(128))) bench_seq { /* Model fseqs: one seq per double cache line */
+  ulong seq;
+};
+
+typedef struct bench_seq bench_seq_t;
+
+static bench_seq_t   rx_seq    [ RX_MAX ];
+static bench_seq_t   agg_seq   [ RX_MAX ];
+static ulong         rx_slow   [ RX_MAX ];
+static ulong         agg_slow  [ RX_MAX ];
+static ulong const * rx_seq_laddr[ RX_MAX ];
+
+static uchar __attribute__((aligned(FD_FCTL_ALIGN))) flat_mem[ FD_FCTL_FOOTPRINT( RX_MAX ) ];
+static uchar __attribute__((aligned(FD_FCTL_ALIGN))) grp_mem [ FD_FCTL_FOOTPRINT( RX_MAX ) ];
+
+static volatile ulong grp_cfg; /* rx_cnt<<32 | grp_cnt of the configuration currently being benchmarked */
+static volatile int   rx_stop;
+
+static void
+agg_refresh( ulong grp_idx,
+             ulong rx_cnt,
+             ulong grp_cnt ) {
+  ulong rx0 = fd_fctl_rx_grp_rx0( grp_idx,     rx_cnt, grp_cnt );
+  ulong rx1 = fd_fctl_rx_grp_rx0( grp_idx+1UL, rx_cnt, grp_cnt );
+  fd_fctl_rx_agg_update( &agg_seq[ grp_idx ].seq, rx_seq_laddr + rx0, rx1-rx0 );
+}
+
+static int
+rx_tile_main( int     argc,
+              char ** argv ) {
+  (void)argc; (void)argv;
+  ulong seq = 0UL;
+  while( !rx_stop ) {
+    seq++;
+    for( ulong rx_idx=0UL; rx_idx<RX_MAX; rx_idx++ ) fd_fctl_rx_cr_return( &rx_seq[ rx_idx ].seq, seq );
+    ulong cfg     = grp_cfg;
+    ulong rx_cnt  = cfg >> 32;
+    ulong grp_cnt = cfg & 0xffffffffUL;
+    for( ulong grp_idx=0UL; grp_idx<grp_cnt; grp_idx++ ) agg_refresh( grp_idx, rx_cnt, grp_cnt );
+  }
+  return 0;
+}
+
+static double
+bench_query( fd_fctl_t const * fctl,
+             ulong             iter_cnt ) {
+  ulong dummy = 0UL;
+  long  dt    = -fd_log_wallclock();
+  for( ulong iter=0UL; iter<iter_cnt; iter++ ) {
+    ulong rx_idx_slow;
+    dummy += fd_fctl_cr_query( fctl, iter, &rx_idx_slow ) + rx_idx_slow;
+    FD_SPIN_PAUSE(); /* Give receiver time to dirty the lines again */
+  }
+  dt += fd_log_wallclock();
+  FD_COMPILER_UNPREDICTABLE( dummy );
+  return (double)dt / (double)iter_cnt;
+}
+
+static double
+bench_refresh( ulong rx_cnt,
+               ulong grp_cnt,
+               ulong iter_cnt ) {
+  long dt = -fd_log_wallclock();
+  for( ulong iter=0UL; iter<iter_cnt; iter++ ) {
+    agg_refresh( 0UL, rx_cnt, grp_cnt ); /* Group 0 is one of the largest groups */
+    FD_SPIN_PAUSE();
+  }
+  dt += fd_log_wallclock();
+  return (double)dt / (double)iter_cnt;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong rx_max   = fd_env_strip_cmdline_ulong( &argc, &argv, "--rx-max",   NULL,     RX_MAX );
+  ulong grp_max  = fd_env_strip_cmdline_ulong( &argc, &argv, "--grp-cnt",  NULL,        4UL );
+  ulong iter_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--iter-cnt", NULL,   100000UL );
+
+  if( FD_UNLIKELY( !((1UL<=rx_max ) & (rx_max <=RX_MAX)) ) ) FD_LOG_ERR(( "--rx-max should be in [1,%lu]", RX_MAX ));
+  if( FD_UNLIKELY( !((1UL<=grp_max) & (grp_max<=RX_MAX)) ) ) FD_LOG_ERR(( "--grp-cnt should be in [1,%lu]", RX_MAX ));
+  if( FD_UNLIKELY( !iter_cnt                             ) ) FD_LOG_ERR(( "--iter-cnt should be positive" ));
+
+  ulong tile_cnt = fd_tile_cnt();
+
+  FD_LOG_NOTICE(( "Benching --rx-max %lu --grp-cnt %lu --iter-cnt %lu (%s receivers)",
+                  rx_max, grp_max, iter_cnt, tile_cnt>1UL ? "remote" : "local" ));
+
+  for( ulong rx_idx=0UL; rx_idx<RX_MAX; rx_idx++ ) rx_seq_laddr[ rx_idx ] = &rx_seq[ rx_idx ].seq;
+
+  grp_cfg = (1UL<<32) | 1UL;
+
+  fd_tile_exec_t * exec = NULL;
+  if( tile_cnt>1UL ) {
+    exec = fd_tile_exec_new( 1UL, rx_tile_main, 0, NULL );
+    if( FD_UNLIKELY( !exec ) ) FD_LOG_ERR(( "fd_tile_exec_new failed" ));
+  }
+
+  FD_LOG_NOTICE(( "rx_cnt  grp_cnt  flat ns/query  grp ns/query  grp ns/refresh" ));
+
+  for( ulong rx_cnt=1UL; rx_cnt<=rx_max; rx_cnt<<=1 ) { /* Powers of 2 up to rx_max */
+    ulong grp_cnt = fd_ulong_min( grp_max, rx_cnt );
+    grp_cfg = (rx_cnt<<32) | grp_cnt;
+
+    fd_fctl_t * flat = fd_fctl_join( fd_fctl_new( flat_mem, rx_cnt ) );
+    for( ulong rx_idx=0UL; rx_idx<rx_cnt; rx_idx++ )
+      fd_fctl_cfg_rx_add( flat, (ulong)LONG_MAX, &rx_seq[ rx_idx ].seq, &rx_slow[ rx_idx ] );
+    FD_TEST( fd_fctl_cfg_done( flat, 1UL, 0UL, 0UL, 0UL ) );
+
+    fd_fctl_t * grp = fd_fctl_join( fd_fctl_new( grp_mem, grp_cnt ) );
+    for( ulong grp_idx=0UL; grp_idx<grp_cnt; grp_idx++ )
+      fd_fctl_cfg_rx_add( grp, (ulong)LONG_MAX, &agg_seq[ grp_idx ].seq, &agg_slow[ grp_idx ] );
+    FD_TEST( fd_fctl_cfg_done( grp, 1UL, 0UL, 0UL, 0UL ) );
+
+    double flat_ns    = bench_query( flat, iter_cnt );
+    double grp_ns     = bench_query( grp,  iter_cnt );
+    double refresh_ns = bench_refresh( rx_cnt, grp_cnt, iter_cnt );
+
+    FD_LOG_NOTICE(( "%6lu  %7lu  %13.1f  %12.1f  %14.1f", rx_cnt, grp_cnt, flat_ns, grp_ns, refresh_ns ));
+
+    fd_fctl_delete( fd_fctl_leave( flat ) );
+    fd_fctl_delete( fd_fctl_leave( grp  ) );
+  }
+
+  if( exec ) {
+    rx_stop = 1;
+    fd_tile_exec_delete( exec, NULL );
+  }
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
@@ -289,6 +289,109 @@ fd_fctl_rx_cr_return( ulong * _rx_seq,
   FD_COMPILER_MFENCE();
 }
 
+/* Hierarchical flow control **************************************/
+
+/* When a transmitter has many reliable receivers (e.g. dozens of verify
+   tiles behind a single producer), fd_fctl_cr_query pulls one cache
+   line per receiver from a different core every time the transmitter
+   refills.  This can dominate the transmitter's flow control cost.
+
+   To keep this cost flat as the receiver count grows, the rx_cnt
+   receivers can be partitioned into a fixed number grp_cnt of groups
+   (ideally of receivers that are topologically close to each other,
+   e.g. on the same core complex).  Each group has an aggregator
+   location (typically the seq of a dedicated fseq) that holds a lower
+   bound of the positions of all receivers in the group.  The group's
+   first receiver (see fd_fctl_rx_grp_rx0) refreshes the aggregate in
+   its housekeeping with fd_fctl_rx_agg_update right after returning its
+   own credits.  The transmitter then registers only the aggregators as
+   its receivers:
+
+     fd_fctl_cfg_rx_add( fctl, group_cr_max, agg_seq_laddr, agg_slow_laddr );
+
+   where group_cr_max is the minimum cr_max of the group's members.  The
+   transmitter reads grp_cnt lines per refill, independent of rx_cnt.
+   The cost of reading the group members moves to the refreshing
+   receivers (off the transmitter's critical path and spread over
+   grp_cnt cores).  For very large rx_cnt, the aggregators can
+   themselves be grouped the same way (an aggregate of aggregates is a
+   lower bound of all the receivers under it).
+
+   As receivers only move forward in sequence space, a stale aggregate
+   is still a valid lower bound of the group's position, so this is
+   safe (it just adds the aggregation refresh interval to the latency
+   with which the transmitter sees credits returned).  Conversely, a
+   group whose refresher has stopped will eventually backpressure the
+   transmitter.  Slow receiver diagnostics are attributed to the group
+   as a whole. */
+
+/* fd_fctl_rx_grp_idx returns the group of receiver rx_idx when rx_cnt
+   receivers are partitioned into grp_cnt groups.  fd_fctl_rx_grp_rx0
+   returns the first receiver of group grp_idx.  That is, the receivers
+   of group grp_idx are [fd_fctl_rx_grp_rx0( grp_idx ),
+   fd_fctl_rx_grp_rx0( grp_idx+1 )).  Groups are contiguous ranges of
+   receivers of nearly equal size (sizes differ by at most one) and are
+   never empty.  Assumes 0<grp_cnt<=rx_cnt, rx_idx<rx_cnt, grp_idx<=grp_cnt
+   and rx_cnt*grp_cnt does not overflow. */
+
+FD_FN_CONST static inline ulong
+fd_fctl_rx_grp_idx( ulong rx_idx,
+                    ulong rx_cnt,
+                    ulong grp_cnt ) {
+  return (rx_idx*grp_cnt) / rx_cnt;
+}
+
+FD_FN_CONST static inline ulong
+fd_fctl_rx_grp_rx0( ulong grp_idx,
+                    ulong rx_cnt,
+                    ulong grp_cnt ) {
+  return (grp_idx*rx_cnt + grp_cnt - 1UL) / grp_cnt;
+}
+
+/* fd_fctl_rx_seq_min returns the cyclic minimum of the active receiver
+   positions in sequence space given by rx_seq_laddr (indexed
+   [0,rx_cnt)).  NULL entries are treated as inactive receivers and are
+   ignored.  Returns seq_idle if there are no active receivers.  Assumes
+   the active receivers are within LONG_MAX sequence numbers of each
+   other (true of any sanely configured flow control). */
+
+static inline ulong
+fd_fctl_rx_seq_min( ulong const * const * rx_seq_laddr,
+                    ulong                 rx_cnt,
+                    ulong                 seq_idle ) {
+  int   any     = 0;
+  ulong seq_min = seq_idle;
+  for( ulong rx_idx=0UL; rx_idx<rx_cnt; rx_idx++ ) {
+    ulong const * _rx_seq = rx_seq_laddr[ rx_idx ];
+    if( FD_UNLIKELY( !_rx_seq ) ) continue; /* Skip inactive rx */
+    ulong rx_seq = FD_VOLATILE_CONST( *_rx_seq );
+    seq_min = fd_ulong_if( (!any) | fd_seq_lt( rx_seq, seq_min ), rx_seq, seq_min );
+    any     = 1;
+  }
+  return seq_min;
+}
+
+/* fd_fctl_rx_agg_update refreshes the group aggregate at agg_seq_laddr
+   to the current cyclic minimum of the positions of the group members
+   given by rx_seq_laddr (indexed [0,rx_cnt), NULL entries are ignored
+   as above).  If the group has no active members, the aggregate is left
+   unchanged.  The aggregate is only stored to if it changed such that
+   an idle group doesn't dirty the cache line the transmitter reads.
+   Returns the aggregate.  Like fd_fctl_rx_cr_return, this also serves
+   as a compiler memory fence. */
+
+static inline ulong
+fd_fctl_rx_agg_update( ulong *               agg_seq_laddr,
+                       ulong const * const * rx_seq_laddr,
+                       ulong                 rx_cnt ) {
+  FD_COMPILER_MFENCE();
+  ulong agg_seq = FD_VOLATILE_CONST( *agg_seq_laddr );
+  ulong seq_min = fd_fctl_rx_seq_min( rx_seq_laddr, rx_cnt, agg_seq );
+  if( FD_LIKELY( seq_min!=agg_seq ) ) FD_VOLATILE( *agg_seq_laddr ) = seq_min;
+  FD_COMPILER_MFENCE();
+  return seq_min;
+}
+
 /**********************************************************************/
 
 /* fd_fctl_cr_query returns a lower bound of the number of credits
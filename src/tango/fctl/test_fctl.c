@@ -102,6 +102,81 @@ main( int     argc,
   FD_TEST( fd_fctl_leave ( fctl )==shfctl );
   FD_TEST( fd_fctl_delete( fctl )==shmem  );
 
+  /* Test hierarchical flow control.  Partition RX_MAX receivers into
+     GRP_CNT groups and check that a fctl over the group aggregates
+     gives the same credits as a fctl over all the receivers. */
+
+# define GRP_CNT (8UL)
+  ulong const * grp_rx_seq[ RX_MAX ];
+  ulong         agg_seq   [ GRP_CNT ];
+  ulong         agg_slow  [ GRP_CNT ];
+  ulong         grp_rx_cnt = RX_MAX / GRP_CNT;
+
+  for( ulong rx_cnt=1UL; rx_cnt<=RX_MAX; rx_cnt++ ) {
+    for( ulong grp_cnt=1UL; grp_cnt<=rx_cnt; grp_cnt++ ) {
+      FD_TEST( fd_fctl_rx_grp_rx0( 0UL,     rx_cnt, grp_cnt )==0UL    );
+      FD_TEST( fd_fctl_rx_grp_rx0( grp_cnt, rx_cnt, grp_cnt )==rx_cnt );
+      for( ulong grp_idx=0UL; grp_idx<grp_cnt; grp_idx++ ) {
+        ulong rx0 = fd_fctl_rx_grp_rx0( grp_idx,     rx_cnt, grp_cnt );
+        ulong rx1 = fd_fctl_rx_grp_rx0( grp_idx+1UL, rx_cnt, grp_cnt );
+        FD_TEST( (rx0<rx1) & ((rx1-rx0)<=(rx_cnt+grp_cnt-1UL)/grp_cnt) ); /* Non-empty and balanced */
+        for( ulong rx_idx=rx0; rx_idx<rx1; rx_idx++ ) FD_TEST( fd_fctl_rx_grp_idx( rx_idx, rx_cnt, grp_cnt )==grp_idx );
+      }
+    }
+  }
+
+  FD_TEST( fd_fctl_rx_seq_min( NULL, 0UL, 1234UL )==1234UL ); /* no rx */
+
+  for( ulong rx_idx=0UL; rx_idx<RX_MAX; rx_idx++ ) grp_rx_seq[ rx_idx ] = NULL;
+  FD_TEST( fd_fctl_rx_seq_min( grp_rx_seq, RX_MAX, 1234UL )==1234UL ); /* no active rx */
+
+  ulong tx_seq = fd_rng_ulong( rng ); /* Test cyclic wrapping too */
+  for( ulong rx_idx=0UL; rx_idx<RX_MAX; rx_idx++ ) {
+    rx_seq    [ rx_idx ] = tx_seq - (ulong)fd_rng_uint_roll( rng, (uint)rx_cr_max );
+    grp_rx_seq[ rx_idx ] = &rx_seq[ rx_idx ];
+  }
+
+  for( ulong grp_idx=0UL; grp_idx<GRP_CNT; grp_idx++ ) {
+    ulong const * const * member = grp_rx_seq + grp_idx*grp_rx_cnt;
+    ulong seq_min = rx_seq[ grp_idx*grp_rx_cnt ];
+    for( ulong rx_idx=0UL; rx_idx<grp_rx_cnt; rx_idx++ )
+      if( fd_seq_lt( *member[ rx_idx ], seq_min ) ) seq_min = *member[ rx_idx ];
+    FD_TEST( fd_fctl_rx_seq_min( member, grp_rx_cnt, 0UL )==seq_min );
+    agg_seq[ grp_idx ] = tx_seq;
+    FD_TEST( fd_fctl_rx_agg_update( &agg_seq[ grp_idx ], member, grp_rx_cnt )==seq_min );
+    FD_TEST( agg_seq[ grp_idx ]==seq_min );
+  }
+
+  fd_fctl_t * flat = fd_fctl_join( fd_fctl_new( shmem, RX_MAX ) ); FD_TEST( flat );
+  for( ulong rx_idx=0UL; rx_idx<RX_MAX; rx_idx++ )
+    FD_TEST( fd_fctl_cfg_rx_add( flat, rx_cr_max, &rx_seq[ rx_idx ], &rx_slow[ rx_idx ] ) );
+  FD_TEST( fd_fctl_cfg_done( flat, 1UL, 0UL, 0UL, 0UL ) );
+  ulong flat_slow;
+  ulong flat_cr = fd_fctl_cr_query( flat, tx_seq, &flat_slow );
+  FD_TEST( fd_fctl_delete( fd_fctl_leave( flat ) )==shmem );
+
+  static uchar __attribute__((aligned(FD_FCTL_ALIGN))) grp_shmem[ FD_FCTL_FOOTPRINT( GRP_CNT ) ];
+  fd_fctl_t * grp = fd_fctl_join( fd_fctl_new( grp_shmem, GRP_CNT ) ); FD_TEST( grp );
+  for( ulong grp_idx=0UL; grp_idx<GRP_CNT; grp_idx++ )
+    FD_TEST( fd_fctl_cfg_rx_add( grp, rx_cr_max, &agg_seq[ grp_idx ], &agg_slow[ grp_idx ] ) );
+  FD_TEST( fd_fctl_cfg_done( grp, 1UL, 0UL, 0UL, 0UL ) );
+  ulong grp_slow;
+  ulong grp_cr = fd_fctl_cr_query( grp, tx_seq, &grp_slow );
+  FD_TEST( grp_cr==flat_cr );
+  FD_TEST( grp_slow==fd_ulong_if( flat_slow==ULONG_MAX, ULONG_MAX, flat_slow/grp_rx_cnt ) );
+
+  /* Receivers moving forward should only ever increase the aggregate */
+
+  for( ulong rx_idx=0UL; rx_idx<RX_MAX; rx_idx++ ) fd_fctl_rx_cr_return( &rx_seq[ rx_idx ], tx_seq );
+  for( ulong grp_idx=0UL; grp_idx<GRP_CNT; grp_idx++ ) {
+    ulong agg_prv = agg_seq[ grp_idx ];
+    FD_TEST( fd_fctl_rx_agg_update( &agg_seq[ grp_idx ], grp_rx_seq + grp_idx*grp_rx_cnt, grp_rx_cnt )==tx_seq );
+    FD_TEST( fd_seq_le( agg_prv, agg_seq[ grp_idx ] ) );
+  }
+  FD_TEST( fd_fctl_cr_query( grp, tx_seq, &grp_slow )==fd_fctl_cr_max( grp ) );
+  FD_TEST( fd_fctl_delete( fd_fctl_leave( grp ) )==grp_shmem );
+# undef GRP_CNT
+
   fd_rng_delete( fd_rng_leave( rng ) );
 
   FD_LOG_NOTICE(( "pass" ));
@@ -10,6 +10,9 @@
 #include "dcache/fd_dcache.h" /* Includes fd_tango_base.h */
 #include "tcache/fd_tcache.h" /* Includes fd_tango_base.h */
 #include "aio/fd_aio.h"       /* Includes fd_tango_base.h */
+#include "idle/fd_idle.h"     /* Includes fd_tango_base.h */
+#include "lhist/fd_lhist.h"   /* Includes fd_tango_base.h */
+#include "tlog/fd_tlog.h"     /* Includes fd_tango_base.h */
 
 #endif /* HEADER_fd_src_tango_fd_tango_h */
 
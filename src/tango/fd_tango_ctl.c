@@ -8,6 +8,56 @@
 
 FD_IMPORT_CSTR( fd_tango_ctl_help, "src/tango/fd_tango_ctl_help" );
 
+/* fd_tango_ctl_tlog_drain decodes the records of tlog (named name) from
+   seq up to the most recently written record into the permanent log.
+   Record tickcounts are converted into wallclocks relative to a joint
+   read of the two clocks taken before draining.  Records lost to
+   overrun are skipped.  Accumulates the number of records drained and
+   lost into *_rec_cnt and *_ovrn and returns the sequence number at
+   which to resume draining. */
+
+static ulong
+fd_tango_ctl_tlog_drain( fd_tlog_t const * tlog,
+                         char const *      name,
+                         ulong             seq,
+                         double            tick_per_ns,
+                         ulong *           _rec_cnt,
+                         ulong *           _ovrn ) {
+  long now_tick = fd_tickcount();
+  long now_wc   = fd_log_wallclock();
+
+  ulong depth   = fd_tlog_depth( tlog );
+  ulong seq_end = fd_tlog_seq( tlog );
+  ulong rec_cnt = 0UL;
+  ulong ovrn    = 0UL;
+  while( fd_seq_lt( seq, seq_end ) ) {
+    fd_tlog_rec_t rec[1];
+    int err = fd_tlog_read( tlog, seq, rec );
+    if( FD_UNLIKELY( err ) ) {
+      if( err<0 ) break; /* Should not happen, seq_end was already published */
+      /* Overrun, skip ahead to the oldest record we might still read */
+      ulong seq_new = fd_seq_dec( fd_tlog_seq( tlog ), depth );
+      if( fd_seq_lt( seq_new, fd_tlog_seq0( tlog ) ) ) seq_new = fd_tlog_seq0( tlog );
+      if( fd_seq_le( seq_new, seq ) ) seq_new = fd_seq_inc( seq, 1UL );
+      ovrn += (ulong)fd_seq_diff( seq_new, seq );
+      seq   = seq_new;
+      if( fd_seq_lt( seq_end, seq ) ) seq_end = seq;
+      continue;
+    }
+    char buf[ 512 ];
+    long ts_wc = now_wc - (long)((double)(now_tick - rec->ts) / tick_per_ns);
+    char ts_cstr[ FD_LOG_WALLCLOCK_CSTR_BUF_SZ ];
+    FD_LOG_INFO(( "%s: %lu %s: %s", name, seq, fd_log_wallclock_cstr( ts_wc, ts_cstr ),
+                  fd_tlog_rec_cstr( tlog, rec, buf, 512UL ) ));
+    rec_cnt++;
+    seq = fd_seq_inc( seq, 1UL );
+  }
+
+  *_rec_cnt += rec_cnt;
+  *_ovrn    += ovrn;
+  return seq;
+}
+
 int
 main( int     argc,
       char ** argv ) {
@@ -721,6 +771,275 @@ main( int     argc,
       FD_LOG_NOTICE(( "%i: %s %s: success", cnt, cmd, gaddr ));
       SHIFT( 1 );
 
+    } else if( !strcmp( cmd, "new-lhist" ) ) {
+
+      if( FD_UNLIKELY( argc<1 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * _wksp = argv[0];
+
+      ulong align     = fd_lhist_align();
+      ulong footprint = fd_lhist_footprint();
+
+      fd_wksp_t * wksp = fd_wksp_attach( _wksp );
+      if( FD_UNLIKELY( !wksp ) ) {
+        FD_LOG_ERR(( "%i: %s: fd_wksp_attach( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _wksp, bin ));
+      }
+
+      ulong gaddr = fd_wksp_alloc( wksp, align, footprint, tag );
+      if( FD_UNLIKELY( !gaddr ) ) {
+        fd_wksp_detach( wksp );
+        FD_LOG_ERR(( "%i: %s: fd_wksp_alloc( \"%s\", %lu, %lu, %lu ) failed\n\tDo %s help for help",
+                     cnt, cmd, _wksp, align, footprint, tag, bin ));
+      }
+
+      void * shmem = fd_wksp_laddr( wksp, gaddr );
+      if( FD_UNLIKELY( !shmem ) ) {
+        fd_wksp_free( wksp, gaddr );
+        fd_wksp_detach( wksp );
+        FD_LOG_ERR(( "%i: %s: fd_wksp_laddr( \"%s\", %lu ) failed\n\tDo %s help for help", cnt, cmd, _wksp, gaddr, bin ));
+      }
+
+      void * shlhist = fd_lhist_new( shmem );
+      if( FD_UNLIKELY( !shlhist ) ) {
+        fd_wksp_free( wksp, gaddr );
+        fd_wksp_detach( wksp );
+        FD_LOG_ERR(( "%i: %s: fd_lhist_new( %s:%lu ) failed\n\tDo %s help for help", cnt, cmd, _wksp, gaddr, bin ));
+      }
+
+      char buf[ FD_WKSP_CSTR_MAX ];
+      printf( "%s\n", fd_wksp_cstr( wksp, gaddr, buf ) );
+
+      fd_wksp_detach( wksp );
+
+      FD_LOG_NOTICE(( "%i: %s %s: success", cnt, cmd, _wksp ));
+      SHIFT( 1 );
+
+    } else if( !strcmp( cmd, "delete-lhist" ) ) {
+
+      if( FD_UNLIKELY( argc<1 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * _shlhist = argv[0];
+
+      void * shlhist = fd_wksp_map( _shlhist );
+      if( FD_UNLIKELY( !shlhist ) )
+        FD_LOG_ERR(( "%i: %s: fd_wksp_map( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shlhist, bin ));
+      if( FD_UNLIKELY( !fd_lhist_delete( shlhist ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_lhist_delete( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shlhist, bin ));
+      fd_wksp_unmap( shlhist );
+
+      fd_wksp_cstr_free( _shlhist );
+
+      FD_LOG_NOTICE(( "%i: %s %s: success", cnt, cmd, _shlhist ));
+      SHIFT( 1 );
+
+    } else if( !strcmp( cmd, "query-lhist" ) ) {
+
+      if( FD_UNLIKELY( argc<2 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * _shlhist =                 argv[0];
+      int          verbose  = fd_cstr_to_int( argv[1] );
+
+      void * shlhist = fd_wksp_map( _shlhist );
+      if( FD_UNLIKELY( !shlhist ) )
+        FD_LOG_ERR(( "%i: %s: fd_wksp_map( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shlhist, bin ));
+
+      fd_lhist_t const * lhist = fd_lhist_join( shlhist );
+      if( FD_UNLIKELY( !lhist ) )
+        FD_LOG_ERR(( "%i: %s: fd_lhist_join( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shlhist, bin ));
+
+      if( !verbose ) printf( "%lu\n", fd_lhist_cnt( lhist ) );
+      else {
+        static ulong snap[ FD_LHIST_BIN_CNT ];
+        fd_lhist_snap( lhist, snap );
+        printf( "lhist %s\n", _shlhist );
+        printf( "\tcnt  %lu\n", fd_lhist_cnt( lhist ) );
+        printf( "\tsum  %lu\n", fd_lhist_sum( lhist ) );
+        printf( "\tmax  %lu\n", fd_lhist_max( lhist ) );
+        printf( "\tp50  %lu\n", fd_lhist_quantile( snap, 0.5   ) );
+        printf( "\tp99  %lu\n", fd_lhist_quantile( snap, 0.99  ) );
+        printf( "\tp999 %lu\n", fd_lhist_quantile( snap, 0.999 ) );
+        for( ulong idx=0UL; idx<FD_LHIST_BIN_CNT; idx++ )
+          if( snap[ idx ] ) printf( "\tbin  [%lu,%lu] %lu\n", fd_lhist_bin_lo( idx ), fd_lhist_bin_hi( idx ), snap[ idx ] );
+      }
+
+      fd_wksp_unmap( fd_lhist_leave( (fd_lhist_t *)lhist ) );
+
+      FD_LOG_NOTICE(( "%i: %s %s %i: success", cnt, cmd, _shlhist, verbose ));
+      SHIFT( 2 );
+
+    } else if( !strcmp( cmd, "new-tlog" ) ) {
+
+      if( FD_UNLIKELY( argc<3 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * _wksp =                   argv[0];
+      ulong        depth = fd_cstr_to_ulong( argv[1] );
+      ulong        seq0  = fd_cstr_to_ulong( argv[2] );
+
+      ulong align     = fd_tlog_align();
+      ulong footprint = fd_tlog_footprint( depth );
+      if( FD_UNLIKELY( !footprint ) )
+        FD_LOG_ERR(( "%i: %s: depth (%lu) must a power-of-2 and at least 2\n\tDo %s help for help", cnt, cmd, depth, bin ));
+
+      fd_wksp_t * wksp = fd_wksp_attach( _wksp );
+      if( FD_UNLIKELY( !wksp ) ) {
+        FD_LOG_ERR(( "%i: %s: fd_wksp_attach( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _wksp, bin ));
+      }
+
+      ulong gaddr = fd_wksp_alloc( wksp, align, footprint, tag );
+      if( FD_UNLIKELY( !gaddr ) ) {
+        fd_wksp_detach( wksp );
+        FD_LOG_ERR(( "%i: %s: fd_wksp_alloc( \"%s\", %lu, %lu, %lu ) failed\n\tDo %s help for help",
+                     cnt, cmd, _wksp, align, footprint, tag, bin ));
+      }
+
+      void * shmem = fd_wksp_laddr( wksp, gaddr );
+      if( FD_UNLIKELY( !shmem ) ) {
+        fd_wksp_free( wksp, gaddr );
+        fd_wksp_detach( wksp );
+        FD_LOG_ERR(( "%i: %s: fd_wksp_laddr( \"%s\", %lu ) failed\n\tDo %s help for help", cnt, cmd, _wksp, gaddr, bin ));
+      }
+
+      void * shtlog = fd_tlog_new( shmem, depth, seq0 );
+      if( FD_UNLIKELY( !shtlog ) ) {
+        fd_wksp_free( wksp, gaddr );
+        fd_wksp_detach( wksp );
+        FD_LOG_ERR(( "%i: %s: fd_tlog_new( %s:%lu, %lu, %lu ) failed\n\tDo %s help for help",
+                     cnt, cmd, _wksp, gaddr, depth, seq0, bin ));
+      }
+
+      char buf[ FD_WKSP_CSTR_MAX ];
+      printf( "%s\n", fd_wksp_cstr( wksp, gaddr, buf ) );
+
+      fd_wksp_detach( wksp );
+
+      FD_LOG_NOTICE(( "%i: %s %s %lu %lu: success", cnt, cmd, _wksp, depth, seq0 ));
+      SHIFT( 3 );
+
+    } else if( !strcmp( cmd, "delete-tlog" ) ) {
+
+      if( FD_UNLIKELY( argc<1 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * _shtlog = argv[0];
+
+      void * shtlog = fd_wksp_map( _shtlog );
+      if( FD_UNLIKELY( !shtlog ) )
+        FD_LOG_ERR(( "%i: %s: fd_wksp_map( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shtlog, bin ));
+      if( FD_UNLIKELY( !fd_tlog_delete( shtlog ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_tlog_delete( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shtlog, bin ));
+      fd_wksp_unmap( shtlog );
+
+      fd_wksp_cstr_free( _shtlog );
+
+      FD_LOG_NOTICE(( "%i: %s %s: success", cnt, cmd, _shtlog ));
+      SHIFT( 1 );
+
+    } else if( !strcmp( cmd, "query-tlog" ) ) {
+
+      if( FD_UNLIKELY( argc<2 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * _shtlog =                 argv[0];
+      int          verbose = fd_cstr_to_int( argv[1] );
+
+      void * shtlog = fd_wksp_map( _shtlog );
+      if( FD_UNLIKELY( !shtlog ) )
+        FD_LOG_ERR(( "%i: %s: fd_wksp_map( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shtlog, bin ));
+
+      fd_tlog_t const * tlog = fd_tlog_join( shtlog );
+      if( FD_UNLIKELY( !tlog ) )
+        FD_LOG_ERR(( "%i: %s: fd_tlog_join( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shtlog, bin ));
+
+      if( !verbose ) printf( "%lu\n", fd_tlog_seq( tlog ) );
+      else {
+        ulong fmt_cnt = fd_tlog_fmt_cnt( tlog );
+        printf( "tlog %s\n", _shtlog );
+        printf( "\tdepth   %lu\n", fd_tlog_depth( tlog ) );
+        printf( "\tseq0    %lu\n", fd_tlog_seq0 ( tlog ) );
+        printf( "\tseq     %lu\n", fd_tlog_seq  ( tlog ) );
+        printf( "\tfmt_cnt %lu\n", fmt_cnt );
+        for( ulong id=0UL; id<fmt_cnt; id++ ) printf( "\tfmt %2lu  \"%.*s\"\n", id, (int)FD_TLOG_FMT_SZ, fd_tlog_fmt_cstr( tlog, id ) );
+      }
+
+      fd_wksp_unmap( fd_tlog_leave( (fd_tlog_t *)tlog ) );
+
+      FD_LOG_NOTICE(( "%i: %s %s %i: success", cnt, cmd, _shtlog, verbose ));
+      SHIFT( 2 );
+
+    } else if( !strcmp( cmd, "drain-tlog" ) ) {
+
+      if( FD_UNLIKELY( argc<2 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * _shtlog =                   argv[0];
+      ulong        seq     = fd_cstr_to_ulong( argv[1] );
+
+      void * shtlog = fd_wksp_map( _shtlog );
+      if( FD_UNLIKELY( !shtlog ) )
+        FD_LOG_ERR(( "%i: %s: fd_wksp_map( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shtlog, bin ));
+
+      fd_tlog_t const * tlog = fd_tlog_join( shtlog );
+      if( FD_UNLIKELY( !tlog ) )
+        FD_LOG_ERR(( "%i: %s: fd_tlog_join( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shtlog, bin ));
+
+      ulong rec_cnt = 0UL;
+      ulong ovrn    = 0UL;
+      seq = fd_tango_ctl_tlog_drain( tlog, _shtlog, seq, fd_tempo_tick_per_ns( NULL ), &rec_cnt, &ovrn );
+
+      if( FD_UNLIKELY( ovrn ) ) FD_LOG_WARNING(( "%i: %s %s: overrun, %lu records lost", cnt, cmd, _shtlog, ovrn ));
+
+      printf( "%lu\n", seq );
+
+      fd_wksp_unmap( fd_tlog_leave( (fd_tlog_t *)tlog ) );
+
+      FD_LOG_NOTICE(( "%i: %s %s %s: success (%lu records)", cnt, cmd, _shtlog, argv[1], rec_cnt ));
+      SHIFT( 2 );
+
+    } else if( !strcmp( cmd, "monitor-tlog" ) ) {
+
+      if( FD_UNLIKELY( argc<4 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * _shtlog  =                   argv[0];
+      ulong        seq      = fd_cstr_to_ulong( argv[1] );
+      long         dt       = fd_cstr_to_long ( argv[2] );
+      long         duration = fd_cstr_to_long ( argv[3] );
+
+      if( FD_UNLIKELY( dt<=0L ) ) FD_LOG_ERR(( "%i: %s: dt should be positive\n\tDo %s help for help", cnt, cmd, bin ));
+
+      void * shtlog = fd_wksp_map( _shtlog );
+      if( FD_UNLIKELY( !shtlog ) )
+        FD_LOG_ERR(( "%i: %s: fd_wksp_map( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shtlog, bin ));
+
+      fd_tlog_t const * tlog = fd_tlog_join( shtlog );
+      if( FD_UNLIKELY( !tlog ) )
+        FD_LOG_ERR(( "%i: %s: fd_tlog_join( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, _shtlog, bin ));
+
+      /* Drain every dt ns until duration ns have elapsed (a negative
+         duration monitors forever).  Each pass does a fresh joint read
+         of the tickcount and wallclock such that timestamp conversion
+         does not drift over a long monitoring session.  The final pass
+         happens after duration elapsed such that nothing written during
+         the session is missed. */
+
+      double tick_per_ns = fd_tempo_tick_per_ns( NULL );
+      ulong  rec_cnt     = 0UL;
+      ulong  ovrn        = 0UL;
+      long   stop        = fd_log_wallclock() + duration;
+      for(;;) {
+        ulong ovrn_prev = ovrn;
+        seq = fd_tango_ctl_tlog_drain( tlog, _shtlog, seq, tick_per_ns, &rec_cnt, &ovrn );
+        if( FD_UNLIKELY( ovrn!=ovrn_prev ) )
+          FD_LOG_WARNING(( "%i: %s %s: overrun, %lu records lost", cnt, cmd, _shtlog, ovrn-ovrn_prev ));
+        long now = fd_log_wallclock();
+        if( FD_UNLIKELY( (duration>=0L) & (now>=stop) ) ) break;
+        fd_log_sleep( (duration>=0L) ? fd_long_min( dt, stop-now ) : dt );
+      }
+
+      printf( "%lu\n", seq );
+
+      fd_wksp_unmap( fd_tlog_leave( (fd_tlog_t *)tlog ) );
+
+      FD_LOG_NOTICE(( "%i: %s %s %s %li %li: success (%lu records, %lu lost)", cnt, cmd, _shtlog, argv[1], dt, duration,
+                      rec_cnt, ovrn ));
+      SHIFT( 4 );
+
     } else {
 
       FD_LOG_ERR(( "%i: %s: unknown command\n\t"
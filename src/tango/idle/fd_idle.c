@@ -0,0 +1,221 @@
+#include "fd_idle.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+#include "../tempo/fd_tempo.h"
+#include <cpuid.h>
+
+/* FD_IDLE_WAIT_DT_NS is the maximum duration in ns of a single UMWAIT.
+   This bounds the wake-up latency of the wait tier if the watched line
+   is not written (e.g. the run loop is polling multiple inputs or needs
+   to do housekeeping).  Note that the operating system can further
+   limit this (e.g. /sys/devices/system/cpu/umwait_control/max_time on
+   Linux). */
+
+#define FD_IDLE_WAIT_DT_NS (20000L) /* 20 us */
+
+/* FD_IDLE_UMWAIT_CTL specifies the UMWAIT control.  0 requests the
+   deeper C0.2 state (the operating system might demote this to C0.1). */
+
+#define FD_IDLE_UMWAIT_CTL (0U)
+
+int
+fd_idle_has_waitpkg( void ) {
+  uint eax, ebx, ecx, edx;
+  if( FD_UNLIKELY( !__get_cpuid_count( 7U, 0U, &eax, &ebx, &ecx, &edx ) ) ) return 0;
+  return (int)((ecx>>5) & 1U); /* CPUID.(EAX=07H,ECX=0H):ECX.WAITPKG[bit 5] */
+}
+
+static long
+fd_idle_private_ns_to_ticks( long  ns,
+                             float tick_per_ns ) {
+  if( ns==LONG_MAX ) return LONG_MAX;
+  float ticks = ((float)ns)*tick_per_ns;
+  if( FD_UNLIKELY( ticks>=(float)LONG_MAX ) ) return LONG_MAX;
+  return (long)ticks;
+}
+
+void *
+fd_idle_new( void * shmem,
+             long   spin_ns,
+             long   wait_ns,
+             long   sleep_ns ) {
+
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, fd_idle_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  if( spin_ns <0L ) spin_ns  = FD_IDLE_SPIN_NS_DEFAULT;
+  if( wait_ns <0L ) wait_ns  = FD_IDLE_WAIT_NS_DEFAULT;
+  if( sleep_ns<0L ) sleep_ns = FD_IDLE_SLEEP_NS_DEFAULT;
+
+  if( FD_UNLIKELY( wait_ns<spin_ns ) ) {
+    FD_LOG_WARNING(( "wait_ns (%li) must be at least spin_ns (%li)", wait_ns, spin_ns ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !sleep_ns ) ) {
+    FD_LOG_WARNING(( "zero sleep_ns" ));
+    return NULL;
+  }
+
+  float tick_per_ns = (float)fd_tempo_tick_per_ns( NULL );
+
+  fd_idle_t * idle = (fd_idle_t *)shmem;
+
+  memset( idle, 0, sizeof(fd_idle_t) );
+
+  idle->spin_max    = fd_idle_private_ns_to_ticks( spin_ns, tick_per_ns );
+  idle->wait_max    = fd_long_max( fd_idle_private_ns_to_ticks( wait_ns, tick_per_ns ), idle->spin_max );
+  idle->wait_dt     = fd_long_max( fd_idle_private_ns_to_ticks( FD_IDLE_WAIT_DT_NS, tick_per_ns ), 1L );
+  idle->sleep_ns    = sleep_ns;
+  idle->has_waitpkg = fd_idle_has_waitpkg();
+  idle->tier        = -1;
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( idle->magic ) = FD_IDLE_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return shmem;
+}
+
+fd_idle_t *
+fd_idle_join( void * shidle ) {
+
+  if( FD_UNLIKELY( !shidle ) ) {
+    FD_LOG_WARNING(( "NULL shidle" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shidle, fd_idle_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shidle" ));
+    return NULL;
+  }
+
+  fd_idle_t * idle = (fd_idle_t *)shidle;
+
+  if( FD_UNLIKELY( idle->magic!=FD_IDLE_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  return idle;
+}
+
+void *
+fd_idle_leave( fd_idle_t * idle ) {
+
+  if( FD_UNLIKELY( !idle ) ) {
+    FD_LOG_WARNING(( "NULL idle" ));
+    return NULL;
+  }
+
+  return (void *)idle;
+}
+
+void *
+fd_idle_delete( void * shidle ) {
+
+  if( FD_UNLIKELY( !shidle ) ) {
+    FD_LOG_WARNING(( "NULL shidle" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shidle, fd_idle_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shidle" ));
+    return NULL;
+  }
+
+  fd_idle_t * idle = (fd_idle_t *)shidle;
+
+  if( FD_UNLIKELY( idle->magic!=FD_IDLE_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( idle->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return shidle;
+}
+
+/* fd_idle_private_umwait arms the monitor on the cache line containing
+   watch and, if *watch still holds seen, waits until that line is
+   written or the tickcounter reaches deadline, whichever comes first.
+   Rereading watch after arming closes the race where the line is
+   written between when the caller observed seen and when the monitor
+   was armed (such a write would not wake the UMWAIT and the caller
+   would stall until the deadline).  This is only called if the host
+   was detected to have WAITPKG support.  (The UMWAIT deadline is in the
+   same units as fd_tickcount.) */
+
+__attribute__((target("waitpkg"))) static void
+fd_idle_private_umwait( ulong const * watch,
+                        ulong         seen,
+                        long          deadline ) {
+  _umonitor( (void *)watch );
+  if( FD_UNLIKELY( FD_VOLATILE_CONST( *watch )!=seen ) ) return;
+  _umwait( FD_IDLE_UMWAIT_CTL, (ulong)deadline );
+}
+
+long
+fd_idle_wait( fd_idle_t *   idle,
+              ulong const * watch,
+              ulong         seen,
+              long          now ) {
+
+  if( FD_UNLIKELY( idle->tier<0 ) ) idle->idle_then = now; /* Start a new idle episode */
+
+  long idle_dt = now - idle->idle_then;
+  int  tier    = fd_int_if( idle_dt<idle->spin_max, FD_IDLE_TIER_SPIN,
+                 fd_int_if( idle_dt<idle->wait_max, FD_IDLE_TIER_WAIT, FD_IDLE_TIER_SLEEP ) );
+
+  idle->tier      = tier;
+  idle->wait_then = fd_tickcount(); /* now might be stale (or synthetic), measure from when the primitive starts */
+
+  switch( tier ) {
+  case FD_IDLE_TIER_SPIN:
+    FD_SPIN_PAUSE();
+    break;
+  case FD_IDLE_TIER_WAIT:
+    if( FD_LIKELY( idle->has_waitpkg ) ) fd_idle_private_umwait( watch, seen, fd_tickcount() + idle->wait_dt );
+    else                                 FD_SPIN_PAUSE();
+    break;
+  default: /* FD_IDLE_TIER_SLEEP */
+    if( FD_LIKELY( FD_VOLATILE_CONST( *watch )==seen ) ) fd_log_sleep( idle->sleep_ns );
+    break;
+  }
+
+  return fd_tickcount();
+}
+
+long
+fd_idle_wake_quantile( fd_idle_t const * idle,
+                       int               tier,
+                       float             q ) {
+  ulong const * hist = fd_idle_wake_hist( idle, tier );
+
+  ulong cnt = 0UL;
+  for( ulong bin=0UL; bin<FD_IDLE_HIST_BIN_CNT; bin++ ) cnt += hist[ bin ];
+  if( FD_UNLIKELY( !cnt ) ) return 0L;
+
+  q = fd_float_if( q<0.f, 0.f, fd_float_if( q>1.f, 1.f, q ) );
+  ulong rank = fd_ulong_min( (ulong)(q*(float)cnt), cnt-1UL ); /* In [0,cnt) */
+
+  ulong sum = 0UL;
+  ulong bin = 0UL;
+  for( ; bin<FD_IDLE_HIST_BIN_CNT-1UL; bin++ ) {
+    sum += hist[ bin ];
+    if( sum>rank ) break;
+  }
+  return (long)fd_ulong_if( bin<63UL, (2UL<<bin)-1UL, (ulong)LONG_MAX );
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include "../fd_tango.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+FD_STATIC_ASSERT( FD_IDLE_TIER_SPIN ==0, unit_test );
+FD_STATIC_ASSERT( FD_IDLE_TIER_WAIT ==1, unit_test );
+FD_STATIC_ASSERT( FD_IDLE_TIER_SLEEP==2, unit_test );
+FD_STATIC_ASSERT( FD_IDLE_TIER_CNT  ==3, unit_test );
+
+FD_STATIC_ASSERT( FD_IDLE_ALIGN    ==128UL,             unit_test );
+FD_STATIC_ASSERT( FD_IDLE_FOOTPRINT==sizeof(fd_idle_t), unit_test );
+
+static uchar shmem[ FD_IDLE_FOOTPRINT ] __attribute__((aligned(FD_IDLE_ALIGN)));
+static ulong line [ 8 ]                 __attribute__((aligned(64)));
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  long spin_ns  = fd_env_strip_cmdline_long( &argc, &argv, "--spin-ns",  NULL,  10000L );
+  long wait_ns  = fd_env_strip_cmdline_long( &argc, &argv, "--wait-ns",  NULL, 100000L );
+  long sleep_ns = fd_env_strip_cmdline_long( &argc, &argv, "--sleep-ns", NULL,   1000L );
+
+  FD_LOG_NOTICE(( "Testing with --spin-ns %li --wait-ns %li --sleep-ns %li (waitpkg %i)",
+                  spin_ns, wait_ns, sleep_ns, fd_idle_has_waitpkg() ));
+
+  FD_TEST( fd_idle_align    ()==FD_IDLE_ALIGN     );
+  FD_TEST( fd_idle_footprint()==FD_IDLE_FOOTPRINT );
+
+  /* Test failure cases of fd_idle_new */
+  FD_TEST( fd_idle_new( NULL,    spin_ns, wait_ns,   sleep_ns )==NULL ); /* null shmem       */
+  FD_TEST( fd_idle_new( shmem+1, spin_ns, wait_ns,   sleep_ns )==NULL ); /* misaligned shmem */
+  FD_TEST( fd_idle_new( shmem,   spin_ns, spin_ns-1, sleep_ns )==NULL ); /* wait<spin        */
+  FD_TEST( fd_idle_new( shmem,   spin_ns, wait_ns,   0L       )==NULL ); /* zero sleep       */
+
+  /* Test defaults */
+  void *      shidle = fd_idle_new ( shmem, -1L, -1L, -1L ); FD_TEST( shidle );
+  fd_idle_t * idle   = fd_idle_join( shidle );               FD_TEST( idle   );
+  FD_TEST( fd_idle_wait_max( idle )==LONG_MAX                 );
+  FD_TEST( fd_idle_sleep_ns( idle )==FD_IDLE_SLEEP_NS_DEFAULT );
+  FD_TEST( fd_idle_delete( fd_idle_leave( idle ) )==shmem );
+
+  shidle = fd_idle_new ( shmem, spin_ns, wait_ns, sleep_ns ); FD_TEST( shidle );
+  idle   = fd_idle_join( shidle );                            FD_TEST( idle   );
+
+  /* Test failure cases of fd_idle_join */
+  FD_TEST( fd_idle_join( NULL          )==NULL ); /* null shidle       */
+  FD_TEST( fd_idle_join( (void *)0x1UL )==NULL ); /* misaligned shidle */
+
+  /* Test bad magic value */
+  ulong * shidle_magic = (ulong *)shidle;
+  (*shidle_magic)++;
+  FD_TEST( fd_idle_join( shidle )==NULL );
+  (*shidle_magic)--;
+
+  long spin_max = fd_idle_spin_max( idle );
+  long wait_max = fd_idle_wait_max( idle );
+  FD_TEST( 0L<=spin_max && spin_max<=wait_max );
+  FD_TEST( fd_idle_sleep_ns( idle )==sleep_ns );
+  FD_TEST( fd_idle_waitpkg ( idle )==fd_idle_has_waitpkg() );
+  FD_TEST( !fd_idle_in_episode( idle ) );
+
+  for( int tier=0; tier<FD_IDLE_TIER_CNT; tier++ ) {
+    FD_TEST( !fd_idle_episode_cnt  ( idle, tier      ) );
+    FD_TEST( !fd_idle_wake_quantile( idle, tier, 0.5f ) );
+    ulong const * hist = fd_idle_wake_hist( idle, tier );
+    for( ulong bin=0UL; bin<FD_IDLE_HIST_BIN_CNT; bin++ ) FD_TEST( !hist[ bin ] );
+  }
+
+  /* Busy when not idle is a no-op */
+
+  fd_idle_busy( idle, fd_tickcount() );
+  for( int tier=0; tier<FD_IDLE_TIER_CNT; tier++ ) FD_TEST( !fd_idle_episode_cnt( idle, tier ) );
+
+  /* Test tier escalation.  We drive the escalation with synthetic
+     values for now relative to the start of the episode. */
+
+  ulong ep_cnt[ FD_IDLE_TIER_CNT ] = { 0UL, 0UL, 0UL };
+  for( ulong iter=0UL; iter<100UL; iter++ ) {
+    int   exp_tier = (int)(iter % (ulong)FD_IDLE_TIER_CNT);
+    long  t0       = fd_tickcount();
+    long  now      = fd_idle_wait( idle, line, line[0], t0 ); /* Episode start is always in spin tier */
+    FD_TEST( fd_idle_in_episode( idle ) );
+    FD_TEST( now-t0>=0L );
+    if( exp_tier>=FD_IDLE_TIER_WAIT  ) now = fd_idle_wait( idle, line, line[0], t0 + spin_max );
+    if( exp_tier>=FD_IDLE_TIER_SLEEP ) now = fd_idle_wait( idle, line, line[0], t0 + wait_max );
+    FD_TEST( idle->tier==exp_tier );
+    fd_idle_busy( idle, now );
+    FD_TEST( !fd_idle_in_episode( idle ) );
+    ep_cnt[ exp_tier ]++;
+    for( int tier=0; tier<FD_IDLE_TIER_CNT; tier++ ) FD_TEST( fd_idle_episode_cnt( idle, tier )==ep_cnt[ tier ] );
+  }
+
+  /* Test histogram accounting and quantiles */
+
+  for( int tier=0; tier<FD_IDLE_TIER_CNT; tier++ ) {
+    ulong const * hist = fd_idle_wake_hist( idle, tier );
+    ulong cnt = 0UL;
+    for( ulong bin=0UL; bin<FD_IDLE_HIST_BIN_CNT; bin++ ) cnt += hist[ bin ];
+    FD_TEST( cnt==ep_cnt[ tier ] );
+    long p50 = fd_idle_wake_quantile( idle, tier, 0.50f );
+    long p99 = fd_idle_wake_quantile( idle, tier, 0.99f );
+    FD_TEST( 0L<p50 && p50<=p99 );
+    FD_LOG_NOTICE(( "tier %i: episodes %lu, wake p50 <= %li ticks, p99 <= %li ticks", tier, cnt, p50, p99 ));
+  }
+
+  /* A sleep tier wake must take at least sleep_ns */
+
+  long now = fd_idle_wait( idle, line, line[0], fd_tickcount() );
+  long t0  = fd_log_wallclock();
+  fd_idle_wait( idle, line, line[0], now + wait_max );
+  FD_TEST( fd_log_wallclock()-t0>=sleep_ns );
+  fd_idle_busy( idle, fd_tickcount() );
+
+  FD_TEST( fd_idle_leave( NULL )==NULL   ); /* null idle */
+  FD_TEST( fd_idle_leave( idle )==shidle ); /* ok */
+
+  FD_TEST( fd_idle_delete( NULL               )==NULL ); /* null shidle       */
+  FD_TEST( fd_idle_delete( (char *)shidle+1UL )==NULL ); /* misaligned shidle */
+
+  /* Test bad magic value */
+  (*shidle_magic)++;
+  FD_TEST( fd_idle_delete( shidle )==NULL );
+  (*shidle_magic)--;
+
+  FD_TEST( fd_idle_delete( shidle )==shmem );
+
+  /* Blocking tiers must not block if the watched location no longer
+     holds the value the caller saw (e.g. a frag was published between
+     the caller's poll and the idle primitive).  Use a long sleep so a
+     missed recheck is obvious. */
+
+  idle = fd_idle_join( fd_idle_new( shmem, 0L, 0L, (long)1e9 ) ); FD_TEST( idle ); /* every wait is in the sleep tier */
+  t0  = fd_log_wallclock();
+  fd_idle_wait( idle, line, line[0]-1UL, fd_tickcount() );
+  FD_TEST( idle->tier==FD_IDLE_TIER_SLEEP );
+  FD_TEST( fd_log_wallclock()-t0<(long)1e8 );
+  fd_idle_busy( idle, fd_tickcount() );
+  FD_TEST( fd_idle_delete( fd_idle_leave( idle ) )==shmem );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
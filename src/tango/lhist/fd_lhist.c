@@ -0,0 +1,133 @@
+#include "fd_lhist.h"
+
+void *
+fd_lhist_new( void * shmem ) {
+
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, fd_lhist_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  fd_lhist_t * lhist = (fd_lhist_t *)shmem;
+
+  memset( lhist, 0, sizeof(fd_lhist_t) );
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( lhist->magic ) = FD_LHIST_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return shmem;
+}
+
+fd_lhist_t *
+fd_lhist_join( void * shlhist ) {
+
+  if( FD_UNLIKELY( !shlhist ) ) {
+    FD_LOG_WARNING(( "NULL shlhist" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shlhist, fd_lhist_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shlhist" ));
+    return NULL;
+  }
+
+  fd_lhist_t * lhist = (fd_lhist_t *)shlhist;
+
+  if( FD_UNLIKELY( lhist->magic!=FD_LHIST_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  return lhist;
+}
+
+void *
+fd_lhist_leave( fd_lhist_t * lhist ) {
+
+  if( FD_UNLIKELY( !lhist ) ) {
+    FD_LOG_WARNING(( "NULL lhist" ));
+    return NULL;
+  }
+
+  return (void *)lhist;
+}
+
+void *
+fd_lhist_delete( void * shlhist ) {
+
+  if( FD_UNLIKELY( !shlhist ) ) {
+    FD_LOG_WARNING(( "NULL shlhist" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shlhist, fd_lhist_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shlhist" ));
+    return NULL;
+  }
+
+  fd_lhist_t * lhist = (fd_lhist_t *)shlhist;
+
+  if( FD_UNLIKELY( lhist->magic!=FD_LHIST_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( lhist->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return shlhist;
+}
+
+ulong
+fd_lhist_snap( fd_lhist_t const * lhist,
+               ulong *            snap ) {
+  ulong const * bin = lhist->bin;
+  ulong cnt = 0UL;
+  FD_COMPILER_MFENCE();
+  for( ulong idx=0UL; idx<FD_LHIST_BIN_CNT; idx++ ) {
+    ulong c = FD_VOLATILE_CONST( bin[ idx ] );
+    snap[ idx ] = c;
+    cnt += c;
+  }
+  FD_COMPILER_MFENCE();
+  return cnt;
+}
+
+ulong
+fd_lhist_snap_sub( ulong *       delta,
+                   ulong const * cur,
+                   ulong const * prv ) {
+  ulong cnt = 0UL;
+  for( ulong idx=0UL; idx<FD_LHIST_BIN_CNT; idx++ ) {
+    ulong d = cur[ idx ] - prv[ idx ];
+    delta[ idx ] = d;
+    cnt += d;
+  }
+  return cnt;
+}
+
+ulong
+fd_lhist_quantile( ulong const * snap,
+                   double        q ) {
+
+  ulong cnt = 0UL;
+  for( ulong idx=0UL; idx<FD_LHIST_BIN_CNT; idx++ ) cnt += snap[ idx ];
+  if( FD_UNLIKELY( !cnt ) ) return 0UL;
+
+  ulong rank = (q<=0.) ? 0UL : (q>=1.) ? (cnt-1UL) : fd_ulong_min( (ulong)(q*(double)cnt), cnt-1UL ); /* In [0,cnt) */
+
+  ulong sum = 0UL;
+  ulong idx = 0UL;
+  for( ; idx<FD_LHIST_BIN_CNT-1UL; idx++ ) {
+    sum += snap[ idx ];
+    if( sum>rank ) break;
+  }
+  return fd_lhist_bin_hi( idx );
+}
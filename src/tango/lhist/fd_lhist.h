@@ -0,0 +1,173 @@
+#ifndef HEADER_fd_src_tango_lhist_fd_lhist_h
+#define HEADER_fd_src_tango_lhist_fd_lhist_h
+
+/* fd_lhist provides a log-linear histogram (HDR histogram style) for
+   accumulating distributions of non-negative integer samples with a
+   wide dynamic range (e.g. per frag latencies in ticks).  The sample
+   range [0,2^64) is split into octaves and each octave is split
+   linearly into FD_LHIST_SUB_CNT bins.  Samples less than
+   FD_LHIST_SUB_CNT are counted exactly.  Larger samples are counted in
+   a bin whose width is at most 1/FD_LHIST_SUB_CNT of its lower edge
+   (i.e. quantiles derived from the histogram have a relative error of
+   at most ~6%).
+
+   A lhist is designed to live in a shared memory region (e.g. a wksp)
+   with exactly one writer (typically the consumer tile of a link) and
+   an arbitrary number of concurrent readers (typically monitors).  The
+   writer never blocks and does no atomic operations.  Readers take
+   snapshots of the bin counts.  As bins are updated individually, a
+   snapshot might not correspond exactly to the histogram at any single
+   point in time, but each bin count is monotonically non-decreasing
+   and thus the difference of two snapshots gives a (slightly fuzzy)
+   histogram of the samples taken between those snapshots.  This is
+   more than adequate for diagnostics and lets monitors show interval
+   quantiles without the writer ever needing to reset. */
+
+#include "../fd_tango_base.h"
+
+/* FD_LHIST_SUB_LG_CNT / FD_LHIST_SUB_CNT give the number of linear bins
+   per octave. */
+
+#define FD_LHIST_SUB_LG_CNT (4)
+#define FD_LHIST_SUB_CNT    (16UL)
+
+/* FD_LHIST_BIN_CNT is the number of bins in a lhist.  Bins [0,SUB_CNT)
+   count samples exactly.  The remaining bins cover the octaves
+   [2^SUB_LG_CNT,2^64) with SUB_CNT bins each. */
+
+#define FD_LHIST_BIN_CNT ((65UL-(ulong)FD_LHIST_SUB_LG_CNT)*FD_LHIST_SUB_CNT)
+
+/* FD_LHIST_{ALIGN,FOOTPRINT} specify the alignment and footprint needed
+   for a lhist.  ALIGN is double cache line to mitigate various kinds of
+   false sharing. */
+
+#define FD_LHIST_ALIGN     (128UL)
+#define FD_LHIST_FOOTPRINT (sizeof(fd_lhist_t))
+
+/* fd_lhist_t is an opaque handle of a lhist.  Details are exposed here
+   to facilitate inlining the writer path. */
+
+#define FD_LHIST_MAGIC (0xf17eda2c371157a0UL) /* firedancer lhist ver 0 */
+
+struct __attribute__((aligned(FD_LHIST_ALIGN))) fd_lhist_private {
+  ulong magic; /* == FD_LHIST_MAGIC */
+  ulong cnt;   /* Number of samples recorded */
+  ulong sum;   /* Sum of samples recorded (modulo 2^64) */
+  ulong max;   /* Largest sample recorded (0 if no samples) */
+  ulong bin[ FD_LHIST_BIN_CNT ] __attribute__((aligned(FD_LHIST_ALIGN)));
+};
+
+typedef struct fd_lhist_private fd_lhist_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_lhist_{align,footprint} return the required alignment and
+   footprint of a memory region suitable for use as a lhist. */
+
+FD_FN_CONST static inline ulong fd_lhist_align    ( void ) { return FD_LHIST_ALIGN;     }
+FD_FN_CONST static inline ulong fd_lhist_footprint( void ) { return FD_LHIST_FOOTPRINT; }
+
+/* fd_lhist_new formats an unused memory region for use as a lhist.
+   The lhist will initially have no samples.  Returns shmem on success
+   and NULL on failure (logs details).
+
+   fd_lhist_join joins the caller to a lhist.  fd_lhist_leave leaves a
+   current local join.  fd_lhist_delete unformats a memory region used
+   as a lhist.  These follow the usual conventions. */
+
+void *
+fd_lhist_new( void * shmem );
+
+fd_lhist_t *
+fd_lhist_join( void * shlhist );
+
+void *
+fd_lhist_leave( fd_lhist_t * lhist );
+
+void *
+fd_lhist_delete( void * shlhist );
+
+/* fd_lhist_bin_idx returns the index of the bin that counts sample x.
+   Result will be in [0,FD_LHIST_BIN_CNT).
+
+   fd_lhist_bin_{lo,hi} return the smallest / largest sample counted by
+   the bin idx.  idx is assumed to be in [0,FD_LHIST_BIN_CNT). */
+
+FD_FN_CONST static inline ulong
+fd_lhist_bin_idx( ulong x ) {
+  if( x<FD_LHIST_SUB_CNT ) return x;
+  int   msb   = fd_ulong_find_msb( x ); /* In [SUB_LG_CNT,63] */
+  int   shift = msb - FD_LHIST_SUB_LG_CNT;
+  return ((ulong)(shift+1) << FD_LHIST_SUB_LG_CNT) | ((x>>shift) & (FD_LHIST_SUB_CNT-1UL));
+}
+
+FD_FN_CONST static inline ulong
+fd_lhist_bin_lo( ulong idx ) {
+  if( idx<FD_LHIST_SUB_CNT ) return idx;
+  int   shift = (int)(idx >> FD_LHIST_SUB_LG_CNT) - 1;
+  return (FD_LHIST_SUB_CNT | (idx & (FD_LHIST_SUB_CNT-1UL))) << shift;
+}
+
+FD_FN_CONST static inline ulong
+fd_lhist_bin_hi( ulong idx ) {
+  if( idx<FD_LHIST_SUB_CNT ) return idx;
+  int   shift = (int)(idx >> FD_LHIST_SUB_LG_CNT) - 1;
+  return fd_lhist_bin_lo( idx ) + ((1UL<<shift)-1UL);
+}
+
+/* fd_lhist_sample records the sample x into the lhist.  Only the
+   lhist's single writer should call this.  This is O(1) and touches
+   two cache lines (the header and the sample's bin). */
+
+static inline void
+fd_lhist_sample( fd_lhist_t * lhist,
+                 ulong        x ) {
+  ulong idx = fd_lhist_bin_idx( x );
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( lhist->bin[ idx ] ) = lhist->bin[ idx ] + 1UL;
+  FD_VOLATILE( lhist->cnt        ) = lhist->cnt + 1UL;
+  FD_VOLATILE( lhist->sum        ) = lhist->sum + x;
+  FD_VOLATILE( lhist->max        ) = fd_ulong_max( lhist->max, x );
+  FD_COMPILER_MFENCE();
+}
+
+/* Accessors.  These can be called by any reader.  cnt, sum and max
+   are updated independently and thus might be slightly inconsistent
+   with each other and the bin counts under concurrent updates. */
+
+static inline ulong fd_lhist_cnt( fd_lhist_t const * lhist ) { return FD_VOLATILE_CONST( lhist->cnt ); }
+static inline ulong fd_lhist_sum( fd_lhist_t const * lhist ) { return FD_VOLATILE_CONST( lhist->sum ); }
+static inline ulong fd_lhist_max( fd_lhist_t const * lhist ) { return FD_VOLATILE_CONST( lhist->max ); }
+
+/* fd_lhist_snap copies the current bin counts of lhist into snap
+   (indexed [0,FD_LHIST_BIN_CNT)) and returns the sum of the copied
+   counts.  Safe to call concurrently with the writer (see above). */
+
+ulong
+fd_lhist_snap( fd_lhist_t const * lhist,
+               ulong *            snap );
+
+/* fd_lhist_snap_sub computes the per bin difference cur-prv of two
+   snapshots into delta and returns the sum of the differences.  All
+   arrays are indexed [0,FD_LHIST_BIN_CNT) and delta can be in-place
+   with cur or prv.  Useful for getting a histogram of the samples
+   recorded between two snapshots. */
+
+ulong
+fd_lhist_snap_sub( ulong *       delta,
+                   ulong const * cur,
+                   ulong const * prv );
+
+/* fd_lhist_quantile returns an upper bound of the q quantile of the
+   histogram given by snap (indexed [0,FD_LHIST_BIN_CNT)).  Specifically
+   returns fd_lhist_bin_hi of the bin containing the sample of rank
+   floor(q*cnt) (clamped to [0,cnt)), where cnt is the number of samples
+   in snap.  q is in [0,1].  Returns 0 if snap has no samples. */
+
+FD_FN_PURE ulong
+fd_lhist_quantile( ulong const * snap,
+                   double        q );
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_tango_lhist_fd_lhist_h */
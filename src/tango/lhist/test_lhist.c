@@ -0,0 +1,140 @@
+#include "../fd_tango.h"
+
+FD_STATIC_ASSERT( FD_LHIST_SUB_CNT==(1UL<<FD_LHIST_SUB_LG_CNT), unit_test );
+FD_STATIC_ASSERT( FD_LHIST_BIN_CNT==976UL,                      unit_test );
+
+FD_STATIC_ASSERT( FD_LHIST_ALIGN    ==128UL,              unit_test );
+FD_STATIC_ASSERT( FD_LHIST_FOOTPRINT==sizeof(fd_lhist_t), unit_test );
+
+static uchar shmem[ FD_LHIST_FOOTPRINT ] __attribute__((aligned(FD_LHIST_ALIGN)));
+
+static ulong snap0[ FD_LHIST_BIN_CNT ];
+static ulong snap1[ FD_LHIST_BIN_CNT ];
+static ulong delta[ FD_LHIST_BIN_CNT ];
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong iter_max = fd_env_strip_cmdline_ulong( &argc, &argv, "--iter-max", NULL, 1000000UL );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  FD_TEST( fd_lhist_align    ()==FD_LHIST_ALIGN     );
+  FD_TEST( fd_lhist_footprint()==FD_LHIST_FOOTPRINT );
+
+  /* Test bin mapping.  Bins should tile [0,2^64) contiguously in
+     order with a relative width of at most 1/SUB_CNT. */
+
+  FD_TEST( fd_lhist_bin_lo( 0UL                  )==0UL      );
+  FD_TEST( fd_lhist_bin_hi( FD_LHIST_BIN_CNT-1UL )==ULONG_MAX );
+  for( ulong idx=0UL; idx<FD_LHIST_BIN_CNT; idx++ ) {
+    ulong lo = fd_lhist_bin_lo( idx );
+    ulong hi = fd_lhist_bin_hi( idx );
+    FD_TEST( lo<=hi );
+    FD_TEST( fd_lhist_bin_idx( lo )==idx );
+    FD_TEST( fd_lhist_bin_idx( hi )==idx );
+    if( idx ) FD_TEST( fd_lhist_bin_hi( idx-1UL )+1UL==lo );
+    if( idx<FD_LHIST_SUB_CNT ) FD_TEST( lo==hi );
+    else                       FD_TEST( (hi-lo) < (lo/FD_LHIST_SUB_CNT) );
+  }
+
+  for( ulong iter=0UL; iter<iter_max; iter++ ) {
+    ulong x   = fd_rng_ulong( rng ) >> fd_rng_uint_roll( rng, 64U );
+    ulong idx = fd_lhist_bin_idx( x );
+    FD_TEST( idx<FD_LHIST_BIN_CNT );
+    FD_TEST( fd_lhist_bin_lo( idx )<=x && x<=fd_lhist_bin_hi( idx ) );
+  }
+
+  /* Test failure cases of fd_lhist_new */
+
+  FD_TEST( fd_lhist_new( NULL    )==NULL ); /* null shmem       */
+  FD_TEST( fd_lhist_new( shmem+1 )==NULL ); /* misaligned shmem */
+
+  void *       shlhist = fd_lhist_new ( shmem   ); FD_TEST( shlhist==shmem );
+  fd_lhist_t * lhist   = fd_lhist_join( shlhist ); FD_TEST( lhist );
+
+  /* Test failure cases of fd_lhist_join */
+
+  FD_TEST( fd_lhist_join( NULL          )==NULL ); /* null shlhist       */
+  FD_TEST( fd_lhist_join( (void *)0x1UL )==NULL ); /* misaligned shlhist */
+
+  ulong * shlhist_magic = (ulong *)shlhist;
+  (*shlhist_magic)++;
+  FD_TEST( fd_lhist_join( shlhist )==NULL ); /* bad magic */
+  (*shlhist_magic)--;
+
+  /* Test empty lhist */
+
+  FD_TEST( !fd_lhist_cnt( lhist ) );
+  FD_TEST( !fd_lhist_sum( lhist ) );
+  FD_TEST( !fd_lhist_max( lhist ) );
+  FD_TEST( !fd_lhist_snap( lhist, snap0 ) );
+  FD_TEST( !fd_lhist_quantile( snap0, 0.5 ) );
+
+  /* Test sampling against exact reference quantiles.  Sample 1..n
+     (uniform) so the exact q quantile is known. */
+
+  ulong n   = 100000UL;
+  ulong sum = 0UL;
+  for( ulong x=1UL; x<=n; x++ ) { fd_lhist_sample( lhist, x ); sum += x; }
+
+  FD_TEST( fd_lhist_cnt( lhist )==n   );
+  FD_TEST( fd_lhist_sum( lhist )==sum );
+  FD_TEST( fd_lhist_max( lhist )==n   );
+  FD_TEST( fd_lhist_snap( lhist, snap0 )==n );
+
+  double q[5] = { 0., 0.5, 0.99, 0.999, 1. };
+  for( ulong i=0UL; i<5UL; i++ ) {
+    ulong rank  = fd_ulong_min( (ulong)(q[i]*(double)n), n-1UL );
+    ulong exact = rank+1UL;
+    ulong est   = fd_lhist_quantile( snap0, q[i] );
+    FD_TEST( exact<=est );
+    FD_TEST( (double)(est-exact) <= (double)exact/(double)FD_LHIST_SUB_CNT );
+    FD_LOG_NOTICE(( "q %.3f: exact %lu est %lu", q[i], exact, est ));
+  }
+
+  /* Test interval snapshots */
+
+  for( ulong iter=0UL; iter<1000UL; iter++ ) fd_lhist_sample( lhist, 1000000UL );
+  FD_TEST( fd_lhist_snap( lhist, snap1 )==n+1000UL );
+  FD_TEST( fd_lhist_snap_sub( delta, snap1, snap0 )==1000UL );
+  ulong est = fd_lhist_quantile( delta, 0.5 );
+  FD_TEST( fd_lhist_bin_idx( est )==fd_lhist_bin_idx( 1000000UL ) );
+  FD_TEST( fd_lhist_snap_sub( snap1, snap1, snap1 )==0UL ); /* in place */
+  FD_TEST( !fd_lhist_quantile( snap1, 0.5 ) );
+
+  /* Test extreme samples */
+
+  fd_lhist_sample( lhist, ULONG_MAX );
+  FD_TEST( fd_lhist_max( lhist )==ULONG_MAX );
+  fd_lhist_snap( lhist, snap1 );
+  FD_TEST( fd_lhist_quantile( snap1, 1. )==ULONG_MAX );
+
+  /* Benchmark the writer path */
+
+  ulong bench_cnt = iter_max;
+  long  dt        = -fd_log_wallclock();
+  for( ulong iter=0UL; iter<bench_cnt; iter++ ) fd_lhist_sample( lhist, (iter*0x9e3779b97f4a7c15UL)>>48 );
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "fd_lhist_sample: %.3f ns/sample", (double)dt / (double)bench_cnt ));
+
+  FD_TEST( fd_lhist_leave( NULL  )==NULL    ); /* null lhist */
+  FD_TEST( fd_lhist_leave( lhist )==shlhist ); /* ok */
+
+  FD_TEST( fd_lhist_delete( NULL                )==NULL ); /* null shlhist       */
+  FD_TEST( fd_lhist_delete( (char *)shlhist+1UL )==NULL ); /* misaligned shlhist */
+
+  (*shlhist_magic)++;
+  FD_TEST( fd_lhist_delete( shlhist )==NULL ); /* bad magic */
+  (*shlhist_magic)--;
+
+  FD_TEST( fd_lhist_delete( shlhist )==shmem );
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -0,0 +1,4 @@
+$(call add-hdrs,fd_tlog.h)
+$(call add-objs,fd_tlog,fd_tango)
+$(call make-unit-test,test_tlog,test_tlog,fd_tango fd_util)
+$(call run-unit-test,test_tlog,)
@@ -0,0 +1,222 @@
+#include "fd_tlog.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+#include <stdio.h>
+
+void *
+fd_tlog_new( void * shmem,
+             ulong  depth,
+             ulong  seq0 ) {
+
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, fd_tlog_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  ulong footprint = fd_tlog_footprint( depth );
+  if( FD_UNLIKELY( !footprint ) ) {
+    FD_LOG_WARNING(( "bad depth" ));
+    return NULL;
+  }
+
+  fd_tlog_t * tlog = (fd_tlog_t *)shmem;
+
+  memset( tlog, 0, sizeof(fd_tlog_t) );
+
+  tlog->depth   = depth;
+  tlog->seq0    = seq0;
+  tlog->fmt_cnt = 0UL;
+  tlog->seq     = seq0;
+
+  /* Mark the records such that reads of records before seq0 indicate
+     overrun and reads of records at or after seq0 indicate not yet
+     written (see fd_tlog_read).  Specifically, if record idx would have
+     held sequence number s before seq0, we mark it with s+1 (which is
+     after s but before s+depth and not a sequence number record idx can
+     hold). */
+
+  fd_tlog_rec_t * rec = fd_tlog_private_rec( tlog );
+  for( ulong idx=0UL; idx<depth; idx++ ) {
+    ulong s = fd_seq_dec( seq0, depth ) + ((idx-seq0) & (depth-1UL));
+    memset( rec+idx, 0, sizeof(fd_tlog_rec_t) );
+    rec[ idx ].seq = fd_seq_inc( s, 1UL );
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( tlog->magic ) = FD_TLOG_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return shmem;
+}
+
+fd_tlog_t *
+fd_tlog_join( void * shtlog ) {
+
+  if( FD_UNLIKELY( !shtlog ) ) {
+    FD_LOG_WARNING(( "NULL shtlog" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shtlog, fd_tlog_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shtlog" ));
+    return NULL;
+  }
+
+  fd_tlog_t * tlog = (fd_tlog_t *)shtlog;
+
+  if( FD_UNLIKELY( tlog->magic!=FD_TLOG_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  return tlog;
+}
+
+void *
+fd_tlog_leave( fd_tlog_t * tlog ) {
+
+  if( FD_UNLIKELY( !tlog ) ) {
+    FD_LOG_WARNING(( "NULL tlog" ));
+    return NULL;
+  }
+
+  return (void *)tlog;
+}
+
+void *
+fd_tlog_delete( void * shtlog ) {
+
+  if( FD_UNLIKELY( !shtlog ) ) {
+    FD_LOG_WARNING(( "NULL shtlog" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shtlog, fd_tlog_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shtlog" ));
+    return NULL;
+  }
+
+  fd_tlog_t * tlog = (fd_tlog_t *)shtlog;
+
+  if( FD_UNLIKELY( tlog->magic!=FD_TLOG_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( tlog->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return shtlog;
+}
+
+/* fd_tlog_private_fmt_arg_cnt returns the number of arguments consumed
+   by the printf style format cstr fmt or ULONG_MAX if fmt uses a
+   conversion other than %% or a conversion taking a long / ulong (see
+   fd_tlog.h). */
+
+static ulong
+fd_tlog_private_fmt_arg_cnt( char const * fmt ) {
+  ulong cnt = 0UL;
+  for( char const * p=fmt; *p; p++ ) {
+    if( *p!='%' ) continue;
+    p++;
+    if( *p=='%' ) continue;
+    while( *p=='-' || *p=='+' || *p==' ' || *p=='#' || *p=='0' ) p++; /* flags */
+    while( '0'<=*p && *p<='9' ) p++;                                 /* width */
+    if( *p=='.' ) { p++; while( '0'<=*p && *p<='9' ) p++; }           /* precision */
+    if( *p!='l' ) return ULONG_MAX;                                  /* length, must be l */
+    p++;
+    if( !( *p=='d' || *p=='i' || *p=='u' || *p=='x' || *p=='X' || *p=='o' ) ) return ULONG_MAX;
+    cnt++;
+  }
+  return cnt;
+}
+
+ulong
+fd_tlog_fmt( fd_tlog_t *  tlog,
+             char const * fmt ) {
+
+  if( FD_UNLIKELY( !tlog ) ) {
+    FD_LOG_WARNING(( "NULL tlog" ));
+    return ULONG_MAX;
+  }
+
+  if( FD_UNLIKELY( !fmt ) ) {
+    FD_LOG_WARNING(( "NULL fmt" ));
+    return ULONG_MAX;
+  }
+
+  ulong len = strlen( fmt );
+  if( FD_UNLIKELY( len>=FD_TLOG_FMT_SZ ) ) {
+    FD_LOG_WARNING(( "fmt too long" ));
+    return ULONG_MAX;
+  }
+
+  ulong arg_cnt = fd_tlog_private_fmt_arg_cnt( fmt );
+  if( FD_UNLIKELY( arg_cnt==ULONG_MAX ) ) {
+    FD_LOG_WARNING(( "fmt \"%s\" uses an unsupported conversion", fmt ));
+    return ULONG_MAX;
+  }
+  if( FD_UNLIKELY( arg_cnt>FD_TLOG_ARG_MAX ) ) {
+    FD_LOG_WARNING(( "fmt \"%s\" has too many conversions", fmt ));
+    return ULONG_MAX;
+  }
+
+  ulong fmt_cnt = tlog->fmt_cnt;
+  for( ulong id=0UL; id<fmt_cnt; id++ ) if( !strcmp( tlog->fmt[ id ], fmt ) ) return id;
+
+  if( FD_UNLIKELY( fmt_cnt>=FD_TLOG_FMT_MAX ) ) {
+    FD_LOG_WARNING(( "too many fmts" ));
+    return ULONG_MAX;
+  }
+
+  /* Write the fmt before making it visible to readers */
+
+  memcpy( tlog->fmt[ fmt_cnt ], fmt, len+1UL );
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( tlog->fmt_cnt ) = fmt_cnt+1UL;
+  FD_COMPILER_MFENCE();
+
+  return fmt_cnt;
+}
+
+char const *
+fd_tlog_fmt_cstr( fd_tlog_t const * tlog,
+                  ulong             id ) {
+  if( FD_UNLIKELY( id>=fd_tlog_fmt_cnt( tlog ) ) ) return NULL;
+  return tlog->fmt[ id ];
+}
+
+char *
+fd_tlog_rec_cstr( fd_tlog_t const *     tlog,
+                  fd_tlog_rec_t const * rec,
+                  char *                buf,
+                  ulong                 buf_sz ) {
+  ulong const * a = rec->arg;
+
+  /* Since the tlog might be corrupt and/or concurrently modified by
+     another process, work from a local copy of the fmt and revalidate
+     it before using it. */
+
+  char         fmt[ FD_TLOG_FMT_SZ ];
+  char const * src = fd_tlog_fmt_cstr( tlog, rec->fmt );
+  int          ok  = !!src;
+  if( FD_LIKELY( ok ) ) {
+    memcpy( fmt, src, FD_TLOG_FMT_SZ );
+    fmt[ FD_TLOG_FMT_SZ-1UL ] = '\0';
+    ok = fd_tlog_private_fmt_arg_cnt( fmt )<=FD_TLOG_ARG_MAX;
+  }
+
+  if( FD_LIKELY( ok ) ) snprintf( buf, buf_sz, fmt, a[0], a[1], a[2], a[3], a[4] );
+  else                  snprintf( buf, buf_sz, "unknown fmt %lu args %lu %lu %lu %lu %lu", rec->fmt, a[0], a[1], a[2], a[3], a[4] );
+  return buf;
+}
+
+#endif
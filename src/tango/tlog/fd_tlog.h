@@ -0,0 +1,256 @@
+#ifndef HEADER_fd_src_tango_tlog_fd_tlog_h
+#define HEADER_fd_src_tango_tlog_fd_tlog_h
+
+/* fd_tlog provides a binary trace log for diagnostics from tile run
+   loops.  Instead of formatting a message and writing it synchronously
+   to the log (microseconds and a potential stall on disk), the writer
+   appends a fixed size binary record (format id, tickcount timestamp
+   and up to FD_TLOG_ARG_MAX ulong arguments) into a ring in shared
+   memory.  This costs a handful of ns and touches one cache line per
+   record, so verbose diagnostics can be left on in production.  A
+   separate reader (e.g. fd_tango_ctl drain-tlog) decodes the records
+   asynchronously and writes them to the permanent log.
+
+   A tlog has exactly one writer and an arbitrary number of concurrent
+   readers.  The writer never blocks and does no atomic operations.  As
+   such, a slow reader can be overrun by the writer (like a mcache
+   consumer, the reader detects this and can skip ahead).
+
+   Formats are printf style cstrs registered with the tlog up front (at
+   tile boot) such that they are available to readers in other
+   processes.  To keep readers robust against arbitrary arguments, a
+   format can only use conversions that take a long or a ulong (i.e.
+   %ld, %li, %lu, %lx, %lX and %lo, with the usual flags, width and
+   precision) and %%, and at most FD_TLOG_ARG_MAX conversions.  Typical
+   usage:
+
+     // At tile boot
+     ulong fmt_ovrn = fd_tlog_fmt( tlog, "overrun seq %lu cnt %lu" );
+
+     // In the run loop
+     FD_TLOG( tlog, fmt_ovrn, seq, ovrn_cnt ); */
+
+#include "../fd_tango_base.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+/* FD_TLOG_ARG_MAX is the maximum number of arguments in a record.
+   FD_TLOG_FMT_MAX is the maximum number of formats that can be
+   registered with a tlog.  FD_TLOG_FMT_SZ is the maximum size of a
+   format cstr (including the terminating '\0'). */
+
+#define FD_TLOG_ARG_MAX (5UL)
+#define FD_TLOG_FMT_MAX (64UL)
+#define FD_TLOG_FMT_SZ  (128UL)
+
+/* FD_TLOG_{ALIGN,FOOTPRINT} specify the alignment and footprint needed
+   for a tlog with depth records.  ALIGN is double cache line to
+   mitigate various kinds of false sharing.  depth is assumed to be a
+   valid depth (see fd_tlog_footprint). */
+
+#define FD_TLOG_ALIGN              (128UL)
+#define FD_TLOG_FOOTPRINT( depth ) (sizeof(fd_tlog_t) + (depth)*sizeof(fd_tlog_rec_t))
+
+/* A fd_tlog_rec_t is a tlog record.  Records are exactly one cache
+   line.  seq is the sequence number of the record (written last by the
+   writer such that readers can detect torn reads and overruns), ts is
+   the fd_tickcount when the record was written, fmt is the format id
+   and arg holds the arguments (unused arguments are zero). */
+
+struct __attribute__((aligned(64UL))) fd_tlog_rec {
+  ulong seq;
+  long  ts;
+  ulong fmt;
+  ulong arg[ FD_TLOG_ARG_MAX ];
+};
+
+typedef struct fd_tlog_rec fd_tlog_rec_t;
+
+/* fd_tlog_t is an opaque handle of a tlog.  Details are exposed here
+   to facilitate inlining the writer path.  The ring of depth records
+   immediately follows the header. */
+
+#define FD_TLOG_MAGIC (0xf17eda2c37710900UL) /* firedancer tlog ver 0 */
+
+struct __attribute__((aligned(FD_TLOG_ALIGN))) fd_tlog_private {
+  ulong magic;   /* == FD_TLOG_MAGIC */
+  ulong depth;   /* Number of records in the ring, a power of 2 */
+  ulong seq0;    /* Sequence number of the first record */
+  ulong fmt_cnt; /* Number of registered formats, in [0,FD_TLOG_FMT_MAX] */
+
+  ulong seq __attribute__((aligned(FD_TLOG_ALIGN))); /* Sequence number of the next record to write (writer owned line) */
+
+  char  fmt[ FD_TLOG_FMT_MAX ][ FD_TLOG_FMT_SZ ] __attribute__((aligned(FD_TLOG_ALIGN)));
+
+  /* depth fd_tlog_rec_t follow here */
+};
+
+typedef struct fd_tlog_private fd_tlog_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_tlog_{align,footprint} return the required alignment and
+   footprint of a memory region suitable for use as a tlog with depth
+   records.  depth should be an integer power of 2 of at least 2.
+   fd_tlog_footprint returns 0 for an invalid depth. */
+
+FD_FN_CONST static inline ulong fd_tlog_align( void ) { return FD_TLOG_ALIGN; }
+
+FD_FN_CONST static inline ulong
+fd_tlog_footprint( ulong depth ) {
+  if( FD_UNLIKELY( !((depth>=2UL) & fd_ulong_is_pow2( depth ) & (depth<=(1UL<<48))) ) ) return 0UL;
+  return FD_TLOG_FOOTPRINT( depth );
+}
+
+/* fd_tlog_new formats an unused memory region for use as a tlog with
+   depth records.  The first record written will have sequence number
+   seq0 and the tlog will initially have no registered formats.  Returns
+   shmem on success and NULL on failure (logs details).
+
+   fd_tlog_join joins the caller to a tlog.  fd_tlog_leave leaves a
+   current local join.  fd_tlog_delete unformats a memory region used
+   as a tlog.  These follow the usual conventions. */
+
+void *
+fd_tlog_new( void * shmem,
+             ulong  depth,
+             ulong  seq0 );
+
+fd_tlog_t *
+fd_tlog_join( void * shtlog );
+
+void *
+fd_tlog_leave( fd_tlog_t * tlog );
+
+void *
+fd_tlog_delete( void * shtlog );
+
+/* Accessors.  fd_tlog_seq returns the sequence number of the next
+   record the writer will write (as observed at some point in time
+   between when the call was made and when it returned). */
+
+FD_FN_PURE static inline ulong fd_tlog_depth  ( fd_tlog_t const * tlog ) { return tlog->depth; }
+FD_FN_PURE static inline ulong fd_tlog_seq0   ( fd_tlog_t const * tlog ) { return tlog->seq0;  }
+static inline ulong            fd_tlog_seq    ( fd_tlog_t const * tlog ) { return FD_VOLATILE_CONST( tlog->seq     ); }
+static inline ulong            fd_tlog_fmt_cnt( fd_tlog_t const * tlog ) { return FD_VOLATILE_CONST( tlog->fmt_cnt ); }
+
+/* fd_tlog_private_rec returns the location of the tlog's ring in the
+   caller's address space. */
+
+FD_FN_CONST static inline fd_tlog_rec_t *
+fd_tlog_private_rec( fd_tlog_t * tlog ) {
+  return (fd_tlog_rec_t *)(tlog+1);
+}
+
+FD_FN_CONST static inline fd_tlog_rec_t const *
+fd_tlog_private_rec_const( fd_tlog_t const * tlog ) {
+  return (fd_tlog_rec_t const *)(tlog+1);
+}
+
+/* fd_tlog_fmt registers the format cstr fmt with tlog and returns its
+   id (in [0,FD_TLOG_FMT_MAX)).  If fmt was already registered, returns
+   the existing id (such that tiles can reregister their formats when
+   restarted).  Returns ULONG_MAX on failure (e.g. fmt is NULL, too
+   long, uses an unsupported conversion or the tlog has no room for more
+   formats ... logs details).  Only the tlog's writer should call this
+   (typically at boot).  Formats can never be unregistered.
+
+   fd_tlog_fmt_cstr returns the format cstr with the given id or NULL if
+   id is not a registered format. */
+
+ulong
+fd_tlog_fmt( fd_tlog_t *  tlog,
+             char const * fmt );
+
+char const *
+fd_tlog_fmt_cstr( fd_tlog_t const * tlog,
+                  ulong             id );
+
+/* fd_tlog_write appends a record with format id fmt and the given
+   arguments to the tlog.  Only the tlog's single writer should call
+   this.  This is O(1), does no atomic operations, never blocks and
+   touches the record's cache line and the (writer owned) seq cache
+   line.  fmt is not validated (an invalid fmt will be reported by the
+   reader).  FD_TLOG is a convenience wrapper that takes 0 to
+   FD_TLOG_ARG_MAX arguments (zero filling unused arguments). */
+
+static inline void
+fd_tlog_write( fd_tlog_t * tlog,
+               ulong       fmt,
+               ulong       a0,
+               ulong       a1,
+               ulong       a2,
+               ulong       a3,
+               ulong       a4 ) {
+  long            ts  = fd_tickcount();
+  ulong           seq = tlog->seq;
+  fd_tlog_rec_t * rec = fd_tlog_private_rec( tlog ) + (seq & (tlog->depth-1UL));
+
+  /* Mark the record as being written (looks older than seq to readers
+     looking for seq and newer than any older record to readers looking
+     for an older record), fill it in and then publish it. */
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( rec->seq ) = fd_seq_dec( seq, 1UL );
+  FD_COMPILER_MFENCE();
+  rec->ts     = ts;
+  rec->fmt    = fmt;
+  rec->arg[0] = a0;
+  rec->arg[1] = a1;
+  rec->arg[2] = a2;
+  rec->arg[3] = a3;
+  rec->arg[4] = a4;
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( rec->seq  ) = seq;
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( tlog->seq ) = fd_seq_inc( seq, 1UL );
+  FD_COMPILER_MFENCE();
+}
+
+#define FD_TLOG( ... ) FD_TLOG_PRIVATE( __VA_ARGS__, 0UL, 0UL, 0UL, 0UL, 0UL, 0UL )
+#define FD_TLOG_PRIVATE( tlog, fmt, a0, a1, a2, a3, a4, ... )                                 \
+  fd_tlog_write( (tlog), (fmt), (ulong)(a0), (ulong)(a1), (ulong)(a2), (ulong)(a3), (ulong)(a4) )
+
+/* fd_tlog_read copies record seq of tlog into rec.  Returns 0 on
+   success, a negative value if record seq has not been written yet and
+   a positive value if record seq was overrun by the writer (or never
+   existed, i.e. is before seq0).  rec is clobbered on failure.  Safe to
+   call concurrently with the writer.  A reader that was overrun can
+   resume at fd_tlog_seq( tlog ) - depth (or later) and should report
+   the number of records lost. */
+
+static inline int
+fd_tlog_read( fd_tlog_t const * tlog,
+              ulong             seq,
+              fd_tlog_rec_t *   rec ) {
+  fd_tlog_rec_t const * src = fd_tlog_private_rec_const( tlog ) + (seq & (tlog->depth-1UL));
+
+  FD_COMPILER_MFENCE();
+  ulong seq_before = FD_VOLATILE_CONST( src->seq );
+  FD_COMPILER_MFENCE();
+  *rec = *src;
+  FD_COMPILER_MFENCE();
+  ulong seq_after  = FD_VOLATILE_CONST( src->seq );
+  FD_COMPILER_MFENCE();
+
+  if( FD_UNLIKELY( seq_before!=seq ) ) return fd_seq_lt( seq_before, seq ) ? -1 : 1;
+  if( FD_UNLIKELY( seq_after !=seq ) ) return 1;
+  return 0;
+}
+
+/* fd_tlog_rec_cstr formats rec (read from tlog) into the cstr buf of
+   size buf_sz (truncating if necessary).  Records with an unregistered
+   format id are formatted as the format id and raw arguments.  Returns
+   buf.  buf_sz should be positive. */
+
+char *
+fd_tlog_rec_cstr( fd_tlog_t const *     tlog,
+                  fd_tlog_rec_t const * rec,
+                  char *                buf,
+                  ulong                 buf_sz );
+
+FD_PROTOTYPES_END
+
+#endif
+
+#endif /* HEADER_fd_src_tango_tlog_fd_tlog_h */
@@ -0,0 +1,189 @@
+#include "../fd_tango.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+FD_STATIC_ASSERT( FD_TLOG_ALIGN  ==128UL, unit_test );
+FD_STATIC_ASSERT( FD_TLOG_ARG_MAX==  5UL, unit_test );
+
+FD_STATIC_ASSERT( sizeof(fd_tlog_rec_t)==64UL, unit_test );
+
+FD_STATIC_ASSERT( FD_TLOG_FOOTPRINT( 4UL )==sizeof(fd_tlog_t)+4UL*sizeof(fd_tlog_rec_t), unit_test );
+
+#define DEPTH (64UL)
+
+static uchar shmem[ FD_TLOG_FOOTPRINT( DEPTH ) ] __attribute__((aligned(FD_TLOG_ALIGN)));
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong iter_max = fd_env_strip_cmdline_ulong( &argc, &argv, "--iter-max", NULL, 10000000UL );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  FD_TEST( fd_tlog_align()==FD_TLOG_ALIGN );
+
+  FD_TEST( !fd_tlog_footprint( 0UL   ) );
+  FD_TEST( !fd_tlog_footprint( 1UL   ) );
+  FD_TEST( !fd_tlog_footprint( 3UL   ) );
+  FD_TEST( fd_tlog_footprint( DEPTH )==FD_TLOG_FOOTPRINT( DEPTH ) );
+
+  /* Test failure cases of fd_tlog_new */
+
+  ulong seq0 = fd_rng_ulong( rng );
+
+  FD_TEST( fd_tlog_new( NULL,    DEPTH, seq0 )==NULL ); /* null shmem       */
+  FD_TEST( fd_tlog_new( shmem+1, DEPTH, seq0 )==NULL ); /* misaligned shmem */
+  FD_TEST( fd_tlog_new( shmem,   3UL,   seq0 )==NULL ); /* bad depth        */
+
+  void *      shtlog = fd_tlog_new ( shmem, DEPTH, seq0 ); FD_TEST( shtlog==shmem );
+  fd_tlog_t * tlog   = fd_tlog_join( shtlog );             FD_TEST( tlog );
+
+  /* Test failure cases of fd_tlog_join */
+
+  FD_TEST( fd_tlog_join( NULL          )==NULL ); /* null shtlog       */
+  FD_TEST( fd_tlog_join( (void *)0x1UL )==NULL ); /* misaligned shtlog */
+
+  ulong * shtlog_magic = (ulong *)shtlog;
+  (*shtlog_magic)++;
+  FD_TEST( fd_tlog_join( shtlog )==NULL ); /* bad magic */
+  (*shtlog_magic)--;
+
+  FD_TEST( fd_tlog_depth  ( tlog )==DEPTH );
+  FD_TEST( fd_tlog_seq0   ( tlog )==seq0  );
+  FD_TEST( fd_tlog_seq    ( tlog )==seq0  );
+  FD_TEST( fd_tlog_fmt_cnt( tlog )==0UL   );
+
+  /* Test fmt registration */
+
+  FD_TEST( fd_tlog_fmt( NULL, "x" )==ULONG_MAX ); /* null tlog */
+  FD_TEST( fd_tlog_fmt( tlog, NULL )==ULONG_MAX ); /* null fmt  */
+  FD_TEST( fd_tlog_fmt( tlog, "%s"               )==ULONG_MAX ); /* unsupported conversions */
+  FD_TEST( fd_tlog_fmt( tlog, "%u"               )==ULONG_MAX );
+  FD_TEST( fd_tlog_fmt( tlog, "%f"               )==ULONG_MAX );
+  FD_TEST( fd_tlog_fmt( tlog, "%lf"              )==ULONG_MAX );
+  FD_TEST( fd_tlog_fmt( tlog, "%llu"             )==ULONG_MAX );
+  FD_TEST( fd_tlog_fmt( tlog, "%n"               )==ULONG_MAX );
+  FD_TEST( fd_tlog_fmt( tlog, "trailing %"       )==ULONG_MAX );
+  FD_TEST( fd_tlog_fmt( tlog, "trailing %l"      )==ULONG_MAX );
+  FD_TEST( fd_tlog_fmt( tlog, "%lu%lu%lu%lu%lu%lu" )==ULONG_MAX ); /* too many conversions */
+
+  char long_fmt[ FD_TLOG_FMT_SZ+1UL ];
+  memset( long_fmt, 'a', FD_TLOG_FMT_SZ ); long_fmt[ FD_TLOG_FMT_SZ ] = '\0';
+  FD_TEST( fd_tlog_fmt( tlog, long_fmt )==ULONG_MAX ); /* too long */
+
+  FD_TEST( fd_tlog_fmt_cnt( tlog )==0UL );
+
+  ulong fmt0 = fd_tlog_fmt( tlog, "no args 100%%" );                         FD_TEST( fmt0==0UL );
+  ulong fmt1 = fd_tlog_fmt( tlog, "seq %lu sz %lu" );                         FD_TEST( fmt1==1UL );
+  ulong fmt2 = fd_tlog_fmt( tlog, "%ld %li %5lu %-3lx| %#lX %016lx %.3lo" ); FD_TEST( fmt2==ULONG_MAX ); /* 7 args */
+  /**/  fmt2 = fd_tlog_fmt( tlog, "%ld %li %5lu %-3lx|%#lX" );               FD_TEST( fmt2==2UL );
+  FD_TEST( fd_tlog_fmt( tlog, "seq %lu sz %lu" )==fmt1 ); /* reregistration */
+  FD_TEST( fd_tlog_fmt_cnt( tlog )==3UL );
+
+  FD_TEST( !strcmp( fd_tlog_fmt_cstr( tlog, fmt1 ), "seq %lu sz %lu" ) );
+  FD_TEST( !fd_tlog_fmt_cstr( tlog, 3UL ) );
+
+  for( ulong id=3UL; id<FD_TLOG_FMT_MAX; id++ ) {
+    char buf[ 32 ];
+    FD_TEST( fd_tlog_fmt( tlog, fd_cstr_printf( buf, 32UL, NULL, "fmt %lu %%lu", id ) )==id );
+  }
+  FD_TEST( fd_tlog_fmt( tlog, "one too many" )==ULONG_MAX );
+
+  /* Test empty tlog */
+
+  fd_tlog_rec_t rec[1];
+  FD_TEST( fd_tlog_read( tlog, seq0,                      rec )<0 ); /* not yet written */
+  FD_TEST( fd_tlog_read( tlog, fd_seq_inc( seq0, 5UL ),   rec )<0 ); /* not yet written */
+  FD_TEST( fd_tlog_read( tlog, fd_seq_dec( seq0, 1UL ),   rec )>0 ); /* never existed   */
+  FD_TEST( fd_tlog_read( tlog, fd_seq_dec( seq0, DEPTH ), rec )>0 ); /* never existed   */
+
+  /* Test writing and reading and decoding */
+
+  char buf[ 256 ];
+
+  long ts0 = fd_tickcount();
+  FD_TLOG( tlog, fmt0 );
+  FD_TLOG( tlog, fmt1, 12UL, 34UL );
+  FD_TLOG( tlog, fmt2, -1L, 2L, 3UL, 0xabUL, 0xcdUL );
+  FD_TLOG( tlog, 1234UL, 1UL, 2UL );
+  long ts1 = fd_tickcount();
+
+  FD_TEST( fd_tlog_seq( tlog )==fd_seq_inc( seq0, 4UL ) );
+
+  FD_TEST( !fd_tlog_read( tlog, seq0, rec ) );
+  FD_TEST( rec->seq==seq0 ); FD_TEST( rec->fmt==fmt0 ); FD_TEST( ts0<=rec->ts ); FD_TEST( rec->ts<=ts1 );
+  for( ulong i=0UL; i<FD_TLOG_ARG_MAX; i++ ) FD_TEST( !rec->arg[i] );
+  FD_TEST( !strcmp( fd_tlog_rec_cstr( tlog, rec, buf, 256UL ), "no args 100%" ) );
+
+  FD_TEST( !fd_tlog_read( tlog, fd_seq_inc( seq0, 1UL ), rec ) );
+  FD_TEST( !strcmp( fd_tlog_rec_cstr( tlog, rec, buf, 256UL ), "seq 12 sz 34" ) );
+
+  FD_TEST( !fd_tlog_read( tlog, fd_seq_inc( seq0, 2UL ), rec ) );
+  FD_TEST( !strcmp( fd_tlog_rec_cstr( tlog, rec, buf, 256UL ), "-1 2     3 ab |0XCD" ) );
+  FD_TEST( !strcmp( fd_tlog_rec_cstr( tlog, rec, buf, 8UL ), "-1 2   " ) ); /* truncation */
+
+  FD_TEST( !fd_tlog_read( tlog, fd_seq_inc( seq0, 3UL ), rec ) );
+  FD_TEST( !strcmp( fd_tlog_rec_cstr( tlog, rec, buf, 256UL ), "unknown fmt 1234 args 1 2 0 0 0" ) );
+
+  FD_TEST( fd_tlog_read( tlog, fd_seq_inc( seq0, 4UL ), rec )<0 );
+
+  /* Test overrun detection with random read positions as the writer
+     laps the ring many times */
+
+  ulong seq = fd_seq_inc( seq0, 4UL );
+  for( ulong iter=0UL; iter<100000UL; iter++ ) {
+    ulong a0 = fd_rng_ulong( rng );
+    FD_TLOG( tlog, fmt1, seq, a0 );
+    seq = fd_seq_inc( seq, 1UL );
+    FD_TEST( fd_tlog_seq( tlog )==seq );
+
+    ulong lag = fd_rng_ulong_roll( rng, 2UL*DEPTH ); /* In [0,2*DEPTH) */
+    ulong s   = fd_seq_dec( seq, lag );
+    ulong avl = fd_ulong_min( DEPTH, seq-seq0 ); /* Number of most recent records still readable */
+    int   err = fd_tlog_read( tlog, s, rec );
+    if(      lag==0UL   ) FD_TEST( err<0 );
+    else if( lag<=avl   ) { FD_TEST( !err ); FD_TEST( rec->seq==s ); FD_TEST( rec->fmt==fmt1 ); FD_TEST( rec->arg[0]==s ); }
+    else                  FD_TEST( err>0 );
+    if( lag==1UL ) FD_TEST( rec->arg[1]==a0 );
+  }
+
+  /* Benchmark the writer path */
+
+  long dt = -fd_log_wallclock();
+  for( ulong iter=0UL; iter<iter_max; iter++ ) FD_TLOG( tlog, fmt1, iter, seq );
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "fd_tlog_write: %.3f ns/record", (double)dt / (double)iter_max ));
+
+  FD_TEST( fd_tlog_leave( NULL )==NULL   ); /* null tlog */
+  FD_TEST( fd_tlog_leave( tlog )==shtlog ); /* ok */
+
+  FD_TEST( fd_tlog_delete( NULL               )==NULL ); /* null shtlog       */
+  FD_TEST( fd_tlog_delete( (char *)shtlog+1UL )==NULL ); /* misaligned shtlog */
+
+  (*shtlog_magic)++;
+  FD_TEST( fd_tlog_delete( shtlog )==NULL ); /* bad magic */
+  (*shtlog_magic)--;
+
+  FD_TEST( fd_tlog_delete( shtlog )==shmem );
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
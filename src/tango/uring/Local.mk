@@ -0,0 +1,8 @@
+ifdef FD_HAS_HOSTED
+ifdef FD_HAS_IO_URING
+$(call add-hdrs,fd_uring_aio.h)
+$(call add-objs,fd_uring_aio,fd_tango)
+$(call make-unit-test,test_uring_aio,test_uring_aio,fd_tango fd_util)
+$(call run-unit-test,test_uring_aio)
+endif
+endif
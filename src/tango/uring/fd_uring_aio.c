@@ -0,0 +1,827 @@
+#if !defined(__linux__) || !FD_HAS_IO_URING
+#error "fd_uring_aio requires Linux operating system with io_uring support"
+#endif
+
+#define _GNU_SOURCE /* for syscall and struct in_pktinfo */
+
+#include "../../util/fd_util.h"
+#include "../../util/net/fd_eth.h"
+#include "../../util/net/fd_udp.h" /* includes fd_ip4.h */
+#include "fd_uring_aio.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <linux/io_uring.h>
+
+/* Private definition of an fd_uring_aio_t */
+
+#define FD_URING_AIO_MAGIC (0xf17eda2c7572696fUL) /* firedancer hex(urio) */
+
+/* FD_URING_AIO_UDATA_RX is the io_uring user_data of the multishot
+   receive.  Sends use the index of their tx slot. */
+
+#define FD_URING_AIO_UDATA_RX (ULONG_MAX)
+
+/* FD_URING_AIO_RX_{NAME,CTL}_SZ are the space reserved in front of the
+   payload of each rx buffer for the sender's address and the
+   IP_PKTINFO control message.  With the io_uring_recvmsg_out header,
+   the payload starts FD_URING_AIO_RX_PAYLOAD_OFF bytes into the buffer
+   leaving enough room to write the synthesized headers in front of it
+   (in place of the kernel's metadata, after it has been consumed). */
+
+#define FD_URING_AIO_RX_NAME_SZ     (16UL) /* sizeof(struct sockaddr_in) */
+#define FD_URING_AIO_RX_CTL_SZ      (32UL) /* CMSG_SPACE( sizeof(struct in_pktinfo) ) */
+#define FD_URING_AIO_RX_PAYLOAD_OFF (sizeof(struct io_uring_recvmsg_out)+FD_URING_AIO_RX_NAME_SZ+FD_URING_AIO_RX_CTL_SZ)
+#define FD_URING_AIO_HDR_SZ         (sizeof(fd_eth_hdr_t)+sizeof(fd_ip4_hdr_t)+sizeof(fd_udp_hdr_t))
+
+FD_STATIC_ASSERT( FD_URING_AIO_RX_PAYLOAD_OFF==64UL,                                       layout );
+FD_STATIC_ASSERT( FD_URING_AIO_RX_PAYLOAD_MAX==FD_URING_AIO_FRAME_SZ-FD_URING_AIO_RX_PAYLOAD_OFF, layout );
+FD_STATIC_ASSERT( FD_URING_AIO_HDR_SZ<=FD_URING_AIO_RX_PAYLOAD_OFF,                         layout );
+
+/* fd_uring_aio_tx_slot_t holds the sendmsg arguments of a send in
+   flight (the kernel reads these asynchronously). */
+
+struct fd_uring_aio_tx_slot {
+  struct msghdr      msg;
+  struct iovec       iov;
+  struct sockaddr_in addr;
+};
+
+typedef struct fd_uring_aio_tx_slot fd_uring_aio_tx_slot_t;
+
+struct __attribute__((aligned(128))) fd_uring_aio_private {
+
+  /* Data Layout Config ***********************************************/
+
+  ulong magic;        /* ==FD_URING_AIO_MAGIC */
+  ulong rx_depth;     /* number of rx buffers, power of 2 */
+  ulong tx_depth;     /* number of tx slots */
+  ulong pkt_depth;    /* max frames per rx aio batch */
+  ulong br_off;       /* offset of the provided buffer ring (page aligned), struct io_uring_buf[ rx_depth ] */
+  ulong pkt_off;      /* offset of fd_aio_pkt_info_t[ pkt_depth ] */
+  ulong bid_off;      /* offset of ulong[ pkt_depth ], rx buffer of each pkt */
+  ulong tx_slot_off;  /* offset of fd_uring_aio_tx_slot_t[ tx_depth ] */
+  ulong tx_stack_off; /* offset of ulong[ tx_depth ], stack of free tx slots */
+  ulong rx_frame_off; /* offset of uchar[ rx_depth ][ FD_URING_AIO_FRAME_SZ ] */
+  ulong tx_frame_off; /* offset of uchar[ tx_depth ][ FD_URING_AIO_FRAME_SZ ] */
+
+  /* Join Config ******************************************************/
+
+  int      sock_fd;  /* -1 if not joined */
+  int      ring_fd;
+  uint     laddr;    /* local address of sock_fd (used if a datagram comes without IP_PKTINFO) */
+  ushort   lport;    /* local port of sock_fd, net order */
+  fd_aio_t rx;       /* from outside to user */
+  fd_aio_t tx;       /* from user to outside */
+
+  void *   ring_mem; /* SQ / CQ rings (single mmap) */
+  ulong    ring_sz;
+  struct io_uring_sqe * sqe;
+  ulong    sqe_sz;
+
+  uint *   sq_khead;
+  uint *   sq_ktail;
+  uint     sq_mask;
+  uint     sq_entries;
+  uint     sq_tail;  /* local copy of the SQ tail */
+
+  uint *   cq_khead;
+  uint *   cq_ktail;
+  uint     cq_mask;
+  struct io_uring_cqe * cqe;
+
+  struct io_uring_buf_ring * br;
+  ulong    br_tail;  /* local copy of the provided buffer ring tail */
+
+  struct msghdr rx_msg; /* recvmsg template of the multishot receive */
+  int      rx_armed;    /* non-zero if the multishot receive is active */
+
+  ulong *  tx_stack;
+  ulong    tx_top;
+
+  /* RX frames received but not yet accepted by the rx aio.  These are
+     pkt[0,rx_pend_cnt) / bid[0,rx_pend_cnt) and their buffers are held
+     back from the kernel until accepted. */
+
+  ulong    rx_pend_cnt;
+
+  /* Diagnostics (accumulated over the lifetime of the join) */
+
+  ulong    rx_defer_cnt;
+  ulong    rx_drop_cnt;
+  ulong    rx_nobuf_cnt;
+  ulong    tx_err_cnt;
+
+  /* Variable-length data (see *_off above) follows */
+};
+
+/* io_uring syscalls (no liburing dependency, these are thin) */
+
+static inline int
+fd_io_uring_setup( uint                     entries,
+                   struct io_uring_params * p ) {
+  return (int)syscall( __NR_io_uring_setup, entries, p );
+}
+
+static inline int
+fd_io_uring_enter( int  ring_fd,
+                   uint to_submit,
+                   uint min_complete,
+                   uint flags ) {
+  return (int)syscall( __NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0UL );
+}
+
+static inline int
+fd_io_uring_register( int    ring_fd,
+                      uint   opcode,
+                      void * arg,
+                      uint   nr_args ) {
+  return (int)syscall( __NR_io_uring_register, ring_fd, opcode, arg, nr_args );
+}
+
+FD_FN_PURE static inline fd_aio_pkt_info_t *      fd_uring_aio_pkts    ( fd_uring_aio_t * aio ) { return (fd_aio_pkt_info_t *     )((ulong)aio + aio->pkt_off     ); }
+FD_FN_PURE static inline ulong *                  fd_uring_aio_bids    ( fd_uring_aio_t * aio ) { return (ulong *                 )((ulong)aio + aio->bid_off     ); }
+FD_FN_PURE static inline fd_uring_aio_tx_slot_t * fd_uring_aio_tx_slots( fd_uring_aio_t * aio ) { return (fd_uring_aio_tx_slot_t *)((ulong)aio + aio->tx_slot_off ); }
+
+FD_FN_PURE static inline uchar *
+fd_uring_aio_rx_frame( fd_uring_aio_t * aio,
+                       ulong            bid ) {
+  return (uchar *)((ulong)aio + aio->rx_frame_off + bid*FD_URING_AIO_FRAME_SZ);
+}
+
+FD_FN_PURE static inline uchar *
+fd_uring_aio_tx_frame( fd_uring_aio_t * aio,
+                       ulong            slot ) {
+  return (uchar *)((ulong)aio + aio->tx_frame_off + slot*FD_URING_AIO_FRAME_SZ);
+}
+
+/* Forward declaration */
+static int
+fd_uring_aio_send( void *                    ctx,
+                   fd_aio_pkt_info_t const * batch,
+                   ulong                     batch_cnt,
+                   ulong *                   opt_batch_idx );
+
+/* fd_uring_aio_rx_discard is the rx aio until one is set with
+   fd_uring_aio_set_rx (see fd_xsk_aio_rx_discard). */
+static int
+fd_uring_aio_rx_discard( void *                    ctx,
+                         fd_aio_pkt_info_t const * batch,
+                         ulong                     batch_cnt,
+                         ulong *                   opt_batch_idx ) {
+  (void)ctx; (void)batch; (void)batch_cnt; (void)opt_batch_idx;
+  return FD_AIO_SUCCESS;
+}
+
+ulong
+fd_uring_aio_align( void ) {
+  return FD_URING_AIO_ALIGN;
+}
+
+/* fd_uring_aio_layout computes the offsets of the variable-length
+   regions of an fd_uring_aio_t into aio (which can be a scratch
+   struct) and returns the footprint.  Assumes valid parameters. */
+
+static ulong
+fd_uring_aio_layout( fd_uring_aio_t * aio,
+                     ulong            rx_depth,
+                     ulong            tx_depth,
+                     ulong            pkt_cnt ) {
+  ulong off = 0UL;
+  off = fd_ulong_align_up( off + sizeof(fd_uring_aio_t),                     FD_URING_AIO_ALIGN ); aio->br_off       = off;
+  off = fd_ulong_align_up( off + rx_depth*sizeof(struct io_uring_buf),        128UL              ); aio->pkt_off      = off;
+  off = fd_ulong_align_up( off + pkt_cnt *sizeof(fd_aio_pkt_info_t),          128UL              ); aio->bid_off      = off;
+  off = fd_ulong_align_up( off + pkt_cnt *sizeof(ulong),                      128UL              ); aio->tx_slot_off  = off;
+  off = fd_ulong_align_up( off + tx_depth*sizeof(fd_uring_aio_tx_slot_t),     128UL              ); aio->tx_stack_off = off;
+  off = fd_ulong_align_up( off + tx_depth*sizeof(ulong),                      128UL              ); aio->rx_frame_off = off;
+  off =                    off + rx_depth*FD_URING_AIO_FRAME_SZ;                                    aio->tx_frame_off = off;
+  off = fd_ulong_align_up( off + tx_depth*FD_URING_AIO_FRAME_SZ,              FD_URING_AIO_ALIGN );
+  return off;
+}
+
+ulong
+fd_uring_aio_footprint( ulong rx_depth,
+                        ulong tx_depth,
+                        ulong pkt_cnt ) {
+  if( FD_UNLIKELY( !fd_ulong_is_pow2( rx_depth ) || rx_depth>FD_URING_AIO_RX_DEPTH_MAX ) ) return 0UL;
+  if( FD_UNLIKELY( !tx_depth || tx_depth>FD_URING_AIO_RX_DEPTH_MAX-1UL                 ) ) return 0UL;
+  if( FD_UNLIKELY( !pkt_cnt  || pkt_cnt>rx_depth                                       ) ) return 0UL;
+
+  fd_uring_aio_t scratch[1];
+  return fd_uring_aio_layout( scratch, rx_depth, tx_depth, pkt_cnt );
+}
+
+void *
+fd_uring_aio_new( void * mem,
+                  ulong  rx_depth,
+                  ulong  tx_depth,
+                  ulong  pkt_cnt ) {
+
+  if( FD_UNLIKELY( !mem ) ) {
+    FD_LOG_WARNING(( "NULL mem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)mem, fd_uring_aio_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned mem" ));
+    return NULL;
+  }
+
+  ulong footprint = fd_uring_aio_footprint( rx_depth, tx_depth, pkt_cnt );
+  if( FD_UNLIKELY( !footprint ) ) {
+    FD_LOG_WARNING(( "invalid footprint for rx_depth (%lu), tx_depth (%lu), pkt_cnt (%lu)", rx_depth, tx_depth, pkt_cnt ));
+    return NULL;
+  }
+
+  fd_memset( mem, 0, footprint );
+
+  fd_uring_aio_t * aio = (fd_uring_aio_t *)mem;
+
+  fd_uring_aio_layout( aio, rx_depth, tx_depth, pkt_cnt );
+  aio->rx_depth  = rx_depth;
+  aio->tx_depth  = tx_depth;
+  aio->pkt_depth = pkt_cnt;
+  aio->sock_fd   = -1;
+  aio->ring_fd   = -1;
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( aio->magic ) = FD_URING_AIO_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return aio;
+}
+
+/* fd_uring_aio_ring_fini destroys the io_uring instance of a join (the
+   kernel cancels any requests in flight and drops the provided buffer
+   ring registration). */
+
+static void
+fd_uring_aio_ring_fini( fd_uring_aio_t * aio ) {
+  if( aio->sqe      ) munmap( aio->sqe,      aio->sqe_sz  );
+  if( aio->ring_mem ) munmap( aio->ring_mem, aio->ring_sz );
+  if( aio->ring_fd>=0 && FD_UNLIKELY( close( aio->ring_fd ) ) )
+    FD_LOG_WARNING(( "close(ring_fd) failed (%i-%s); attempting to continue", errno, strerror( errno ) ));
+  aio->sqe      = NULL;
+  aio->ring_mem = NULL;
+  aio->ring_fd  = -1;
+}
+
+/* fd_uring_aio_submit makes SQEs written since the last call visible
+   to the kernel and submits them. */
+
+static void
+fd_uring_aio_submit( fd_uring_aio_t * aio ) {
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( *aio->sq_ktail ) = aio->sq_tail;
+  FD_COMPILER_MFENCE();
+  uint cnt = aio->sq_tail - FD_VOLATILE_CONST( *aio->sq_khead );
+  if( FD_UNLIKELY( !cnt ) ) return;
+  if( FD_UNLIKELY( fd_io_uring_enter( aio->ring_fd, cnt, 0U, 0U )<0 ) ) {
+    /* SQEs not consumed stay in the SQ and are retried on the next
+       submit */
+    if( errno!=EAGAIN && errno!=EBUSY && errno!=EINTR )
+      FD_LOG_WARNING(( "io_uring_enter failed (%i-%s)", errno, strerror( errno ) ));
+  }
+}
+
+/* fd_uring_aio_sqe returns the next free SQE (zeroed) or NULL if the SQ
+   is full. */
+
+static inline struct io_uring_sqe *
+fd_uring_aio_sqe( fd_uring_aio_t * aio ) {
+  uint head = FD_VOLATILE_CONST( *aio->sq_khead );
+  if( FD_UNLIKELY( (aio->sq_tail - head)>=aio->sq_entries ) ) return NULL;
+  struct io_uring_sqe * sqe = aio->sqe + (aio->sq_tail & aio->sq_mask);
+  fd_memset( sqe, 0, sizeof(struct io_uring_sqe) );
+  aio->sq_tail++;
+  return sqe;
+}
+
+/* fd_uring_aio_rx_arm queues the multishot receive (caller submits).
+   Returns 0 if the SQ is full. */
+
+static int
+fd_uring_aio_rx_arm( fd_uring_aio_t * aio ) {
+  struct io_uring_sqe * sqe = fd_uring_aio_sqe( aio );
+  if( FD_UNLIKELY( !sqe ) ) return 0;
+  sqe->opcode    = IORING_OP_RECVMSG;
+  sqe->fd        = aio->sock_fd;
+  sqe->addr      = (ulong)&aio->rx_msg;
+  sqe->ioprio    = IORING_RECV_MULTISHOT;
+  sqe->flags     = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = 0;
+  sqe->user_data = FD_URING_AIO_UDATA_RX;
+  aio->rx_armed  = 1;
+  return 1;
+}
+
+/* fd_uring_aio_rx_recycle gives rx buffer bid back to the kernel
+   (becomes visible on the next fd_uring_aio_rx_flush). */
+
+static inline void
+fd_uring_aio_rx_recycle( fd_uring_aio_t * aio,
+                         ulong            bid ) {
+  struct io_uring_buf * buf = aio->br->bufs + (aio->br_tail & (aio->rx_depth-1UL));
+  buf->addr = (ulong)fd_uring_aio_rx_frame( aio, bid );
+  buf->len  = (uint)FD_URING_AIO_FRAME_SZ;
+  buf->bid  = (ushort)bid;
+  aio->br_tail++;
+}
+
+static inline void
+fd_uring_aio_rx_flush( fd_uring_aio_t * aio ) {
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( aio->br->tail ) = (ushort)aio->br_tail;
+  FD_COMPILER_MFENCE();
+}
+
+fd_uring_aio_t *
+fd_uring_aio_join( void * shaio,
+                   int    sock_fd ) {
+
+  if( FD_UNLIKELY( !shaio ) ) {
+    FD_LOG_WARNING(( "NULL shaio" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shaio, fd_uring_aio_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shaio" ));
+    return NULL;
+  }
+
+  fd_uring_aio_t * aio = (fd_uring_aio_t *)shaio;
+
+  if( FD_UNLIKELY( aio->magic!=FD_URING_AIO_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic (not an fd_uring_aio_t?)" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( aio->sock_fd>=0 ) ) {
+    FD_LOG_WARNING(( "uring_aio in an unclean state, resetting" ));
+    aio->sock_fd  = -1;
+    aio->ring_fd  = -1;
+    aio->ring_mem = NULL;
+    aio->sqe      = NULL;
+    /* continue */
+  }
+
+  /* Validate the socket */
+
+  int       type;
+  socklen_t type_sz = sizeof(int);
+  if( FD_UNLIKELY( getsockopt( sock_fd, SOL_SOCKET, SO_TYPE, &type, &type_sz ) ) ) {
+    FD_LOG_WARNING(( "getsockopt(sock_fd,SO_TYPE) failed (%i-%s)", errno, strerror( errno ) ));
+    return NULL;
+  }
+
+  struct sockaddr_in laddr;
+  socklen_t          laddr_sz = sizeof(laddr);
+  if( FD_UNLIKELY( getsockname( sock_fd, fd_type_pun( &laddr ), &laddr_sz ) ) ) {
+    FD_LOG_WARNING(( "getsockname(sock_fd) failed (%i-%s)", errno, strerror( errno ) ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( type!=SOCK_DGRAM || laddr.sin_family!=AF_INET || !laddr.sin_port ) ) {
+    FD_LOG_WARNING(( "sock_fd is not a bound AF_INET SOCK_DGRAM socket" ));
+    return NULL;
+  }
+
+  int one = 1;
+  if( FD_UNLIKELY( setsockopt( sock_fd, IPPROTO_IP, IP_PKTINFO, &one, sizeof(int) ) ) ) {
+    FD_LOG_WARNING(( "setsockopt(sock_fd,IP_PKTINFO) failed (%i-%s)", errno, strerror( errno ) ));
+    return NULL;
+  }
+
+  /* Create the io_uring.  The SQ needs room for a full tx batch plus
+     the receive.  The CQ is sized such that all requests in flight can
+     complete without overflowing (the kernel would buffer overflows
+     anyway, IORING_FEAT_NODROP, but that is slow). */
+
+  ulong rx_depth = aio->rx_depth;
+  ulong tx_depth = aio->tx_depth;
+
+  struct io_uring_params params;
+  fd_memset( &params, 0, sizeof(params) );
+  params.flags      = IORING_SETUP_CQSIZE;
+  params.cq_entries = (uint)fd_ulong_pow2_up( rx_depth + tx_depth + 1UL );
+
+  int ring_fd = fd_io_uring_setup( (uint)fd_ulong_pow2_up( tx_depth + 1UL ), &params );
+  if( FD_UNLIKELY( ring_fd<0 ) ) {
+    FD_LOG_WARNING(( "io_uring_setup failed (%i-%s)", errno, strerror( errno ) ));
+    return NULL;
+  }
+  aio->ring_fd = ring_fd;
+
+  if( FD_UNLIKELY( !(params.features & IORING_FEAT_SINGLE_MMAP) ) ) {
+    FD_LOG_WARNING(( "kernel io_uring too old (no IORING_FEAT_SINGLE_MMAP)" ));
+    fd_uring_aio_ring_fini( aio );
+    return NULL;
+  }
+
+  ulong sq_sz   = params.sq_off.array + params.sq_entries*sizeof(uint);
+  ulong cq_sz   = params.cq_off.cqes  + params.cq_entries*sizeof(struct io_uring_cqe);
+  ulong ring_sz = fd_ulong_max( sq_sz, cq_sz );
+  void * ring_mem = mmap( NULL, ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, (long)IORING_OFF_SQ_RING );
+  if( FD_UNLIKELY( ring_mem==MAP_FAILED ) ) {
+    FD_LOG_WARNING(( "mmap(IORING_OFF_SQ_RING) failed (%i-%s)", errno, strerror( errno ) ));
+    fd_uring_aio_ring_fini( aio );
+    return NULL;
+  }
+  aio->ring_mem = ring_mem;
+  aio->ring_sz  = ring_sz;
+
+  ulong sqe_sz = params.sq_entries*sizeof(struct io_uring_sqe);
+  void * sqe = mmap( NULL, sqe_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, (long)IORING_OFF_SQES );
+  if( FD_UNLIKELY( sqe==MAP_FAILED ) ) {
+    FD_LOG_WARNING(( "mmap(IORING_OFF_SQES) failed (%i-%s)", errno, strerror( errno ) ));
+    fd_uring_aio_ring_fini( aio );
+    return NULL;
+  }
+  aio->sqe    = (struct io_uring_sqe *)sqe;
+  aio->sqe_sz = sqe_sz;
+
+  uchar * ring = (uchar *)ring_mem;
+  aio->sq_khead   = (uint *)(ring + params.sq_off.head);
+  aio->sq_ktail   = (uint *)(ring + params.sq_off.tail);
+  aio->sq_mask    = FD_LOAD( uint, ring + params.sq_off.ring_mask );
+  aio->sq_entries = params.sq_entries;
+  aio->sq_tail    = FD_VOLATILE_CONST( *aio->sq_ktail );
+  aio->cq_khead   = (uint *)(ring + params.cq_off.head);
+  aio->cq_ktail   = (uint *)(ring + params.cq_off.tail);
+  aio->cq_mask    = FD_LOAD( uint, ring + params.cq_off.ring_mask );
+  aio->cqe        = (struct io_uring_cqe *)(ring + params.cq_off.cqes);
+
+  /* Use an identity mapping between SQ slots and SQEs */
+
+  uint * sq_array = (uint *)(ring + params.sq_off.array);
+  for( uint i=0U; i<params.sq_entries; i++ ) sq_array[i] = i;
+
+  /* Register the rx buffers as a provided buffer ring (buffer group 0)
+     and hand all of them to the kernel */
+
+  aio->br      = (struct io_uring_buf_ring *)((ulong)aio + aio->br_off);
+  aio->br_tail = 0UL;
+  fd_memset( aio->br, 0, rx_depth*sizeof(struct io_uring_buf) );
+
+  struct io_uring_buf_reg reg;
+  fd_memset( &reg, 0, sizeof(reg) );
+  reg.ring_addr    = (ulong)aio->br;
+  reg.ring_entries = (uint)rx_depth;
+  reg.bgid         = 0;
+  if( FD_UNLIKELY( fd_io_uring_register( ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1U ) ) ) {
+    FD_LOG_WARNING(( "io_uring_register(IORING_REGISTER_PBUF_RING) failed (%i-%s)", errno, strerror( errno ) ));
+    fd_uring_aio_ring_fini( aio );
+    return NULL;
+  }
+
+  for( ulong bid=0UL; bid<rx_depth; bid++ ) fd_uring_aio_rx_recycle( aio, bid );
+  fd_uring_aio_rx_flush( aio );
+
+  /* Reset state */
+
+  aio->sock_fd     = sock_fd;
+  aio->laddr       = laddr.sin_addr.s_addr;
+  aio->lport       = laddr.sin_port;
+  aio->rx_pend_cnt = 0UL;
+
+  aio->rx_defer_cnt = 0UL;
+  aio->rx_drop_cnt  = 0UL;
+  aio->rx_nobuf_cnt = 0UL;
+  aio->tx_err_cnt   = 0UL;
+
+  fd_memset( &aio->rx_msg, 0, sizeof(struct msghdr) );
+  aio->rx_msg.msg_namelen    = (socklen_t)FD_URING_AIO_RX_NAME_SZ;
+  aio->rx_msg.msg_controllen = FD_URING_AIO_RX_CTL_SZ;
+
+  /* Add all tx slots to the free stack */
+
+  fd_uring_aio_tx_slot_t * slot = fd_uring_aio_tx_slots( aio );
+  aio->tx_stack = (ulong *)((ulong)aio + aio->tx_stack_off);
+  aio->tx_top   = 0UL;
+  for( ulong j=0UL; j<tx_depth; j++ ) {
+    fd_memset( slot + j, 0, sizeof(fd_uring_aio_tx_slot_t) );
+    slot[j].msg.msg_name    = &slot[j].addr;
+    slot[j].msg.msg_namelen = sizeof(struct sockaddr_in);
+    slot[j].msg.msg_iov     = &slot[j].iov;
+    slot[j].msg.msg_iovlen  = 1UL;
+    slot[j].iov.iov_base    = fd_uring_aio_tx_frame( aio, j );
+    slot[j].addr.sin_family = AF_INET;
+    aio->tx_stack[ aio->tx_top++ ] = j;
+  }
+
+  /* Setup local TX and RX */
+
+  fd_aio_new( &aio->tx, aio, fd_uring_aio_send );
+  fd_aio_t * rx = fd_aio_join( fd_aio_new( &aio->rx, aio, fd_uring_aio_rx_discard ) );
+  if( FD_UNLIKELY( !rx ) ) {
+    FD_LOG_WARNING(( "Failed to join rx aio" ));
+    fd_uring_aio_ring_fini( aio );
+    aio->sock_fd = -1;
+    return NULL;
+  }
+
+  /* Start receiving */
+
+  fd_uring_aio_rx_arm( aio );
+  fd_uring_aio_submit( aio );
+
+  return aio;
+}
+
+void *
+fd_uring_aio_leave( fd_uring_aio_t * aio ) {
+
+  if( FD_UNLIKELY( !aio ) ) {
+    FD_LOG_WARNING(( "NULL aio" ));
+    return NULL;
+  }
+
+  fd_uring_aio_ring_fini( aio );
+  aio->sock_fd     = -1;
+  aio->rx_armed    = 0;
+  aio->rx_pend_cnt = 0UL;
+
+  fd_aio_delete( fd_aio_leave( &aio->rx ) );
+  fd_aio_delete( fd_aio_leave( &aio->tx ) );
+
+  return (void *)aio;
+}
+
+void *
+fd_uring_aio_delete( void * shaio ) {
+
+  if( FD_UNLIKELY( !shaio ) ) {
+    FD_LOG_WARNING(( "NULL shaio" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shaio, fd_uring_aio_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shaio" ));
+    return NULL;
+  }
+
+  fd_uring_aio_t * aio = (fd_uring_aio_t *)shaio;
+
+  if( FD_UNLIKELY( aio->magic!=FD_URING_AIO_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( aio->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return (void *)aio;
+}
+
+void
+fd_uring_aio_set_rx( fd_uring_aio_t * aio,
+                     fd_aio_t const * rx ) {
+  fd_memcpy( &aio->rx, rx, sizeof(fd_aio_t) );
+}
+
+fd_aio_t const *
+fd_uring_aio_get_tx( fd_uring_aio_t const * aio ) {
+  return &aio->tx;
+}
+
+int fd_uring_aio_sock( fd_uring_aio_t const * aio ) { return aio->sock_fd; }
+
+ulong fd_uring_aio_rx_pend_cnt ( fd_uring_aio_t const * aio ) { return aio->rx_pend_cnt;  }
+ulong fd_uring_aio_rx_defer_cnt( fd_uring_aio_t const * aio ) { return aio->rx_defer_cnt; }
+ulong fd_uring_aio_rx_drop_cnt ( fd_uring_aio_t const * aio ) { return aio->rx_drop_cnt;  }
+ulong fd_uring_aio_rx_nobuf_cnt( fd_uring_aio_t const * aio ) { return aio->rx_nobuf_cnt; }
+ulong fd_uring_aio_tx_err_cnt  ( fd_uring_aio_t const * aio ) { return aio->tx_err_cnt;   }
+
+/* fd_uring_aio_rx_frame_build turns the datagram the kernel wrote into
+   rx buffer frame into an Ethernet frame in place.  Returns the
+   location of the frame and its size in *_sz, or NULL if the datagram
+   should be dropped. */
+
+static uchar *
+fd_uring_aio_rx_frame_build( fd_uring_aio_t * aio,
+                             uchar *          frame,
+                             ulong *          _sz ) {
+
+  /* Consume the kernel's metadata (the headers are written over it) */
+
+  struct io_uring_recvmsg_out const * out = (struct io_uring_recvmsg_out const *)frame;
+  ulong payload_sz = (ulong)out->payloadlen;
+  if( FD_UNLIKELY( (out->flags & MSG_TRUNC) | (out->namelen<sizeof(struct sockaddr_in)) |
+                   (payload_sz>FD_URING_AIO_RX_PAYLOAD_MAX) ) ) return NULL;
+
+  struct sockaddr_in const * src = (struct sockaddr_in const *)(out+1);
+  uint   saddr = src->sin_addr.s_addr;
+  ushort sport = src->sin_port;
+  uint   daddr = aio->laddr;
+
+  uchar const * ctl    = frame + sizeof(struct io_uring_recvmsg_out) + FD_URING_AIO_RX_NAME_SZ;
+  ulong         ctl_sz = fd_ulong_min( (ulong)out->controllen, FD_URING_AIO_RX_CTL_SZ );
+  for( ulong off=0UL; off+sizeof(struct cmsghdr)<=ctl_sz; ) {
+    struct cmsghdr const * cmsg = (struct cmsghdr const *)(ctl + off);
+    if( FD_UNLIKELY( cmsg->cmsg_len<sizeof(struct cmsghdr) ) ) break;
+    if( cmsg->cmsg_level==IPPROTO_IP && cmsg->cmsg_type==IP_PKTINFO &&
+        off+sizeof(struct cmsghdr)+sizeof(struct in_pktinfo)<=ctl_sz ) {
+      struct in_pktinfo const * info = (struct in_pktinfo const *)(cmsg+1);
+      daddr = info->ipi_addr.s_addr;
+    }
+    off += fd_ulong_align_up( cmsg->cmsg_len, sizeof(ulong) );
+  }
+
+  /* Synthesize the headers in front of the payload */
+
+  uchar *        pkt = frame + FD_URING_AIO_RX_PAYLOAD_OFF - FD_URING_AIO_HDR_SZ;
+  fd_eth_hdr_t * eth = (fd_eth_hdr_t *)pkt;
+  fd_ip4_hdr_t * ip4 = (fd_ip4_hdr_t *)(eth+1);
+  fd_udp_hdr_t * udp = (fd_udp_hdr_t *)(ip4+1);
+
+  fd_memset( eth, 0, 12UL ); /* dst and src MACs */
+  eth->net_type     = fd_ushort_bswap( FD_ETH_HDR_TYPE_IP );
+
+  ip4->ihl          = 5U;
+  ip4->version      = 4U;
+  ip4->tos          = (uchar)0;
+  ip4->net_tot_len  = fd_ushort_bswap( (ushort)(sizeof(fd_ip4_hdr_t)+sizeof(fd_udp_hdr_t)+payload_sz) );
+  ip4->net_id       = (ushort)0;
+  ip4->net_frag_off = fd_ushort_bswap( FD_IP4_HDR_FRAG_OFF_DF );
+  ip4->ttl          = (uchar)64;
+  ip4->protocol     = FD_IP4_HDR_PROTOCOL_UDP;
+  ip4->check        = (ushort)0;
+  ip4->saddr        = saddr;
+  ip4->daddr        = daddr;
+  ip4->check        = fd_ip4_hdr_check_fast( ip4 );
+
+  udp->net_sport    = sport;
+  udp->net_dport    = aio->lport;
+  udp->net_len      = fd_ushort_bswap( (ushort)(sizeof(fd_udp_hdr_t)+payload_sz) );
+  udp->check        = (ushort)0;
+
+  *_sz = FD_URING_AIO_HDR_SZ + payload_sz;
+  return pkt;
+}
+
+void
+fd_uring_aio_service( fd_uring_aio_t * aio ) {
+  fd_aio_pkt_info_t * pkt       = fd_uring_aio_pkts( aio );
+  ulong *             bid       = fd_uring_aio_bids( aio );
+  ulong               pkt_depth = aio->pkt_depth;
+  ulong               batch_cnt = aio->rx_pend_cnt;
+
+  /* Reap completions behind any frames still pending from a previous
+     service.  We stop early if the batch fills up (the remaining
+     completions are reaped next service). */
+
+  uint cq_head = FD_VOLATILE_CONST( *aio->cq_khead );
+  FD_COMPILER_MFENCE();
+  uint cq_tail = FD_VOLATILE_CONST( *aio->cq_ktail );
+  FD_COMPILER_MFENCE();
+
+  for( ; cq_head!=cq_tail; cq_head++ ) {
+    struct io_uring_cqe const * cqe = aio->cqe + (cq_head & aio->cq_mask);
+    ulong udata = (ulong)cqe->user_data;
+    int   res   = cqe->res;
+    uint  flags = cqe->flags;
+
+    if( FD_LIKELY( udata==FD_URING_AIO_UDATA_RX ) ) {
+      if( FD_UNLIKELY( (flags & IORING_CQE_F_BUFFER) && batch_cnt>=pkt_depth ) ) break;
+      if( FD_UNLIKELY( !(flags & IORING_CQE_F_MORE) ) ) aio->rx_armed = 0;
+
+      if( FD_UNLIKELY( !(flags & IORING_CQE_F_BUFFER) ) ) {
+        if( FD_LIKELY( res==-ENOBUFS ) ) aio->rx_nobuf_cnt++;
+        else if( res<0 )                 FD_LOG_WARNING(( "multishot recvmsg failed (%i-%s); rearming", -res, strerror( -res ) ));
+        continue;
+      }
+
+      ulong b = (ulong)(flags >> IORING_CQE_BUFFER_SHIFT);
+      ulong sz;
+      uchar * frame = fd_uring_aio_rx_frame_build( aio, fd_uring_aio_rx_frame( aio, b ), &sz );
+      if( FD_UNLIKELY( res<0 || !frame ) ) {
+        aio->rx_drop_cnt++;
+        fd_uring_aio_rx_recycle( aio, b );
+        continue;
+      }
+
+      pkt[ batch_cnt ] = (fd_aio_pkt_info_t) { .buf = frame, .buf_sz = (ushort)sz };
+      bid[ batch_cnt ] = b;
+      batch_cnt++;
+
+    } else {
+      if( FD_UNLIKELY( res<0 ) ) aio->tx_err_cnt++;
+      aio->tx_stack[ aio->tx_top++ ] = udata;
+    }
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( *aio->cq_khead ) = cq_head;
+  FD_COMPILER_MFENCE();
+
+  /* Forward to aio (see fd_xsk_aio_service for the pending / drop
+     semantics) */
+
+  if( batch_cnt ) {
+    ulong batch_idx = 0UL;
+    int   err       = fd_aio_send( &aio->rx, pkt, batch_cnt, &batch_idx );
+
+    ulong done_cnt = batch_cnt;
+    if( FD_UNLIKELY( err ) ) {
+      done_cnt = fd_ulong_min( batch_idx, batch_cnt );
+      if( err!=FD_AIO_ERR_AGAIN && done_cnt<batch_cnt ) {
+        done_cnt++;
+        aio->rx_drop_cnt++;
+      }
+    }
+
+    for( ulong j=0UL; j<done_cnt; j++ ) fd_uring_aio_rx_recycle( aio, bid[j] );
+
+    ulong pend_cnt = batch_cnt - done_cnt;
+    if( FD_UNLIKELY( pend_cnt ) ) {
+      memmove( bid, bid + done_cnt, pend_cnt*sizeof(ulong)             );
+      memmove( pkt, pkt + done_cnt, pend_cnt*sizeof(fd_aio_pkt_info_t) );
+      aio->rx_defer_cnt += pend_cnt;
+    }
+    aio->rx_pend_cnt = pend_cnt;
+  }
+
+  /* Give recycled buffers back to the kernel (this also covers the
+     frames dropped above) */
+
+  fd_uring_aio_rx_flush( aio );
+
+  if( FD_UNLIKELY( !aio->rx_armed ) ) {
+    fd_uring_aio_rx_arm( aio );
+    fd_uring_aio_submit( aio );
+  }
+}
+
+/* fd_uring_aio_send is an aio callback that sends the given batch of
+   frames through the socket. */
+
+static int
+fd_uring_aio_send( void *                    ctx,
+                   fd_aio_pkt_info_t const * pkt,
+                   ulong                     pkt_cnt,
+                   ulong *                   opt_batch_idx ) {
+  if( FD_UNLIKELY( pkt_cnt==0UL ) ) return FD_AIO_SUCCESS;
+
+  fd_uring_aio_t *         aio  = (fd_uring_aio_t *)ctx;
+  fd_uring_aio_tx_slot_t * slot = fd_uring_aio_tx_slots( aio );
+
+  int   err = FD_AIO_SUCCESS;
+  ulong pkt_idx;
+  for( pkt_idx=0UL; pkt_idx<pkt_cnt; pkt_idx++ ) {
+    uchar const * data    = (uchar const *)pkt[ pkt_idx ].buf;
+    ulong         data_sz = (ulong)pkt[ pkt_idx ].buf_sz;
+    if( FD_UNLIKELY( !data_sz ) ) continue;
+
+    /* Find the destination and the payload */
+
+    fd_eth_hdr_t const * eth = (fd_eth_hdr_t const *)data;
+    fd_ip4_hdr_t const * ip4 = (fd_ip4_hdr_t const *)(eth+1);
+    if( FD_UNLIKELY( (data_sz<FD_URING_AIO_HDR_SZ) | (eth->net_type!=fd_ushort_bswap( FD_ETH_HDR_TYPE_IP )) |
+                     (ip4->version!=4U) | (ip4->ihl<5U) | (ip4->protocol!=FD_IP4_HDR_PROTOCOL_UDP) ) ) {
+      err = FD_AIO_ERR_INVAL;
+      break;
+    }
+    ulong                udp_off = sizeof(fd_eth_hdr_t) + 4UL*(ulong)ip4->ihl;
+    fd_udp_hdr_t const * udp     = (fd_udp_hdr_t const *)(data + udp_off);
+    ulong                udp_sz  = (ulong)fd_ushort_bswap( udp->net_len );
+    if( FD_UNLIKELY( (udp_off+sizeof(fd_udp_hdr_t)>data_sz) ||
+                     (udp_sz<sizeof(fd_udp_hdr_t)) | (udp_off+udp_sz>data_sz) ) ) {
+      err = FD_AIO_ERR_INVAL;
+      break;
+    }
+    ulong payload_sz = udp_sz - sizeof(fd_udp_hdr_t);
+    if( FD_UNLIKELY( payload_sz>FD_URING_AIO_TX_PAYLOAD_MAX ) ) {
+      FD_LOG_WARNING(( "payload too large for uring_aio (%lu > %lu), aborting send", payload_sz, FD_URING_AIO_TX_PAYLOAD_MAX ));
+      err = FD_AIO_ERR_INVAL;
+      break;
+    }
+
+    /* Get a tx slot and an SQE */
+
+    if( FD_UNLIKELY( !aio->tx_top ) ) { err = FD_AIO_ERR_AGAIN; break; }
+    struct io_uring_sqe * sqe = fd_uring_aio_sqe( aio );
+    if( FD_UNLIKELY( !sqe ) ) { err = FD_AIO_ERR_AGAIN; break; }
+    ulong s = aio->tx_stack[ --aio->tx_top ];
+
+    fd_memcpy( slot[s].iov.iov_base, udp+1, payload_sz );
+    slot[s].iov.iov_len          = payload_sz;
+    slot[s].addr.sin_addr.s_addr = ip4->daddr;
+    slot[s].addr.sin_port        = udp->net_dport;
+
+    sqe->opcode    = IORING_OP_SENDMSG;
+    sqe->fd        = aio->sock_fd;
+    sqe->addr      = (ulong)&slot[s].msg;
+    sqe->len       = 1U;
+    sqe->user_data = s;
+  }
+
+  fd_uring_aio_submit( aio );
+
+  if( FD_UNLIKELY( err ) && FD_LIKELY( opt_batch_idx ) ) *opt_batch_idx = pkt_idx;
+  return err;
+}
@@ -0,0 +1,169 @@
+#ifndef HEADER_fd_src_tango_uring_fd_uring_aio_h
+#define HEADER_fd_src_tango_uring_fd_uring_aio_h
+
+#if defined(__linux__) && FD_HAS_IO_URING
+
+#include "../aio/fd_aio.h"
+
+/* fd_uring_aio_t is an fd_aio driver for UDP/IP4 sockets built on
+   io_uring.  It is intended for hosts where AF_XDP (fd_xsk_aio) is not
+   available.  Datagrams are received with a single multishot recvmsg
+   into a ring of kernel provided buffers and sent with batches of
+   sendmsg requests submitted with one syscall per aio send.
+
+   To be interchangeable with fd_xsk_aio, packets crossing the aio
+   boundary are raw Ethernet frames holding a UDP/IP4 datagram:
+
+   - Received datagrams are handed to the rx aio with a synthesized
+     Ethernet (zero MACs), IP4 (no options, valid header checksum) and
+     UDP (no checksum) header in front of the payload.  The source is
+     the datagram's sender and the destination the local address the
+     datagram was received on.
+
+   - Frames sent through the tx aio are parsed for the IP4 destination
+     address and UDP destination port and their UDP payload is sent to
+     that destination through the socket.  The Ethernet and IP4 source
+     fields of the frame are ignored (the socket's local address is
+     used).  VLAN tagged frames and IP4 options are not supported.
+
+   May not be shared across thread groups. */
+
+#define FD_URING_AIO_ALIGN (4096UL)
+
+/* FD_URING_AIO_FRAME_SZ is the size of each rx and tx buffer.
+   FD_URING_AIO_RX_PAYLOAD_MAX is the largest UDP payload that can be
+   received (larger datagrams are dropped) and FD_URING_AIO_TX_PAYLOAD_MAX
+   the largest that can be sent. */
+
+#define FD_URING_AIO_FRAME_SZ       (2048UL)
+#define FD_URING_AIO_RX_PAYLOAD_MAX (FD_URING_AIO_FRAME_SZ-64UL)
+#define FD_URING_AIO_TX_PAYLOAD_MAX (FD_URING_AIO_FRAME_SZ)
+
+/* FD_URING_AIO_RX_DEPTH_MAX is the largest number of rx buffers
+   supported (a limit of io_uring provided buffer rings). */
+
+#define FD_URING_AIO_RX_DEPTH_MAX (32768UL)
+
+struct fd_uring_aio_private;
+typedef struct fd_uring_aio_private fd_uring_aio_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_uring_aio_{align,footprint} return the required alignment and
+   footprint of a memory region suitable for use as an fd_uring_aio_t
+   where rx_depth is the number of rx buffers (an integer power of 2 in
+   [1,FD_URING_AIO_RX_DEPTH_MAX]), tx_depth is the number of sends that
+   can be in flight and pkt_cnt is the max number of packets to handle
+   per fd_uring_aio_service() operation (in [1,rx_depth]).  footprint
+   silently returns 0 if the parameters are invalid. */
+
+FD_FN_CONST ulong
+fd_uring_aio_align( void );
+
+FD_FN_CONST ulong
+fd_uring_aio_footprint( ulong rx_depth,
+                        ulong tx_depth,
+                        ulong pkt_cnt );
+
+/* fd_uring_aio_new formats an unused memory region for use as an
+   fd_uring_aio_t.  mem must point to a memory region that matches
+   fd_uring_aio_align() and fd_uring_aio_footprint().  Returns handle
+   suitable for fd_uring_aio_join() on success and NULL on failure (logs
+   details). */
+
+void *
+fd_uring_aio_new( void * mem,
+                  ulong  rx_depth,
+                  ulong  tx_depth,
+                  ulong  pkt_cnt );
+
+/* fd_uring_aio_join joins the caller to the uring_aio and starts
+   receiving on sock_fd.  sock_fd should be a bound AF_INET SOCK_DGRAM
+   socket that outlives the join (the join enables IP_PKTINFO on it).
+   Creates an io_uring instance for the join, registers the rx buffers
+   with it and arms the multishot receive.  Returns a pointer in the
+   local address space to the fd_uring_aio_t on success or NULL on
+   failure (logs details).  Reasons for failure include an unsuitable
+   sock_fd or a kernel without io_uring provided buffer ring support
+   (Linux 5.19 or newer) or with io_uring disabled.  There may be only
+   one active join for a single fd_uring_aio_t at any given time. */
+
+fd_uring_aio_t *
+fd_uring_aio_join( void * shaio,
+                   int    sock_fd );
+
+/* fd_uring_aio_leave leaves a current local join.  The io_uring
+   instance is destroyed (cancelling any sends still in flight) and
+   frames pending for the rx aio are discarded.  The socket is not
+   closed.  Returns a pointer to the underlying memory region on success
+   and NULL on failure (logs details). */
+
+void *
+fd_uring_aio_leave( fd_uring_aio_t * aio );
+
+/* fd_uring_aio_delete unformats a memory region used as an
+   fd_uring_aio_t.  Assumes nobody is joined to the region.  Returns a
+   pointer to the underlying memory region or NULL if used obviously in
+   error. */
+
+void *
+fd_uring_aio_delete( void * shaio );
+
+/* fd_uring_aio_set_rx sets the fd_aio_t instance called back with
+   received frames during fd_uring_aio_service.  Until set, received
+   frames are discarded. */
+
+void
+fd_uring_aio_set_rx( fd_uring_aio_t * aio,
+                     fd_aio_t const * rx );
+
+/* fd_uring_aio_get_tx gets the fd_aio_t instance to send frames out
+   through the socket.  Each aio send does at most one io_uring_enter
+   syscall.  Payloads are copied such that the caller's buffers are
+   free on return.  Yields FD_AIO_ERR_AGAIN if all tx_depth sends are in
+   flight (completions are reaped by fd_uring_aio_service).  Yields
+   FD_AIO_ERR_INVAL for a frame that is not a UDP/IP4 datagram or with a
+   payload larger than FD_URING_AIO_TX_PAYLOAD_MAX (frames before it in
+   the batch are sent). */
+
+FD_FN_CONST fd_aio_t const *
+fd_uring_aio_get_tx( fd_uring_aio_t const * aio );
+
+/* fd_uring_aio_sock returns the socket aio is joined to (-1 if not
+   joined). */
+
+FD_FN_PURE int
+fd_uring_aio_sock( fd_uring_aio_t const * aio );
+
+/* fd_uring_aio_{rx_pend,rx_defer,rx_drop,rx_nobuf,tx_err}_cnt return
+   the diagnostics of aio.  rx_pend_cnt, rx_defer_cnt and rx_drop_cnt
+   have the same meaning as their fd_xsk_aio counterparts (rx_drop_cnt
+   also counts datagrams larger than FD_URING_AIO_RX_PAYLOAD_MAX).
+   rx_nobuf_cnt is the number of times the kernel found no rx buffer
+   available (datagrams are queued in the socket, and dropped by the
+   kernel when its receive buffer is full).  tx_err_cnt is the number
+   of sends the kernel failed.  These accumulate over the lifetime of
+   the join. */
+
+FD_FN_PURE ulong fd_uring_aio_rx_pend_cnt ( fd_uring_aio_t const * aio );
+FD_FN_PURE ulong fd_uring_aio_rx_defer_cnt( fd_uring_aio_t const * aio );
+FD_FN_PURE ulong fd_uring_aio_rx_drop_cnt ( fd_uring_aio_t const * aio );
+FD_FN_PURE ulong fd_uring_aio_rx_nobuf_cnt( fd_uring_aio_t const * aio );
+FD_FN_PURE ulong fd_uring_aio_tx_err_cnt  ( fd_uring_aio_t const * aio );
+
+/* fd_uring_aio_service reaps io_uring completions.  Received frames
+   are handed to the rx aio in one batch (at most pkt_cnt frames, oldest
+   first) with the same pending / drop semantics as fd_xsk_aio_service
+   (buffers of pending frames are not returned to the kernel until
+   accepted).  Completed sends free their tx buffers.  Rearms the
+   multishot receive if the kernel terminated it (e.g. it ran out of
+   buffers).  Does not block and does no syscalls unless the receive
+   needs rearming. */
+
+void
+fd_uring_aio_service( fd_uring_aio_t * aio );
+
+FD_PROTOTYPES_END
+
+#endif /* defined(__linux__) && FD_HAS_IO_URING */
+#endif /* HEADER_fd_src_tango_uring_fd_uring_aio_h */
@@ -0,0 +1,380 @@
+/* test_uring_aio: Unit tests for fd_uring_aio_t.  Exchanges datagrams
+   over loopback between a socket driven by an fd_uring_aio_t and a
+   plain socket.  Skipped if io_uring is not available (e.g. disabled
+   by the kernel or a sandbox). */
+
+#define _GNU_SOURCE
+
+#include "fd_uring_aio.h"
+#include "../../util/fd_util.h"
+#include "../../util/net/fd_eth.h"
+#include "../../util/net/fd_udp.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <linux/io_uring.h>
+
+#define RX_DEPTH (16UL)
+#define TX_DEPTH (8UL)
+#define PKT_CNT  (8UL)
+
+static uchar _aio[ 1UL<<20 ] __attribute__((aligned(FD_URING_AIO_ALIGN)));
+
+#define HDR_SZ (sizeof(fd_eth_hdr_t)+sizeof(fd_ip4_hdr_t)+sizeof(fd_udp_hdr_t))
+
+/* Datagram k sent in a test has payload size dgram_sz( k ) and bytes
+   dgram_byte( k, j ) */
+
+static inline ulong dgram_sz  ( ulong k )          { return (k*37UL) % (FD_URING_AIO_RX_PAYLOAD_MAX+1UL); }
+static inline uchar dgram_byte( ulong k, ulong j ) { return (uchar)(k*7UL+j); }
+
+static ulong
+dgram_fill( uchar * buf,
+            ulong   k ) {
+  ulong sz = dgram_sz( k );
+  for( ulong j=0UL; j<sz; j++ ) buf[j] = dgram_byte( k, j );
+  return sz;
+}
+
+static int
+dgram_check( uchar const * buf,
+             ulong         sz,
+             ulong         k ) {
+  if( sz!=dgram_sz( k ) ) return 0;
+  for( ulong j=0UL; j<sz; j++ ) if( buf[j]!=dgram_byte( k, j ) ) return 0;
+  return 1;
+}
+
+/* test_rx is the rx aio of the tests.  It validates received frames
+   are the datagrams sent by the peer (in order) and accepts at most
+   accept_max frames per call. */
+
+struct test_rx {
+  ulong  accept_max;
+  ulong  rx_cnt;     /* number of frames accepted */
+  uint   saddr;      /* expected addresses / ports */
+  uint   daddr;
+  ushort net_sport;
+  ushort net_dport;
+};
+
+typedef struct test_rx test_rx_t;
+
+static int
+test_rx_send( void *                    ctx,
+              fd_aio_pkt_info_t const * batch,
+              ulong                     batch_cnt,
+              ulong *                   opt_batch_idx ) {
+  test_rx_t * rx = (test_rx_t *)ctx;
+
+  ulong accept_cnt = fd_ulong_min( batch_cnt, rx->accept_max );
+  for( ulong i=0UL; i<accept_cnt; i++ ) {
+    uchar const *        pkt = (uchar const *)batch[i].buf;
+    ulong                sz  = (ulong)batch[i].buf_sz;
+    FD_TEST( sz>=HDR_SZ );
+    fd_eth_hdr_t const * eth = (fd_eth_hdr_t const *)pkt;
+    fd_ip4_hdr_t const * ip4 = (fd_ip4_hdr_t const *)(eth+1);
+    fd_udp_hdr_t const * udp = (fd_udp_hdr_t const *)(ip4+1);
+    FD_TEST( eth->net_type==fd_ushort_bswap( FD_ETH_HDR_TYPE_IP ) );
+    FD_TEST( ip4->version==4U && ip4->ihl==5U );
+    FD_TEST( ip4->protocol==FD_IP4_HDR_PROTOCOL_UDP );
+    FD_TEST( !fd_ip4_hdr_check( ip4 ) );
+    FD_TEST( (ulong)fd_ushort_bswap( ip4->net_tot_len )==sz-sizeof(fd_eth_hdr_t) );
+    FD_TEST( ip4->saddr==rx->saddr && ip4->daddr==rx->daddr );
+    FD_TEST( udp->net_sport==rx->net_sport && udp->net_dport==rx->net_dport );
+    FD_TEST( (ulong)fd_ushort_bswap( udp->net_len )==sz-sizeof(fd_eth_hdr_t)-sizeof(fd_ip4_hdr_t) );
+    FD_TEST( dgram_check( pkt+HDR_SZ, sz-HDR_SZ, rx->rx_cnt ) );
+    rx->rx_cnt++;
+  }
+
+  if( FD_UNLIKELY( accept_cnt<batch_cnt ) ) {
+    if( opt_batch_idx ) *opt_batch_idx = accept_cnt;
+    return FD_AIO_ERR_AGAIN;
+  }
+  return FD_AIO_SUCCESS;
+}
+
+/* service_until services aio until *cnt reaches target (fails the test
+   if that doesn't happen within a second) */
+
+static void
+service_until( fd_uring_aio_t *      aio,
+               ulong const volatile * cnt,
+               ulong                  target ) {
+  long deadline = fd_log_wallclock() + (long)1e9;
+  while( *cnt<target ) {
+    fd_uring_aio_service( aio );
+    FD_TEST( fd_log_wallclock()<deadline );
+  }
+}
+
+static int
+test_sock( uint addr ) {
+  int fd = socket( AF_INET, SOCK_DGRAM, 0 );
+  FD_TEST( fd>=0 );
+  struct sockaddr_in sa = { .sin_family = AF_INET, .sin_port = 0, .sin_addr = { .s_addr = addr } };
+  FD_TEST( !bind( fd, fd_type_pun( &sa ), sizeof(sa) ) );
+  return fd;
+}
+
+static struct sockaddr_in
+test_sock_addr( int fd ) {
+  struct sockaddr_in sa;
+  socklen_t          sa_sz = sizeof(sa);
+  FD_TEST( !getsockname( fd, fd_type_pun( &sa ), &sa_sz ) );
+  return sa;
+}
+
+static void
+peer_send( int                        fd,
+           struct sockaddr_in const * dst,
+           ulong                      k0,
+           ulong                      cnt ) {
+  static uchar buf[ FD_URING_AIO_FRAME_SZ ];
+  for( ulong k=k0; k<k0+cnt; k++ ) {
+    ulong sz = dgram_fill( buf, k );
+    FD_TEST( sendto( fd, buf, sz, 0, fd_type_pun_const( dst ), sizeof(*dst) )==(long)sz );
+  }
+}
+
+/* test_frame builds an Ethernet frame carrying datagram k to dst */
+
+static ulong
+test_frame( uchar *                    frame,
+            struct sockaddr_in const * dst,
+            ulong                      k ) {
+  fd_eth_hdr_t * eth = (fd_eth_hdr_t *)frame;
+  fd_ip4_hdr_t * ip4 = (fd_ip4_hdr_t *)(eth+1);
+  fd_udp_hdr_t * udp = (fd_udp_hdr_t *)(ip4+1);
+  ulong          sz  = dgram_fill( (uchar *)(udp+1), k );
+  fd_memset( eth, 0, sizeof(fd_eth_hdr_t) );
+  eth->net_type     = fd_ushort_bswap( FD_ETH_HDR_TYPE_IP );
+  fd_memset( ip4, 0, sizeof(fd_ip4_hdr_t) );
+  ip4->ihl          = 5U;
+  ip4->version      = 4U;
+  ip4->net_tot_len  = fd_ushort_bswap( (ushort)(sizeof(fd_ip4_hdr_t)+sizeof(fd_udp_hdr_t)+sz) );
+  ip4->ttl          = (uchar)64;
+  ip4->protocol     = FD_IP4_HDR_PROTOCOL_UDP;
+  ip4->saddr        = FD_IP4_ADDR( 10, 0, 0, 1 ); /* ignored */
+  ip4->daddr        = dst->sin_addr.s_addr;
+  ip4->check        = fd_ip4_hdr_check( ip4 );
+  udp->net_sport    = fd_ushort_bswap( (ushort)9 ); /* ignored */
+  udp->net_dport    = dst->sin_port;
+  udp->net_len      = fd_ushort_bswap( (ushort)(sizeof(fd_udp_hdr_t)+sz) );
+  udp->check        = (ushort)0;
+  return HDR_SZ + sz;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  /* Footprint / new */
+
+  FD_TEST( fd_uring_aio_align()==FD_URING_AIO_ALIGN );
+  FD_TEST( !fd_uring_aio_footprint( 0UL,                             TX_DEPTH, PKT_CNT  ) );
+  FD_TEST( !fd_uring_aio_footprint( 3UL,                             TX_DEPTH, 1UL      ) );
+  FD_TEST( !fd_uring_aio_footprint( FD_URING_AIO_RX_DEPTH_MAX*2UL,   TX_DEPTH, PKT_CNT  ) );
+  FD_TEST( !fd_uring_aio_footprint( RX_DEPTH,                        0UL,      PKT_CNT  ) );
+  FD_TEST( !fd_uring_aio_footprint( RX_DEPTH,                        TX_DEPTH, 0UL      ) );
+  FD_TEST( !fd_uring_aio_footprint( RX_DEPTH,                        TX_DEPTH, RX_DEPTH+1UL ) );
+
+  ulong footprint = fd_uring_aio_footprint( RX_DEPTH, TX_DEPTH, PKT_CNT );
+  FD_TEST( footprint && fd_ulong_is_aligned( footprint, FD_URING_AIO_ALIGN ) && footprint<=sizeof(_aio) );
+
+  FD_TEST( !fd_uring_aio_new( NULL,      RX_DEPTH, TX_DEPTH, PKT_CNT ) ); /* NULL mem */
+  FD_TEST( !fd_uring_aio_new( _aio+64UL, RX_DEPTH, TX_DEPTH, PKT_CNT ) ); /* misaligned */
+  FD_TEST( !fd_uring_aio_new( _aio,      RX_DEPTH, 0UL,      PKT_CNT ) ); /* bad footprint */
+  void * shaio = fd_uring_aio_new( _aio, RX_DEPTH, TX_DEPTH, PKT_CNT );
+  FD_TEST( shaio==_aio );
+
+  /* Probe io_uring */
+
+  struct io_uring_params params;
+  fd_memset( &params, 0, sizeof(params) );
+  int probe_fd = (int)syscall( __NR_io_uring_setup, 1U, &params );
+  if( FD_UNLIKELY( probe_fd<0 ) ) {
+    FD_LOG_WARNING(( "skip: io_uring unavailable (%i-%s)", errno, strerror( errno ) ));
+    FD_TEST( fd_uring_aio_delete( shaio )==shaio );
+    fd_halt();
+    return 0;
+  }
+  close( probe_fd );
+
+  /* Join */
+
+  uint lo = FD_IP4_ADDR( 127, 0, 0, 1 );
+
+  int sock_tcp = socket( AF_INET, SOCK_STREAM, 0 ); FD_TEST( sock_tcp>=0 );
+  int sock_unb = socket( AF_INET, SOCK_DGRAM,  0 ); FD_TEST( sock_unb>=0 );
+  FD_TEST( !fd_uring_aio_join( NULL,  sock_unb ) ); /* NULL shaio */
+  FD_TEST( !fd_uring_aio_join( shaio, -1       ) ); /* bad fd */
+  FD_TEST( !fd_uring_aio_join( shaio, sock_tcp ) ); /* not a datagram socket */
+  FD_TEST( !fd_uring_aio_join( shaio, sock_unb ) ); /* not bound */
+  close( sock_tcp );
+  close( sock_unb );
+
+  int sock = test_sock( lo );
+  int peer = test_sock( lo );
+  struct sockaddr_in sock_addr = test_sock_addr( sock );
+  struct sockaddr_in peer_addr = test_sock_addr( peer );
+
+  struct timeval tv = { .tv_sec = 1, .tv_usec = 0 };
+  FD_TEST( !setsockopt( peer, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) ) );
+
+  fd_uring_aio_t * aio = fd_uring_aio_join( shaio, sock );
+  FD_TEST( aio );
+  FD_TEST( fd_uring_aio_sock( aio )==sock );
+
+  /* Frames received before an rx aio is set are discarded */
+
+  peer_send( peer, &sock_addr, 0UL, 4UL );
+  long deadline = fd_log_wallclock() + (long)10e6;
+  while( fd_log_wallclock()<deadline ) fd_uring_aio_service( aio );
+
+  test_rx_t rx[1] = {{
+    .accept_max = ULONG_MAX,
+    .rx_cnt     = 0UL,
+    .saddr      = lo,
+    .daddr      = lo,
+    .net_sport  = peer_addr.sin_port,
+    .net_dport  = sock_addr.sin_port
+  }};
+  fd_aio_t _rx_aio[1];
+  fd_aio_t * rx_aio = fd_aio_join( fd_aio_new( _rx_aio, rx, test_rx_send ) ); FD_TEST( rx_aio );
+  fd_uring_aio_set_rx( aio, rx_aio );
+
+  /* Receive many more datagrams than rx buffers (in bursts that fit in
+     the socket receive buffer) */
+
+  ulong const rx_total = 4096UL;
+  for( ulong k=0UL; k<rx_total; k+=RX_DEPTH ) {
+    peer_send( peer, &sock_addr, k, RX_DEPTH );
+    service_until( aio, &rx->rx_cnt, k+RX_DEPTH );
+  }
+  FD_TEST( rx->rx_cnt==rx_total );
+  FD_TEST( !fd_uring_aio_rx_pend_cnt( aio ) && !fd_uring_aio_rx_drop_cnt( aio ) );
+
+  /* Datagrams too large for the rx buffers are dropped */
+
+  do {
+    static uchar big[ FD_URING_AIO_RX_PAYLOAD_MAX+1UL ];
+    FD_TEST( sendto( peer, big, sizeof(big), 0, fd_type_pun_const( &sock_addr ), sizeof(sock_addr) )==(long)sizeof(big) );
+    peer_send( peer, &sock_addr, rx->rx_cnt, 1UL );
+    service_until( aio, &rx->rx_cnt, rx_total+1UL );
+    FD_TEST( fd_uring_aio_rx_drop_cnt( aio )==1UL );
+  } while(0);
+
+  /* Backpressure: frames not accepted are kept pending and redelivered
+     in order */
+
+  ulong rx_base = rx->rx_cnt;
+  rx->accept_max = 1UL;
+  peer_send( peer, &sock_addr, rx_base, PKT_CNT );
+  service_until( aio, &rx->rx_cnt, rx_base+PKT_CNT );
+  FD_TEST( fd_uring_aio_rx_defer_cnt( aio )>0UL );
+  FD_TEST( !fd_uring_aio_rx_pend_cnt( aio ) );
+
+  /* A consumer that accepts nothing starves the kernel of rx buffers.
+     The datagrams stay in the socket and are received once the
+     consumer resumes. */
+
+  rx_base = rx->rx_cnt;
+  rx->accept_max = 0UL;
+  peer_send( peer, &sock_addr, rx_base, 2UL*RX_DEPTH );
+  deadline = fd_log_wallclock() + (long)1e9;
+  while( fd_uring_aio_rx_pend_cnt( aio )<PKT_CNT ) {
+    fd_uring_aio_service( aio );
+    FD_TEST( fd_log_wallclock()<deadline );
+  }
+  FD_TEST( rx->rx_cnt==rx_base );
+  rx->accept_max = ULONG_MAX;
+  service_until( aio, &rx->rx_cnt, rx_base+2UL*RX_DEPTH );
+  FD_TEST( fd_uring_aio_rx_nobuf_cnt( aio )>0UL );
+  FD_TEST( fd_uring_aio_rx_drop_cnt ( aio )==1UL );
+
+  FD_LOG_NOTICE(( "rx: cnt %lu defer_cnt %lu drop_cnt %lu nobuf_cnt %lu", rx->rx_cnt,
+                  fd_uring_aio_rx_defer_cnt( aio ), fd_uring_aio_rx_drop_cnt( aio ), fd_uring_aio_rx_nobuf_cnt( aio ) ));
+
+  /* Transmit batches larger than tx_depth */
+
+  fd_aio_t const * tx_aio = fd_uring_aio_get_tx( aio );
+  FD_TEST( tx_aio );
+
+  static uchar frame[ 4UL*TX_DEPTH ][ FD_URING_AIO_FRAME_SZ ];
+  fd_aio_pkt_info_t batch[ 4UL*TX_DEPTH ];
+  ulong const tx_cnt = 4UL*TX_DEPTH;
+  for( ulong k=0UL; k<tx_cnt; k++ ) {
+    batch[k].buf    = frame[k];
+    batch[k].buf_sz = (ushort)test_frame( frame[k], &peer_addr, k );
+  }
+  batch[1].buf_sz = (ushort)0; /* Empty frames are ignored */
+
+  ulong tx_idx = 0UL;
+  deadline = fd_log_wallclock() + (long)1e9;
+  while( tx_idx<tx_cnt ) {
+    ulong batch_idx = ULONG_MAX;
+    int   err       = fd_aio_send( tx_aio, batch+tx_idx, tx_cnt-tx_idx, &batch_idx );
+    if( !err ) break;
+    FD_TEST( err==FD_AIO_ERR_AGAIN );
+    FD_TEST( batch_idx<=tx_cnt-tx_idx );
+    tx_idx += batch_idx;
+    fd_uring_aio_service( aio );
+    FD_TEST( fd_log_wallclock()<deadline );
+  }
+
+  static uchar buf[ FD_URING_AIO_FRAME_SZ ];
+  for( ulong k=0UL; k<tx_cnt; k++ ) {
+    if( k==1UL ) continue;
+    struct sockaddr_in src;
+    socklen_t          src_sz = sizeof(src);
+    long sz = recvfrom( peer, buf, sizeof(buf), 0, fd_type_pun( &src ), &src_sz );
+    FD_TEST( sz>=0L );
+    FD_TEST( dgram_check( buf, (ulong)sz, k ) );
+    FD_TEST( src.sin_addr.s_addr==lo && src.sin_port==sock_addr.sin_port );
+  }
+  FD_TEST( !fd_uring_aio_tx_err_cnt( aio ) );
+
+  /* Malformed frames abort the batch at the frame */
+
+  do {
+    ulong batch_idx;
+    FD_TEST( !fd_aio_send( tx_aio, batch, 0UL, NULL ) );
+
+    batch[1].buf_sz = (ushort)test_frame( frame[1], &peer_addr, 1UL );
+    fd_eth_hdr_t * eth = (fd_eth_hdr_t *)frame[1];
+    eth->net_type = fd_ushort_bswap( FD_ETH_HDR_TYPE_ARP );
+    batch_idx = ULONG_MAX;
+    FD_TEST( fd_aio_send( tx_aio, batch, 2UL, &batch_idx )==FD_AIO_ERR_INVAL );
+    FD_TEST( batch_idx==1UL );
+
+    batch[1].buf_sz = (ushort)(HDR_SZ-1UL);
+    eth->net_type   = fd_ushort_bswap( FD_ETH_HDR_TYPE_IP );
+    batch_idx = ULONG_MAX;
+    FD_TEST( fd_aio_send( tx_aio, batch+1, 1UL, &batch_idx )==FD_AIO_ERR_INVAL );
+    FD_TEST( batch_idx==0UL );
+
+    /* The frame before the bad one was sent */
+    long sz = recvfrom( peer, buf, sizeof(buf), 0, NULL, NULL );
+    FD_TEST( sz>=0L && dgram_check( buf, (ulong)sz, 0UL ) );
+  } while(0);
+
+  /* Clean up */
+
+  FD_TEST( fd_uring_aio_leave( aio )==shaio );
+  FD_TEST( fd_uring_aio_sock( (fd_uring_aio_t const *)shaio )==-1 );
+  FD_TEST( fd_uring_aio_delete( shaio )==shaio );
+  FD_TEST( !fd_uring_aio_join( shaio, sock ) ); /* bad magic */
+
+  fd_aio_delete( fd_aio_leave( rx_aio ) );
+  close( peer );
+  close( sock );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
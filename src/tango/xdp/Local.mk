@@ -1,10 +1,16 @@
 $(call add-hdrs,fd_xdp_redirect_prog.h)
 
+ifdef FD_HAS_HOSTED
+$(call make-unit-test,test_xdp_redirect_prog,test_xdp_redirect_prog,fd_util)
+$(call run-unit-test,test_xdp_redirect_prog)
+endif
+
 ifdef FD_HAS_HOSTED
 ifdef FD_HAS_LIBBPF
 $(call make-lib,fd_xdp)
-$(call add-hdrs,fd_xdp.h fd_xsk.h fd_xsk_aio.h fd_xdp_redirect_user.h)
-$(call add-objs,fd_xsk fd_xsk_aio fd_xdp_redirect_user,fd_xdp)
+$(call add-hdrs,fd_xdp.h fd_xsk.h fd_xsk_aio.h fd_xdp_redirect_user.h fd_xdp_iface.h)
+$(call add-objs,fd_xsk fd_xsk_aio fd_xdp_redirect_user fd_xdp_iface,fd_xdp)
+$(call make-bin,fd_xdp_ctl,fd_xdp_ctl,fd_xdp fd_util)
 
 $(call make-unit-test,test_xsk,test_xsk,fd_xdp fd_util)
 $(call run-unit-test,test_xsk)
@@ -7,5 +7,6 @@
 #include "fd_xsk.h"               /* XSKs (AF_XDP sockets)              */
 #include "fd_xsk_aio.h"           /* fd_aio driver for fd_xsk           */
 #include "fd_xdp_redirect_user.h" /* XDP redirect program userspace API */
+#include "fd_xdp_iface.h"         /* Network device RX queue / RSS info  */
 
 #endif /* HEADER_fd_src_tango_xdp_fd_xdp_h */
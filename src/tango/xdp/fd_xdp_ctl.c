@@ -0,0 +1,264 @@
+#include "fd_xdp.h"
+
+#if FD_HAS_HOSTED && defined(__linux__) && FD_HAS_LIBBPF
+
+#include <stdio.h>
+#include <errno.h>
+
+FD_IMPORT_CSTR( fd_xdp_ctl_help, "src/tango/xdp/fd_xdp_ctl_help" );
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+# define SHIFT(n) argv+=(n),argc-=(n)
+
+  if( FD_UNLIKELY( argc<1 ) ) FD_LOG_ERR(( "no arguments" ));
+  char const * bin = argv[0];
+  SHIFT(1);
+
+  int cnt = 0;
+  while( argc ) {
+    char const * cmd = argv[0];
+    SHIFT(1);
+
+    if( !strcmp( cmd, "help" ) ) {
+
+      fputs( fd_xdp_ctl_help, stdout );
+
+      FD_LOG_NOTICE(( "%i: %s: success", cnt, cmd ));
+
+    } else if( !strcmp( cmd, "init" ) ) {
+
+      if( FD_UNLIKELY( argc<1 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * app = argv[0];
+
+      if( FD_UNLIKELY( fd_xdp_init( app ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_init( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, app, bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s: success", cnt, cmd, app ));
+      SHIFT(1);
+
+    } else if( !strcmp( cmd, "fini" ) ) {
+
+      if( FD_UNLIKELY( argc<1 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * app = argv[0];
+
+      if( FD_UNLIKELY( fd_xdp_fini( app ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_fini( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, app, bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s: success", cnt, cmd, app ));
+      SHIFT(1);
+
+    } else if( !strcmp( cmd, "hook-iface" ) ) {
+
+      if( FD_UNLIKELY( argc<4 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * app    = argv[0];
+      char const * ifname = argv[1];
+      char const * _mode  = argv[2];
+      char const * prog   = argv[3];
+
+      uint mode;
+      if(      !strcmp( _mode, "default" ) ) mode = 0U;
+      else if( !strcmp( _mode, "skb"     ) ) mode = XDP_FLAGS_SKB_MODE;
+      else if( !strcmp( _mode, "drv"     ) ) mode = XDP_FLAGS_DRV_MODE;
+      else if( !strcmp( _mode, "hw"      ) ) mode = XDP_FLAGS_HW_MODE;
+      else FD_LOG_ERR(( "%i: %s: unsupported mode \"%s\"\n\tDo %s help for help", cnt, cmd, _mode, bin ));
+
+      FILE * file = fopen( prog, "rb" );
+      if( FD_UNLIKELY( !file ) )
+        FD_LOG_ERR(( "%i: %s: fopen( \"%s\" ) failed (%i-%s)\n\tDo %s help for help", cnt, cmd, prog, errno, strerror( errno ), bin ));
+
+      static uchar prog_elf[ 1UL<<20 ];
+      ulong prog_elf_sz = fread( prog_elf, 1UL, sizeof(prog_elf), file );
+      int   bad         = ferror( file ) || !feof( file );
+      fclose( file );
+      if( FD_UNLIKELY( bad ) )
+        FD_LOG_ERR(( "%i: %s: failed to read \"%s\" (too large or I/O error)\n\tDo %s help for help", cnt, cmd, prog, bin ));
+
+      if( FD_UNLIKELY( fd_xdp_hook_iface( app, ifname, mode, 0, prog_elf, prog_elf_sz ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_hook_iface( \"%s\", \"%s\", %s, \"%s\" ) failed\n\tDo %s help for help",
+                     cnt, cmd, app, ifname, _mode, prog, bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s %s %s %s: success", cnt, cmd, app, ifname, _mode, prog ));
+      SHIFT(4);
+
+    } else if( !strcmp( cmd, "unhook-iface" ) ) {
+
+      if( FD_UNLIKELY( argc<2 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * app    = argv[0];
+      char const * ifname = argv[1];
+
+      if( FD_UNLIKELY( fd_xdp_unhook_iface( app, ifname ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_unhook_iface( \"%s\", \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, app, ifname, bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s %s: success", cnt, cmd, app, ifname ));
+      SHIFT(2);
+
+    } else if( !strcmp( cmd, "listen-udp-port" ) ) {
+
+      if( FD_UNLIKELY( argc<4 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * app   =                      argv[0];
+      ulong        ip4   = fd_cstr_to_ip4_addr( argv[1] );
+      uint         port  = fd_cstr_to_uint    ( argv[2] );
+      uint         proto = fd_cstr_to_uint    ( argv[3] );
+
+      if( FD_UNLIKELY( ip4==ULONG_MAX ) ) FD_LOG_ERR(( "%i: %s: bad ip4 \"%s\"\n\tDo %s help for help", cnt, cmd, argv[1], bin ));
+
+      if( FD_UNLIKELY( fd_xdp_listen_udp_port( app, (uint)ip4, port, proto ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_listen_udp_port( \"%s\", %s, %u, %u ) failed\n\tDo %s help for help",
+                     cnt, cmd, app, argv[1], port, proto, bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s %s %u %u: success", cnt, cmd, app, argv[1], port, proto ));
+      SHIFT(4);
+
+    } else if( !strcmp( cmd, "release-udp-port" ) ) {
+
+      if( FD_UNLIKELY( argc<3 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * app  =                      argv[0];
+      ulong        ip4  = fd_cstr_to_ip4_addr( argv[1] );
+      uint         port = fd_cstr_to_uint    ( argv[2] );
+
+      if( FD_UNLIKELY( ip4==ULONG_MAX ) ) FD_LOG_ERR(( "%i: %s: bad ip4 \"%s\"\n\tDo %s help for help", cnt, cmd, argv[1], bin ));
+
+      if( FD_UNLIKELY( fd_xdp_release_udp_port( app, (uint)ip4, port ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_release_udp_port( \"%s\", %s, %u ) failed\n\tDo %s help for help",
+                     cnt, cmd, app, argv[1], port, bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s %s %u: success", cnt, cmd, app, argv[1], port ));
+      SHIFT(3);
+
+    } else if( !strcmp( cmd, "filter-config" ) ) {
+
+      if( FD_UNLIKELY( argc<4 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * app        =                  argv[0];
+      uint         udp_sz_max = fd_cstr_to_uint ( argv[1] );
+      ulong        rate       = fd_cstr_to_ulong( argv[2] );
+      ulong        burst      = fd_cstr_to_ulong( argv[3] );
+
+      if( FD_UNLIKELY( fd_xdp_filter_config( app, udp_sz_max, rate, burst ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_filter_config( \"%s\", %u, %lu, %lu ) failed\n\tDo %s help for help",
+                     cnt, cmd, app, udp_sz_max, rate, burst, bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s %u %lu %lu: success", cnt, cmd, app, udp_sz_max, rate, burst ));
+      SHIFT(4);
+
+    } else if( !strcmp( cmd, "filter-prefix" ) ) {
+
+      if( FD_UNLIKELY( argc<3 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * app     = argv[0];
+      char const * _prefix = argv[1];
+      char const * _action = argv[2];
+
+      char prefix[ 32 ];
+      if( FD_UNLIKELY( strlen( _prefix )>=sizeof(prefix) ) )
+        FD_LOG_ERR(( "%i: %s: bad prefix \"%s\"\n\tDo %s help for help", cnt, cmd, _prefix, bin ));
+      strcpy( prefix, _prefix );
+
+      uint   prefix_len = 32U;
+      char * slash      = strchr( prefix, '/' );
+      if( slash ) {
+        *slash     = '\0';
+        prefix_len = fd_cstr_to_uint( slash+1 );
+      }
+      ulong ip4 = fd_cstr_to_ip4_addr( prefix );
+      if( FD_UNLIKELY( ip4==ULONG_MAX ) ) FD_LOG_ERR(( "%i: %s: bad prefix \"%s\"\n\tDo %s help for help", cnt, cmd, _prefix, bin ));
+
+      uint action;
+      if(      !strcmp( _action, "allow" ) ) action = FD_XDP_FILTER_ACTION_ALLOW;
+      else if( !strcmp( _action, "deny"  ) ) action = FD_XDP_FILTER_ACTION_DENY;
+      else if( !strcmp( _action, "none"  ) ) action = 0U;
+      else FD_LOG_ERR(( "%i: %s: bad action \"%s\"\n\tDo %s help for help", cnt, cmd, _action, bin ));
+
+      if( FD_UNLIKELY( fd_xdp_filter_src_prefix( app, (uint)ip4, prefix_len, action ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_filter_src_prefix( \"%s\", %s, %u, %u ) failed\n\tDo %s help for help",
+                     cnt, cmd, app, prefix, prefix_len, action, bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s %s %s: success", cnt, cmd, app, _prefix, _action ));
+      SHIFT(3);
+
+    } else if( !strcmp( cmd, "query-filter" ) ) {
+
+      if( FD_UNLIKELY( argc<1 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * app = argv[0];
+
+      ulong stats[ FD_XDP_FILTER_STAT_CNT ];
+      if( FD_UNLIKELY( fd_xdp_filter_stats( app, stats ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_filter_stats( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, app, bin ));
+
+      printf( "%lu %lu %lu %lu\n", stats[ FD_XDP_FILTER_STAT_PASS      ], stats[ FD_XDP_FILTER_STAT_DROP_SZ   ],
+                                  stats[ FD_XDP_FILTER_STAT_DROP_DENY ], stats[ FD_XDP_FILTER_STAT_DROP_RATE ] );
+
+      FD_LOG_NOTICE(( "%i: %s %s: success", cnt, cmd, app ));
+      SHIFT(1);
+
+    } else if( !strcmp( cmd, "query-iface" ) ) {
+
+      if( FD_UNLIKELY( argc<1 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * ifname = argv[0];
+
+      ulong rxq_cnt = fd_xdp_iface_rxq_cnt( ifname );
+      if( FD_UNLIKELY( !rxq_cnt ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_iface_rxq_cnt( \"%s\" ) failed\n\tDo %s help for help", cnt, cmd, ifname, bin ));
+      ulong numa_idx = fd_xdp_iface_numa_idx( ifname );
+
+      if( numa_idx==ULONG_MAX ) printf( "%lu -\n", rxq_cnt );
+      else                      printf( "%lu %lu\n", rxq_cnt, numa_idx );
+
+      FD_LOG_NOTICE(( "%i: %s %s: success", cnt, cmd, ifname ));
+      SHIFT(1);
+
+    } else if( !strcmp( cmd, "rss-spread" ) ) {
+
+      if( FD_UNLIKELY( argc<2 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * ifname    =                  argv[0];
+      ulong        queue_cnt = fd_cstr_to_ulong( argv[1] );
+
+      if( FD_UNLIKELY( fd_xdp_iface_rss_spread( ifname, queue_cnt ) ) )
+        FD_LOG_ERR(( "%i: %s: fd_xdp_iface_rss_spread( \"%s\", %lu ) failed\n\tDo %s help for help", cnt, cmd, ifname, queue_cnt, bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s %lu: success", cnt, cmd, ifname, queue_cnt ));
+      SHIFT(2);
+
+    } else {
+
+      FD_LOG_ERR(( "%i: %s: unknown command\n\t"
+                   "Do %s help for help", cnt, cmd, bin ));
+
+    }
+    cnt++;
+  }
+
+  if( FD_UNLIKELY( cnt<1 ) ) FD_LOG_NOTICE(( "processed %i commands\n\tDo %s help for help", cnt, bin ));
+  else                       FD_LOG_NOTICE(( "processed %i commands", cnt ));
+
+# undef SHIFT
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  if( FD_UNLIKELY( argc<1 ) ) FD_LOG_ERR(( "No arguments" ));
+  if( FD_UNLIKELY( argc>1 ) ) FD_LOG_ERR(( "fd_xdp_ctl not supported on this platform" ));
+  FD_LOG_NOTICE(( "processed 0 commands" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
@@ -0,0 +1,163 @@
+#define _DEFAULT_SOURCE /* for struct ifreq */
+#include "fd_xdp_iface.h"
+
+#if FD_HAS_HOSTED && defined(__linux__)
+
+#include "../../util/fd_util.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/ethtool.h>
+#include <linux/sockios.h>
+
+/* FD_XDP_IFACE_INDIR_MAX is the largest RSS indirection table size
+   supported.  Typical NICs use 128 to 512 entries. */
+
+#define FD_XDP_IFACE_INDIR_MAX (4096UL)
+
+/* FD_XDP_IFACE_PATH_MAX is the max sysfs path length used below */
+
+#define FD_XDP_IFACE_PATH_MAX (64UL+IF_NAMESIZE)
+
+ulong
+fd_xdp_iface_rxq_cnt( char const * ifname ) {
+
+  if( FD_UNLIKELY( !ifname ) ) {
+    FD_LOG_WARNING(( "NULL ifname" ));
+    return 0UL;
+  }
+
+  /* The kernel exposes one rx-<queue idx> directory per RX queue in
+     use.  This is reliable across drivers (unlike ETHTOOL_GCHANNELS,
+     which isn't supported by all drivers and whose rx / combined split
+     is driver specific). */
+
+  char path[ FD_XDP_IFACE_PATH_MAX ];
+  if( FD_UNLIKELY( !fd_cstr_printf( path, FD_XDP_IFACE_PATH_MAX, NULL, "/sys/class/net/%s/queues", ifname ) ) ) {
+    FD_LOG_WARNING(( "ifname too long" ));
+    return 0UL;
+  }
+
+  DIR * dir = opendir( path );
+  if( FD_UNLIKELY( !dir ) ) {
+    FD_LOG_WARNING(( "opendir( \"%s\" ) failed (%i-%s)", path, errno, strerror( errno ) ));
+    return 0UL;
+  }
+
+  ulong rxq_cnt = 0UL;
+  for(;;) {
+    struct dirent * ent = readdir( dir );
+    if( !ent ) break;
+    rxq_cnt += (ulong)!strncmp( ent->d_name, "rx-", 3UL );
+  }
+
+  if( FD_UNLIKELY( closedir( dir ) ) ) FD_LOG_WARNING(( "closedir( \"%s\" ) failed (%i-%s); attempting to continue",
+                                                        path, errno, strerror( errno ) ));
+
+  if( FD_UNLIKELY( !rxq_cnt ) ) FD_LOG_WARNING(( "%s has no RX queues", ifname ));
+  return rxq_cnt;
+}
+
+ulong
+fd_xdp_iface_numa_idx( char const * ifname ) {
+  if( FD_UNLIKELY( !ifname ) ) return ULONG_MAX;
+
+  char path[ FD_XDP_IFACE_PATH_MAX ];
+  if( FD_UNLIKELY( !fd_cstr_printf( path, FD_XDP_IFACE_PATH_MAX, NULL, "/sys/class/net/%s/device/numa_node", ifname ) ) )
+    return ULONG_MAX;
+
+  /* Virtual devices have no device link and devices on hosts without
+     NUMA report -1 */
+
+  FILE * file = fopen( path, "r" );
+  if( !file ) return ULONG_MAX;
+  long numa_idx = -1L;
+  if( fscanf( file, "%ld", &numa_idx )!=1 ) numa_idx = -1L;
+  fclose( file );
+
+  if( (numa_idx<0L) | (numa_idx>=(long)fd_shmem_numa_cnt()) ) return ULONG_MAX;
+  return (ulong)numa_idx;
+}
+
+/* fd_xdp_iface_ethtool does the SIOCETHTOOL ioctl cmd (the first
+   field of cmd) on ifname.  Returns 0 on success and an errno on
+   failure (does not log). */
+
+static int
+fd_xdp_iface_ethtool( char const * ifname,
+                      void *       cmd ) {
+  int fd = socket( AF_INET, SOCK_DGRAM, 0 );
+  if( FD_UNLIKELY( fd<0 ) ) return errno;
+
+  struct ifreq ifr;
+  fd_memset( &ifr, 0, sizeof(struct ifreq) );
+  strncpy( ifr.ifr_name, ifname, IF_NAMESIZE-1UL );
+  ifr.ifr_data = (char *)cmd;
+
+  int err = ioctl( fd, SIOCETHTOOL, &ifr ) ? errno : 0;
+  close( fd );
+  return err;
+}
+
+int
+fd_xdp_iface_rss_spread( char const * ifname,
+                         ulong        queue_cnt ) {
+
+  if( FD_UNLIKELY( !ifname ) ) {
+    FD_LOG_WARNING(( "NULL ifname" ));
+    return -1;
+  }
+
+  if( FD_UNLIKELY( strlen( ifname )>=IF_NAMESIZE ) ) {
+    FD_LOG_WARNING(( "ifname too long" ));
+    return -1;
+  }
+
+  ulong rxq_cnt = fd_xdp_iface_rxq_cnt( ifname );
+  if( FD_UNLIKELY( !rxq_cnt ) ) return -1;
+  if( FD_UNLIKELY( queue_cnt>rxq_cnt ) ) {
+    FD_LOG_WARNING(( "queue_cnt (%lu) larger than the number of RX queues of %s (%lu)", queue_cnt, ifname, rxq_cnt ));
+    return -1;
+  }
+
+  /* Get the size of the indirection table */
+
+  uint _indir[ 2UL+FD_XDP_IFACE_INDIR_MAX ]; /* cmd, size, ring_index[ size ] */
+  struct ethtool_rxfh_indir * indir = (struct ethtool_rxfh_indir *)_indir;
+
+  indir->cmd  = ETHTOOL_GRXFHINDIR;
+  indir->size = 0U;
+  int err = fd_xdp_iface_ethtool( ifname, indir );
+  if( FD_UNLIKELY( err ) ) {
+    FD_LOG_WARNING(( "ETHTOOL_GRXFHINDIR on %s failed (%i-%s)%s", ifname, err, strerror( err ),
+                     err==EOPNOTSUPP ? "; driver does not support RSS indirection" : "" ));
+    return -1;
+  }
+
+  ulong indir_sz = (ulong)indir->size;
+  if( FD_UNLIKELY( (!indir_sz) | (indir_sz>FD_XDP_IFACE_INDIR_MAX) ) ) {
+    FD_LOG_WARNING(( "unsupported RSS indirection table size (%lu) for %s", indir_sz, ifname ));
+    return -1;
+  }
+
+  /* Spread the table round robin over the queues (a size of zero
+     resets the table to the driver default) */
+
+  indir->cmd  = ETHTOOL_SRXFHINDIR;
+  indir->size = queue_cnt ? (uint)indir_sz : 0U;
+  for( ulong idx=0UL; idx<(queue_cnt ? indir_sz : 0UL); idx++ ) indir->ring_index[ idx ] = (uint)(idx % queue_cnt);
+  err = fd_xdp_iface_ethtool( ifname, indir );
+  if( FD_UNLIKELY( err ) ) {
+    FD_LOG_WARNING(( "ETHTOOL_SRXFHINDIR on %s failed (%i-%s)", ifname, err, strerror( err ) ));
+    return -1;
+  }
+
+  return 0;
+}
+
+#endif /* FD_HAS_HOSTED && defined(__linux__) */
@@ -0,0 +1,57 @@
+#ifndef HEADER_fd_src_tango_xdp_fd_xdp_iface_h
+#define HEADER_fd_src_tango_xdp_fd_xdp_iface_h
+
+/* fd_xdp_iface provides helpers to inspect and configure the RX queues
+   of a network device for multi-queue AF_XDP ingress.
+
+   On a multi-queue NIC, the NIC hashes each received packet's flow
+   (RSS, receive side scaling) and uses the hash to index an
+   indirection table that gives the RX queue the packet lands on.  The
+   XDP redirect program steers packets landing on RX queue q to the XSK
+   bound to queue q (see fd_xdp_redirect_prog.c).  Thus, ingress can be
+   scaled horizontally by binding one XSK per RX queue and spreading the
+   RX queues over multiple tiles.  These helpers are used to find out
+   how many RX queues a device has, what NUMA node it is attached to
+   (such that queues can be assigned to nearby tiles) and to restrict
+   RSS to the queues that have an XSK bound. */
+
+#include "../../util/fd_util_base.h"
+
+#if FD_HAS_HOSTED && defined(__linux__)
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_xdp_iface_rxq_cnt returns the number of RX queues of the network
+   device with name ifname (i.e. the number of queue indices in
+   [0,rxq_cnt) an XSK can be bound to).  Returns 0 on failure (logs
+   details).  Reasons for failure include there is no such device. */
+
+ulong
+fd_xdp_iface_rxq_cnt( char const * ifname );
+
+/* fd_xdp_iface_numa_idx returns the NUMA node the network device with
+   name ifname is attached to.  Returns ULONG_MAX if unknown (e.g. a
+   virtual device like a veth or a single node host) or on failure (does
+   not log). */
+
+ulong
+fd_xdp_iface_numa_idx( char const * ifname );
+
+/* fd_xdp_iface_rss_spread configures the RSS indirection table of the
+   network device with name ifname to spread flows evenly over RX queues
+   [0,queue_cnt).  If queue_cnt is zero, the table is reset to the
+   driver's default.  Returns 0 on success and -1 on failure (logs
+   details).  Reasons for failure include the driver does not support
+   configuring the indirection table (e.g. veth), queue_cnt is larger
+   than the number of RX queues or the caller does not have
+   CAP_NET_ADMIN. */
+
+int
+fd_xdp_iface_rss_spread( char const * ifname,
+                         ulong        queue_cnt );
+
+FD_PROTOTYPES_END
+
+#endif /* FD_HAS_HOSTED && defined(__linux__) */
+
+#endif /* HEADER_fd_src_tango_xdp_fd_xdp_iface_h */
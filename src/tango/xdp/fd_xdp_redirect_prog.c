@@ -5,8 +5,10 @@
    every packet as part of the XDP stage of the Linux host.  Its task is
    to forward packets to the appropriate destination which may be the
    XSKs handling Firedancer traffic or the regular Linux networking
-   stack for unrelated traffic.  It may also be used in the future to
-   protect against packet floods.
+   stack for unrelated traffic.  It also protects the XSKs against
+   packet floods with an optional filter stage (see
+   fd_xdp_redirect_prog.h) such that spam gets dropped in the driver
+   before any cycles are spent on it in userspace.
 
    The following code targets the Linux eBPF virtual machine which does
    not yet support libc and has strict control-flow and memory
@@ -58,8 +60,99 @@ struct {
   __type( value,       int                );
 } firedancer_udp_dsts SEC(".maps");
 
+/* firedancer_filter_cfg: Filter stage config, a single entry of type
+   fd_xdp_filter_cfg_t at key 0. */
+struct {
+  __uint( type,        BPF_MAP_TYPE_ARRAY  );
+  __uint( max_entries, 1U                  );
+  __type( key,         uint                );
+  __type( value,       fd_xdp_filter_cfg_t );
+} firedancer_filter_cfg SEC(".maps");
+
+/* firedancer_src_prefixes: Allow/deny source prefixes
+   value is an FD_XDP_FILTER_ACTION_* */
+struct {
+  __uint( type,        BPF_MAP_TYPE_LPM_TRIE     );
+  __uint( max_entries, FD_XDP_SRC_PREFIX_MAP_CNT );
+  __uint( map_flags,   BPF_F_NO_PREALLOC         );
+  __type( key,         fd_xdp_src_prefix_key_t   );
+  __type( value,       uint                      );
+} firedancer_src_prefixes SEC(".maps");
+
+/* firedancer_src_rates: Token bucket per source address
+   key is the IP source addr (in network byte order). */
+struct {
+  __uint( type,        BPF_MAP_TYPE_LRU_HASH   );
+  __uint( max_entries, FD_XDP_SRC_RATE_MAP_CNT );
+  __type( key,         uint                    );
+  __type( value,       fd_xdp_src_bucket_t     );
+} firedancer_src_rates SEC(".maps");
+
+/* firedancer_filter_stats: Per CPU filter counters
+   key is an FD_XDP_FILTER_STAT_* */
+struct {
+  __uint( type,        BPF_MAP_TYPE_PERCPU_ARRAY );
+  __uint( max_entries, FD_XDP_FILTER_STAT_CNT    );
+  __type( key,         uint                      );
+  __type( value,       ulong                     );
+} firedancer_filter_stats SEC(".maps");
+
 /* Executable Code ****************************************************/
 
+/* fd_xdp_filter_stat increments filter counter stat_idx and returns
+   action. */
+static inline __attribute__((always_inline)) int
+fd_xdp_filter_stat( uint stat_idx,
+                    int  action ) {
+  ulong * cnt = bpf_map_lookup_elem( &firedancer_filter_stats, &stat_idx );
+  if( FD_LIKELY( cnt ) ) *cnt += 1UL;
+  return action;
+}
+
+/* fd_xdp_filter: Filter stage for a datagram from IP source addr
+   ip_srcaddr (network byte order) with UDP payload size udp_sz.
+   Returns XDP_DROP if the datagram should be dropped and XDP_REDIRECT
+   otherwise.  See fd_xdp_src_bucket_take for how token buckets of a
+   source seen by multiple CPUs at once are updated. */
+static inline __attribute__((always_inline)) int
+fd_xdp_filter( uint ip_srcaddr,
+               uint udp_sz ) {
+
+  uint cfg_key = 0U;
+  fd_xdp_filter_cfg_t const * cfg = bpf_map_lookup_elem( &firedancer_filter_cfg, &cfg_key );
+  if( FD_UNLIKELY( !cfg ) ) return XDP_REDIRECT;
+
+  /* Size check */
+  if( cfg->udp_sz_max && udp_sz>cfg->udp_sz_max )
+    return fd_xdp_filter_stat( FD_XDP_FILTER_STAT_DROP_SZ, XDP_DROP );
+
+  /* Allow/deny prefixes */
+  fd_xdp_src_prefix_key_t prefix_key = { .prefix_len=32U, .ip4_addr=ip_srcaddr };
+  uint * prefix_action = bpf_map_lookup_elem( &firedancer_src_prefixes, &prefix_key );
+  if( prefix_action ) {
+    if( *prefix_action==FD_XDP_FILTER_ACTION_DENY  ) return fd_xdp_filter_stat( FD_XDP_FILTER_STAT_DROP_DENY, XDP_DROP );
+    if( *prefix_action==FD_XDP_FILTER_ACTION_ALLOW ) return fd_xdp_filter_stat( FD_XDP_FILTER_STAT_PASS, XDP_REDIRECT );
+  }
+
+  /* Per source token bucket */
+  ulong cost  = cfg->pkt_cost_ns;
+  ulong burst = cfg->burst_ns;
+  if( cost ) {
+    ulong now = bpf_ktime_get_ns();
+    fd_xdp_src_bucket_t * bucket = bpf_map_lookup_elem( &firedancer_src_rates, &ip_srcaddr );
+    if( FD_UNLIKELY( !bucket ) ) {
+      /* New source starts with a full bucket */
+      fd_xdp_src_bucket_t fresh = { .ts_ns=now, .credit_ns=burst-cost };
+      bpf_map_update_elem( &firedancer_src_rates, &ip_srcaddr, &fresh, BPF_ANY );
+    } else {
+      if( !fd_xdp_src_bucket_take( bucket, now, cost, burst ) )
+        return fd_xdp_filter_stat( FD_XDP_FILTER_STAT_DROP_RATE, XDP_DROP );
+    }
+  }
+
+  return fd_xdp_filter_stat( FD_XDP_FILTER_STAT_PASS, XDP_REDIRECT );
+}
+
 /* firedancer_redirect: Entrypoint of redirect XDP program.
    ctx is the XDP context for an Ethernet/IP packet.
    Returns an XDP action code in XDP_{PASS,REDIRECT,DROP}. */
@@ -83,7 +176,7 @@ int firedancer_redirect( struct xdp_md *ctx ) {
   uchar const * udp = iphdr + iplen;
 
   /* Ignore if UDP header is too short */
-  if( udp+4U > data_end ) return XDP_PASS;
+  if( udp+8U > data_end ) return XDP_PASS;
 
   /* Extract IP dest addr and UDP dest port */
   ulong ip_dstaddr  = *(uint   *)( iphdr+16UL );
@@ -94,6 +187,11 @@ int firedancer_redirect( struct xdp_md *ctx ) {
   uint * udp_value = bpf_map_lookup_elem( &firedancer_udp_dsts, &flow_key );
   if( !udp_value ) return XDP_PASS;
 
+  /* Drop spam before it reaches the XSKs */
+  uint ip_srcaddr = *(uint *)( iphdr+12UL );
+  uint udp_sz     = (uint)__builtin_bswap16( *(ushort *)( udp+4UL ) ) - 8U;
+  if( fd_xdp_filter( ip_srcaddr, udp_sz )==XDP_DROP ) return XDP_DROP;
+
   /* Look up the interface queue to find the socket to forward to */
   uint socket_key = ctx->rx_queue_index;
   return bpf_redirect_map( &firedancer_xsks, socket_key, 0 );
@@ -5,6 +5,7 @@
 #include "fd_xdp_redirect_user.h"
 #include "fd_xdp_redirect_prog.h"
 #include "../../util/fd_util.h"
+#include "../../util/net/fd_ip4.h"
 
 #define _DEFAULT_SOURCE
 #include <dirent.h>
@@ -48,6 +49,39 @@ fd_xdp_validate_name_cstr( char const * s,
 }
 
 
+/* fd_xdp_maps: eBPF maps shared by all interfaces hooked by an app.
+   These are created and pinned to /sys/fs/bpf/{app_name}/{pin_name} by
+   fd_xdp_init and swapped into the program object on each
+   fd_xdp_hook_iface.  Must match the definitions in
+   fd_xdp_redirect_prog.c. */
+
+struct fd_xdp_map_def {
+  char const *      pin_name;
+  char const *      map_name;
+  enum bpf_map_type type;
+  uint              key_sz;
+  uint              value_sz;
+  uint              max_entries;
+  uint              map_flags;
+};
+
+typedef struct fd_xdp_map_def fd_xdp_map_def_t;
+
+static fd_xdp_map_def_t const fd_xdp_maps[] = {
+  { "udp_dsts",     "firedancer_udp_dsts",     BPF_MAP_TYPE_HASH,         8U,
+    4U,                           FD_XDP_UDP_MAP_CNT,        0U                },
+  { "filter_cfg",   "firedancer_filter_cfg",   BPF_MAP_TYPE_ARRAY,        4U,
+    sizeof(fd_xdp_filter_cfg_t),  1U,                        0U                },
+  { "src_prefixes", "firedancer_src_prefixes", BPF_MAP_TYPE_LPM_TRIE,     sizeof(fd_xdp_src_prefix_key_t),
+    4U,                           FD_XDP_SRC_PREFIX_MAP_CNT, BPF_F_NO_PREALLOC },
+  { "src_rates",    "firedancer_src_rates",    BPF_MAP_TYPE_LRU_HASH,     4U,
+    sizeof(fd_xdp_src_bucket_t),  FD_XDP_SRC_RATE_MAP_CNT,   0U                },
+  { "filter_stats", "firedancer_filter_stats", BPF_MAP_TYPE_PERCPU_ARRAY, 4U,
+    8U,                           FD_XDP_FILTER_STAT_CNT,    0U                }
+};
+
+#define FD_XDP_MAP_CNT (sizeof(fd_xdp_maps)/sizeof(fd_xdp_map_def_t))
+
 int
 fd_xdp_init( char const * app_name ) {
   /* Validate arguments */
@@ -55,43 +89,45 @@ fd_xdp_init( char const * app_name ) {
   if( FD_UNLIKELY( 0!=fd_xdp_validate_name_cstr( app_name, NAME_MAX, "app_name" ) ) )
     return -1;
 
-  /* Create UDP dsts map */
-
-  struct bpf_map_create_opts map_create_opts = { .sz = sizeof(struct bpf_map_create_opts) };
-  int udp_dsts_map_fd = bpf_map_create(
-      /* map_type    */ BPF_MAP_TYPE_HASH,
-      /* map_name    */ "firedancer_udp_dsts",
-      /* key_size    */ 8U,
-      /* value_size  */ 4U,
-      /* max_entries */ FD_XDP_UDP_MAP_CNT,
-      /* opts        */ &map_create_opts );
-  if( FD_UNLIKELY( udp_dsts_map_fd<0 ) ) {
-    FD_LOG_WARNING(( "bpf_map_create(BPF_MAP_TYPE_HASH,\"firedancer_udp_dsts\",8U,4U,%u,%p) failed (%d-%s)",
-                     FD_XDP_UDP_MAP_CNT, (void *)&map_create_opts, errno, strerror( errno ) ));
-    return -1;
-  }
-
-  /* Pin UDP dsts map to BPF FS */
-
   char path[ PATH_MAX ];
   snprintf( path, PATH_MAX, "/sys/fs/bpf/%s", app_name );
 
   if( FD_UNLIKELY( 0!=mkdir( path, 0777UL ) && errno!=EEXIST ) ) {
     FD_LOG_WARNING(( "mkdir(%s) failed (%d-%s)",
                      path, errno, strerror( errno ) ));
-    close( udp_dsts_map_fd );
     return -1;
   }
 
-  snprintf( path, PATH_MAX, "/sys/fs/bpf/%s/udp_dsts", app_name );
-  if( FD_UNLIKELY( 0!=bpf_obj_pin( udp_dsts_map_fd, path ) ) ) {
-    FD_LOG_WARNING(( "bpf_obj_pin(%u,%s) failed (%d-%s)",
-                     udp_dsts_map_fd, path, errno, strerror( errno ) ));
-    close( udp_dsts_map_fd );
-    return -1;
+  for( ulong map_idx=0UL; map_idx<FD_XDP_MAP_CNT; map_idx++ ) {
+    fd_xdp_map_def_t const * def = fd_xdp_maps + map_idx;
+
+    /* Create map */
+
+    struct bpf_map_create_opts map_create_opts = {
+      .sz        = sizeof(struct bpf_map_create_opts),
+      .map_flags = def->map_flags
+    };
+    int map_fd = bpf_map_create( def->type, def->map_name, def->key_sz, def->value_sz, def->max_entries, &map_create_opts );
+    if( FD_UNLIKELY( map_fd<0 ) ) {
+      FD_LOG_WARNING(( "bpf_map_create(%d,\"%s\",%uU,%uU,%u,%p) failed (%d-%s)",
+                       (int)def->type, def->map_name, def->key_sz, def->value_sz, def->max_entries,
+                       (void *)&map_create_opts, errno, strerror( errno ) ));
+      return -1;
+    }
+
+    /* Pin map to BPF FS */
+
+    snprintf( path, PATH_MAX, "/sys/fs/bpf/%s/%s", app_name, def->pin_name );
+    if( FD_UNLIKELY( 0!=bpf_obj_pin( map_fd, path ) ) ) {
+      FD_LOG_WARNING(( "bpf_obj_pin(%u,%s) failed (%d-%s)",
+                       map_fd, path, errno, strerror( errno ) ));
+      close( map_fd );
+      return -1;
+    }
+
+    close( map_fd );
   }
 
-  close( udp_dsts_map_fd );
   return 0;
 }
 
@@ -143,9 +179,10 @@ fd_xdp_fini( char const * app_name ) {
       FD_LOG_WARNING(( "fd_xdp_unhook_iface(%s,%s) failed", app_name, iface_ent->d_name ));
   }
 
-  /* Remove UDP dst map */
+  /* Remove shared maps */
 
-  unlinkat( dirfd( app_dir ), "udp_dsts", 0 );
+  for( ulong map_idx=0UL; map_idx<FD_XDP_MAP_CNT; map_idx++ )
+    unlinkat( dirfd( app_dir ), fd_xdp_maps[ map_idx ].pin_name, 0 );
 
   /* Remove app dir */
 
@@ -191,17 +228,7 @@ fd_xdp_hook_iface( char const * app_name,
     return -1;
   }
 
-  /* Find pinned UDP dsts map fd */
-
   char path[ PATH_MAX ];
-  snprintf( path, PATH_MAX, "/sys/fs/bpf/%s/udp_dsts", app_name );
-
-  int udp_dsts_map_fd = bpf_obj_get( path );
-  if( FD_UNLIKELY( udp_dsts_map_fd<0 ) ) {
-    FD_LOG_WARNING(( "bpf_obj_get(%s) failed (%d-%s)",
-                     path, errno, strerror( errno ) ));
-    return -1;
-  }
 
   /* Load and relocate eBPF object file.
      Create eBPF maps as implied by BTF data. */
@@ -215,7 +242,6 @@ fd_xdp_hook_iface( char const * app_name,
   if( FD_UNLIKELY( !obj ) ) {
     FD_LOG_WARNING(( "bpf_object__open_mem(%p,%lu) failed (%d-%s)",
                      prog_elf, prog_elf_sz, errno, strerror( errno ) ));
-    close( udp_dsts_map_fd );
     return -1;
   }
 
@@ -226,31 +252,43 @@ fd_xdp_hook_iface( char const * app_name,
     FD_LOG_WARNING(( "bpf_object__find_program_by_name(%p,\"firedancer_redirect\") failed (%d-%s)",
                      (void *)obj, errno, strerror( errno ) ));
     bpf_object__close( obj );
-    close( udp_dsts_map_fd );
     return -1;
   }
 
-  /* Load UDP dsts map from object file.
-     Replace previously created map with shared pinned map (kinda ugly) */
+  /* Replace the maps created from the object file with the shared
+     pinned maps (kinda ugly) */
 
-  struct bpf_map * udp_dsts_map = bpf_object__find_map_by_name( obj, "firedancer_udp_dsts" );
-  if( FD_UNLIKELY( !udp_dsts_map ) ) {
-    FD_LOG_WARNING(( "bpf_object__find_map_by_name(%p,\"firedancer_udp_dsts\") failed (%d-%s)",
-                     (void *)obj, errno, strerror( errno ) ));
-    bpf_object__close( obj );
-    close( udp_dsts_map_fd );
-    return -1;
-  }
+  for( ulong map_idx=0UL; map_idx<FD_XDP_MAP_CNT; map_idx++ ) {
+    fd_xdp_map_def_t const * def = fd_xdp_maps + map_idx;
 
-  if( FD_UNLIKELY( 0!=bpf_map__reuse_fd( udp_dsts_map, udp_dsts_map_fd ) ) ) {
-    FD_LOG_WARNING(( "bpf_map__reuse_fd(%p,%u) failed (%d-%s)",
-                     (void *)udp_dsts_map, udp_dsts_map_fd, errno, strerror( errno ) ));
-    bpf_object__close( obj );
-    close( udp_dsts_map_fd );
-    return -1;
-  }
+    snprintf( path, PATH_MAX, "/sys/fs/bpf/%s/%s", app_name, def->pin_name );
+    int map_fd = bpf_obj_get( path );
+    if( FD_UNLIKELY( map_fd<0 ) ) {
+      FD_LOG_WARNING(( "bpf_obj_get(%s) failed (%d-%s); was fd_xdp_init run for this app?",
+                       path, errno, strerror( errno ) ));
+      bpf_object__close( obj );
+      return -1;
+    }
+
+    struct bpf_map * map = bpf_object__find_map_by_name( obj, def->map_name );
+    if( FD_UNLIKELY( !map ) ) {
+      FD_LOG_WARNING(( "bpf_object__find_map_by_name(%p,\"%s\") failed (%d-%s)",
+                       (void *)obj, def->map_name, errno, strerror( errno ) ));
+      bpf_object__close( obj );
+      close( map_fd );
+      return -1;
+    }
+
+    if( FD_UNLIKELY( 0!=bpf_map__reuse_fd( map, map_fd ) ) ) {
+      FD_LOG_WARNING(( "bpf_map__reuse_fd(%p,%u) failed (%d-%s)",
+                       (void *)map, map_fd, errno, strerror( errno ) ));
+      bpf_object__close( obj );
+      close( map_fd );
+      return -1;
+    }
 
-  close( udp_dsts_map_fd );
+    close( map_fd );
+  }
 
   /* Load XSK map from object file. */
 
@@ -396,17 +434,18 @@ fd_xdp_unhook_iface( char const * app_name,
 
 
 static int
-fd_xdp_get_udp_dsts_map( char const * app_name ) {
+fd_xdp_get_app_map( char const * app_name,
+                    char const * pin_name ) {
   char path[ PATH_MAX ];
-  snprintf( path, PATH_MAX, "/sys/fs/bpf/%s/udp_dsts", app_name );
+  snprintf( path, PATH_MAX, "/sys/fs/bpf/%s/%s", app_name, pin_name );
 
-  int udp_dsts_fd = bpf_obj_get( path );
-  if( FD_UNLIKELY( udp_dsts_fd<0 ) ) {
+  int map_fd = bpf_obj_get( path );
+  if( FD_UNLIKELY( map_fd<0 ) ) {
     FD_LOG_WARNING(( "bpf_obj_get(%s) failed (%d-%s)", path, errno, strerror( errno ) ));
     return -1;
   }
 
-  return udp_dsts_fd;
+  return map_fd;
 }
 
 
@@ -422,7 +461,7 @@ fd_xdp_listen_udp_port( char const * app_name,
 
   /* Open map */
 
-  int udp_dsts_fd = fd_xdp_get_udp_dsts_map( app_name );
+  int udp_dsts_fd = fd_xdp_get_app_map( app_name, "udp_dsts" );
   if( FD_UNLIKELY( udp_dsts_fd<0 ) ) return -1;
 
   /* Insert element */
@@ -455,7 +494,7 @@ fd_xdp_release_udp_port( char const * app_name,
 
   /* Open map */
 
-  int udp_dsts_fd = fd_xdp_get_udp_dsts_map( app_name );
+  int udp_dsts_fd = fd_xdp_get_app_map( app_name, "udp_dsts" );
   if( FD_UNLIKELY( udp_dsts_fd<0 ) ) return -1;
 
   /* Delete element */
@@ -476,6 +515,152 @@ fd_xdp_release_udp_port( char const * app_name,
 }
 
 
+int
+fd_xdp_filter_config( char const * app_name,
+                      uint         udp_sz_max,
+                      ulong        src_rate,
+                      ulong        src_burst ) {
+  /* Validate arguments */
+
+  if( FD_UNLIKELY( 0!=fd_xdp_validate_name_cstr( app_name, NAME_MAX, "app_name" ) ) )
+    return -1;
+
+  if( FD_UNLIKELY( src_rate>1000000000UL ) ) {
+    FD_LOG_WARNING(( "src_rate (%lu) must be at most 1e9 datagrams per second", src_rate ));
+    return -1;
+  }
+
+  if( FD_UNLIKELY( src_rate && !src_burst ) ) {
+    FD_LOG_WARNING(( "src_burst must be positive" ));
+    return -1;
+  }
+
+  fd_xdp_filter_cfg_t cfg = { .udp_sz_max = udp_sz_max };
+  if( src_rate ) {
+    cfg.pkt_cost_ns = 1000000000UL / src_rate;
+    if( FD_UNLIKELY( src_burst > ULONG_MAX / cfg.pkt_cost_ns ) ) {
+      FD_LOG_WARNING(( "src_burst (%lu) too large", src_burst ));
+      return -1;
+    }
+    cfg.burst_ns = src_burst * cfg.pkt_cost_ns;
+  }
+
+  /* Open map */
+
+  int cfg_fd = fd_xdp_get_app_map( app_name, "filter_cfg" );
+  if( FD_UNLIKELY( cfg_fd<0 ) ) return -1;
+
+  /* Update config */
+
+  uint key = 0U;
+  if( FD_UNLIKELY( 0!=bpf_map_update_elem( cfg_fd, &key, &cfg, 0UL ) ) ) {
+    FD_LOG_WARNING(( "bpf_map_update_elem(fd=%d,key=%u,flags=0) failed (%d-%s)",
+                     cfg_fd, key, errno, strerror( errno ) ));
+    close( cfg_fd );
+    return -1;
+  }
+
+  /* Clean up */
+
+  close( cfg_fd );
+  return 0;
+}
+
+
+int
+fd_xdp_filter_src_prefix( char const * app_name,
+                          uint         ip4_addr,
+                          uint         prefix_len,
+                          uint         action ) {
+  /* Validate arguments */
+
+  if( FD_UNLIKELY( 0!=fd_xdp_validate_name_cstr( app_name, NAME_MAX, "app_name" ) ) )
+    return -1;
+
+  if( FD_UNLIKELY( prefix_len>32U ) ) {
+    FD_LOG_WARNING(( "prefix_len (%u) must be at most 32", prefix_len ));
+    return -1;
+  }
+
+  if( FD_UNLIKELY( action!=0U && action!=FD_XDP_FILTER_ACTION_ALLOW && action!=FD_XDP_FILTER_ACTION_DENY ) ) {
+    FD_LOG_WARNING(( "unsupported action %u", action ));
+    return -1;
+  }
+
+  /* Open map */
+
+  int prefixes_fd = fd_xdp_get_app_map( app_name, "src_prefixes" );
+  if( FD_UNLIKELY( prefixes_fd<0 ) ) return -1;
+
+  /* Insert or delete element (LPM tries require the bits past the
+     prefix to be clear) */
+
+  uint mask = prefix_len ? fd_uint_bswap( ~0U << (32U-prefix_len) ) : 0U;
+  fd_xdp_src_prefix_key_t key = { .prefix_len = prefix_len, .ip4_addr = ip4_addr & mask };
+
+  int err = action ? bpf_map_update_elem( prefixes_fd, &key, &action, 0UL )
+                   : bpf_map_delete_elem( prefixes_fd, &key );
+  if( FD_UNLIKELY( 0!=err ) ) {
+    FD_LOG_WARNING(( "bpf_map_%s_elem(fd=%d,key=" FD_IP4_ADDR_FMT "/%u) failed (%d-%s)",
+                     action ? "update" : "delete", prefixes_fd, FD_IP4_ADDR_FMT_ARGS( key.ip4_addr ), prefix_len,
+                     errno, strerror( errno ) ));
+    close( prefixes_fd );
+    return -1;
+  }
+
+  /* Clean up */
+
+  close( prefixes_fd );
+  return 0;
+}
+
+
+int
+fd_xdp_filter_stats( char const * app_name,
+                     ulong *      stats ) {
+  /* Validate arguments */
+
+  if( FD_UNLIKELY( 0!=fd_xdp_validate_name_cstr( app_name, NAME_MAX, "app_name" ) ) )
+    return -1;
+
+  if( FD_UNLIKELY( !stats ) ) {
+    FD_LOG_WARNING(( "NULL stats" ));
+    return -1;
+  }
+
+  int cpu_cnt = libbpf_num_possible_cpus();
+  if( FD_UNLIKELY( cpu_cnt<=0 || (ulong)cpu_cnt>FD_SHMEM_CPU_MAX ) ) {
+    FD_LOG_WARNING(( "libbpf_num_possible_cpus() failed (%d)", cpu_cnt ));
+    return -1;
+  }
+
+  /* Open map */
+
+  int stats_fd = fd_xdp_get_app_map( app_name, "filter_stats" );
+  if( FD_UNLIKELY( stats_fd<0 ) ) return -1;
+
+  /* Sum the per CPU counters */
+
+  ulong per_cpu[ FD_SHMEM_CPU_MAX ];
+  for( uint stat_idx=0U; stat_idx<FD_XDP_FILTER_STAT_CNT; stat_idx++ ) {
+    if( FD_UNLIKELY( 0!=bpf_map_lookup_elem( stats_fd, &stat_idx, per_cpu ) ) ) {
+      FD_LOG_WARNING(( "bpf_map_lookup_elem(fd=%d,key=%u) failed (%d-%s)",
+                       stats_fd, stat_idx, errno, strerror( errno ) ));
+      close( stats_fd );
+      return -1;
+    }
+    ulong sum = 0UL;
+    for( int cpu_idx=0; cpu_idx<cpu_cnt; cpu_idx++ ) sum += per_cpu[ cpu_idx ];
+    stats[ stat_idx ] = sum;
+  }
+
+  /* Clean up */
+
+  close( stats_fd );
+  return 0;
+}
+
+
 static int
 fd_xdp_get_xsks_map( char const * app_name,
                      char const * ifname ) {
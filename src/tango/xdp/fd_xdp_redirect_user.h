@@ -34,11 +34,13 @@
        - fd_xsk_join()
    - For each UDP/IP destination to listen on
      - fd_xdp_listen_udp_port()
+   - Optionally, fd_xdp_filter_config() / fd_xdp_filter_src_prefix()
    - ... Application run ... */
 
 /* TODO: Support NUMA-aware eBPF maps */
 
 #include "fd_xsk.h"
+#include "fd_xdp_redirect_prog.h"
 #include "../../util/fd_util.h"
 
 /* FD_XDP_PIN_NAME_SZ: max number of chars in an eBPF pin dir name */
@@ -59,10 +61,14 @@ FD_PROTOTYPES_BEGIN
    (e.g. by listening on the same ports).
 
    Assumes that /sys/fs/bpf is a valid bpffs mount.
-   Creates the following files in /sys/fs/bpf/{app_name}/
-
-     udp_dsts  BPF_MAP_TYPE_HASH map, see firedancer_udp_dsts in
-               program ebpf_xdp_flow.c */
+   Creates the following files in /sys/fs/bpf/{app_name}/ (see the
+   corresponding firedancer_* maps in fd_xdp_redirect_prog.c)
+
+     udp_dsts      BPF_MAP_TYPE_HASH map of UDP listeners
+     filter_cfg    BPF_MAP_TYPE_ARRAY filter stage config
+     src_prefixes  BPF_MAP_TYPE_LPM_TRIE allow/deny source prefixes
+     src_rates     BPF_MAP_TYPE_LRU_HASH per source token buckets
+     filter_stats  BPF_MAP_TYPE_PERCPU_ARRAY filter counters */
 int
 fd_xdp_init( char const * app_name );
 
@@ -122,11 +128,12 @@ fd_xdp_unhook_iface( char const * app_name,
 /* Listen API (privileged) ********************************************/
 
 /* fd_xdp_udp_dst_key returns a key for the firedancer_udp_dsts eBPF
-   map given the IPv4 dest address and UDP port number. */
+   map given the IPv4 dest address (in network byte order, as returned
+   by fd_cstr_to_ip4_addr) and UDP port number (in host byte order). */
 static inline ulong
 fd_xdp_udp_dst_key( uint ip4_addr,
                     uint udp_port ) {
-  return ( (ulong)fd_uint_bswap( ip4_addr )<<16 ) | fd_ushort_bswap( (ushort)udp_port );
+  return ( (ulong)ip4_addr<<16 ) | fd_ushort_bswap( (ushort)udp_port );
 }
 
 /* fd_xdp_listen_udp_port installs a listener for protocol proto on IPv4
@@ -154,6 +161,44 @@ fd_xdp_release_udp_port( char const * app_name,
                          uint         ip4_dst_addr,
                          uint         udp_dst_port );
 
+/* Filter API (privileged) ********************************************/
+
+/* fd_xdp_filter_config configures the filter stage applied to traffic
+   matching a UDP listener of app_name on all interfaces hooked by it.
+   Datagrams with a UDP payload larger than udp_sz_max (0 to disable)
+   get dropped.  Each source address not in an allowed prefix can send
+   a sustained src_rate datagrams per second (0 to disable) with bursts
+   of up to src_burst datagrams.  Sources are tracked in an LRU map of
+   FD_XDP_SRC_RATE_MAP_CNT entries.  Returns 0 on success and -1 on
+   error.  Reasons for error are logged to FD_LOG_WARNING. */
+int
+fd_xdp_filter_config( char const * app_name,
+                      uint         udp_sz_max,
+                      ulong        src_rate,
+                      ulong        src_burst );
+
+/* fd_xdp_filter_src_prefix sets the filter action for source addresses
+   in the prefix ip4_addr/prefix_len (ip4_addr in network byte order,
+   bits past prefix_len are ignored).  action is one of
+   FD_XDP_FILTER_ACTION_{ALLOW,DENY} or 0 to remove the prefix.  Allowed
+   sources bypass rate limiting, denied sources get dropped.  The
+   longest matching prefix wins.  Returns 0 on success and -1 on error
+   (e.g. too many prefixes or removing a prefix that was not set).
+   Reasons for error are logged to FD_LOG_WARNING. */
+int
+fd_xdp_filter_src_prefix( char const * app_name,
+                          uint         ip4_addr,
+                          uint         prefix_len,
+                          uint         action );
+
+/* fd_xdp_filter_stats sums the filter counters of app_name over all
+   CPUs and interfaces into stats[ FD_XDP_FILTER_STAT_* ] (indexed in
+   [0,FD_XDP_FILTER_STAT_CNT)).  Returns 0 on success and -1 on error.
+   Reasons for error are logged to FD_LOG_WARNING. */
+int
+fd_xdp_filter_stats( char const * app_name,
+                     ulong *      stats );
+
 /* Runtime API (unprivileged) *****************************************/
 
 /* fd_xsk_activate installs an XSK file descriptor into the XDP redirect
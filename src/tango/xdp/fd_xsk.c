@@ -222,6 +222,92 @@ fd_xsk_new( void *       shmem,
   xsk_off+=cr_depth*frame_sz;
   xsk->params.umem_sz = xsk_off;
 
+  xsk->umem_off      = (long)fd_ulong_align_up( sizeof(fd_xsk_t), FD_XSK_UMEM_ALIGN );
+  xsk->umem_headroom = 0UL; /* TODO no need for headroom for now */
+
+  /* Mark object as valid */
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( xsk->magic ) = FD_XSK_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return (void *)xsk;
+}
+
+ulong
+fd_xsk_shumem_footprint( void ) {
+  return fd_ulong_align_up( sizeof(fd_xsk_t), FD_XSK_ALIGN );
+}
+
+void *
+fd_xsk_new_shumem( void * shmem,
+                   ulong  frame_sz,
+                   ulong  fr_depth,
+                   ulong  rx_depth,
+                   ulong  tx_depth,
+                   ulong  cr_depth,
+                   void * umem,
+                   ulong  umem_sz,
+                   ulong  headroom ) {
+  /* Validate arguments */
+
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, fd_xsk_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_xsk_footprint( frame_sz, fr_depth, rx_depth, tx_depth, cr_depth ) ) ) {
+    FD_LOG_WARNING(( "invalid footprint for config" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !umem ) ) {
+    FD_LOG_WARNING(( "NULL umem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)umem, FD_XSK_UMEM_ALIGN ) ) ) {
+    FD_LOG_WARNING(( "misaligned umem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( (!umem_sz) | (umem_sz % frame_sz) ) ) {
+    FD_LOG_WARNING(( "umem_sz must be a positive multiple of frame_sz" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( headroom>=frame_sz-XDP_PACKET_HEADROOM ) ) {
+    FD_LOG_WARNING(( "headroom too large for frame_sz" ));
+    return NULL;
+  }
+
+  /* Reset fd_xsk_t state.  The UMEM area is owned by the caller */
+
+  fd_xsk_t * xsk = (fd_xsk_t *)shmem;
+
+  fd_memset( xsk, 0, fd_xsk_shumem_footprint() );
+
+  xsk->xsk_fd         = -1;
+  xsk->xdp_map_fd     = -1;
+  xsk->xdp_udp_map_fd = -1;
+
+  /* Copy config */
+
+  xsk->params.frame_sz = frame_sz;
+  xsk->params.fr_depth = fr_depth;
+  xsk->params.rx_depth = rx_depth;
+  xsk->params.tx_depth = tx_depth;
+  xsk->params.cr_depth = cr_depth;
+  xsk->params.umem_sz  = umem_sz;
+
+  xsk->umem_off      = (long)umem - (long)shmem;
+  xsk->umem_headroom = headroom;
+
   /* Mark object as valid */
 
   FD_COMPILER_MFENCE();
@@ -370,12 +456,9 @@ fd_xsk_cleanup( fd_xsk_t * xsk ) {
    getsockopt().  Returns 1 on success, 0 on failure. */
 static int
 fd_xsk_setup_umem( fd_xsk_t * xsk ) {
-  /* Find byte offset of UMEM area */
-  ulong umem_off = fd_ulong_align_up( sizeof(fd_xsk_t), FD_XSK_UMEM_ALIGN );
-
   /* Initialize xdp_umem_reg */
-  xsk->umem.headroom   = 0; /* TODO no need for headroom for now */
-  xsk->umem.addr       = (ulong)xsk + umem_off;
+  xsk->umem.headroom   = (uint)xsk->umem_headroom;
+  xsk->umem.addr       = (ulong)((long)xsk + xsk->umem_off);
   xsk->umem.chunk_size = (uint)xsk->params.frame_sz;
   xsk->umem.len        =       xsk->params.umem_sz;
 
@@ -574,6 +657,31 @@ fd_xsk_ifqueue( fd_xsk_t * const xsk ) {
   return xsk->if_queue_id;
 }
 
+int
+fd_xsk_stats( fd_xsk_t *       xsk,
+              fd_xsk_stats_t * stats ) {
+  fd_memset( stats, 0, sizeof(fd_xsk_stats_t) );
+
+  struct xdp_statistics xstats;
+  fd_memset( &xstats, 0, sizeof(struct xdp_statistics) );
+  socklen_t xstats_sz = sizeof(struct xdp_statistics);
+  if( FD_UNLIKELY( 0!=getsockopt( xsk->xsk_fd, SOL_XDP, XDP_STATISTICS, &xstats, &xstats_sz ) ) ) {
+    FD_LOG_WARNING(( "getsockopt(SOL_XDP, XDP_STATISTICS): %s", strerror( errno ) ));
+    return -1;
+  }
+
+  /* Older kernels only report the first three counters (xstats_sz is
+     smaller), the others are left zero */
+
+  stats->rx_dropped               = xstats.rx_dropped;
+  stats->rx_invalid_descs         = xstats.rx_invalid_descs;
+  stats->tx_invalid_descs         = xstats.tx_invalid_descs;
+  stats->rx_ring_full             = xstats.rx_ring_full;
+  stats->rx_fill_ring_empty_descs = xstats.rx_fill_ring_empty_descs;
+  stats->tx_ring_empty_descs      = xstats.tx_ring_empty_descs;
+  return 0;
+}
+
 /* RX/TX implementation ***********************************************/
 
 ulong
@@ -656,7 +764,7 @@ fd_xsk_rx_enqueue2( fd_xsk_t *            xsk,
   ulong mask = fill->depth - 1;
   for( ulong j = 0; j < sz; ++j ) {
     ulong k = prod & mask;
-    ring[k] = meta[j].off & frame_mask;
+    ring[k] = meta[j].off & ~frame_mask;
 
     prod++;
   }
@@ -182,6 +182,47 @@ fd_xsk_new( void * shmem,
             ulong  tx_depth,
             ulong  cr_depth);
 
+/* fd_xsk_shumem_footprint returns the footprint of a memory region
+   suitable for use as an fd_xsk_t whose UMEM lives outside of it (see
+   fd_xsk_new_shumem).  Aligned by fd_xsk_align(). */
+
+FD_FN_CONST ulong
+fd_xsk_shumem_footprint( void );
+
+/* fd_xsk_new_shumem is fd_xsk_new for an fd_xsk_t that uses the caller
+   provided memory region [umem,umem+umem_sz) as its UMEM instead of
+   one trailing the fd_xsk_t.  This allows frames to be received
+   directly into application memory (e.g. the data region of a dcache
+   in a wksp), such that consumers can be handed a received frame
+   without copying it.  shmem must match fd_xsk_align() and
+   fd_xsk_shumem_footprint().  umem must be FD_XSK_UMEM_ALIGN aligned
+   and umem_sz must be a positive multiple of frame_sz.  headroom is the
+   number of bytes the kernel leaves free in front of each received
+   packet (in addition to XDP_PACKET_HEADROOM) and must be less than
+   frame_sz-XDP_PACKET_HEADROOM.
+
+   The UMEM is located relative to the fd_xsk_t.  Thus, the UMEM must
+   be mapped at the same offset relative to the fd_xsk_t in the address
+   space of every thread group that joins (e.g. both in the same wksp
+   or both local to the only joining thread group).  The caller is
+   responsible for the UMEM memory region lifetime, which should be a
+   superset of the fd_xsk_t lifetime.  It is up to the caller to decide
+   which frames of the UMEM are given to the kernel for RX and TX.
+
+   Returns handle suitable for fd_xsk_join() on success and NULL on
+   failure (logs details). */
+
+void *
+fd_xsk_new_shumem( void * shmem,
+                   ulong  frame_sz,
+                   ulong  fr_depth,
+                   ulong  rx_depth,
+                   ulong  tx_depth,
+                   ulong  cr_depth,
+                   void * umem,
+                   ulong  umem_sz,
+                   ulong  headroom );
+
 /* fd_xsk_bind assigns an XSK buffer to the network device with name
    ifname and RX queue index ifqueue.  fd_xsk_unbind unassigns an XSK
    buffer from any netdev queue.  shxsk points to the first byte of the
@@ -374,6 +415,31 @@ fd_xsk_ifqueue( fd_xsk_t * const xsk );
 FD_FN_CONST void *
 fd_xsk_umem_laddr( fd_xsk_t * xsk );
 
+/* fd_xsk_stats_t holds the kernel's counters of an XSK (see struct
+   xdp_statistics in <linux/if_xdp.h>).  Counters are cumulative since
+   the XSK was bound. */
+
+struct fd_xsk_stats {
+  ulong rx_dropped;               /* Frames dropped for reasons other than the below */
+  ulong rx_invalid_descs;         /* Frames dropped due to an invalid fill ring descriptor */
+  ulong tx_invalid_descs;         /* Frames dropped due to an invalid TX ring descriptor */
+  ulong rx_ring_full;             /* Frames dropped because the RX ring was full */
+  ulong rx_fill_ring_empty_descs; /* Times the kernel found the fill ring empty */
+  ulong tx_ring_empty_descs;      /* Times the kernel found the TX ring empty */
+};
+
+typedef struct fd_xsk_stats fd_xsk_stats_t;
+
+/* fd_xsk_stats queries the kernel's counters of xsk into *stats.  xsk
+   must be a current local join to a bound fd_xsk_t.  Returns 0 on
+   success and -1 on failure (logs details, *stats is zeroed).  This
+   does a syscall, so it should only be used at a low rate (e.g. from
+   tile housekeeping). */
+
+int
+fd_xsk_stats( fd_xsk_t *       xsk,
+              fd_xsk_stats_t * stats );
+
 /* fd_xsk_get_params returns a pointer to the memory layout params from
    xsk. The caller should zero-initialize the params buffer before use.
    xsk must be a valid join to fd_xsk_t and params must point to a
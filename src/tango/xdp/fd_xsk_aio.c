@@ -12,6 +12,18 @@ fd_xsk_aio_send( void *                    ctx,
                  ulong                     batch_cnt,
                  ulong *                   opt_batch_idx );
 
+/* fd_xsk_aio_rx_discard is the rx aio until one is set with
+   fd_xsk_aio_set_rx.  It accepts (and discards) everything such that
+   frames received before then are recycled rather than kept pending. */
+static int
+fd_xsk_aio_rx_discard( void *                    ctx,
+                       fd_aio_pkt_info_t const * batch,
+                       ulong                     batch_cnt,
+                       ulong *                   opt_batch_idx ) {
+  (void)ctx; (void)batch; (void)batch_cnt; (void)opt_batch_idx;
+  return FD_AIO_SUCCESS;
+}
+
 ulong
 fd_xsk_aio_align( void ) {
   return FD_XSK_AIO_ALIGN;
@@ -24,6 +36,7 @@ fd_xsk_aio_footprint( ulong tx_depth,
   if( FD_UNLIKELY( pkt_cnt ==0UL ) ) return 0UL;
 
   ulong sz =      1UL*sizeof( fd_xsk_aio_t        )
+           +  pkt_cnt*sizeof( fd_xsk_frame_meta_t )
            +  pkt_cnt*sizeof( fd_xsk_frame_meta_t )
            +  pkt_cnt*sizeof( fd_aio_pkt_info_t   )
            + tx_depth*sizeof( ulong               );
@@ -64,13 +77,15 @@ fd_xsk_aio_new( void * mem,
   /* Assumes alignment of `fd_xsk_aio_t` matches alignment of
      `fd_xsk_frame_meta_t` and `fd_aio_buf_t`. */
 
-  ulong meta_off     =                    sizeof(fd_xsk_aio_t       );
-  ulong pkt_off      = meta_off + pkt_cnt*sizeof(fd_xsk_frame_meta_t);
-  ulong tx_stack_off = pkt_off  + pkt_cnt*sizeof(fd_aio_pkt_info_t  );
+  ulong meta_off     =                       sizeof(fd_xsk_aio_t       );
+  ulong rx_meta_off  = meta_off    + pkt_cnt*sizeof(fd_xsk_frame_meta_t);
+  ulong pkt_off      = rx_meta_off + pkt_cnt*sizeof(fd_xsk_frame_meta_t);
+  ulong tx_stack_off = pkt_off     + pkt_cnt*sizeof(fd_aio_pkt_info_t  );
 
   xsk_aio->pkt_depth    = pkt_cnt;
   xsk_aio->tx_depth     = tx_depth;
   xsk_aio->meta_off     = meta_off;
+  xsk_aio->rx_meta_off  = rx_meta_off;
   xsk_aio->pkt_off      = pkt_off;
   xsk_aio->tx_stack_off = tx_stack_off;
 
@@ -139,6 +154,7 @@ fd_xsk_aio_join( void *     shxsk_aio,
   xsk_aio->tx_stack       = fd_xsk_aio_tx_stack( xsk_aio );
   xsk_aio->tx_stack_depth = params->tx_depth;
   xsk_aio->tx_top         = 0;
+  xsk_aio->rx_pend_cnt    = 0UL; /* All frames are given to the fill ring below */
 
   /* Setup local TX */
 
@@ -146,7 +162,7 @@ fd_xsk_aio_join( void *     shxsk_aio,
 
   /* Set up RX callback (local address) */
 
-  fd_aio_t * rx = fd_aio_join( fd_aio_new( &xsk_aio->rx, xsk_aio, fd_xsk_aio_send ) );
+  fd_aio_t * rx = fd_aio_join( fd_aio_new( &xsk_aio->rx, xsk_aio, fd_xsk_aio_rx_discard ) );
   if( FD_UNLIKELY( !rx ) ) {
     FD_LOG_WARNING(( "Failed to join rx aio" ));
     return NULL;
@@ -231,6 +247,15 @@ fd_xsk_aio_get_tx( fd_xsk_aio_t const * xsk_aio ) {
   return &xsk_aio->tx;
 }
 
+fd_xsk_t *
+fd_xsk_aio_xsk( fd_xsk_aio_t const * xsk_aio ) {
+  return xsk_aio->xsk;
+}
+
+ulong fd_xsk_aio_rx_pend_cnt ( fd_xsk_aio_t const * xsk_aio ) { return xsk_aio->rx_pend_cnt;  }
+ulong fd_xsk_aio_rx_defer_cnt( fd_xsk_aio_t const * xsk_aio ) { return xsk_aio->rx_defer_cnt; }
+ulong fd_xsk_aio_rx_drop_cnt ( fd_xsk_aio_t const * xsk_aio ) { return xsk_aio->rx_drop_cnt;  }
+
 void
 fd_xsk_aio_set_rx( fd_xsk_aio_t *   xsk_aio,
                    fd_aio_t const * aio ) {
@@ -242,33 +267,60 @@ void
 fd_xsk_aio_service( fd_xsk_aio_t * xsk_aio ) {
   fd_xsk_t *            xsk         = xsk_aio->xsk;
   fd_aio_t *            ingress     = &xsk_aio->rx;
-  fd_xsk_frame_meta_t * meta        = fd_xsk_aio_meta( xsk_aio );
+  fd_xsk_frame_meta_t * meta        = fd_xsk_aio_rx_meta( xsk_aio );
   fd_aio_pkt_info_t *   pkt         = fd_xsk_aio_pkts( xsk_aio );
   ulong                 pkt_depth   = xsk_aio->pkt_depth;
+  ulong                 pend_cnt    = xsk_aio->rx_pend_cnt;
   ulong                 frame_laddr = (ulong)fd_xsk_umem_laddr( xsk_aio->xsk );
 
-  /* try completing receives */
-  ulong rx_avail = fd_xsk_rx_complete( xsk, meta, pkt_depth );
+  /* try completing receives behind any frames still pending from a
+     previous service */
+  ulong rx_avail = fd_xsk_rx_complete( xsk, meta + pend_cnt, pkt_depth - pend_cnt );
+  for( ulong j=pend_cnt; j<pend_cnt+rx_avail; j++ ) {
+    pkt[j] = (fd_aio_pkt_info_t) {
+      .buf    = (void *)(frame_laddr + meta[j].off),
+      .buf_sz = (ushort)meta[j].sz
+    };
+  }
 
   /* forward to aio */
-  if( rx_avail ) {
-    for( ulong j=0; j<rx_avail; j++ ) {
-      pkt[j] = (fd_aio_pkt_info_t) {
-        .buf    = (void *)(frame_laddr + meta[j].off),
-        .buf_sz = (ushort)meta[j].sz
-      };
+  ulong batch_cnt = pend_cnt + rx_avail;
+  if( batch_cnt ) {
+    ulong batch_idx = 0UL;
+    int   err       = fd_aio_send( ingress, pkt, batch_cnt, &batch_idx );
+
+    /* done_cnt is the number of frames at the front of the batch the
+       consumer is done with.  On AGAIN, the consumer accepted
+       [0,batch_idx) and the rest is kept pending (and out of the fill
+       ring) such that backpressure from the consumer turns into fill
+       ring starvation in the kernel (visible in the XSK statistics)
+       rather than silently recycled frames.  On any other error, the
+       frame at batch_idx was untransmissable and is dropped (retrying
+       it would wedge the queue). */
+    ulong done_cnt = batch_cnt;
+    if( FD_UNLIKELY( err ) ) {
+      done_cnt = fd_ulong_min( batch_idx, batch_cnt );
+      if( err!=FD_AIO_ERR_AGAIN && done_cnt<batch_cnt ) {
+        done_cnt++;
+        xsk_aio->rx_drop_cnt++;
+      }
     }
 
-    fd_aio_send( ingress, pkt, rx_avail, NULL );
-    /* TODO frames may not all be processed at this point
-       we should count them, and possibly buffer them */
-
     /* return frames to rx ring */
-    ulong enq_rc = fd_xsk_rx_enqueue2( xsk, meta, rx_avail );
-    if( FD_UNLIKELY( enq_rc < rx_avail ) ) {
+    ulong enq_rc = fd_xsk_rx_enqueue2( xsk, meta, done_cnt );
+    if( FD_UNLIKELY( enq_rc < done_cnt ) ) {
       /* this should not be possible */
       FD_LOG_WARNING(( "frames lost trying to replenish rx ring" ));
     }
+
+    /* keep the rest pending */
+    pend_cnt = batch_cnt - done_cnt;
+    if( FD_UNLIKELY( pend_cnt ) ) {
+      memmove( meta, meta + done_cnt, pend_cnt*sizeof(fd_xsk_frame_meta_t) );
+      memmove( pkt,  pkt  + done_cnt, pend_cnt*sizeof(fd_aio_pkt_info_t  ) );
+      xsk_aio->rx_defer_cnt += pend_cnt;
+    }
+    xsk_aio->rx_pend_cnt = pend_cnt;
   }
 
   /* any tx to complete? */
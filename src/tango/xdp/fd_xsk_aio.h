@@ -78,7 +78,8 @@ fd_xsk_aio_delete( void * xsk_aio );
 
 /* fd_xsk_aio_set_rx sets the fd_aio_t instance called back when
    fd_xsk_t receives data.  Requires periodic fd_xsk_aio_service()
-   calls to poll AF_XDP buffers for RX events and TX completions. */
+   calls to poll AF_XDP buffers for RX events and TX completions.  Until
+   set, received frames are discarded. */
 
 void
 fd_xsk_aio_set_rx( fd_xsk_aio_t *   xsk_aio,
@@ -94,8 +95,36 @@ fd_xsk_aio_set_rx( fd_xsk_aio_t *   xsk_aio,
 FD_FN_CONST fd_aio_t const *
 fd_xsk_aio_get_tx( fd_xsk_aio_t const * xsk_aio );
 
+/* fd_xsk_aio_xsk returns the fd_xsk_t xsk_aio is joined to (NULL if
+   not joined). */
+
+FD_FN_PURE fd_xsk_t *
+fd_xsk_aio_xsk( fd_xsk_aio_t const * xsk_aio );
+
+/* fd_xsk_aio_rx_{pend,defer,drop}_cnt return the RX backpressure
+   diagnostics of xsk_aio.  pend_cnt is the number of frames currently
+   pending (in [0,pkt_cnt]).  defer_cnt is the number of times a frame
+   was kept pending after being offered to the rx aio (a frame offered
+   k times before acceptance counts k-1 times).  drop_cnt is the number
+   of frames dropped because the rx aio rejected them.  defer_cnt and
+   drop_cnt accumulate over the lifetime of xsk_aio. */
+
+FD_FN_PURE ulong fd_xsk_aio_rx_pend_cnt ( fd_xsk_aio_t const * xsk_aio );
+FD_FN_PURE ulong fd_xsk_aio_rx_defer_cnt( fd_xsk_aio_t const * xsk_aio );
+FD_FN_PURE ulong fd_xsk_aio_rx_drop_cnt ( fd_xsk_aio_t const * xsk_aio );
+
 /* fd_xsk_aio_service services aio callbacks for incoming packets and
-   handles completions for tx requests. */
+   handles completions for tx requests.
+
+   Received frames are handed to the rx aio in one batch (at most
+   pkt_cnt frames, oldest first).  Frames the rx aio did not accept
+   (FD_AIO_ERR_AGAIN with *opt_batch_idx<batch_cnt) are kept pending
+   and are resent at the front of the next batch; they are not returned
+   to the fill ring until accepted.  A sustained slow consumer thus
+   starves the fill ring and the kernel drops incoming frames (see
+   fd_xsk_stats) instead of accepted frames being overwritten.  If the
+   rx aio fails with any other error, the frame at *opt_batch_idx is
+   dropped and the frames after it are kept pending. */
 
 void
 fd_xsk_aio_service( fd_xsk_aio_t * xsk_aio );
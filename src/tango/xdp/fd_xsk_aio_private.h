@@ -15,6 +15,7 @@ struct __attribute__((aligned(FD_XSK_AIO_ALIGN))) fd_xsk_aio_private {
   ulong pkt_depth;      /* depth of fd_aio_pkt_info_t buffer          */
   ulong tx_depth;       /* depth of the fd_xsk_t tx_depth/cr_depth    */
   ulong meta_off;       /* offset of fd_xsk_frame_meta_t[ batch_cnt ] */
+  ulong rx_meta_off;    /* offset of fd_xsk_frame_meta_t[ batch_cnt ] */
   ulong pkt_off;        /* offset of fd_aio_pkt_info_t  [ batch_cnt ] */
   ulong tx_stack_off;   /* offset of ulong              [ tx_depth  ] */
 
@@ -37,9 +38,21 @@ struct __attribute__((aligned(FD_XSK_AIO_ALIGN))) fd_xsk_aio_private {
 
   ulong   frame_sz;       /* Frame size from fd_xsk_params_t */
 
+  /* RX frames received but not yet accepted by the rx aio.  These are
+     rx_meta[0,rx_pend_cnt) / pkt[0,rx_pend_cnt) and are held back from
+     the fill ring until accepted. */
+
+  ulong   rx_pend_cnt;
+
+  /* RX diagnostics (accumulated over the lifetime of the xsk_aio) */
+
+  ulong   rx_defer_cnt;   /* frames kept pending after an rx aio send */
+  ulong   rx_drop_cnt;    /* frames rejected as untransmissable by the rx aio */
+
   /* Variable-length data *********************************************/
 
-  /* ... fd_xsk_frame_meta_t[ pkt_depth ] follows ... */
+  /* ... fd_xsk_frame_meta_t[ pkt_depth ] follows ... (tx scratch) */
+  /* ... fd_xsk_frame_meta_t[ pkt_depth ] follows ... (rx pending) */
   /* ... fd_aio_pkt_info_t  [ pkt_depth ] follows ... */
   /* ... ulong              [ tx_depth  ] follows ... */
 };
@@ -49,6 +62,11 @@ fd_xsk_aio_meta( fd_xsk_aio_t * xsk_aio ) {
   return (fd_xsk_frame_meta_t *)( (ulong)xsk_aio + xsk_aio->meta_off );
 }
 
+FD_FN_PURE static inline fd_xsk_frame_meta_t *
+fd_xsk_aio_rx_meta( fd_xsk_aio_t * xsk_aio ) {
+  return (fd_xsk_frame_meta_t *)( (ulong)xsk_aio + xsk_aio->rx_meta_off );
+}
+
 FD_FN_PURE static inline fd_aio_pkt_info_t *
 fd_xsk_aio_pkts( fd_xsk_aio_t * xsk_aio ) {
   return (fd_aio_pkt_info_t *)( (ulong)xsk_aio + xsk_aio->pkt_off );
@@ -80,6 +80,15 @@ struct __attribute__((aligned(FD_XSK_ALIGN))) fd_xsk_private {
 
   fd_xsk_params_t params;
 
+  /* umem_off:      Byte offset from the first byte of the fd_xsk_t to
+                    the first byte of the UMEM area (may be negative
+                    for UMEMs provided via fd_xsk_new_shumem).
+     umem_headroom: Headroom the kernel leaves in front of each packet
+                    in addition to XDP_PACKET_HEADROOM. */
+
+  long  umem_off;
+  ulong umem_headroom;
+
   /* xdp_mode: XDP processing mode.  Defined by <linux/if_link.h>
 
      Valid values:
@@ -0,0 +1,63 @@
+/* test_xdp_redirect_prog: Unit tests for the parts of the XDP redirect
+   program that are shared with the host (fd_xdp_redirect_prog.h). */
+
+#include "fd_xdp_redirect_prog.h"
+#include "../../util/fd_util.h"
+
+static void
+test_src_bucket( void ) {
+  ulong cost  = 1000UL;       /* 1M datagrams/s */
+  ulong burst = 4UL*cost;     /* 4 datagram burst */
+  ulong t0    = 1000000000UL;
+
+  /* A full bucket passes burst/cost datagrams at once */
+
+  fd_xdp_src_bucket_t bucket[1] = {{ .ts_ns=t0, .credit_ns=burst }};
+  for( ulong i=0UL; i<4UL; i++ ) FD_TEST( fd_xdp_src_bucket_take( bucket, t0, cost, burst )==1 );
+  FD_TEST( fd_xdp_src_bucket_take( bucket, t0, cost, burst )==0 );
+  FD_TEST( bucket->credit_ns==0UL );
+  FD_TEST( bucket->ts_ns    ==t0  );
+
+  /* Credit accrues at 1 ns per ns */
+
+  FD_TEST( fd_xdp_src_bucket_take( bucket, t0+cost-1UL, cost, burst )==0 );
+  FD_TEST( bucket->credit_ns==cost-1UL );
+  FD_TEST( fd_xdp_src_bucket_take( bucket, t0+cost,     cost, burst )==1 );
+  FD_TEST( bucket->credit_ns==0UL      );
+  FD_TEST( bucket->ts_ns    ==t0+cost  );
+
+  /* Credit is capped at burst, even after a very long quiet period */
+
+  FD_TEST( fd_xdp_src_bucket_take( bucket, ~0UL, cost, burst )==1 );
+  FD_TEST( bucket->credit_ns==burst-cost );
+  FD_TEST( bucket->ts_ns    ==~0UL       );
+
+  /* A now older than ts_ns (another CPU stored a newer timestamp)
+     must not refill the bucket or move ts_ns backward */
+
+  bucket->ts_ns     = t0;
+  bucket->credit_ns = 0UL;
+  for( ulong i=1UL; i<=8UL; i++ ) {
+    FD_TEST( fd_xdp_src_bucket_take( bucket, t0-i, cost, burst )==0 );
+    FD_TEST( bucket->credit_ns==0UL );
+    FD_TEST( bucket->ts_ns    ==t0  );
+  }
+
+  bucket->credit_ns = cost;
+  FD_TEST( fd_xdp_src_bucket_take( bucket, t0-1UL, cost, burst )==1 );
+  FD_TEST( fd_xdp_src_bucket_take( bucket, t0-1UL, cost, burst )==0 );
+  FD_TEST( bucket->credit_ns==0UL );
+  FD_TEST( bucket->ts_ns    ==t0  );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  test_src_bucket();
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -244,40 +244,45 @@ test_xsk( void ) {
   fd_memset( &test_xsk_ring_fr, 0, sizeof(test_xsk_ring_desc_t) );
   xsk->ring_fr.cached_prod = xsk->ring_fr.cached_cons = 0UL;
 
-  /* Test fd_xsk_rx_enqueue2 (fill ring) */
+  /* Test fd_xsk_rx_enqueue2 (fill ring).  RX offsets point into their
+     frame (past any headroom) and get rounded down to the frame. */
+
+#define META_OFF(n) (((n)*2048UL) + 256UL + (n))
 
   FD_TEST( fd_xsk_rx_enqueue2( xsk, NULL, 0UL )==0UL );
 
   {
     fd_xsk_frame_meta_t metas[ 3UL ] =
-      { {.off=0UL}, {.off=1UL}, {.off=2UL} };
+      { {.off=META_OFF(0UL)}, {.off=META_OFF(1UL)}, {.off=META_OFF(2UL)} };
     FD_TEST( fd_xsk_rx_enqueue2( xsk, metas, 3UL )==3UL );
     FD_TEST( test_xsk_ring_fr.prod==3UL );
   }
   {
     fd_xsk_frame_meta_t metas[ 6UL ] =
-      { {.off=3UL}, {.off=4UL}, {.off=5UL}, {.off=6UL}, {.off=7UL},
-        {.off=8UL} };
+      { {.off=META_OFF(3UL)}, {.off=META_OFF(4UL)}, {.off=META_OFF(5UL)}, {.off=META_OFF(6UL)}, {.off=META_OFF(7UL)},
+        {.off=META_OFF(8UL)} };
     FD_TEST( fd_xsk_rx_enqueue2( xsk, metas, 6UL )==5UL );
     FD_TEST( test_xsk_ring_fr.prod==8UL );
     FD_TEST( fd_xsk_rx_enqueue2( xsk, metas, 6UL )==0UL );
   }
 
   for( ulong i=0UL; i<8UL; i++ )
-    FD_TEST( test_xsk_ring_fr.frame_idxs[ i ]==i );
+    FD_TEST( test_xsk_ring_fr.frame_idxs[ i ]==i*2048UL );
 
   test_xsk_ring_fr.cons = 1UL;
 
   {
     fd_xsk_frame_meta_t metas[ 3UL ] =
-      { {.off=8UL}, {.off=9UL}, {.off=10UL} };
+      { {.off=META_OFF(8UL)}, {.off=META_OFF(9UL)}, {.off=META_OFF(10UL)} };
     FD_TEST( fd_xsk_rx_enqueue2( xsk, metas, 3UL )==1UL );
     FD_TEST( test_xsk_ring_fr.prod==9UL );
   }
 
-  FD_TEST  ( test_xsk_ring_fr.frame_idxs[ 0UL ]==8UL );
+#undef META_OFF
+
+  FD_TEST  ( test_xsk_ring_fr.frame_idxs[ 0UL ]==8UL*2048UL );
   for( ulong i=1UL; i<8UL; i++ )
-    FD_TEST( test_xsk_ring_fr.frame_idxs[ i   ]==i   );
+    FD_TEST( test_xsk_ring_fr.frame_idxs[ i   ]==i*2048UL   );
 
   /* Test fd_xsk_tx_enqueue */
 
@@ -438,6 +443,8 @@ static uchar _xsk_aio[ 16384UL ] __attribute__((aligned(FD_XSK_AIO_ALIGN)));
 static fd_aio_pkt_info_t const * _rx_batch;
 static ulong                     _rx_batch_cnt;
 static ulong                     _rx_call_cnt;
+static ulong                     _rx_accept_cnt = ULONG_MAX; /* frames the mock accepts per call */
+static int                       _rx_err        = FD_AIO_ERR_AGAIN; /* error if not all accepted */
 
 static fd_aio_t _rx;
 
@@ -447,7 +454,6 @@ test_xsk_aio_rx( void *                    ctx,
                  ulong                     batch_cnt,
                  ulong *                   opt_batch_idx ) {
   (void)ctx;
-  (void)opt_batch_idx;
 
   _rx_call_cnt++;
   FD_LOG_INFO(( "serving fd_xsk_aio callback" ));
@@ -459,7 +465,9 @@ test_xsk_aio_rx( void *                    ctx,
   _rx_batch     = batch;
   _rx_batch_cnt = batch_cnt;
 
-  return FD_AIO_SUCCESS;
+  if( _rx_accept_cnt>=batch_cnt ) return FD_AIO_SUCCESS;
+  if( opt_batch_idx ) *opt_batch_idx = _rx_accept_cnt;
+  return _rx_err;
 }
 
 void
@@ -485,7 +493,7 @@ test_xsk_aio( void ) {
 
   /* Create new XSK aio */
 
-  FD_TEST( fd_xsk_aio_footprint( 8UL, 8UL )==480UL            );
+  FD_TEST( fd_xsk_aio_footprint( 8UL, 8UL )==640UL            );
   FD_TEST( fd_xsk_aio_footprint( 8UL, 8UL )<=sizeof(_xsk_aio) );
   void * shxsk_aio = fd_xsk_aio_new( _xsk_aio, 8UL, 8UL );
   FD_TEST( shxsk_aio );
@@ -530,6 +538,7 @@ test_xsk_aio( void ) {
   /* Check alignment */
 
   FD_TEST( ( (ulong)fd_xsk_aio_meta    ( xsk_aio ) % alignof( fd_xsk_frame_meta_t ) )==0UL );
+  FD_TEST( ( (ulong)fd_xsk_aio_rx_meta ( xsk_aio ) % alignof( fd_xsk_frame_meta_t ) )==0UL );
   FD_TEST( ( (ulong)fd_xsk_aio_pkts    ( xsk_aio ) % alignof( fd_aio_pkt_info_t   ) )==0UL );
   FD_TEST( ( (ulong)fd_xsk_aio_tx_stack( xsk_aio ) % alignof( ulong               ) )==0UL );
 
@@ -638,6 +647,77 @@ test_xsk_aio( void ) {
     FD_TEST( _rx_batch[i].buf_sz==3U );
   }
 
+  FD_TEST( fd_xsk_aio_rx_pend_cnt ( xsk_aio )==0UL );
+  FD_TEST( fd_xsk_aio_rx_defer_cnt( xsk_aio )==0UL );
+  FD_TEST( fd_xsk_aio_rx_drop_cnt ( xsk_aio )==0UL );
+
+  /* Partially accepted receive: the rest stays pending and out of the
+     fill ring */
+
+  test_xsk_ring_fr.cons = 18U;
+  for( uint i=10U; i<14U; i++ )
+    test_xsk_ring_rx.packets[i%8UL] =
+      (struct xdp_desc) { .addr=(i%8)*2048U, .len=4U };
+  test_xsk_ring_rx.prod = 14U;
+
+  _rx_accept_cnt = 2UL;
+  fd_xsk_aio_service( xsk_aio );
+
+  FD_TEST( _rx_call_cnt==2UL );
+  FD_TEST( _rx_batch_cnt==4UL );
+  FD_TEST( test_xsk_ring_rx.cons==14U );
+  FD_TEST( test_xsk_ring_fr.prod==20U );
+  FD_TEST( test_xsk_ring_fr.frame_idxs[ 18U%8U ]==(10U%8U)*2048U );
+  FD_TEST( test_xsk_ring_fr.frame_idxs[ 19U%8U ]==(11U%8U)*2048U );
+  FD_TEST( fd_xsk_aio_rx_pend_cnt ( xsk_aio )==2UL );
+  FD_TEST( fd_xsk_aio_rx_defer_cnt( xsk_aio )==2UL );
+
+  /* Pending frames are redelivered first (nothing new arrived) */
+
+  _rx_accept_cnt = ULONG_MAX;
+  fd_xsk_aio_service( xsk_aio );
+
+  FD_TEST( _rx_call_cnt==3UL );
+  FD_TEST( _rx_batch_cnt==2UL );
+  FD_TEST( _rx_batch[0].buf==(void *)( umem_laddr + (12U%8U)*2048U ) );
+  FD_TEST( _rx_batch[1].buf==(void *)( umem_laddr + (13U%8U)*2048U ) );
+  FD_TEST( _rx_batch[0].buf_sz==4U );
+  FD_TEST( test_xsk_ring_fr.prod==22U );
+  FD_TEST( test_xsk_ring_fr.frame_idxs[ 20U%8U ]==(12U%8U)*2048U );
+  FD_TEST( test_xsk_ring_fr.frame_idxs[ 21U%8U ]==(13U%8U)*2048U );
+  FD_TEST( fd_xsk_aio_rx_pend_cnt ( xsk_aio )==0UL );
+  FD_TEST( fd_xsk_aio_rx_defer_cnt( xsk_aio )==2UL );
+
+  /* A rejected frame is dropped, the frames behind it stay pending */
+
+  for( uint i=14U; i<16U; i++ )
+    test_xsk_ring_rx.packets[i%8UL] =
+      (struct xdp_desc) { .addr=(i%8)*2048U, .len=5U };
+  test_xsk_ring_rx.prod = 16U;
+
+  _rx_accept_cnt = 0UL;
+  _rx_err        = FD_AIO_ERR_INVAL;
+  fd_xsk_aio_service( xsk_aio );
+
+  FD_TEST( _rx_call_cnt==4UL );
+  FD_TEST( _rx_batch_cnt==2UL );
+  FD_TEST( test_xsk_ring_fr.prod==23U );
+  FD_TEST( test_xsk_ring_fr.frame_idxs[ 22U%8U ]==(14U%8U)*2048U );
+  FD_TEST( fd_xsk_aio_rx_pend_cnt ( xsk_aio )==1UL );
+  FD_TEST( fd_xsk_aio_rx_defer_cnt( xsk_aio )==3UL );
+  FD_TEST( fd_xsk_aio_rx_drop_cnt ( xsk_aio )==1UL );
+
+  _rx_accept_cnt = ULONG_MAX;
+  _rx_err        = FD_AIO_ERR_AGAIN;
+  fd_xsk_aio_service( xsk_aio );
+
+  FD_TEST( _rx_call_cnt==5UL );
+  FD_TEST( _rx_batch_cnt==1UL );
+  FD_TEST( _rx_batch[0].buf==(void *)( umem_laddr + (15U%8U)*2048U ) );
+  FD_TEST( test_xsk_ring_fr.prod==24U );
+  FD_TEST( fd_xsk_aio_rx_pend_cnt ( xsk_aio )==0UL );
+  FD_TEST( fd_xsk_aio_rx_drop_cnt ( xsk_aio )==1UL );
+
   /* Clean up */
 
   FD_TEST( fd_xsk_aio_leave ( xsk_aio   ) );
@@ -1114,25 +1114,22 @@ fd_alloc_is_empty( fd_alloc_t * join ) {
   ulong       lo   = fd_wksp_gaddr_fast( wksp, alloc );
   ulong       hi   = lo + FD_ALLOC_FOOTPRINT;
 
-  ulong part_idx;
-  ulong part_cnt;
+  uint part_idx;
 
   fd_wksp_private_lock( wksp );
 
-  fd_wksp_private_part_t * part     = wksp->part;
-  /**/                     part_cnt = wksp->part_cnt;
-  for( part_idx=0UL; part_idx<part_cnt; part_idx++ ) {
-    ulong p = part[ part_idx ];
-    if( FD_UNLIKELY( fd_wksp_private_part_tag( p )==tag ) ) { /* optimize for leak detection case */
-      ulong plo = fd_wksp_private_part_gaddr( p );
-      ulong phi = fd_wksp_private_part_gaddr( part[ part_idx+1UL ] );
+  fd_wksp_private_pinfo_t const * pinfo = wksp->pinfo;
+  for( part_idx=wksp->head_cidx; part_idx!=FD_WKSP_PRIVATE_PINFO_IDX_NULL; part_idx=pinfo[ part_idx ].next_cidx ) {
+    if( FD_UNLIKELY( pinfo[ part_idx ].tag==tag ) ) { /* optimize for leak detection case */
+      ulong plo = pinfo[ part_idx ].gaddr_lo;
+      ulong phi = pinfo[ part_idx ].gaddr_hi;
       if( FD_UNLIKELY( !((plo<=lo) & (hi<=phi)) ) ) break; /* optimize for leak detection case, note lo<hi guaranteed */
     }
   }
 
   fd_wksp_private_unlock( wksp );
 
-  return part_idx==part_cnt;
+  return part_idx==FD_WKSP_PRIVATE_PINFO_IDX_NULL;
 }
 
 /**********************************************************************/
@@ -1341,19 +1338,17 @@ fd_alloc_fprintf( fd_alloc_t * join,
 
     ulong tag = alloc->tag;
 
-    fd_wksp_private_part_t * part     = wksp->part;
-    ulong                    part_cnt = wksp->part_cnt;
-    for( ulong part_idx=0UL; part_idx<part_cnt; part_idx++ ) {
-      ulong p = part[ part_idx ];
-      if( fd_wksp_private_part_tag( p )!=tag ) continue;
-      ulong gaddr_lo = fd_wksp_private_part_gaddr( p );
+    fd_wksp_private_pinfo_t const * pinfo = wksp->pinfo;
+    for( uint part_idx=wksp->head_cidx; part_idx!=FD_WKSP_PRIVATE_PINFO_IDX_NULL; part_idx=pinfo[ part_idx ].next_cidx ) {
+      if( pinfo[ part_idx ].tag!=tag ) continue;
+      ulong gaddr_lo = pinfo[ part_idx ].gaddr_lo;
 
       /* If the user used the same tag for both the alloc metadata and the
          alloc allocations, skip the metadata partition */
 
       if( gaddr_lo==fd_wksp_gaddr_fast( wksp, alloc ) ) continue;
 
-      ulong gaddr_hi       = fd_wksp_private_part_gaddr( part[ part_idx+1UL ] );
+      ulong gaddr_hi       = pinfo[ part_idx ].gaddr_hi;
       ulong part_footprint = gaddr_hi - gaddr_lo;
 
       if( FD_UNLIKELY( part_footprint<=sizeof(fd_alloc_hdr_t) ) ) continue; /* Skip over holes (FIXME: log?) */
@@ -10,11 +10,12 @@
 //#include "env/fd_env.h"           /* includes cstr/fd_cstr.h */
 //#include "log/fd_log.h"           /* includes env/fd_env.h */
 //#include "shmem/fd_shmem.h"       /* includes log/fd_log.h sanitize/fd_sanitize.h  */
-//#include "wksp/fd_wksp.h"         /* includes shmem/fd_shmem.h pod/fd_pod.h */
+//#include "wksp/fd_wksp.h"         /* includes shmem/fd_shmem.h pod/fd_pod.h tpool/fd_tpool.h */
 #include "math/fd_stat.h"           /* includes bits/fd_bits.h */
 #include "rng/fd_rng.h"             /* includes bits/fd_bits.h */
 #include "scratch/fd_scratch.h"     /* includes log/fd_log.h */
 #include "tile/fd_tile.h"           /* includes shmem/fd_shmem.h */
+#include "tpool/fd_tpool.h"         /* includes tile/fd_tile.h */
 #include "alloc/fd_alloc.h"         /* includes wksp/fd_wksp.h */
 
 /* Additional fd_util APIs that are not included by default */
@@ -29,6 +30,7 @@
 //#include "bits/fd_uwide.h" /* includes bits/fd_bits.h */
 //#include "math/fd_sqrt.h"  /* includes bits/fd_bits.h */
 //#include "math/fd_fxp.h"   /* includes math/fd_sqrt.h, (!FD_HAS_INT128) bits/fd_uwide.h */
+//#include "math/fd_qsketch.h" /* includes log/fd_log.h */
 //#include "simd/fd_sse.h"   /* includes bits/fd_bits.h, requires FD_HAS_SSE */
 //#include "simd/fd_avx.h"   /* includes bits/fd_bits.h, requires FD_HAS_AVX */
 
@@ -1,9 +1,10 @@
-$(call add-hdrs,fd_sqrt.h fd_fxp.h fd_stat.h)
-$(call add-objs,fd_stat,fd_util)
+$(call add-hdrs,fd_sqrt.h fd_fxp.h fd_stat.h fd_qsketch.h)
+$(call add-objs,fd_stat fd_qsketch,fd_util)
 $(call make-unit-test,test_sqrt,test_sqrt,fd_util)
 $(call make-unit-test,test_fxp,test_fxp,fd_util)
 $(call make-unit-test,test_stat,test_stat,fd_util)
+$(call make-unit-test,test_qsketch,test_qsketch,fd_util)
 $(call run-unit-test,test_sqrt,)
 $(call run-unit-test,test_fxp,)
 $(call run-unit-test,test_stat,)
-
+$(call run-unit-test,test_qsketch,)
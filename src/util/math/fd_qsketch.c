@@ -0,0 +1,266 @@
+#include "fd_qsketch.h"
+
+#if FD_HAS_DOUBLE
+
+#include <math.h>
+
+#define FD_QSKETCH_MAGIC (0xf17eda2c3795e7c0UL) /* firedancer qsketch ver 0 */
+
+struct __attribute__((aligned(FD_QSKETCH_ALIGN))) fd_qsketch_private {
+  ulong  magic;        /* == FD_QSKETCH_MAGIC */
+  ulong  bucket_cnt;   /* In [3,FD_QSKETCH_BUCKET_MAX] */
+  double alpha;
+  double min;
+  double max;
+  double ln_gamma;     /* ln( (1+alpha)/(1-alpha) ) */
+  double inv_ln_gamma; /* 1/ln_gamma */
+  double key_min;      /* Key of min (an integer) */
+  ulong  cnt;          /* Number of samples inserted */
+
+  /* bucket_cnt ulong counts follow here (aligned FD_QSKETCH_ALIGN).
+     Bucket 0 counts samples in [0,min).  Bucket i>0 counts samples
+     with key key_min+i-1 (the top bucket also counts the samples larger
+     than max). */
+};
+
+FD_STATIC_ASSERT( sizeof(fd_qsketch_t)==FD_QSKETCH_ALIGN, layout );
+
+static inline ulong *
+fd_qsketch_private_bucket( fd_qsketch_t * sketch ) {
+  return (ulong *)(sketch+1);
+}
+
+static inline ulong const *
+fd_qsketch_private_bucket_const( fd_qsketch_t const * sketch ) {
+  return (ulong const *)(sketch+1);
+}
+
+/* fd_qsketch_private_bucket_cnt returns the number of buckets needed
+   for the given configuration and 0 if the configuration is invalid. */
+
+static ulong
+fd_qsketch_private_bucket_cnt( double alpha,
+                               double min,
+                               double max ) {
+  if( FD_UNLIKELY( !((0.<alpha) & (alpha<=0.5)) ) ) return 0UL;
+  if( FD_UNLIKELY( !((0.<min) & (min<max) & (max<=DBL_MAX)) ) ) return 0UL;
+  double inv_ln_gamma = 1. / log( (1.+alpha)/(1.-alpha) );
+  double cnt = ceil( log( max )*inv_ln_gamma ) - ceil( log( min )*inv_ln_gamma ) + 2.;
+  if( FD_UNLIKELY( !(cnt<=(double)FD_QSKETCH_BUCKET_MAX) ) ) return 0UL;
+  return (ulong)cnt;
+}
+
+ulong
+fd_qsketch_align( void ) {
+  return FD_QSKETCH_ALIGN;
+}
+
+ulong
+fd_qsketch_footprint( double alpha,
+                      double min,
+                      double max ) {
+  ulong bucket_cnt = fd_qsketch_private_bucket_cnt( alpha, min, max );
+  if( FD_UNLIKELY( !bucket_cnt ) ) return 0UL;
+  return sizeof(fd_qsketch_t) + fd_ulong_align_up( bucket_cnt*sizeof(ulong), FD_QSKETCH_ALIGN );
+}
+
+void *
+fd_qsketch_new( void * shmem,
+                double alpha,
+                double min,
+                double max ) {
+
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, fd_qsketch_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  ulong footprint = fd_qsketch_footprint( alpha, min, max );
+  if( FD_UNLIKELY( !footprint ) ) {
+    FD_LOG_WARNING(( "bad configuration (alpha %g, min %g, max %g)", alpha, min, max ));
+    return NULL;
+  }
+
+  fd_qsketch_t * sketch = (fd_qsketch_t *)shmem;
+
+  memset( sketch, 0, footprint );
+
+  sketch->bucket_cnt   = fd_qsketch_private_bucket_cnt( alpha, min, max );
+  sketch->alpha        = alpha;
+  sketch->min          = min;
+  sketch->max          = max;
+  sketch->ln_gamma     = log( (1.+alpha)/(1.-alpha) );
+  sketch->inv_ln_gamma = 1. / sketch->ln_gamma;
+  sketch->key_min      = ceil( log( min )*sketch->inv_ln_gamma );
+  sketch->cnt          = 0UL;
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( sketch->magic ) = FD_QSKETCH_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return shmem;
+}
+
+fd_qsketch_t *
+fd_qsketch_join( void * shsketch ) {
+
+  if( FD_UNLIKELY( !shsketch ) ) {
+    FD_LOG_WARNING(( "NULL shsketch" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shsketch, fd_qsketch_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shsketch" ));
+    return NULL;
+  }
+
+  fd_qsketch_t * sketch = (fd_qsketch_t *)shsketch;
+
+  if( FD_UNLIKELY( sketch->magic!=FD_QSKETCH_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  return sketch;
+}
+
+void *
+fd_qsketch_leave( fd_qsketch_t * sketch ) {
+
+  if( FD_UNLIKELY( !sketch ) ) {
+    FD_LOG_WARNING(( "NULL sketch" ));
+    return NULL;
+  }
+
+  return (void *)sketch;
+}
+
+void *
+fd_qsketch_delete( void * shsketch ) {
+
+  if( FD_UNLIKELY( !shsketch ) ) {
+    FD_LOG_WARNING(( "NULL shsketch" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shsketch, fd_qsketch_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shsketch" ));
+    return NULL;
+  }
+
+  fd_qsketch_t * sketch = (fd_qsketch_t *)shsketch;
+
+  if( FD_UNLIKELY( sketch->magic!=FD_QSKETCH_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( sketch->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return shsketch;
+}
+
+double fd_qsketch_alpha     ( fd_qsketch_t const * sketch ) { return sketch->alpha;      }
+double fd_qsketch_min       ( fd_qsketch_t const * sketch ) { return sketch->min;        }
+double fd_qsketch_max       ( fd_qsketch_t const * sketch ) { return sketch->max;        }
+ulong  fd_qsketch_bucket_cnt( fd_qsketch_t const * sketch ) { return sketch->bucket_cnt; }
+
+ulong fd_qsketch_cnt( fd_qsketch_t const * sketch ) { return FD_VOLATILE_CONST( sketch->cnt ); }
+
+void
+fd_qsketch_insert( fd_qsketch_t * sketch,
+                   double         x ) {
+  ulong idx = 0UL;
+  if( FD_LIKELY( x>=sketch->min ) ) {
+    /* key(x)-key(min) is non-negative as log is monotonic.  The clamp
+       handles samples larger than max (including inf). */
+    double k = ceil( log( x )*sketch->inv_ln_gamma ) - sketch->key_min;
+    idx = 1UL + (ulong)fmin( fmax( k, 0. ), (double)(sketch->bucket_cnt-2UL) );
+  }
+  ulong * bucket = fd_qsketch_private_bucket( sketch );
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( bucket[ idx ] ) = bucket[ idx ] + 1UL;
+  FD_VOLATILE( sketch->cnt   ) = sketch->cnt + 1UL;
+  FD_COMPILER_MFENCE();
+}
+
+fd_qsketch_t *
+fd_qsketch_reset( fd_qsketch_t * sketch ) {
+  ulong * bucket     = fd_qsketch_private_bucket( sketch );
+  ulong   bucket_cnt = sketch->bucket_cnt;
+  FD_COMPILER_MFENCE();
+  for( ulong idx=0UL; idx<bucket_cnt; idx++ ) FD_VOLATILE( bucket[ idx ] ) = 0UL;
+  FD_VOLATILE( sketch->cnt ) = 0UL;
+  FD_COMPILER_MFENCE();
+  return sketch;
+}
+
+fd_qsketch_t *
+fd_qsketch_merge( fd_qsketch_t *       dst,
+                  fd_qsketch_t const * src ) {
+
+  if( FD_UNLIKELY( (dst->bucket_cnt!=src->bucket_cnt) | (dst->alpha!=src->alpha) |
+                   (dst->min       !=src->min       ) | (dst->max  !=src->max  ) ) ) {
+    FD_LOG_WARNING(( "incompatible sketches" ));
+    return NULL;
+  }
+
+  ulong *       dst_bucket = fd_qsketch_private_bucket      ( dst );
+  ulong const * src_bucket = fd_qsketch_private_bucket_const( src );
+  ulong         bucket_cnt = dst->bucket_cnt;
+
+  ulong cnt = 0UL;
+  FD_COMPILER_MFENCE();
+  for( ulong idx=0UL; idx<bucket_cnt; idx++ ) {
+    ulong c = FD_VOLATILE_CONST( src_bucket[ idx ] );
+    FD_VOLATILE( dst_bucket[ idx ] ) = dst_bucket[ idx ] + c;
+    cnt += c;
+  }
+  FD_VOLATILE( dst->cnt ) = dst->cnt + cnt;
+  FD_COMPILER_MFENCE();
+
+  return dst;
+}
+
+double
+fd_qsketch_quantile( fd_qsketch_t const * sketch,
+                     double               q ) {
+  ulong const * bucket     = fd_qsketch_private_bucket_const( sketch );
+  ulong         bucket_cnt = sketch->bucket_cnt;
+
+  /* Count the samples in the buckets (rather than using sketch->cnt)
+     such that the rank is consistent with what we scan below, modulo
+     concurrent inserts. */
+
+  ulong cnt = 0UL;
+  FD_COMPILER_MFENCE();
+  for( ulong idx=0UL; idx<bucket_cnt; idx++ ) cnt += FD_VOLATILE_CONST( bucket[ idx ] );
+  FD_COMPILER_MFENCE();
+  if( FD_UNLIKELY( !cnt ) ) return 0.;
+
+  ulong rank = (q<=0.) ? 0UL : (q>=1.) ? (cnt-1UL) : fd_ulong_min( (ulong)(q*(double)(cnt-1UL)), cnt-1UL );
+
+  ulong sum = 0UL;
+  ulong idx = 0UL;
+  for( ; idx<bucket_cnt-1UL; idx++ ) {
+    sum += FD_VOLATILE_CONST( bucket[ idx ] );
+    if( sum>rank ) break;
+  }
+  if( !idx ) return 0.;
+
+  /* Bucket idx covers (gamma^(k-1),gamma^k] where k = key_min+idx-1.
+     2 gamma^k / (gamma+1) is within a relative error alpha of every
+     value in the bucket. */
+
+  double k = sketch->key_min + (double)(idx-1UL);
+  return exp( k*sketch->ln_gamma ) * (1.-sketch->alpha);
+}
+
+#endif /* FD_HAS_DOUBLE */
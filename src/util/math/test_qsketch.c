@@ -0,0 +1,188 @@
+#include "../fd_util.h"
+#include "fd_qsketch.h"
+
+#if FD_HAS_DOUBLE
+
+#include <math.h>
+
+FD_STATIC_ASSERT( FD_QSKETCH_ALIGN==128UL, unit_test );
+
+#define CNT_MAX (200001UL) /* Odd such that fd_stat_median is a sample */
+
+static uchar  mem0[ 1UL<<16 ] __attribute__((aligned(FD_QSKETCH_ALIGN)));
+static uchar  mem1[ 1UL<<16 ] __attribute__((aligned(FD_QSKETCH_ALIGN)));
+static uchar  mem2[ 1UL<<16 ] __attribute__((aligned(FD_QSKETCH_ALIGN)));
+static double x   [ CNT_MAX ];
+static double tmp [ CNT_MAX ];
+
+/* rand_sample returns a random sample from one of a few latency like
+   distributions (including samples outside [min,max) for dist 3). */
+
+static double
+rand_sample( fd_rng_t * rng,
+             int        dist ) {
+  switch( dist ) {
+  case 0:  return 1000.*fd_rng_double_exp( rng );                     /* exponential */
+  case 1:  return exp( 5. + 2.*fd_rng_double_norm( rng ) );           /* log normal, heavy tail */
+  case 2:  return 100. + 10.*fd_rng_double_c0( rng );                 /* narrow uniform */
+  default: return ldexp( fd_rng_double_c0( rng ), fd_rng_int_roll( rng, 48 ) - 8 ); /* very wide, below min too */
+  }
+}
+
+/* check tests that est is within the sketch's error bound of exact
+   (the sample of the corresponding rank). */
+
+static void
+check( fd_qsketch_t const * sketch,
+       double               est,
+       double               exact ) {
+  double alpha = fd_qsketch_alpha( sketch );
+  double min   = fd_qsketch_min  ( sketch );
+  double max   = fd_qsketch_max  ( sketch );
+  if( exact<min )      FD_TEST( est==0. );
+  else if( exact<=max ) {
+    if( !( fabs( est-exact ) <= alpha*exact*(1.+1e-9) ) )
+      FD_LOG_ERR(( "FAIL: est %.17g exact %.17g alpha %g", est, exact, alpha ));
+  }
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  /* Test configuration */
+
+  FD_TEST( fd_qsketch_align()==FD_QSKETCH_ALIGN );
+
+  FD_TEST( !fd_qsketch_footprint( 0.,    1., 2.      ) ); /* bad alpha */
+  FD_TEST( !fd_qsketch_footprint( 0.6,   1., 2.      ) ); /* bad alpha */
+  FD_TEST( !fd_qsketch_footprint( 0.01,  0., 2.      ) ); /* bad min   */
+  FD_TEST( !fd_qsketch_footprint( 0.01,  2., 1.      ) ); /* bad max   */
+  FD_TEST( !fd_qsketch_footprint( 0.01,  1., 1.      ) ); /* bad max   */
+  FD_TEST( !fd_qsketch_footprint( 0.01,  1., DBL_MAX*2. ) ); /* bad max */
+  FD_TEST( !fd_qsketch_footprint( 1e-9,  1., 1e12    ) ); /* too many buckets */
+
+  ulong footprint = fd_qsketch_footprint( 0.01, 1., 1e12 );
+  FD_TEST( footprint );
+  FD_TEST( fd_ulong_is_aligned( footprint, FD_QSKETCH_ALIGN ) );
+  FD_TEST( footprint<=sizeof(mem0) );
+  FD_LOG_NOTICE(( "alpha 0.01 range [1,1e12]: footprint %lu", footprint ));
+
+  FD_TEST( !fd_qsketch_new( NULL,   0.01, 1., 1e12 ) ); /* NULL shmem */
+  FD_TEST( !fd_qsketch_new( mem0+1, 0.01, 1., 1e12 ) ); /* misaligned */
+  FD_TEST( !fd_qsketch_new( mem0,   0.7,  1., 1e12 ) ); /* bad config */
+
+  for( ulong trial=0UL; trial<16UL; trial++ ) {
+    double alpha = trial<4UL ? 0.01 : (0.001 + 0.05*fd_rng_double_c0( rng ));
+    double min   = 1.;
+    double max   = 1e12;
+    int    dist  = (int)(trial & 3UL);
+
+    void *         sh0 = fd_qsketch_new( mem0, alpha, min, max ); FD_TEST( sh0==mem0 );
+    void *         sh1 = fd_qsketch_new( mem1, alpha, min, max ); FD_TEST( sh1==mem1 );
+    void *         sh2 = fd_qsketch_new( mem2, alpha, min, max ); FD_TEST( sh2==mem2 );
+    fd_qsketch_t * s0  = fd_qsketch_join( sh0 );                  FD_TEST( s0 );
+    fd_qsketch_t * s1  = fd_qsketch_join( sh1 );                  FD_TEST( s1 );
+    fd_qsketch_t * s2  = fd_qsketch_join( sh2 );                  FD_TEST( s2 );
+
+    FD_TEST( fd_qsketch_alpha( s0 )==alpha );
+    FD_TEST( fd_qsketch_min  ( s0 )==min   );
+    FD_TEST( fd_qsketch_max  ( s0 )==max   );
+    FD_TEST( fd_qsketch_cnt  ( s0 )==0UL   );
+    FD_TEST( fd_qsketch_quantile( s0, 0.5 )==0. );
+
+    /* Insert samples into s0, the first half into s1 and the rest into
+       s2 */
+
+    ulong cnt = 1UL + 2UL*fd_rng_ulong_roll( rng, CNT_MAX/2UL );
+    for( ulong i=0UL; i<cnt; i++ ) {
+      x[i] = rand_sample( rng, dist );
+      fd_qsketch_insert( s0, x[i] );
+      fd_qsketch_insert( (i<cnt/2UL) ? s1 : s2, x[i] );
+    }
+    FD_TEST( fd_qsketch_cnt( s0 )==cnt );
+
+    /* Median should match fd_stat_median to within the error bound */
+
+    memcpy( tmp, x, cnt*sizeof(double) );
+    double med = fd_stat_median_double( tmp, cnt );
+    check( s0, fd_qsketch_quantile( s0, 0.5 ), med );
+
+    /* As should the other quantiles */
+
+    memcpy( tmp, x, cnt*sizeof(double) );
+    fd_sort_up_double_inplace( tmp, cnt );
+    static double const q[9] = { 0., 0.01, 0.1, 0.25, 0.5, 0.9, 0.99, 0.999, 1. };
+    for( ulong j=0UL; j<9UL; j++ ) check( s0, fd_qsketch_quantile( s0, q[j] ), tmp[ (ulong)(q[j]*(double)(cnt-1UL)) ] );
+    for( ulong j=0UL; j<1000UL; j++ ) {
+      double qj = fd_rng_double_c( rng );
+      check( s0, fd_qsketch_quantile( s0, qj ), tmp[ (ulong)(qj*(double)(cnt-1UL)) ] );
+    }
+
+    /* Merging the halves should give exactly the same sketch */
+
+    FD_TEST( fd_qsketch_merge( s1, s2 )==s1 );
+    FD_TEST( fd_qsketch_cnt( s1 )==cnt );
+    for( ulong j=0UL; j<1000UL; j++ ) {
+      double qj = fd_rng_double_c( rng );
+      FD_TEST( fd_qsketch_quantile( s1, qj )==fd_qsketch_quantile( s0, qj ) );
+    }
+
+    FD_LOG_NOTICE(( "dist %i alpha %.4f cnt %6lu (%lu buckets): median %12.4g (exact %12.4g) p99 %12.4g (exact %12.4g)",
+                    dist, alpha, cnt, fd_qsketch_bucket_cnt( s0 ),
+                    fd_qsketch_quantile( s0, 0.5  ), med,
+                    fd_qsketch_quantile( s0, 0.99 ), tmp[ (ulong)(0.99*(double)(cnt-1UL)) ] ));
+
+    /* Test reset */
+
+    FD_TEST( fd_qsketch_reset( s2 )==s2 );
+    FD_TEST( fd_qsketch_cnt( s2 )==0UL );
+    FD_TEST( fd_qsketch_quantile( s2, 0.5 )==0. );
+
+    FD_TEST( fd_qsketch_leave( s2 )==sh2 ); FD_TEST( fd_qsketch_delete( sh2 )==mem2 );
+    FD_TEST( fd_qsketch_leave( s1 )==sh1 ); FD_TEST( fd_qsketch_delete( sh1 )==mem1 );
+    FD_TEST( fd_qsketch_leave( s0 )==sh0 ); FD_TEST( fd_qsketch_delete( sh0 )==mem0 );
+  }
+
+  /* Test merge of incompatible sketches and join / leave / delete
+     failure cases */
+
+  fd_qsketch_t * s0 = fd_qsketch_join( fd_qsketch_new( mem0, 0.01, 1., 1e12 ) ); FD_TEST( s0 );
+  fd_qsketch_t * s1 = fd_qsketch_join( fd_qsketch_new( mem1, 0.02, 1., 1e12 ) ); FD_TEST( s1 );
+  FD_TEST( !fd_qsketch_merge( s0, s1 ) );
+
+  FD_TEST( !fd_qsketch_join( NULL   ) ); /* NULL shsketch */
+  FD_TEST( !fd_qsketch_join( mem0+1 ) ); /* misaligned    */
+  FD_TEST( !fd_qsketch_join( mem2   ) ); /* bad magic     */
+
+  FD_TEST( !fd_qsketch_leave( NULL ) );
+
+  FD_TEST( !fd_qsketch_delete( NULL   ) ); /* NULL shsketch */
+  FD_TEST( !fd_qsketch_delete( mem0+1 ) ); /* misaligned    */
+  FD_TEST( !fd_qsketch_delete( mem2   ) ); /* bad magic     */
+
+  FD_TEST( fd_qsketch_delete( fd_qsketch_leave( s1 ) )==mem1 );
+  FD_TEST( fd_qsketch_delete( fd_qsketch_leave( s0 ) )==mem0 );
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_DOUBLE capability" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
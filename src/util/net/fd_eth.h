@@ -209,17 +209,32 @@ fd_eth_mac_is_ip4_mcast( uchar const * mac ) {
 
    if buf/sz are the concatenation with no padding of the parts.
    
-   The FCS computation under the hood is the IEEE802.3 crc32.  This
-   currently is not a particularly fast implementation (byte at a time
-   table lookup based) nor a particularly good hash function
-   theoretically.  Rather, this is here for the rare application that
-   needs to manually compute / validate an Ethernet FCS. */
+   The FCS computation under the hood is the IEEE802.3 crc32.  The
+   implementation is selected by build target.  On targets with
+   PCLMULQDQ (e.g. FD_HAS_SSE targets built for haswell or later), 64
+   bytes are folded in per iteration with carry-less multiplies.  On
+   targets that additionally have AVX-512 VPCLMULQDQ (e.g. built for
+   icelake or later), 256 bytes are folded in per iteration.  Otherwise
+   (and for short buffers and trailing bytes), this is a byte at a time
+   table lookup.  Results are identical for all implementations.  It is
+   not a particularly good hash function theoretically; rather, this is
+   here for applications that need to compute / validate an Ethernet
+   FCS (or an IEEE802.3 crc32 generally).
+
+   fd_eth_fcs_append_ref is the portable table lookup implementation
+   with the same semantics as fd_eth_fcs_append.  It is provided for
+   testing and benchmarking. */
 
 FD_FN_PURE uint
 fd_eth_fcs_append( uint         fcs,
                    void const * buf,
                    ulong        sz );
 
+FD_FN_PURE uint
+fd_eth_fcs_append_ref( uint         fcs,
+                       void const * buf,
+                       ulong        sz );
+
 FD_FN_PURE static inline uint
 fd_eth_fcs( void const * buf,
             ulong        sz ) {
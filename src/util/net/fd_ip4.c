@@ -0,0 +1,37 @@
+#include "fd_ip4.h"
+
+#if FD_HAS_AVX
+#include "../simd/fd_avx.h"
+#endif
+
+ulong
+fd_ip4_csum_append( ulong        sum,
+                    void const * buf,
+                    ulong        sz ) {
+  uchar const * p = (uchar const *)buf;
+
+# if FD_HAS_AVX
+
+  /* Sum the 32-bit words of 64 bytes per iteration into 64-bit lanes.
+     Each lane grows by less than 2^33 per iteration so this cannot
+     overflow for any practical sz.  As the final fold is modulo 2^16-1,
+     how the words are paired up into lanes does not matter. */
+
+  wl_t mask = wl_bcast( 0xffffffffL );
+  wl_t a0   = wl_zero();
+  wl_t a1   = wl_zero();
+  for( ; sz>=64UL; p+=64UL, sz-=64UL ) {
+    wl_t x0 = wl_ldu( (long const *)(p     ) );
+    wl_t x1 = wl_ldu( (long const *)(p+32UL) );
+    a0 = wl_add( a0, wl_add( wl_and( x0, mask ), wl_shru( x0, 32 ) ) );
+    a1 = wl_add( a1, wl_add( wl_and( x1, mask ), wl_shru( x1, 32 ) ) );
+  }
+  sum += (ulong)wl_extract( wl_sum_all( wl_add( a0, a1 ) ), 0 );
+
+# endif
+
+  for( ; sz>=4UL; p+=4UL, sz-=4UL ) sum += (ulong)fd_uint_load_4( p );
+  if( sz>=2UL ) { sum += (ulong)fd_ushort_load_2( p ); p += 2UL; sz -= 2UL; }
+  if( sz      )   sum += (ulong)p[0]; /* Zero padded to an even length */
+  return sum;
+}
@@ -1,9 +1,17 @@
+#define _DEFAULT_SOURCE /* for madvise */
 #include "fd_pcap.h"
 
 #if FD_HAS_HOSTED
 
 #include <stdio.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define FD_PCAP_MAGIC_USEC (0xa1b2c3d4U)
+#define FD_PCAP_MAGIC_NSEC (0xa1b23c4dU)
 
 #define FD_PCAP_HDR_NETWORK_ETHERNET  (1U)
 #define FD_PCAP_HDR_NETWORK_LINUX_SLL (113U)
@@ -37,6 +45,25 @@ typedef struct {
   ushort net_type;
 } fd_pcap_sll_hdr_t;
 
+/* fd_pcap_sll_to_eth constructs an ethernet compatible header that
+   encodes the sll header info in a reasonable way */
+
+static void
+fd_pcap_sll_to_eth( fd_eth_hdr_t *            hdr,
+                    fd_pcap_sll_hdr_t const * sll ) {
+  hdr->dst[0] = (uchar)(sll->dir    ); hdr->dst[1] = (uchar)(sll->dir     >> 8);
+  hdr->dst[2] = (uchar)(sll->ha_type); hdr->dst[3] = (uchar)(sll->ha_type >> 8);
+  hdr->dst[4] = (uchar)(sll->ha_len ); hdr->dst[5] = (uchar)(sll->ha_len  >> 8);
+  hdr->src[0] = sll->ha[0];            hdr->src[1] = sll->ha[1];
+  hdr->src[2] = sll->ha[2];            hdr->src[3] = sll->ha[3];
+  hdr->src[4] = sll->ha[4];            hdr->src[5] = sll->ha[5];
+  hdr->net_type = sll->net_type;
+
+  hdr->dst[0] = (uchar)(((ulong)hdr->dst[0] & ~3UL) | 2UL); /* Mark as a local admin unicast MAC */
+  hdr->src[0] = (uchar)(((ulong)hdr->src[0] & ~3UL) | 2UL); /* " */
+  /* FIXME: ENCODE LOST BITS TOO? */
+}
+
 fd_pcap_iter_t *
 fd_pcap_iter_new( void * _file ) {
   FILE * file = (FILE *)_file;
@@ -57,8 +84,8 @@ fd_pcap_iter_new( void * _file ) {
     return NULL;
   }
 
-  if( FD_UNLIKELY( !((pcap->magic_number==0xa1b2c3d4U) |
-                     (pcap->magic_number==0xa1b23c4dU) ) ) ) {
+  if( FD_UNLIKELY( !((pcap->magic_number==FD_PCAP_MAGIC_USEC) |
+                     (pcap->magic_number==FD_PCAP_MAGIC_NSEC) ) ) ) {
     FD_LOG_WARNING(( "not a supported pcap file (bad magic number)" ));
     return NULL;
   }
@@ -117,20 +144,7 @@ fd_pcap_iter_next( fd_pcap_iter_t * iter,
       return 0UL;
     }
 
-    /* Construct an ethernet compatible header that encodes the sll
-       header info in a reasonable way */
-
-    hdr->dst[0] = (uchar)(sll->dir    ); hdr->dst[1] = (uchar)(sll->dir     >> 8);
-    hdr->dst[2] = (uchar)(sll->ha_type); hdr->dst[3] = (uchar)(sll->ha_type >> 8);
-    hdr->dst[4] = (uchar)(sll->ha_len ); hdr->dst[5] = (uchar)(sll->ha_len  >> 8);
-    hdr->src[0] = sll->ha[0];            hdr->src[1] = sll->ha[1];
-    hdr->src[2] = sll->ha[2];            hdr->src[3] = sll->ha[3];
-    hdr->src[4] = sll->ha[4];            hdr->src[5] = sll->ha[5];
-    hdr->net_type = sll->net_type;
-
-    hdr->dst[0] = (uchar)(((ulong)hdr->dst[0] & ~3UL) | 2UL); /* Mark as a local admin unicast MAC */
-    hdr->src[0] = (uchar)(((ulong)hdr->src[0] & ~3UL) | 2UL); /* " */
-    /* FIXME: ENCODE LOST BITS TOO? */
+    fd_pcap_sll_to_eth( hdr, sll );
 
     pkt_sz -= sizeof(fd_pcap_sll_hdr_t);
     pkt_sz += sizeof(fd_eth_hdr_t);
@@ -159,7 +173,7 @@ fd_pcap_iter_next( fd_pcap_iter_t * iter,
 ulong
 fd_pcap_fwrite_hdr( void * file ) {
   fd_pcap_hdr_t hdr[1];
-  hdr->magic_number  = 0xa1b23c4dU;
+  hdr->magic_number  = FD_PCAP_MAGIC_NSEC;
   hdr->version_major = (ushort)2;
   hdr->version_minor = (ushort)4;
   hdr->thiszone      = 0;
@@ -207,6 +221,424 @@ fd_pcap_fwrite_pkt( long         ts,
   return 1UL;
 }
 
+/* pcapng (see the IETF pcapng draft).  Blocks are:
+
+     uint type
+     uint blk_sz (includes the type, blk_sz and trailing blk_sz)
+     ... body (padded to a multiple of 4)
+     uint blk_sz */
+
+#define FD_PCAPNG_BLOCK_SHB        (0x0a0d0d0aU) /* Section header */
+#define FD_PCAPNG_BLOCK_IDB        (0x00000001U) /* Interface description */
+#define FD_PCAPNG_BLOCK_EPB        (0x00000006U) /* Enhanced packet */
+#define FD_PCAPNG_BYTE_ORDER_MAGIC (0x1a2b3c4dU)
+#define FD_PCAPNG_OPT_END          (0UL)
+#define FD_PCAPNG_OPT_IF_TSRESOL   (9UL)
+
+/* fd_pcap_mmap_if_init initializes an interface with the given link
+   type and timestamp resolution (a resolution of 10^-tsresol s).
+   Returns 0 on success and -1 if the resolution is not supported (e.g.
+   a power of 2 resolution).  An unsupported link type is not an error
+   here (the interface's packets get skipped). */
+
+static int
+fd_pcap_mmap_if_init( fd_pcap_mmap_if_t * if_,
+                      ulong               network,
+                      ulong               tsresol ) {
+  if_->type = network==FD_PCAP_HDR_NETWORK_ETHERNET  ? FD_PCAP_ITER_TYPE_ETHERNET :
+              network==FD_PCAP_HDR_NETWORK_LINUX_SLL ? FD_PCAP_ITER_TYPE_COOKED   : ULONG_MAX;
+  if( FD_UNLIKELY( tsresol>18UL ) ) return -1;
+  ulong ts_mul = 1UL; for( ulong k=tsresol; k< 9UL;     k++ ) ts_mul *= 10UL;
+  ulong ts_div = 1UL; for( ulong k=9UL;     k<tsresol; k++ ) ts_div *= 10UL;
+  if_->ts_mul = ts_mul;
+  if_->ts_div = ts_div;
+  return 0;
+}
+
+/* fd_pcap_mmap_idb appends the interface described by the pcapng IDB
+   blk of blk_sz bytes to pcap's interfaces.  Returns 0 on success and
+   -1 on failure (logs details). */
+
+static int
+fd_pcap_mmap_idb( fd_pcap_mmap_t * pcap,
+                  uchar const *    blk,
+                  ulong            blk_sz ) {
+  if( FD_UNLIKELY( blk_sz<20UL ) ) {
+    FD_LOG_WARNING(( "corrupt pcapng interface description" ));
+    return -1;
+  }
+
+  if( FD_UNLIKELY( pcap->if_cnt>=FD_PCAP_MMAP_IF_MAX ) ) {
+    FD_LOG_WARNING(( "too many interfaces in pcapng section (max %lu)", FD_PCAP_MMAP_IF_MAX ));
+    return -1;
+  }
+
+  ulong network = fd_ulong_load_2( blk+8UL );
+  ulong tsresol = 6UL; /* Default is us */
+
+  ulong opt     = 16UL;
+  ulong opt_end = blk_sz-4UL;
+  while( opt+4UL<=opt_end ) {
+    ulong code = fd_ulong_load_2( blk+opt     );
+    ulong len  = fd_ulong_load_2( blk+opt+2UL );
+    if( code==FD_PCAPNG_OPT_END ) break;
+    if( FD_UNLIKELY( len>opt_end-opt-4UL ) ) {
+      FD_LOG_WARNING(( "corrupt pcapng interface description option" ));
+      return -1;
+    }
+    if( (code==FD_PCAPNG_OPT_IF_TSRESOL) & (len==1UL) ) tsresol = (ulong)blk[ opt+4UL ];
+    opt += 4UL + fd_ulong_align_up( len, 4UL );
+  }
+
+  ulong if_idx = pcap->if_cnt;
+  if( FD_UNLIKELY( fd_pcap_mmap_if_init( pcap->if_ + if_idx, network, tsresol ) ) ) {
+    FD_LOG_WARNING(( "unsupported timestamp resolution (%lu) for pcapng interface %lu", tsresol, if_idx ));
+    return -1;
+  }
+  if( FD_UNLIKELY( pcap->if_[ if_idx ].type==ULONG_MAX ) )
+    FD_LOG_WARNING(( "skipping packets of pcapng interface %lu (unsupported link type %lu)", if_idx, network ));
+  pcap->if_cnt = if_idx+1UL;
+  return 0;
+}
+
+/* fd_pcap_mmap_prefetch asks the kernel to read in the file up to
+   FD_PCAP_MMAP_PREFETCH_SZ bytes past off.  This is done in huge page
+   sized steps such that the madvise cost is amortized over many
+   packets. */
+
+#define FD_PCAP_MMAP_PREFETCH_STEP (2UL<<20) /* Huge page size */
+
+static inline void
+fd_pcap_mmap_prefetch( fd_pcap_mmap_t * pcap,
+                       ulong            off ) {
+  ulong map_sz = pcap->map_sz;
+  if( FD_LIKELY( pcap->prefetch>=fd_ulong_min( off+FD_PCAP_MMAP_PREFETCH_SZ, map_sz ) ) ) return;
+  ulong start = pcap->prefetch;
+  ulong end   = fd_ulong_min( fd_ulong_align_up( off+FD_PCAP_MMAP_PREFETCH_SZ, FD_PCAP_MMAP_PREFETCH_STEP ), map_sz );
+  (void)madvise( (void *)(pcap->map+start), end-start, MADV_WILLNEED ); /* Only advisory */
+  pcap->prefetch = end;
+}
+
+fd_pcap_mmap_t *
+fd_pcap_mmap_open( fd_pcap_mmap_t * pcap,
+                   char const *     path ) {
+
+  if( FD_UNLIKELY( !pcap ) ) {
+    FD_LOG_WARNING(( "NULL pcap" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !path ) ) {
+    FD_LOG_WARNING(( "NULL path" ));
+    return NULL;
+  }
+
+  int fd = open( path, O_RDONLY );
+  if( FD_UNLIKELY( fd<0 ) ) {
+    FD_LOG_WARNING(( "open(\"%s\") failed (%i-%s)", path, errno, strerror( errno ) ));
+    return NULL;
+  }
+
+  struct stat st;
+  if( FD_UNLIKELY( fstat( fd, &st ) ) ) {
+    FD_LOG_WARNING(( "fstat(\"%s\") failed (%i-%s)", path, errno, strerror( errno ) ));
+    close( fd );
+    return NULL;
+  }
+
+  ulong map_sz = (ulong)st.st_size;
+  if( FD_UNLIKELY( map_sz<12UL ) ) { /* Smaller than a pcap header or a pcapng block header */
+    FD_LOG_WARNING(( "\"%s\" is too small to be a pcap (%lu bytes)", path, map_sz ));
+    close( fd );
+    return NULL;
+  }
+
+  /* The mapping holds its own reference to the file */
+
+  void * map = mmap( NULL, map_sz, PROT_READ, MAP_PRIVATE, fd, 0 );
+  int    err = errno;
+  if( FD_UNLIKELY( close( fd ) ) )
+    FD_LOG_WARNING(( "close(\"%s\") failed (%i-%s); attempting to continue", path, errno, strerror( errno ) ));
+  if( FD_UNLIKELY( map==MAP_FAILED ) ) {
+    FD_LOG_WARNING(( "mmap(\"%s\",%lu KiB) failed (%i-%s)", path, map_sz>>10, err, strerror( err ) ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( madvise( map, map_sz, MADV_SEQUENTIAL ) ) )
+    FD_LOG_WARNING(( "madvise(\"%s\",%lu KiB) failed (%i-%s); attempting to continue", path, map_sz>>10, errno, strerror( errno ) ));
+
+  /* Huge page backed file mappings are only available on some
+     filesystems / kernels so silently ignore failure here */
+
+# ifdef MADV_HUGEPAGE
+  (void)madvise( map, map_sz, MADV_HUGEPAGE );
+# endif
+
+  uchar const * p     = (uchar const *)map;
+  uint          magic = fd_uint_load_4( p );
+
+  pcap->map      = p;
+  pcap->map_sz   = map_sz;
+  pcap->prefetch = 0UL;
+  pcap->if_cnt   = 0UL;
+
+  if( (magic==FD_PCAP_MAGIC_USEC) | (magic==FD_PCAP_MAGIC_NSEC) ) {
+
+    fd_pcap_hdr_t hdr[1];
+    if( FD_UNLIKELY( map_sz<sizeof(fd_pcap_hdr_t) ) ) {
+      FD_LOG_WARNING(( "\"%s\" has a truncated pcap header", path ));
+      munmap( map, map_sz );
+      return NULL;
+    }
+    memcpy( hdr, p, sizeof(fd_pcap_hdr_t) );
+
+    fd_pcap_mmap_if_init( pcap->if_, (ulong)hdr->network, magic==FD_PCAP_MAGIC_NSEC ? 9UL : 6UL );
+    if( FD_UNLIKELY( pcap->if_[0].type==ULONG_MAX ) ) {
+      FD_LOG_WARNING(( "unsupported network type (neither an Ethernet nor a cooked socket pcap)" ));
+      munmap( map, map_sz );
+      return NULL;
+    }
+
+    pcap->fmt    = FD_PCAP_MMAP_FMT_PCAP;
+    pcap->if_cnt = 1UL;
+    pcap->off0   = sizeof(fd_pcap_hdr_t);
+
+  } else if( magic==FD_PCAPNG_BLOCK_SHB ) {
+
+    if( FD_UNLIKELY( fd_uint_load_4( p+8UL )!=FD_PCAPNG_BYTE_ORDER_MAGIC ) ) {
+      FD_LOG_WARNING(( "unsupported pcapng byte order" ));
+      munmap( map, map_sz );
+      return NULL;
+    }
+
+    pcap->fmt  = FD_PCAP_MMAP_FMT_PCAPNG;
+    pcap->off0 = 0UL; /* Section header (re)parsed by fd_pcap_mmap_next */
+
+  } else {
+
+    FD_LOG_WARNING(( "not a supported pcap or pcapng file (bad magic number)" ));
+    munmap( map, map_sz );
+    return NULL;
+
+  }
+
+  pcap->off = pcap->off0;
+  return pcap;
+}
+
+void *
+fd_pcap_mmap_close( fd_pcap_mmap_t * pcap ) {
+  if( FD_UNLIKELY( !pcap ) ) {
+    FD_LOG_WARNING(( "NULL pcap" ));
+    return NULL;
+  }
+  if( FD_UNLIKELY( munmap( (void *)pcap->map, pcap->map_sz ) ) )
+    FD_LOG_WARNING(( "munmap failed (%i-%s); attempting to continue", errno, strerror( errno ) ));
+  return pcap;
+}
+
+void
+fd_pcap_mmap_rewind( fd_pcap_mmap_t * pcap ) {
+  pcap->off      = pcap->off0;
+  pcap->prefetch = 0UL;
+}
+
+ulong
+fd_pcap_mmap_next( fd_pcap_mmap_t * pcap,
+                   void *           pkt,
+                   ulong            pkt_max,
+                   long *           _pkt_ts ) {
+  uchar const * map    = pcap->map;
+  ulong         map_sz = pcap->map_sz;
+
+  fd_pcap_mmap_if_t const * if_;
+  uchar const *             data;
+  ulong                     cap_sz;
+  ulong                     orig_sz;
+  long                      ts;
+
+  for(;;) {
+    ulong off = pcap->off;
+    if( FD_UNLIKELY( off>=map_sz ) ) return 0UL; /* Normal EOF */
+    fd_pcap_mmap_prefetch( pcap, off );
+
+    uchar const * rec = map    + off;
+    ulong         rem = map_sz - off;
+
+    if( FD_LIKELY( pcap->fmt==FD_PCAP_MMAP_FMT_PCAP ) ) {
+
+      fd_pcap_pkt_hdr_t hdr[1];
+      if( FD_UNLIKELY( rem<sizeof(fd_pcap_pkt_hdr_t) ) ) {
+        FD_LOG_WARNING(( "packet header truncated (truncated pcap file?)" ));
+        break;
+      }
+      memcpy( hdr, rec, sizeof(fd_pcap_pkt_hdr_t) );
+
+      if_     = pcap->if_;
+      data    = rec + sizeof(fd_pcap_pkt_hdr_t);
+      cap_sz  = (ulong)hdr->incl_len;
+      orig_sz = (ulong)hdr->orig_len;
+      ts      = 1000000000L*(long)hdr->sec + (long)((ulong)hdr->usec*if_->ts_mul);
+
+      if( FD_UNLIKELY( cap_sz>rem-sizeof(fd_pcap_pkt_hdr_t) ) ) {
+        FD_LOG_WARNING(( "packet payload truncated (truncated pcap file?)" ));
+        break;
+      }
+      pcap->off = off + sizeof(fd_pcap_pkt_hdr_t) + cap_sz;
+
+    } else {
+
+      ulong type   = (rem>=12UL) ? fd_ulong_load_4( rec     ) : 0UL;
+      ulong blk_sz = (rem>=12UL) ? fd_ulong_load_4( rec+4UL ) : 0UL;
+      if( FD_UNLIKELY( (blk_sz<12UL) | (blk_sz>rem) | (!fd_ulong_is_aligned( blk_sz, 4UL )) ) ) {
+        FD_LOG_WARNING(( "corrupt pcapng block at offset %lu (truncated pcapng file?)", off ));
+        break;
+      }
+      pcap->off = off + blk_sz;
+
+      if( FD_UNLIKELY( type!=FD_PCAPNG_BLOCK_EPB ) ) {
+        if( type==FD_PCAPNG_BLOCK_IDB ) {
+          if( FD_UNLIKELY( fd_pcap_mmap_idb( pcap, rec, blk_sz ) ) ) break;
+        } else if( type==FD_PCAPNG_BLOCK_SHB ) {
+          if( FD_UNLIKELY( (blk_sz<28UL) || fd_uint_load_4( rec+8UL )!=FD_PCAPNG_BYTE_ORDER_MAGIC ) ) {
+            FD_LOG_WARNING(( "corrupt or unsupported byte order pcapng section at offset %lu", off ));
+            break;
+          }
+          pcap->if_cnt = 0UL; /* Interfaces are scoped to a section */
+        }
+        continue; /* Skip other blocks (statistics, name resolution, ...) */
+      }
+
+      ulong if_idx = fd_ulong_load_4( rec+8UL );
+      cap_sz  = (blk_sz>=32UL) ? fd_ulong_load_4( rec+20UL ) : ULONG_MAX;
+      orig_sz = (blk_sz>=32UL) ? fd_ulong_load_4( rec+24UL ) : 0UL;
+      if( FD_UNLIKELY( (if_idx>=pcap->if_cnt) | (cap_sz>blk_sz-32UL) ) ) {
+        FD_LOG_WARNING(( "corrupt pcapng enhanced packet block at offset %lu", off ));
+        break;
+      }
+
+      if_ = pcap->if_ + if_idx;
+      if( FD_UNLIKELY( if_->type==ULONG_MAX ) ) continue; /* Unsupported link type (logged when described) */
+
+      ulong t = (fd_ulong_load_4( rec+12UL )<<32) | fd_ulong_load_4( rec+16UL );
+      ts   = (long)( (if_->ts_div==1UL) ? t*if_->ts_mul : t/if_->ts_div );
+      data = rec + 28UL;
+
+    }
+
+    if( FD_UNLIKELY( cap_sz!=orig_sz ) ) {
+      FD_LOG_WARNING(( "Read a truncated packet (%lu bytes to %lu bytes), run tcpdump with '-s0' option to capture everything",
+                       cap_sz, orig_sz ));
+      break;
+    }
+
+    int   cooked      = (if_->type==FD_PCAP_ITER_TYPE_COOKED);
+    ulong pcap_hdr_sz = fd_ulong_if( cooked, sizeof(fd_pcap_sll_hdr_t), sizeof(fd_eth_hdr_t) );
+    if( FD_UNLIKELY( cap_sz<pcap_hdr_sz ) ) {
+      FD_LOG_WARNING(( "Corrupt packet size %lu in pcap", cap_sz ));
+      break;
+    }
+
+    ulong pkt_sz = cap_sz - pcap_hdr_sz + sizeof(fd_eth_hdr_t);
+    if( FD_UNLIKELY( pkt_sz>pkt_max ) ) {
+      FD_LOG_WARNING(( "Too large packet detected in pcap (%lu bytes with %lu max)", pkt_sz, pkt_max ));
+      break;
+    }
+
+    if( FD_UNLIKELY( cooked ) ) {
+      fd_pcap_sll_hdr_t sll[1];
+      memcpy( sll, data, sizeof(fd_pcap_sll_hdr_t) );
+      fd_pcap_sll_to_eth( (fd_eth_hdr_t *)pkt, sll );
+      memcpy( (uchar *)pkt + sizeof(fd_eth_hdr_t), data + sizeof(fd_pcap_sll_hdr_t), cap_sz - sizeof(fd_pcap_sll_hdr_t) );
+    } else {
+      memcpy( pkt, data, cap_sz );
+    }
+
+    *_pkt_ts = ts;
+    return pkt_sz;
+  }
+
+  /* Failed (logged above) ... behave like EOF from here */
+
+  pcap->off = map_sz;
+  return 0UL;
+}
+
+ulong
+fd_pcapng_fwrite_hdr( void * file ) {
+  uint shb[7];
+  shb[0] = FD_PCAPNG_BLOCK_SHB;
+  shb[1] = (uint)sizeof(shb);
+  shb[2] = FD_PCAPNG_BYTE_ORDER_MAGIC;
+  shb[3] = 1U;          /* version 1.0 */
+  shb[4] = UINT_MAX;    /* section length unspecified (-1) */
+  shb[5] = UINT_MAX;
+  shb[6] = (uint)sizeof(shb);
+
+  uint idb[8];
+  idb[0] = FD_PCAPNG_BLOCK_IDB;
+  idb[1] = (uint)sizeof(idb);
+  idb[2] = FD_PCAP_HDR_NETWORK_ETHERNET; /* linktype, reserved */
+  idb[3] = 0U;                           /* snaplen (unlimited) */
+  idb[4] = (uint)FD_PCAPNG_OPT_IF_TSRESOL | (1U<<16);
+  idb[5] = 9U;                           /* ns */
+  idb[6] = (uint)FD_PCAPNG_OPT_END;
+  idb[7] = (uint)sizeof(idb);
+
+  if( FD_UNLIKELY( (fwrite( shb, sizeof(shb), 1UL, (FILE *)file )!=1UL) ||
+                   (fwrite( idb, sizeof(idb), 1UL, (FILE *)file )!=1UL) ) ) {
+    FD_LOG_WARNING(( "fwrite failed" ));
+    return 0UL;
+  }
+  return 1UL;
+}
+
+ulong
+fd_pcapng_fwrite_pkt( long         ts,
+                      void const * pkt,
+                      ulong        pkt_sz,
+                      char const * comment,
+                      void *       file ) {
+
+  ulong comment_sz = comment ? strlen( comment ) : 0UL;
+  if( FD_UNLIKELY( (pkt_sz>(ulong)UINT_MAX/2UL) | (comment_sz>(ulong)USHORT_MAX) ) ) {
+    FD_LOG_WARNING(( "packet or comment too large for pcapng" ));
+    return 0UL;
+  }
+
+  ulong pkt_pad_sz     = fd_ulong_align_up( pkt_sz,     4UL ) - pkt_sz;
+  ulong comment_pad_sz = fd_ulong_align_up( comment_sz, 4UL ) - comment_sz;
+  ulong opt_sz         = comment_sz ? (4UL + comment_sz + comment_pad_sz + 4UL) : 0UL; /* opt_comment, opt_endofopt */
+  uint  blk_sz         = (uint)( 32UL + pkt_sz + pkt_pad_sz + opt_sz );
+
+  uint epb[7];
+  epb[0] = FD_PCAPNG_BLOCK_EPB;
+  epb[1] = blk_sz;
+  epb[2] = 0U; /* interface */
+  epb[3] = (uint)(((ulong)ts) >> 32);
+  epb[4] = (uint)  (ulong)ts;
+  epb[5] = (uint)pkt_sz;
+  epb[6] = (uint)pkt_sz;
+
+  uint opt[1]; opt[0] = 1U /* opt_comment */ | ((uint)comment_sz<<16);
+  uint pad[1]; pad[0] = 0U; /* Also opt_endofopt */
+
+  FILE * stream = (FILE *)file;
+  int    err    = (fwrite( epb, sizeof(epb), 1UL, stream )!=1UL);
+  if( pkt_sz         ) err |= (fwrite( pkt, pkt_sz,         1UL, stream )!=1UL);
+  if( pkt_pad_sz     ) err |= (fwrite( pad, pkt_pad_sz,     1UL, stream )!=1UL);
+  if( comment_sz ) {
+    err |= (fwrite( opt,     sizeof(opt),    1UL, stream )!=1UL);
+    err |= (fwrite( comment, comment_sz,     1UL, stream )!=1UL);
+    if( comment_pad_sz ) err |= (fwrite( pad, comment_pad_sz, 1UL, stream )!=1UL);
+    err |= (fwrite( pad,     sizeof(pad),    1UL, stream )!=1UL);
+  }
+  err |= (fwrite( &blk_sz, sizeof(uint), 1UL, stream )!=1UL);
+
+  if( FD_UNLIKELY( err ) ) { FD_LOG_WARNING(( "fwrite failed" )); return 0UL; }
+  return 1UL;
+}
+
 #else
 
 /* Implement pcap support for this target */
@@ -12,6 +12,51 @@
 struct fd_pcap_iter;
 typedef struct fd_pcap_iter fd_pcap_iter_t;
 
+/* fd_pcap_mmap_t is a pcap reader that memory maps the whole capture
+   instead of streaming it through stdio.  Packets are copied exactly
+   once, straight from the page cache into the caller's buffer.  It
+   reads both classic pcap (Ethernet or cooked, microsecond or
+   nanosecond resolution) and pcapng files (enhanced packet blocks on
+   Ethernet or cooked interfaces, other blocks are skipped).  Both are
+   assumed to have been written in little endian byte order.  The
+   layout below is exposed to facilitate declaring readers on the stack
+   but should otherwise be treated as opaque. */
+
+#define FD_PCAP_MMAP_FMT_PCAP   (0UL)
+#define FD_PCAP_MMAP_FMT_PCAPNG (1UL)
+
+/* FD_PCAP_MMAP_IF_MAX is the max number of interfaces per pcapng
+   section supported */
+
+#define FD_PCAP_MMAP_IF_MAX (16UL)
+
+/* FD_PCAP_MMAP_PREFETCH_SZ is how far ahead of the read position the
+   reader asks the kernel to read the file in.  Prefetches are issued in
+   huge page sized steps. */
+
+#define FD_PCAP_MMAP_PREFETCH_SZ (16UL<<20)
+
+struct fd_pcap_mmap_if {
+  ulong type;   /* FD_PCAP_ITER_TYPE_* or ULONG_MAX if unsupported link type */
+  ulong ts_mul; /* ns = ts*ts_mul/ts_div */
+  ulong ts_div;
+};
+
+typedef struct fd_pcap_mmap_if fd_pcap_mmap_if_t;
+
+struct fd_pcap_mmap {
+  uchar const *     map;      /* Read only mapping of the file */
+  ulong             map_sz;   /* Size of the file */
+  ulong             off;      /* Offset of the next record */
+  ulong             off0;     /* Offset of the first record (rewind point) */
+  ulong             prefetch; /* File prefetched up to this offset */
+  ulong             fmt;      /* FD_PCAP_MMAP_FMT_* */
+  ulong             if_cnt;   /* Number of interfaces, 1 for a pcap */
+  fd_pcap_mmap_if_t if_[ FD_PCAP_MMAP_IF_MAX ];
+};
+
+typedef struct fd_pcap_mmap fd_pcap_mmap_t;
+
 FD_PROTOTYPES_BEGIN
 
 /* fd_pcap_iter_new creates an iterator suitable for reading a pcap
@@ -96,6 +141,73 @@ fd_pcap_fwrite_pkt( long         ts,
                     uint         _fcs,
                     void *       file );
 
+/* fd_pcapng_fwrite_hdr writes a little endian pcapng section header
+   followed by the description of a single Ethernet interface with
+   nanosecond timestamp resolution to the stream pointed to by file.
+   Same semantics as fwrite (returns 1 on success and 0 on failure, logs
+   details on failure). */
+
+ulong
+fd_pcapng_fwrite_hdr( void * file );
+
+/* fd_pcapng_fwrite_pkt writes the pkt_sz bytes pointed to by pkt as a
+   pcapng enhanced packet block on the interface written by
+   fd_pcapng_fwrite_hdr at time ts (ns).  pkt should start on the first
+   byte of the Ethernet header (no FCS is appended).  If comment is
+   non-NULL, the cstr it points to is attached to the packet as a
+   comment option (e.g. to preserve metadata that has no place in the
+   packet).  Same semantics as fwrite (returns 1 on success and 0 on
+   failure, logs details on failure). */
+
+ulong
+fd_pcapng_fwrite_pkt( long         ts,
+                      void const * pkt,
+                      ulong        pkt_sz,
+                      char const * comment,
+                      void *       file );
+
+/* fd_pcap_mmap_open opens the pcap or pcapng file at path for reading
+   into the reader pointed to by pcap.  The file is mapped read-only and
+   the kernel is advised the mapping will be read sequentially (and, if
+   the filesystem supports it, that it can be backed by huge pages).
+   Returns pcap on success and NULL on failure (logs details).  Reasons
+   for failure include the file could not be opened / mapped, is not a
+   pcap / pcapng or uses an unsupported link type or byte order. */
+
+fd_pcap_mmap_t *
+fd_pcap_mmap_open( fd_pcap_mmap_t * pcap,
+                   char const *     path );
+
+/* fd_pcap_mmap_close unmaps the file read by pcap.  Returns the memory
+   used for the reader (which is no longer valid). */
+
+void *
+fd_pcap_mmap_close( fd_pcap_mmap_t * pcap );
+
+/* fd_pcap_mmap_fmt returns the format (a FD_PCAP_MMAP_FMT_*) of the
+   file read by pcap. */
+
+FD_FN_PURE static inline ulong fd_pcap_mmap_fmt( fd_pcap_mmap_t const * pcap ) { return pcap->fmt; }
+
+/* fd_pcap_mmap_next extracts the next packet from the file read by
+   pcap.  Has the same semantics as fd_pcap_iter_next (including the
+   phony Ethernet header of cooked captures) except timestamps are
+   converted to ns according to the resolution recorded in the file.
+   After a failure other than a normal end-of-file (which is logged),
+   the reader behaves as if it reached the end of the file. */
+
+ulong
+fd_pcap_mmap_next( fd_pcap_mmap_t * pcap,
+                   void *           pkt,
+                   ulong            pkt_max,
+                   long *           _pkt_ts );
+
+/* fd_pcap_mmap_rewind moves pcap back to the first packet of the file
+   (e.g. to replay the file in a loop without remapping it). */
+
+void
+fd_pcap_mmap_rewind( fd_pcap_mmap_t * pcap );
+
 FD_PROTOTYPES_END
 
 #endif /* HEADER_fd_src_util_net_fd_pcap_h */
@@ -34,40 +34,26 @@ FD_PROTOTYPES_BEGIN
 
      dgram_sz = fd_ushort_bswap(udp->net_len) - sizeof(fd_udp_hdr_t)
 
-   bytes.  This assumes it is safe to read up to 3 bytes past the end of
-   dgram (technically it will read the fd_align_up(dgram_sz,4UL) bytes
-   dgram).  The contents of the tail read region are irrelevant.
-
-   This is neither a particularly fast calculation (reasonably fast
-   O(dgram_sz)) nor a particularly robust and it can inhibit cut-through
-   usage.  So in general it is best to avoid UDP checksums, usually by
-   exploiting their optionality in IP4 (note that the Ethernet CRC is
-   reasonably strong and still provides protection).
-
-   As such, this is mostly here for the rare application that needs to
-   manually compute / validate UDP checksums (e.g. overhead doesn't
-   matter or when the hardware sending/receiving the packet doesn't do
-   various checksum offload computations and UDP checksums are
-   required).
-
-   WARNING!  With strict aliasing optimizations enabled and having this
-   inline, the caller might need to type pun the dgram value passed to
-   this (e.g. fd_type_pun_const(my_dgram)), wrap their dgram structure
-   in a union like seen above for the udp_hdr_t or play various games
-   with the may_alias attribute.  fd_type_pun_const is the quickest way
-   to handle this but can inhibit various optimizations.  Wrapping in a
-   union type is the fastest and most conformant way to handle this.
-   The compiler is pretty good at catching when this is necessary and
-   warning about it but be careful here.  FIXME: CONSIDER NOT INLINING
-   THIS? */
+   bytes.  No bytes past the end of dgram are read and dgram has no
+   alignment requirements.  The datagram is summed with
+   fd_ip4_csum_append (AVX2 accelerated on FD_HAS_AVX targets).
+
+   UDP checksums are not particularly robust and can inhibit
+   cut-through usage.  So in general it is best to avoid them, usually
+   by exploiting their optionality in IP4 (note that the Ethernet CRC
+   is reasonably strong and still provides protection) or by relying on
+   NIC checksum offload.  This is here for applications that need to
+   compute / validate UDP checksums in software (e.g. when the hardware
+   sending/receiving the packet doesn't do checksum offload and UDP
+   checksums are required). */
 
 FD_FN_PURE static inline ushort
 fd_ip4_udp_check( uint                 ip4_saddr,
                   uint                 ip4_daddr,
                   fd_udp_hdr_t const * udp,
-                  void const *         dgram ) { /* Assumed safe to tail read up to 3 bytes past end of msg */
+                  void const *         dgram ) {
   ushort net_len = udp->net_len; /* In net order */
-  uint   rem     = (uint)fd_ushort_bswap( net_len ) - (uint)sizeof(fd_udp_hdr_t);
+  ulong  rem     = (ulong)fd_ushort_bswap( net_len ) - sizeof(fd_udp_hdr_t);
 
   /* Sum the pseudo header and UDP header words */
   uint const * u = udp->u;
@@ -77,21 +63,8 @@ fd_ip4_udp_check( uint                 ip4_saddr,
            + ((ulong)u[0])
            + ((ulong)u[1]);
 
-  /* Sum the dgram words (reads up to 4 past end of msg) */
-  u = (uint const *)dgram; /* See warning above */
-  for( ; rem>3U; rem-=4U, u++ ) ul += (ulong)u[0];
-  ul += (ulong)( u[0] & ((1U<<(8U*rem))-1U) );
-
-  /* Reduce the sum to a 16-bit one's complement sum */
-  ul  = ( ul>>32            ) +
-        ((ul>>16) & 0xffffUL) +
-        ( ul      & 0xffffUL);
-  ul  = ( ul>>16            ) +
-        ( ul      & 0xffffUL);
-  ul += ( ul>>16            );
-
-  /* And complement it */
-  return (ushort)~ul;
+  /* Sum the dgram words, reduce and complement */
+  return fd_ip4_csum_fold( fd_ip4_csum_append( ul, dgram, rem ) );
 }
 
 FD_PROTOTYPES_END
@@ -71,6 +71,60 @@ main( int     argc,
   fcs = fd_eth_fcs_append( fcs, frame+10UL, frame_sz-10UL );
   FD_TEST( fcs==fcs_exp );
 
+  FD_TEST( fd_eth_fcs_append_ref( FD_ETH_FCS_APPEND_SEED, frame, frame_sz )==fcs_exp );
+
+  /* Test the accelerated implementation (if any) against the table
+     over a range of sizes, alignments, seeds and split points */
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  static uchar buf[ 4096UL+64UL ] __attribute__((aligned(128)));
+  for( ulong b=0UL; b<sizeof(buf); b++ ) buf[b] = fd_rng_uchar( rng );
+
+  for( ulong iter=0UL; iter<100000UL; iter++ ) {
+    ulong off  = fd_rng_ulong( rng ) & 63UL;
+    ulong sz   = fd_rng_ulong_roll( rng, (iter & 1UL) ? 4097UL : 1025UL );
+    uint  seed = (iter & 2UL) ? fd_rng_uint( rng ) : FD_ETH_FCS_APPEND_SEED;
+    uint  ref  = fd_eth_fcs_append_ref( seed, buf+off, sz );
+    FD_TEST( fd_eth_fcs_append( seed, buf+off, sz )==ref );
+
+    ulong split = fd_rng_ulong_roll( rng, sz+1UL );
+    FD_TEST( fd_eth_fcs_append( fd_eth_fcs_append( seed, buf+off, split ), buf+off+split, sz-split )==ref );
+  }
+
+  /* Do a quick benchmark of the table and accelerated implementations
+     on small, typical and large frames */
+
+  static ulong const bench_sz[3] = { 64UL, 1514UL, 4096UL };
+
+  for( ulong idx=0UL; idx<3UL; idx++ ) {
+    ulong sz   = bench_sz[ idx ];
+    ulong iter = 262144UL / (sz>>6);
+
+    /* warmup */
+    for( ulong rem=10UL; rem; rem-- ) { fcs = fd_eth_fcs_append_ref( fcs, buf, sz ); FD_COMPILER_UNPREDICTABLE( fcs ); }
+    for( ulong rem=10UL; rem; rem-- ) { fcs = fd_eth_fcs_append    ( fcs, buf, sz ); FD_COMPILER_UNPREDICTABLE( fcs ); }
+
+    /* for real (the fences keep the pure calls from being moved out of
+       the timed regions) */
+    long dt_ref = -fd_log_wallclock();
+    FD_COMPILER_MFENCE();
+    for( ulong rem=iter; rem; rem-- ) { fcs = fd_eth_fcs_append_ref( fcs, buf, sz ); FD_COMPILER_UNPREDICTABLE( fcs ); }
+    FD_COMPILER_MFENCE();
+    dt_ref += fd_log_wallclock();
+
+    long dt = -fd_log_wallclock();
+    FD_COMPILER_MFENCE();
+    for( ulong rem=iter; rem; rem-- ) { fcs = fd_eth_fcs_append( fcs, buf, sz ); FD_COMPILER_UNPREDICTABLE( fcs ); }
+    FD_COMPILER_MFENCE();
+    dt += fd_log_wallclock();
+
+    FD_LOG_NOTICE(( "sz %4lu: table ~%7.3f GB/s, fd_eth_fcs_append ~%7.3f GB/s / core", sz,
+                    ((double)(sz*iter)) / ((double)dt_ref), ((double)(sz*iter)) / ((double)dt) ));
+  }
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+
   uchar dst[6];
   FD_TEST( fd_eth_mac_bcast( dst )==dst );
   FD_TEST( dst[0]==(uchar)0xff ); FD_TEST( dst[1]==(uchar)0xff ); FD_TEST( dst[2]==(uchar)0xff );
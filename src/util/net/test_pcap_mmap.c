@@ -0,0 +1,378 @@
+#include "../fd_util.h"
+#include "fd_pcap.h"
+
+FD_STATIC_ASSERT( FD_PCAP_MMAP_FMT_PCAP  ==0UL, unit_test );
+FD_STATIC_ASSERT( FD_PCAP_MMAP_FMT_PCAPNG==1UL, unit_test );
+
+#if FD_HAS_HOSTED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define PKT_CNT (64UL)
+#define PKT_MAX (256UL)
+
+static uchar ref_pkt[ PKT_CNT ][ PKT_MAX ];
+static ulong ref_sz [ PKT_CNT ];
+static long  ref_ts [ PKT_CNT ];
+
+static void
+ref_init( fd_rng_t * rng,
+          long       ts_unit ) {
+  long ts = 1000000000L*(long)fd_rng_uint_roll( rng, 1U<<30 );
+  for( ulong idx=0UL; idx<PKT_CNT; idx++ ) {
+    ref_sz[ idx ] = 64UL + fd_rng_ulong_roll( rng, PKT_MAX-64UL+1UL );
+    ref_ts[ idx ] = ts;
+    for( ulong b=0UL; b<ref_sz[ idx ]; b++ ) ref_pkt[ idx ][ b ] = fd_rng_uchar( rng );
+    ts += ts_unit*(long)fd_rng_uint_roll( rng, 1000000U );
+  }
+}
+
+static FILE *
+tmp_open( char * path ) {
+  strcpy( path, "/tmp/test_pcap_mmap.XXXXXX" );
+  int fd = mkstemp( path );
+  if( FD_UNLIKELY( fd<0 ) ) FD_LOG_ERR(( "mkstemp failed" ));
+  FILE * file = fdopen( fd, "w" );
+  if( FD_UNLIKELY( !file ) ) FD_LOG_ERR(( "fdopen failed" ));
+  return file;
+}
+
+static void
+tmp_close( FILE * file ) {
+  if( FD_UNLIKELY( fclose( file ) ) ) FD_LOG_ERR(( "fclose failed" ));
+}
+
+/* write_pcap writes the reference packets as a classic pcap with the
+   given magic.  If cooked, each packet's first 14 bytes are replaced by
+   a sll header (ref_pkt is updated to hold what the reader should
+   return). */
+
+static void
+write_pcap( FILE * file,
+            uint   magic,
+            int    cooked ) {
+  uint hdr[6];
+  hdr[0] = magic;
+  hdr[1] = 2U | (4U<<16); /* version */
+  hdr[2] = 0U;            /* thiszone */
+  hdr[3] = 0U;            /* sigfigs */
+  hdr[4] = 65535U;        /* snaplen */
+  hdr[5] = cooked ? 113U : 1U;
+  FD_TEST( fwrite( hdr, sizeof(hdr), 1UL, file )==1UL );
+
+  long res = magic==0xa1b2c3d4U ? 1000L : 1L;
+  for( ulong idx=0UL; idx<PKT_CNT; idx++ ) {
+    uchar * pkt = ref_pkt[ idx ];
+    ulong   sz  = ref_sz[ idx ];
+    ulong   cap = sz;
+    uchar   sll[16];
+    if( cooked ) {
+      for( ulong b=0UL; b<14UL; b++ ) sll[b] = pkt[b];
+      sll[14] = pkt[12]; sll[15] = pkt[13]; /* net_type */
+      cap += 2UL;
+
+      /* Expected phony Ethernet header */
+      pkt[ 0] = (uchar)((sll[0] & ~3) | 2); pkt[1] = sll[1];
+      pkt[ 2] = sll[2]; pkt[ 3] = sll[3]; pkt[4] = sll[4]; pkt[5] = sll[5];
+      pkt[ 6] = (uchar)((sll[6] & ~3) | 2); pkt[7] = sll[7];
+      pkt[ 8] = sll[8]; pkt[ 9] = sll[9]; pkt[10] = sll[10]; pkt[11] = sll[11];
+    }
+    uint rec[4];
+    rec[0] = (uint)(ref_ts[ idx ] / 1000000000L);
+    rec[1] = (uint)((ref_ts[ idx ] % 1000000000L) / res);
+    rec[2] = (uint)cap;
+    rec[3] = (uint)cap;
+    FD_TEST( fwrite( rec, sizeof(rec), 1UL, file )==1UL );
+    if( cooked ) {
+      FD_TEST( fwrite( sll,       16UL,    1UL, file )==1UL );
+      FD_TEST( fwrite( pkt+14UL,  sz-14UL, 1UL, file )==1UL );
+    } else {
+      FD_TEST( fwrite( pkt,       sz,      1UL, file )==1UL );
+    }
+  }
+}
+
+static void
+write_blk( FILE *       file,
+           uint         type,
+           void const * body,
+           ulong        body_sz ) {
+  uint  pad = 0U;
+  ulong pad_sz = fd_ulong_align_up( body_sz, 4UL ) - body_sz;
+  uint  blk_sz = (uint)(12UL + body_sz + pad_sz);
+  FD_TEST( fwrite( &type,   4UL, 1UL, file )==1UL );
+  FD_TEST( fwrite( &blk_sz, 4UL, 1UL, file )==1UL );
+  if( body_sz ) FD_TEST( fwrite( body, body_sz, 1UL, file )==1UL );
+  if( pad_sz  ) FD_TEST( fwrite( &pad, pad_sz,  1UL, file )==1UL );
+  FD_TEST( fwrite( &blk_sz, 4UL, 1UL, file )==1UL );
+}
+
+static void
+write_idb( FILE * file,
+           ushort linktype,
+           int    tsresol ) { /* -1 for default */
+  uchar body[16] = {0};
+  memcpy( body, &linktype, 2UL );
+  uint snaplen = 65535U; memcpy( body+4, &snaplen, 4UL );
+  ulong sz = 8UL;
+  if( tsresol>=0 ) {
+    ushort code = 9; ushort len = 1;
+    memcpy( body+8,  &code, 2UL );
+    memcpy( body+10, &len,  2UL );
+    body[12] = (uchar)tsresol;
+    sz = 16UL; /* opt_endofopt omitted (allowed) */
+  }
+  write_blk( file, 1U, body, sz );
+}
+
+static void
+write_epb( FILE *       file,
+           uint         if_idx,
+           ulong        ts,
+           void const * pkt,
+           ulong        sz ) {
+  uchar body[ 20UL+PKT_MAX ];
+  uint  f[5] = { if_idx, (uint)(ts>>32), (uint)ts, (uint)sz, (uint)sz };
+  memcpy( body,      f,   20UL );
+  memcpy( body+20UL, pkt, sz   );
+  write_blk( file, 6U, body, 20UL+sz );
+}
+
+static void
+write_shb( FILE * file ) {
+  uchar body[16];
+  uint  bom = 0x1a2b3c4dU;    memcpy( body,   &bom, 4UL );
+  uint  ver = 1U | (0U<<16);  memcpy( body+4, &ver, 4UL );
+  long  len = -1L;            memcpy( body+8, &len, 8UL );
+  write_blk( file, 0x0a0d0d0aU, body, 16UL );
+}
+
+/* check_mmap reads the rest of the file with pcap and checks it
+   matches the reference packets */
+
+static void
+check_mmap( fd_pcap_mmap_t * pcap ) {
+  uchar pkt[ PKT_MAX ];
+  for( ulong idx=0UL; idx<PKT_CNT; idx++ ) {
+    long  ts = 0L;
+    ulong sz = fd_pcap_mmap_next( pcap, pkt, PKT_MAX, &ts );
+    FD_TEST( sz==ref_sz[ idx ] );
+    FD_TEST( ts==ref_ts[ idx ] );
+    FD_TEST( !memcmp( pkt, ref_pkt[ idx ], sz ) );
+  }
+  long ts = 0L;
+  FD_TEST( !fd_pcap_mmap_next( pcap, pkt, PKT_MAX, &ts ) );
+  FD_TEST( !fd_pcap_mmap_next( pcap, pkt, PKT_MAX, &ts ) );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong bench_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--bench-cnt", NULL, 1UL<<20 );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  char           path[ 64 ];
+  fd_pcap_mmap_t _pcap[1];
+
+  /* Bad inputs */
+
+  FD_TEST( !fd_pcap_mmap_open( NULL,  "/dev/null"               ) );
+  FD_TEST( !fd_pcap_mmap_open( _pcap, NULL                      ) );
+  FD_TEST( !fd_pcap_mmap_open( _pcap, "/nonexistent/test.pcap"  ) );
+  FD_TEST( !fd_pcap_mmap_open( _pcap, "/dev/null"               ) );
+
+  do {
+    FILE * file = tmp_open( path );
+    uint junk[8] = { 0xdeadbeefU };
+    FD_TEST( fwrite( junk, sizeof(junk), 1UL, file )==1UL );
+    tmp_close( file );
+    FD_TEST( !fd_pcap_mmap_open( _pcap, path ) );
+    unlink( path );
+  } while(0);
+
+  /* Classic pcap in all combinations of resolution and link type.  The
+     mmap reader should match the stdio iterator (for the ns Ethernet
+     captures the iterator supports) and rewind should reproduce the
+     same stream. */
+
+  for( int cooked=0; cooked<2; cooked++ ) {
+    for( int nsec=0; nsec<2; nsec++ ) {
+      ref_init( rng, nsec ? 1L : 1000L );
+      FILE * file = tmp_open( path );
+      write_pcap( file, nsec ? 0xa1b23c4dU : 0xa1b2c3d4U, cooked );
+      tmp_close( file );
+
+      fd_pcap_mmap_t * pcap = fd_pcap_mmap_open( _pcap, path ); FD_TEST( pcap==_pcap );
+      FD_TEST( fd_pcap_mmap_fmt( pcap )==FD_PCAP_MMAP_FMT_PCAP );
+      check_mmap( pcap );
+      fd_pcap_mmap_rewind( pcap );
+      check_mmap( pcap );
+      FD_TEST( fd_pcap_mmap_close( pcap )==_pcap );
+
+      if( nsec && !cooked ) {
+        file = fopen( path, "r" ); FD_TEST( file );
+        fd_pcap_iter_t * iter = fd_pcap_iter_new( file ); FD_TEST( iter );
+        FD_TEST( fd_pcap_iter_type( iter )==FD_PCAP_ITER_TYPE_ETHERNET );
+        for( ulong idx=0UL; idx<PKT_CNT; idx++ ) {
+          uchar pkt[ PKT_MAX ];
+          long  ts = 0L;
+          FD_TEST( fd_pcap_iter_next( iter, pkt, PKT_MAX, &ts )==ref_sz[ idx ] );
+          FD_TEST( ts==ref_ts[ idx ] );
+          FD_TEST( !memcmp( pkt, ref_pkt[ idx ], ref_sz[ idx ] ) );
+        }
+        FD_TEST( !fclose( fd_pcap_iter_delete( iter ) ) );
+      }
+
+      unlink( path );
+    }
+  }
+
+  /* Truncated pcap and too small pkt_max */
+
+  do {
+    ref_init( rng, 1L );
+    FILE * file = tmp_open( path );
+    write_pcap( file, 0xa1b23c4dU, 0 );
+    long file_sz = ftell( file );
+    tmp_close( file );
+    FD_TEST( !truncate( path, file_sz-1L ) );
+
+    uchar pkt[ PKT_MAX ];
+    long  ts;
+    fd_pcap_mmap_t * pcap = fd_pcap_mmap_open( _pcap, path ); FD_TEST( pcap );
+    for( ulong idx=0UL; idx<PKT_CNT-1UL; idx++ ) FD_TEST( fd_pcap_mmap_next( pcap, pkt, PKT_MAX, &ts )==ref_sz[ idx ] );
+    FD_TEST( !fd_pcap_mmap_next( pcap, pkt, PKT_MAX, &ts ) ); /* logs */
+    FD_TEST( !fd_pcap_mmap_next( pcap, pkt, PKT_MAX, &ts ) ); /* silent */
+
+    fd_pcap_mmap_rewind( pcap );
+    FD_TEST( !fd_pcap_mmap_next( pcap, pkt, ref_sz[0]-1UL, &ts ) ); /* logs */
+    FD_TEST( fd_pcap_mmap_close( pcap )==_pcap );
+    unlink( path );
+  } while(0);
+
+  /* pcapng with two sections.  The first section has a ns Ethernet
+     interface, an unsupported interface (whose packets are skipped) and
+     an Ethernet interface with the default (us) resolution.  The second section
+     redefines interface 0 with a ms resolution. */
+
+  do {
+    ref_init( rng, 1000000L );
+    FILE * file = tmp_open( path );
+
+    write_shb( file );
+    write_idb( file, 1,   9 );
+    write_idb( file, 101, 9 );
+    write_idb( file, 1,   -1 );
+    write_blk( file, 5U, "stat", 4UL ); /* Interface statistics, skipped */
+
+    ulong half = PKT_CNT/2UL;
+    for( ulong idx=0UL; idx<half; idx++ ) {
+      uint if_idx = (uint)(idx & 1UL) << 1; /* 0 or 2 */
+      ulong ts = if_idx ? (ulong)ref_ts[ idx ]/1000UL : (ulong)ref_ts[ idx ];
+      write_epb( file, if_idx, ts, ref_pkt[ idx ], ref_sz[ idx ] );
+      write_epb( file, 1U, ts, ref_pkt[ idx ], ref_sz[ idx ] );
+    }
+
+    write_shb( file );
+    write_idb( file, 1, 3 );
+    for( ulong idx=half; idx<PKT_CNT; idx++ ) write_epb( file, 0U, (ulong)ref_ts[ idx ]/1000000UL, ref_pkt[ idx ], ref_sz[ idx ] );
+
+    tmp_close( file );
+
+    fd_pcap_mmap_t * pcap = fd_pcap_mmap_open( _pcap, path ); FD_TEST( pcap );
+    FD_TEST( fd_pcap_mmap_fmt( pcap )==FD_PCAP_MMAP_FMT_PCAPNG );
+    check_mmap( pcap );
+    fd_pcap_mmap_rewind( pcap );
+    check_mmap( pcap );
+    FD_TEST( fd_pcap_mmap_close( pcap )==_pcap );
+
+    /* Packet on an undescribed interface */
+
+    file = fopen( path, "a" ); FD_TEST( file );
+    write_epb( file, 7U, 0UL, ref_pkt[0], ref_sz[0] );
+    tmp_close( file );
+
+    pcap = fd_pcap_mmap_open( _pcap, path ); FD_TEST( pcap );
+    uchar pkt[ PKT_MAX ];
+    long  ts;
+    for( ulong idx=0UL; idx<PKT_CNT; idx++ ) FD_TEST( fd_pcap_mmap_next( pcap, pkt, PKT_MAX, &ts )==ref_sz[ idx ] );
+    FD_TEST( !fd_pcap_mmap_next( pcap, pkt, PKT_MAX, &ts ) ); /* logs */
+    FD_TEST( fd_pcap_mmap_close( pcap )==_pcap );
+
+    unlink( path );
+  } while(0);
+
+  /* pcapng written by fd_pcapng_fwrite_* (with and without comments)
+     should read back as written */
+
+  do {
+    ref_init( rng, 1L );
+    FILE * file = tmp_open( path );
+    FD_TEST( fd_pcapng_fwrite_hdr( file )==1UL );
+    for( ulong idx=0UL; idx<PKT_CNT; idx++ ) {
+      char comment[ 16 ];
+      FD_TEST( fd_cstr_printf( comment, 16UL, NULL, "pkt %lu", idx ) );
+      FD_TEST( fd_pcapng_fwrite_pkt( ref_ts[ idx ], ref_pkt[ idx ], ref_sz[ idx ], (idx & 1UL) ? comment : NULL, file )==1UL );
+    }
+    tmp_close( file );
+
+    fd_pcap_mmap_t * pcap = fd_pcap_mmap_open( _pcap, path ); FD_TEST( pcap );
+    FD_TEST( fd_pcap_mmap_fmt( pcap )==FD_PCAP_MMAP_FMT_PCAPNG );
+    check_mmap( pcap );
+    FD_TEST( fd_pcap_mmap_close( pcap )==_pcap );
+    unlink( path );
+  } while(0);
+
+  /* Throughput of min sized frames looping over a mapped file */
+
+  if( bench_cnt ) {
+    FILE * file = tmp_open( path );
+    FD_TEST( fd_pcap_fwrite_hdr( file )==1UL );
+    uchar frame[ 60 ] = {0};
+    for( ulong idx=0UL; idx<PKT_CNT*1024UL; idx++ )
+      FD_TEST( fd_pcap_fwrite_pkt( (long)idx, frame, 14UL, frame+14UL, 46UL, 0U, file )==1UL );
+    tmp_close( file );
+
+    fd_pcap_mmap_t * pcap = fd_pcap_mmap_open( _pcap, path ); FD_TEST( pcap );
+    uchar pkt[ 2048 ];
+    ulong sum = 0UL;
+    long  dt  = -fd_log_wallclock();
+    FD_COMPILER_MFENCE();
+    for( ulong rem=bench_cnt; rem; rem-- ) {
+      long  ts;
+      ulong sz = fd_pcap_mmap_next( pcap, pkt, 2048UL, &ts );
+      if( FD_UNLIKELY( !sz ) ) { fd_pcap_mmap_rewind( pcap ); sz = fd_pcap_mmap_next( pcap, pkt, 2048UL, &ts ); }
+      sum += sz + (ulong)pkt[ 0 ];
+    }
+    FD_COMPILER_MFENCE();
+    dt += fd_log_wallclock();
+    FD_COMPILER_UNPREDICTABLE( sum );
+    FD_LOG_NOTICE(( "fd_pcap_mmap_next: %.3f Mpps (64 B frames)", 1e3*(double)bench_cnt/(double)dt ));
+    FD_TEST( fd_pcap_mmap_close( pcap )==_pcap );
+    unlink( path );
+  }
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_NOTICE(( "skip: unit test requires FD_HAS_HOSTED" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
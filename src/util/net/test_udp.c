@@ -14,7 +14,48 @@ main( int     argc,
   FD_TEST( (ulong)( &(((fd_udp_hdr_t *)NULL)->check    ) )==6UL );
   FD_TEST( (ulong)(  (((fd_udp_hdr_t *)NULL)->u        ) )==0UL );
 
-  /* FIXME: TEST FD_IP4_UDP_CHECK */
+  /* Test fd_ip4_udp_check by filling in and validating checksums of
+     random datagrams of random sizes and alignments */
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  static uchar buf[ 8UL+2048UL+64UL ];
+
+  for( ulong iter=0UL; iter<100000UL; iter++ ) {
+    ulong off      = fd_rng_ulong( rng ) & 63UL;
+    ulong dgram_sz = fd_rng_ulong_roll( rng, 2049UL );
+    for( ulong b=0UL; b<8UL+dgram_sz; b++ ) buf[off+b] = fd_rng_uchar( rng );
+
+    uint           saddr = fd_rng_uint( rng );
+    uint           daddr = fd_rng_uint( rng );
+    fd_udp_hdr_t * udp   = (fd_udp_hdr_t *)fd_type_pun( buf+off );
+    uchar *        dgram = buf+off+8UL;
+    udp->net_len = fd_ushort_bswap( (ushort)(8UL+dgram_sz) );
+    udp->check   = (ushort)0;
+
+    /* Reference: sum the pseudo header and the datagram as big endian
+       words */
+
+    ulong c = (ulong)fd_ushort_bswap( (ushort) saddr      ) + (ulong)fd_ushort_bswap( (ushort)(saddr>>16) )
+            + (ulong)fd_ushort_bswap( (ushort) daddr      ) + (ulong)fd_ushort_bswap( (ushort)(daddr>>16) )
+            + (ulong)FD_IP4_HDR_PROTOCOL_UDP + 8UL + dgram_sz;
+    for( ulong b=0UL; b<8UL+dgram_sz; b+=2UL ) c += (((ulong)buf[off+b])<<8) | ((b+1UL<8UL+dgram_sz) ? (ulong)buf[off+b+1UL] : 0UL);
+    while( c>>16 ) c = (c>>16) + (c & 0xffffUL);
+    ushort ref = fd_ushort_bswap( (ushort)~c );
+
+    ushort check = fd_ip4_udp_check( saddr, daddr, udp, dgram );
+    FD_TEST( check==ref );
+    udp->check = check;
+    if( check ) FD_TEST( !fd_ip4_udp_check( saddr, daddr, udp, dgram ) );
+
+    if( dgram_sz && check ) {
+      ulong b = fd_rng_ulong_roll( rng, dgram_sz );
+      dgram[ b ] = (uchar)(dgram[ b ] ^ (1U << fd_rng_uint_roll( rng, 8U )));
+      FD_TEST( fd_ip4_udp_check( saddr, daddr, udp, dgram ) );
+    }
+  }
+
+  fd_rng_delete( fd_rng_leave( rng ) );
 
   FD_LOG_NOTICE(( "pass" ));
   fd_halt();
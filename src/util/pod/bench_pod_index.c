@@ -0,0 +1,119 @@
+#include "../fd_util.h"
+#include "fd_pod_index.h"
+
+/* bench_pod_index models tile boot querying a large topology config
+   pod.  The pod has --tile-cnt verify tiles, each with a subpod of
+   typical tile configuration (e.g. "verify.v123.mcache"), along with
+   some other top level configuration.  It times the queries each tile
+   does at boot with fd_pod_query and with an fd_pod_index (including
+   the index build and a no-op refresh). */
+
+#define TILE_CNT_MAX (4096UL)
+#define POD_MAX      (1UL<<22)
+#define INDEX_MAX    (1UL<<23)
+
+static uchar _pod  [ POD_MAX   ];
+static uchar _index[ INDEX_MAX ] __attribute__((aligned(FD_POD_INDEX_ALIGN)));
+
+static char const * tile_key[] = { "cnc", "mcache", "dcache", "fseq", "tcache", "cpu_idx", "depth", "mtu", "lazy", "seed" };
+
+#define TILE_KEY_CNT (sizeof(tile_key)/sizeof(tile_key[0]))
+
+static char path[ TILE_CNT_MAX*TILE_KEY_CNT ][ 32 ];
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong tile_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--tile-cnt", NULL, 1000UL );
+  if( FD_UNLIKELY( !((1UL<=tile_cnt) & (tile_cnt<=TILE_CNT_MAX)) ) ) FD_LOG_ERR(( "--tile-cnt should be in [1,%lu]", TILE_CNT_MAX ));
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  /* Create the config pod */
+
+  uchar * pod = fd_pod_join( fd_pod_new( _pod, POD_MAX ) );
+  if( FD_UNLIKELY( !pod ) ) FD_LOG_ERR(( "fd_pod_new failed" ));
+
+  FD_TEST( fd_pod_insert_cstr ( pod, "app",             "bench"   ) );
+  FD_TEST( fd_pod_insert_cstr ( pod, "wksp",            "bench.0" ) );
+  FD_TEST( fd_pod_insert_ulong( pod, "main.cnc",        4096UL    ) );
+  FD_TEST( fd_pod_insert_ulong( pod, "pack.cnc",        8192UL    ) );
+  FD_TEST( fd_pod_insert_ulong( pod, "verify.cnt",      tile_cnt  ) );
+  FD_TEST( fd_pod_insert_ulong( pod, "dedup.tcache",    12288UL   ) );
+
+  ulong path_cnt = 0UL;
+  for( ulong tile_idx=0UL; tile_idx<tile_cnt; tile_idx++ ) {
+    for( ulong key_idx=0UL; key_idx<TILE_KEY_CNT; key_idx++ ) {
+      FD_TEST( fd_cstr_printf( path[ path_cnt ], 32UL, NULL, "verify.v%lu.%s", tile_idx, tile_key[ key_idx ] ) );
+      FD_TEST( fd_pod_insert_ulong( pod, path[ path_cnt ], fd_rng_ulong( rng ) ) );
+      path_cnt++;
+    }
+  }
+
+  ulong key_cnt = fd_pod_cnt_recursive( pod );
+  FD_LOG_NOTICE(( "config pod: %lu verify tiles, %lu keys, %lu bytes used", tile_cnt, key_cnt, fd_pod_used( pod ) ));
+
+  /* Create the index */
+
+  ulong footprint = fd_pod_index_footprint( key_cnt );
+  if( FD_UNLIKELY( !footprint || footprint>INDEX_MAX ) ) FD_LOG_ERR(( "increase INDEX_MAX" ));
+  fd_pod_index_t * index = fd_pod_index_join( fd_pod_index_new( _index, key_cnt ) );
+  if( FD_UNLIKELY( !index ) ) FD_LOG_ERR(( "fd_pod_index_new failed" ));
+
+  long dt = -fd_log_wallclock();
+  FD_TEST( fd_pod_index_build( index, pod )==index );
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "build:   %.3f ms (%lu keys, footprint %lu)", 1e-6*(double)dt, fd_pod_index_key_cnt( index ), footprint ));
+
+  dt = -fd_log_wallclock();
+  FD_TEST( fd_pod_index_refresh( index, pod )==index );
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "refresh: %.3f ms (no-op)", 1e-6*(double)dt ));
+
+  /* Boot queries: every tile queries its config in order */
+
+  ulong chk0 = 0UL;
+  dt = -fd_log_wallclock();
+  for( ulong path_idx=0UL; path_idx<path_cnt; path_idx++ ) chk0 += fd_pod_query_ulong( pod, path[ path_idx ], 0UL );
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "fd_pod_query:       %10.3f ns/query (%lu queries)", (double)dt/(double)path_cnt, path_cnt ));
+
+  ulong chk1 = 0UL;
+  dt = -fd_log_wallclock();
+  for( ulong path_idx=0UL; path_idx<path_cnt; path_idx++ ) chk1 += fd_pod_index_query_ulong( index, pod, path[ path_idx ], 0UL );
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "fd_pod_index_query: %10.3f ns/query (%lu queries)", (double)dt/(double)path_cnt, path_cnt ));
+
+  FD_TEST( chk0==chk1 );
+
+  /* Runtime queries: random tile config lookups (the index gets
+     repeated more to get a stable timing) */
+
+  ulong iter_cnt = 100000UL;
+
+  chk0 = 0UL;
+  dt = -fd_log_wallclock();
+  for( ulong iter=0UL; iter<iter_cnt; iter++ ) chk0 += fd_pod_query_ulong( pod, path[ fd_rng_ulong_roll( rng, path_cnt ) ], 0UL );
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "random fd_pod_query:       %10.3f ns/query", (double)dt/(double)iter_cnt ));
+
+  iter_cnt *= 100UL;
+
+  chk1 = 0UL;
+  dt = -fd_log_wallclock();
+  for( ulong iter=0UL; iter<iter_cnt; iter++ ) chk1 += fd_pod_index_query_ulong( index, pod, path[ fd_rng_ulong_roll( rng, path_cnt ) ], 0UL );
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "random fd_pod_index_query: %10.3f ns/query", (double)dt/(double)iter_cnt ));
+
+  FD_TEST( chk0 || chk1 || !path_cnt );
+
+  fd_pod_index_delete( fd_pod_index_leave( index ) );
+  fd_pod_delete( fd_pod_leave( pod ) );
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
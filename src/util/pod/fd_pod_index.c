@@ -0,0 +1,328 @@
+#include "fd_pod_index.h"
+#include "../log/fd_log.h"
+
+#define FD_POD_INDEX_MAGIC (0xf17eda2c3790d1d0UL) /* firedancer pod index ver 0 */
+
+#define FD_POD_INDEX_PARENT_NULL (~0UL)
+
+/* An index slot describes one key in the pod.  key_sz==0 indicates the
+   slot is empty (keys in a pod always have key_sz>=1).  parent is the
+   slot of the subpod holding the key (FD_POD_INDEX_PARENT_NULL if the
+   key is in the top level pod).  Offsets are relative to the first
+   byte of the top level pod. */
+
+struct __attribute__((aligned(FD_POD_INDEX_ALIGN))) fd_pod_index_private_slot {
+  ulong hash;     /* fd_ulong_hash of the full dotted path hash */
+  ulong parent;
+  ulong key_off;
+  ulong key_sz;
+  ulong val_off;
+  ulong val_sz;
+  int   val_type;
+};
+
+typedef struct fd_pod_index_private_slot fd_pod_index_private_slot_t;
+
+struct __attribute__((aligned(FD_POD_INDEX_ALIGN))) fd_pod_index_private {
+  ulong magic;    /* == FD_POD_INDEX_MAGIC */
+  ulong key_max;
+  ulong slot_cnt; /* Power of 2 >= 2*key_max */
+  ulong key_cnt;  /* In [0,key_max] */
+  ulong gen;      /* Generation of the indexed pod, 0 if the index is empty */
+
+  /* slot_cnt fd_pod_index_private_slot_t follow here */
+};
+
+FD_STATIC_ASSERT( sizeof(fd_pod_index_private_slot_t)==FD_POD_INDEX_ALIGN, layout );
+FD_STATIC_ASSERT( sizeof(fd_pod_index_t             )==FD_POD_INDEX_ALIGN, layout );
+
+static inline fd_pod_index_private_slot_t *
+fd_pod_index_private_slot( fd_pod_index_t * index ) {
+  return (fd_pod_index_private_slot_t *)(index+1);
+}
+
+static inline fd_pod_index_private_slot_t const *
+fd_pod_index_private_slot_const( fd_pod_index_t const * index ) {
+  return (fd_pod_index_private_slot_t const *)(index+1);
+}
+
+/* fd_pod_index_private_hash_{init,append} compute a hash of a dotted
+   path incrementally (FNV-1a).  This lets the build hash the full path
+   of a key in a subpod by continuing the hash of the subpod's path
+   (without materializing the path).  The result is fed through
+   fd_ulong_hash before being used to pick a slot. */
+
+#define FD_POD_INDEX_PRIVATE_HASH_INIT  (0xcbf29ce484222325UL)
+#define FD_POD_INDEX_PRIVATE_HASH_PRIME (0x00000100000001b3UL)
+
+static inline ulong
+fd_pod_index_private_hash_append( ulong        h,
+                                  char const * s,
+                                  ulong        sz ) {
+  for( ulong i=0UL; i<sz; i++ ) h = (h ^ (ulong)(uchar)s[i]) * FD_POD_INDEX_PRIVATE_HASH_PRIME;
+  return h;
+}
+
+ulong
+fd_pod_gen( uchar const * pod ) {
+  ulong gen = fd_hash( 0UL, pod, fd_pod_used( pod ) );
+  return fd_ulong_if( !gen, 1UL, gen ); /* 0 reserved for an empty index */
+}
+
+ulong
+fd_pod_index_align( void ) {
+  return FD_POD_INDEX_ALIGN;
+}
+
+ulong
+fd_pod_index_footprint( ulong key_max ) {
+  if( FD_UNLIKELY( !((1UL<=key_max) & (key_max<=FD_POD_INDEX_KEY_MAX)) ) ) return 0UL;
+  return sizeof(fd_pod_index_t) + fd_ulong_pow2_up( 2UL*key_max )*sizeof(fd_pod_index_private_slot_t);
+}
+
+void *
+fd_pod_index_new( void * shmem,
+                  ulong  key_max ) {
+
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, fd_pod_index_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  ulong footprint = fd_pod_index_footprint( key_max );
+  if( FD_UNLIKELY( !footprint ) ) {
+    FD_LOG_WARNING(( "bad key_max" ));
+    return NULL;
+  }
+
+  fd_pod_index_t * index = (fd_pod_index_t *)shmem;
+
+  memset( index, 0, footprint );
+
+  index->key_max  = key_max;
+  index->slot_cnt = fd_ulong_pow2_up( 2UL*key_max );
+  index->key_cnt  = 0UL;
+  index->gen      = 0UL;
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( index->magic ) = FD_POD_INDEX_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return shmem;
+}
+
+fd_pod_index_t *
+fd_pod_index_join( void * shindex ) {
+
+  if( FD_UNLIKELY( !shindex ) ) {
+    FD_LOG_WARNING(( "NULL shindex" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shindex, fd_pod_index_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shindex" ));
+    return NULL;
+  }
+
+  fd_pod_index_t * index = (fd_pod_index_t *)shindex;
+
+  if( FD_UNLIKELY( index->magic!=FD_POD_INDEX_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  return index;
+}
+
+void *
+fd_pod_index_leave( fd_pod_index_t * index ) {
+
+  if( FD_UNLIKELY( !index ) ) {
+    FD_LOG_WARNING(( "NULL index" ));
+    return NULL;
+  }
+
+  return (void *)index;
+}
+
+void *
+fd_pod_index_delete( void * shindex ) {
+
+  if( FD_UNLIKELY( !shindex ) ) {
+    FD_LOG_WARNING(( "NULL shindex" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shindex, fd_pod_index_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shindex" ));
+    return NULL;
+  }
+
+  fd_pod_index_t * index = (fd_pod_index_t *)shindex;
+
+  if( FD_UNLIKELY( index->magic!=FD_POD_INDEX_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( index->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return shindex;
+}
+
+ulong fd_pod_index_key_max( fd_pod_index_t const * index ) { return index->key_max; }
+ulong fd_pod_index_key_cnt( fd_pod_index_t const * index ) { return index->key_cnt; }
+ulong fd_pod_index_gen    ( fd_pod_index_t const * index ) { return index->gen;     }
+
+/* fd_pod_index_private_build_node inserts all the keys in subpod (a
+   pod nested in pod at any depth, including pod itself) into the index.
+   parent is the slot of subpod (FD_POD_INDEX_PARENT_NULL for pod
+   itself) and h is the incremental hash of subpod's dotted path.
+   Returns 0 on success and -1 if the index is full. */
+
+static int
+fd_pod_index_private_build_node( fd_pod_index_t * index,
+                                 uchar const *    pod,
+                                 uchar const *    subpod,
+                                 ulong            parent,
+                                 ulong            h ) {
+  fd_pod_index_private_slot_t * slot    = fd_pod_index_private_slot( index );
+  ulong                         mask    = index->slot_cnt - 1UL;
+  ulong                         key_max = index->key_max;
+
+  if( parent!=FD_POD_INDEX_PARENT_NULL ) h = fd_pod_index_private_hash_append( h, ".", 1UL );
+
+  for( fd_pod_iter_t iter = fd_pod_iter_init( subpod ); !fd_pod_iter_done( iter ); iter = fd_pod_iter_next( iter ) ) {
+    fd_pod_info_t info = fd_pod_iter_info( iter );
+
+    if( FD_UNLIKELY( index->key_cnt>=key_max ) ) return -1;
+
+    ulong key_h = fd_pod_index_private_hash_append( h, info.key, info.key_sz-1UL );
+    ulong hash  = fd_ulong_hash( key_h );
+
+    /* Linear probe for an empty slot.  The index is at most half full
+       so this terminates quickly.  If the pod has duplicate keys (not
+       possible for a pod built with the fd_pod APIs), the earliest one
+       in the pod is earlier in the probe sequence, matching
+       fd_pod_query. */
+
+    ulong idx = hash & mask;
+    while( slot[ idx ].key_sz ) idx = (idx+1UL) & mask;
+
+    slot[ idx ].hash     = hash;
+    slot[ idx ].parent   = parent;
+    slot[ idx ].key_off  = (ulong)((uchar const *)info.key - pod);
+    slot[ idx ].key_sz   = info.key_sz;
+    slot[ idx ].val_off  = (ulong)((uchar const *)info.val - pod);
+    slot[ idx ].val_sz   = info.val_sz;
+    slot[ idx ].val_type = info.val_type;
+    index->key_cnt++;
+
+    if( info.val_type==FD_POD_VAL_TYPE_SUBPOD &&
+        FD_UNLIKELY( fd_pod_index_private_build_node( index, pod, (uchar const *)info.val, idx, key_h ) ) ) return -1;
+  }
+
+  return 0;
+}
+
+fd_pod_index_t *
+fd_pod_index_build( fd_pod_index_t * index,
+                    uchar const *    pod ) {
+
+  fd_pod_index_private_slot_t * slot = fd_pod_index_private_slot( index );
+
+  memset( slot, 0, index->slot_cnt*sizeof(fd_pod_index_private_slot_t) );
+  index->key_cnt = 0UL;
+  index->gen     = 0UL;
+
+  if( FD_UNLIKELY( !pod ) ) {
+    FD_LOG_WARNING(( "NULL pod" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( fd_pod_index_private_build_node( index, pod, pod, FD_POD_INDEX_PARENT_NULL, FD_POD_INDEX_PRIVATE_HASH_INIT ) ) ) {
+    FD_LOG_WARNING(( "pod has more than key_max %lu keys", index->key_max ));
+    memset( slot, 0, index->slot_cnt*sizeof(fd_pod_index_private_slot_t) );
+    index->key_cnt = 0UL;
+    return NULL;
+  }
+
+  index->gen = fd_pod_gen( pod );
+  return index;
+}
+
+fd_pod_index_t *
+fd_pod_index_refresh( fd_pod_index_t * index,
+                      uchar const *    pod ) {
+  if( FD_UNLIKELY( !pod ) ) {
+    FD_LOG_WARNING(( "NULL pod" ));
+    return NULL;
+  }
+  if( FD_LIKELY( !fd_pod_index_is_stale( index, pod ) ) ) return index;
+  return fd_pod_index_build( index, pod );
+}
+
+/* fd_pod_index_private_match returns 1 if the path (path_len bytes, in
+   a strlen sense) is the full dotted path of the key in slot idx and 0
+   otherwise.  Matches from the end of the path, walking up the slot's
+   parents. */
+
+static inline int
+fd_pod_index_private_match( fd_pod_index_private_slot_t const * slot,
+                            ulong                               idx,
+                            uchar const *                       pod,
+                            char const *                        path,
+                            ulong                               path_len ) {
+  ulong pos = path_len;
+  for(;;) {
+    ulong key_len = slot[ idx ].key_sz - 1UL;
+    if( FD_UNLIKELY( key_len>pos ) ) return 0;
+    pos -= key_len;
+    if( FD_UNLIKELY( memcmp( path + pos, pod + slot[ idx ].key_off, key_len ) ) ) return 0;
+    idx = slot[ idx ].parent;
+    if( idx==FD_POD_INDEX_PARENT_NULL ) return !pos;
+    if( FD_UNLIKELY( (!pos) || path[ pos-1UL ]!='.' ) ) return 0;
+    pos--;
+  }
+}
+
+int
+fd_pod_index_query( fd_pod_index_t const * FD_RESTRICT index,
+                    uchar const *          FD_RESTRICT pod,
+                    char const *           FD_RESTRICT path,
+                    fd_pod_info_t *        FD_RESTRICT opt_info ) {
+  if( FD_UNLIKELY( (!index) | (!pod) | (!path) ) ) return FD_POD_ERR_INVAL;
+
+  ulong path_len = strlen( path );
+  ulong hash     = fd_ulong_hash( fd_pod_index_private_hash_append( FD_POD_INDEX_PRIVATE_HASH_INIT, path, path_len ) );
+
+  fd_pod_index_private_slot_t const * slot = fd_pod_index_private_slot_const( index );
+  ulong                               mask = index->slot_cnt - 1UL;
+
+  ulong idx = hash & mask;
+  for(;;) {
+    fd_pod_index_private_slot_t const * s = slot + idx;
+    if( FD_UNLIKELY( !s->key_sz ) ) break;
+    if( FD_LIKELY( s->hash==hash ) && FD_LIKELY( fd_pod_index_private_match( slot, idx, pod, path, path_len ) ) ) {
+      if( opt_info ) {
+        opt_info->key_sz   = s->key_sz;
+        opt_info->key      = (char const *)(pod + s->key_off);
+        opt_info->val_type = s->val_type;
+        opt_info->val_sz   = s->val_sz;
+        opt_info->val      = (void const *)(pod + s->val_off);
+        opt_info->parent   = NULL;
+      }
+      return FD_POD_SUCCESS;
+    }
+    idx = (idx+1UL) & mask;
+  }
+
+  return FD_POD_ERR_RESOLVE;
+}
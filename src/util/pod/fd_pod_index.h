@@ -0,0 +1,266 @@
+#ifndef HEADER_fd_src_util_pod_fd_pod_index_h
+#define HEADER_fd_src_util_pod_fd_pod_index_h
+
+/* fd_pod_index provides an optional compiled index over a pod for hot
+   configuration queries.  fd_pod_query walks the pod's key-val pairs
+   linearly (and recursively for each key in a dotted path), which is
+   O(pod_cnt) per path component.  An index hashes the full dotted path
+   of every key in the pod (including keys in subpods) once at build
+   time such that a query is O(1) (a hash of the path, typically a
+   single probe and a compare of the path against the pod's keys).
+
+   The index stores offsets relative to the first byte of the pod (not
+   pointers) so the index and pod can be placed in shared memory and
+   used by different processes that have the pod mapped at different
+   addresses.
+
+   Since the pod encoding has no room for a generation counter (and a
+   pod can be modified by many operations, including users writing
+   directly into values they allocated), the pod generation is a 64-bit
+   tag of the pod's current contents (see fd_pod_gen).  Any change to
+   the pod (practically) changes its generation.  An index records the
+   generation of the pod it was built from.  fd_pod_index_refresh
+   compares this to the pod's current generation and rebuilds the index
+   if the pod changed.  Queries themselves do not check the generation
+   (that would be O(pod_used)).  It is up to the user to refresh the
+   index after doing any invalidating operations on the pod.
+
+   Typical usage:
+
+     ulong key_max = fd_pod_cnt_recursive( pod );
+     void * mem = ... alloc fd_pod_index_footprint( key_max ) bytes
+                  with fd_pod_index_align() alignment ...
+     fd_pod_index_t * index = fd_pod_index_join( fd_pod_index_new( mem, key_max ) );
+     fd_pod_index_build( index, pod );
+
+     ... many O(1) queries ...
+     ulong depth = fd_pod_index_query_ulong( index, pod, "verify.v123.depth", 0UL );
+
+     ... after the pod might have changed ...
+     fd_pod_index_refresh( index, pod ); */
+
+#include "fd_pod.h"
+
+/* FD_POD_INDEX_ALIGN gives the alignment of an index.  An index slot
+   is a cache line. */
+
+#define FD_POD_INDEX_ALIGN (64UL)
+
+/* FD_POD_INDEX_KEY_MAX gives the maximum number of keys an index
+   supports (keeps footprint calculations from overflowing). */
+
+#define FD_POD_INDEX_KEY_MAX (1UL<<40)
+
+struct fd_pod_index_private;
+typedef struct fd_pod_index_private fd_pod_index_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_pod_gen returns the current generation of a pod.  This is a
+   non-zero 64-bit tag of the pod's current contents (bytes [0,pod_used)
+   of the pod).  Two pods with the same contents have the same
+   generation and a pod's generation changes (with probability
+   ~1-2^-64) whenever its contents change.  Assumes pod is a current
+   local join.  O(pod_used) but fast (fd_hash speed). */
+
+FD_FN_PURE ulong
+fd_pod_gen( uchar const * pod );
+
+/* Constructors *******************************************************/
+
+/* fd_pod_index_{align,footprint} return the alignment and footprint
+   required for a memory region to be used as an index that can hold up
+   to key_max keys.  key_max should be at least the
+   fd_pod_cnt_recursive of the pods to be indexed.  footprint returns 0
+   if key_max is not in [1,FD_POD_INDEX_KEY_MAX].
+
+   fd_pod_index_new formats an unused memory region for use as an
+   index.  The index will initially be empty (every query will fail
+   with FD_POD_ERR_RESOLVE and it will be stale for every pod).
+   Returns shmem on success and NULL on failure (logs details).
+
+   fd_pod_index_{join,leave,delete} have the usual semantics. */
+
+FD_FN_CONST ulong
+fd_pod_index_align( void );
+
+FD_FN_CONST ulong
+fd_pod_index_footprint( ulong key_max );
+
+void *
+fd_pod_index_new( void * shmem,
+                  ulong  key_max );
+
+fd_pod_index_t *
+fd_pod_index_join( void * shindex );
+
+void *
+fd_pod_index_leave( fd_pod_index_t * index );
+
+void *
+fd_pod_index_delete( void * shindex );
+
+/* Accessors **********************************************************/
+
+/* fd_pod_index_{key_max,key_cnt,gen} return the maximum number of keys
+   the index can hold, the number of keys currently in the index and
+   the generation of the pod the index was last built from (0 if the
+   index is empty because it was never successfully built).  Assumes
+   index is a current local join. */
+
+FD_FN_PURE ulong fd_pod_index_key_max( fd_pod_index_t const * index );
+FD_FN_PURE ulong fd_pod_index_key_cnt( fd_pod_index_t const * index );
+FD_FN_PURE ulong fd_pod_index_gen    ( fd_pod_index_t const * index );
+
+/* fd_pod_index_is_stale returns 0 if the index was built from a pod
+   with pod's current contents and non-zero otherwise.  O(pod_used). */
+
+static inline int
+fd_pod_index_is_stale( fd_pod_index_t const * index,
+                       uchar const *          pod ) {
+  return fd_pod_index_gen( index )!=fd_pod_gen( pod );
+}
+
+/* Operations *********************************************************/
+
+/* fd_pod_index_build indexes all the keys in pod (recursing into
+   subpods).  Any previous index contents are discarded.  Returns index
+   on success and NULL on failure (NULL pod or pod has more than
+   key_max keys, logs details).  On failure, the index will be empty.
+   Assumes index is a current local join and pod is a current local
+   join to a well formed pod that will not be changed during the build.
+   O(fd_pod_cnt_recursive(pod)) + O(pod_used).
+
+   fd_pod_index_refresh rebuilds the index if the index is stale for
+   pod.  Returns index on success (including when no rebuild was
+   necessary) and NULL on failure (as per build).  O(pod_used) if no
+   rebuild was necessary. */
+
+fd_pod_index_t *
+fd_pod_index_build( fd_pod_index_t * index,
+                    uchar const *    pod );
+
+fd_pod_index_t *
+fd_pod_index_refresh( fd_pod_index_t * index,
+                      uchar const *    pod );
+
+/* fd_pod_index_query is fd_pod_query( pod, path, opt_info ) in O(1).
+   Assumes index is current for pod (e.g. built or refreshed with no
+   subsequent invalidating operations on the pod).  The pod passed here
+   is used to resolve the offsets stored in the index and can be a join
+   to the pod in a different address space than the one used for the
+   build.  Returns FD_POD_SUCCESS, FD_POD_ERR_INVAL or
+   FD_POD_ERR_RESOLVE.  Unlike fd_pod_query, a path with a prefix that
+   resolves to a non-subpod fails with RESOLVE (not TYPE). */
+
+int
+fd_pod_index_query( fd_pod_index_t const * FD_RESTRICT index,
+                    uchar const *          FD_RESTRICT pod,
+                    char const *           FD_RESTRICT path,
+                    fd_pod_info_t *        FD_RESTRICT opt_info );
+
+/* fd_pod_index_query_{subpod,buf,cstr,[type]} are the indexed versions
+   of the corresponding fd_pod_query_* and have the same semantics
+   (given index is current for pod). */
+
+FD_FN_UNUSED static uchar const * /* Work around -Winline */
+fd_pod_index_query_subpod( fd_pod_index_t const * FD_RESTRICT index,
+                           uchar const *          FD_RESTRICT pod,
+                           char const *           FD_RESTRICT path ) {
+  fd_pod_info_t info[1];
+  if( FD_UNLIKELY( fd_pod_index_query( index, pod, path, info ) ) ||
+      FD_UNLIKELY( info->val_type!=FD_POD_VAL_TYPE_SUBPOD       ) ) return NULL;
+  return (uchar const *)info->val;
+}
+
+FD_FN_UNUSED static void const * /* Work around -Winline */
+fd_pod_index_query_buf( fd_pod_index_t const * FD_RESTRICT index,
+                        uchar const *          FD_RESTRICT pod,
+                        char const *           FD_RESTRICT path,
+                        ulong *                FD_RESTRICT opt_buf_sz ) {
+  fd_pod_info_t info[1];
+  if( FD_UNLIKELY( fd_pod_index_query( index, pod, path, info ) ) ||
+      FD_UNLIKELY( info->val_type!=FD_POD_VAL_TYPE_BUF          ) ) return NULL;
+  if( opt_buf_sz ) *opt_buf_sz = info->val_sz;
+  return info->val;
+}
+
+FD_FN_UNUSED static char const * /* Work around -Winline */
+fd_pod_index_query_cstr( fd_pod_index_t const * FD_RESTRICT index,
+                         uchar const *          FD_RESTRICT pod,
+                         char const *           FD_RESTRICT path,
+                         char const *           FD_RESTRICT def ) {
+  fd_pod_info_t info[1];
+  if( FD_UNLIKELY( fd_pod_index_query( index, pod, path, info ) ) ||
+      FD_UNLIKELY( info->val_type!=FD_POD_VAL_TYPE_CSTR         ) ) return def;
+  return info->val_sz ? (char const *)info->val : NULL;
+}
+
+#define FD_POD_INDEX_IMPL(type,TYPE,DECODE)                                    \
+FD_FN_UNUSED static type /* Work around -Winline */                            \
+fd_pod_index_query_##type( fd_pod_index_t const * FD_RESTRICT index,           \
+                           uchar const *          FD_RESTRICT pod,             \
+                           char const *           FD_RESTRICT path,            \
+                           type                               def ) {          \
+  fd_pod_info_t info[1];                                                       \
+  if( FD_UNLIKELY( fd_pod_index_query( index, pod, path, info ) ) ||           \
+      FD_UNLIKELY( info->val_type!=FD_POD_VAL_TYPE_##TYPE       ) ) return def; \
+  DECODE;                                                                      \
+}
+
+#define FD_POD_INDEX_RAW     return *(__typeof__(def) const *)(info->val)
+#define FD_POD_INDEX_LOAD    return FD_LOAD( __typeof__(def), info->val )
+#define FD_POD_INDEX_SVW     ulong u; fd_ulong_svw_dec( (uchar const *)info->val, &u ); return (__typeof__(def))u
+#define FD_POD_INDEX_SVW_ZZ  ulong u; fd_ulong_svw_dec( (uchar const *)info->val, &u ); return (__typeof__(def))fd_long_zz_dec( u )
+
+FD_POD_INDEX_IMPL( char,   CHAR,   FD_POD_INDEX_RAW    )
+FD_POD_INDEX_IMPL( schar,  SCHAR,  FD_POD_INDEX_RAW    )
+FD_POD_INDEX_IMPL( uchar,  UCHAR,  FD_POD_INDEX_RAW    )
+FD_POD_INDEX_IMPL( float,  FLOAT,  FD_POD_INDEX_LOAD   )
+#if FD_HAS_DOUBLE
+FD_POD_INDEX_IMPL( double, DOUBLE, FD_POD_INDEX_LOAD   )
+#endif
+FD_POD_INDEX_IMPL( ushort, USHORT, FD_POD_INDEX_SVW    )
+FD_POD_INDEX_IMPL( uint,   UINT,   FD_POD_INDEX_SVW    )
+FD_POD_INDEX_IMPL( ulong,  ULONG,  FD_POD_INDEX_SVW    )
+FD_POD_INDEX_IMPL( short,  SHORT,  FD_POD_INDEX_SVW_ZZ )
+FD_POD_INDEX_IMPL( int,    INT,    FD_POD_INDEX_SVW_ZZ )
+FD_POD_INDEX_IMPL( long,   LONG,   FD_POD_INDEX_SVW_ZZ )
+
+#undef FD_POD_INDEX_SVW_ZZ
+#undef FD_POD_INDEX_SVW
+#undef FD_POD_INDEX_LOAD
+#undef FD_POD_INDEX_RAW
+#undef FD_POD_INDEX_IMPL
+
+#if FD_HAS_INT128
+FD_FN_UNUSED static uint128 /* Work around -Winline */
+fd_pod_index_query_uint128( fd_pod_index_t const * FD_RESTRICT index,
+                            uchar const *          FD_RESTRICT pod,
+                            char const *           FD_RESTRICT path,
+                            uint128                            def ) {
+  fd_pod_info_t info[1];
+  if( FD_UNLIKELY( fd_pod_index_query( index, pod, path, info ) ) ||
+      FD_UNLIKELY( info->val_type!=FD_POD_VAL_TYPE_UINT128      ) ) return def;
+  union { ulong w[2]; uint128 u; } tmp;
+  fd_ulong_svw_dec( fd_ulong_svw_dec( (uchar const *)info->val, tmp.w ), tmp.w+1 );
+  return tmp.u;
+}
+
+FD_FN_UNUSED static int128 /* Work around -Winline */
+fd_pod_index_query_int128( fd_pod_index_t const * FD_RESTRICT index,
+                           uchar const *          FD_RESTRICT pod,
+                           char const *           FD_RESTRICT path,
+                           int128                             def ) {
+  fd_pod_info_t info[1];
+  if( FD_UNLIKELY( fd_pod_index_query( index, pod, path, info ) ) ||
+      FD_UNLIKELY( info->val_type!=FD_POD_VAL_TYPE_INT128       ) ) return def;
+  union { ulong w[2]; uint128 u; } tmp;
+  fd_ulong_svw_dec( fd_ulong_svw_dec( (uchar const *)info->val, tmp.w ), tmp.w+1 );
+  return fd_int128_zz_dec( tmp.u );
+}
+#endif
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_util_pod_fd_pod_index_h */
@@ -0,0 +1,248 @@
+#include "../fd_util.h"
+#include "fd_pod_index.h"
+
+FD_STATIC_ASSERT( FD_POD_INDEX_ALIGN  ==64UL,      unit_test );
+FD_STATIC_ASSERT( FD_POD_INDEX_KEY_MAX==(1UL<<40), unit_test );
+
+#define POD_MAX (16384UL)
+#define KEY_MAX (1024UL)
+
+static uchar mem [ POD_MAX ];
+static uchar mem2[ POD_MAX ];
+static uchar _index[ 1UL<<18 ] __attribute__((aligned(FD_POD_INDEX_ALIGN)));
+
+static fd_pod_info_t list[ KEY_MAX ];
+
+/* path_of populates path with the full dotted path of the key described
+   by info (from a recursive listing).  Returns the strlen of path. */
+
+static ulong
+path_of( fd_pod_info_t const * info,
+         char *                path ) {
+  ulong len = 0UL;
+  if( info->parent ) {
+    len = path_of( info->parent, path );
+    path[ len++ ] = '.';
+  }
+  memcpy( path + len, info->key, info->key_sz );
+  return len + info->key_sz - 1UL;
+}
+
+/* check_query tests that the index query for path gives the same result
+   as fd_pod_query. */
+
+static void
+check_query( fd_pod_index_t const * index,
+             uchar const *          pod,
+             char const *           path ) {
+  fd_pod_info_t exp[1]; int exp_err = fd_pod_query      ( pod, path, exp );
+  fd_pod_info_t got[1]; int got_err = fd_pod_index_query( index, pod, path, got );
+  if( exp_err==FD_POD_ERR_TYPE ) exp_err = FD_POD_ERR_RESOLVE;
+  FD_TEST( got_err==exp_err );
+  if( got_err ) return;
+  FD_TEST( got->key_sz  ==exp->key_sz   );
+  FD_TEST( got->key     ==exp->key      );
+  FD_TEST( got->val_type==exp->val_type );
+  FD_TEST( got->val_sz  ==exp->val_sz   );
+  FD_TEST( got->val     ==exp->val      );
+  FD_TEST( got->parent  ==exp->parent   );
+  FD_TEST( !fd_pod_index_query( index, pod, path, NULL ) );
+}
+
+static void
+rand_path( fd_rng_t * rng,
+           char *     path ) { /* Room for 16 bytes */
+  ulong path_sz = 1UL + fd_rng_ulong_roll( rng, 16UL );
+  for( ulong b=0UL; b<path_sz-1UL; b++ ) {
+    char c = (char)( (uint)'a' + (fd_rng_uint( rng ) & 3U) );
+    if( c=='d' ) c = '.';
+    path[b] = c;
+  }
+  path[path_sz-1UL] = '\0';
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  FD_TEST( fd_pod_index_align()==FD_POD_INDEX_ALIGN );
+
+  FD_TEST( !fd_pod_index_footprint( 0UL                      ) );
+  FD_TEST( !fd_pod_index_footprint( FD_POD_INDEX_KEY_MAX+1UL ) );
+  for( ulong key_max=1UL; key_max<10000UL; key_max++ ) {
+    ulong footprint = fd_pod_index_footprint( key_max );
+    FD_TEST( fd_ulong_is_aligned( footprint, FD_POD_INDEX_ALIGN ) );
+    FD_TEST( footprint>=FD_POD_INDEX_ALIGN*(1UL+2UL*key_max) );
+  }
+  FD_TEST( fd_pod_index_footprint( KEY_MAX )<=sizeof(_index) );
+
+  FD_TEST( !fd_pod_index_new( NULL,     KEY_MAX ) ); /* NULL shmem */
+  FD_TEST( !fd_pod_index_new( _index+1, KEY_MAX ) ); /* misaligned */
+  FD_TEST( !fd_pod_index_new( _index,   0UL     ) ); /* bad key_max */
+
+  void *           shindex = fd_pod_index_new ( _index, KEY_MAX ); FD_TEST( shindex==(void *)_index );
+  fd_pod_index_t * index   = fd_pod_index_join( shindex );         FD_TEST( index );
+
+  FD_TEST( fd_pod_index_key_max( index )==KEY_MAX );
+  FD_TEST( fd_pod_index_key_cnt( index )==0UL     );
+  FD_TEST( fd_pod_index_gen    ( index )==0UL     );
+
+  uchar * pod = fd_pod_join( fd_pod_new( mem, POD_MAX ) ); FD_TEST( pod );
+
+  FD_TEST( fd_pod_index_is_stale( index, pod ) ); /* new index is stale for every pod */
+  FD_TEST( fd_pod_index_query( index, pod, "foo", NULL )==FD_POD_ERR_RESOLVE );
+
+  FD_TEST( fd_pod_index_query( NULL,  pod,  "foo", NULL )==FD_POD_ERR_INVAL );
+  FD_TEST( fd_pod_index_query( index, NULL, "foo", NULL )==FD_POD_ERR_INVAL );
+  FD_TEST( fd_pod_index_query( index, pod,  NULL,  NULL )==FD_POD_ERR_INVAL );
+
+  /* Build from an empty pod */
+
+  FD_TEST( fd_pod_index_build( index, pod )==index );
+  FD_TEST( fd_pod_index_key_cnt( index )==0UL );
+  FD_TEST( fd_pod_index_gen( index )==fd_pod_gen( pod ) );
+  FD_TEST( !fd_pod_index_is_stale( index, pod ) );
+  FD_TEST( fd_pod_index_query( index, pod, "", NULL )==FD_POD_ERR_RESOLVE );
+
+  for( ulong iter=0UL; iter<1000UL; iter++ ) {
+
+    /* Populate the pod with random keys of random types at random
+       depths (paths like "ab.c.a") */
+
+    fd_pod_reset( pod );
+    ulong ins_cnt = fd_rng_ulong_roll( rng, 200UL );
+    for( ulong ins=0UL; ins<ins_cnt; ins++ ) {
+      char path[16]; rand_path( rng, path );
+      switch( fd_rng_uint_roll( rng, 5U ) ) {
+      case 0U: fd_pod_insert_ulong ( pod, path, fd_rng_ulong( rng )                    ); break;
+      case 1U: fd_pod_insert_int   ( pod, path, (int)fd_rng_uint( rng )                ); break;
+      case 2U: fd_pod_insert_cstr  ( pod, path, fd_rng_uint_roll( rng, 4U ) ? path : NULL ); break;
+      case 3U: fd_pod_insert_float ( pod, path, fd_rng_float_c0( rng )                 ); break;
+      default: fd_pod_alloc_subpod ( pod, path, 64UL + fd_rng_ulong_roll( rng, 512UL ) ); break;
+      }
+    }
+
+    ulong cnt = fd_pod_cnt_recursive( pod );
+    FD_TEST( cnt<=KEY_MAX );
+
+    /* Refresh should rebuild (the pod changed).  Refreshing again
+       should be a no-op. */
+
+    ulong gen = fd_pod_gen( pod );
+    FD_TEST( gen );
+    FD_TEST( fd_pod_index_refresh( index, pod )==index );
+    FD_TEST( fd_pod_index_gen    ( index )==gen );
+    FD_TEST( fd_pod_index_key_cnt( index )==cnt );
+    FD_TEST( fd_pod_index_refresh( index, pod )==index );
+    FD_TEST( fd_pod_index_gen    ( index )==gen );
+
+    /* Every key in the pod should be found by its full path */
+
+    FD_TEST( fd_pod_list_recursive( pod, list )==list );
+    for( ulong idx=0UL; idx<cnt; idx++ ) {
+      char path[ 64 ];
+      path_of( list + idx, path );
+      check_query( index, pod, path );
+    }
+
+    /* As should random paths (mostly misses, including paths through
+       non-subpods) */
+
+    for( ulong rem=0UL; rem<100UL; rem++ ) {
+      char path[16]; rand_path( rng, path );
+      check_query( index, pod, path );
+    }
+
+    /* Typed queries */
+
+    for( ulong rem=0UL; rem<100UL; rem++ ) {
+      char path[16]; rand_path( rng, path );
+      FD_TEST( fd_pod_index_query_ulong ( index, pod, path, 1UL   )==fd_pod_query_ulong ( pod, path, 1UL   ) );
+      FD_TEST( fd_pod_index_query_int   ( index, pod, path, 2     )==fd_pod_query_int   ( pod, path, 2     ) );
+      FD_TEST( fd_pod_index_query_cstr  ( index, pod, path, "def" )==fd_pod_query_cstr  ( pod, path, "def" ) );
+      FD_TEST( fd_pod_index_query_float ( index, pod, path, 3.f   )==fd_pod_query_float ( pod, path, 3.f   ) );
+      FD_TEST( fd_pod_index_query_subpod( index, pod, path        )==fd_pod_query_subpod( pod, path        ) );
+      FD_TEST( fd_pod_index_query_buf   ( index, pod, path, NULL  )==fd_pod_query_buf   ( pod, path, NULL  ) );
+    }
+
+    /* The index should work with a copy of the pod (e.g. the pod
+       mapped at a different address in another process) */
+
+    memcpy( mem2, mem, fd_pod_used( pod ) );
+    uchar const * pod2 = mem2;
+    FD_TEST( !fd_pod_index_is_stale( index, pod2 ) );
+    for( ulong idx=0UL; idx<cnt; idx++ ) {
+      char path[ 64 ];
+      path_of( list + idx, path );
+      check_query( index, pod2, path );
+    }
+
+    /* Modifying the pod (even just a value in place) makes the index
+       stale */
+
+    if( cnt ) {
+      fd_pod_info_t const * info = list + fd_rng_ulong_roll( rng, cnt );
+      if( info->val_sz ) {
+        uchar * val = (uchar *)info->val;
+        val[0] = (uchar)(val[0] ^ 1);
+        FD_TEST( fd_pod_index_is_stale( index, pod ) );
+        val[0] = (uchar)(val[0] ^ 1);
+        FD_TEST( !fd_pod_index_is_stale( index, pod ) );
+      }
+      char path[ 64 ];
+      path_of( info, path );
+      FD_TEST( !fd_pod_remove( pod, path ) );
+      FD_TEST( fd_pod_index_is_stale( index, pod ) );
+    }
+  }
+
+  /* Build with too many keys fails and leaves the index empty */
+
+  do {
+    fd_pod_reset( pod );
+    for( ulong idx=0UL; idx<KEY_MAX+1UL; idx++ ) {
+      char path[32];
+      FD_TEST( fd_cstr_printf( path, 32UL, NULL, "k%lu", idx ) );
+      FD_TEST( fd_pod_insert_uchar( pod, path, (uchar)idx ) );
+    }
+    FD_TEST( !fd_pod_index_build( index, pod ) );
+    FD_TEST( fd_pod_index_key_cnt( index )==0UL );
+    FD_TEST( fd_pod_index_gen    ( index )==0UL );
+    FD_TEST( fd_pod_index_is_stale( index, pod ) );
+    FD_TEST( fd_pod_index_query( index, pod, "k0", NULL )==FD_POD_ERR_RESOLVE );
+    FD_TEST( !fd_pod_index_refresh( index, pod ) );
+    FD_TEST( !fd_pod_index_build  ( index, NULL ) );
+    FD_TEST( !fd_pod_index_refresh( index, NULL ) );
+
+    FD_TEST( !fd_pod_remove( pod, "k0" ) );
+    FD_TEST( fd_pod_index_refresh( index, pod )==index );
+    FD_TEST( fd_pod_index_key_cnt( index )==KEY_MAX );
+    FD_TEST( fd_pod_index_query_uchar( index, pod, "k1",    (uchar)0 )==(uchar)1   );
+    FD_TEST( fd_pod_index_query_uchar( index, pod, "k1000", (uchar)0 )==(uchar)232 );
+    FD_TEST( fd_pod_index_query_uchar( index, pod, "k0",    (uchar)7 )==(uchar)7   );
+  } while(0);
+
+  FD_TEST( !fd_pod_index_join( NULL     ) ); /* NULL shindex */
+  FD_TEST( !fd_pod_index_join( _index+1 ) ); /* misaligned */
+
+  FD_TEST( !fd_pod_index_leave( NULL ) );
+
+  FD_TEST( !fd_pod_index_delete( NULL     ) ); /* NULL shindex */
+  FD_TEST( !fd_pod_index_delete( _index+1 ) ); /* misaligned */
+
+  FD_TEST( fd_pod_index_leave ( index   )==shindex         );
+  FD_TEST( fd_pod_index_delete( shindex )==(void *)_index  );
+
+  FD_TEST( !fd_pod_index_join  ( shindex ) ); /* bad magic */
+  FD_TEST( !fd_pod_index_delete( shindex ) ); /* bad magic */
+
+  fd_pod_delete( fd_pod_leave( pod ) );
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
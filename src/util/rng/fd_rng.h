@@ -445,6 +445,33 @@ double fd_rng_double_exp   ( fd_rng_t * rng );
 double fd_rng_double_norm  ( fd_rng_t * rng );
 #endif
 
+/* fd_rng_fill_{uint,ulong,float,double} fill out[i] for i in [0,cnt)
+   with the values that would be produced by cnt sequential calls to
+   fd_rng_{uint,ulong,float_c0,double_c0} respectively (bit level
+   identical, including rng's idx on return).  That is, these are bulk
+   versions of the basic generators and consume 1 (uint and float) or 2
+   (ulong and double) slots per value.  Since the slots of a batch can
+   be hashed independently, on targets with AVX, these generate 4 or 8
+   values at a time.  cnt 0 is fine.
+
+   fd_rng_fill_{float,double}_{exp,norm} are the same for the exp and
+   norm distributions.  The slot hashing is vectorized (the
+   transcendental parts are not, as these need to match the scalar
+   generators bit for bit).  Like their scalar counterparts, the norm
+   variants consume a variable number of slots. */
+
+void fd_rng_fill_uint      ( fd_rng_t * rng, uint  * out, ulong cnt );
+void fd_rng_fill_ulong     ( fd_rng_t * rng, ulong * out, ulong cnt );
+void fd_rng_fill_float     ( fd_rng_t * rng, float * out, ulong cnt );
+void fd_rng_fill_float_exp ( fd_rng_t * rng, float * out, ulong cnt );
+void fd_rng_fill_float_norm( fd_rng_t * rng, float * out, ulong cnt );
+
+#if FD_HAS_DOUBLE
+void fd_rng_fill_double     ( fd_rng_t * rng, double * out, ulong cnt );
+void fd_rng_fill_double_exp ( fd_rng_t * rng, double * out, ulong cnt );
+void fd_rng_fill_double_norm( fd_rng_t * rng, double * out, ulong cnt );
+#endif
+
 /* FIXME: IMPORT ATOMIC VARIANTS FOR REENTRANT USAGE (E.G. ATOMIC_XCHG
    FOR SET, ATOMIC_INC OF INDEX FOR THE RETURN TYPES, CAS STATE UPDATES,
    ETC) */
@@ -233,6 +233,89 @@ main( int     argc,
 
   FD_TEST( domain==fd_ulong_mask_lsb(50) );
 
+  FD_LOG_NOTICE(( "Testing fill" ));
+
+  do {
+#   define FILL_MAX (300UL)
+    static uint   u0[ FILL_MAX ]; static uint   u1[ FILL_MAX ];
+    static ulong  l0[ FILL_MAX ]; static ulong  l1[ FILL_MAX ];
+    static float  f0[ FILL_MAX ]; static float  f1[ FILL_MAX ];
+#   if FD_HAS_DOUBLE
+    static double d0[ FILL_MAX ]; static double d1[ FILL_MAX ];
+#   endif
+
+    fd_rng_t _ref[1]; fd_rng_t * ref = fd_rng_join( fd_rng_new( _ref, 0U, 0UL ) );
+
+    /* Fills should match the scalar generators bit for bit (memcmp so
+       that -0 / NaN differences would be caught) and leave the rng at
+       the same slot */
+
+#   define TEST_FILL(fill,scalar,a,b) do {                                            \
+      uint  seq = fd_rng_uint ( rng );                                                \
+      ulong idx = fd_rng_ulong( rng );                                                \
+      ulong cnt = fd_rng_ulong_roll( rng, FILL_MAX+1UL );                             \
+      fd_rng_seq_set( ref, seq ); fd_rng_idx_set( ref, idx );                         \
+      for( ulong i=0UL; i<cnt; i++ ) a[i] = scalar( ref );                            \
+      fd_rng_t _tst[1]; fd_rng_t * tst = fd_rng_join( fd_rng_new( _tst, seq, idx ) ); \
+      fill( tst, b, cnt );                                                            \
+      FD_TEST( !memcmp( a, b, cnt*sizeof(a[0]) ) );                                   \
+      FD_TEST( fd_rng_idx( tst )==fd_rng_idx( ref ) );                                \
+      fd_rng_delete( fd_rng_leave( tst ) );                                           \
+    } while(0)
+
+    for( ulong iter=0UL; iter<10000UL; iter++ ) {
+      TEST_FILL( fd_rng_fill_uint,        fd_rng_uint,        u0, u1 );
+      TEST_FILL( fd_rng_fill_ulong,       fd_rng_ulong,       l0, l1 );
+      TEST_FILL( fd_rng_fill_float,       fd_rng_float_c0,    f0, f1 );
+      TEST_FILL( fd_rng_fill_float_exp,   fd_rng_float_exp,   f0, f1 );
+      TEST_FILL( fd_rng_fill_float_norm,  fd_rng_float_norm,  f0, f1 );
+#     if FD_HAS_DOUBLE
+      TEST_FILL( fd_rng_fill_double,      fd_rng_double_c0,   d0, d1 );
+      TEST_FILL( fd_rng_fill_double_exp,  fd_rng_double_exp,  d0, d1 );
+      TEST_FILL( fd_rng_fill_double_norm, fd_rng_double_norm, d0, d1 );
+#     endif
+    }
+
+#   undef TEST_FILL
+
+    /* Bench fills against the scalar generators */
+
+#   define BENCH_FILL(fill,scalar,a) do {                                                                 \
+      ulong iter_cnt = 1UL<<16;                                                                           \
+      long  dt_scalar = -fd_log_wallclock();                                                              \
+      for( ulong iter=0UL; iter<iter_cnt; iter++ ) {                                                      \
+        for( ulong i=0UL; i<FILL_MAX; i++ ) a[i] = scalar( rng );                                         \
+        FD_COMPILER_MFENCE();                                                                             \
+      }                                                                                                   \
+      dt_scalar += fd_log_wallclock();                                                                    \
+      long  dt_fill = -fd_log_wallclock();                                                                \
+      for( ulong iter=0UL; iter<iter_cnt; iter++ ) {                                                      \
+        fill( rng, a, FILL_MAX );                                                                         \
+        FD_COMPILER_MFENCE();                                                                             \
+      }                                                                                                   \
+      dt_fill += fd_log_wallclock();                                                                      \
+      double norm = 1. / (double)(iter_cnt*FILL_MAX);                                                     \
+      FD_LOG_NOTICE(( "%-24s %6.2f ns/val (%-18s %6.2f ns/val)", #fill, norm*(double)dt_fill,             \
+                      #scalar, norm*(double)dt_scalar ));                                                 \
+    } while(0)
+
+    BENCH_FILL( fd_rng_fill_uint,        fd_rng_uint,        u0 );
+    BENCH_FILL( fd_rng_fill_ulong,       fd_rng_ulong,       l0 );
+    BENCH_FILL( fd_rng_fill_float,       fd_rng_float_c0,    f0 );
+    BENCH_FILL( fd_rng_fill_float_exp,   fd_rng_float_exp,   f0 );
+    BENCH_FILL( fd_rng_fill_float_norm,  fd_rng_float_norm,  f0 );
+#   if FD_HAS_DOUBLE
+    BENCH_FILL( fd_rng_fill_double,      fd_rng_double_c0,   d0 );
+    BENCH_FILL( fd_rng_fill_double_exp,  fd_rng_double_exp,  d0 );
+    BENCH_FILL( fd_rng_fill_double_norm, fd_rng_double_norm, d0 );
+#   endif
+
+#   undef BENCH_FILL
+#   undef FILL_MAX
+
+    fd_rng_delete( fd_rng_leave( ref ) );
+  } while(0);
+
   FD_LOG_NOTICE(( "Testing seed expansion" ));
 
   long sum_pop  = 0L;
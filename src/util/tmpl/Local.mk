@@ -1,10 +1,14 @@
-$(call add-hdrs,fd_smallset.c fd_set.c fd_set_dynamic.c fd_sort.c fd_map.c fd_map_dynamic.c fd_prq.c fd_stack.c fd_queue.c fd_queue_dynamic.c fd_deque.c fd_deque_dynamic.c fd_voff.c)
+$(call add-hdrs,fd_smallset.c fd_set.c fd_set_dynamic.c fd_sort.c fd_map.c fd_map_dynamic.c fd_map_simd.c fd_map_para.c fd_prq.c fd_stack.c fd_queue.c fd_queue_dynamic.c fd_deque.c fd_deque_dynamic.c fd_voff.c fd_twheel.c)
 $(call make-unit-test,test_smallset,test_smallset,fd_util)
 $(call make-unit-test,test_set,test_set,fd_util)
 $(call make-unit-test,test_set_dynamic,test_set_dynamic,fd_util)
 $(call make-unit-test,test_sort,test_sort,fd_util)
+$(call make-unit-test,bench_sort,bench_sort,fd_util)
 $(call make-unit-test,test_map,test_map,fd_util)
 $(call make-unit-test,test_map_dynamic,test_map_dynamic,fd_util)
+$(call make-unit-test,test_map_simd,test_map_simd,fd_util)
+$(call make-unit-test,bench_map_simd,bench_map_simd,fd_util)
+$(call make-unit-test,test_map_para,test_map_para,fd_util)
 $(call make-unit-test,test_prq,test_prq,fd_util)
 $(call make-unit-test,test_stack,test_stack,fd_util)
 $(call make-unit-test,test_queue,test_queue,fd_util)
@@ -12,12 +16,16 @@ $(call make-unit-test,test_queue_dynamic,test_queue_dynamic,fd_util)
 $(call make-unit-test,test_deque,test_deque,fd_util)
 $(call make-unit-test,test_deque_dynamic,test_deque_dynamic,fd_util)
 $(call make-unit-test,test_voff,test_voff,fd_util)
+$(call make-unit-test,test_twheel,test_twheel,fd_util)
+$(call make-unit-test,bench_twheel,bench_twheel,fd_util)
 $(call run-unit-test,test_smallset,)
 $(call run-unit-test,test_set,)
 $(call run-unit-test,test_set_dynamic,)
 $(call run-unit-test,test_sort,)
 $(call run-unit-test,test_map,)
 $(call run-unit-test,test_map_dynamic,)
+$(call run-unit-test,test_map_simd,)
+$(call run-unit-test,test_map_para,)
 $(call run-unit-test,test_prq,)
 $(call run-unit-test,test_stack,)
 $(call run-unit-test,test_queue,)
@@ -25,4 +33,4 @@ $(call run-unit-test,test_queue_dynamic,)
 $(call run-unit-test,test_deque,)
 $(call run-unit-test,test_deque_dynamic,)
 $(call run-unit-test,test_voff,)
-
+$(call run-unit-test,test_twheel,)
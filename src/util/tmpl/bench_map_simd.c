@@ -0,0 +1,148 @@
+#include "../fd_util.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+/* bench_map_simd compares fd_map_simd against fd_map_dynamic with the
+   same element type and number of slots filled to the same --fill
+   ratio (fd_map_dynamic can go all the way to 1 slot empty but is
+   usually not run beyond 1/2 full).  It times successful queries,
+   unsuccessful queries and remove / insert pairs. */
+
+struct elem {
+  ulong key;
+  uint  hash;
+  uint  val;
+};
+
+typedef struct elem elem_t;
+
+#define MAP_NAME dmap
+#define MAP_T    elem_t
+#include "fd_map_dynamic.c"
+
+#define MAP_NAME smap
+#define MAP_T    elem_t
+#include "fd_map_simd.c"
+
+/* BENCH declares a function that benches the map type with the given
+   prefix.  key holds key_cnt unique keys (the first fill_cnt of which
+   are inserted) followed by key_cnt keys that are never inserted. */
+
+#define BENCH(M)                                                                                           \
+static void                                                                                                \
+bench_##M( fd_wksp_t *   wksp,                                                                             \
+           int           lg_slot_cnt,                                                                      \
+           ulong         fill_cnt,                                                                         \
+           ulong const * key,                                                                              \
+           ulong const * idx,                                                                              \
+           ulong         iter_cnt ) {                                                                      \
+  void * mem = fd_wksp_alloc_laddr( wksp, M##_align(), M##_footprint( lg_slot_cnt ), 1UL );                \
+  if( FD_UNLIKELY( !mem ) ) FD_LOG_ERR(( "fd_wksp_alloc_laddr failed" ));                                  \
+  elem_t * map = M##_join( M##_new( mem, lg_slot_cnt ) );                                                  \
+                                                                                                           \
+  long dt = -fd_log_wallclock();                                                                           \
+  for( ulong i=0UL; i<fill_cnt; i++ ) M##_insert( map, key[i] )->val = (uint)i;                            \
+  dt += fd_log_wallclock();                                                                                \
+  FD_TEST( M##_key_cnt( map )==fill_cnt );                                                                 \
+  double ns_fill = (double)dt / (double)fill_cnt;                                                          \
+                                                                                                           \
+  ulong sum = 0UL;                                                                                         \
+  dt = -fd_log_wallclock();                                                                                \
+  for( ulong i=0UL; i<iter_cnt; i++ ) sum += M##_query( map, key[ idx[i] ], NULL )->val;                   \
+  dt += fd_log_wallclock();                                                                                \
+  double ns_hit = (double)dt / (double)iter_cnt;                                                           \
+                                                                                                           \
+  ulong miss = 0UL;                                                                                        \
+  dt = -fd_log_wallclock();                                                                                \
+  for( ulong i=0UL; i<iter_cnt; i++ ) miss += (ulong)!M##_query( map, key[ fill_cnt+idx[i] ], NULL );      \
+  dt += fd_log_wallclock();                                                                                \
+  FD_TEST( miss==iter_cnt );                                                                               \
+  double ns_miss = (double)dt / (double)iter_cnt;                                                          \
+                                                                                                           \
+  dt = -fd_log_wallclock();                                                                                \
+  for( ulong i=0UL; i<iter_cnt; i++ ) {                                                                    \
+    ulong j = idx[i];                                                                                      \
+    M##_remove( map, M##_query( map, key[j], NULL ) );                                                     \
+    M##_insert( map, key[j] )->val = (uint)j;                                                              \
+  }                                                                                                        \
+  dt += fd_log_wallclock();                                                                                \
+  FD_TEST( M##_key_cnt( map )==fill_cnt );                                                                 \
+  double ns_churn = (double)dt / (double)iter_cnt;                                                         \
+                                                                                                           \
+  FD_LOG_NOTICE(( "%-5s insert %6.1f ns  query hit %6.1f ns  query miss %6.1f ns  remove+insert %6.1f ns " \
+                  "(footprint %lu, sum %lu)", #M, ns_fill, ns_hit, ns_miss, ns_churn,                      \
+                  M##_footprint( lg_slot_cnt ), sum ));                                                    \
+                                                                                                           \
+  fd_wksp_free_laddr( M##_delete( M##_leave( map ) ) );                                                    \
+}
+
+BENCH(dmap)
+BENCH(smap)
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz    = fd_env_strip_cmdline_cstr  ( &argc, &argv, "--page-sz",     NULL,         "normal" );
+  int          lg_slot_cnt = fd_env_strip_cmdline_int   ( &argc, &argv, "--lg-slot-cnt", NULL,               20 );
+  double       fill        = fd_env_strip_cmdline_double( &argc, &argv, "--fill",        NULL,            0.875 );
+  ulong        iter_cnt    = fd_env_strip_cmdline_ulong ( &argc, &argv, "--iter-cnt",    NULL,        1000000UL );
+  ulong        near_cpu    = fd_env_strip_cmdline_ulong ( &argc, &argv, "--near-cpu",    NULL,   fd_log_cpu_id() );
+
+  ulong page_sz = fd_cstr_to_shmem_page_sz( _page_sz );
+  if( FD_UNLIKELY( !page_sz ) ) FD_LOG_ERR(( "unsupported --page-sz" ));
+  if( FD_UNLIKELY( !((4<=lg_slot_cnt) & (lg_slot_cnt<=30)) ) ) FD_LOG_ERR(( "--lg-slot-cnt should be in [4,30]" ));
+  if( FD_UNLIKELY( !iter_cnt ) ) FD_LOG_ERR(( "--iter-cnt should be positive" ));
+
+  ulong slot_cnt = 1UL << lg_slot_cnt;
+  ulong fill_cnt = (ulong)(fill*(double)slot_cnt);
+  ulong key_max  = slot_cnt - slot_cnt/8UL;
+  if( FD_UNLIKELY( !((1UL<=fill_cnt) & (fill_cnt<=key_max)) ) ) FD_LOG_ERR(( "--fill should be in (0,0.875]" ));
+
+  FD_LOG_NOTICE(( "Benching --lg-slot-cnt %i --fill %.3f (%lu keys) --iter-cnt %lu", lg_slot_cnt, fill, fill_cnt, iter_cnt ));
+
+  ulong wksp_sz  = 2UL*fd_ulong_max( dmap_footprint( lg_slot_cnt ), smap_footprint( lg_slot_cnt ) )
+                 + 2UL*fill_cnt*sizeof(ulong) + iter_cnt*sizeof(ulong) + (4UL<<20);
+  ulong page_cnt = (wksp_sz + page_sz - 1UL) / page_sz;
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( page_sz, page_cnt, near_cpu, "bench_map_simd", 0UL );
+  if( FD_UNLIKELY( !wksp ) ) FD_LOG_ERR(( "fd_wksp_new_anonymous failed" ));
+
+  ulong * key = (ulong *)fd_wksp_alloc_laddr( wksp, alignof(ulong), 2UL*fill_cnt*sizeof(ulong), 1UL );
+  ulong * idx = (ulong *)fd_wksp_alloc_laddr( wksp, alignof(ulong), iter_cnt   *sizeof(ulong), 1UL );
+  if( FD_UNLIKELY( (!key) | (!idx) ) ) FD_LOG_ERR(( "fd_wksp_alloc_laddr failed" ));
+
+  /* Unique non-zero keys (fd_ulong_hash is a permutation) and a random
+     access pattern */
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+  ulong seed = fd_rng_ulong( rng ) | 1UL;
+  for( ulong i=0UL; i<2UL*fill_cnt; i++ ) key[i] = fd_ulong_hash( seed + i );
+  for( ulong i=0UL; i<2UL*fill_cnt; i++ ) if( FD_UNLIKELY( !key[i] ) ) FD_LOG_ERR(( "zero key, try a different seed" ));
+  for( ulong i=0UL; i<iter_cnt;     i++ ) idx[i] = fd_rng_ulong_roll( rng, fill_cnt );
+
+  bench_dmap( wksp, lg_slot_cnt, fill_cnt, key, idx, iter_cnt );
+  bench_smap( wksp, lg_slot_cnt, fill_cnt, key, idx, iter_cnt );
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+  fd_wksp_free_laddr( idx );
+  fd_wksp_free_laddr( key );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
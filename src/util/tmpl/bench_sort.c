@@ -0,0 +1,155 @@
+#include "../fd_util.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+/* bench_sort compares the fd_sort strategies for random ulong and
+   double keys for cnt from 1e3 to --cnt-max by factors of 10:
+
+     insert  - insertion sort (only for cnt up to --insert-max)
+     stable  - merge sort
+     inplace - quick sort with insertion sort for small partitions
+     network - quick sort with sorting networks for small partitions
+     radix   - LSD radix sort
+
+   Each strategy is run on a fresh copy of the same keys (repeated for
+   small cnt to get stable timings, with the time to make the copies
+   subtracted) and the results are validated against each other. */
+
+#define SORT_NAME         sort_ulong
+#define SORT_KEY_T        ulong
+#define SORT_BEFORE(a,b)  ((a)<(b))
+#include "fd_sort.c"
+
+#define SORT_NAME         sort_ulong_net
+#define SORT_KEY_T        ulong
+#define SORT_BEFORE(a,b)  ((a)<(b))
+#define SORT_NETWORK      2
+#define SORT_RADIX_KEY(k) fd_sort_radix_key_ulong( (k) )
+#include "fd_sort.c"
+
+#define SORT_NAME         sort_double
+#define SORT_KEY_T        double
+#define SORT_BEFORE(a,b)  ((a)<(b))
+#include "fd_sort.c"
+
+#define SORT_NAME         sort_double_net
+#define SORT_KEY_T        double
+#define SORT_BEFORE(a,b)  ((a)<(b))
+#define SORT_NETWORK      3
+#define SORT_RADIX_KEY(k) fd_sort_radix_key_double( (k) )
+#include "fd_sort.c"
+
+/* BENCH declares a function that benches the strategies for keys of
+   type T.  src holds the cnt keys to sort, key and tmp are scratch
+   regions of cnt keys and ref receives the sorted keys. */
+
+#define BENCH(T)                                                                                     \
+static void                                                                                          \
+bench_##T( T const * src,                                                                            \
+           T *       key,                                                                            \
+           T *       tmp,                                                                            \
+           T *       ref,                                                                            \
+           ulong     cnt,                                                                            \
+           ulong     insert_max ) {                                                                  \
+  ulong rep = fd_ulong_max( 10000000UL / cnt, 1UL );                                                 \
+                                                                                                     \
+  long dt_copy = -fd_log_wallclock();                                                                \
+  for( ulong r=0UL; r<rep; r++ ) { memcpy( key, src, cnt*sizeof(T) ); FD_COMPILER_MFENCE(); }        \
+  dt_copy += fd_log_wallclock();                                                                     \
+                                                                                                     \
+  memcpy( ref, src, cnt*sizeof(T) );                                                                 \
+  sort_##T##_stable( ref, cnt, tmp );                                                                \
+                                                                                                     \
+  static char const * name[5] = { "insert", "stable", "inplace", "network", "radix" };               \
+  double ns[5];                                                                                      \
+  for( int s=0; s<5; s++ ) {                                                                         \
+    if( (s==0) & (cnt>insert_max) ) { ns[s] = 0.; continue; }                                        \
+    T * out = key;                                                                                   \
+    long dt = -fd_log_wallclock();                                                                   \
+    for( ulong r=0UL; r<rep; r++ ) {                                                                 \
+      memcpy( key, src, cnt*sizeof(T) );                                                             \
+      switch( s ) {                                                                                  \
+      case 0: out = sort_##T##_insert         ( key, cnt      ); break;                              \
+      case 1: out = sort_##T##_stable_fast    ( key, cnt, tmp ); break;                              \
+      case 2: out = sort_##T##_inplace        ( key, cnt      ); break;                              \
+      case 3: out = sort_##T##_net_inplace    ( key, cnt      ); break;                              \
+      default: out = sort_##T##_net_radix_fast( key, cnt, tmp ); break;                              \
+      }                                                                                              \
+      FD_COMPILER_MFENCE();                                                                          \
+    }                                                                                                \
+    dt += fd_log_wallclock();                                                                        \
+    if( FD_UNLIKELY( memcmp( out, ref, cnt*sizeof(T) ) ) ) FD_LOG_ERR(( "%s: mismatch", name[s] ));  \
+    ns[s] = (double)(dt-dt_copy) / (double)(rep*cnt);                                                \
+  }                                                                                                  \
+                                                                                                     \
+  FD_LOG_NOTICE(( "%-6s cnt %9lu  insert %7.2f  stable %7.2f  inplace %7.2f  network %7.2f  "        \
+                  "radix %7.2f ns/key", #T, cnt, ns[0], ns[1], ns[2], ns[3], ns[4] ));               \
+}
+
+BENCH(ulong)
+BENCH(double)
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz   = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",    NULL,        "normal" );
+  ulong        cnt_max    = fd_env_strip_cmdline_ulong( &argc, &argv, "--cnt-max",    NULL,    100000000UL );
+  ulong        insert_max = fd_env_strip_cmdline_ulong( &argc, &argv, "--insert-max", NULL,         1000UL );
+  ulong        near_cpu   = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu",   NULL, fd_log_cpu_id() );
+
+  ulong page_sz = fd_cstr_to_shmem_page_sz( _page_sz );
+  if( FD_UNLIKELY( !page_sz ) ) FD_LOG_ERR(( "unsupported --page-sz" ));
+  if( FD_UNLIKELY( cnt_max<1000UL ) ) FD_LOG_ERR(( "--cnt-max should be at least 1000" ));
+
+  FD_LOG_NOTICE(( "Benching --cnt-max %lu --insert-max %lu", cnt_max, insert_max ));
+
+  ulong sz       = cnt_max*sizeof(ulong); /* sizeof(double)==sizeof(ulong) */
+  ulong page_cnt = (4UL*sz + (4UL<<20) + page_sz - 1UL) / page_sz;
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( page_sz, page_cnt, near_cpu, "bench_sort", 0UL );
+  if( FD_UNLIKELY( !wksp ) ) FD_LOG_ERR(( "fd_wksp_new_anonymous failed" ));
+
+  ulong * src = (ulong *)fd_wksp_alloc_laddr( wksp, 128UL, sz, 1UL );
+  ulong * key = (ulong *)fd_wksp_alloc_laddr( wksp, 128UL, sz, 1UL );
+  ulong * tmp = (ulong *)fd_wksp_alloc_laddr( wksp, 128UL, sz, 1UL );
+  ulong * ref = (ulong *)fd_wksp_alloc_laddr( wksp, 128UL, sz, 1UL );
+  if( FD_UNLIKELY( (!src) | (!key) | (!tmp) | (!ref) ) ) FD_LOG_ERR(( "fd_wksp_alloc_laddr failed" ));
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  for( ulong cnt=1000UL; cnt<=cnt_max; cnt*=10UL ) {
+    for( ulong i=0UL; i<cnt; i++ ) src[i] = fd_rng_ulong( rng );
+    bench_ulong( src, key, tmp, ref, cnt, insert_max );
+
+    double * dsrc = (double *)src;
+    for( ulong i=0UL; i<cnt; i++ ) dsrc[i] = fd_rng_double_norm( rng );
+    bench_double( dsrc, (double *)key, (double *)tmp, (double *)ref, cnt, insert_max );
+
+    if( cnt>cnt_max/10UL ) break;
+  }
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+  fd_wksp_free_laddr( ref );
+  fd_wksp_free_laddr( tmp );
+  fd_wksp_free_laddr( key );
+  fd_wksp_free_laddr( src );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
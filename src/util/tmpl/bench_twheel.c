@@ -0,0 +1,185 @@
+#include "../fd_util.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+/* bench_twheel compares fd_twheel against fd_prq for a typical timeout
+   workload: --timer-cnt timers are scheduled uniformly over the next
+   --horizon time units, a random --cancel-frac of them are canceled
+   (e.g. transactions that landed or connections that saw activity) and
+   then time is advanced in --step increments until all remaining
+   timers have expired.  fd_prq can't remove an event by handle, so
+   canceling is done lazily (the canceled timer's generation is bumped
+   and stale events are discarded as they reach the top of the heap). */
+
+struct tmr {
+  ulong prev;
+  ulong next;
+  ulong expire;
+  ulong gen;
+};
+
+typedef struct tmr tmr_t;
+
+#define TWHEEL_NAME wheel
+#define TWHEEL_T    tmr_t
+#include "fd_twheel.c"
+
+struct event {
+  long  timeout;
+  ulong idx;
+  ulong gen;
+  ulong pad;
+};
+
+typedef struct event event_t;
+
+#define PRQ_NAME eventq
+#define PRQ_T    event_t
+#include "fd_prq.c"
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz    = fd_env_strip_cmdline_cstr  ( &argc, &argv, "--page-sz",     NULL,         "normal" );
+  ulong        timer_cnt   = fd_env_strip_cmdline_ulong ( &argc, &argv, "--timer-cnt",   NULL,        1000000UL );
+  ulong        horizon     = fd_env_strip_cmdline_ulong ( &argc, &argv, "--horizon",     NULL,          1UL<<24 );
+  ulong        step        = fd_env_strip_cmdline_ulong ( &argc, &argv, "--step",        NULL,          1UL<<10 );
+  double       cancel_frac = fd_env_strip_cmdline_double( &argc, &argv, "--cancel-frac", NULL,              0.5 );
+  ulong        near_cpu    = fd_env_strip_cmdline_ulong ( &argc, &argv, "--near-cpu",    NULL,  fd_log_cpu_id() );
+
+  ulong page_sz = fd_cstr_to_shmem_page_sz( _page_sz );
+  if( FD_UNLIKELY( !page_sz ) ) FD_LOG_ERR(( "unsupported --page-sz" ));
+  if( FD_UNLIKELY( !timer_cnt ) ) FD_LOG_ERR(( "--timer-cnt should be positive" ));
+  if( FD_UNLIKELY( !((1UL<=horizon) & (horizon<=(1UL<<62))) ) ) FD_LOG_ERR(( "--horizon should be in [1,2^62]" ));
+  if( FD_UNLIKELY( !step ) ) FD_LOG_ERR(( "--step should be positive" ));
+  if( FD_UNLIKELY( !((0.<=cancel_frac) & (cancel_frac<=1.)) ) ) FD_LOG_ERR(( "--cancel-frac should be in [0,1]" ));
+
+  ulong cancel_cnt = (ulong)(cancel_frac*(double)timer_cnt);
+
+  FD_LOG_NOTICE(( "Benching --timer-cnt %lu --horizon %lu --step %lu --cancel-frac %.3f (%lu cancels)",
+                  timer_cnt, horizon, step, cancel_frac, cancel_cnt ));
+
+  ulong wksp_sz  = wheel_footprint() + eventq_footprint( timer_cnt )
+                 + timer_cnt*(sizeof(tmr_t) + 2UL*sizeof(ulong)) + (4UL<<20);
+  ulong page_cnt = (wksp_sz + page_sz - 1UL) / page_sz;
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( page_sz, page_cnt, near_cpu, "bench_twheel", 0UL );
+  if( FD_UNLIKELY( !wksp ) ) FD_LOG_ERR(( "fd_wksp_new_anonymous failed" ));
+
+  tmr_t * pool   = (tmr_t *)fd_wksp_alloc_laddr( wksp, alignof(tmr_t),  timer_cnt*sizeof(tmr_t),      1UL );
+  ulong * expire = (ulong *)fd_wksp_alloc_laddr( wksp, alignof(ulong),  timer_cnt*sizeof(ulong),      1UL );
+  ulong * cancel = (ulong *)fd_wksp_alloc_laddr( wksp, alignof(ulong),  timer_cnt*sizeof(ulong),      1UL );
+  void *  wmem   =          fd_wksp_alloc_laddr( wksp, wheel_align(),   wheel_footprint(),            1UL );
+  void *  qmem   =          fd_wksp_alloc_laddr( wksp, eventq_align(),  eventq_footprint( timer_cnt ), 1UL );
+  if( FD_UNLIKELY( (!pool) | (!expire) | (!cancel) | (!wmem) | (!qmem) ) ) FD_LOG_ERR(( "fd_wksp_alloc_laddr failed" ));
+
+  /* Random expirations in [1,horizon] and a random subset of timers to
+     cancel (the first cancel_cnt of a random permutation) */
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+  for( ulong i=0UL; i<timer_cnt; i++ ) expire[i] = 1UL + fd_rng_ulong_roll( rng, horizon );
+  for( ulong i=0UL; i<timer_cnt; i++ ) {
+    ulong j = fd_rng_ulong_roll( rng, i+1UL );
+    cancel[i] = cancel[j];
+    cancel[j] = i;
+  }
+
+  ulong end = horizon + step; /* All timers expired by end */
+
+  /* Bench the timer wheel */
+
+  ulong wheel_exp_cnt = 0UL;
+  double wheel_ns[3];
+  do {
+    wheel_t * wheel = wheel_join( wheel_new( wmem, 0UL ) );
+
+    long dt = -fd_log_wallclock();
+    for( ulong i=0UL; i<timer_cnt; i++ ) wheel_schedule( wheel, pool, i, expire[i] );
+    dt += fd_log_wallclock();
+    wheel_ns[0] = (double)dt / (double)timer_cnt;
+
+    dt = -fd_log_wallclock();
+    for( ulong i=0UL; i<cancel_cnt; i++ ) wheel_cancel( wheel, pool, cancel[i] );
+    dt += fd_log_wallclock();
+    wheel_ns[1] = (double)dt / (double)fd_ulong_max( cancel_cnt, 1UL );
+
+    dt = -fd_log_wallclock();
+    for( ulong now=step; now<=end; now+=step )
+      for( ulong idx=wheel_advance( wheel, pool, now ); idx!=ULONG_MAX; idx=pool[ idx ].next ) wheel_exp_cnt++;
+    dt += fd_log_wallclock();
+    wheel_ns[2] = (double)dt / (double)fd_ulong_max( timer_cnt-cancel_cnt, 1UL );
+
+    FD_TEST( !wheel_cnt( wheel ) );
+    wheel_delete( wheel_leave( wheel ) );
+  } while(0);
+
+  /* Bench the priority queue */
+
+  ulong prq_exp_cnt = 0UL;
+  double prq_ns[3];
+  do {
+    event_t * heap = eventq_join( eventq_new( qmem, timer_cnt ) );
+    for( ulong i=0UL; i<timer_cnt; i++ ) pool[i].gen = 0UL;
+
+    long dt = -fd_log_wallclock();
+    for( ulong i=0UL; i<timer_cnt; i++ ) {
+      event_t ev[1];
+      ev->timeout = (long)expire[i];
+      ev->idx     = i;
+      ev->gen     = pool[i].gen;
+      ev->pad     = 0UL;
+      eventq_insert( heap, ev );
+    }
+    dt += fd_log_wallclock();
+    prq_ns[0] = (double)dt / (double)timer_cnt;
+
+    dt = -fd_log_wallclock();
+    for( ulong i=0UL; i<cancel_cnt; i++ ) pool[ cancel[i] ].gen++;
+    dt += fd_log_wallclock();
+    prq_ns[1] = (double)dt / (double)fd_ulong_max( cancel_cnt, 1UL );
+
+    dt = -fd_log_wallclock();
+    for( ulong now=step; now<=end; now+=step )
+      while( eventq_cnt( heap ) && heap[0].timeout<=(long)now ) {
+        prq_exp_cnt += (ulong)(heap[0].gen==pool[ heap[0].idx ].gen);
+        eventq_remove_min( heap );
+      }
+    dt += fd_log_wallclock();
+    prq_ns[2] = (double)dt / (double)fd_ulong_max( timer_cnt-cancel_cnt, 1UL );
+
+    FD_TEST( !eventq_cnt( heap ) );
+    eventq_delete( eventq_leave( heap ) );
+  } while(0);
+
+  FD_TEST( wheel_exp_cnt==timer_cnt-cancel_cnt );
+  FD_TEST( prq_exp_cnt  ==timer_cnt-cancel_cnt );
+
+  FD_LOG_NOTICE(( "twheel schedule %6.1f ns  cancel %6.1f ns  expire %6.1f ns", wheel_ns[0], wheel_ns[1], wheel_ns[2] ));
+  FD_LOG_NOTICE(( "prq    schedule %6.1f ns  cancel %6.1f ns  expire %6.1f ns (lazy cancel)", prq_ns[0], prq_ns[1], prq_ns[2] ));
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+  fd_wksp_free_laddr( qmem   );
+  fd_wksp_free_laddr( wmem   );
+  fd_wksp_free_laddr( cancel );
+  fd_wksp_free_laddr( expire );
+  fd_wksp_free_laddr( pool   );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
@@ -0,0 +1,517 @@
+/* Declare ultra high performance dynamic key-val maps of bounded
+   run time size that can be run at high fill ratios.  This has the
+   same API as fd_map_dynamic but, in addition to the slot array, the
+   map keeps a compact control array with one byte per slot.  A control
+   byte is zero if its slot is empty and holds a 7-bit tag derived from
+   the key's hash otherwise.  Inserts and queries scan the control array
+   a group of slots at a time (32 with AVX, 16 with SSE) with vector byte
+   compares, only touching slots whose tag matches.  As such, probe
+   sequences can be long (in slots) without being slow and the map can
+   run up to 7/8 full.  Typical usage:
+
+     struct mymap {
+       ulong key;  // Technically "MAP_KEY_T  MAP_KEY;"  (default is ulong key)
+       uint  hash; // Technically "MAP_HASH_T MAP_HASH;" (default is uint  hash), ==mymap_hash(key)
+       ... key and hash can be located arbitrarily in struct
+       ... hash is not required if MAP_MEMOIZE is zero
+       ... the rest of the struct is POD state/values associated with key
+       ... the mapping of a key to a map slot is arbitrary and might
+       ... change over the lifetime of the key
+     };
+
+     typedef struct mymap mymap_t;
+
+     #define MAP_NAME mymap
+     #define MAP_T    mymap_t
+     #include "util/tmpl/fd_map_simd.c"
+
+  will declare the following static inline APIs as a header only style
+  library in the compilation unit:
+
+    // align/footprint - Return the alignment/footprint required for a
+    // memory region to be used as mymap with 2^lg_slot_cnt slots
+    // (sufficient to hold up to mymap_key_max keys).  Assumes
+    // lg_slot_cnt is in [0,48).
+    //
+    // new - Format a memory region pointed to by shmem into a mymap.
+    // Assumes shmem points to a region with the required alignment and
+    // footprint not in use by anything else.  Caller is not joined on
+    // return.  Returns shmem.
+    //
+    // join - Join a mymap.  Assumes shmap points at a region formatted
+    // as a mymap.  Returns a handle of the callers join (will be
+    // pointer to an array indexed [0,2^lg_slot_cnt) of mymap_t slots).
+    // THIS IS NOT JUST A SIMPLE CAST OF SHMAP.
+    //
+    // leave - Leave a mymap.  Asumes mymap points to a current join.
+    // Returns a pointer to the shared memory region the join.  THIS IS
+    // NOT JUST A SIMPLE CAST OF MAP.
+    //
+    // delete - Unformat a memory region used as a mymap.  Assumes
+    // shmymap points to a formatted region with no current joins.
+    // Returns a pointer to the unformated memory region.
+
+    ulong     mymap_align    ( void                             );
+    ulong     mymap_footprint( int lg_slot_cnt                  );
+    void *    mymap_new      ( void *    shmem, int lg_slot_cnt );
+    mymap_t * mymap_join     ( void *    shmap                  ); // Indexed [0,2^lg_slot_cnt)
+    void *    mymap_leave    ( mymap_t * map                    );
+    void *    mymap_delete   ( void *    shmap                  );
+
+    // Return the current/maximum number of keys that can be inserted
+    // into a mymap.  key_max is 7/8 of the slot count (rounded down,
+    // but always leaving at least one slot empty).
+
+    ulong mymap_key_cnt( mymap_t const * map ); // In [0,key_max]
+    ulong mymap_key_max( mymap_t const * map ); // ~7/8 2^lg_slot_cnt
+
+    // Return the log2 number of slots / number of slots in a mymap.
+    // This is to facilitate iterating / listing all contents of a mymap
+    // (this process is not algorithmically ideal for a sparse mymap).
+    // E.g.  mymap[slot_idx].key for slot_idx in [0,mymap_slot_cnt()]
+    // when key!=0 is the set of all current key-vals in the mymap.
+
+    int   mymap_lg_slot_cnt( mymap_t const * map ); // Non-negative
+    ulong mymap_slot_cnt   ( mymap_t const * map ); // == 2^lg_slot_cnt
+
+    // Returns the index of the slot.  Same as fd_map_dynamic.
+
+    ulong mymap_slot_idx( mymap_t const * map, mymap_t const * slot );
+
+    // mymap_key_null, mymap_key_inval, mymap_key_equal and
+    // mymap_key_hash are the same as fd_map_dynamic.
+
+    ulong mymap_key_null ( void               ); // == MAP_KEY_NULL
+    int   mymap_key_inval( ulong key          );
+    int   mymap_key_equal( ulong k0, ulong k1 );
+    uint  mymap_key_hash ( ulong key          );
+
+    // Insert key into the map, fast O(1).  Returns a pointer to the map
+    // entry with key on success and NULL on failure (i.e. key is
+    // already in the map or there are key_max keys in the map).  The
+    // returned pointer lifetime is until _any_ map remove or map leave.
+    // The caller should not change the values in map_key or map_hash but
+    // is free to modify other fields in the entry on return.  Assumes
+    // map is a current join and key is value that can be inserted.
+
+    mymap_t * mymap_insert( mymap_t * map, ulong key );
+
+    // Remove entry from map, fast O(1).  Assumes map is a current join
+    // and that entry points to a full entry currently in the map.  Like
+    // fd_map_dynamic, this will move entries around (via MAP_MOVE) to
+    // keep probe sequences intact (no tombstones).
+
+    void mymap_remove( mymap_t * map, mymap_t * entry );
+
+    // Query map for key, fast O(1).  Returns a pointer to the map slot
+    // holding key or null if key not in map.  The returned pointer
+    // lifetime is until the next map remove or map leave.  The caller
+    // should not change key or hash but is free to modify other fields
+    // in the entry.  Assumes map is a current join and that key is
+    // non-zero.
+
+    mymap_t * mymap_query( mymap_t * map, ulong key, mymap_t * null );
+
+  The notes on non-POD C++ keys in fd_map_dynamic apply here too. */
+
+#include "../bits/fd_bits.h"
+
+#if FD_HAS_SSE
+#include <x86intrin.h>
+#endif
+
+#ifndef MAP_NAME
+#error "Define MAP_NAME"
+#endif
+
+/* A MAP_T should be something something reasonable to shallow copy with
+   the fields described above. */
+
+#ifndef MAP_T
+#error "Define MAP_T struct"
+#endif
+
+/* MAP_HASH_T should be an unsigned integral type. */
+
+#ifndef MAP_HASH_T
+#define MAP_HASH_T uint
+#endif
+
+/* MAP_HASH is the MAP_T hash field name.  Defaults to hash. */
+
+#ifndef MAP_HASH
+#define MAP_HASH hash
+#endif
+
+/* MAP_KEY_T should be something reasonable to pass to a static inline
+   by value, assign to MAP_KEY_NULL, compare for equality and copy.
+   E.g. a uint, ulong, __m128i, etc. */
+
+#ifndef MAP_KEY_T
+#define MAP_KEY_T ulong
+#else
+#if !defined(MAP_KEY_NULL) || !defined(MAP_KEY_INVAL) || !defined(MAP_KEY_EQUAL) || !defined(MAP_KEY_HASH)
+#error "Define MAP_KEY_NULL, MAP_KEY_INVAL, MAP_KEY_EQUAL and MAP_KEY_HASH if using a custom MAP_KEY_T"
+#endif
+#endif
+
+/* MAP_KEY is the MAP_T key field name.  Defaults to key. */
+
+#ifndef MAP_KEY
+#define MAP_KEY key
+#endif
+
+/* MAP_KEY_NULL is a key that will never be inserted. */
+
+#ifndef MAP_KEY_NULL
+#define MAP_KEY_NULL 0UL
+#endif
+
+/* MAP_KEY_INVAL returns 1 if k0 is key that will never be inserted
+   and zero otherwise.  Note that MAP_KEY_INVAL( MAP_KEY_NULL ) should
+   be true.  This should be generally fast. */
+
+#ifndef MAP_KEY_INVAL
+#define MAP_KEY_INVAL(k) !(k)
+#endif
+
+/* MAP_KEY_EQUAL returns 0/1 if k0 is the same/different */
+
+#ifndef MAP_KEY_EQUAL
+#define MAP_KEY_EQUAL(k0,k1) (k0)==(k1)
+#endif
+
+/* MAP_KEY_HASH takes a key and maps it into MAP_HASH_T uniform pseudo
+   randomly.  The least significant bits of the hash select the slot
+   where the probe sequence starts and the most significant 7 bits are
+   the key's tag.  (Unlike fd_map_dynamic, there is no
+   MAP_KEY_EQUAL_IS_SLOW as the tags already filter out nearly all
+   key compares against other keys.) */
+
+#ifndef MAP_KEY_HASH
+#define MAP_KEY_HASH(key) ((MAP_HASH_T)fd_ulong_hash( key ))
+#endif
+
+/* MAP_KEY_MOVE moves the contents from src to dst.  Non-POD key types
+   need to customize this accordingly (and handle the case of
+   ks==MAP_KEY_NULL).  Defaults to shallow copy. */
+
+#ifndef MAP_KEY_MOVE
+#define MAP_KEY_MOVE(kd,ks) (kd)=(ks)
+#endif
+
+/* MAP_MOVE moves the contents of a MAP_T from src to dst.  Non-POD key
+   types need to customize this accordingly.  Defaults to shallow copy. */
+
+#ifndef MAP_MOVE
+#define MAP_MOVE(d,s) (d)=(s)
+#endif
+
+/* If MAP_MEMOIZE is defined to non-zero, the MAP_T requires a
+   "map_hash" field that will hold the value of the MAP_KEY_HASH of the
+   MAP_T's MAP_KEY when the map slot is not empty (undefined otherwise).
+   This accelerates remove operations. */
+
+#ifndef MAP_MEMOIZE
+#define MAP_MEMOIZE 1
+#endif
+
+/* Implementation *****************************************************/
+
+/* FD_MAP_SIMD_PRIVATE_GROUP_SZ is the number of control bytes scanned
+   at a time.  The control array has GROUP_SZ extra trailing bytes that
+   mirror the leading bytes such that a group can be loaded starting at
+   any slot without worrying about wrapping. */
+
+#ifndef FD_MAP_SIMD_PRIVATE_GROUP_SZ
+#if FD_HAS_AVX
+#define FD_MAP_SIMD_PRIVATE_GROUP_SZ (32UL)
+#elif FD_HAS_SSE
+#define FD_MAP_SIMD_PRIVATE_GROUP_SZ (16UL)
+#else
+#define FD_MAP_SIMD_PRIVATE_GROUP_SZ (8UL)
+#endif
+#endif
+
+#define MAP_(n) FD_EXPAND_THEN_CONCAT3(MAP_NAME,_,n)
+
+struct MAP_(private) {
+  ulong key_cnt;     /* == number of keys currently in map */
+  ulong key_max;     /* == ~7/8 slot_cnt, in [0,slot_cnt) */
+  ulong slot_mask;   /* == 2^lg_slot_cnt - 1 */
+  int   lg_slot_cnt; /* non-negative */
+  MAP_T slot[1];     /* Actually 2^lg_slot_cnt in size, followed by the control array */
+};
+
+typedef struct MAP_(private) MAP_(private_t);
+
+FD_PROTOTYPES_BEGIN
+
+/* Private APIs *******************************************************/
+
+/* private_from_slot return a pointer to the map_private given a pointer
+   to the map's slot.  private_from_map_const also provided for
+   const-correctness purposes. */
+
+FD_FN_CONST static inline MAP_(private_t) *
+MAP_(private_from_slot)( MAP_T * slot ) {
+  return (MAP_(private_t) *)( (ulong)slot - (ulong)&(((MAP_(private_t) *)NULL)->slot) );
+}
+
+FD_FN_CONST static inline MAP_(private_t) const *
+MAP_(private_from_slot_const)( MAP_T const * slot ) {
+  return (MAP_(private_t) const *)( (ulong)slot - (ulong)&(((MAP_(private_t) *)NULL)->slot) );
+}
+
+/* private_ctrl returns the location of the control array (indexed
+   [0,slot_cnt+GROUP_SZ)) in the caller's address space given the slot
+   array and slot_mask. */
+
+FD_FN_CONST static inline uchar *
+MAP_(private_ctrl)( MAP_T * slot,
+                    ulong   slot_mask ) {
+  return (uchar *)(slot + slot_mask + 1UL);
+}
+
+/* Get the linear probing starting slot and the control tag of a key
+   from its hash.  Tags are in [0x80,0xff] (the control byte of an empty
+   slot is 0). */
+
+FD_FN_CONST static inline ulong MAP_(private_start)( MAP_HASH_T hash, ulong slot_mask ) { return (ulong)(hash & (MAP_HASH_T)slot_mask); }
+
+FD_FN_CONST static inline uint
+MAP_(private_tag)( MAP_HASH_T hash ) {
+  return 0x80U | (uint)(((ulong)hash) >> (8UL*sizeof(MAP_HASH_T)-7UL));
+}
+
+/* private_ctrl_set sets the control byte for slot (and its mirrors). */
+
+static inline void
+MAP_(private_ctrl_set)( uchar * ctrl,
+                        ulong   slot_mask,
+                        ulong   slot,
+                        uint    tag ) {
+  ulong slot_cnt = slot_mask + 1UL;
+  ulong ctrl_cnt = slot_cnt + FD_MAP_SIMD_PRIVATE_GROUP_SZ;
+  for( ulong idx=slot; idx<ctrl_cnt; idx+=slot_cnt ) ctrl[ idx ] = (uchar)tag;
+}
+
+/* private_group returns the control bytes for slots [slot,slot+GROUP_SZ)
+   (cyclic) that match tag in match and the ones that are empty in empty
+   (bit i of the mask corresponds to slot+i).  This is the only place
+   where the vector instructions are used. */
+
+static inline void
+MAP_(private_group)( uchar const * ctrl,
+                     ulong         slot,
+                     uint          tag,
+                     ulong *       _match,
+                     ulong *       _empty ) {
+# if FD_HAS_AVX
+  __m256i c = _mm256_loadu_si256( (__m256i const *)(ctrl + slot) );
+  *_match = (ulong)(uint)_mm256_movemask_epi8( _mm256_cmpeq_epi8( c, _mm256_set1_epi8( (char)tag ) ) );
+  *_empty = (ulong)(uint)_mm256_movemask_epi8( _mm256_cmpeq_epi8( c, _mm256_setzero_si256()       ) );
+# elif FD_HAS_SSE
+  __m128i c = _mm_loadu_si128( (__m128i const *)(ctrl + slot) );
+  *_match = (ulong)(uint)_mm_movemask_epi8( _mm_cmpeq_epi8( c, _mm_set1_epi8( (char)tag ) ) );
+  *_empty = (ulong)(uint)_mm_movemask_epi8( _mm_cmpeq_epi8( c, _mm_setzero_si128()       ) );
+# else
+  ulong match = 0UL;
+  ulong empty = 0UL;
+  for( ulong idx=0UL; idx<FD_MAP_SIMD_PRIVATE_GROUP_SZ; idx++ ) {
+    uint c = (uint)ctrl[ slot+idx ];
+    match |= ((ulong)(c==tag)) << idx;
+    empty |= ((ulong)(c==0U )) << idx;
+  }
+  *_match = match;
+  *_empty = empty;
+# endif
+}
+
+/* Public APIS ********************************************************/
+
+FD_FN_CONST static inline ulong MAP_(align)( void ) { return alignof(MAP_(private_t)); }
+
+FD_FN_CONST static inline ulong
+MAP_(footprint)( int lg_slot_cnt ) {
+  ulong slot_cnt = 1UL << lg_slot_cnt;
+  return fd_ulong_align_up( fd_ulong_align_up( 32UL, alignof(MAP_T) ) + sizeof(MAP_T)*slot_cnt
+                            + slot_cnt + FD_MAP_SIMD_PRIVATE_GROUP_SZ, alignof(MAP_(private_t)) );
+}
+
+static inline void *
+MAP_(new)( void *  shmem,
+           int     lg_slot_cnt ) {
+  ulong slot_cnt  = 1UL<<lg_slot_cnt;
+  ulong slot_mask = slot_cnt - 1UL;
+  MAP_(private_t) * map = (MAP_(private_t) *)shmem;
+
+  map->key_cnt     = 0UL;
+  map->key_max     = slot_cnt - fd_ulong_max( slot_cnt>>3, 1UL );
+  map->slot_mask   = slot_mask;
+  map->lg_slot_cnt = lg_slot_cnt;
+
+  MAP_T * slot = map->slot; FD_COMPILER_FORGET( slot );
+  for( ulong slot_idx=0UL; slot_idx<slot_cnt; slot_idx++ ) slot[ slot_idx ].MAP_KEY = (MAP_KEY_NULL);
+  memset( MAP_(private_ctrl)( slot, slot_mask ), 0, slot_cnt + FD_MAP_SIMD_PRIVATE_GROUP_SZ );
+
+  return map;
+}
+
+static inline MAP_T *
+MAP_(join)( void * shmap ) {
+  MAP_(private_t) * map = (MAP_(private_t) *)shmap;
+  MAP_T * slot = map->slot; FD_COMPILER_FORGET( slot );
+  return slot;
+}
+
+static inline void * MAP_(leave) ( MAP_T * slot  ) { return (void *)MAP_(private_from_slot)( slot ); }
+static inline void * MAP_(delete)( void *  shmap ) { return shmap; }
+
+FD_FN_PURE  static inline ulong MAP_(key_cnt)    ( MAP_T const * slot ) { return MAP_(private_from_slot_const)( slot )->key_cnt;       }
+FD_FN_CONST static inline ulong MAP_(key_max)    ( MAP_T const * slot ) { return MAP_(private_from_slot_const)( slot )->key_max;       }
+FD_FN_CONST static inline int   MAP_(lg_slot_cnt)( MAP_T const * slot ) { return MAP_(private_from_slot_const)( slot )->lg_slot_cnt;   }
+FD_FN_CONST static inline ulong MAP_(slot_cnt)   ( MAP_T const * slot ) { return MAP_(private_from_slot_const)( slot )->slot_mask+1UL; }
+
+FD_FN_CONST static inline ulong MAP_(slot_idx)( MAP_T const * map, MAP_T const * entry ) { return (ulong)(entry - map); }
+
+FD_FN_CONST static inline MAP_KEY_T MAP_(key_null)( void ) { return (MAP_KEY_NULL); }
+
+/* These are FD_FN_PURE instead of FD_FN_CONST in case a non-POD
+   MAP_KEY_T.  FIXME: CONSIDER LETTING THE COMPILER SORT THIS OUT? */
+
+FD_FN_PURE static inline int MAP_(key_inval)( MAP_KEY_T k0               ) { return (MAP_KEY_INVAL(k0)); }
+FD_FN_PURE static inline int MAP_(key_equal)( MAP_KEY_T k0, MAP_KEY_T k1 ) { return (MAP_KEY_EQUAL(k0,k1)); }
+
+FD_FN_PURE static inline MAP_HASH_T MAP_(key_hash)( MAP_KEY_T key ) { return (MAP_KEY_HASH(key)); }
+
+FD_FN_UNUSED static MAP_T * /* Work around -Winline */
+MAP_(insert)( MAP_T *   map,
+              MAP_KEY_T key ) {
+  MAP_(private_t) * hdr = MAP_(private_from_slot)( map );
+
+  ulong key_cnt = hdr->key_cnt;
+  if( FD_UNLIKELY( key_cnt>=hdr->key_max ) ) return NULL;
+
+  ulong      slot_mask = hdr->slot_mask;
+  uchar *    ctrl      = MAP_(private_ctrl)( map, slot_mask );
+  MAP_HASH_T hash      = MAP_(key_hash)( key );
+  uint       tag       = MAP_(private_tag)( hash );
+  ulong      slot      = MAP_(private_start)( hash, slot_mask );
+  for(;;) {
+    ulong match; ulong empty; MAP_(private_group)( ctrl, slot, tag, &match, &empty );
+
+    /* Only tag matches before the first empty slot in the group are in
+       the probe sequence.  Note that keys are always found on the first
+       try when the fill ratio is modest. */
+
+    match &= (empty & (-empty)) - 1UL; /* all ones if empty is 0 */
+    while( FD_UNLIKELY( match ) ) {
+      ulong s = (slot + (ulong)fd_ulong_find_lsb( match )) & slot_mask;
+      if( FD_LIKELY( MAP_(key_equal)( map[s].MAP_KEY, key ) ) ) return NULL;
+      match &= match-1UL;
+    }
+
+    if( FD_LIKELY( empty ) ) {
+      slot = (slot + (ulong)fd_ulong_find_lsb( empty )) & slot_mask;
+      break;
+    }
+
+    slot = (slot + FD_MAP_SIMD_PRIVATE_GROUP_SZ) & slot_mask;
+  }
+
+  MAP_T * m = map + slot;
+  MAP_KEY_MOVE( m->MAP_KEY, key );
+# if MAP_MEMOIZE
+  m->MAP_HASH = hash;
+# endif
+  MAP_(private_ctrl_set)( ctrl, slot_mask, slot, tag );
+  hdr->key_cnt = key_cnt + 1UL;
+  return m;
+}
+
+static inline void
+MAP_(remove)( MAP_T * map,
+              MAP_T * entry ) {
+  MAP_(private_t) * hdr = MAP_(private_from_slot)( map );
+
+  /* FIXME: CONSIDER VALIDATING KEY_CNT AND/OR ENTRY ISN'T VALID */
+  hdr->key_cnt--;
+
+  ulong   slot_mask = hdr->slot_mask;
+  uchar * ctrl      = MAP_(private_ctrl)( map, slot_mask );
+  ulong   slot      = MAP_(slot_idx)( map, entry );
+  for(;;) {
+
+    /* Make a hole at slot */
+
+    map[slot].MAP_KEY = (MAP_KEY_NULL);
+    MAP_(private_ctrl_set)( ctrl, slot_mask, slot, 0U );
+    ulong hole = slot;
+
+    /* The creation of a hole at slot might have disrupted the probe
+       sequence involving the keys in any contiguously occupied map
+       entry after slot (see fd_map_dynamic for details). */
+
+    for(;;) {
+      slot = (slot+1UL) & slot_mask;
+
+      if( !ctrl[slot] ) return;
+
+#     if MAP_MEMOIZE
+      MAP_HASH_T hash = map[slot].MAP_HASH;
+#     else
+      MAP_HASH_T hash = MAP_(key_hash)( map[slot].MAP_KEY );
+#     endif
+      ulong start = MAP_(private_start)( hash, slot_mask );
+      if( !(((hole<start) & (start<=slot)) | ((hole>slot) & ((hole<start) | (start<=slot)))) ) break;
+    }
+
+    MAP_MOVE( map[hole], map[slot] );
+    MAP_(private_ctrl_set)( ctrl, slot_mask, hole, (uint)ctrl[slot] );
+  }
+  /* never get here */
+}
+
+FD_FN_PURE FD_FN_UNUSED static MAP_T * /* Work around -Winline */
+MAP_(query)( MAP_T *   map,
+             MAP_KEY_T key,
+             MAP_T *   null ) {
+  ulong         slot_mask = MAP_(private_from_slot)( map )->slot_mask;
+  uchar const * ctrl      = MAP_(private_ctrl)( map, slot_mask );
+  MAP_HASH_T    hash      = MAP_(key_hash)( key );
+  uint          tag       = MAP_(private_tag)( hash );
+  ulong         slot      = MAP_(private_start)( hash, slot_mask );
+  for(;;) {
+    ulong match; ulong empty; MAP_(private_group)( ctrl, slot, tag, &match, &empty );
+    match &= (empty & (-empty)) - 1UL;
+    while( match ) {
+      MAP_T * m = map + ((slot + (ulong)fd_ulong_find_lsb( match )) & slot_mask);
+      if( FD_LIKELY( MAP_(key_equal)( m->MAP_KEY, key ) ) ) return m;
+      match &= match-1UL;
+    }
+    if( FD_LIKELY( empty ) ) return null;
+    slot = (slot + FD_MAP_SIMD_PRIVATE_GROUP_SZ) & slot_mask;
+  }
+  /* never get here */
+}
+
+FD_PROTOTYPES_END
+
+#undef MAP_
+
+/* End implementation *************************************************/
+
+#undef MAP_MEMOIZE
+#undef MAP_MOVE
+#undef MAP_KEY_MOVE
+#undef MAP_KEY_HASH
+#undef MAP_KEY_EQUAL
+#undef MAP_KEY_INVAL
+#undef MAP_KEY_NULL
+#undef MAP_KEY
+#undef MAP_KEY_T
+#undef MAP_HASH
+#undef MAP_HASH_T
+#undef MAP_T
+#undef MAP_NAME
@@ -65,6 +65,47 @@
                          ulong    cnt,
                          ulong    rnk );
 
+   If SORT_RADIX_KEY is defined (see below), the following API is also
+   created:
+
+     // Sort key[i] for i in [0,cnt) stable in best / average / worst
+     // case of O(N) / O(N) / O(N) operations (an LSD radix sort with
+     // 8-bit digits that skips digits where all keys are the same).
+     // Scratch is a scratch workspace suitable for the stable sorts
+     // above.  Returns where the sorted values ended up.  Will be at
+     // either key or (double *)scratch.
+
+     double *
+     sort_double_descend_radix_fast( double * key,
+                                     ulong    cnt,
+                                     void *   scratch );
+
+     // Same as above but does additional copying if necessary such that
+     // the final result ends up in key.  Returns key.
+
+     double *
+     sort_double_descend_radix( double * key,
+                                ulong    cnt,
+                                void *   scratch );
+
+   If SORT_PARALLEL is non-zero (see below), the following API is also
+   created:
+
+     // Same as sort_double_descend_stable but uses the caller and the
+     // tiles [tile0,tile1) as workers of the fd_tpool tpool.  Blocks
+     // are sorted in parallel with the above and then merged in
+     // parallel (each merge is split into segments that are placed by
+     // binary search such that all workers can help with the final
+     // merges).  Returns key.
+
+     double *
+     sort_double_descend_stable_para( fd_tpool_t * tpool,
+                                      ulong        tile0,
+                                      ulong        tile1,
+                                      double *     key,
+                                      ulong        cnt,
+                                      void *       scratch );
+
    It is fine to include this template multiple times in a compilation
    unit.  Just provide the specification before each inclusion.  Various
    additional options to tune the methods are described below. */
@@ -126,6 +167,47 @@
 #define SORT_QUICK_SWAP_MINIMIZE 0
 #endif
 
+/* SORT_RADIX_KEY(k), if defined, maps a key to a ulong such that
+   SORT_BEFORE(a,b) is equivalent to SORT_RADIX_KEY(a)<SORT_RADIX_KEY(b).
+   This enables the radix sort APIs.  fd_sort_radix_key_{long,ulong,
+   double,...} below give the mappings for the usual primitive types
+   (e.g. for an descending sort of doubles, use
+   ~fd_sort_radix_key_double(k)).  Keys narrower than 64-bits should
+   map to small values to benefit from the skipping of digits where all
+   keys are the same. */
+
+/* SORT_NETWORK indicates that quick sort and select should sort small
+   partitions with AVX2 bitonic sorting networks instead of insertion
+   sort.  Only supported for keys that are 64-bit primitives sorted in
+   ascending order:
+     0 - use insertion sort (default)
+     1 - SORT_KEY_T is a long   and SORT_BEFORE(a,b) is (a)<(b)
+     2 - SORT_KEY_T is a ulong  and SORT_BEFORE(a,b) is (a)<(b)
+     3 - SORT_KEY_T is a double and SORT_BEFORE(a,b) is (a)<(b) (no NaN)
+   Ignored on targets without FD_HAS_AVX.  The networks handle
+   partitions of up to 32 keys (SORT_QUICK_THRESH should be at most 32
+   to use them for all small partitions). */
+
+#ifndef SORT_NETWORK
+#define SORT_NETWORK 0
+#endif
+
+/* SORT_PARALLEL indicates the parallel APIs should be created (requires
+   fd_tpool).  SORT_PARALLEL_THRESH gives the largest cnt that the
+   parallel APIs sort on the caller alone. */
+
+#ifndef SORT_PARALLEL
+#define SORT_PARALLEL 0
+#endif
+
+#ifndef SORT_PARALLEL_THRESH
+#define SORT_PARALLEL_THRESH 16384UL
+#endif
+
+#if SORT_PARALLEL
+#include "../tpool/fd_tpool.h"
+#endif
+
 /* 0 - local use only
    1 - library header declaration
    2 - library implementation */
@@ -142,6 +224,113 @@
 
 /**********************************************************************/
 
+#ifndef HEADER_fd_src_util_tmpl_fd_sort_private
+#define HEADER_fd_src_util_tmpl_fd_sort_private
+
+/* fd_sort_radix_key_* map primitive types to ulongs that preserve the
+   ascending order of the type (for floating point, -0 is before +0 and
+   NaN are not supported). */
+
+FD_FN_CONST static inline ulong fd_sort_radix_key_uchar ( uchar  k ) { return (ulong)k; }
+FD_FN_CONST static inline ulong fd_sort_radix_key_ushort( ushort k ) { return (ulong)k; }
+FD_FN_CONST static inline ulong fd_sort_radix_key_uint  ( uint   k ) { return (ulong)k; }
+FD_FN_CONST static inline ulong fd_sort_radix_key_ulong ( ulong  k ) { return k;        }
+FD_FN_CONST static inline ulong fd_sort_radix_key_schar ( schar  k ) { return (ulong)(uchar )(k ^ (schar)SCHAR_MIN); }
+FD_FN_CONST static inline ulong fd_sort_radix_key_short ( short  k ) { return (ulong)(ushort)(k ^ (short)SHRT_MIN ); }
+FD_FN_CONST static inline ulong fd_sort_radix_key_int   ( int    k ) { return (ulong)((uint)k ^ (1U <<31)); }
+FD_FN_CONST static inline ulong fd_sort_radix_key_long  ( long   k ) { return (ulong)k ^ (1UL<<63); }
+
+FD_FN_CONST static inline ulong
+fd_sort_radix_key_float( float k ) {
+  union { float f; uint u; } t; t.f = k;
+  return (ulong)(t.u ^ ((uint)(((int)t.u)>>31) | (1U<<31)));
+}
+
+#if FD_HAS_DOUBLE
+FD_FN_CONST static inline ulong
+fd_sort_radix_key_double( double k ) {
+  union { double f; ulong u; } t; t.f = k;
+  return t.u ^ ((ulong)(((long)t.u)>>63) | (1UL<<63));
+}
+#endif
+
+#if FD_HAS_AVX
+
+#include <x86intrin.h>
+
+/* FD_SORT_PRIVATE_CE does a compare exchange of the 4 signed 64-bit
+   lanes of a and b (a gets the lane-wise min and b the max). */
+
+#define FD_SORT_PRIVATE_CE(a,b) do {                          \
+    __m256i _gt = _mm256_cmpgt_epi64( (a), (b) );              \
+    __m256i _lo = _mm256_blendv_epi8( (a), (b), _gt );         \
+    (b)         = _mm256_blendv_epi8( (b), (a), _gt );         \
+    (a)         = _lo;                                         \
+  } while(0)
+
+/* fd_sort_private_net_clean sorts the bitonic sequence held in the 4
+   lanes of v. */
+
+static inline __m256i
+fd_sort_private_net_clean( __m256i v ) {
+  __m256i t; __m256i gt; __m256i lo; __m256i hi;
+  t  = _mm256_permute4x64_epi64( v, 0x4E ); /* Distance 2 */
+  gt = _mm256_cmpgt_epi64( v, t );
+  lo = _mm256_blendv_epi8( v, t, gt );
+  hi = _mm256_blendv_epi8( t, v, gt );
+  v  = _mm256_blend_epi32( lo, hi, 0xF0 );
+  t  = _mm256_permute4x64_epi64( v, 0xB1 ); /* Distance 1 */
+  gt = _mm256_cmpgt_epi64( v, t );
+  lo = _mm256_blendv_epi8( v, t, gt );
+  hi = _mm256_blendv_epi8( t, v, gt );
+  return _mm256_blend_epi32( lo, hi, 0xCC );
+}
+
+/* fd_sort_private_net sorts the 4*reg_cnt signed 64-bit values in the
+   32-byte aligned buf in ascending order with a bitonic sorting
+   network.  reg_cnt should be a compile time constant 4 or 8.  Groups
+   of 4 registers are sorted column-wise and transposed such that each
+   register holds a sorted run of 4, then runs are repeatedly bitonic
+   merged. */
+
+static inline void
+fd_sort_private_net( long * buf,
+                     ulong  reg_cnt ) {
+  __m256i r[8];
+  for( ulong i=0UL; i<reg_cnt; i++ ) r[i] = _mm256_load_si256( (__m256i const *)(buf + 4UL*i) );
+
+  for( ulong g=0UL; g<reg_cnt; g+=4UL ) {
+    FD_SORT_PRIVATE_CE( r[g    ], r[g+1UL] ); FD_SORT_PRIVATE_CE( r[g+2UL], r[g+3UL] );
+    FD_SORT_PRIVATE_CE( r[g    ], r[g+2UL] ); FD_SORT_PRIVATE_CE( r[g+1UL], r[g+3UL] );
+    FD_SORT_PRIVATE_CE( r[g+1UL], r[g+2UL] );
+    __m256i t0 = _mm256_unpacklo_epi64( r[g    ], r[g+1UL] );
+    __m256i t1 = _mm256_unpackhi_epi64( r[g    ], r[g+1UL] );
+    __m256i t2 = _mm256_unpacklo_epi64( r[g+2UL], r[g+3UL] );
+    __m256i t3 = _mm256_unpackhi_epi64( r[g+2UL], r[g+3UL] );
+    r[g    ] = _mm256_permute2x128_si256( t0, t2, 0x20 );
+    r[g+1UL] = _mm256_permute2x128_si256( t1, t3, 0x20 );
+    r[g+2UL] = _mm256_permute2x128_si256( t0, t2, 0x31 );
+    r[g+3UL] = _mm256_permute2x128_si256( t1, t3, 0x31 );
+  }
+
+  for( ulong w=1UL; w<reg_cnt; w<<=1 ) { /* Merge runs of w registers */
+    for( ulong b=0UL; b<reg_cnt; b+=2UL*w ) {
+      __m256i t[4];
+      for( ulong i=0UL; i<w; i++ ) t[i] = _mm256_permute4x64_epi64( r[b+2UL*w-1UL-i], 0x1B ); /* Reverse the right run */
+      for( ulong i=0UL; i<w; i++ ) { FD_SORT_PRIVATE_CE( r[b+i], t[i] ); r[b+w+i] = t[i]; }
+      for( ulong d=w>>1; d; d>>=1 )
+        for( ulong i=b; i<b+2UL*w; i++ ) if( !(i & d) ) FD_SORT_PRIVATE_CE( r[i], r[i+d] );
+      for( ulong i=b; i<b+2UL*w; i++ ) r[i] = fd_sort_private_net_clean( r[i] );
+    }
+  }
+
+  for( ulong i=0UL; i<reg_cnt; i++ ) _mm256_store_si256( (__m256i *)(buf + 4UL*i), r[i] );
+}
+
+#endif /* FD_HAS_AVX */
+
+#endif /* HEADER_fd_src_util_tmpl_fd_sort_private */
+
 #define SORT_(x)FD_EXPAND_THEN_CONCAT3(SORT_NAME,_,x)
 
 #if SORT_IMPL_STYLE==1 /* need prototypes */
@@ -160,6 +349,23 @@ SORT_(private_select)( SORT_KEY_T * key,
                        SORT_IDX_T   cnt,
                        SORT_IDX_T   rnk );
 
+#ifdef SORT_RADIX_KEY
+SORT_KEY_T *
+SORT_(private_radix)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt,
+                      SORT_KEY_T * tmp );
+#endif
+
+#if SORT_PARALLEL
+SORT_KEY_T *
+SORT_(stable_para)( fd_tpool_t * tpool,
+                    ulong        tile0,
+                    ulong        tile1,
+                    SORT_KEY_T * key,
+                    SORT_IDX_T   cnt,
+                    void *       scratch );
+#endif
+
 #else /* need implementations */
 
 #if SORT_IMPL_STYLE==0 /* local only */
@@ -185,6 +391,60 @@ SORT_(insert)( SORT_KEY_T * key,
   return key;
 }
 
+/* SORT_(private_small) sorts the small partitions of quick sort and
+   select. */
+
+#if SORT_NETWORK && FD_HAS_AVX
+
+FD_STATIC_ASSERT( sizeof(SORT_KEY_T)==8UL, fd_sort_network_requires_64_bit_keys );
+
+static inline SORT_KEY_T *
+SORT_(private_small)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt ) {
+  ulong n = (ulong)cnt;
+  if( FD_UNLIKELY( n>32UL ) ) return SORT_(insert)( key, cnt );
+  if( FD_UNLIKELY( n<2UL  ) ) return key;
+
+  /* Map the keys to signed 64-bit values with the same order, pad with
+     the largest value, sort and map back */
+
+  long buf[ 32 ] __attribute__((aligned(32)));
+  ulong m = fd_ulong_if( n<=16UL, 16UL, 32UL );
+  for( ulong i=0UL; i<n; i++ ) {
+#   if SORT_NETWORK==1
+    buf[i] = (long)key[i];
+#   elif SORT_NETWORK==2
+    buf[i] = (long)(((ulong)key[i]) ^ (1UL<<63));
+#   else
+    union { SORT_KEY_T f; long u; } t; t.f = key[i];
+    buf[i] = t.u ^ (long)(((ulong)(t.u>>63))>>1);
+#   endif
+  }
+  for( ulong i=n; i<m; i++ ) buf[i] = LONG_MAX;
+  fd_sort_private_net( buf, m>>2 );
+  for( ulong i=0UL; i<n; i++ ) {
+#   if SORT_NETWORK==1
+    key[i] = (SORT_KEY_T)buf[i];
+#   elif SORT_NETWORK==2
+    key[i] = (SORT_KEY_T)(((ulong)buf[i]) ^ (1UL<<63));
+#   else
+    union { SORT_KEY_T f; long u; } t; t.u = buf[i] ^ (long)(((ulong)(buf[i]>>63))>>1);
+    key[i] = t.f;
+#   endif
+  }
+  return key;
+}
+
+#else
+
+static inline SORT_KEY_T *
+SORT_(private_small)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt ) {
+  return SORT_(insert)( key, cnt );
+}
+
+#endif
+
 /* FIXME: USE IMPLICIT RECURSION ALA QUICK BELOW? */
 
 SORT_IMPL_STATIC SORT_KEY_T *
@@ -278,7 +538,7 @@ SORT_(private_quick)( SORT_KEY_T * key,
 
     SORT_IDX_T n = h-l;
     if( FD_LIKELY( n <= ((SORT_IDX_T)(SORT_QUICK_THRESH)) ) ) {
-      SORT_(insert)( key+l, n );
+      SORT_(private_small)( key+l, n );
       continue;
     }
 
@@ -441,7 +701,7 @@ SORT_(private_select)( SORT_KEY_T * key,
        enough, sort it via insertion sort. */
 
     SORT_IDX_T n = h-l;
-    if( FD_LIKELY( n <= ((SORT_IDX_T)(SORT_QUICK_THRESH)) ) ) { SORT_(insert)( key+l, n ); return key; }
+    if( FD_LIKELY( n <= ((SORT_IDX_T)(SORT_QUICK_THRESH)) ) ) { SORT_(private_small)( key+l, n ); return key; }
 
     /* This partition is too large to insertion sort.  Pick two pivots,
        sort the partition into a left, center and right partition and
@@ -564,6 +824,195 @@ SORT_(private_select)( SORT_KEY_T * key,
   /* never get here */
 }
 
+#ifdef SORT_RADIX_KEY
+
+/* This is an LSD radix sort with 8-bit digits.  All the digit
+   histograms are computed in a single pass up front.  Passes for
+   digits where all keys have the same value are skipped (such that
+   sorting narrow or clustered keys is cheap). */
+
+SORT_IMPL_STATIC SORT_KEY_T *
+SORT_(private_radix)( SORT_KEY_T * key,
+                      SORT_IDX_T   cnt,
+                      SORT_KEY_T * tmp ) {
+  ulong n = (ulong)cnt;
+  if( FD_UNLIKELY( n<2UL ) ) return key;
+
+  ulong hist[ 8 ][ 256 ];
+  memset( hist, 0, sizeof(hist) );
+  for( ulong i=0UL; i<n; i++ ) {
+    ulong r = (ulong)(SORT_RADIX_KEY( key[i] ));
+    for( ulong d=0UL; d<8UL; d++ ) hist[ d ][ (r >> (8UL*d)) & 255UL ]++;
+  }
+
+  ulong        r0  = (ulong)(SORT_RADIX_KEY( key[0] ));
+  SORT_KEY_T * src = key;
+  SORT_KEY_T * dst = tmp;
+  for( ulong d=0UL; d<8UL; d++ ) {
+    ulong   shift = 8UL*d;
+    ulong * h     = hist[ d ];
+    if( h[ (r0 >> shift) & 255UL ]==n ) continue; /* All keys have the same digit */
+
+    ulong sum = 0UL;
+    for( ulong b=0UL; b<256UL; b++ ) { ulong c = h[b]; h[b] = sum; sum += c; }
+
+    for( ulong i=0UL; i<n; i++ ) {
+      SORT_KEY_T k = src[i];
+      dst[ h[ (((ulong)(SORT_RADIX_KEY( k ))) >> shift) & 255UL ]++ ] = k;
+    }
+
+    SORT_KEY_T * t = src; src = dst; dst = t;
+  }
+  return src;
+}
+
+#endif
+
+#if SORT_PARALLEL
+
+/* A SORT_(private_para_t) describes a pass of SORT_(stable_para).  The
+   pass reads runs of width keys from src and writes runs of 2*width
+   keys to dst.  Each pair of runs is merged as seg_per_pair segments
+   of seg_sz output keys. */
+
+struct SORT_(private_para) {
+  SORT_KEY_T * src;
+  SORT_KEY_T * dst;
+  ulong        cnt;
+  ulong        width;
+  ulong        seg_sz;
+  ulong        seg_per_pair;
+};
+
+typedef struct SORT_(private_para) SORT_(private_para_t);
+
+/* SORT_(private_para_leaf) sorts the blocks [b0,b1) of width keys in
+   place (using the same region of dst as scratch). */
+
+static void
+SORT_(private_para_leaf)( void * _ctx,
+                          ulong  b0,
+                          ulong  b1 ) {
+  SORT_(private_para_t) const * ctx = (SORT_(private_para_t) const *)_ctx;
+  for( ulong b=b0; b<b1; b++ ) {
+    ulong        i0  = b*ctx->width;
+    if( FD_UNLIKELY( i0>=ctx->cnt ) ) return; /* Trailing blocks can be empty when cnt is not a multiple of width */
+    ulong        n   = fd_ulong_min( ctx->width, ctx->cnt - i0 );
+    SORT_KEY_T * key = ctx->src + i0;
+    SORT_KEY_T * tmp = ctx->dst + i0;
+    if( SORT_(private_merge)( key, (SORT_IDX_T)n, tmp )==tmp ) memcpy( key, tmp, n*sizeof(SORT_KEY_T) );
+  }
+}
+
+/* SORT_(private_para_merge) does the merge segments [s0,s1) of a
+   pass.  The number of keys from the left run among the first k
+   outputs of a merge is found by binary search (ties go to the left run
+   for stability), so each segment can be merged independently. */
+
+static inline ulong
+SORT_(private_para_split)( SORT_KEY_T const * a,
+                           ulong              na,
+                           SORT_KEY_T const * b,
+                           ulong              nb,
+                           ulong              k ) {
+  ulong lo = k - fd_ulong_min( k, nb );
+  ulong hi = fd_ulong_min( k, na );
+  while( lo<hi ) {
+    ulong mid = (lo+hi+1UL)>>1;
+    if( SORT_BEFORE( b[ k-mid ], a[ mid-1UL ] ) ) hi = mid-1UL;
+    else                                         lo = mid;
+  }
+  return lo;
+}
+
+static void
+SORT_(private_para_merge)( void * _ctx,
+                           ulong  s0,
+                           ulong  s1 ) {
+  SORT_(private_para_t) const * ctx = (SORT_(private_para_t) const *)_ctx;
+  ulong cnt   = ctx->cnt;
+  ulong width = ctx->width;
+  for( ulong s=s0; s<s1; s++ ) {
+    ulong base = (s / ctx->seg_per_pair)*2UL*width;
+    ulong na   = fd_ulong_min( width, cnt - base );
+    ulong nb   = fd_ulong_min( width, cnt - base - na );
+    ulong o0   = (s % ctx->seg_per_pair)*ctx->seg_sz;
+    if( FD_UNLIKELY( o0>=na+nb ) ) continue;
+    ulong o1   = fd_ulong_min( o0 + ctx->seg_sz, na+nb );
+
+    SORT_KEY_T const * a  = ctx->src + base;
+    SORT_KEY_T const * b  = a + na;
+    ulong              a0 = SORT_(private_para_split)( a, na, b, nb, o0 ); ulong b0 = o0 - a0;
+    ulong              a1 = SORT_(private_para_split)( a, na, b, nb, o1 ); ulong b1 = o1 - a1;
+    SORT_KEY_T *       out = ctx->dst + base + o0;
+
+    while( (a0<a1) & (b0<b1) ) {
+      if( SORT_BEFORE( b[b0], a[a0] ) ) *out++ = b[b0++];
+      else                              *out++ = a[a0++];
+    }
+    while( a0<a1 ) *out++ = a[a0++];
+    while( b0<b1 ) *out++ = b[b0++];
+  }
+}
+
+/* SORT_(private_para_copy) copies src[i0,i1) to dst. */
+
+static void
+SORT_(private_para_copy)( void * _ctx,
+                          ulong  i0,
+                          ulong  i1 ) {
+  SORT_(private_para_t) const * ctx = (SORT_(private_para_t) const *)_ctx;
+  memcpy( ctx->dst + i0, ctx->src + i0, (i1-i0)*sizeof(SORT_KEY_T) );
+}
+
+SORT_IMPL_STATIC SORT_KEY_T *
+SORT_(stable_para)( fd_tpool_t * tpool,
+                    ulong        tile0,
+                    ulong        tile1,
+                    SORT_KEY_T * key,
+                    SORT_IDX_T   cnt,
+                    void *       scratch ) {
+  SORT_KEY_T * tmp        = (SORT_KEY_T *)scratch;
+  ulong        n          = (ulong)cnt;
+  ulong        worker_cnt = 1UL + tile1 - tile0;
+
+  if( FD_UNLIKELY( (n<=SORT_PARALLEL_THRESH) | (worker_cnt<=1UL) ) ) {
+    if( SORT_(private_merge)( key, cnt, tmp )==tmp ) memcpy( key, tmp, n*sizeof(SORT_KEY_T) );
+    return key;
+  }
+
+  /* Sort a power of two number of blocks (at least one per worker) in
+   parallel */
+
+  ulong block_cnt = fd_ulong_min( fd_ulong_pow2_up( worker_cnt ), 1UL << fd_ulong_find_msb( n / fd_ulong_max( (SORT_PARALLEL_THRESH)/2UL, 1UL ) ) );
+
+  SORT_(private_para_t) ctx[1];
+  ctx->src   = key;
+  ctx->dst   = tmp;
+  ctx->cnt   = n;
+  ctx->width = (n + block_cnt - 1UL) / block_cnt;
+  fd_tpool_for( tpool, tile0, tile1, 0UL, block_cnt, 1UL, SORT_(private_para_leaf), ctx );
+
+  /* Merge pairs of runs in parallel until there is one run */
+
+  ctx->seg_sz = fd_ulong_max( (n + 4UL*worker_cnt - 1UL) / (4UL*worker_cnt), 4096UL );
+  while( ctx->width<n ) {
+    ulong pair_cnt = (n + 2UL*ctx->width - 1UL) / (2UL*ctx->width);
+    ctx->seg_per_pair = (2UL*ctx->width + ctx->seg_sz - 1UL) / ctx->seg_sz;
+    fd_tpool_for( tpool, tile0, tile1, 0UL, pair_cnt*ctx->seg_per_pair, 1UL, SORT_(private_para_merge), ctx );
+    SORT_KEY_T * t = ctx->src; ctx->src = ctx->dst; ctx->dst = t;
+    ctx->width *= 2UL;
+  }
+
+  if( ctx->src!=key ) {
+    ctx->dst = key;
+    fd_tpool_for( tpool, tile0, tile1, 0UL, n, ctx->seg_sz, SORT_(private_para_copy), ctx );
+  }
+  return key;
+}
+
+#endif
+
 #undef SORT_IMPL_STATIC
 
 #endif
@@ -598,6 +1047,27 @@ SORT_(stable)( SORT_KEY_T * key,
   return key;
 }
 
+#ifdef SORT_RADIX_KEY
+
+static inline SORT_KEY_T *
+SORT_(radix_fast)( SORT_KEY_T * key,
+                   SORT_IDX_T   cnt,
+                   void *       scratch ) {
+  SORT_KEY_T * tmp = (SORT_KEY_T *)scratch;
+  return SORT_(private_radix)( key, cnt, tmp );
+}
+
+FD_FN_UNUSED static SORT_KEY_T * /* Work around -Winline */
+SORT_(radix)( SORT_KEY_T * key,
+              SORT_IDX_T   cnt,
+              void *       scratch ) {
+  SORT_KEY_T * tmp = (SORT_KEY_T *)scratch;
+  if( SORT_(private_radix)( key, cnt, tmp )==tmp ) for( SORT_IDX_T i=((SORT_IDX_T)0); i<cnt; i++ ) key[i] = tmp[i];
+  return key;
+}
+
+#endif
+
 static inline SORT_KEY_T *
 SORT_(inplace)( SORT_KEY_T * key,
                 SORT_IDX_T   cnt ) {
@@ -617,6 +1087,10 @@ SORT_(select)( SORT_KEY_T * key,
 
 #undef SORT_IDX_IF
 #undef SORT_IMPL_STYLE
+#undef SORT_NETWORK
+#undef SORT_RADIX_KEY
+#undef SORT_PARALLEL
+#undef SORT_PARALLEL_THRESH
 #undef SORT_QUICK_SWAP_MINIMIZE
 #undef SORT_QUICK_ORDER_STYLE
 #undef SORT_QUICK_THRESH
@@ -0,0 +1,428 @@
+/* Declare ultra high performance hierarchical timer wheels.  A timer
+   wheel tracks a large number of timers (e.g. pending transaction
+   expiration, per flow timeouts, etc) with O(1) schedule, O(1) cancel
+   and O(1) amortized cost per timer to advance time (independent of
+   the number of timers and of how far time is advanced).  By contrast,
+   a priority queue like fd_prq is O(lg N) per operation and does not
+   support canceling an arbitrary timer.  Typical usage:
+
+     struct flow {
+       ... app stuff
+       ulong prev;   // Technically "ulong TWHEEL_PREV;"
+       ulong next;   // Technically "ulong TWHEEL_NEXT;"
+       ulong expire; // Technically "ulong TWHEEL_EXPIRE;"
+       ... app stuff
+     };
+
+     typedef struct flow flow_t;
+
+     #define TWHEEL_NAME flow_wheel
+     #define TWHEEL_T    flow_t
+     #include "util/tmpl/fd_twheel.c"
+
+   will declare the following static inline APIs as a header only style
+   library in the compilation unit:
+
+     // Timers are elements of a caller managed pool of TWHEEL_T (e.g.
+     // an array or a fd_pool of flows) and are identified by their index
+     // in the pool.  The wheel stores its links in the elements
+     // themselves (intrusive), so the wheel itself has a small fixed
+     // footprint and never allocates.  The pool is passed to calls that
+     // need to access elements (such that the pool can be at different
+     // addresses in different processes).
+
+     // align/footprint - Return the alignment/footprint required for a
+     // memory region to be used as a flow_wheel.
+     //
+     // new - Format a memory region pointed to by shmem into a
+     // flow_wheel with no timers scheduled and current time now.
+     // Assumes shmem points to a region with the required alignment and
+     // footprint not in use by anything else.  Caller is not joined on
+     // return.  Returns shmem.
+     //
+     // join - Join a flow_wheel.  Assumes shwheel points at a region
+     // formatted as a flow_wheel.  Returns a local handle to the wheel.
+     //
+     // leave - Leave a flow_wheel.  Returns a pointer to the memory
+     // region holding the wheel.
+     //
+     // delete - Unformat a memory region used as a flow_wheel.  Returns
+     // a pointer to the unformatted memory region.
+
+     ulong          flow_wheel_align    ( void );
+     ulong          flow_wheel_footprint( void );
+     void *         flow_wheel_new      ( void *         shmem, ulong now );
+     flow_wheel_t * flow_wheel_join     ( void *         shwheel );
+     void *         flow_wheel_leave    ( flow_wheel_t * wheel );
+     void *         flow_wheel_delete   ( void *         shwheel );
+
+     // idx_null returns the index used to indicate no element.
+     // now returns the wheel's current time.
+     // cnt returns the number of timers currently scheduled.
+
+     ulong flow_wheel_idx_null( void );
+     ulong flow_wheel_now     ( flow_wheel_t const * wheel );
+     ulong flow_wheel_cnt     ( flow_wheel_t const * wheel );
+
+     // schedule schedules pool element idx (not currently scheduled) to
+     // expire at time expire (stored in the element's expire field).  If
+     // expire is at or before the wheel's current time, the element will
+     // be returned by the next advance.  Fast O(1).
+     //
+     // cancel cancels the timer of currently scheduled pool element idx.
+     // Fast O(1).  To reschedule a timer, cancel and then schedule it.
+
+     void flow_wheel_schedule( flow_wheel_t * wheel, flow_t * pool, ulong idx, ulong expire );
+     void flow_wheel_cancel  ( flow_wheel_t * wheel, flow_t * pool, ulong idx );
+
+     // advance advances the wheel's current time to now (now at or
+     // before the wheel's current time just returns the timers that
+     // were scheduled to expire in the past) and returns the timers that
+     // have expired as a list (linked through the elements' next fields
+     // and terminated by idx_null) in order of nondecreasing expiration
+     // time (except that timers that were scheduled to expire at or
+     // before the wheel's time at schedule are first in the list in an
+     // arbitrary order).  The returned elements are no longer scheduled
+     // (they can be immediately rescheduled, but note that rescheduling
+     // clobbers the next field ... copy it before rescheduling).  Cost
+     // is O(1) per expired timer plus O(1) per wheel slot holding timers
+     // that is passed, independent of how far time is advanced.  E.g.:
+     //
+     //   for( ulong idx=flow_wheel_advance( wheel, pool, fd_tickcount()>>10 ); idx!=flow_wheel_idx_null(); ) {
+     //     ulong next = pool[ idx ].next;
+     //     ... handle expiration of pool[ idx ] ...
+     //     idx = next;
+     //   }
+
+     ulong flow_wheel_advance( flow_wheel_t * wheel, flow_t * pool, ulong now );
+
+   The units of time are up to the caller (e.g. fd_tickcount() or
+   fd_log_wallclock() shifted right to get a coarser resolution, slot
+   numbers, etc).  Timers are exact at the resolution of these units
+   (i.e. a timer with expire e is returned by the first advance to a
+   time at or after e).  Time is a ulong that should be monotonically
+   non-decreasing.
+
+   The wheel has TWHEEL_LVL_CNT levels of 2^TWHEEL_LG_SLOT_CNT slots.
+   Level l holds the timers that expire in the current rotation of level
+   l+1 (i.e. whose expiration time agrees with the current time in all
+   digits above digit l, where digits are TWHEEL_LG_SLOT_CNT bits wide)
+   and are bucketed by digit l.  When time reaches a slot at a level
+   above 0, the slot's timers are redistributed to lower levels.  Timers
+   beyond the range of the top level are held in an overflow list.
+   When advance runs out of timers in the current top level rotation,
+   it jumps directly to the rotation of the earliest overflow timer and
+   redistributes the overflow list (this is O(overflow cnt) so the
+   wheel should be configured such that the overflow list is rarely
+   used).  Occupancy bitmaps let advance skip empty slots such that long
+   idle periods are cheap.
+
+   For performance, none of the functions do any error checking (e.g.
+   scheduling an already scheduled element, canceling an element not
+   scheduled, etc).
+
+   You can do this as often as you like in a compilation unit to get
+   different types of timer wheels.  Since it is all static inline, it
+   is fine to do this in a header too.  Additional options to fine tune
+   this are detailed below. */
+
+#include "../bits/fd_bits.h"
+
+#ifndef TWHEEL_NAME
+#error "Define TWHEEL_NAME"
+#endif
+
+#ifndef TWHEEL_T
+#error "Define TWHEEL_T"
+#endif
+
+/* TWHEEL_{PREV,NEXT,EXPIRE} give the names of the ulong fields of a
+   TWHEEL_T used by the wheel.  While an element is scheduled, the wheel
+   owns these fields. */
+
+#ifndef TWHEEL_PREV
+#define TWHEEL_PREV prev
+#endif
+
+#ifndef TWHEEL_NEXT
+#define TWHEEL_NEXT next
+#endif
+
+#ifndef TWHEEL_EXPIRE
+#define TWHEEL_EXPIRE expire
+#endif
+
+/* TWHEEL_LG_SLOT_CNT gives the lg number of slots per level and
+   TWHEEL_LVL_CNT gives the number of levels.  The wheel covers timers
+   up to 2^(TWHEEL_LG_SLOT_CNT*TWHEEL_LVL_CNT) time units in the future
+   without using the overflow list.  The defaults cover 2^32 time units
+   in a ~8 KiB footprint. */
+
+#ifndef TWHEEL_LG_SLOT_CNT
+#define TWHEEL_LG_SLOT_CNT 8
+#endif
+
+#ifndef TWHEEL_LVL_CNT
+#define TWHEEL_LVL_CNT 4
+#endif
+
+#if !((1<=TWHEEL_LG_SLOT_CNT) && (TWHEEL_LG_SLOT_CNT<=16))
+#error "TWHEEL_LG_SLOT_CNT should be in [1,16]"
+#endif
+
+#if !((1<=TWHEEL_LVL_CNT) && ((TWHEEL_LG_SLOT_CNT*TWHEEL_LVL_CNT)<64))
+#error "TWHEEL_LVL_CNT should be positive and TWHEEL_LG_SLOT_CNT*TWHEEL_LVL_CNT should be less than 64"
+#endif
+
+/* Implementation *****************************************************/
+
+#define TWHEEL_(n) FD_EXPAND_THEN_CONCAT3(TWHEEL_NAME,_,n)
+
+#define TWHEEL_PRIVATE_SLOT_CNT (1UL<<(TWHEEL_LG_SLOT_CNT))
+#define TWHEEL_PRIVATE_SLOT_MSK (TWHEEL_PRIVATE_SLOT_CNT-1UL)
+#define TWHEEL_PRIVATE_OCC_CNT  ((TWHEEL_PRIVATE_SLOT_CNT+63UL)>>6)
+#define TWHEEL_PRIVATE_OVFL     ((ulong)(TWHEEL_LVL_CNT)*TWHEEL_PRIVATE_SLOT_CNT) /* Overflow list */
+#define TWHEEL_PRIVATE_DUE      (TWHEEL_PRIVATE_OVFL+1UL)                         /* Already expired list */
+#define TWHEEL_PRIVATE_HEAD     (1UL<<63)                                          /* prev of a list head */
+
+struct TWHEEL_(private) {
+  ulong now;
+  ulong cnt;
+  ulong occ [ TWHEEL_LVL_CNT ][ TWHEEL_PRIVATE_OCC_CNT ]; /* Bit s of level l set if slot s of level l is non-empty */
+  ulong head[ TWHEEL_PRIVATE_DUE+1UL ];                  /* Indexed by list id, idx of the list head or idx_null */
+};
+
+typedef struct TWHEEL_(private) TWHEEL_(t);
+
+FD_PROTOTYPES_BEGIN
+
+/* Private APIs *******************************************************/
+
+/* Lists are doubly linked through the elements.  The prev field of a
+   list head is TWHEEL_PRIVATE_HEAD | list (pool indices are assumed to
+   be less than 2^63) such that cancel can find the list and update the
+   list head and the occupancy bitmap in O(1).  List id l*SLOT_CNT+s is
+   slot s of level l. */
+
+static inline void
+TWHEEL_(private_push)( TWHEEL_(t) * wheel,
+                       TWHEEL_T *   pool,
+                       ulong        idx,
+                       ulong        list ) {
+  ulong head = wheel->head[ list ];
+  pool[ idx ].TWHEEL_PREV = TWHEEL_PRIVATE_HEAD | list;
+  pool[ idx ].TWHEEL_NEXT = head;
+  if( head!=ULONG_MAX ) pool[ head ].TWHEEL_PREV = idx;
+  wheel->head[ list ] = idx;
+  if( FD_LIKELY( list<TWHEEL_PRIVATE_OVFL ) ) {
+    ulong lvl = list >> (TWHEEL_LG_SLOT_CNT);
+    ulong s   = list & TWHEEL_PRIVATE_SLOT_MSK;
+    wheel->occ[ lvl ][ s>>6 ] |= 1UL << (s & 63UL);
+  }
+}
+
+/* private_place puts element idx in the list appropriate for its
+   expiration time given the wheel's current time. */
+
+static inline void
+TWHEEL_(private_place)( TWHEEL_(t) * wheel,
+                        TWHEEL_T *   pool,
+                        ulong        idx ) {
+  ulong expire = pool[ idx ].TWHEEL_EXPIRE;
+  ulong now    = wheel->now;
+  ulong list;
+  if( FD_UNLIKELY( expire<=now ) ) list = TWHEEL_PRIVATE_DUE;
+  else {
+    ulong lvl = (ulong)fd_ulong_find_msb( expire ^ now ) / (ulong)(TWHEEL_LG_SLOT_CNT);
+    if( FD_UNLIKELY( lvl>=(ulong)(TWHEEL_LVL_CNT) ) ) list = TWHEEL_PRIVATE_OVFL;
+    else list = (lvl << (TWHEEL_LG_SLOT_CNT)) | ((expire >> ((ulong)(TWHEEL_LG_SLOT_CNT)*lvl)) & TWHEEL_PRIVATE_SLOT_MSK);
+  }
+  TWHEEL_(private_push)( wheel, pool, idx, list );
+}
+
+/* private_next_slot returns the first non-empty slot after slot s in
+   the level with occupancy bitmap occ or SLOT_CNT if none. */
+
+FD_FN_PURE static inline ulong
+TWHEEL_(private_next_slot)( ulong const * occ,
+                            ulong         s ) {
+  s++;
+  if( FD_UNLIKELY( s>=TWHEEL_PRIVATE_SLOT_CNT ) ) return TWHEEL_PRIVATE_SLOT_CNT;
+  ulong w = s >> 6;
+  ulong m = occ[ w ] & ((~0UL) << (s & 63UL));
+  for(;;) {
+    if( m ) return (w<<6) | (ulong)fd_ulong_find_lsb( m );
+    if( ++w>=TWHEEL_PRIVATE_OCC_CNT ) return TWHEEL_PRIVATE_SLOT_CNT;
+    m = occ[ w ];
+  }
+}
+
+/* Public APIS ********************************************************/
+
+FD_FN_CONST static inline ulong TWHEEL_(align)    ( void ) { return alignof(TWHEEL_(t)); }
+FD_FN_CONST static inline ulong TWHEEL_(footprint)( void ) { return sizeof (TWHEEL_(t)); }
+
+static inline void *
+TWHEEL_(new)( void * shmem,
+              ulong  now ) {
+  TWHEEL_(t) * wheel = (TWHEEL_(t) *)shmem;
+  wheel->now = now;
+  wheel->cnt = 0UL;
+  memset( wheel->occ, 0, sizeof(wheel->occ) );
+  for( ulong list=0UL; list<=TWHEEL_PRIVATE_DUE; list++ ) wheel->head[ list ] = ULONG_MAX;
+  return shmem;
+}
+
+static inline TWHEEL_(t) * TWHEEL_(join  )( void *       shwheel ) { return (TWHEEL_(t) *)shwheel; }
+static inline void *       TWHEEL_(leave )( TWHEEL_(t) * wheel   ) { return (void *)wheel;         }
+static inline void *       TWHEEL_(delete)( void *       shwheel ) { return shwheel;               }
+
+FD_FN_CONST static inline ulong TWHEEL_(idx_null)( void                      ) { return ULONG_MAX;  }
+FD_FN_PURE  static inline ulong TWHEEL_(now)     ( TWHEEL_(t) const * wheel ) { return wheel->now; }
+FD_FN_PURE  static inline ulong TWHEEL_(cnt)     ( TWHEEL_(t) const * wheel ) { return wheel->cnt; }
+
+static inline void
+TWHEEL_(schedule)( TWHEEL_(t) * wheel,
+                   TWHEEL_T *   pool,
+                   ulong        idx,
+                   ulong        expire ) {
+  pool[ idx ].TWHEEL_EXPIRE = expire;
+  TWHEEL_(private_place)( wheel, pool, idx );
+  wheel->cnt++;
+}
+
+static inline void
+TWHEEL_(cancel)( TWHEEL_(t) * wheel,
+                 TWHEEL_T *   pool,
+                 ulong        idx ) {
+  ulong prev = pool[ idx ].TWHEEL_PREV;
+  ulong next = pool[ idx ].TWHEEL_NEXT;
+  if( next!=ULONG_MAX ) pool[ next ].TWHEEL_PREV = prev;
+  if( FD_LIKELY( !(prev & TWHEEL_PRIVATE_HEAD) ) ) pool[ prev ].TWHEEL_NEXT = next;
+  else {
+    ulong list = prev & ~TWHEEL_PRIVATE_HEAD;
+    wheel->head[ list ] = next;
+    if( (next==ULONG_MAX) & (list<TWHEEL_PRIVATE_OVFL) ) {
+      ulong lvl = list >> (TWHEEL_LG_SLOT_CNT);
+      ulong s   = list & TWHEEL_PRIVATE_SLOT_MSK;
+      wheel->occ[ lvl ][ s>>6 ] &= ~(1UL << (s & 63UL));
+    }
+  }
+  wheel->cnt--;
+}
+
+FD_FN_UNUSED static ulong /* Work around -Winline */
+TWHEEL_(advance)( TWHEEL_(t) * wheel,
+                  TWHEEL_T *   pool,
+                  ulong        now ) {
+  ulong exp_head = ULONG_MAX;
+  ulong exp_tail = ULONG_MAX;
+  ulong exp_cnt  = 0UL;
+
+# define TWHEEL_PRIVATE_EXPIRE( idx ) do {                          \
+    ulong _idx = (idx);                                             \
+    pool[ _idx ].TWHEEL_NEXT = ULONG_MAX;                           \
+    if( exp_tail==ULONG_MAX ) exp_head = _idx;                      \
+    else                      pool[ exp_tail ].TWHEEL_NEXT = _idx;  \
+    exp_tail = _idx;                                                \
+    exp_cnt++;                                                      \
+  } while(0)
+
+  /* Timers that were scheduled in the past */
+
+  ulong idx = wheel->head[ TWHEEL_PRIVATE_DUE ];
+  wheel->head[ TWHEEL_PRIVATE_DUE ] = ULONG_MAX;
+  while( idx!=ULONG_MAX ) {
+    ulong next = pool[ idx ].TWHEEL_NEXT;
+    TWHEEL_PRIVATE_EXPIRE( idx );
+    idx = next;
+  }
+
+  /* Repeatedly jump to the earliest time a non-empty slot is reached
+     (at most now), expiring its timers if level 0 and redistributing
+     them otherwise.  Since a level holds only timers in the current
+     rotation of the level above, the earliest non-empty slot is the
+     first one after the current time in the lowest non-empty level.
+     Slots at or before the current time's digit in each level are
+     empty. */
+
+  while( wheel->now<now ) {
+    ulong t0   = wheel->now;
+    ulong t    = ULONG_MAX;
+    ulong list = ULONG_MAX;
+    ulong lvl  = 0UL;
+    for( ; lvl<(ulong)(TWHEEL_LVL_CNT); lvl++ ) {
+      ulong shift = (ulong)(TWHEEL_LG_SLOT_CNT)*lvl;
+      ulong s     = TWHEEL_(private_next_slot)( wheel->occ[ lvl ], (t0 >> shift) & TWHEEL_PRIVATE_SLOT_MSK );
+      if( s<TWHEEL_PRIVATE_SLOT_CNT ) {
+        ulong hi_shift = shift + (ulong)(TWHEEL_LG_SLOT_CNT);
+        t    = ((t0 >> hi_shift) << hi_shift) | (s << shift);
+        list = (lvl << (TWHEEL_LG_SLOT_CNT)) | s;
+        break;
+      }
+    }
+    if( FD_UNLIKELY( (list==ULONG_MAX) & (wheel->head[ TWHEEL_PRIVATE_OVFL ]!=ULONG_MAX) ) ) {
+
+      /* The wheel is empty in the current top level rotation.  Jump to
+         the start of the rotation holding the earliest overflow timer
+         (after t0 as the timer is in a later rotation). */
+
+      ulong span = (ulong)(TWHEEL_LG_SLOT_CNT)*(ulong)(TWHEEL_LVL_CNT);
+      ulong emin = ULONG_MAX;
+      for( ulong i=wheel->head[ TWHEEL_PRIVATE_OVFL ]; i!=ULONG_MAX; i=pool[ i ].TWHEEL_NEXT )
+        emin = fd_ulong_min( emin, pool[ i ].TWHEEL_EXPIRE );
+      t    = (emin >> span) << span;
+      list = TWHEEL_PRIVATE_OVFL;
+    }
+
+    if( (t>now) | (list==ULONG_MAX) ) { wheel->now = now; break; }
+    wheel->now = t;
+
+    idx = wheel->head[ list ];
+    wheel->head[ list ] = ULONG_MAX;
+    if( FD_LIKELY( list<TWHEEL_PRIVATE_OVFL ) ) {
+      ulong s = list & TWHEEL_PRIVATE_SLOT_MSK;
+      wheel->occ[ lvl ][ s>>6 ] &= ~(1UL << (s & 63UL));
+    }
+
+    if( !lvl ) { /* All expire at t */
+      while( idx!=ULONG_MAX ) {
+        ulong next = pool[ idx ].TWHEEL_NEXT;
+        TWHEEL_PRIVATE_EXPIRE( idx );
+        idx = next;
+      }
+    } else { /* Redistribute (timers expiring at t expire now) */
+      while( idx!=ULONG_MAX ) {
+        ulong next = pool[ idx ].TWHEEL_NEXT;
+        if( pool[ idx ].TWHEEL_EXPIRE<=t ) TWHEEL_PRIVATE_EXPIRE( idx );
+        else                               TWHEEL_(private_place)( wheel, pool, idx );
+        idx = next;
+      }
+    }
+  }
+
+# undef TWHEEL_PRIVATE_EXPIRE
+
+  wheel->cnt -= exp_cnt;
+  return exp_head;
+}
+
+FD_PROTOTYPES_END
+
+#undef TWHEEL_PRIVATE_HEAD
+#undef TWHEEL_PRIVATE_DUE
+#undef TWHEEL_PRIVATE_OVFL
+#undef TWHEEL_PRIVATE_OCC_CNT
+#undef TWHEEL_PRIVATE_SLOT_MSK
+#undef TWHEEL_PRIVATE_SLOT_CNT
+#undef TWHEEL_
+
+/* End implementation *************************************************/
+
+#undef TWHEEL_LVL_CNT
+#undef TWHEEL_LG_SLOT_CNT
+#undef TWHEEL_EXPIRE
+#undef TWHEEL_NEXT
+#undef TWHEEL_PREV
+#undef TWHEEL_T
+#undef TWHEEL_NAME
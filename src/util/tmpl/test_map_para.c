@@ -0,0 +1,250 @@
+#include "../fd_util.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+struct ele {
+  ulong key;
+  uint  next;
+  uint  mod_cnt; /* Number of times this element was modified in place */
+  ulong val;
+  ulong chk;     /* == fd_ulong_hash( key ^ val ^ mod_cnt ), used to detect torn reads */
+};
+
+typedef struct ele ele_t;
+
+#define MAP_NAME map
+#define MAP_T    ele_t
+#include "fd_map_para.c"
+
+#define BUCKET_CNT (1024UL)
+#define ELE_MAX    (4096UL)
+
+static uchar mem[ 262144 ] __attribute__((aligned(128)));
+
+static int     go = 0;
+static map_t * _map;
+static ulong   _iter_cnt;
+
+static inline ulong ele_chk( ele_t const * e ) { return fd_ulong_hash( e->key ^ e->val ^ (ulong)e->mod_cnt ); }
+
+/* test_main stresses the map with a random mix of operations.  Tile
+   tile_idx owns keys tile_idx+1+tile_cnt*j (j in [0,key_cnt)) and
+   validates the results of operations on these against a local
+   reference.  Tiles also query keys owned by other tiles to validate
+   that concurrent readers always see untorn elements. */
+
+static int
+test_main( int     argc,
+           char ** argv ) {
+  (void)argc; (void)argv;
+
+  while( !FD_VOLATILE_CONST( go ) ) FD_SPIN_PAUSE();
+
+  map_t * map      = FD_VOLATILE_CONST( _map      );
+  ulong   iter_cnt = FD_VOLATILE_CONST( _iter_cnt );
+  ulong   tile_idx = fd_tile_idx();
+  ulong   tile_cnt = fd_tile_cnt();
+  ulong   key_cnt  = fd_ulong_min( ELE_MAX / tile_cnt, 1024UL );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, (uint)tile_idx, 0UL ) );
+
+  ulong ref_val[ 1024 ]; /* 0 if key j not in the map */
+  uint  ref_mod[ 1024 ];
+  for( ulong j=0UL; j<key_cnt; j++ ) ref_val[ j ] = 0UL, ref_mod[ j ] = 0U;
+
+  for( ulong iter=0UL; iter<iter_cnt; iter++ ) {
+    uint  r   = fd_rng_uint( rng );
+    int   op  = (int)(r & 7U); r >>= 3;
+    ulong j   = fd_rng_ulong_roll( rng, key_cnt );
+    ulong key = tile_idx + 1UL + tile_cnt*j;
+
+    ele_t ele[1];
+    switch( op ) {
+
+    case 0: case 1: { /* insert */
+      ele->key     = key;
+      ele->mod_cnt = 0U;
+      ele->val     = fd_rng_ulong( rng ) | 1UL;
+      ele->chk     = ele_chk( ele );
+      int err = map_insert( map, ele );
+      if( ref_val[ j ] ) FD_TEST( err==FD_MAP_PARA_ERR_KEY );
+      else {
+        FD_TEST( err==FD_MAP_PARA_SUCCESS );
+        ref_val[ j ] = ele->val;
+        ref_mod[ j ] = 0U;
+      }
+      break;
+    }
+
+    case 2: { /* remove */
+      int err = map_remove( map, key, ele );
+      if( !ref_val[ j ] ) FD_TEST( err==FD_MAP_PARA_ERR_KEY );
+      else {
+        FD_TEST( err==FD_MAP_PARA_SUCCESS );
+        FD_TEST( ele->key==key ); FD_TEST( ele->val==ref_val[ j ] ); FD_TEST( ele->mod_cnt==ref_mod[ j ] );
+        FD_TEST( ele->chk==ele_chk( ele ) );
+        ref_val[ j ] = 0UL;
+      }
+      break;
+    }
+
+    case 3: { /* modify */
+      ulong   lock;
+      ele_t * e = map_modify_prepare( map, key, &lock );
+      if( !ref_val[ j ] ) FD_TEST( !e );
+      else {
+        FD_TEST( e ); FD_TEST( e->key==key ); FD_TEST( e->val==ref_val[ j ] );
+        e->mod_cnt++;
+        e->val = fd_ulong_hash( e->val ) | 1UL;
+        e->chk = ele_chk( e );
+        ref_val[ j ] = e->val;
+        ref_mod[ j ] = e->mod_cnt;
+        map_modify_publish( map, lock );
+      }
+      break;
+    }
+
+    case 4: case 5: { /* query own key */
+      int err = map_query( map, key, ele );
+      if( !ref_val[ j ] ) FD_TEST( err==FD_MAP_PARA_ERR_KEY );
+      else {
+        FD_TEST( err==FD_MAP_PARA_SUCCESS );
+        FD_TEST( ele->key==key ); FD_TEST( ele->val==ref_val[ j ] ); FD_TEST( ele->mod_cnt==ref_mod[ j ] );
+        FD_TEST( ele->chk==ele_chk( ele ) );
+      }
+      break;
+    }
+
+    default: { /* query a key potentially owned by another tile */
+      ulong other = 1UL + fd_rng_ulong_roll( rng, tile_cnt*key_cnt );
+      int err = map_query( map, other, ele );
+      if( !err ) { FD_TEST( ele->key==other ); FD_TEST( ele->chk==ele_chk( ele ) ); }
+      else       FD_TEST( err==FD_MAP_PARA_ERR_KEY );
+      break;
+    }
+
+    }
+  }
+
+  /* Clean up our keys */
+
+  for( ulong j=0UL; j<key_cnt; j++ ) {
+    ulong key = tile_idx + 1UL + tile_cnt*j;
+    FD_TEST( map_remove( map, key, NULL )==(ref_val[ j ] ? FD_MAP_PARA_SUCCESS : FD_MAP_PARA_ERR_KEY) );
+  }
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+  return 0;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  _iter_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--iter-cnt", NULL, 1000000UL );
+
+  ulong tile_cnt = fd_tile_cnt();
+
+  /* Test single threaded API */
+
+  FD_TEST( fd_ulong_is_pow2( map_align() ) );
+  FD_TEST( !map_footprint( 0UL,        ELE_MAX       ) );
+  FD_TEST( !map_footprint( 3UL,        ELE_MAX       ) );
+  FD_TEST( !map_footprint( BUCKET_CNT, 0UL           ) );
+  FD_TEST( !map_footprint( BUCKET_CNT, (ulong)UINT_MAX ) );
+  ulong footprint = map_footprint( BUCKET_CNT, ELE_MAX );
+  FD_TEST( footprint && fd_ulong_is_aligned( footprint, map_align() ) );
+  if( FD_UNLIKELY( footprint>sizeof(mem) ) ) FD_LOG_ERR(( "adjust mem to support this test" ));
+
+  FD_TEST( !map_new( NULL,    BUCKET_CNT, ELE_MAX, 1234UL ) ); /* NULL shmem */
+  FD_TEST( !map_new( mem+1UL, BUCKET_CNT, ELE_MAX, 1234UL ) ); /* misaligned */
+  FD_TEST( !map_new( mem,     3UL,        ELE_MAX, 1234UL ) ); /* bad bucket_cnt */
+
+  void * shmap = map_new( mem, BUCKET_CNT, ELE_MAX, 1234UL ); FD_TEST( shmap==(void *)mem );
+
+  FD_TEST( !map_join( NULL    ) ); /* NULL shmap */
+  FD_TEST( !map_join( mem+1UL ) ); /* misaligned */
+
+  map_t * map = map_join( shmap ); FD_TEST( map );
+
+  FD_TEST( map_bucket_cnt( map )==BUCKET_CNT );
+  FD_TEST( map_ele_max   ( map )==ELE_MAX    );
+  FD_TEST( map_seed      ( map )==1234UL     );
+  FD_TEST( map_key_cnt   ( map )==0UL        );
+
+  ele_t ele[1];
+  ulong lock;
+  for( ulong key=1UL; key<=ELE_MAX; key++ ) {
+    ele->key = key; ele->val = 2UL*key; ele->mod_cnt = 0U;
+    FD_TEST( map_query( map, key, ele )==FD_MAP_PARA_ERR_KEY );
+    ele->key = key; ele->val = 2UL*key;
+    FD_TEST( map_insert( map, ele )==FD_MAP_PARA_SUCCESS );
+    FD_TEST( map_insert( map, ele )==(key<ELE_MAX ? FD_MAP_PARA_ERR_KEY : FD_MAP_PARA_ERR_FULL) );
+    FD_TEST( map_key_cnt( map )==key );
+  }
+  ele->key = ELE_MAX+1UL;
+  FD_TEST( map_insert( map, ele )==FD_MAP_PARA_ERR_FULL );
+  FD_TEST( !map_modify_prepare( map, ELE_MAX+1UL, &lock ) );
+
+  for( ulong key=1UL; key<=ELE_MAX; key++ ) {
+    FD_TEST( map_query( map, key, ele )==FD_MAP_PARA_SUCCESS ); FD_TEST( ele->key==key ); FD_TEST( ele->val==2UL*key );
+    ele_t * e = map_modify_prepare( map, key, &lock ); FD_TEST( e ); FD_TEST( e->key==key );
+    e->val++;
+    map_modify_publish( map, lock );
+  }
+
+  for( ulong key=ELE_MAX; key; key-- ) {
+    FD_TEST( map_remove( map, key, ele )==FD_MAP_PARA_SUCCESS ); FD_TEST( ele->key==key ); FD_TEST( ele->val==2UL*key+1UL );
+    FD_TEST( map_remove( map, key, NULL )==FD_MAP_PARA_ERR_KEY );
+    FD_TEST( map_query ( map, key, ele  )==FD_MAP_PARA_ERR_KEY );
+    FD_TEST( map_key_cnt( map )==key-1UL );
+  }
+
+  /* Stress test concurrent use */
+
+  FD_LOG_NOTICE(( "Testing concurrent use with --iter-cnt %lu on %lu tile(s)", _iter_cnt, tile_cnt ));
+
+  _map = map;
+
+  fd_tile_exec_t * exec[ FD_TILE_MAX ];
+  for( ulong tile_idx=1UL; tile_idx<tile_cnt; tile_idx++ ) exec[ tile_idx ] = fd_tile_exec_new( tile_idx, test_main, 0, NULL );
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( go ) = 1;
+  FD_COMPILER_MFENCE();
+
+  test_main( 0, NULL );
+
+  for( ulong tile_idx=1UL; tile_idx<tile_cnt; tile_idx++ ) fd_tile_exec_delete( exec[ tile_idx ], NULL );
+
+  FD_TEST( map_key_cnt( map )==0UL );
+
+  /* Make sure all the elements were returned to the unused stack */
+
+  for( ulong key=1UL; key<=ELE_MAX; key++ ) { ele->key = key; FD_TEST( map_insert( map, ele )==FD_MAP_PARA_SUCCESS ); }
+  ele->key = ELE_MAX+1UL;
+  FD_TEST( map_insert( map, ele )==FD_MAP_PARA_ERR_FULL );
+
+  FD_TEST( map_leave ( map   )==shmap );
+  FD_TEST( !map_delete( NULL ) );
+  FD_TEST( map_delete( shmap )==(void *)mem );
+  FD_TEST( !map_join( shmap ) ); /* bad magic */
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
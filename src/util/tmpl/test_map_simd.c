@@ -0,0 +1,239 @@
+#include "../fd_util.h"
+
+#define LG_SLOT_CNT 9
+#define MEMOIZE     0
+
+struct pair {
+  ulong mykey;
+# if MEMOIZE
+  uint  myhash;
+# endif
+  uint  val;
+};
+
+typedef struct pair pair_t;
+
+#define MAP_NAME    map
+#define MAP_T       pair_t
+#define MAP_MEMOIZE MEMOIZE
+#define MAP_KEY     mykey
+#if MEMOIZE
+#define MAP_HASH    myhash
+#endif
+#include "fd_map_simd.c"
+
+/* bad is map with a terrible hash function (all keys have the same tag
+   and probe sequences start at one of 4 slots) to stress long probe
+   sequences that span many groups and wrap around. */
+
+struct bad {
+  ulong key;
+  uint  hash;
+  uint  val;
+};
+
+typedef struct bad bad_t;
+
+#define MAP_NAME     bad
+#define MAP_T        bad_t
+#define MAP_KEY_HASH(k) ((uint)((k) & 3UL))
+#include "fd_map_simd.c"
+
+uchar mem[ 16384 ] __attribute__((aligned(8)));
+
+static void
+shuffle_pair( fd_rng_t * rng,
+              pair_t *   pair,
+              ulong      cnt ) {
+  for( ulong i=1UL; i<cnt; i++ ) {
+    ulong j  = fd_rng_ulong_roll( rng, i+1UL );
+    pair_t t = pair[i]; pair[i] = pair[j]; pair[j] = t;
+  }
+}
+
+/* test_bad does random inserts, removes and queries against a reference
+   for a bad map with 2^lg_slot_cnt slots. */
+
+static void
+test_bad( fd_rng_t * rng,
+          int        lg_slot_cnt ) {
+  ulong key_universe = 2UL << lg_slot_cnt;
+  ulong ref[ 2048 ]; /* ref[k-1] val for key k, 0 if k is not in the map */
+  FD_TEST( key_universe<=2048UL );
+  for( ulong k=0UL; k<key_universe; k++ ) ref[k] = 0UL;
+
+  FD_TEST( bad_footprint( lg_slot_cnt )<=16384UL );
+  bad_t * map = bad_join( bad_new( mem, lg_slot_cnt ) ); FD_TEST( map );
+
+  ulong slot_cnt = bad_slot_cnt( map );
+  ulong key_max  = bad_key_max ( map );
+  FD_TEST( key_max<slot_cnt );
+  FD_TEST( key_max==slot_cnt-fd_ulong_max( slot_cnt/8UL, 1UL ) );
+
+  ulong cnt = 0UL;
+  for( ulong iter=0UL; iter<100000UL; iter++ ) {
+    ulong k = 1UL + fd_rng_ulong_roll( rng, key_universe );
+    uint  r = fd_rng_uint( rng );
+    bad_t * p = bad_query( map, k, NULL );
+    FD_TEST( (!!p)==(!!ref[k-1UL]) );
+    if( p ) {
+      FD_TEST( p->key==k ); FD_TEST( (ulong)p->val==ref[k-1UL] );
+      FD_TEST( !bad_insert( map, k ) );
+      if( r & 1U ) { bad_remove( map, p ); ref[k-1UL] = 0UL; cnt--; }
+    } else {
+      p = bad_insert( map, k );
+      if( cnt<key_max ) {
+        FD_TEST( p && p->key==k && p->hash==bad_key_hash( k ) );
+        p->val = r | 1U; ref[k-1UL] = (ulong)p->val; cnt++;
+      } else {
+        FD_TEST( !p );
+      }
+    }
+    FD_TEST( bad_key_cnt( map )==cnt );
+  }
+
+  /* Verify the full slot set matches the reference */
+
+  ulong full_cnt = 0UL;
+  for( ulong slot=0UL; slot<slot_cnt; slot++ ) {
+    ulong k = map[slot].key;
+    if( bad_key_inval( k ) ) continue;
+    FD_TEST( (ulong)map[slot].val==ref[k-1UL] );
+    full_cnt++;
+  }
+  FD_TEST( full_cnt==cnt );
+
+  FD_TEST( bad_delete( bad_leave( map ) )==(void *)mem );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  pair_t ref[511];
+  pair_t tst[511];
+
+  ulong align     = map_align();
+  ulong footprint = map_footprint( LG_SLOT_CNT );
+  if( FD_UNLIKELY( (footprint>16384UL) | (align>8UL) ) ) { FD_LOG_WARNING(( "skip: adjust mem to support this test" )); return 0; }
+  FD_TEST( fd_ulong_is_pow2   ( align            ) );
+  FD_TEST( fd_ulong_is_aligned( footprint, align ) );
+
+  void   * shmap = map_new ( mem, LG_SLOT_CNT ); FD_TEST( shmap );
+  pair_t * map   = map_join( shmap );            FD_TEST( map   );
+
+  FD_TEST( map_key_cnt    ( map )==0UL                          );
+  FD_TEST( map_key_max    ( map )==7UL*map_slot_cnt( map )/8UL  );
+  FD_TEST( map_lg_slot_cnt( map )==LG_SLOT_CNT                  );
+  FD_TEST( map_slot_cnt   ( map )==fd_ulong_pow2( LG_SLOT_CNT ) );
+
+  ulong max = map_key_max( map ); /* Take map right to its algorithmic limit */
+  if( FD_UNLIKELY( max>511UL ) ) { FD_LOG_WARNING(( "skip: adjust ref and tst to support this test" )); return 0; }
+  for( ulong idx=0UL; idx<max; idx++ ) {
+    ref[idx].mykey  = ((fd_rng_ulong( rng ) | 1UL) << 9) | idx; /* Every map key is unique and non-zero */
+#   if MEMOIZE
+    ref[idx].myhash = map_key_hash( ref[idx].mykey );
+#   endif
+    ref[idx].val    = fd_rng_uint( rng );
+    tst[idx] = ref[idx];
+  }
+
+  ulong slot_cnt = map_slot_cnt( map );
+  for( ulong slot_idx=0UL; slot_idx<slot_cnt; slot_idx++ ) FD_TEST( map_slot_idx( map, &map[slot_idx] )==slot_idx );
+
+  FD_TEST( map_key_inval( map_key_null() ) );
+  FD_TEST( map_key_equal( map_key_null(), map_key_null() ) );
+  for( ulong i=0UL; i<max; i++ ) {
+    FD_TEST( !map_key_inval( ref[i].mykey ) );
+    FD_TEST( !map_key_equal( ref[i].mykey, map_key_null() ) );
+    FD_TEST(  map_key_equal( ref[i].mykey, ref[i].mykey ) );
+    for( ulong j=0UL; j<i; j++ ) FD_TEST( !map_key_equal( ref[i].mykey, ref[j].mykey ) );
+  }
+
+  for( ulong iter=0UL; iter<100UL; iter++ ) {
+    if( !(iter % 10UL) ) FD_LOG_NOTICE(( "Iter %lu", iter ));
+    shuffle_pair( rng, tst, max ); /* Generate a randomized insertion order */
+
+    /* Map is empty at this point */
+
+    for( ulong i=0UL; i<max; i++ ) {
+      ulong ki = tst[i].mykey;
+      uint  vi = tst[i].val;
+
+      /* Make sure we can find all values inserted so far */
+      for( ulong j=0UL; j<i; j++ ) {
+        pair_t * p = map_query( map, tst[j].mykey, NULL );
+        FD_TEST( p && p->val==tst[j].val );
+      }
+
+      /* Make sure ki isn't already in the map */
+      FD_TEST( !map_query( map, ki, NULL ) );
+
+      /* Insert the value */
+      pair_t * p = map_insert( map, ki );
+      FD_TEST( p && map_key_equal( p->mykey, ki ) );
+      p->val = vi;
+
+      /* Make sure inserting again fails */
+      FD_TEST( map_key_cnt( map )==(i+1UL) );
+      FD_TEST( !map_insert( map, ki ) );
+      FD_TEST( map_key_cnt( map )==(i+1UL) );
+
+      /* Make sure we can look up the inserted value */
+      pair_t * q = map_query( map, tst[i].mykey, NULL );
+      FD_TEST( q==p && map_key_equal( q->mykey, ki ) && q->val==vi );
+    }
+
+    /* Map is full at this point */
+
+    FD_TEST( !map_insert( map, 1UL ) );
+
+    shuffle_pair( rng, tst, max ); /* Generate a different randomized deletion order */
+
+    for( ulong i=0UL; i<max; i++ ) {
+      ulong ki = tst[i].mykey;
+      uint  vi = tst[i].val;
+
+      /* Make we've deleted all entries before i */
+      for( ulong j=0UL; j<i; j++ ) FD_TEST( !map_query( map, tst[j].mykey, NULL ) );
+
+      /* Look up entry i and make sure it is intact */
+      pair_t * p = map_query( map, ki, NULL );
+      FD_TEST( p && map_key_equal( p->mykey, ki ) && p->val==vi );
+
+      /* Delete entry i and verify the deletion */
+      FD_TEST( map_key_cnt( map )==(max-i) );
+      map_remove( map, p );
+      FD_TEST( map_key_cnt( map )==(max-i-1UL) );
+      FD_TEST( !map_query( map, ki, NULL ) );
+
+      /* Make sure all remaining entries are intact */
+      for( ulong j=i+1UL; j<max; j++ ) {
+        pair_t * p = map_query( map, tst[j].mykey, NULL );
+        FD_TEST( p && map_key_equal( p->mykey, tst[j].mykey ) && p->val==tst[j].val );
+      }
+    }
+
+    /* Map is empty at this point */
+  }
+
+  FD_TEST( map_leave ( map   )==shmap       );
+  FD_TEST( map_delete( shmap )==(void *)mem );
+
+  /* Stress maps with tiny to modest slot counts (smaller and larger
+     than a group) with heavy collisions */
+
+  for( int lg_slot_cnt=0; lg_slot_cnt<=9; lg_slot_cnt++ ) {
+    FD_LOG_NOTICE(( "Testing bad map (lg_slot_cnt %i)", lg_slot_cnt ));
+    test_bad( rng, lg_slot_cnt );
+  }
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
@@ -5,16 +5,82 @@
 #define TYPE float
 #define MAX  1024UL
 
-#define SORT_NAME        sort_up
-#define SORT_KEY_T       TYPE
-#define SORT_BEFORE(a,b) ((a)<(b))
+#define SORT_NAME         sort_up
+#define SORT_KEY_T        TYPE
+#define SORT_BEFORE(a,b)  ((a)<(b))
+#define SORT_RADIX_KEY(k) fd_sort_radix_key_float( (k) )
 #include "fd_sort.c"
 
-#define SORT_NAME        sort_dn
-#define SORT_KEY_T       TYPE
-#define SORT_BEFORE(a,b) ((a)>(b))
+#define SORT_NAME         sort_dn
+#define SORT_KEY_T        TYPE
+#define SORT_BEFORE(a,b)  ((a)>(b))
+#define SORT_RADIX_KEY(k) (~fd_sort_radix_key_float( (k) ))
 #include "fd_sort.c"
 
+/* 64-bit keys with the sorting network and radix options enabled.  The
+   ref variants use the default insertion sort for small partitions. */
+
+#define SORT_NAME         sort_long
+#define SORT_KEY_T        long
+#define SORT_BEFORE(a,b)  ((a)<(b))
+#define SORT_NETWORK      1
+#define SORT_RADIX_KEY(k) fd_sort_radix_key_long( (k) )
+#include "fd_sort.c"
+
+#define SORT_NAME         sort_ulong
+#define SORT_KEY_T        ulong
+#define SORT_BEFORE(a,b)  ((a)<(b))
+#define SORT_NETWORK      2
+#define SORT_RADIX_KEY(k) fd_sort_radix_key_ulong( (k) )
+#include "fd_sort.c"
+
+#if FD_HAS_DOUBLE
+#define SORT_NAME         sort_double
+#define SORT_KEY_T        double
+#define SORT_BEFORE(a,b)  ((a)<(b))
+#define SORT_NETWORK      3
+#define SORT_RADIX_KEY(k) fd_sort_radix_key_double( (k) )
+#include "fd_sort.c"
+#endif
+
+/* test_wide_{long,ulong,double} validate inplace, select and radix of
+   the above against insertion sort for random keys with cnt in
+   [0,MAX].  The keys are drawn from a small range with probability 1/2
+   to exercise duplicate keys and radix digit skipping. */
+
+#define TEST_WIDE( T, randkey )                                                                    \
+static void                                                                                        \
+test_wide_##T( fd_rng_t * rng ) {                                                                  \
+  static T src[ MAX ];                                                                             \
+  static T ref[ MAX ];                                                                             \
+  static T tst[ MAX ];                                                                             \
+  static T tmp[ MAX ];                                                                             \
+  for( ulong trial=0UL; trial<1000UL; trial++ ) {                                                  \
+    ulong cnt   = fd_rng_ulong_roll( rng, MAX+1UL );                                               \
+    int   small = fd_rng_int_roll( rng, 2 );                                                       \
+    for( ulong i=0UL; i<cnt; i++ ) { ulong r = fd_rng_ulong( rng ); src[i] = (randkey); }          \
+    memcpy( ref, src, cnt*sizeof(T) ); sort_##T##_insert( ref, cnt );                              \
+    memcpy( tst, src, cnt*sizeof(T) );                                                             \
+    FD_TEST( sort_##T##_inplace( tst, cnt )==tst && !memcmp( tst, ref, cnt*sizeof(T) ) );          \
+    memcpy( tst, src, cnt*sizeof(T) );                                                             \
+    T * out = sort_##T##_radix_fast( tst, cnt, tmp );                                              \
+    FD_TEST( (out==tst || out==tmp) && !memcmp( out, ref, cnt*sizeof(T) ) );                       \
+    memcpy( tst, src, cnt*sizeof(T) );                                                             \
+    FD_TEST( sort_##T##_radix( tst, cnt, tmp )==tst && !memcmp( tst, ref, cnt*sizeof(T) ) );       \
+    if( !cnt ) continue;                                                                           \
+    ulong rnk = fd_rng_ulong_roll( rng, cnt );                                                     \
+    memcpy( tst, src, cnt*sizeof(T) );                                                             \
+    FD_TEST( sort_##T##_select( tst, cnt, rnk )==tst && tst[ rnk ]==ref[ rnk ] );                  \
+  }                                                                                                \
+  FD_LOG_NOTICE(( "wide " #T ": pass" ));                                                          \
+}
+
+TEST_WIDE( long,  small ? (long)(r & 15UL)-8L : (long)r )
+TEST_WIDE( ulong, small ? (r & 15UL)          : r       )
+#if FD_HAS_DOUBLE
+TEST_WIDE( double, small ? (double)((long)(r & 15UL)-8L) : ((double)(long)r)*1e-300 )
+#endif
+
 static TYPE *
 shuffle( fd_rng_t *   rng,
          TYPE *       y,
@@ -198,6 +264,22 @@ main( int     argc,
     FD_LOG_NOTICE(( "%lu: pass (cnt %lu)", trial, cnt ));
   }
 
+  for( ulong cnt=0UL; cnt<128UL; cnt++ ) {
+    for( ulong i=0UL; i<cnt; i++ ) ref[i] = (TYPE)i;
+    FD_TEST( !memcmp( sort_up_radix_fast( shuffle( rng, tst, ref, cnt ), cnt, tmp ), ref, cnt*sizeof(TYPE) ) );
+    FD_TEST( sort_up_radix( shuffle( rng, tst, ref, cnt ), cnt, tmp )==tst && !memcmp( tst, ref, cnt*sizeof(TYPE) ) );
+    for( ulong i=0UL; i<cnt; i++ ) ref[i] = (TYPE)(cnt-i-1UL) - (TYPE)(cnt/2UL);
+    FD_TEST( !memcmp( sort_dn_radix_fast( shuffle( rng, tst, ref, cnt ), cnt, tmp ), ref, cnt*sizeof(TYPE) ) );
+    FD_TEST( sort_dn_radix( shuffle( rng, tst, ref, cnt ), cnt, tmp )==tst && !memcmp( tst, ref, cnt*sizeof(TYPE) ) );
+  }
+  FD_LOG_NOTICE(( "radix: pass" ));
+
+  test_wide_long ( rng );
+  test_wide_ulong( rng );
+# if FD_HAS_DOUBLE
+  test_wide_double( rng );
+# endif
+
   fd_rng_delete( fd_rng_leave( rng ) );
 
   FD_LOG_NOTICE(( "pass" ));
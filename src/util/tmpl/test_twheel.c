@@ -0,0 +1,166 @@
+#include "../fd_util.h"
+
+struct tmr {
+  ulong expire;
+  ulong next;
+  ulong prev;
+  ulong live; /* Reference state, not used by the wheel */
+};
+
+typedef struct tmr tmr_t;
+
+#define TWHEEL_NAME wheel
+#define TWHEEL_T    tmr_t
+#include "fd_twheel.c"
+
+/* A tiny wheel (range of 64 time units) to stress redistribution and
+   the overflow list */
+
+#define TWHEEL_NAME        tiny
+#define TWHEEL_T           tmr_t
+#define TWHEEL_LG_SLOT_CNT 2
+#define TWHEEL_LVL_CNT     3
+#include "fd_twheel.c"
+
+FD_STATIC_ASSERT( sizeof(wheel_t)==sizeof(ulong)*(2UL+4UL*4UL+4UL*256UL+2UL), unit_test );
+
+#define POOL_MAX (1024UL)
+
+static tmr_t pool[ POOL_MAX ];
+static ulong   live_idx[ POOL_MAX ];
+
+static uchar wheel_mem[ 16384 ] __attribute__((aligned(128)));
+
+/* rand_delta returns a random time delta with a wide dynamic range */
+
+static ulong
+rand_delta( fd_rng_t * rng ) {
+  switch( fd_rng_uint_roll( rng, 8U ) ) {
+  case 0:  return 0UL;
+  case 1:  return fd_rng_ulong_roll( rng, 4UL );
+  case 2:  return fd_rng_ulong_roll( rng, 64UL );
+  case 3:  return fd_rng_ulong_roll( rng, 4096UL );
+  case 4:  return fd_rng_ulong_roll( rng, 1UL<<20 );
+  case 5:  return fd_rng_ulong_roll( rng, 1UL<<33 );
+  case 6:  return fd_rng_ulong_roll( rng, 1UL<<40 );
+  default: return fd_rng_ulong_roll( rng, 256UL );
+  }
+}
+
+#define TEST_WHEEL(W)                                                                                  \
+static void                                                                                            \
+test_##W( fd_rng_t * rng,                                                                              \
+          ulong      iter_cnt ) {                                                                      \
+  FD_TEST( fd_ulong_is_pow2( W##_align() ) );                                                          \
+  FD_TEST( W##_footprint()<=sizeof(wheel_mem) );                                                       \
+  FD_TEST( W##_idx_null()==ULONG_MAX );                                                                \
+                                                                                                       \
+  ulong now0 = fd_rng_ulong( rng ) >> 2;                                                               \
+  void * shwheel = W##_new( wheel_mem, now0 ); FD_TEST( shwheel==(void *)wheel_mem );                  \
+  W##_t * w = W##_join( shwheel );             FD_TEST( w );                                           \
+  FD_TEST( W##_now( w )==now0 );                                                                       \
+  FD_TEST( W##_cnt( w )==0UL  );                                                                       \
+  FD_TEST( W##_advance( w, pool, now0 )==ULONG_MAX );                                                  \
+                                                                                                       \
+  for( ulong i=0UL; i<POOL_MAX; i++ ) pool[i].live = ULONG_MAX; /* live is the position in live_idx */ \
+  ulong live_cnt = 0UL;                                                                                \
+  ulong exp_tot  = 0UL;                                                                                \
+                                                                                                       \
+  for( ulong iter=0UL; iter<iter_cnt; iter++ ) {                                                       \
+    ulong now = W##_now( w );                                                                          \
+    uint  r   = fd_rng_uint_roll( rng, 16U );                                                          \
+                                                                                                       \
+    if( r<8U && live_cnt<POOL_MAX ) { /* schedule */                                                   \
+      ulong idx; do idx = fd_rng_ulong_roll( rng, POOL_MAX ); while( pool[idx].live!=ULONG_MAX );     \
+      ulong expire = fd_rng_uint_roll( rng, 16U ) ? now + rand_delta( rng ) : now - fd_ulong_min( now, rand_delta( rng ) ); \
+      W##_schedule( w, pool, idx, expire );                                                            \
+      FD_TEST( pool[idx].expire==expire );                                                             \
+      pool[idx].live = live_cnt; live_idx[ live_cnt++ ] = idx;                                         \
+                                                                                                       \
+    } else if( r<12U && live_cnt ) { /* cancel */                                                      \
+      ulong pos = fd_rng_ulong_roll( rng, live_cnt );                                                  \
+      ulong idx = live_idx[ pos ];                                                                     \
+      W##_cancel( w, pool, idx );                                                                      \
+      live_idx[ pos ] = live_idx[ --live_cnt ]; pool[ live_idx[ pos ] ].live = pos;                    \
+      pool[idx].live = ULONG_MAX;                                                                      \
+                                                                                                       \
+    } else { /* advance */                                                                             \
+      ulong now1 = fd_rng_uint_roll( rng, 8U ) ? now + rand_delta( rng ) : now - fd_ulong_min( now, rand_delta( rng ) );    \
+      ulong ref_cnt = 0UL;                                                                             \
+      for( ulong pos=0UL; pos<live_cnt; pos++ ) ref_cnt += (ulong)(pool[ live_idx[pos] ].expire<=fd_ulong_max( now, now1 )); \
+                                                                                                       \
+      ulong idx  = W##_advance( w, pool, now1 );                                                       \
+      FD_TEST( W##_now( w )==fd_ulong_max( now, now1 ) );                                              \
+      ulong cnt  = 0UL;                                                                                \
+      ulong last = now; /* Timers scheduled in the past come first in any order */                    \
+      while( idx!=ULONG_MAX ) {                                                                        \
+        FD_TEST( idx<POOL_MAX );                                                                       \
+        ulong pos = pool[idx].live; FD_TEST( pos<live_cnt ); FD_TEST( live_idx[pos]==idx );            \
+        FD_TEST( pool[idx].expire<=W##_now( w ) );                                                     \
+        if( pool[idx].expire>now ) { FD_TEST( last<=pool[idx].expire ); last = pool[idx].expire; }     \
+        else                         FD_TEST( last==now );                                             \
+        ulong next = pool[idx].next;                                                                   \
+        live_idx[ pos ] = live_idx[ --live_cnt ]; pool[ live_idx[ pos ] ].live = pos;                  \
+        pool[idx].live = ULONG_MAX;                                                                    \
+        cnt++;                                                                                         \
+        idx = next;                                                                                    \
+      }                                                                                                \
+      FD_TEST( cnt==ref_cnt );                                                                         \
+      exp_tot += cnt;                                                                                  \
+    }                                                                                                  \
+                                                                                                       \
+    FD_TEST( W##_cnt( w )==live_cnt );                                                                 \
+  }                                                                                                    \
+                                                                                                       \
+  /* Drain the wheel */                                                                                \
+                                                                                                       \
+  ulong cnt = 0UL;                                                                                     \
+  for( ulong idx=W##_advance( w, pool, ULONG_MAX ); idx!=ULONG_MAX; idx=pool[idx].next ) cnt++;        \
+  FD_TEST( cnt==live_cnt );                                                                            \
+  FD_TEST( W##_cnt( w )==0UL );                                                                        \
+  FD_TEST( W##_now( w )==ULONG_MAX );                                                                  \
+                                                                                                       \
+  FD_TEST( W##_leave( w )==shwheel );                                                                  \
+  FD_TEST( W##_delete( shwheel )==(void *)wheel_mem );                                                 \
+  FD_LOG_NOTICE(( #W ": pass (%lu expirations)", exp_tot+cnt ));                                      \
+}
+
+TEST_WHEEL(wheel)
+TEST_WHEEL(tiny)
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong iter_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--iter-cnt", NULL, 1000000UL );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  /* Test timers are returned at exactly the right time */
+
+  wheel_t * w = wheel_join( wheel_new( wheel_mem, 100UL ) );
+  wheel_schedule( w, pool, 0UL, 1000UL );
+  wheel_schedule( w, pool, 1UL,  999UL );
+  wheel_schedule( w, pool, 2UL,   50UL ); /* in the past */
+  wheel_schedule( w, pool, 3UL, 1000UL + (1UL<<40) );
+  FD_TEST( wheel_cnt( w )==4UL );
+  ulong idx = wheel_advance( w, pool, 100UL ); FD_TEST( idx==2UL ); FD_TEST( pool[2].next==ULONG_MAX );
+  FD_TEST( wheel_advance( w, pool, 998UL )==ULONG_MAX );
+  idx = wheel_advance( w, pool,  999UL ); FD_TEST( idx==1UL ); FD_TEST( pool[1].next==ULONG_MAX );
+  idx = wheel_advance( w, pool, 1000UL ); FD_TEST( idx==0UL ); FD_TEST( pool[0].next==ULONG_MAX );
+  FD_TEST( wheel_advance( w, pool, 999UL + (1UL<<40) )==ULONG_MAX );
+  wheel_cancel( w, pool, 3UL );
+  FD_TEST( wheel_cnt( w )==0UL );
+  FD_TEST( wheel_advance( w, pool, ULONG_MAX )==ULONG_MAX );
+  wheel_delete( wheel_leave( w ) );
+
+  test_wheel( rng, iter_cnt );
+  test_tiny ( rng, iter_cnt );
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
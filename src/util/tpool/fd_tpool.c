@@ -0,0 +1,349 @@
+#include "fd_tpool.h"
+
+/* A fd_tpool_private_range_t is a range of chunks [c0,c1) of the
+   current fd_tpool_for.  Chunk c covers the indices
+   [i0+c*grain,min(i0+(c+1)*grain,i1)). */
+
+struct fd_tpool_private_range {
+  ulong c0;
+  ulong c1;
+};
+
+typedef struct fd_tpool_private_range fd_tpool_private_range_t;
+
+/* Each worker has a small deque of chunk ranges (the owner pops chunks
+   off the head and thieves split off the back of the tail).  As the
+   owner only ever pushes back the remainder of a range it popped and a
+   thief only ever pushes into its own empty deque, a deque never holds
+   more than a couple of ranges. */
+
+#define DEQUE_NAME fd_tpool_private_deque
+#define DEQUE_T    fd_tpool_private_range_t
+#define DEQUE_MAX  4UL
+#include "../tmpl/fd_deque.c"
+
+struct __attribute__((aligned(128UL))) fd_tpool_private_worker {
+  ulong                                 lock;   /* 0 if unlocked, 1 if locked */
+  fd_tpool_private_range_t *            deque;  /* Local join to deque_mem */
+  fd_tpool_private_deque_private_t      deque_mem[1];
+};
+
+typedef struct fd_tpool_private_worker fd_tpool_private_worker_t;
+
+FD_STATIC_ASSERT( sizeof(fd_tpool_private_worker_t)==128UL, layout );
+
+#define FD_TPOOL_MAGIC (0xf17eda2c37790010UL) /* firedancer tpool ver 0 */
+
+struct __attribute__((aligned(FD_TPOOL_ALIGN))) fd_tpool_private {
+  ulong           magic;      /* == FD_TPOOL_MAGIC */
+  ulong           worker_max;
+
+  /* State of the current fd_tpool_for */
+
+  ulong           worker_cnt;
+  ulong           i0;
+  ulong           i1;
+  ulong           grain;
+  fd_tpool_task_t task;
+  void *          ctx;
+
+  /* worker_max fd_tpool_private_worker_t follow here */
+};
+
+FD_STATIC_ASSERT( sizeof(fd_tpool_t)==128UL, layout );
+
+static inline fd_tpool_private_worker_t *
+fd_tpool_private_worker( fd_tpool_t * tpool ) {
+  return (fd_tpool_private_worker_t *)(tpool+1);
+}
+
+void *
+fd_tpool_new( void * shmem,
+              ulong  worker_max ) {
+
+  if( FD_UNLIKELY( !shmem ) ) {
+    FD_LOG_WARNING(( "NULL shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shmem, fd_tpool_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shmem" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_tpool_footprint( worker_max ) ) ) {
+    FD_LOG_WARNING(( "bad worker_max" ));
+    return NULL;
+  }
+
+  fd_tpool_t * tpool = (fd_tpool_t *)shmem;
+
+  memset( tpool, 0, sizeof(fd_tpool_t) );
+  tpool->worker_max = worker_max;
+
+  fd_tpool_private_worker_t * worker = fd_tpool_private_worker( tpool );
+  for( ulong w=0UL; w<worker_max; w++ ) {
+    worker[w].lock  = 0UL;
+    worker[w].deque = NULL;
+    fd_tpool_private_deque_new( worker[w].deque_mem );
+  }
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( tpool->magic ) = FD_TPOOL_MAGIC;
+  FD_COMPILER_MFENCE();
+
+  return shmem;
+}
+
+fd_tpool_t *
+fd_tpool_join( void * shtpool ) {
+
+  if( FD_UNLIKELY( !shtpool ) ) {
+    FD_LOG_WARNING(( "NULL shtpool" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shtpool, fd_tpool_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shtpool" ));
+    return NULL;
+  }
+
+  fd_tpool_t * tpool = (fd_tpool_t *)shtpool;
+
+  if( FD_UNLIKELY( tpool->magic!=FD_TPOOL_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  fd_tpool_private_worker_t * worker = fd_tpool_private_worker( tpool );
+  for( ulong w=0UL; w<tpool->worker_max; w++ ) worker[w].deque = fd_tpool_private_deque_join( worker[w].deque_mem );
+
+  return tpool;
+}
+
+void *
+fd_tpool_leave( fd_tpool_t * tpool ) {
+
+  if( FD_UNLIKELY( !tpool ) ) {
+    FD_LOG_WARNING(( "NULL tpool" ));
+    return NULL;
+  }
+
+  fd_tpool_private_worker_t * worker = fd_tpool_private_worker( tpool );
+  for( ulong w=0UL; w<tpool->worker_max; w++ ) {
+    fd_tpool_private_deque_leave( worker[w].deque );
+    worker[w].deque = NULL;
+  }
+
+  return (void *)tpool;
+}
+
+void *
+fd_tpool_delete( void * shtpool ) {
+
+  if( FD_UNLIKELY( !shtpool ) ) {
+    FD_LOG_WARNING(( "NULL shtpool" ));
+    return NULL;
+  }
+
+  if( FD_UNLIKELY( !fd_ulong_is_aligned( (ulong)shtpool, fd_tpool_align() ) ) ) {
+    FD_LOG_WARNING(( "misaligned shtpool" ));
+    return NULL;
+  }
+
+  fd_tpool_t * tpool = (fd_tpool_t *)shtpool;
+
+  if( FD_UNLIKELY( tpool->magic!=FD_TPOOL_MAGIC ) ) {
+    FD_LOG_WARNING(( "bad magic" ));
+    return NULL;
+  }
+
+  fd_tpool_private_worker_t * worker = fd_tpool_private_worker( tpool );
+  for( ulong w=0UL; w<tpool->worker_max; w++ ) fd_tpool_private_deque_delete( worker[w].deque_mem );
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( tpool->magic ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  return shtpool;
+}
+
+ulong fd_tpool_worker_max( fd_tpool_t const * tpool ) { return tpool->worker_max; }
+
+/* fd_tpool_private_{lock,unlock} acquire / release a worker's deque
+   lock.  Critical sections are a handful of instructions so a simple
+   spin lock is fine. */
+
+static inline void
+fd_tpool_private_lock( fd_tpool_private_worker_t * worker ) {
+# if FD_HAS_ATOMIC
+  while( FD_UNLIKELY( FD_ATOMIC_CAS( &worker->lock, 0UL, 1UL ) ) ) FD_SPIN_PAUSE();
+# else
+  worker->lock = 1UL; /* Targets without atomics are single tile */
+# endif
+  FD_COMPILER_MFENCE();
+}
+
+static inline void
+fd_tpool_private_unlock( fd_tpool_private_worker_t * worker ) {
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( worker->lock ) = 0UL;
+  FD_COMPILER_MFENCE();
+}
+
+/* fd_tpool_private_pop pops the next chunk off the head of worker w's
+   deque.  Returns 1 on success (chunk in *_c) and 0 if the deque was
+   empty. */
+
+static int
+fd_tpool_private_pop( fd_tpool_private_worker_t * worker,
+                      ulong *                     _c ) {
+  fd_tpool_private_lock( worker );
+  int ok = !fd_tpool_private_deque_empty( worker->deque );
+  if( FD_LIKELY( ok ) ) {
+    fd_tpool_private_range_t r = fd_tpool_private_deque_pop_head( worker->deque );
+    *_c = r.c0;
+    r.c0++;
+    if( r.c0<r.c1 ) fd_tpool_private_deque_push_head( worker->deque, r );
+  }
+  fd_tpool_private_unlock( worker );
+  return ok;
+}
+
+/* fd_tpool_private_steal moves the back half (rounded up) of the range
+   at the tail of another worker's deque into worker w's (empty) deque.
+   Victims are tried round robin starting after w.  Returns 1 on
+   success and 0 if all other deques were found empty (in which case
+   all work has been claimed and w is done ... a worker that is
+   concurrently moving stolen work between deques can make another
+   worker finish a little early but this only reduces parallelism). */
+
+static int
+fd_tpool_private_steal( fd_tpool_t * tpool,
+                        ulong        w ) {
+  fd_tpool_private_worker_t * worker     = fd_tpool_private_worker( tpool );
+  ulong                       worker_cnt = tpool->worker_cnt;
+  for( ulong k=1UL; k<worker_cnt; k++ ) {
+    fd_tpool_private_worker_t * victim = worker + ((w+k) % worker_cnt);
+    if( fd_tpool_private_deque_empty( victim->deque ) ) continue; /* Racy peek, avoids locking idle deques */
+
+    fd_tpool_private_lock( victim );
+    int ok = !fd_tpool_private_deque_empty( victim->deque );
+    fd_tpool_private_range_t r;
+    if( FD_LIKELY( ok ) ) {
+      r = fd_tpool_private_deque_pop_tail( victim->deque );
+      ulong mid = r.c1 - ((r.c1-r.c0+1UL)>>1);
+      if( r.c0<mid ) {
+        fd_tpool_private_range_t keep; keep.c0 = r.c0; keep.c1 = mid;
+        fd_tpool_private_deque_push_tail( victim->deque, keep );
+      }
+      r.c0 = mid;
+    }
+    fd_tpool_private_unlock( victim );
+
+    if( FD_LIKELY( ok ) ) {
+      fd_tpool_private_lock( worker + w );
+      fd_tpool_private_deque_push_tail( worker[w].deque, r );
+      fd_tpool_private_unlock( worker + w );
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* fd_tpool_private_run runs worker w's loop until all work has been
+   claimed. */
+
+static void
+fd_tpool_private_run( fd_tpool_t * tpool,
+                      ulong        w ) {
+  fd_tpool_private_worker_t * worker = fd_tpool_private_worker( tpool );
+  ulong                       i0     = tpool->i0;
+  ulong                       i1     = tpool->i1;
+  ulong                       grain  = tpool->grain;
+  fd_tpool_task_t             task   = tpool->task;
+  void *                      ctx    = tpool->ctx;
+  for(;;) {
+    ulong c;
+    if( FD_UNLIKELY( !fd_tpool_private_pop( worker + w, &c ) ) ) {
+      if( FD_UNLIKELY( !fd_tpool_private_steal( tpool, w ) ) ) break;
+      continue;
+    }
+    ulong j0 = i0 + c*grain;
+    task( ctx, j0, fd_ulong_min( j0 + grain, i1 ) );
+  }
+}
+
+/* fd_tpool_private_exec is the fd_tile task for workers other than the
+   caller.  argc is the worker index and argv is the tpool. */
+
+static int
+fd_tpool_private_exec( int     argc,
+                       char ** argv ) {
+  fd_tpool_private_run( (fd_tpool_t *)argv, (ulong)argc );
+  return 0;
+}
+
+void
+fd_tpool_for( fd_tpool_t *    tpool,
+              ulong           tile0,
+              ulong           tile1,
+              ulong           i0,
+              ulong           i1,
+              ulong           grain,
+              fd_tpool_task_t task,
+              void *          ctx ) {
+
+  if( FD_UNLIKELY( i0>=i1 ) ) return;
+
+  ulong worker_cnt = 1UL + tile1 - tile0;
+  if( FD_UNLIKELY( !((tile0<=tile1) & (worker_cnt<=tpool->worker_max)) ) )
+    FD_LOG_ERR(( "bad tile range [%lu,%lu) for tpool with worker_max %lu", tile0, tile1, tpool->worker_max ));
+
+  grain = fd_ulong_max( grain, 1UL );
+  ulong n         = i1 - i0;
+  ulong chunk_cnt = n/grain + (ulong)!!(n%grain);
+
+  tpool->worker_cnt = worker_cnt;
+  tpool->i0         = i0;
+  tpool->i1         = i1;
+  tpool->grain      = grain;
+  tpool->task       = task;
+  tpool->ctx        = ctx;
+
+  /* Statically partition the chunks over the workers */
+
+  ulong chunk_per = chunk_cnt / worker_cnt;
+  ulong chunk_rem = chunk_cnt % worker_cnt; /* First chunk_rem workers get an extra chunk */
+
+  fd_tpool_private_worker_t * worker = fd_tpool_private_worker( tpool );
+  for( ulong w=0UL; w<worker_cnt; w++ ) {
+    fd_tpool_private_deque_remove_all( worker[w].deque );
+    fd_tpool_private_range_t r;
+    r.c0 = chunk_per* w      + fd_ulong_min( w,     chunk_rem );
+    r.c1 = chunk_per*(w+1UL) + fd_ulong_min( w+1UL, chunk_rem );
+    if( r.c0<r.c1 ) fd_tpool_private_deque_push_tail( worker[w].deque, r );
+    worker[w].lock = 0UL;
+  }
+
+  FD_COMPILER_MFENCE();
+
+  /* Dispatch the tiles (worker w>0 is tile tile0+w-1), run worker 0 on
+     the caller and wait for the tiles to finish.  A tile that can't be
+     dispatched just leaves its block to be stolen. */
+
+  fd_tile_exec_t * exec[ FD_TPOOL_WORKER_MAX ];
+  for( ulong w=1UL; w<worker_cnt; w++ ) {
+    ulong tile_idx = tile0 + w - 1UL;
+    exec[w] = fd_tile_exec_new( tile_idx, fd_tpool_private_exec, (int)w, (char **)tpool );
+    if( FD_UNLIKELY( !exec[w] ) ) FD_LOG_WARNING(( "fd_tile_exec_new failed for tile %lu; its work will be stolen", tile_idx ));
+  }
+
+  fd_tpool_private_run( tpool, 0UL );
+
+  for( ulong w=1UL; w<worker_cnt; w++ ) {
+    if( FD_UNLIKELY( !exec[w] ) ) continue;
+    char const * err = fd_tile_exec_delete( exec[w], NULL );
+    if( FD_UNLIKELY( err ) ) FD_LOG_ERR(( "tile %lu terminated abnormally (%s)", tile0 + w - 1UL, err ));
+  }
+}
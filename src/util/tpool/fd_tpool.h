@@ -0,0 +1,120 @@
+#ifndef HEADER_fd_src_util_tpool_fd_tpool_h
+#define HEADER_fd_src_util_tpool_fd_tpool_h
+
+/* fd_tpool provides a small fork-join layer over fd_tile for data
+   parallel work that isn't latency critical (e.g. building large
+   tables at startup or offline tools).  The caller and a range of
+   otherwise idle tiles in the caller's thread group cooperatively run
+   a task over an index range:
+
+     static void
+     my_task( void * ctx,
+              ulong  i0,
+              ulong  i1 ) {
+       ... process indices [i0,i1) ...
+     }
+
+     uchar _tpool[ FD_TPOOL_FOOTPRINT( FD_TILE_MAX ) ] __attribute__((aligned(FD_TPOOL_ALIGN)));
+     fd_tpool_t * tpool = fd_tpool_join( fd_tpool_new( _tpool, FD_TILE_MAX ) );
+
+     // From tile 0, use tile 0 and tiles [1,fd_tile_cnt())
+     fd_tpool_for( tpool, 1UL, fd_tile_cnt(), 0UL, cnt, 1024UL, my_task, ctx );
+
+   The index range is statically partitioned over the workers in
+   contiguous blocks (for locality) of grain sized chunks.  Each worker
+   processes the chunks of its block in order from a double-ended queue
+   and, when it runs out, steals half of the remaining chunks from the
+   tail of another worker's queue.  So load imbalance (heterogeneous
+   costs per index, a worker preempted by the OS, a tile that couldn't
+   be dispatched, etc) is smoothed over at a granularity of a chunk.
+
+   Tiles spin while they wait for work (fd_tile) so a tpool works best
+   with tiles that have a dedicated core.  A tpool can be used by only
+   one fd_tpool_for at a time but a task can itself use a different
+   tpool with a disjoint set of tiles. */
+
+#include "../tile/fd_tile.h"
+
+/* FD_TPOOL_{ALIGN,FOOTPRINT} give the alignment and footprint of a
+   tpool that can use up to worker_max workers (including the caller).
+   worker_max is assumed to be in [1,FD_TPOOL_WORKER_MAX]. */
+
+#define FD_TPOOL_WORKER_MAX        (FD_TILE_MAX)
+#define FD_TPOOL_ALIGN             (128UL)
+#define FD_TPOOL_FOOTPRINT( worker_max ) (128UL + 128UL*(worker_max))
+
+/* A fd_tpool_task_t is a function pointer with the function signature
+   for tasks run by fd_tpool_for.  The task should process the indices
+   [i0,i1) (non-empty and within the range passed to fd_tpool_for).  ctx
+   is the value passed to fd_tpool_for.  Tasks are run concurrently on
+   disjoint ranges. */
+
+typedef void (*fd_tpool_task_t)( void * ctx, ulong i0, ulong i1 );
+
+struct fd_tpool_private;
+typedef struct fd_tpool_private fd_tpool_t;
+
+FD_PROTOTYPES_BEGIN
+
+/* fd_tpool_{align,footprint} return the required alignment and
+   footprint of a memory region suitable for use as a tpool with up to
+   worker_max workers.  fd_tpool_footprint returns 0 if worker_max is
+   not in [1,FD_TPOOL_WORKER_MAX]. */
+
+FD_FN_CONST static inline ulong fd_tpool_align( void ) { return FD_TPOOL_ALIGN; }
+
+FD_FN_CONST static inline ulong
+fd_tpool_footprint( ulong worker_max ) {
+  if( FD_UNLIKELY( !((1UL<=worker_max) & (worker_max<=FD_TPOOL_WORKER_MAX)) ) ) return 0UL;
+  return FD_TPOOL_FOOTPRINT( worker_max );
+}
+
+/* fd_tpool_new formats an unused memory region for use as a tpool with
+   up to worker_max workers.  Returns shmem on success and NULL on
+   failure (logs details).  fd_tpool_join joins the caller to a tpool,
+   fd_tpool_leave leaves it and fd_tpool_delete unformats the memory
+   region.  These follow the usual conventions.  A tpool is a local
+   object (it holds pointers in the caller's address space). */
+
+void *
+fd_tpool_new( void * shmem,
+              ulong  worker_max );
+
+fd_tpool_t *
+fd_tpool_join( void * shtpool );
+
+void *
+fd_tpool_leave( fd_tpool_t * tpool );
+
+void *
+fd_tpool_delete( void * shtpool );
+
+/* fd_tpool_worker_max returns the worker_max tpool was created with. */
+
+FD_FN_PURE ulong fd_tpool_worker_max( fd_tpool_t const * tpool );
+
+/* fd_tpool_for runs task over the index range [i0,i1) in chunks of up
+   to grain indices using the caller and the tiles [tile0,tile1) of the
+   caller's thread group as workers and returns when all indices have
+   been processed.  The tiles should be idle and not include the caller
+   or tile 0 (e.g. from tile 0, use tile0==1).  The number of workers,
+   1+tile1-tile0, should be at most fd_tpool_worker_max.  tile0==tile1
+   runs the task on the caller.  grain of 0 is treated as 1.
+
+   If a tile can't be dispatched, its share of the work is stolen by
+   the other workers (logs details).  If a tile terminates abnormally,
+   this logs details and terminates the application. */
+
+void
+fd_tpool_for( fd_tpool_t *    tpool,
+              ulong           tile0,
+              ulong           tile1,
+              ulong           i0,
+              ulong           i1,
+              ulong           grain,
+              fd_tpool_task_t task,
+              void *          ctx );
+
+FD_PROTOTYPES_END
+
+#endif /* HEADER_fd_src_util_tpool_fd_tpool_h */
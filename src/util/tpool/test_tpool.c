@@ -0,0 +1,169 @@
+#include "../fd_util.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+/* Run with --tile-cpus to test with multiple tiles (e.g. --tile-cpus
+   0-63 or, when cores are scarce, --tile-cpus 0,63f to float 63 tiles).
+   All worker counts from 1 to fd_tile_cnt() are tested. */
+
+FD_STATIC_ASSERT( FD_TPOOL_ALIGN==128UL,                   unit_test );
+FD_STATIC_ASSERT( FD_TPOOL_FOOTPRINT( 2UL )==128UL*3UL,    unit_test );
+FD_STATIC_ASSERT( FD_TPOOL_WORKER_MAX==FD_TILE_MAX,        unit_test );
+
+struct pair {
+  ulong key;
+  ulong idx;
+};
+
+typedef struct pair pair_t;
+
+#define SORT_NAME        sort_pair
+#define SORT_KEY_T       pair_t
+#define SORT_BEFORE(a,b) ((a).key<(b).key)
+#define SORT_PARALLEL    1
+#include "../tmpl/fd_sort.c"
+
+/* sort_pair_tiny goes parallel at very small cnt such that blocks are
+   narrow and cnt is usually not a multiple of the block width (i.e.
+   trailing blocks can be partial or empty). */
+
+#define SORT_NAME            sort_pair_tiny
+#define SORT_KEY_T           pair_t
+#define SORT_BEFORE(a,b)     ((a).key<(b).key)
+#define SORT_PARALLEL        1
+#define SORT_PARALLEL_THRESH 2UL
+#include "../tmpl/fd_sort.c"
+
+#define CNT_MAX (1UL<<18)
+
+static uchar  tpool_mem[ FD_TPOOL_FOOTPRINT( FD_TILE_MAX ) ] __attribute__((aligned(FD_TPOOL_ALIGN)));
+static uint   visit[ CNT_MAX ];
+static pair_t src  [ CNT_MAX ];
+static pair_t ref  [ CNT_MAX ];
+static pair_t tst  [ CNT_MAX ];
+static pair_t tmp  [ CNT_MAX ];
+
+/* visit_task marks the indices it processed.  Indices are processed by
+   exactly one worker so no atomics are needed.  If ctx is non-NULL,
+   the cost per index is proportional to the index (to exercise work
+   stealing). */
+
+static void
+visit_task( void * ctx,
+            ulong  i0,
+            ulong  i1 ) {
+  FD_TEST( i0<i1 );
+  for( ulong i=i0; i<i1; i++ ) {
+    visit[i]++;
+    if( ctx ) for( ulong j=0UL; j<(i>>6); j++ ) FD_SPIN_PAUSE();
+  }
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  ulong trial_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--trial-cnt", NULL, 16UL );
+
+  ulong tile_cnt = fd_tile_cnt();
+
+  FD_LOG_NOTICE(( "Testing with --trial-cnt %lu on %lu tile(s)", trial_cnt, tile_cnt ));
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  /* Test construction */
+
+  FD_TEST( fd_tpool_align()==FD_TPOOL_ALIGN );
+  FD_TEST( !fd_tpool_footprint( 0UL                   ) );
+  FD_TEST( !fd_tpool_footprint( FD_TPOOL_WORKER_MAX+1UL ) );
+  FD_TEST( fd_tpool_footprint( tile_cnt )==FD_TPOOL_FOOTPRINT( tile_cnt ) );
+
+  FD_TEST( !fd_tpool_new( NULL,          tile_cnt ) ); /* NULL shmem     */
+  FD_TEST( !fd_tpool_new( tpool_mem+1UL, tile_cnt ) ); /* misaligned     */
+  FD_TEST( !fd_tpool_new( tpool_mem,     0UL      ) ); /* bad worker_max */
+
+  void * shtpool = fd_tpool_new( tpool_mem, tile_cnt ); FD_TEST( shtpool==(void *)tpool_mem );
+
+  FD_TEST( !fd_tpool_join( NULL          ) ); /* NULL shtpool */
+  FD_TEST( !fd_tpool_join( tpool_mem+1UL ) ); /* misaligned   */
+
+  fd_tpool_t * tpool = fd_tpool_join( shtpool ); FD_TEST( tpool );
+
+  FD_TEST( fd_tpool_worker_max( tpool )==tile_cnt );
+
+  for( ulong worker_cnt=1UL; worker_cnt<=tile_cnt; worker_cnt++ ) {
+    ulong tile0 = 1UL;
+    ulong tile1 = worker_cnt;
+
+    /* Test fd_tpool_for covers each index exactly once for random
+       ranges and grains */
+
+    for( ulong trial=0UL; trial<trial_cnt; trial++ ) {
+      ulong i0    = fd_rng_ulong_roll( rng, CNT_MAX );
+      ulong i1    = i0 + fd_rng_ulong_roll( rng, CNT_MAX-i0+1UL );
+      ulong grain = fd_rng_ulong_roll( rng, 4UL ) ? fd_rng_ulong_roll( rng, 4096UL ) : fd_rng_ulong_roll( rng, 1UL<<20 );
+      void * ctx  = fd_rng_uint_roll( rng, 4U ) ? NULL : (void *)1;
+      memset( visit, 0, sizeof(visit) );
+      fd_tpool_for( tpool, tile0, tile1, i0, i1, grain, visit_task, ctx );
+      for( ulong i=0UL; i<CNT_MAX; i++ ) FD_TEST( visit[i]==(uint)((i0<=i) & (i<i1)) );
+    }
+
+    /* Test parallel sort matches serial stable sort (including the
+       order of equal keys) */
+
+    for( ulong trial=0UL; trial<trial_cnt; trial++ ) {
+      ulong cnt      = fd_rng_ulong_roll( rng, CNT_MAX+1UL );
+      ulong key_mask = fd_rng_uint_roll( rng, 2U ) ? 255UL : ULONG_MAX; /* Lots of equal keys half the time */
+      for( ulong i=0UL; i<cnt; i++ ) { src[i].key = fd_rng_ulong( rng ) & key_mask; src[i].idx = i; }
+      memcpy( ref, src, cnt*sizeof(pair_t) ); sort_pair_stable( ref, cnt, tmp );
+      memcpy( tst, src, cnt*sizeof(pair_t) );
+      FD_TEST( sort_pair_stable_para( tpool, tile0, tile1, tst, cnt, tmp )==tst );
+      FD_TEST( !memcmp( tst, ref, cnt*sizeof(pair_t) ) );
+    }
+
+    /* Same with a tiny parallel threshold and every small cnt (most
+       are not a multiple of the block width and some leave trailing
+       blocks empty).  Keys and scratch past cnt are filled with reverse
+       sorted canaries that must not be touched. */
+
+    for( ulong cnt=0UL; cnt<=64UL; cnt++ ) {
+      for( ulong i=0UL; i<cnt; i++ ) { src[i].key = fd_rng_ulong( rng ) & 15UL; src[i].idx = i; }
+      memcpy( ref, src, cnt*sizeof(pair_t) ); sort_pair_tiny_stable( ref, cnt, tmp );
+      memcpy( tst, src, cnt*sizeof(pair_t) );
+      for( ulong i=cnt; i<cnt+128UL; i++ ) { tst[i].key = ~i; tst[i].idx = i; tmp[i] = tst[i]; }
+      FD_TEST( sort_pair_tiny_stable_para( tpool, tile0, tile1, tst, cnt, tmp )==tst );
+      FD_TEST( !memcmp( tst, ref, cnt*sizeof(pair_t) ) );
+      for( ulong i=cnt; i<cnt+128UL; i++ ) FD_TEST( (tst[i].key==~i) & (tst[i].idx==i) & (tmp[i].key==~i) & (tmp[i].idx==i) );
+    }
+
+    FD_LOG_NOTICE(( "%lu worker(s): pass", worker_cnt ));
+  }
+
+  FD_TEST( !fd_tpool_leave( NULL ) );
+  FD_TEST( fd_tpool_leave( tpool )==shtpool );
+
+  FD_TEST( !fd_tpool_delete( NULL          ) ); /* NULL shtpool */
+  FD_TEST( !fd_tpool_delete( tpool_mem+1UL ) ); /* misaligned   */
+  FD_TEST( fd_tpool_delete( shtpool )==(void *)tpool_mem );
+  FD_TEST( !fd_tpool_join( shtpool ) ); /* bad magic */
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include "../fd_util.h"
+#include "fd_wksp_private.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/* bench_wksp models application startup creating a large number of
+   workspace objects.  It times creating --part-cnt partitions, times
+   the recovery of the wksp from a process that died in the middle of
+   splitting a partition (which rebuilds all the partition indices) and
+   then times freeing all the partitions in a random order.  The wksp
+   is validated against the expected usage after each phase. */
+
+static ulong
+dead_pid( void ) {
+  pid_t pid = fork();
+  if( FD_UNLIKELY( pid<0 ) ) FD_LOG_ERR(( "fork failed (%i-%s)", errno, strerror( errno ) ));
+  if( !pid ) _exit( 0 );
+  if( FD_UNLIKELY( waitpid( pid, NULL, 0 )!=pid ) ) FD_LOG_ERR(( "waitpid failed (%i-%s)", errno, strerror( errno ) ));
+  return (ulong)pid;
+}
+
+static void
+check_usage( fd_wksp_t * wksp,
+             ulong       used_cnt,
+             ulong       used_sz ) {
+  ulong           tag = 1UL;
+  fd_wksp_usage_t usage[1];
+  FD_TEST( fd_wksp_usage( wksp, &tag, 1UL, usage )==usage );
+  FD_TEST( usage->used_cnt==used_cnt );
+  FD_TEST( usage->used_sz ==used_sz  );
+  FD_TEST( usage->total_cnt==usage->free_cnt+usage->used_cnt+1UL ); /* +1 for the tag 2 gaddr array */
+  FD_TEST( usage->free_cnt<=usage->used_cnt+2UL );
+  FD_TEST( usage->total_sz==wksp->gaddr_hi-wksp->gaddr_lo );
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",  NULL,         "normal" );
+  ulong        part_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--part-cnt", NULL,         100000UL );
+  ulong        sz_max   = fd_env_strip_cmdline_ulong( &argc, &argv, "--sz-max",   NULL,           8192UL );
+  ulong        near_cpu = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu", NULL, fd_log_cpu_id() );
+
+  ulong page_sz = fd_cstr_to_shmem_page_sz( _page_sz );
+  if( FD_UNLIKELY( !page_sz  ) ) FD_LOG_ERR(( "unsupported --page-sz" ));
+  if( FD_UNLIKELY( !part_cnt ) ) FD_LOG_ERR(( "--part-cnt should be positive" ));
+  if( FD_UNLIKELY( !sz_max   ) ) FD_LOG_ERR(( "--sz-max should be positive" ));
+
+  /* Size the wksp such that all the partitions fit with plenty of room
+     for alignment and fragmentation */
+
+  ulong blk_max  = (sz_max + FD_WKSP_ALLOC_ALIGN_MIN - 1UL) / FD_WKSP_ALLOC_ALIGN_MIN;
+  ulong wksp_sz  = 2UL*part_cnt*blk_max*FD_WKSP_ALLOC_ALIGN_MIN + (2UL<<20);
+  ulong page_cnt = (wksp_sz + page_sz - 1UL) / page_sz;
+
+  FD_LOG_NOTICE(( "Benching --page-sz %s --part-cnt %lu --sz-max %lu (page_cnt %lu)", _page_sz, part_cnt, sz_max, page_cnt ));
+
+  fd_wksp_t * wksp = fd_wksp_new_anonymous( page_sz, page_cnt, near_cpu, "bench_wksp", 0UL );
+  if( FD_UNLIKELY( !wksp ) ) FD_LOG_ERR(( "fd_wksp_new_anonymous failed" ));
+
+  ulong * gaddr = (ulong *)fd_wksp_alloc_laddr( wksp, 0UL, part_cnt*sizeof(ulong), 2UL );
+  if( FD_UNLIKELY( !gaddr ) ) FD_LOG_ERR(( "fd_wksp_alloc_laddr failed" ));
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  /* Startup: create part_cnt partitions of random size and alignment */
+
+  ulong used_sz = 0UL;
+  long  dt      = -fd_log_wallclock();
+  for( ulong idx=0UL; idx<part_cnt; idx++ ) {
+    ulong align = FD_WKSP_ALLOC_ALIGN_MIN << fd_rng_uint_roll( rng, 3U );
+    ulong sz    = 1UL + fd_rng_ulong_roll( rng, sz_max );
+    gaddr[ idx ] = fd_wksp_alloc( wksp, align, sz, 1UL );
+    if( FD_UNLIKELY( !gaddr[ idx ] ) ) FD_LOG_ERR(( "fd_wksp_alloc failed at partition %lu", idx ));
+    used_sz += fd_ulong_align_up( sz, FD_WKSP_ALLOC_ALIGN_MIN );
+  }
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "alloc:   %.3f ms total, %.1f ns/partition", 1e-6*(double)dt, (double)dt/(double)part_cnt ));
+
+  check_usage( wksp, part_cnt, used_sz );
+
+  /* Simulate a process that died in the middle of splitting the largest
+     free partition (it had created the free trailing partition but had
+     not yet shrunk the partition being split). */
+
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+  uint                      i     = wksp->root_cidx[1];
+  while( pinfo[i].child_cidx[1][1]!=FD_WKSP_PRIVATE_PINFO_IDX_NULL ) i = pinfo[i].child_cidx[1][1];
+  uint j = wksp->idle_cidx;
+  FD_TEST( i!=FD_WKSP_PRIVATE_PINFO_IDX_NULL );
+  FD_TEST( j!=FD_WKSP_PRIVATE_PINFO_IDX_NULL );
+  FD_TEST( (pinfo[i].gaddr_hi-pinfo[i].gaddr_lo)>FD_WKSP_ALLOC_ALIGN_MIN );
+
+  ulong part_cnt_before = wksp->part_cnt;
+  wksp->owner        = dead_pid();
+  wksp->idle_cidx    = pinfo[j].next_cidx;
+  pinfo[j].tag       = 0UL;
+  pinfo[j].gaddr_lo  = pinfo[i].gaddr_lo + FD_WKSP_ALLOC_ALIGN_MIN;
+  pinfo[j].gaddr_hi  = pinfo[i].gaddr_hi;
+  wksp->root_cidx[0] = FD_WKSP_PRIVATE_PINFO_IDX_NULL; /* Trash the indices too */
+  wksp->root_cidx[1] = FD_WKSP_PRIVATE_PINFO_IDX_NULL;
+
+  dt = -fd_log_wallclock();
+  fd_wksp_check( wksp ); /* Recovers the lock */
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "recover: %.3f ms total (part_max %lu)", 1e-6*(double)dt, wksp->part_max ));
+
+  FD_TEST( wksp->part_cnt==part_cnt_before );
+  check_usage( wksp, part_cnt, used_sz );
+  for( ulong idx=0UL; idx<part_cnt; idx++ ) FD_TEST( fd_wksp_tag( wksp, gaddr[ idx ] )==1UL );
+
+  /* Teardown: free all partitions in a random order */
+
+  for( ulong idx=part_cnt-1UL; idx; idx-- ) {
+    ulong swap = fd_rng_ulong_roll( rng, idx+1UL );
+    ulong tmp = gaddr[ idx ]; gaddr[ idx ] = gaddr[ swap ]; gaddr[ swap ] = tmp;
+  }
+
+  dt = -fd_log_wallclock();
+  for( ulong idx=0UL; idx<part_cnt; idx++ ) fd_wksp_free( wksp, gaddr[ idx ] );
+  dt += fd_log_wallclock();
+  FD_LOG_NOTICE(( "free:    %.3f ms total, %.1f ns/partition", 1e-6*(double)dt, (double)dt/(double)part_cnt ));
+
+  check_usage( wksp, 0UL, 0UL );
+  FD_TEST( wksp->part_cnt==2UL ); /* the gaddr array and the rest of the wksp */
+
+  fd_wksp_free_laddr( gaddr );
+  FD_TEST( wksp->part_cnt==1UL );
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+  fd_wksp_delete_anonymous( wksp );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif
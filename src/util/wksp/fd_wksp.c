@@ -8,91 +8,400 @@
 
 /* Private APIs **********************************************/
 
-/* fd_wksp_private_make_hole increases the number of partitions in wksp
-   by 1.  Returns zero on success and non-zero on failure (e.g. not
-   enough room in wksp to increase the number of partitions).  On
-   success, new partitions [0,i) will be identical to old partitions
-   [0,i).  New partition i will be a hole such that
-   old_part[i]==new_part[i]==new_part[i+1] exactly and partitions
-   [i+1,new_part_cnt) will be identical to old partition
-   [i,old_part_cnt) respectively where new_part_cnt==old_part_cnt+1.
-   Partitions on unchanged on failure.  It is okay if
-   i==old_part_cnt==new_part_cnt-1.  This just indicates the created
-   hole will be at the very end.
-
-   This is implemented that that at all points in time while this is
-   running the partition storage will never lose any information about
-   existing partitions and there will be at most one hole somewhere in
-   the partitions.  As such, if the caller is terminated while doing
-   this, the operation can be rolled back by another thread by
-   compacting out any holes.  Assumes the caller has the wksp lock. */
+/* The partitioning of the wksp data region is described by the pinfo
+   array (see fd_wksp_private.h).  The ground truth for the partitioning
+   is the (gaddr_lo,gaddr_hi,tag) fields of each pinfo.  All other pinfo
+   fields and the wksp header cidx fields are indices over the ground
+   truth that allow alloc and free to run in O(lg part_cnt) (an address
+   ordered list, an address treap for finding the partition containing a
+   gaddr and a size treap for finding the best fit free partition).
+
+   Operations modify the ground truth such that, if the caller is
+   terminated at any point, the ground truth is in one of the following
+   states:
+
+   - a valid partitioning (possibly with address adjacent free
+     partitions), or
+
+   - a valid partitioning plus an extra live pinfo whose range is
+     contained within a lower address free partition (this is either
+     the free tail of a partition in the middle of being split or a free
+     partition in the middle of being merged into a lower address free
+     neighbor).
+
+   As such, the process that recovers the lock can roll back any
+   interrupted operation by discarding live pinfo contained within lower
+   address partitions, merging address adjacent free partitions and then
+   rebuilding all the indices from scratch (fd_wksp_private_rebuild).
+   The indices themselves are only modified while holding the lock and
+   do not need to be kept crash consistent.  Similar considerations
+   apply if the recovering process itself is terminated. */
+
+#define IDX_NULL FD_WKSP_PRIVATE_PINFO_IDX_NULL
+
+/* fd_wksp_private_prio returns the treap heap priority of pinfo idx.
+   Since fd_uint_hash is a permutation, priorities are unique. */
+
+static inline uint fd_wksp_private_prio( uint idx ) { return fd_uint_hash( idx ); }
+
+/* fd_wksp_private_key_lt returns 1 if the key of pinfo a is less than
+   the key of pinfo b for treap t and 0 otherwise. */
 
 static inline int
-fd_wksp_private_make_hole( fd_wksp_t * wksp,
-                           ulong       i ) {
-  ulong part_cnt = wksp->part_cnt;
-  if( FD_UNLIKELY( part_cnt>=wksp->part_max ) ) return 1;
-  fd_wksp_private_part_t * part = wksp->part;
+fd_wksp_private_key_lt( fd_wksp_private_pinfo_t const * pinfo,
+                        int                             t,
+                        uint                            a,
+                        uint                            b ) {
+  ulong a_lo = pinfo[a].gaddr_lo;
+  ulong b_lo = pinfo[b].gaddr_lo;
+  if( !t ) return a_lo<b_lo;
+  ulong a_sz = pinfo[a].gaddr_hi - a_lo;
+  ulong b_sz = pinfo[b].gaddr_hi - b_lo;
+  return (a_sz<b_sz) | ((a_sz==b_sz) & (a_lo<b_lo));
+}
+
+/* fd_wksp_private_treap_insert inserts pinfo n (not currently in treap
+   t) into treap t.  fd_wksp_private_treap_remove removes pinfo n
+   (currently in treap t) from treap t.  The key of pinfo n should not
+   change while n is in treap t.  Both are O(lg part_cnt) expected.
+   Assumes the caller has the wksp lock. */
+
+static void
+fd_wksp_private_treap_insert( fd_wksp_t * wksp,
+                              int         t,
+                              uint        n ) {
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+  uint                      prio  = fd_wksp_private_prio( n );
+
+  /* Descend to where n belongs in the heap order */
+
+  uint * hook = &wksp->root_cidx[t];
+  for(;;) {
+    uint r = *hook;
+    if( (r==IDX_NULL) || (prio>fd_wksp_private_prio( r )) ) break;
+    hook = &pinfo[r].child_cidx[t][ fd_wksp_private_key_lt( pinfo, t, r, n ) ];
+  }
+
+  /* Split the subtree there into the keys less than and greater than
+     n's key and make them n's children */
+
+  uint   r      = *hook;
+  uint * l_hook = &pinfo[n].child_cidx[t][0];
+  uint * r_hook = &pinfo[n].child_cidx[t][1];
+  while( r!=IDX_NULL ) {
+    if( fd_wksp_private_key_lt( pinfo, t, r, n ) ) { *l_hook = r; l_hook = &pinfo[r].child_cidx[t][1]; r = *l_hook; }
+    else                                           { *r_hook = r; r_hook = &pinfo[r].child_cidx[t][0]; r = *r_hook; }
+  }
+  *l_hook = IDX_NULL;
+  *r_hook = IDX_NULL;
+  *hook   = n;
+}
+
+static void
+fd_wksp_private_treap_remove( fd_wksp_t * wksp,
+                              int         t,
+                              uint        n ) {
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+
+  uint * hook = &wksp->root_cidx[t];
+  for(;;) {
+    uint r = *hook;
+    if( FD_UNLIKELY( r==IDX_NULL ) ) { FD_LOG_WARNING(( "corruption detected" )); return; }
+    if( r==n ) break;
+    hook = &pinfo[r].child_cidx[t][ fd_wksp_private_key_lt( pinfo, t, r, n ) ];
+  }
+
+  /* Replace n with the merge of its children */
+
+  uint a = pinfo[n].child_cidx[t][0];
+  uint b = pinfo[n].child_cidx[t][1];
+  for(;;) {
+    if( a==IDX_NULL ) { *hook = b; break; }
+    if( b==IDX_NULL ) { *hook = a; break; }
+    if( fd_wksp_private_prio( a )>fd_wksp_private_prio( b ) ) { *hook = a; hook = &pinfo[a].child_cidx[t][1]; a = *hook; }
+    else                                                      { *hook = b; hook = &pinfo[b].child_cidx[t][0]; b = *hook; }
+  }
+}
 
-  /* Make a hole at the end */
+/* fd_wksp_private_containing returns the index of the live pinfo whose
+   range contains gaddr or IDX_NULL if none.  fd_wksp_private_fit
+   returns the index of the free partition with the smallest size at
+   least sz (lowest address breaking ties) or IDX_NULL if none.
+   fd_wksp_private_fit_next returns the index of the free partition with
+   the next larger size key after free partition n or IDX_NULL if none.
+   All are O(lg part_cnt) expected.  Assumes the caller has the wksp
+   lock. */
+
+static inline uint
+fd_wksp_private_containing( fd_wksp_t const * wksp,
+                            ulong             gaddr ) {
+  fd_wksp_private_pinfo_t const * pinfo = wksp->pinfo;
+  uint best = IDX_NULL;
+  uint r    = wksp->root_cidx[0];
+  while( r!=IDX_NULL ) {
+    int c = pinfo[r].gaddr_lo<=gaddr;
+    best  = c ? r : best;
+    r     = pinfo[r].child_cidx[0][c];
+  }
+  if( FD_UNLIKELY( (best==IDX_NULL) || (gaddr>=pinfo[best].gaddr_hi) ) ) return IDX_NULL;
+  return best;
+}
+
+static inline uint
+fd_wksp_private_fit( fd_wksp_t const * wksp,
+                     ulong             sz ) {
+  fd_wksp_private_pinfo_t const * pinfo = wksp->pinfo;
+  uint best = IDX_NULL;
+  uint r    = wksp->root_cidx[1];
+  while( r!=IDX_NULL ) {
+    int c = (pinfo[r].gaddr_hi - pinfo[r].gaddr_lo)>=sz;
+    best  = c ? r : best;
+    r     = pinfo[r].child_cidx[1][!c];
+  }
+  return best;
+}
+
+static inline uint
+fd_wksp_private_fit_next( fd_wksp_t const * wksp,
+                          uint              n ) {
+  fd_wksp_private_pinfo_t const * pinfo = wksp->pinfo;
+  uint best = IDX_NULL;
+  uint r    = wksp->root_cidx[1];
+  while( r!=IDX_NULL ) {
+    int c = fd_wksp_private_key_lt( pinfo, 1, n, r );
+    best  = c ? r : best;
+    r     = pinfo[r].child_cidx[1][!c];
+  }
+  return best;
+}
 
-  part_cnt++;
+/* fd_wksp_private_pinfo_acquire pops an idle pinfo and makes it a live
+   free partition covering [lo,hi) (lo<hi).  Returns the pinfo index on
+   success and IDX_NULL if there are no idle pinfo.  The pinfo becomes
+   live atomically on the final write and is not yet in any index.
+   fd_wksp_private_pinfo_release makes live pinfo n idle (atomically on
+   the first write) and pushes it onto the idle stack.  The caller
+   should have already removed it from all the indices.  Both are O(1).
+   Assumes the caller has the wksp lock. */
+
+static inline uint
+fd_wksp_private_pinfo_acquire( fd_wksp_t * wksp,
+                               ulong       lo,
+                               ulong       hi ) {
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+  uint n = wksp->idle_cidx;
+  if( FD_UNLIKELY( n==IDX_NULL ) ) return IDX_NULL;
+  wksp->idle_cidx = pinfo[n].next_cidx;
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( pinfo[n].tag      ) = 0UL;
   FD_COMPILER_MFENCE();
-  FD_VOLATILE( part[part_cnt] ) = part[part_cnt-1UL]; /* This has no impact until wksp->part_cnt is increased (tail clobbering) */
+  FD_VOLATILE( pinfo[n].gaddr_lo ) = lo; /* Still idle as gaddr_hi is 0 */
   FD_COMPILER_MFENCE();
-  FD_VOLATILE( wksp->part_cnt ) = part_cnt; /* Hole is made */
+  FD_VOLATILE( pinfo[n].gaddr_hi ) = hi; /* Live */
   FD_COMPILER_MFENCE();
 
-  /* We have a hole at partition (old) part_cnt / (new) part_cnt-1UL.
-     Move it to partition (old/new) i. */
+  wksp->part_cnt++;
+  return n;
+}
 
-  for( ulong hole=part_cnt-1UL; hole>i; hole-- ) {
-    FD_COMPILER_MFENCE();
-    FD_VOLATILE( part[hole] ) = part[hole-1UL];
-  }
+static inline void
+fd_wksp_private_pinfo_release( fd_wksp_t * wksp,
+                               uint        n ) {
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( pinfo[n].gaddr_hi ) = 0UL; /* Idle */
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( pinfo[n].gaddr_lo ) = 0UL;
+  FD_VOLATILE( pinfo[n].tag      ) = 0UL;
   FD_COMPILER_MFENCE();
-  return 0;
+
+  pinfo[n].next_cidx = wksp->idle_cidx;
+  wksp->idle_cidx    = n;
+  wksp->part_cnt--;
 }
 
-/* fd_wksp_private_compact_holes compacts all holes in the partition.
-   The caller promises partitions j for j<i for i in [0,part_cnt) are
-   already compact (i==part_cnt is a no-op as such indicates that the
-   caller already knows there are no holes).  The compaction is done
-   such that, if the caller is terminated doing this, the operation can
-   be safely resumed by another thread.  Assumes the caller has the wksp
-   lock. */
+/* fd_wksp_private_list_insert inserts pinfo n into the address ordered
+   list immediately after pinfo p.  fd_wksp_private_list_remove removes
+   pinfo n from the address ordered list.  Both are O(1).  Assumes the
+   caller has the wksp lock. */
+
+static inline void
+fd_wksp_private_list_insert( fd_wksp_t * wksp,
+                             uint        p,
+                             uint        n ) {
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+  uint q = pinfo[p].next_cidx;
+  pinfo[n].prev_cidx = p;
+  pinfo[n].next_cidx = q;
+  pinfo[p].next_cidx = n;
+  if( q!=IDX_NULL ) pinfo[q].prev_cidx = n;
+}
 
 static inline void
-fd_wksp_private_compact_holes( fd_wksp_t * wksp,
-                               ulong       i ) {
-  ulong                    part_cnt = wksp->part_cnt;
-  fd_wksp_private_part_t * part     = wksp->part;
-
-  ulong j = i;
-  for( ; i<part_cnt; i++ ) {
-    /* At this point partitions <j are known to be compact (and will
-       still be compact if this process is terminated and restarted).
-       Further we have examined original partitions <i (where j<=i) and
-       the compaction has insured that partitions k in (j,i) are where
-       the holes found so far are located.  We are looking for end of
-       new/old partition j/i (start of new/old partition j+1/i+1).  If
-       old partition i ends after the start of new partition j, old
-       partition i is not a hole and gives where new partition j should
-       end / new partition j+1 should begin. */
-    if( fd_wksp_private_part_gaddr( part[i+1UL] )<=fd_wksp_private_part_gaddr( part[j] ) ) continue; /* Partition i is a hole */
+fd_wksp_private_list_remove( fd_wksp_t * wksp,
+                             uint        n ) {
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+  uint p = pinfo[n].prev_cidx;
+  uint q = pinfo[n].next_cidx;
+  if( p!=IDX_NULL ) pinfo[p].next_cidx = q;
+  else              wksp->head_cidx    = q;
+  if( q!=IDX_NULL ) pinfo[q].prev_cidx = p;
+}
+
+/* fd_wksp_private_drop removes live pinfo n from the list and address
+   treap and releases it.  n should not be in the size treap.  Assumes
+   the caller has the wksp lock. */
+
+static inline void
+fd_wksp_private_drop( fd_wksp_t * wksp,
+                      uint        n ) {
+  fd_wksp_private_list_remove ( wksp,    n );
+  fd_wksp_private_treap_remove( wksp, 0, n );
+  fd_wksp_private_pinfo_release( wksp, n );
+}
+
+/* fd_wksp_private_free_part frees the allocated partition n and merges
+   it with any free address neighbors.  Returns the index of the
+   resulting free partition (which contains n's former range).  Assumes
+   the caller has the wksp lock. */
+
+static uint
+fd_wksp_private_free_part( fd_wksp_t * wksp,
+                           uint        n ) {
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+
+  /* Mark the partition as free */
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( pinfo[n].tag ) = 0UL;
+  FD_COMPILER_MFENCE();
+
+  /* If the next partition is free, expand n to cover it (making the
+     next partition contained in n) and then discard it. */
+
+  uint q = pinfo[n].next_cidx;
+  if( q!=IDX_NULL && !pinfo[q].tag ) {
+    fd_wksp_private_treap_remove( wksp, 1, q );
+    FD_COMPILER_MFENCE();
+    FD_VOLATILE( pinfo[n].gaddr_hi ) = pinfo[q].gaddr_hi;
     FD_COMPILER_MFENCE();
-    FD_VOLATILE( part[j] ) = part[i]; /* Doesn't change partition j start, just sets the tag correctly (probably theoretically
-                                         unnecessary provided holes are introduced into the partition array very carefully) */
+    fd_wksp_private_drop( wksp, q );
+  }
+
+  /* Similarly if the previous partition is free */
+
+  uint p = pinfo[n].prev_cidx;
+  if( p!=IDX_NULL && !pinfo[p].tag ) {
+    fd_wksp_private_treap_remove( wksp, 1, p );
     FD_COMPILER_MFENCE();
-    FD_VOLATILE( part[j+1UL] ) = part[i+1UL]; /* End partition j (tag might not be right for partition j+1 though) */
+    FD_VOLATILE( pinfo[p].gaddr_hi ) = pinfo[n].gaddr_hi;
     FD_COMPILER_MFENCE();
-    j++;
+    fd_wksp_private_drop( wksp, n );
+    n = p;
   }
-  FD_COMPILER_MFENCE();
-  FD_VOLATILE( part[j] ) = part[i]; /* See notes above about setting the tag */
-  FD_COMPILER_MFENCE();
-  FD_VOLATILE( wksp->part_cnt ) = j; /* Discard trailing holes */
-  FD_COMPILER_MFENCE();
+
+  fd_wksp_private_treap_insert( wksp, 1, n );
+  return n;
+}
+
+/* fd_wksp_private_rebuild repairs the ground truth of any operation
+   interrupted by a terminated process (see above) and then rebuilds all
+   the indices from the ground truth.  This is O(part_max + part_cnt lg
+   part_cnt).  Assumes the caller has the wksp lock.  If the caller is
+   terminated while running this, it is safe for another process to
+   rerun it. */
+
+void
+fd_wksp_private_rebuild( fd_wksp_t * wksp ) {
+  fd_wksp_private_pinfo_t * pinfo    = wksp->pinfo;
+  uint                      part_max = (uint)wksp->part_max;
+
+  wksp->part_cnt     = 0UL;
+  wksp->head_cidx    = IDX_NULL;
+  wksp->idle_cidx    = IDX_NULL;
+  wksp->root_cidx[0] = IDX_NULL;
+  wksp->root_cidx[1] = IDX_NULL;
+
+  /* Push the idle pinfo onto the idle stack (lowest index on top) and
+     insert the live pinfo into the address treap and address ordered
+     list. */
+
+  for( uint rem=part_max; rem; rem-- ) {
+    uint n = rem - 1U;
+
+    if( pinfo[n].gaddr_hi<=pinfo[n].gaddr_lo ) {
+      FD_COMPILER_MFENCE();
+      FD_VOLATILE( pinfo[n].gaddr_hi ) = 0UL;
+      FD_COMPILER_MFENCE();
+      FD_VOLATILE( pinfo[n].gaddr_lo ) = 0UL;
+      FD_VOLATILE( pinfo[n].tag      ) = 0UL;
+      FD_COMPILER_MFENCE();
+      pinfo[n].next_cidx = wksp->idle_cidx;
+      wksp->idle_cidx    = n;
+      continue;
+    }
+
+    fd_wksp_private_treap_insert( wksp, 0, n );
+    wksp->part_cnt++;
+
+    /* Find n's address predecessor and link n in after it */
+
+    uint p = IDX_NULL;
+    uint r = wksp->root_cidx[0];
+    while( r!=IDX_NULL ) {
+      int c = pinfo[r].gaddr_lo<pinfo[n].gaddr_lo;
+      p     = c ? r : p;
+      r     = pinfo[r].child_cidx[0][c];
+    }
+
+    if( p==IDX_NULL ) {
+      uint q = wksp->head_cidx;
+      pinfo[n].prev_cidx = IDX_NULL;
+      pinfo[n].next_cidx = q;
+      if( q!=IDX_NULL ) pinfo[q].prev_cidx = n;
+      wksp->head_cidx = n;
+    } else {
+      fd_wksp_private_list_insert( wksp, p, n );
+    }
+  }
+
+  /* Walk the partitions in address order, discarding partitions
+     contained in a lower address partition and merging adjacent free
+     partitions.  Free partitions that survive go into the size treap. */
+
+  uint  p       = IDX_NULL;
+  ulong gaddr   = wksp->gaddr_lo;
+  int   corrupt = 0;
+  for( uint n=wksp->head_cidx; n!=IDX_NULL; ) {
+    uint q = pinfo[n].next_cidx;
+
+    if( p!=IDX_NULL ) {
+      int overlap = pinfo[n].gaddr_lo< pinfo[p].gaddr_hi;
+      int merge   = (pinfo[n].gaddr_lo==pinfo[p].gaddr_hi) & !pinfo[p].tag & !pinfo[n].tag;
+      if( overlap | merge ) {
+        if( pinfo[n].gaddr_hi>pinfo[p].gaddr_hi ) {
+          corrupt |= overlap;
+          FD_COMPILER_MFENCE();
+          FD_VOLATILE( pinfo[p].gaddr_hi ) = pinfo[n].gaddr_hi; /* n now contained in p */
+          FD_COMPILER_MFENCE();
+        }
+        fd_wksp_private_drop( wksp, n );
+        n = q;
+        continue;
+      }
+      if( !pinfo[p].tag ) fd_wksp_private_treap_insert( wksp, 1, p );
+    }
+
+    corrupt |= pinfo[n].gaddr_lo!=gaddr;
+    gaddr = pinfo[n].gaddr_hi;
+    p     = n;
+    n     = q;
+  }
+  if( p!=IDX_NULL && !pinfo[p].tag ) fd_wksp_private_treap_insert( wksp, 1, p );
+
+  if( FD_UNLIKELY( corrupt | (gaddr!=wksp->gaddr_hi) ) ) FD_LOG_WARNING(( "wksp %s corruption detected", wksp->name ));
 }
 
 void
@@ -116,34 +425,13 @@ fd_wksp_private_lock( fd_wksp_t * wksp ) {
 
         if( FD_ATOMIC_CAS( _owner, pid, me )==pid ) {
 
-          /* We reclaimed the lock.  The partitions might be in an
-             inconsistent state (specifically, there might be inactive
-             partitions adjacent to each other and there might be holes
-             ... partitions that are empty).  Find and repair any
-             damage.  If we die in repair, it is okay as others will be
-             able to complete our repairs. */
-
-          ulong                    part_cnt = wksp->part_cnt;
-          fd_wksp_private_part_t * part     = wksp->part;
-          
-          /* Merging any adjacent inactive partitions that might have
-             been left when the owner was killed.  Leading adjacent
-             inactive partionings will become holes.  (FIXME: MERGE
-             TRAILING TO GET ACTIVE BIT PROPAGATION BETTER TO SPEED UP
-             COMPACT HOLES?) */
-
-          for( ulong i=1UL; i<part_cnt; i++ ) 
-            if( ((int)!fd_wksp_private_part_tag( part[i-1UL] )) &
-                ((int)!fd_wksp_private_part_tag( part[i    ] )) ) { /* clang makes babies cry */
-              FD_COMPILER_MFENCE();
-              FD_VOLATILE( part[i] ) = part[i-1UL];
-              FD_COMPILER_MFENCE();
-            }
-
-          /* Compact out any holes formed above and/or left when the
-             owner was killed.  */
-
-          fd_wksp_private_compact_holes( wksp, 0UL );
+          /* We reclaimed the lock.  The partitioning might be in the
+             middle of an interrupted operation and the indices might be
+             inconsistent.  Roll back any interrupted operation and
+             rebuild the indices.  If we die in repair, it is okay as
+             others will be able to redo our repairs. */
+
+          fd_wksp_private_rebuild( wksp );
 
           /* We have the lock and the partitioning is repaired. */
           FD_COMPILER_MFENCE();
@@ -488,60 +776,61 @@ fd_wksp_new( void *       shmem,
 
        part_max = data_region_sz / ALIGN_MIN
 
-     partitions.  This in turn require partition array of size:
+     partitions.  This in turn require pinfo array of size:
 
-       sizeof(fd_wksp_private_part_t)*(part_max+1)
+       sizeof(fd_wksp_private_pinfo_t)*part_max
        
      which in turn is carved out of the overall workspace.  The wksp
      header is also carved out of the workspace as is any padding
      necessary for alignment.  The general upshot is then, we'd like to
      a pick partition max such that:
 
-       hdr_sz + (part_max+1)*sizeof(fd_wksp_private_part_t) + padding + part_max*ALIGN_MIN ~ footprint
+       hdr_sz + part_max*sizeof(fd_wksp_private_pinfo_t) + padding + part_max*ALIGN_MIN ~ footprint
 
      solving for part_max, we have:
 
-       part_max ~ (footprint - hdr_sz - sizeof(fd_wksp_private_part_t) - padding) / (ALIGN_MIN+sizeof(fd_wksp_private_part_t))
+       part_max ~ (footprint - hdr_sz - padding) / (ALIGN_MIN+sizeof(fd_wksp_private_pinfo_t))
 
      The padding itself is complex function of this but since we'd
      prefer to overestimate part_max, we can just use the lower bound of
      zero, yielding a reasonble tight upper bound of:
 
-       part_max ~ ceil( (footprint - hdr_sz - sizeof(fd_wksp_private_part_t)) / (ALIGN_MIN+sizeof(fd_wksp_private_part_t) ) )
+       part_max ~ ceil( (footprint - hdr_sz) / (ALIGN_MIN+sizeof(fd_wksp_private_pinfo_t) ) )
 
      which in turn can be rewritten C friendly as:
 
-       part_max ~ (footprint - hdr_sz - sizeof(fd_wksp_private_part_t) + ALIGN_MIN+sizeof(fd_wksp_private_part_t)-1U) /
-                  (ALIGN_MIN+sizeof(fd_wksp_private_part_t) ) )
+       part_max ~ (footprint - hdr_sz + ALIGN_MIN+sizeof(fd_wksp_private_pinfo_t)-1U) /
+                  (ALIGN_MIN+sizeof(fd_wksp_private_pinfo_t))
 
-     or:
-
-       part_max ~ (footprint - hdr_sz + ALIGN_MIN - 1U) / (ALIGN_MIN+sizeof(fd_wksp_private_part_t))
-       
-     For a 4KiB align min and 8 byte fd_wksp_private_part_t, this in
-     turn implies there is an asymptotic 0.2% overhead for wksp metadata
-     storage. */
+     For a 4KiB align min and 48 byte fd_wksp_private_pinfo_t, this in
+     turn implies there is an asymptotic 1.2% overhead for wksp metadata
+     storage.  Since pinfo indices are uint, part_max is also capped at
+     UINT_MAX (this only matters for wksp larger than ~16 TiB). */
 
-  ulong part_max_default = (footprint - FD_WKSP_PRIVATE_HDR_SZ + FD_WKSP_ALLOC_ALIGN_MIN - 1UL)
-                         / (FD_WKSP_ALLOC_ALIGN_MIN + sizeof(fd_wksp_private_part_t));
+  ulong part_max_default = (footprint - FD_WKSP_PRIVATE_HDR_SZ + FD_WKSP_ALLOC_ALIGN_MIN + sizeof(fd_wksp_private_pinfo_t) - 1UL)
+                         / (FD_WKSP_ALLOC_ALIGN_MIN + sizeof(fd_wksp_private_pinfo_t));
+  part_max_default = fd_ulong_min( part_max_default, (ulong)UINT_MAX );
   if( ((!part_max) | (part_max>part_max_default)) ) part_max = part_max_default;
 
-  ulong gaddr_lo = fd_ulong_align_up( FD_WKSP_PRIVATE_HDR_SZ + (part_max+1UL)*sizeof(fd_wksp_private_part_t),
-                                      FD_WKSP_ALLOC_ALIGN_MIN );
+  ulong gaddr_lo = fd_ulong_align_up( FD_WKSP_PRIVATE_HDR_SZ + part_max*sizeof(fd_wksp_private_pinfo_t), FD_WKSP_ALLOC_ALIGN_MIN );
   ulong gaddr_hi = footprint;
 
   /* Consider zeroing out all wskp memory here (e.g. init padding to
      zero, touch all the memory in the wksp, etc) */
 
   wksp->owner    = ULONG_MAX;
-  wksp->part_cnt = 1UL;
   wksp->part_max = part_max;
   wksp->gaddr_lo = gaddr_lo;
   wksp->gaddr_hi = gaddr_hi;
   fd_memcpy( wksp->name, name, name_len+1UL );
-  wksp->part[0]  = fd_wksp_private_part( 0UL, gaddr_lo );
-  wksp->part[1]  = fd_wksp_private_part( 1UL, gaddr_hi ); /* A non-zero tag is used to indicate there is nothing allocatable beyond
-                                                             the wksp end (free makes use of this for merging logic) */
+
+  /* Start with all pinfo idle except pinfo 0, which is a free
+     partition covering the whole data region, and build the indices */
+
+  fd_memset( wksp->pinfo, 0, part_max*sizeof(fd_wksp_private_pinfo_t) );
+  wksp->pinfo[0].gaddr_lo = gaddr_lo;
+  wksp->pinfo[0].gaddr_hi = gaddr_hi;
+  fd_wksp_private_rebuild( wksp );
 
   FD_COMPILER_MFENCE();
   FD_VOLATILE( wksp->magic ) = FD_WKSP_MAGIC;
@@ -678,102 +967,111 @@ fd_wksp_alloc( fd_wksp_t * wksp,
 
   if( FD_UNLIKELY( !sz ) ) return 0UL;
 
-  fd_wksp_private_lock( wksp );
-
-  fd_wksp_private_part_t * part     = wksp->part;
-  ulong                    part_cnt = wksp->part_cnt;
-
-  for( ulong i=0UL; i<part_cnt; i++ ) {      
-    fd_wksp_private_part_t part_i = part[i];
-    if( fd_wksp_private_part_tag( part_i ) ) continue;
-
-    ulong lo = fd_wksp_private_part_gaddr( part_i );                /* At least FD_WKSP_ALLOC_ALIGN_MIN aligned */
-    ulong r0 = fd_ulong_align_up( lo,    align );                   /* " */
-    ulong r1 = fd_ulong_align_up( r0+sz, FD_WKSP_ALLOC_ALIGN_MIN ); /* " */
-    ulong hi = fd_wksp_private_part_gaddr( part[i+1UL] );           /* " */
-
-    if( ((lo<=r0) & (r0<r1) & (r1<=hi)) ) { /* Implictly covers sz / align so large as to wrap */
-
-      /* Partition i can handle the request (using a first-fit address
-         ordered policy with a block size of FD_WKSP_ALLOC_ALIGN_MIN,
-         which has empirically found to be very robust to fragmentation
-         in the literature).  Split off any leading blocks of partition
-         i that would otherwise be lost from request alignment. */
-
-      if( lo<r0 ) {
+  /* Any free partition with at least sz_min bytes can hold the request
+     if it happens to be suitably aligned and any free partition with
+     at least sz_max bytes can hold the request regardless of alignment
+     (as partitions are at least FD_WKSP_ALLOC_ALIGN_MIN aligned). */
 
-        /* If we don't have enough free storage to split this partition,
-           we use the whole partition for this request (potentially
-           wasteful but more a question of when alloc will start failing
-           ... this has at least a chance of surviving).  FIXME:
-           CONSIDER EXPLORING MORE RANGES? LOGGING A WARNING? */
-
-        if( fd_wksp_private_make_hole( wksp, i+1UL ) ) {
-          FD_COMPILER_MFENCE();
-          FD_VOLATILE( part[i] ) = fd_wksp_private_part( tag, lo );
-          FD_COMPILER_MFENCE();
-          fd_wksp_private_unlock( wksp ); /* Inside the partition but free can handle that */
-          return r0;
-        }
-
-        /* We have a hole at partition i+1 such that
-           old_part[i+1]==new_part[i+1]==new_part[i+2] and atomically
-           contract/expand partition i/i+1 into the appropriate split. */
-
-        FD_COMPILER_MFENCE();
-        FD_VOLATILE( part[i+1UL] ) = fd_wksp_private_part( 0UL, r0 );
-        FD_COMPILER_MFENCE();
-
-        /* At this point, partition i holds the blocks trimmed off to
-           align the request and partition i+1 is where the request will
-           actually end up.  Advance i into the next partition that will
-           end up holding the request. */
+  ulong sz_min = fd_ulong_align_up( sz, FD_WKSP_ALLOC_ALIGN_MIN );
+  ulong sz_max = sz_min + align - FD_WKSP_ALLOC_ALIGN_MIN;
+  if( FD_UNLIKELY( (sz_min<sz) | (sz_max<sz_min) ) ) {
+    FD_LOG_WARNING(( "No usable workspace free space available" ));
+    return 0UL;
+  }
 
-        i++;
-        lo = r0;
-      }
+  fd_wksp_private_lock( wksp );
 
-      /* Partition i as tight as possible for the requested alignment
-         but might be larger than necessary.  Split off trailing blocks
-         of the partition that would otherwise be lost. */
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+
+  /* Find the free partition to use for the request (using a best-fit
+     policy with a block size of FD_WKSP_ALLOC_ALIGN_MIN, lowest address
+     breaking ties, which has also been found empirically to be very
+     robust to fragmentation in the literature).  We first try the
+     smallest partition that could hold the request.  If that doesn't
+     work out due to alignment, we try the smallest partition that is
+     guaranteed to hold the request.  If there are no such partitions,
+     we fall back on scanning the remaining candidates in size order
+     (this last case only happens when the wksp is nearly full or very
+     fragmented). */
+
+  uint  i  = fd_wksp_private_fit( wksp, sz_min );
+  ulong lo = 0UL;
+  ulong r0 = 0UL;
+  ulong r1 = 0UL;
+  ulong hi = 0UL;
+  int   second = 0;
+  while( i!=IDX_NULL ) {
+    lo = pinfo[i].gaddr_lo;                        /* At least FD_WKSP_ALLOC_ALIGN_MIN aligned */
+    r0 = fd_ulong_align_up( lo,    align );        /* " */
+    r1 = fd_ulong_align_up( r0+sz, FD_WKSP_ALLOC_ALIGN_MIN ); /* " */
+    hi = pinfo[i].gaddr_hi;                        /* " */
+    if( ((lo<=r0) & (r0<r1) & (r1<=hi)) ) break; /* Implictly covers sz / align so large as to wrap */
+    if( !second ) {
+      second = 1;
+      uint j = fd_wksp_private_fit( wksp, sz_max );
+      if( j!=IDX_NULL ) { i = j; continue; }
+    }
+    i = fd_wksp_private_fit_next( wksp, i );
+  }
 
-      if( r1<hi ) {
+  if( FD_UNLIKELY( i==IDX_NULL ) ) {
+    /* No partition can handle this request right now.  Fail. */
+    fd_wksp_private_unlock( wksp );
+    FD_LOG_WARNING(( "No usable workspace free space available" ));
+    return 0UL;
+  }
 
-        /* The splitting logic here is identical to the above */
+  /* Partition i can handle the request.  It will be resized below so
+     take it out of the size treap. */
 
-        if( fd_wksp_private_make_hole( wksp, i+1UL ) ) {
-          FD_COMPILER_MFENCE();
-          FD_VOLATILE( part[i] ) = fd_wksp_private_part( tag, lo );
-          FD_COMPILER_MFENCE();
-          fd_wksp_private_unlock( wksp );
-          return lo;
-        }
+  fd_wksp_private_treap_remove( wksp, 1, i );
 
-        FD_COMPILER_MFENCE();
-        FD_VOLATILE( part[i+1UL] ) = fd_wksp_private_part( 0UL, r1 );
-        FD_COMPILER_MFENCE();
+  /* Split off trailing blocks of the partition that would otherwise be
+     lost.  We create the free trailing partition first (it is contained
+     in partition i until partition i is shrunk).  If we don't have
+     enough free pinfo to split this partition, we use the whole tail
+     for this request (potentially wasteful but more a question of when
+     alloc will start failing ... this has at least a chance of
+     surviving).  FIXME: CONSIDER LOGGING A WARNING? */
 
-        /* At this point, partition i+1 holds the blocks trimmed off to
-           pack the request tightly and partition i is where the request
-           will actually end up. */
-      }
+  if( r1<hi ) {
+    uint j = fd_wksp_private_pinfo_acquire( wksp, r1, hi );
+    if( FD_LIKELY( j!=IDX_NULL ) ) {
+      FD_COMPILER_MFENCE();
+      FD_VOLATILE( pinfo[i].gaddr_hi ) = r1;
+      FD_COMPILER_MFENCE();
+      fd_wksp_private_list_insert ( wksp,    i, j );
+      fd_wksp_private_treap_insert( wksp, 0,    j );
+      fd_wksp_private_treap_insert( wksp, 1,    j );
+      hi = r1;
+    }
+  }
 
-      /* Partition i is as tight as possible for the request. */
+  /* Similarly split off any leading blocks that would otherwise be lost
+     from request alignment.  This time, the request ends up in the
+     newly created partition.  If we can't split, the request ends up
+     inside partition i (but free can handle that). */
 
+  if( lo<r0 ) {
+    uint j = fd_wksp_private_pinfo_acquire( wksp, r0, hi );
+    if( FD_LIKELY( j!=IDX_NULL ) ) {
       FD_COMPILER_MFENCE();
-      FD_VOLATILE( part[i] ) = fd_wksp_private_part( tag, lo );
+      FD_VOLATILE( pinfo[i].gaddr_hi ) = r0;
       FD_COMPILER_MFENCE();
-      fd_wksp_private_unlock( wksp );
-      return lo;
+      fd_wksp_private_list_insert ( wksp,    i, j );
+      fd_wksp_private_treap_insert( wksp, 0,    j );
+      fd_wksp_private_treap_insert( wksp, 1,    i );
+      i = j;
     }
-
-    /* This partition cannot handle the request. */
   }
 
-  /* No partition can handle this request right now.  Fail. */
+  /* Partition i is as tight as possible for the request. */
+
+  FD_COMPILER_MFENCE();
+  FD_VOLATILE( pinfo[i].tag ) = tag;
+  FD_COMPILER_MFENCE();
   fd_wksp_private_unlock( wksp );
-  FD_LOG_WARNING(( "No usable workspace free space available" ));
-  return 0UL;
+  return r0;
 }
 
 void
@@ -795,74 +1093,13 @@ fd_wksp_free( fd_wksp_t * wksp,
 
   /* At this point we know gaddr points into a partition and we know
      that the partition it points to is stable because we have the lock.
-     Since partitions are monotonically increasing, we can use a binary
-     search to find the containing partition. */
-
-  fd_wksp_private_part_t * part     = wksp->part;
-  ulong                    part_cnt = wksp->part_cnt;
-
-  ulong l = 0UL;
-  ulong h = wksp->part_cnt;
-  for(;;) {
-    ulong cnt = h - l;
-    if( cnt<=1UL ) break;
-    ulong m = l + (cnt>>1);
-    int   c = gaddr < fd_wksp_private_part_gaddr( part[m] );
-    /**/  l = fd_ulong_if( c, l, m ); /* cmov */
-    /**/  h = fd_ulong_if( c, m, h ); /* cmov */
-  }
-
-  if( FD_UNLIKELY( h==l ) ) {
-
-    FD_LOG_WARNING(( "corruption detected" ));
-
-  } else if( FD_UNLIKELY( !fd_wksp_private_part_tag( part[l] ) ) ) {
-
-    FD_LOG_WARNING(( "gaddr does not seem to point to a current wksp allocation" ));
-
-  } else {
+     Use the address treap to find the containing partition. */
 
-    ulong gaddr_lo = fd_wksp_private_part_gaddr( part[l] );
-    ulong hole_idx = part_cnt;
+  uint i = fd_wksp_private_containing( wksp, gaddr );
 
-    /* Mark the partition as free */
-
-    FD_COMPILER_MFENCE();
-    FD_VOLATILE( part[l] ) = fd_wksp_private_part( 0UL, gaddr_lo );
-    FD_COMPILER_MFENCE();
-
-    /* At this point, there are at most three contiguous inactive
-       partitions and zero holes.  If partition l+1 is also inactive,
-       atomically expand/contract partition l/l+1 to make partition l
-       the merged partition and partition l+1 a hole.  Since
-       part[part_cnt] is marked as active, no bounds checking is
-       necessary (but wouldn't otherwise hurt). */
-
-    if( /*(l+1UL)<part_cnt &&*/ !fd_wksp_private_part_tag( part[l+1UL] ) ) {
-      FD_COMPILER_MFENCE();
-      FD_VOLATILE( part[l+1UL] ) = part[l+2UL];
-      FD_COMPILER_MFENCE();
-      hole_idx = l+1UL;
-    }
-
-    /* At this point, there are at most two contiguous inactive
-       partitions and one hole.  If partition l-1 is also inactive,
-       atomically expand/contract partition l-1/l to make partition l-1
-       the merged partition and partition l a hole. */
-
-    if( l>0UL && !fd_wksp_private_part_tag( part[l-1UL] ) ) {
-      FD_COMPILER_MFENCE();
-      FD_VOLATILE( part[l] ) = part[l+1UL];
-      FD_COMPILER_MFENCE();
-      hole_idx = l;
-    }
-
-    /* At this point, there are no adjacent contiguous inactive
-       partitions but either zero, one or two holes starting at
-       hole_idx.  Compact them out. */
-
-    fd_wksp_private_compact_holes( wksp, hole_idx );
-  }
+  if(      FD_UNLIKELY( i==IDX_NULL          ) ) FD_LOG_WARNING(( "corruption detected" ));
+  else if( FD_UNLIKELY( !wksp->pinfo[i].tag ) ) FD_LOG_WARNING(( "gaddr does not seem to point to a current wksp allocation" ));
+  else                                           fd_wksp_private_free_part( wksp, i );
 
   fd_wksp_private_unlock( wksp );
 }
@@ -880,23 +1117,12 @@ fd_wksp_tag( fd_wksp_t * wksp,
 
   /* At this point we know gaddr points into a partition and we know
      that the partition it points to is stable because we have the lock.
-     Since partitions are monotonically increasing, we can use a binary
-     search to find the containing partition. */
+     Use the address treap to find the containing partition. */
 
-  fd_wksp_private_part_t * part = wksp->part;
-  ulong                    l    = 0UL;
-  ulong                    h    = wksp->part_cnt;
-  for(;;) {
-    ulong cnt = h - l;
-    if( cnt<=1UL ) break;
-    ulong m = l + (cnt>>1);
-    int   c = gaddr < fd_wksp_private_part_gaddr( part[m] ); /* Yes, strict < */
-    /**/  l = fd_ulong_if( c, l, m ); /* cmov */
-    /**/  h = fd_ulong_if( c, m, h ); /* cmov */
-  }
+  uint i = fd_wksp_private_containing( wksp, gaddr );
 
-  if( FD_UNLIKELY( l==h ) ) tag = 0UL; /* Corruption detected */
-  else                      tag = fd_wksp_private_part_tag( part[l] );
+  if( FD_UNLIKELY( i==IDX_NULL ) ) tag = 0UL; /* Corruption detected */
+  else                             tag = wksp->pinfo[i].tag;
 
   fd_wksp_private_unlock( wksp );
 
@@ -935,47 +1161,17 @@ fd_wksp_tag_free( fd_wksp_t *   wksp,
 
   fd_wksp_private_lock( wksp );
   
-  /* We scan the partitions backwards and whenever we find a partition
-     that matches tag, we mark it inactive and merge it with adjacent
-     inactive partitions via the exact same process as free.  This has
-     the nice property that any holes that get introduced will be at or
-     after the current partition and that any holes that get introduced
-     will have a non-zero tag (be "active").  That means, at the start
-     of each loop body that matches a tag, the partition immediately
-     above not an inactive hole. */
-
-  fd_wksp_private_part_t * part     = wksp->part;
-  ulong                    part_cnt = wksp->part_cnt;
-  ulong                    hole_idx = part_cnt;
-  for( ulong rem=part_cnt; rem; rem-- ) {
-    ulong l = rem - 1UL;
-    if( !fd_wksp_alloc_tag_set_test( set, fd_wksp_private_part_tag( part[l] ) ) ) continue; /* app dependent probabilty */
-
-    ulong gaddr_lo = fd_wksp_private_part_gaddr( part[l] );
-  
-    FD_COMPILER_MFENCE();
-    FD_VOLATILE( part[l] ) = fd_wksp_private_part( 0UL, gaddr_lo );
-    FD_COMPILER_MFENCE();
-  
-    if( /*(l+1UL)<part_cnt &&*/ !fd_wksp_private_part_tag( part[l+1UL] ) ) {
-      FD_COMPILER_MFENCE();
-      FD_VOLATILE( part[l+1UL] ) = part[l+2UL];
-      FD_COMPILER_MFENCE();
-      hole_idx = l+1UL;
-    }
-  
-    if( l>0UL && !fd_wksp_private_part_tag( part[l-1UL] ) ) {
-      FD_COMPILER_MFENCE();
-      FD_VOLATILE( part[l] ) = part[l+1UL];
-      FD_COMPILER_MFENCE();
-      hole_idx = l;
-    }
-  }
-  
-  /* Compact out any holes that got introduced. */
-  
-  fd_wksp_private_compact_holes( wksp, hole_idx );
-  
+  /* We scan the partitions in address order and whenever we find a
+     partition that matches tag, we free it via the exact same process
+     as free.  The partition resulting from the free has the same next
+     partition as the freed partition had (or the one after it if the
+     merge absorbed the next partition, which, being free, could not
+     have matched), so we can continue the scan from it. */
+
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+  for( uint i=wksp->head_cidx; i!=IDX_NULL; i=pinfo[i].next_cidx )
+    if( fd_wksp_alloc_tag_set_test( set, pinfo[i].tag ) ) i = fd_wksp_private_free_part( wksp, i ); /* app dependent prob */
+
   fd_wksp_private_unlock( wksp );
 
   fd_wksp_alloc_tag_set_delete( fd_wksp_alloc_tag_set_leave( set ) );
@@ -1023,26 +1219,15 @@ fd_wksp_memset( fd_wksp_t * wksp,
 
   fd_wksp_private_lock( wksp );
 
-  /* For all active partitions */
-
-  fd_wksp_private_part_t * part     = wksp->part;
-  ulong                    part_cnt = wksp->part_cnt;
-  for( ulong i=0UL; i<part_cnt; i++ ) {
-    fd_wksp_private_part_t part_i = part[i];
-    if( !fd_wksp_private_part_tag( part[i] ) ) continue;
-
-    ulong lo = fd_wksp_private_part_gaddr( part_i      ); /* At least FD_WKSP_ALLOC_ALIGN_MIN aligned */
-    ulong hi = fd_wksp_private_part_gaddr( part[i+1UL] ); /* " */
+  /* If gaddr is in an active partition, clear the whole partition */
 
-    /* If addr is in this active partition, ... */
-
-    if( ((lo<=gaddr) & (gaddr<hi)) ) { /* Yes, strict < for hi */
-      fd_memset( fd_wksp_laddr( wksp, gaddr ), c, hi-lo );
-      fd_wksp_private_unlock( wksp );
-      return;
-    }
-
-    /* This partition cannot handle the request. */
+  uint i = fd_wksp_private_containing( wksp, gaddr );
+  if( FD_LIKELY( (i!=IDX_NULL) && wksp->pinfo[i].tag ) ) {
+    ulong lo = wksp->pinfo[i].gaddr_lo;
+    ulong hi = wksp->pinfo[i].gaddr_hi;
+    fd_memset( fd_wksp_laddr_fast( wksp, lo ), c, hi-lo );
+    fd_wksp_private_unlock( wksp );
+    return;
   }
 
   /* addr not found in an active partition */
@@ -1077,29 +1262,31 @@ fd_wksp_reset( fd_wksp_t * wksp ) {
 
   fd_wksp_private_lock( wksp );
 
-  /* Free partition 0 and expand it cover the entire data region to make
-     all other partitions holes atomically.  Could be done as two
-     separate writes ala:
+  /* Free the first partition and expand it cover the entire data
+     region such that all other partitions are contained in it
+     atomically.  Could be done as two separate writes ala:
 
        FD_COMPILER_MFENCE();
-       FD_VOLATILE( wksp->part[0] ) = fd_wksp_private_part( 0UL, wksp->gaddr_lo );
+       FD_VOLATILE( pinfo[head].tag      ) = 0UL;
        FD_COMPILER_MFENCE();
-       FD_VOLATILE( wksp->part[1] ) = fd_wksp_private_part( 1UL, wksp->gaddr_hi );
+       FD_VOLATILE( pinfo[head].gaddr_hi ) = wksp->gaddr_hi;
        FD_COMPILER_MFENCE();
 
      but it becomes theoretically possible for the caller to be killed
-     after the first write such that the effect would only to free
-     partition 0.  Doing both writes concurrently makes the entire
-     operation atomic.  See note in fd_wksp_new and fd_wksp_free why the
-     part[1] is marked as active. */
+     after the first write such that the effect would only to free the
+     first partition.  Doing both writes concurrently makes the entire
+     operation atomic.  The rebuild then discards all the other
+     partitions (exactly as a recovering process would). */
+
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+  uint                      head  = wksp->head_cidx;
 
   FD_COMPILER_MFENCE();
-  _mm_store_si128( (__m128i *)wksp->part, _mm_set_epi64x( (long)fd_wksp_private_part( 1UL, wksp->gaddr_hi ),
-                                                          (long)fd_wksp_private_part( 0UL, wksp->gaddr_lo ) ) );
-  FD_COMPILER_MFENCE();
-  FD_VOLATILE( wksp->part_cnt ) = 1UL; /* Trim off all holes */
+  _mm_store_si128( (__m128i *)&pinfo[head].gaddr_hi, _mm_set_epi64x( 0L, (long)wksp->gaddr_hi ) ); /* tag, gaddr_hi */
   FD_COMPILER_MFENCE();
 
+  fd_wksp_private_rebuild( wksp );
+
   fd_wksp_private_unlock( wksp );
 }
 
@@ -1179,19 +1366,10 @@ fd_wksp_usage( fd_wksp_t *       wksp,
 
   usage->total_max = wksp->part_max;
 
-  fd_wksp_private_part_t const * part     = wksp->part;
-  ulong                          part_cnt = wksp->part_cnt;
-
-  fd_wksp_private_part_t part_hi  = part[0];
-  ulong                  gaddr_hi = fd_wksp_private_part_gaddr( part_hi );
-  for( ulong part_idx=0UL; part_idx<part_cnt; part_idx++ ) {
-    fd_wksp_private_part_t part_lo  = part_hi;
-    /**/                   part_hi  = part[part_idx+1UL];
-    ulong                  gaddr_lo = gaddr_hi;
-    /**/                   gaddr_hi = fd_wksp_private_part_gaddr( part_hi );
-
-    ulong part_tag = fd_wksp_private_part_tag( part_lo );
-    ulong part_sz  = gaddr_hi - gaddr_lo;
+  fd_wksp_private_pinfo_t const * pinfo = wksp->pinfo;
+  for( uint i=wksp->head_cidx; i!=IDX_NULL; i=pinfo[i].next_cidx ) {
+    ulong part_tag = pinfo[i].tag;
+    ulong part_sz  = pinfo[i].gaddr_hi - pinfo[i].gaddr_lo;
 
     int is_free = !part_tag;
     int is_used = fd_wksp_alloc_tag_set_test( set, part_tag );
@@ -1208,4 +1386,6 @@ fd_wksp_usage( fd_wksp_t *       wksp,
   return usage;
 }
 
+#undef IDX_NULL
+
 #endif
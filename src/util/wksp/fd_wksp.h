@@ -3,6 +3,7 @@
 
 #include "../pod/fd_pod.h"
 #include "../shmem/fd_shmem.h"
+#include "../tpool/fd_tpool.h"
 
 #if FD_HAS_HOSTED && FD_HAS_X86
 
@@ -121,6 +122,18 @@
 
 #define FD_WKSP_ALLOC_TAG_MAX (FD_WKSP_ALLOC_ALIGN_MIN-1UL)
 
+/* FD_WKSP_CHECKPT_STYLE_* specify how fd_wksp_checkpt writes a
+   checkpt.  RAW writes just the allocations and their metadata.  HASH
+   additionally stores a hash of the data for each frame (a checkpt
+   splits allocations into frames of at most FD_WKSP_CHECKPT_FRAME_MAX
+   bytes) such that fd_wksp_restore can detect data corruption at a
+   modest cost in throughput. */
+
+#define FD_WKSP_CHECKPT_STYLE_RAW  (0)
+#define FD_WKSP_CHECKPT_STYLE_HASH (1)
+
+#define FD_WKSP_CHECKPT_FRAME_MAX (1UL<<26)
+
 /* A fd_wksp_t * is an opaque handle of a workspace */
 
 struct fd_wksp_private;
@@ -470,7 +483,7 @@ static inline void * fd_wksp_laddr_fast( fd_wksp_t const * wksp, ulong        ga
    in other allocators like libc malloc, ptmalloc, dmalloc, Hoard, etc.
    As such they use large minimum alignments (akin to a block size /
    page size), prioritize efficiency of packing allocations tightly
-   (best effort based on the first-fit address-ordered block empirically
+   (best effort based on the best-fit address-ordered block empirically
    found quite robust in practice by Johnstone and Wilson "The Memory
    Fragmentation Problem: Solved?" ACM 1998) and prioritize robustness
    against heap corruption (e.g. overrunning an allocation might corrupt
@@ -478,7 +491,11 @@ static inline void * fd_wksp_laddr_fast( fd_wksp_t const * wksp, ulong        ga
    ... as the goal of this data structure is to encourage minimization
    of TLB usage, there is very little that can be done to proactively
    prevent intraworkspace interallocation data corruption).  (Overall,
-   both operations are a fast O(wksp_alloc_cnt).)
+   both operations are a fast O(lg wksp_alloc_cnt) expected as the
+   partitions are indexed by address and free partitions are indexed by
+   size.  An alloc can degrade to O(wksp_alloc_cnt) when the wksp is
+   nearly full or extremely fragmented such that only partitions that
+   happen to be suitably aligned can hold the request.)
 
    These operations are "quasi-lock-free".  Specifically, while they can
    suffer priority inversion due to a slow thread stalling other threads
@@ -580,7 +597,9 @@ fd_wksp_tag( fd_wksp_t * wksp,
    are fine and as are tags not in [1,FD_WKPS_ALLOC_TAG_MAX] (these will
    be ignoredas they defintely do not match any allocations).  Logs
    details if any wonkiness encountered (e.g. wksp is NULL, tag is not
-   in [1,FD_WKSP_ALLOC_TAG_MAX].  This is a fast O(wksp_alloc_cnt). */
+   in [1,FD_WKSP_ALLOC_TAG_MAX].  This is a fast O(wksp_alloc_cnt +
+   free_cnt lg wksp_alloc_cnt) where free_cnt is the number of
+   allocations freed. */
 
 void
 fd_wksp_tag_free( fd_wksp_t *   wksp,
@@ -613,9 +632,10 @@ fd_wksp_free_laddr( void * laddr );
    global address that points to any byte in the allocation (i.e. can
    point to anything in [gbase,gbase+sz) where sz is value provided to
    the original fd_wksp_alloc and gbase is where it was allocated in the
-   workspace).  Logs details of any weirdness detected.  Clear of "NULL"
-   (0UL) silently returns.  Atomic with respect to other operations on
-   this workspace. */
+   workspace).  The entire allocation is set (including any leading
+   alignment padding and trailing block padding).  Logs details of any
+   weirdness detected.  Clear of "NULL" (0UL) silently returns.  Atomic
+   with respect to other operations on this workspace. */
 
 void
 fd_wksp_memset( fd_wksp_t * wksp,
@@ -634,7 +654,7 @@ void
 fd_wksp_check( fd_wksp_t * wksp );
 
 /* fd_wksp_reset frees all allocations from the wksp.  Logs details on
-   failure.  This happens atomically. */
+   failure.  This happens atomically.  This is O(part_max). */
 
 void
 fd_wksp_reset( fd_wksp_t * wksp );
@@ -726,6 +746,61 @@ fd_wksp_usage( fd_wksp_t *       wksp,
                ulong             tag_cnt,
                fd_wksp_usage_t * usage );
 
+/* fd_wksp_checkpt writes the allocations of wksp (their gaddr ranges,
+   tags and data) to a newly created file at path with the unix
+   permissions mode.  Free partitions are not written so a mostly empty
+   gigantic page backed wksp checkpts quickly and compactly.  style is a
+   FD_WKSP_CHECKPT_STYLE_*.  The file I/O is done in frames of up to
+   FD_WKSP_CHECKPT_FRAME_MAX bytes with O_DIRECT (when supported by the
+   underlying file system) by the caller and tiles [t0,t1) via tpool (a
+   NULL tpool indicates to do all I/O on the caller).  See fd_tpool_for
+   for restrictions on tpool, t0 and t1.  E.g. to checkpt using all the
+   tiles of the thread group from tile 0:
+
+     fd_wksp_checkpt( tpool, 1UL, fd_tile_cnt(), wksp, path, 0600UL, FD_WKSP_CHECKPT_STYLE_RAW );
+
+   Returns 0 on success and an errno compatible error code on failure
+   (logs details).  Any existing file at path is replaced.  On failure,
+   there will be no file at path.
+
+   The wksp is locked while the checkpt is written such that it captures
+   the partitioning at a single point in time.  It is the caller's
+   responsibility to quiesce users of the allocations if the data needs
+   to be consistent too (e.g. by halting the tiles that write to it).
+
+   fd_wksp_restore replaces all the allocations in wksp with the
+   allocations in the checkpt at path (as written by fd_wksp_checkpt),
+   restoring each allocation at its original gaddr with its original
+   tag and data.  tpool, t0 and t1 are as above.  wksp can be the
+   original wksp or any wksp whose data region covers all the
+   allocations in the checkpt and that has enough partitions to hold
+   them (e.g. a wksp of the same or larger size created with the same
+   opt_part_max as the original ... the data region of a larger wksp
+   created with default partition max starts at a higher gaddr).
+   Returns 0 on success and an errno compatible error code on failure
+   (logs details).  Fails with EPROTO if path does not appear to be a
+   valid checkpt (including hash mismatches for HASH style checkpts).
+   On failure, wksp is unchanged if the checkpt could not be used and
+   has no allocations if the failure was detected while reading the
+   data.  There should be no users of wksp's allocations during the
+   restore (the wksp is locked for the duration of the restore). */
+
+int
+fd_wksp_checkpt( fd_tpool_t * tpool,
+                 ulong        t0,
+                 ulong        t1,
+                 fd_wksp_t *  wksp,
+                 char const * path,
+                 ulong        mode,
+                 int          style );
+
+int
+fd_wksp_restore( fd_tpool_t * tpool,
+                 ulong        t0,
+                 ulong        t1,
+                 fd_wksp_t *  wksp,
+                 char const * path );
+
 FD_PROTOTYPES_END
 
 #endif
@@ -0,0 +1,561 @@
+#if FD_HAS_HOSTED && FD_HAS_X86
+#define _GNU_SOURCE
+#endif
+
+#include "fd_wksp_private.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* A checkpt file has the layout:
+
+     [0,BLOCK_SZ)                      header (fd_wksp_private_checkpt_hdr_t)
+     [BLOCK_SZ,BLOCK_SZ+table_sz)      frame table (frame_cnt fd_wksp_private_checkpt_frame_t, zero padded)
+     [BLOCK_SZ+table_sz,...+data_sz)   frame data (concatenated in frame table order)
+
+   Each allocation is stored as one or more consecutive frames of at
+   most FD_WKSP_CHECKPT_FRAME_MAX bytes in address order.  The first
+   frame of an allocation has the allocation's tag and the remaining
+   frames have a tag of 0 (free partitions are never checkpointed so
+   this is unambiguous).  Since wksp partitions are FD_WKSP_ALLOC_ALIGN_MIN
+   aligned and sized, every frame is BLOCK_SZ aligned in both the wksp
+   and the file, allowing the data to be moved with O_DIRECT straight
+   from / to the wksp.  The header magic is written last such that a
+   checkpt that was interrupted is not mistaken for a valid one. */
+
+#define FD_WKSP_CHECKPT_MAGIC (0xF17EDA2C3731C5C0UL) /* F17E=FIRE,DA2C/3R<>DANCER,31/C5<>WKSP CHECKPT,C0<>VERSION 0 */
+
+#define FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ (4096UL)
+
+FD_STATIC_ASSERT( FD_WKSP_ALLOC_ALIGN_MIN==FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ,                       update_checkpt_layout );
+FD_STATIC_ASSERT( !(FD_WKSP_CHECKPT_FRAME_MAX % FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ),                        update_checkpt_layout );
+
+struct fd_wksp_private_checkpt_hdr {
+  ulong magic;      /* ==FD_WKSP_CHECKPT_MAGIC */
+  ulong style;      /* FD_WKSP_CHECKPT_STYLE_* */
+  ulong part_max;   /* (Convenience) part_max of the checkpted wksp */
+  ulong gaddr_lo;   /* (Convenience) data region of the checkpted wksp */
+  ulong gaddr_hi;   /* " */
+  ulong part_cnt;   /* Number of allocations in the checkpt */
+  ulong frame_cnt;  /* Number of frames in the checkpt, in [part_cnt,...] */
+  ulong data_sz;    /* Total number of data bytes in the checkpt */
+  ulong table_hash; /* fd_hash of the frame table (unpadded) seeded with the magic */
+  char  name[ FD_SHMEM_NAME_MAX ]; /* (Convenience) name of the checkpted wksp */
+};
+
+typedef struct fd_wksp_private_checkpt_hdr fd_wksp_private_checkpt_hdr_t;
+
+FD_STATIC_ASSERT( sizeof(fd_wksp_private_checkpt_hdr_t)<=FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ, update_checkpt_layout );
+
+struct fd_wksp_private_checkpt_frame {
+  ulong gaddr_lo; /* Frame covers [gaddr_lo,gaddr_hi) of the wksp */
+  ulong gaddr_hi;
+  ulong tag;      /* Allocation tag for the first frame of an allocation, 0 otherwise */
+  ulong hash;     /* fd_hash of the frame data seeded with gaddr_lo for HASH style checkpts, 0 otherwise */
+};
+
+typedef struct fd_wksp_private_checkpt_frame fd_wksp_private_checkpt_frame_t;
+
+/* fd_wksp_private_checkpt_ctx_t is the state shared by the workers
+   moving the frame data.  off[i] is the file offset of frame i's data.
+   err is the first error encountered (0 if none). */
+
+struct fd_wksp_private_checkpt_ctx {
+  fd_wksp_t *                       wksp;
+  int                               fd;
+  int                               style;
+  fd_wksp_private_checkpt_frame_t * frame;
+  ulong const *                     off;
+  int                               err;
+};
+
+typedef struct fd_wksp_private_checkpt_ctx fd_wksp_private_checkpt_ctx_t;
+
+/* fd_wksp_private_checkpt_{write,read} write / read sz bytes of buf
+   to / from fd at file offset off, retrying on partial transfers and
+   interrupts.  Return 0 on success and an errno compatible error code
+   on failure (EIO if the file ended unexpectedly). */
+
+static int
+fd_wksp_private_checkpt_write( int          fd,
+                               void const * buf,
+                               ulong        sz,
+                               ulong        off ) {
+  uchar const * p = (uchar const *)buf;
+  while( sz ) {
+    long wsz = (long)pwrite( fd, p, fd_ulong_min( sz, 1UL<<30 ), (off_t)off );
+    if( FD_UNLIKELY( wsz<=0L ) ) {
+      if( FD_LIKELY( (wsz<0L) & (errno==EINTR) ) ) continue;
+      return wsz<0L ? errno : EIO;
+    }
+    p += (ulong)wsz; off += (ulong)wsz; sz -= (ulong)wsz;
+  }
+  return 0;
+}
+
+static int
+fd_wksp_private_checkpt_read( int    fd,
+                              void * buf,
+                              ulong  sz,
+                              ulong  off ) {
+  uchar * p = (uchar *)buf;
+  while( sz ) {
+    long rsz = (long)pread( fd, p, fd_ulong_min( sz, 1UL<<30 ), (off_t)off );
+    if( FD_UNLIKELY( rsz<=0L ) ) {
+      if( FD_LIKELY( (rsz<0L) & (errno==EINTR) ) ) continue;
+      return rsz<0L ? errno : EIO;
+    }
+    p += (ulong)rsz; off += (ulong)rsz; sz -= (ulong)rsz;
+  }
+  return 0;
+}
+
+/* fd_wksp_private_checkpt_open opens path with the given flags and
+   mode, using O_DIRECT if the underlying file system supports it.
+   Returns the file descriptor on success and -1 on failure (errno set
+   appropriately). */
+
+static int
+fd_wksp_private_checkpt_open( char const * path,
+                              int          flags,
+                              ulong        mode ) {
+  int fd = open( path, flags | O_DIRECT, (mode_t)mode );
+  if( FD_UNLIKELY( (fd==-1) && (errno==EINVAL) ) ) fd = open( path, flags, (mode_t)mode ); /* e.g. tmpfs */
+  return fd;
+}
+
+/* fd_wksp_private_checkpt_{mmap,munmap} acquire / release sz bytes of
+   page aligned scratch memory for the frame table and offsets.  mmap
+   returns NULL on failure (logs details). */
+
+static void *
+fd_wksp_private_checkpt_mmap( ulong sz ) {
+  void * mem = mmap( NULL, sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, (off_t)0 );
+  if( FD_UNLIKELY( mem==MAP_FAILED ) ) {
+    FD_LOG_WARNING(( "mmap(NULL,%lu KiB) failed (%i-%s)", sz>>10, errno, strerror( errno ) ));
+    return NULL;
+  }
+  return mem;
+}
+
+static void
+fd_wksp_private_checkpt_munmap( void * mem,
+                                ulong  sz ) {
+  if( FD_UNLIKELY( munmap( mem, sz ) ) )
+    FD_LOG_WARNING(( "munmap(%lu KiB) failed (%i-%s); attempting to continue", sz>>10, errno, strerror( errno ) ));
+}
+
+/* fd_wksp_private_checkpt_exec runs task over frames [0,frame_cnt)
+   with the given tpool (or on the caller if tpool is NULL). */
+
+static void
+fd_wksp_private_checkpt_exec( fd_tpool_t *                    tpool,
+                              ulong                           t0,
+                              ulong                           t1,
+                              ulong                           frame_cnt,
+                              fd_tpool_task_t                 task,
+                              fd_wksp_private_checkpt_ctx_t * ctx ) {
+  if( FD_UNLIKELY( !frame_cnt ) ) return;
+  if( tpool ) fd_tpool_for( tpool, t0, t1, 0UL, frame_cnt, 1UL, task, ctx );
+  else        task( ctx, 0UL, frame_cnt );
+}
+
+static void
+fd_wksp_private_checkpt_task( void * _ctx,
+                              ulong  i0,
+                              ulong  i1 ) {
+  fd_wksp_private_checkpt_ctx_t *   ctx   = (fd_wksp_private_checkpt_ctx_t *)_ctx;
+  fd_wksp_private_checkpt_frame_t * frame = ctx->frame;
+
+  for( ulong i=i0; i<i1; i++ ) {
+    if( FD_UNLIKELY( FD_VOLATILE_CONST( ctx->err ) ) ) return;
+    ulong        lo    = frame[i].gaddr_lo;
+    ulong        sz    = frame[i].gaddr_hi - lo;
+    void const * laddr = fd_wksp_laddr_fast( ctx->wksp, lo );
+    if( ctx->style==FD_WKSP_CHECKPT_STYLE_HASH ) frame[i].hash = fd_hash( lo, laddr, sz );
+    int err = fd_wksp_private_checkpt_write( ctx->fd, laddr, sz, ctx->off[i] );
+    if( FD_UNLIKELY( err ) ) {
+      FD_LOG_WARNING(( "write of frame [0x%016lx,0x%016lx) failed (%i-%s)", lo, lo+sz, err, strerror( err ) ));
+      FD_VOLATILE( ctx->err ) = err;
+      return;
+    }
+  }
+}
+
+static void
+fd_wksp_private_restore_task( void * _ctx,
+                              ulong  i0,
+                              ulong  i1 ) {
+  fd_wksp_private_checkpt_ctx_t *   ctx   = (fd_wksp_private_checkpt_ctx_t *)_ctx;
+  fd_wksp_private_checkpt_frame_t * frame = ctx->frame;
+
+  for( ulong i=i0; i<i1; i++ ) {
+    if( FD_UNLIKELY( FD_VOLATILE_CONST( ctx->err ) ) ) return;
+    ulong  lo    = frame[i].gaddr_lo;
+    ulong  sz    = frame[i].gaddr_hi - lo;
+    void * laddr = fd_wksp_laddr_fast( ctx->wksp, lo );
+    int err = fd_wksp_private_checkpt_read( ctx->fd, laddr, sz, ctx->off[i] );
+    if( FD_UNLIKELY( err ) ) {
+      FD_LOG_WARNING(( "read of frame [0x%016lx,0x%016lx) failed (%i-%s)", lo, lo+sz, err, strerror( err ) ));
+      FD_VOLATILE( ctx->err ) = err;
+      return;
+    }
+    if( FD_UNLIKELY( (ctx->style==FD_WKSP_CHECKPT_STYLE_HASH) && (fd_hash( lo, laddr, sz )!=frame[i].hash) ) ) {
+      FD_LOG_WARNING(( "frame [0x%016lx,0x%016lx) hash mismatch (corrupt checkpt?)", lo, lo+sz ));
+      FD_VOLATILE( ctx->err ) = EPROTO;
+      return;
+    }
+  }
+}
+
+int
+fd_wksp_checkpt( fd_tpool_t * tpool,
+                 ulong        t0,
+                 ulong        t1,
+                 fd_wksp_t *  wksp,
+                 char const * path,
+                 ulong        mode,
+                 int          style ) {
+
+  if( FD_UNLIKELY( !wksp ) ) {
+    FD_LOG_WARNING(( "NULL wksp" ));
+    return EINVAL;
+  }
+
+  if( FD_UNLIKELY( !path ) ) {
+    FD_LOG_WARNING(( "NULL path" ));
+    return EINVAL;
+  }
+
+  if( FD_UNLIKELY( !((style==FD_WKSP_CHECKPT_STYLE_RAW) | (style==FD_WKSP_CHECKPT_STYLE_HASH)) ) ) {
+    FD_LOG_WARNING(( "bad style" ));
+    return EINVAL;
+  }
+
+  if( FD_UNLIKELY( tpool && !((t0<=t1) & ((1UL+t1-t0)<=fd_tpool_worker_max( tpool ))) ) ) {
+    FD_LOG_WARNING(( "bad tile range" ));
+    return EINVAL;
+  }
+
+  int fd = fd_wksp_private_checkpt_open( path, O_WRONLY | O_CREAT | O_TRUNC, mode );
+  if( FD_UNLIKELY( fd==-1 ) ) {
+    int err = errno;
+    FD_LOG_WARNING(( "open(\"%s\",O_WRONLY|O_CREAT|O_TRUNC,0%03lo) failed (%i-%s)", path, mode, err, strerror( err ) ));
+    return err;
+  }
+
+  fd_wksp_private_lock( wksp );
+
+  fd_wksp_private_pinfo_t const * pinfo = wksp->pinfo;
+
+  /* Size the checkpt */
+
+  ulong part_cnt  = 0UL;
+  ulong frame_cnt = 0UL;
+  ulong data_sz   = 0UL;
+  for( uint i=wksp->head_cidx; i!=FD_WKSP_PRIVATE_PINFO_IDX_NULL; i=pinfo[i].next_cidx ) {
+    if( !pinfo[i].tag ) continue;
+    ulong sz = pinfo[i].gaddr_hi - pinfo[i].gaddr_lo;
+    part_cnt++;
+    frame_cnt += (sz + FD_WKSP_CHECKPT_FRAME_MAX - 1UL) / FD_WKSP_CHECKPT_FRAME_MAX;
+    data_sz   += sz;
+  }
+
+  ulong table_sz   = fd_ulong_align_up( frame_cnt*sizeof(fd_wksp_private_checkpt_frame_t), FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ );
+  ulong scratch_sz = fd_ulong_align_up( table_sz + frame_cnt*sizeof(ulong) + 1UL, FD_SHMEM_NORMAL_PAGE_SZ );
+  uchar * scratch  = (uchar *)fd_wksp_private_checkpt_mmap( scratch_sz ); /* logs details */
+  if( FD_UNLIKELY( !scratch ) ) {
+    fd_wksp_private_unlock( wksp );
+    close( fd );
+    unlink( path );
+    return ENOMEM;
+  }
+
+  fd_wksp_private_checkpt_frame_t * frame = (fd_wksp_private_checkpt_frame_t *)scratch;
+  ulong *                           off   = (ulong *)(scratch + table_sz);
+
+  /* Build the frame table.  Padding is zero courtesy of the mmap. */
+
+  ulong data_off = FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ + table_sz;
+  ulong j        = 0UL;
+  for( uint i=wksp->head_cidx; i!=FD_WKSP_PRIVATE_PINFO_IDX_NULL; i=pinfo[i].next_cidx ) {
+    ulong tag = pinfo[i].tag;
+    if( !tag ) continue;
+    ulong hi = pinfo[i].gaddr_hi;
+    for( ulong lo=pinfo[i].gaddr_lo; lo<hi; lo+=FD_WKSP_CHECKPT_FRAME_MAX ) {
+      ulong frame_hi = fd_ulong_min( lo+FD_WKSP_CHECKPT_FRAME_MAX, hi );
+      frame[j].gaddr_lo = lo;
+      frame[j].gaddr_hi = frame_hi;
+      frame[j].tag      = tag;
+      frame[j].hash     = 0UL;
+      off  [j]          = data_off;
+      data_off += frame_hi - lo;
+      tag = 0UL;
+      j++;
+    }
+  }
+
+  /* Write the data */
+
+  fd_wksp_private_checkpt_ctx_t ctx[1];
+  ctx->wksp  = wksp;
+  ctx->fd    = fd;
+  ctx->style = style;
+  ctx->frame = frame;
+  ctx->off   = off;
+  ctx->err   = 0;
+
+  fd_wksp_private_checkpt_exec( tpool, t0, t1, frame_cnt, fd_wksp_private_checkpt_task, ctx );
+
+  /* Fill in the header while we still have the lock */
+
+  uchar hdr_mem[ FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ ] __attribute__((aligned(FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ)));
+  fd_memset( hdr_mem, 0, FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ );
+  fd_wksp_private_checkpt_hdr_t * hdr = (fd_wksp_private_checkpt_hdr_t *)hdr_mem;
+  hdr->style      = (ulong)style;
+  hdr->part_max   = wksp->part_max;
+  hdr->gaddr_lo   = wksp->gaddr_lo;
+  hdr->gaddr_hi   = wksp->gaddr_hi;
+  hdr->part_cnt   = part_cnt;
+  hdr->frame_cnt  = frame_cnt;
+  hdr->data_sz    = data_sz;
+  hdr->table_hash = fd_hash( FD_WKSP_CHECKPT_MAGIC, frame, frame_cnt*sizeof(fd_wksp_private_checkpt_frame_t) );
+  fd_memcpy( hdr->name, wksp->name, FD_SHMEM_NAME_MAX );
+
+  fd_wksp_private_unlock( wksp );
+
+  /* Write the frame table, make sure everything is on disk, and then
+     validate the checkpt by writing the header. */
+
+  int err = ctx->err;
+  if( FD_LIKELY( !err ) ) {
+    err = fd_wksp_private_checkpt_write( fd, frame, table_sz, FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ );
+    if( FD_UNLIKELY( err ) ) FD_LOG_WARNING(( "write of frame table failed (%i-%s)", err, strerror( err ) ));
+  }
+
+  if( FD_LIKELY( !err ) ) {
+    if( FD_UNLIKELY( fsync( fd ) ) ) {
+      err = errno;
+      FD_LOG_WARNING(( "fsync failed (%i-%s)", err, strerror( err ) ));
+    }
+  }
+
+  if( FD_LIKELY( !err ) ) {
+    hdr->magic = FD_WKSP_CHECKPT_MAGIC;
+    err = fd_wksp_private_checkpt_write( fd, hdr_mem, FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ, 0UL );
+    if( FD_UNLIKELY( err ) ) FD_LOG_WARNING(( "write of header failed (%i-%s)", err, strerror( err ) ));
+  }
+
+  if( FD_LIKELY( !err ) ) {
+    if( FD_UNLIKELY( fsync( fd ) ) ) {
+      err = errno;
+      FD_LOG_WARNING(( "fsync failed (%i-%s)", err, strerror( err ) ));
+    }
+  }
+
+  fd_wksp_private_checkpt_munmap( scratch, scratch_sz ); /* logs details */
+
+  if( FD_UNLIKELY( close( fd ) ) ) {
+    int close_err = errno;
+    FD_LOG_WARNING(( "close(\"%s\") failed (%i-%s)", path, close_err, strerror( close_err ) ));
+    if( !err ) err = close_err;
+  }
+
+  if( FD_UNLIKELY( err ) ) {
+    if( FD_UNLIKELY( unlink( path ) ) )
+      FD_LOG_WARNING(( "unlink(\"%s\") failed (%i-%s); attempting to continue", path, errno, strerror( errno ) ));
+    return err;
+  }
+
+  return 0;
+}
+
+int
+fd_wksp_restore( fd_tpool_t * tpool,
+                 ulong        t0,
+                 ulong        t1,
+                 fd_wksp_t *  wksp,
+                 char const * path ) {
+
+  if( FD_UNLIKELY( !wksp ) ) {
+    FD_LOG_WARNING(( "NULL wksp" ));
+    return EINVAL;
+  }
+
+  if( FD_UNLIKELY( !path ) ) {
+    FD_LOG_WARNING(( "NULL path" ));
+    return EINVAL;
+  }
+
+  if( FD_UNLIKELY( tpool && !((t0<=t1) & ((1UL+t1-t0)<=fd_tpool_worker_max( tpool ))) ) ) {
+    FD_LOG_WARNING(( "bad tile range" ));
+    return EINVAL;
+  }
+
+  int fd = fd_wksp_private_checkpt_open( path, O_RDONLY, 0UL );
+  if( FD_UNLIKELY( fd==-1 ) ) {
+    int err = errno;
+    FD_LOG_WARNING(( "open(\"%s\",O_RDONLY) failed (%i-%s)", path, err, strerror( err ) ));
+    return err;
+  }
+
+  uchar *                           scratch    = NULL;
+  ulong                             scratch_sz = 0UL;
+  fd_wksp_private_checkpt_frame_t * frame      = NULL;
+  ulong *                           off        = NULL;
+  int                               err;
+
+# define FAIL( e, ... ) do { FD_LOG_WARNING( __VA_ARGS__ ); err = (e); goto done; } while(0)
+
+  /* Read and validate the header */
+
+  uchar hdr_mem[ FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ ] __attribute__((aligned(FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ)));
+  fd_wksp_private_checkpt_hdr_t const * hdr = (fd_wksp_private_checkpt_hdr_t const *)hdr_mem;
+
+  err = fd_wksp_private_checkpt_read( fd, hdr_mem, FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ, 0UL );
+  if( FD_UNLIKELY( err ) ) FAIL( err==EIO ? EPROTO : err, ( "read of \"%s\" header failed (%i-%s)", path, err, strerror( err ) ) );
+
+  struct stat st[1];
+  if( FD_UNLIKELY( fstat( fd, st ) ) ) FAIL( errno, ( "fstat(\"%s\") failed (%i-%s)", path, errno, strerror( errno ) ) );
+  ulong file_sz = (ulong)st->st_size;
+
+  /* The frame_cnt and data_sz checks imply the file size check below
+     can't overflow. */
+
+  ulong frame_cnt = hdr->frame_cnt;
+  ulong part_cnt  = hdr->part_cnt;
+  int   style     = (int)hdr->style;
+  if( FD_UNLIKELY( (hdr->magic!=FD_WKSP_CHECKPT_MAGIC)                                   |
+                   !((hdr->style==(ulong)FD_WKSP_CHECKPT_STYLE_RAW ) |
+                     (hdr->style==(ulong)FD_WKSP_CHECKPT_STYLE_HASH))                    |
+                   (part_cnt>frame_cnt) | (hdr->data_sz>file_sz)                         |
+                   (frame_cnt>(hdr->data_sz/FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ))           |
+                   (file_sz!=(FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ + hdr->data_sz +
+                              fd_ulong_align_up( frame_cnt*sizeof(fd_wksp_private_checkpt_frame_t),
+                                                 FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ ))) ) )
+    FAIL( EPROTO, ( "\"%s\" does not appear to be a wksp checkpt", path ) );
+
+  if( FD_UNLIKELY( strncmp( hdr->name, wksp->name, FD_SHMEM_NAME_MAX ) ) )
+    FD_LOG_NOTICE(( "restoring checkpt of wksp %.*s into wksp %s; wksp cstr addresses in the restored data might need "
+                     "to be updated", (int)(FD_SHMEM_NAME_MAX-1UL), hdr->name, wksp->name ));
+
+  /* Read and validate the frame table */
+
+  ulong table_sz = fd_ulong_align_up( frame_cnt*sizeof(fd_wksp_private_checkpt_frame_t), FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ );
+  scratch_sz = fd_ulong_align_up( table_sz + frame_cnt*sizeof(ulong) + 1UL, FD_SHMEM_NORMAL_PAGE_SZ );
+  scratch    = (uchar *)fd_wksp_private_checkpt_mmap( scratch_sz ); /* logs details */
+  if( FD_UNLIKELY( !scratch ) ) { scratch_sz = 0UL; err = ENOMEM; goto done; }
+  frame = (fd_wksp_private_checkpt_frame_t *)scratch;
+  off   = (ulong *)(scratch + table_sz);
+
+  err = fd_wksp_private_checkpt_read( fd, frame, table_sz, FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ );
+  if( FD_UNLIKELY( err ) ) FAIL( err==EIO ? EPROTO : err, ( "read of \"%s\" frame table failed (%i-%s)", path, err, strerror( err ) ) );
+
+  if( FD_UNLIKELY( fd_hash( FD_WKSP_CHECKPT_MAGIC, frame, frame_cnt*sizeof(fd_wksp_private_checkpt_frame_t) )!=hdr->table_hash ) )
+    FAIL( EPROTO, ( "\"%s\" frame table hash mismatch (corrupt checkpt?)", path ) );
+
+  /* Validate the frames are a well formed set of allocations in
+     address order that fit in the wksp.  We also count the partitions
+     needed to hold the allocations and the free gaps between them. */
+
+  ulong data_off     = FD_WKSP_PRIVATE_CHECKPT_BLOCK_SZ + table_sz;
+  ulong gaddr        = wksp->gaddr_lo;
+  ulong prev_hi      = 0UL;
+  ulong part_cnt_chk = 0UL;
+  ulong part_req     = 0UL;
+  for( ulong i=0UL; i<frame_cnt; i++ ) {
+    ulong lo  = frame[i].gaddr_lo;
+    ulong hi  = frame[i].gaddr_hi;
+    ulong tag = frame[i].tag;
+    if( FD_UNLIKELY( !( fd_ulong_is_aligned( lo, FD_WKSP_ALLOC_ALIGN_MIN ) & fd_ulong_is_aligned( hi, FD_WKSP_ALLOC_ALIGN_MIN ) &
+                        (lo<hi) & ((hi-lo)<=FD_WKSP_CHECKPT_FRAME_MAX) & (tag<=FD_WKSP_ALLOC_TAG_MAX) &
+                        (tag ? (lo>=prev_hi) : ((!!i) & (lo==prev_hi))) ) ) )
+      FAIL( EPROTO, ( "\"%s\" frame %lu is malformed (corrupt checkpt?)", path, i ) );
+    if( FD_UNLIKELY( (lo<wksp->gaddr_lo) | (hi>wksp->gaddr_hi) ) )
+      FAIL( ENOMEM, ( "\"%s\" allocation at [0x%016lx,0x%016lx) does not fit in wksp %s data region [0x%016lx,0x%016lx) "
+                      "(checkpted wksp had data region [0x%016lx,0x%016lx) and part_max %lu)",
+                      path, lo, hi, wksp->name, wksp->gaddr_lo, wksp->gaddr_hi, hdr->gaddr_lo, hdr->gaddr_hi, hdr->part_max ) );
+    if( tag ) {
+      part_cnt_chk++;
+      part_req += 1UL + (ulong)(lo>gaddr);
+    }
+    off[i]    = data_off;
+    data_off += hi - lo;
+    gaddr     = hi;
+    prev_hi   = hi;
+  }
+  part_req += (ulong)(gaddr<wksp->gaddr_hi);
+
+  if( FD_UNLIKELY( (part_cnt_chk!=part_cnt) | (data_off!=file_sz) ) )
+    FAIL( EPROTO, ( "\"%s\" frame table inconsistent with header (corrupt checkpt?)", path ) );
+
+  if( FD_UNLIKELY( part_req>wksp->part_max ) )
+    FAIL( ENOMEM, ( "\"%s\" needs %lu partitions but wksp %s has part_max %lu", path, part_req, wksp->name, wksp->part_max ) );
+
+  /* Replace the partitioning of the wksp with the checkpted one.  We
+     write out the partitions in address order and then rebuild the
+     indices (as fd_wksp_new does). */
+
+  fd_wksp_private_lock( wksp );
+
+  fd_wksp_private_pinfo_t * pinfo = wksp->pinfo;
+  fd_memset( pinfo, 0, wksp->part_max*sizeof(fd_wksp_private_pinfo_t) );
+
+  ulong n = 0UL;
+  gaddr = wksp->gaddr_lo;
+  for( ulong i=0UL; i<frame_cnt; i++ ) {
+    ulong lo = frame[i].gaddr_lo;
+    ulong hi = frame[i].gaddr_hi;
+    if( !frame[i].tag ) { pinfo[n-1UL].gaddr_hi = hi; gaddr = hi; continue; } /* continuation frame */
+    if( gaddr<lo ) { pinfo[n].gaddr_lo = gaddr; pinfo[n].gaddr_hi = lo; n++; }
+    pinfo[n].gaddr_lo = lo; pinfo[n].gaddr_hi = hi; pinfo[n].tag = frame[i].tag; n++;
+    gaddr = hi;
+  }
+  if( gaddr<wksp->gaddr_hi ) { pinfo[n].gaddr_lo = gaddr; pinfo[n].gaddr_hi = wksp->gaddr_hi; n++; }
+
+  fd_wksp_private_rebuild( wksp );
+
+  /* Read in the data */
+
+  fd_wksp_private_checkpt_ctx_t ctx[1];
+  ctx->wksp  = wksp;
+  ctx->fd    = fd;
+  ctx->style = style;
+  ctx->frame = frame;
+  ctx->off   = off;
+  ctx->err   = 0;
+
+  fd_wksp_private_checkpt_exec( tpool, t0, t1, frame_cnt, fd_wksp_private_restore_task, ctx );
+
+  err = ctx->err;
+  if( FD_UNLIKELY( err ) ) {
+
+    /* The data of some allocations is bad.  Free everything (as
+       fd_wksp_reset does). */
+
+    fd_memset( pinfo, 0, n*sizeof(fd_wksp_private_pinfo_t) );
+    pinfo[0].gaddr_lo = wksp->gaddr_lo;
+    pinfo[0].gaddr_hi = wksp->gaddr_hi;
+    fd_wksp_private_rebuild( wksp );
+    if( err==EIO ) err = EPROTO; /* truncated checkpt */
+  }
+
+  fd_wksp_private_unlock( wksp );
+
+# undef FAIL
+
+done:
+  if( scratch ) fd_wksp_private_checkpt_munmap( scratch, scratch_sz ); /* logs details */
+
+  if( FD_UNLIKELY( close( fd ) ) )
+    FD_LOG_WARNING(( "close(\"%s\") failed (%i-%s); attempting to continue", path, errno, strerror( errno ) ));
+
+  return err;
+}
+
+#endif
@@ -30,11 +30,11 @@ fprintf_wksp( FILE *      file,
 
   fd_wksp_private_lock( wksp );
 
-  fd_wksp_private_part_t * part     = wksp->part;
-  ulong                    part_cnt = wksp->part_cnt;
-  ulong                    part_max = wksp->part_max;
-  ulong                    gaddr_lo = wksp->gaddr_lo;
-  ulong                    gaddr_hi = wksp->gaddr_hi;
+  fd_wksp_private_pinfo_t * pinfo    = wksp->pinfo;
+  ulong                     part_cnt = wksp->part_cnt;
+  ulong                     part_max = wksp->part_max;
+  ulong                     gaddr_lo = wksp->gaddr_lo;
+  ulong                     gaddr_hi = wksp->gaddr_hi;
 
   int err;
 # define TRAP(x) do { err = (x); if( err<0 ) { fd_wksp_private_unlock( wksp ); return err; } ret += err; } while(0)
@@ -50,11 +50,18 @@ fprintf_wksp( FILE *      file,
   ulong active_sz  = 0UL; ulong inactive_sz  = 0UL;
   ulong active_max = 0UL; ulong inactive_max = 0UL;
 
-  int last_active = 1;
-  for( ulong i=0UL; i<part_cnt; i++ ) {
-    ulong tag    = fd_wksp_private_part_tag  (  part[i    ] );
-    ulong lo     = fd_wksp_private_part_gaddr(  part[i    ] );
-    ulong hi     = fd_wksp_private_part_gaddr(  part[i+1UL] );
+  /* Walk the partitions in address order (bounded by part_max in case
+     the list is corrupt) */
+
+  int   last_active = 1;
+  ulong last_hi     = gaddr_lo;
+  ulong i           = 0UL;
+  for( uint idx=wksp->head_cidx; idx!=FD_WKSP_PRIVATE_PINFO_IDX_NULL && i<part_max; idx=pinfo[idx].next_cidx, i++ ) {
+    if( idx>=part_max ) { cnt++; TRAP( fprintf( file, "	partition %20li: idx_err\n", i ) ); break; }
+
+    ulong tag = pinfo[idx].tag;
+    ulong lo  = pinfo[idx].gaddr_lo;
+    ulong hi  = pinfo[idx].gaddr_hi;
 
     ulong sz = hi-lo;
 
@@ -71,17 +78,20 @@ fprintf_wksp( FILE *      file,
 
     TRAP( fprintf( file, "\tpartition %20li: [0x%016lx,0x%016lx) sz %20lu tag %4lu", i, lo, hi, sz, tag ) );
 
-    if( lo>=hi                                                            ) { cnt++; TRAP( fprintf( file, " part_err"      ) ); }
-    if( ((i==0UL)            & (lo!=gaddr_lo))                            ) { cnt++; TRAP( fprintf( file, " lo_err"        ) ); }
-    if( ((i==(part_cnt-1UL)) & (hi!=gaddr_hi))                            ) { cnt++; TRAP( fprintf( file, " hi_err"        ) ); }
-    if( i==(part_cnt-1UL) && fd_wksp_private_part_tag( part[i+1UL] )!=1UL ) { cnt++; TRAP( fprintf( file, " hi_active_err" ) ); }
-    if( !fd_ulong_is_aligned( lo, FD_WKSP_ALLOC_ALIGN_MIN )               ) { cnt++; TRAP( fprintf( file, " align_err"     ) ); }
-    if( ((!last_active) & (!active))                                      ) { cnt++; TRAP( fprintf( file, " merge_err"     ) ); }
+    if( lo>=hi                                                    ) { cnt++; TRAP( fprintf( file, " part_err"  ) ); }
+    if( lo!=last_hi                                               ) { cnt++; TRAP( fprintf( file, " lo_err"    ) ); }
+    if( ((pinfo[idx].next_cidx==FD_WKSP_PRIVATE_PINFO_IDX_NULL) &
+         (hi!=gaddr_hi))                                          ) { cnt++; TRAP( fprintf( file, " hi_err"    ) ); }
+    if( !fd_ulong_is_aligned( lo, FD_WKSP_ALLOC_ALIGN_MIN )       ) { cnt++; TRAP( fprintf( file, " align_err" ) ); }
+    if( ((!last_active) & (!active))                              ) { cnt++; TRAP( fprintf( file, " merge_err" ) ); }
     TRAP( fprintf( file, "\n" ) );
 
     last_active = active;
+    last_hi     = hi;
   }
 
+  if( i!=part_cnt ) { cnt++; TRAP( fprintf( file, "\t%20lu partitions found (expected %lu) list_err\n", i, part_cnt ) ); }
+
   TRAP( fprintf( file, "\t%20lu bytes used  (%20lu alloc(s), largest %20lu bytes)\n",   active_sz,   active_cnt,   active_max ) );
   TRAP( fprintf( file, "\t%20lu bytes avail (%20lu block(s), largest %20lu bytes)\n", inactive_sz, inactive_cnt, inactive_max ) );
   TRAP( fprintf( file, "\t%20lu errors detected\n", cnt ) );
@@ -106,6 +116,13 @@ main( int     argc,
 
   ulong tag = 1UL;
 
+  /* checkpt / restore spread their I/O over all the tiles booted for
+     this thread group */
+
+  static uchar _tpool[ FD_TPOOL_FOOTPRINT( FD_TILE_MAX ) ] __attribute__((aligned(FD_TPOOL_ALIGN)));
+  fd_tpool_t * tpool = fd_tpool_join( fd_tpool_new( _tpool, FD_TILE_MAX ) );
+  if( FD_UNLIKELY( !tpool ) ) FD_LOG_ERR(( "fd_tpool_new failed" ));
+
   int cnt = 0;
   while( argc ) {
     char const * cmd = argv[0];
@@ -308,6 +325,44 @@ main( int     argc,
       FD_LOG_NOTICE(( "%i: %s %s: success", cnt, cmd, name ));
       SHIFT(1);
 
+    } else if( !strcmp( cmd, "checkpt" ) ) {
+
+      if( FD_UNLIKELY( argc<4 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * name  =                         argv[0];
+      char const * path  =                         argv[1];
+      ulong        mode  = fd_cstr_to_ulong_octal( argv[2] );
+      int          style = fd_cstr_to_int        ( argv[3] );
+
+      fd_wksp_t * wksp = fd_wksp_attach( name ); /* logs details */
+      if( FD_UNLIKELY( !wksp ) ) FD_LOG_ERR(( "%i: %s: wksp_attach failed", cnt, cmd ));
+      int err = fd_wksp_checkpt( tpool, 1UL, fd_tile_cnt(), wksp, path, mode, style ); /* logs details */
+      fd_wksp_detach( wksp ); /* logs details */
+      if( FD_UNLIKELY( err ) )
+        FD_LOG_ERR(( "%i: %s %s %s 0%03lo %i: fd_wksp_checkpt failed (%i-%s)\n\tDo %s help for help",
+                     cnt, cmd, name, path, mode, style, err, strerror( err ), bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s %s 0%03lo %i: success", cnt, cmd, name, path, mode, style ));
+      SHIFT(4);
+
+    } else if( !strcmp( cmd, "restore" ) ) {
+
+      if( FD_UNLIKELY( argc<2 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
+
+      char const * name = argv[0];
+      char const * path = argv[1];
+
+      fd_wksp_t * wksp = fd_wksp_attach( name ); /* logs details */
+      if( FD_UNLIKELY( !wksp ) ) FD_LOG_ERR(( "%i: %s: wksp_attach failed", cnt, cmd ));
+      int err = fd_wksp_restore( tpool, 1UL, fd_tile_cnt(), wksp, path ); /* logs details */
+      fd_wksp_detach( wksp ); /* logs details */
+      if( FD_UNLIKELY( err ) )
+        FD_LOG_ERR(( "%i: %s %s %s: fd_wksp_restore failed (%i-%s)\n\tDo %s help for help",
+                     cnt, cmd, name, path, err, strerror( err ), bin ));
+
+      FD_LOG_NOTICE(( "%i: %s %s %s: success", cnt, cmd, name, path ));
+      SHIFT(2);
+
     } else if( !strcmp( cmd, "usage" ) ) {
 
       if( FD_UNLIKELY( argc<2 ) ) FD_LOG_ERR(( "%i: %s: too few arguments\n\tDo %s help for help", cnt, cmd, bin ));
@@ -363,6 +418,8 @@ main( int     argc,
   if( FD_UNLIKELY( cnt<1 ) ) FD_LOG_NOTICE(( "processed %i commands\n\tDo %s help for help", cnt, bin ));
   else                       FD_LOG_NOTICE(( "processed %i commands", cnt ));
 
+  fd_tpool_delete( fd_tpool_leave( tpool ) );
+
 # undef SHIFT
   fd_halt();
   return 0;
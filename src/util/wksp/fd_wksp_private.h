@@ -8,7 +8,7 @@
 /* FD_WKSP_MAGIC is an ideally unique number that specifies the precise
    memory layout of a fd_wksp. */
 
-#define FD_WKSP_MAGIC (0xF17EDA2C3731C590UL) /* F17E=FIRE,DA2C/3R<>DANCER,31/C59<>WKSP,0<>0 --> FIRE DANCER WKSP VERSION 0 */
+#define FD_WKSP_MAGIC (0xF17EDA2C3731C591UL) /* F17E=FIRE,DA2C/3R<>DANCER,31/C59<>WKSP,1<>1 --> FIRE DANCER WKSP VERSION 1 */
 
 FD_STATIC_ASSERT( FD_WKSP_ALLOC_ALIGN_MIN==4096UL, update_fd_wksp_magic );
 
@@ -17,50 +17,85 @@ FD_STATIC_ASSERT( FD_WKSP_ALLOC_ALIGN_MIN==4096UL, update_fd_wksp_magic );
 
 #define FD_WKSP_PRIVATE_HDR_SZ (128UL)
 
-/* fd_wksp_private_part_t indicates where a partition of the wksp data
-   region starts and whether that partition is active (allocated) or
-   inactive (free).  fd_wksp_part_t is cheap and easy to read / write
-   atomically. */
+/* FD_WKSP_PRIVATE_PINFO_IDX_NULL is the partition info index used to
+   indicate "no partition" in the partition indices below. */
+
+#define FD_WKSP_PRIVATE_PINFO_IDX_NULL (UINT_MAX)
+
+/* A fd_wksp_private_pinfo_t describes a wksp partition.  The fields
+   gaddr_lo, gaddr_hi and tag are the ground truth about the partition.
+   A pinfo with gaddr_lo<gaddr_hi is "live" and describes a partition
+   covering [gaddr_lo,gaddr_hi) of the data region that is free (tag 0)
+   or allocated (tag in [1,FD_WKSP_ALLOC_TAG_MAX]).  Otherwise, the
+   pinfo is "idle" (not currently describing a partition and available
+   for describing a new partition).  Each of these fields is cheap and
+   easy to read / write atomically.  gaddr_hi and tag are adjacent and
+   16 byte aligned such that both can be written atomically together.
+
+   The remaining fields are indices for fast lookups.  They can always
+   be recomputed from the ground truth (this is how the wksp recovers
+   from a process that died while holding the wksp lock):
+
+   - prev_cidx / next_cidx link all live pinfo into a doubly linked list
+     in address order.  next_cidx also links all idle pinfo into a stack.
+
+   - child_cidx[0][*] are the left / right children of the pinfo in a
+     treap of all live pinfo keyed by gaddr_lo (the "address treap").
+
+   - child_cidx[1][*] are the left / right children of the pinfo in a
+     treap of all free live pinfo keyed by (gaddr_hi-gaddr_lo,gaddr_lo)
+     (the "size treap").
+
+   The treap heap priorities are a hash of the pinfo index such that
+   they do not need to be stored.  Indices are uint to keep the pinfo
+   compact (as such, part_max is at most UINT_MAX). */
+
+struct __attribute__((aligned(16UL))) fd_wksp_private_pinfo {
+  ulong gaddr_lo;           /* See above */
+  uint  prev_cidx;          /* Address ordered list of live pinfo, IDX_NULL if first */
+  uint  next_cidx;          /* Address ordered list of live pinfo, IDX_NULL if last (or next idle pinfo if idle) */
+  ulong gaddr_hi;           /* See above, 16 byte aligned */
+  ulong tag;                /* See above */
+  uint  child_cidx[2][2];   /* child_cidx[t][d] is the left (d==0) / right (d==1) child in treap t (0 address, 1 size) */
+};
 
-typedef ulong fd_wksp_private_part_t;
+typedef struct fd_wksp_private_pinfo fd_wksp_private_pinfo_t;
 
 /* fd_wksp_private specifies the detailed layout of the internals of a
    fd_wksp_t */
 
-FD_STATIC_ASSERT( (6UL*sizeof(ulong)+FD_SHMEM_NAME_MAX)<=FD_WKSP_PRIVATE_HDR_SZ, update_fd_wksp_private_layout );
+FD_STATIC_ASSERT( (6UL*sizeof(ulong)+4UL*sizeof(uint)+FD_SHMEM_NAME_MAX)<=FD_WKSP_PRIVATE_HDR_SZ, update_fd_wksp_private_layout );
 
 struct __attribute__((aligned(FD_WKSP_ALLOC_ALIGN_MIN))) fd_wksp_private {
-  ulong magic;    /* ==FD_WKSP_MAGIC */
-  ulong owner;    /* ULONG_MAX if no process is operating on this workspace or pid of the process currently operating on this
-                     workspace.  If pid is dead, the workspace is recoverable */
-  ulong part_cnt; /* Number of partitions in the workspace.  0<part_cnt<=part_max.
-                     partition i is completely described by ( part[i].active, part[i].lo, part[i+1].hi ) */
-  ulong part_max; /* Maximum number of partitions of the workspace.  Positive.  This will typically be large enough to accommodate
-                     a worst case partitioning of the workspace. */
-  ulong gaddr_lo; /* (Convenience==part[0       ].off), data region covers bytes [gaddr_lo,gaddr_hi) relative to wksp */
-  ulong gaddr_hi; /* (Convenience==part[part_cnt].off), " */
+  ulong magic;          /* ==FD_WKSP_MAGIC */
+  ulong owner;          /* ULONG_MAX if no process is operating on this workspace or pid of the process currently operating on
+                           this workspace.  If pid is dead, the workspace is recoverable */
+  ulong part_cnt;       /* Number of partitions in the workspace (i.e. live pinfo).  0<part_cnt<=part_max. */
+  ulong part_max;       /* Maximum number of partitions of the workspace.  In [1,UINT_MAX].  This will typically be large
+                           enough to accommodate a worst case partitioning of the workspace. */
+  ulong gaddr_lo;       /* (Convenience) data region covers bytes [gaddr_lo,gaddr_hi) relative to wksp */
+  ulong gaddr_hi;       /* (Convenience) " */
+  uint  head_cidx;      /* Index of the lowest address partition (which always starts at gaddr_lo) */
+  uint  idle_cidx;      /* Top of the idle pinfo stack, IDX_NULL if no idle pinfo */
+  uint  root_cidx[2];   /* Root of the address (0) and size (1) treaps, IDX_NULL if empty */
 
   char  name[ FD_SHMEM_NAME_MAX ]; /* (Convenience) backing fd_shmem region cstr name */
 
   /* Padding to FD_WKSP_PRIVATE_HDR_SZ alignment */
 
-  fd_wksp_private_part_t part[] __attribute__((aligned(FD_WKSP_PRIVATE_HDR_SZ)));
+  fd_wksp_private_pinfo_t pinfo[] __attribute__((aligned(FD_WKSP_PRIVATE_HDR_SZ)));
 
-  /* part has part_max+1 entries.  When the wksp is unlocked (does not
+  /* pinfo has part_max entries.  When the wksp is unlocked (does not
      have an owner), the partitions satisfies the following invariants:
-     - Partition offsets are at least aligned to FD_WKSP_ALLOC_ALIGN_MIN
-     - Partition offsets are strictly monotonically increasing (e.g.
-       part[i+1].gaddr > part[i].gaddr) such that there are no empty
-       partitions and partitions are indexed in address order).
-     - There are no consecutive inactive partitions (e.g.
-       !(!part[i].tag && !part[i+1].tag))
-     - part[part_cnt].tag==1 (i.e. "Partition part_cnt" is active to
-       indicate there no memory available beyond the end of the
-       workspace)
+     - Partition gaddrs are at least aligned to FD_WKSP_ALLOC_ALIGN_MIN
+     - Live partitions exactly tile [gaddr_lo,gaddr_hi) (no gaps, no
+       overlaps, no empty partitions).
+     - There are no address adjacent free partitions.
+     - All indices are consistent with the ground truth.
      When a thread is operating on the data structure, the structure
-     might temporarily have one or more consecutive inactive partitions
-     and one or more "holes" (partitions for which
-     part[i].gaddr>=part[j].gaddr for j>i). */
+     might temporarily have adjacent free partitions and, transiently,
+     a free partition that is contained within a lower address free
+     partition (see fd_wksp.c for details). */
 
   /* Padding to FD_WKSP_ALLOC_ALIGN_MIN here */
 
@@ -75,22 +110,6 @@ struct __attribute__((aligned(FD_WKSP_ALLOC_ALIGN_MIN))) fd_wksp_private {
 
 FD_PROTOTYPES_BEGIN
 
-/* fd_wksp_private_part forms a fd_wksp_private_part_t from the tuple
-   (tag,gaddr).  Note that since
-   FD_WKSP_ALLOC_TAG_MAX<FD_WKSP_ALLOC_ALIGN_MIN, we have room in the
-   least significant bits to store the tag and since
-   FD_WKSP_ALLOC_TAG_MAX is an integer power of two minus 1, we can use
-   it as a bit mask. */
-
-static inline fd_wksp_private_part_t
-fd_wksp_private_part( ulong tag,      /* tag assumed in [0,FD_WKSP_ALLOC_TAG_MAX].  0 indicates inactive partition. */
-                      ulong gaddr ) { /* gaddr assumed aligned at least FD_WKSP_ALLOC_ALIGN_MIN */
-  return gaddr | tag;
-}
-
-static inline ulong fd_wksp_private_part_tag  ( fd_wksp_private_part_t part ) { return part &  FD_WKSP_ALLOC_TAG_MAX; }
-static inline ulong fd_wksp_private_part_gaddr( fd_wksp_private_part_t part ) { return part & ~FD_WKSP_ALLOC_TAG_MAX; }
-
 /* fd_wksp_alloc_tag_set_unpack inserts all tags in [tag_lo,tag_hi] in
    the tag array into the given tag set.  Assumes set is valid,
    tag_lo<=tag_hi<=FD_WKSP_ALLOC_TAG_MAX and tag / tag_cnt are valid.
@@ -120,6 +139,13 @@ fd_wksp_alloc_tag_set_unpack( fd_wksp_alloc_tag_set_t * set,
 void
 fd_wksp_private_lock( fd_wksp_t * wksp );
 
+/* fd_wksp_private_rebuild repairs any interrupted operation and
+   rebuilds all the partition indices from the pinfo ground truth.
+   Assumes the caller has the wksp lock.  See fd_wksp.c for details. */
+
+void
+fd_wksp_private_rebuild( fd_wksp_t * wksp );
+
 /* fd_wksp_private_unlock unlocks the wksp for use by the caller.
    Assumes the caller has the lock. */
 
@@ -0,0 +1,284 @@
+#include "../fd_util.h"
+
+#if FD_HAS_HOSTED && FD_HAS_X86
+
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#define ALLOC_MAX (256UL)
+
+/* A rec_t records what a wksp should look like */
+
+struct rec {
+  ulong cnt;
+  ulong gaddr[ ALLOC_MAX ];
+  ulong sz   [ ALLOC_MAX ];
+  ulong tag  [ ALLOC_MAX ];
+  ulong hash [ ALLOC_MAX ];
+};
+
+typedef struct rec rec_t;
+
+/* populate resets wksp, does a bunch of random allocations (including
+   an optional big_sz allocation, some with large alignments and some
+   freed again to leave holes), fills them with random data and records
+   the result in rec. */
+
+static void
+populate( fd_wksp_t * wksp,
+          fd_rng_t *  rng,
+          ulong       big_sz,
+          rec_t *     rec ) {
+  fd_wksp_reset( wksp );
+
+  ulong gaddr[ ALLOC_MAX ];
+  ulong sz   [ ALLOC_MAX ];
+  ulong tag  [ ALLOC_MAX ];
+
+  ulong cnt = 0UL;
+  if( big_sz ) {
+    sz   [ cnt ] = big_sz;
+    tag  [ cnt ] = 1UL;
+    gaddr[ cnt ] = fd_wksp_alloc( wksp, 0UL, sz[ cnt ], tag[ cnt ] ); FD_TEST( gaddr[ cnt ] );
+    cnt++;
+  }
+  for( ; cnt<ALLOC_MAX; cnt++ ) {
+    ulong align  = 1UL << fd_rng_uint_roll( rng, 17U );                                /* In [1,64KiB] */
+    sz   [ cnt ] = 1UL + fd_rng_ulong_roll( rng, 1UL << fd_rng_uint_roll( rng, 19U ) ); /* In [1,256KiB] */
+    tag  [ cnt ] = 1UL + fd_rng_ulong_roll( rng, FD_WKSP_ALLOC_TAG_MAX );
+    gaddr[ cnt ] = fd_wksp_alloc( wksp, align, sz[ cnt ], tag[ cnt ] ); FD_TEST( gaddr[ cnt ] );
+  }
+
+  rec->cnt = 0UL;
+  for( ulong idx=0UL; idx<cnt; idx++ ) {
+    if( idx && !fd_rng_uint_roll( rng, 4U ) ) { fd_wksp_free( wksp, gaddr[ idx ] ); continue; }
+    ulong * laddr = (ulong *)fd_wksp_laddr( wksp, gaddr[ idx ] );
+    fd_rng_fill_ulong( rng, laddr, (sz[ idx ]+7UL)>>3 ); /* Partitions are page multiples so this is safe */
+    ulong j = rec->cnt++;
+    rec->gaddr[ j ] = gaddr[ idx ];
+    rec->sz   [ j ] = sz   [ idx ];
+    rec->tag  [ j ] = tag  [ idx ];
+    rec->hash [ j ] = fd_hash( 0UL, laddr, sz[ idx ] );
+  }
+}
+
+/* verify tests that wksp looks like rec. */
+
+static void
+verify( fd_wksp_t *   wksp,
+        rec_t const * rec ) {
+  ulong used_sz = 0UL;
+  for( ulong idx=0UL; idx<rec->cnt; idx++ ) {
+    ulong gaddr = rec->gaddr[ idx ];
+    ulong sz    = rec->sz   [ idx ];
+    FD_TEST( fd_wksp_tag( wksp, gaddr        )==rec->tag[ idx ] );
+    FD_TEST( fd_wksp_tag( wksp, gaddr+sz-1UL )==rec->tag[ idx ] );
+    FD_TEST( fd_hash( 0UL, fd_wksp_laddr( wksp, gaddr ), sz )==rec->hash[ idx ] );
+    used_sz += fd_ulong_align_up( sz, FD_WKSP_ALLOC_ALIGN_MIN );
+  }
+
+  fd_wksp_usage_t usage[1];
+  FD_TEST( fd_wksp_usage( wksp, NULL, 0UL, usage )==usage );
+  FD_TEST( (usage->total_cnt-usage->free_cnt)==rec->cnt );
+  FD_TEST( (usage->total_sz -usage->free_sz )==used_sz  );
+}
+
+static rec_t rec0[1];
+static rec_t rec1[1];
+static rec_t rec_empty[1];
+
+/* corrupt flips a bit in the byte at off in the file at path */
+
+static void
+corrupt( char const * path,
+         ulong        off ) {
+  int fd = open( path, O_RDWR );
+  FD_TEST( fd!=-1 );
+  uchar c;
+  FD_TEST( pread ( fd, &c, 1UL, (off_t)off )==1L );
+  c ^= (uchar)1;
+  FD_TEST( pwrite( fd, &c, 1UL, (off_t)off )==1L );
+  FD_TEST( !close( fd ) );
+}
+
+static ulong
+file_sz( char const * path ) {
+  int fd = open( path, O_RDONLY );
+  FD_TEST( fd!=-1 );
+  long sz = (long)lseek( fd, (off_t)0, SEEK_END );
+  FD_TEST( sz>0L );
+  FD_TEST( !close( fd ) );
+  return (ulong)sz;
+}
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+
+  char const * _page_sz = fd_env_strip_cmdline_cstr ( &argc, &argv, "--page-sz",  NULL,                     "normal" );
+  ulong        page_cnt = fd_env_strip_cmdline_ulong( &argc, &argv, "--page-cnt", NULL,                     32768UL );
+  ulong        near_cpu = fd_env_strip_cmdline_ulong( &argc, &argv, "--near-cpu", NULL,             fd_log_cpu_id() );
+  char const * dir      = fd_env_strip_cmdline_cstr ( &argc, &argv, "--dir",      NULL,                       "/tmp" );
+
+  ulong page_sz = fd_cstr_to_shmem_page_sz( _page_sz );
+  if( FD_UNLIKELY( !page_sz ) ) FD_LOG_ERR(( "unsupported --page-sz" ));
+
+  ulong tile_cnt = fd_tile_cnt();
+
+  FD_LOG_NOTICE(( "Testing with --page-sz %s, --page-cnt %lu, --near-cpu %lu, --dir %s on %lu tile(s)",
+                  _page_sz, page_cnt, near_cpu, dir, tile_cnt ));
+
+  static uchar _tpool[ FD_TPOOL_FOOTPRINT( FD_TILE_MAX ) ] __attribute__((aligned(FD_TPOOL_ALIGN)));
+  fd_tpool_t * tpool = fd_tpool_join( fd_tpool_new( _tpool, FD_TILE_MAX ) ); FD_TEST( tpool );
+
+  fd_rng_t _rng[1]; fd_rng_t * rng = fd_rng_join( fd_rng_new( _rng, 0U, 0UL ) );
+
+  char path_raw [ 4096 ]; fd_cstr_printf( path_raw,  4096UL, NULL, "%s/test_wksp_checkpt.%lu.raw",  dir, fd_log_group_id() );
+  char path_hash[ 4096 ]; fd_cstr_printf( path_hash, 4096UL, NULL, "%s/test_wksp_checkpt.%lu.hash", dir, fd_log_group_id() );
+  char path_bad [ 4096 ]; fd_cstr_printf( path_bad,  4096UL, NULL, "%s/nonexistent/dir/checkpt",    dir );
+
+  /* wksp0 is the original.  wksp1 is twice as large but with the same
+     part_max (such that its data region starts at the same gaddr).
+     wksp2 is as large but doesn't have enough partitions to hold a
+     checkpt of wksp0.  wksp3 is smaller than wksp0. */
+
+  fd_wksp_t * wksp0 = fd_wksp_new_anonymous( page_sz, page_cnt, near_cpu, "wksp0", 0UL ); FD_TEST( wksp0 );
+
+  fd_wksp_usage_t usage[1];
+  FD_TEST( fd_wksp_usage( wksp0, NULL, 0UL, usage )==usage );
+  ulong part_max = usage->total_max;
+
+  fd_wksp_t * wksp1 = fd_wksp_new_anonymous( page_sz, 2UL*page_cnt, near_cpu, "wksp1", part_max ); FD_TEST( wksp1 );
+  fd_wksp_t * wksp2 = fd_wksp_new_anonymous( page_sz, page_cnt,     near_cpu, "wksp2", 16UL     ); FD_TEST( wksp2 );
+  fd_wksp_t * wksp3 = fd_wksp_new_anonymous( page_sz, page_cnt/4UL, near_cpu, "wksp3", 0UL      ); FD_TEST( wksp3 );
+
+  /* An allocation spanning a couple of checkpt frames if it fits and
+     that doesn't fit in wksp3 */
+
+  ulong wksp_sz = page_sz*page_cnt;
+  ulong big_sz  = fd_ulong_if( wksp_sz>=2UL*FD_WKSP_CHECKPT_FRAME_MAX, FD_WKSP_CHECKPT_FRAME_MAX + (FD_WKSP_CHECKPT_FRAME_MAX>>2),
+                               wksp_sz>>1 );
+
+  FD_LOG_NOTICE(( "Testing bad args" ));
+
+  FD_TEST( fd_wksp_checkpt( tpool, 1UL, tile_cnt, NULL,  path_raw, 0600UL, FD_WKSP_CHECKPT_STYLE_RAW )==EINVAL );
+  FD_TEST( fd_wksp_checkpt( tpool, 1UL, tile_cnt, wksp0, NULL,     0600UL, FD_WKSP_CHECKPT_STYLE_RAW )==EINVAL );
+  FD_TEST( fd_wksp_checkpt( tpool, 1UL, tile_cnt, wksp0, path_raw, 0600UL, -1                        )==EINVAL );
+  FD_TEST( fd_wksp_checkpt( tpool, 2UL, 0UL,      wksp0, path_raw, 0600UL, FD_WKSP_CHECKPT_STYLE_RAW )==EINVAL );
+  FD_TEST( fd_wksp_checkpt( tpool, 1UL, tile_cnt, wksp0, path_bad, 0600UL, FD_WKSP_CHECKPT_STYLE_RAW )==ENOENT );
+  FD_TEST( fd_wksp_restore( tpool, 1UL, tile_cnt, NULL,  path_raw )==EINVAL );
+  FD_TEST( fd_wksp_restore( tpool, 1UL, tile_cnt, wksp0, NULL     )==EINVAL );
+  FD_TEST( fd_wksp_restore( tpool, 2UL, 0UL,      wksp0, path_raw )==EINVAL );
+  FD_TEST( fd_wksp_restore( tpool, 1UL, tile_cnt, wksp0, path_bad )==ENOENT );
+
+  for( ulong iter=0UL; iter<4UL; iter++ ) {
+    fd_tpool_t * tp  = (iter & 1UL) ? NULL : tpool;
+    int          big = iter<2UL;
+
+    FD_LOG_NOTICE(( "Testing checkpt / restore (%s, %s)", tp ? "tpool" : "no tpool", big ? "big alloc" : "no big alloc" ));
+
+    populate( wksp0, rng, big ? big_sz : 0UL, rec0 );
+
+    long dt = -fd_log_wallclock();
+    FD_TEST( !fd_wksp_checkpt( tp, 1UL, tile_cnt, wksp0, path_raw,  0600UL, FD_WKSP_CHECKPT_STYLE_RAW  ) );
+    dt += fd_log_wallclock();
+    ulong sz_raw = file_sz( path_raw );
+    FD_LOG_NOTICE(( "checkpt raw:  %lu bytes, %.3f GB/s", sz_raw, (double)sz_raw / (double)dt ));
+
+    dt = -fd_log_wallclock();
+    FD_TEST( !fd_wksp_checkpt( tp, 1UL, tile_cnt, wksp0, path_hash, 0600UL, FD_WKSP_CHECKPT_STYLE_HASH ) );
+    dt += fd_log_wallclock();
+    ulong sz_hash = file_sz( path_hash );
+    FD_LOG_NOTICE(( "checkpt hash: %lu bytes, %.3f GB/s", sz_hash, (double)sz_hash / (double)dt ));
+    FD_TEST( sz_raw==sz_hash );
+    FD_TEST( sz_raw<wksp_sz ); /* Free space isn't checkpted */
+
+    /* Scramble wksp0 and wksp1 and restore them */
+
+    populate( wksp0, rng, 0UL, rec1 );
+    populate( wksp1, rng, 0UL, rec1 );
+
+    dt = -fd_log_wallclock();
+    FD_TEST( !fd_wksp_restore( tp, 1UL, tile_cnt, wksp0, path_raw ) );
+    dt += fd_log_wallclock();
+    FD_LOG_NOTICE(( "restore raw:  %.3f GB/s", (double)sz_raw / (double)dt ));
+    verify( wksp0, rec0 );
+
+    dt = -fd_log_wallclock();
+    FD_TEST( !fd_wksp_restore( tp, 1UL, tile_cnt, wksp1, path_hash ) );
+    dt += fd_log_wallclock();
+    FD_LOG_NOTICE(( "restore hash: %.3f GB/s", (double)sz_hash / (double)dt ));
+    verify( wksp1, rec0 );
+
+    /* Restores into wksp that can't hold the checkpt should fail and
+       leave them unchanged */
+
+    FD_TEST( fd_wksp_restore( tp, 1UL, tile_cnt, wksp2, path_raw )==ENOMEM );
+    verify( wksp2, rec_empty );
+
+    if( big ) {
+      populate( wksp3, rng, 0UL, rec1 );
+      FD_TEST( fd_wksp_restore( tp, 1UL, tile_cnt, wksp3, path_raw )==ENOMEM );
+      verify( wksp3, rec1 );
+    }
+
+    /* A corrupt frame table should be detected before wksp is changed.
+       Corrupt data should be detected for a hash style checkpt (and
+       leave the wksp empty). */
+
+    corrupt( path_raw, 4096UL + fd_rng_ulong_roll( rng, 32UL ) );
+    FD_TEST( fd_wksp_restore( tp, 1UL, tile_cnt, wksp1, path_raw )==EPROTO );
+    verify( wksp1, rec0 );
+
+    corrupt( path_hash, sz_hash - 1UL - fd_rng_ulong_roll( rng, 4096UL ) );
+    FD_TEST( fd_wksp_restore( tp, 1UL, tile_cnt, wksp1, path_hash )==EPROTO );
+    verify( wksp1, rec_empty );
+
+    /* A partially written checkpt should be detected */
+
+    FD_TEST( !fd_wksp_checkpt( tp, 1UL, tile_cnt, wksp0, path_raw, 0600UL, FD_WKSP_CHECKPT_STYLE_RAW ) );
+    FD_TEST( !truncate( path_raw, (off_t)(sz_raw - 4096UL) ) );
+    FD_TEST( fd_wksp_restore( tp, 1UL, tile_cnt, wksp1, path_raw )==EPROTO );
+    verify( wksp1, rec_empty );
+    corrupt( path_raw, 0UL );
+    FD_TEST( fd_wksp_restore( tp, 1UL, tile_cnt, wksp1, path_raw )==EPROTO );
+
+    /* Checkpt of an empty wksp should restore to an empty wksp */
+
+    fd_wksp_reset( wksp0 );
+    FD_TEST( !fd_wksp_checkpt( tp, 1UL, tile_cnt, wksp0, path_raw, 0600UL, FD_WKSP_CHECKPT_STYLE_HASH ) );
+    FD_TEST( file_sz( path_raw )==4096UL );
+    populate( wksp1, rng, 0UL, rec1 );
+    FD_TEST( !fd_wksp_restore( tp, 1UL, tile_cnt, wksp1, path_raw ) );
+    verify( wksp1, rec_empty );
+  }
+
+  FD_TEST( !unlink( path_raw  ) );
+  FD_TEST( !unlink( path_hash ) );
+
+  fd_rng_delete( fd_rng_leave( rng ) );
+  fd_wksp_delete_anonymous( wksp3 );
+  fd_wksp_delete_anonymous( wksp2 );
+  fd_wksp_delete_anonymous( wksp1 );
+  fd_wksp_delete_anonymous( wksp0 );
+  fd_tpool_delete( fd_tpool_leave( tpool ) );
+
+  FD_LOG_NOTICE(( "pass" ));
+  fd_halt();
+  return 0;
+}
+
+#else
+
+int
+main( int     argc,
+      char ** argv ) {
+  fd_boot( &argc, &argv );
+  FD_LOG_WARNING(( "skip: unit test requires FD_HAS_HOSTED and FD_HAS_X86 capabilities" ));
+  fd_halt();
+  return 0;
+}
+
+#endif